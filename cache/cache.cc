@@ -38,6 +38,22 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct LRUCacheOptions, low_pri_pool_ratio),
           OptionType::kDouble, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"use_swiss_table",
+         {offsetof(struct LRUCacheOptions, use_swiss_table),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"tiny_lfu_admission",
+         {offsetof(struct LRUCacheOptions, tiny_lfu_admission),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"tiny_lfu_expected_entries",
+         {offsetof(struct LRUCacheOptions, tiny_lfu_expected_entries),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"estimate_miss_ratio_curve",
+         {offsetof(struct LRUCacheOptions, estimate_miss_ratio_curve),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
 };
 
 static std::unordered_map<std::string, OptionTypeInfo>
@@ -64,6 +80,38 @@ static std::unordered_map<std::string, OptionTypeInfo>
                    enable_custom_split_merge),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"max_dict_bytes",
+         {offsetof(struct CompressedSecondaryCacheOptions, max_dict_bytes),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"dict_training_bytes",
+         {offsetof(struct CompressedSecondaryCacheOptions,
+                   dict_training_bytes),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"dict_retrain_bytes",
+         {offsetof(struct CompressedSecondaryCacheOptions, dict_retrain_bytes),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+};
+
+static std::unordered_map<std::string, OptionTypeInfo>
+    nvm_sec_cache_options_type_info = {
+        {"path",
+         {offsetof(struct NvmSecondaryCacheOptions, path), OptionType::kString,
+          OptionVerificationType::kNormal, OptionTypeFlags::kNone}},
+        {"capacity",
+         {offsetof(struct NvmSecondaryCacheOptions, capacity),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"segment_size",
+         {offsetof(struct NvmSecondaryCacheOptions, segment_size),
+          OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"clock_eviction",
+         {offsetof(struct NvmSecondaryCacheOptions, clock_eviction),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
 };
 
 Status SecondaryCache::CreateFromString(
@@ -84,6 +132,21 @@ Status SecondaryCache::CreateFromString(
     }
 
 
+    if (status.ok()) {
+      result->swap(sec_cache);
+    }
+    return status;
+  } else if (value.find("nvm_secondary_cache://") == 0) {
+    std::string args = value;
+    args.erase(0, std::strlen("nvm_secondary_cache://"));
+    NvmSecondaryCacheOptions sec_cache_opts;
+    Status status = OptionTypeInfo::ParseStruct(
+        config_options, "", &nvm_sec_cache_options_type_info, "", args,
+        &sec_cache_opts);
+    std::shared_ptr<SecondaryCache> sec_cache;
+    if (status.ok()) {
+      status = NewNvmSecondaryCache(sec_cache_opts, &sec_cache);
+    }
     if (status.ok()) {
       result->swap(sec_cache);
     }
@@ -149,6 +212,20 @@ void Cache::WaitAll(AsyncLookupHandle* async_handles, size_t count) {
   }
 }
 
+void Cache::MultiLookup(AsyncLookupHandle* async_handles, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    StartAsyncLookup(async_handles[i]);
+  }
+}
+
+void Cache::MultiRelease(Handle** handles, size_t count, bool useful) {
+  for (size_t i = 0; i < count; ++i) {
+    if (handles[i] != nullptr) {
+      Release(handles[i], useful, /*erase_if_last_ref=*/false);
+    }
+  }
+}
+
 void Cache::SetEvictionCallback(EvictionCallback&& fn) {
   // Overwriting non-empty with non-empty could indicate a bug
   assert(!eviction_callback_ || !fn);
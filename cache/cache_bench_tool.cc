@@ -49,6 +49,13 @@ DEFINE_double(resident_ratio, 0.25,
               "Ratio of keys fitting in cache to keyspace.");
 DEFINE_uint64(ops_per_thread, 2000000U, "Number of operations per thread.");
 DEFINE_uint32(value_bytes, 8 * KiB, "Size of each value added.");
+DEFINE_uint32(shifted_value_bytes, 0,
+              "If non-zero, size of each value added after "
+              "value_bytes_shift_pct percent of each thread's operations, to "
+              "shift the entry size distribution mid-run.");
+DEFINE_uint32(value_bytes_shift_pct, 50,
+              "Percentage of each thread's operations done before switching "
+              "to shifted_value_bytes.");
 
 DEFINE_uint32(skew, 5, "Degree of skew in key selection");
 DEFINE_bool(populate_cache, true, "Populate cache before operations");
@@ -83,6 +90,12 @@ static class std::shared_ptr<ROCKSDB_NAMESPACE::SecondaryCache> secondary_cache;
 
 DEFINE_string(cache_type, "lru_cache", "Type of block cache.");
 
+DEFINE_bool(tiny_lfu_admission, false,
+            "Whether to use TinyLFU admission for inserts into a full cache");
+
+DEFINE_bool(lru_use_swiss_table, false,
+            "For lru_cache, whether to use the open-addressed (Swiss) table");
+
 // ## BEGIN stress_cache_key sub-tool options ##
 // See class StressCacheKey below.
 DEFINE_bool(stress_cache_key, false,
@@ -224,17 +237,22 @@ struct KeyGen {
   }
 };
 
-Cache::ObjectPtr createValue(Random64& rnd) {
-  char* rv = new char[FLAGS_value_bytes];
+// Values start with their size, as it can change mid-run (see
+// shifted_value_bytes)
+Cache::ObjectPtr createValue(Random64& rnd, uint32_t value_bytes) {
+  char* rv = new char[value_bytes];
+  EncodeFixed64(rv, value_bytes);
   // Fill with some filler data, and take some CPU time
-  for (uint32_t i = 0; i < FLAGS_value_bytes; i += 8) {
+  for (uint32_t i = 8; i < value_bytes; i += 8) {
     EncodeFixed64(rv + i, rnd.Next());
   }
   return rv;
 }
 
 // Callbacks for secondary cache
-size_t SizeFn(Cache::ObjectPtr /*obj*/) { return FLAGS_value_bytes; }
+size_t SizeFn(Cache::ObjectPtr obj) {
+  return static_cast<size_t>(DecodeFixed64(static_cast<char*>(obj)));
+}
 
 Status SaveToFn(Cache::ObjectPtr from_obj, size_t /*from_offset*/,
                 size_t length, char* out) {
@@ -299,13 +317,22 @@ class CacheBench {
       fprintf(stderr, "Old clock cache implementation has been removed.\n");
       exit(1);
     } else if (FLAGS_cache_type == "hyper_clock_cache") {
-      cache_ = HyperClockCacheOptions(FLAGS_cache_size, FLAGS_value_bytes,
-                                      FLAGS_num_shard_bits)
-                   .MakeSharedCache();
+      HyperClockCacheOptions opts(FLAGS_cache_size, FLAGS_value_bytes,
+                                  FLAGS_num_shard_bits);
+      opts.tiny_lfu_admission = FLAGS_tiny_lfu_admission;
+      cache_ = opts.MakeSharedCache();
+    } else if (FLAGS_cache_type == "auto_hyper_clock_cache") {
+      HyperClockCacheOptions opts(FLAGS_cache_size,
+                                  0 /* estimated_entry_charge */,
+                                  FLAGS_num_shard_bits);
+      opts.tiny_lfu_admission = FLAGS_tiny_lfu_admission;
+      cache_ = opts.MakeSharedCache();
     } else if (FLAGS_cache_type == "lru_cache") {
       LRUCacheOptions opts(FLAGS_cache_size, FLAGS_num_shard_bits,
                            false /* strict_capacity_limit */,
                            0.5 /* high_pri_pool_ratio */);
+      opts.tiny_lfu_admission = FLAGS_tiny_lfu_admission;
+      opts.use_swiss_table = FLAGS_lru_use_swiss_table;
       if (!FLAGS_secondary_cache_uri.empty()) {
         Status s = SecondaryCache::CreateFromString(
             ConfigOptions(), FLAGS_secondary_cache_uri, &secondary_cache);
@@ -333,7 +360,8 @@ class CacheBench {
     KeyGen keygen;
     for (uint64_t i = 0; i < 2 * FLAGS_cache_size; i += FLAGS_value_bytes) {
       Status s = cache_->Insert(keygen.GetRand(rnd, max_key_, max_log_),
-                                createValue(rnd), &helper1, FLAGS_value_bytes);
+                                createValue(rnd, FLAGS_value_bytes), &helper1,
+                                FLAGS_value_bytes);
       assert(s.ok());
     }
   }
@@ -533,10 +561,16 @@ class CacheBench {
     const auto clock = SystemClock::Default().get();
     uint64_t start_time = clock->NowMicros();
     StopWatchNano timer(clock);
+    const uint64_t shift_at =
+        FLAGS_shifted_value_bytes > 0
+            ? FLAGS_ops_per_thread * FLAGS_value_bytes_shift_pct / 100
+            : FLAGS_ops_per_thread;
 
     for (uint64_t i = 0; i < FLAGS_ops_per_thread; i++) {
       Slice key = gen.GetRand(thread->rnd, max_key_, max_log_);
       uint64_t random_op = thread->rnd.Next();
+      const uint32_t value_bytes =
+          i < shift_at ? FLAGS_value_bytes : FLAGS_shifted_value_bytes;
 
       timer.Start();
 
@@ -552,12 +586,13 @@ class CacheBench {
           if (!FLAGS_lean) {
             // do something with the data
             result += NPHash64(static_cast<char*>(cache_->Value(handle)),
-                               FLAGS_value_bytes);
+                               cache_->GetCharge(handle));
           }
         } else {
           // do insert
-          Status s = cache_->Insert(key, createValue(thread->rnd), &helper2,
-                                    FLAGS_value_bytes, &handle);
+          Status s =
+              cache_->Insert(key, createValue(thread->rnd, value_bytes),
+                             &helper2, value_bytes, &handle);
           assert(s.ok());
         }
       } else if (random_op < insert_threshold_) {
@@ -566,8 +601,8 @@ class CacheBench {
           handle = nullptr;
         }
         // do insert
-        Status s = cache_->Insert(key, createValue(thread->rnd), &helper3,
-                                  FLAGS_value_bytes, &handle);
+        Status s = cache_->Insert(key, createValue(thread->rnd, value_bytes),
+                                  &helper3, value_bytes, &handle);
         assert(s.ok());
       } else if (random_op < lookup_threshold_) {
         if (handle) {
@@ -581,7 +616,7 @@ class CacheBench {
           if (!FLAGS_lean) {
             // do something with the data
             result += NPHash64(static_cast<char*>(cache_->Value(handle)),
-                               FLAGS_value_bytes);
+                               cache_->GetCharge(handle));
           }
         }
       } else if (random_op < erase_threshold_) {
@@ -620,6 +655,11 @@ class CacheBench {
     printf("Cache size          : %s\n",
            BytesToHumanString(FLAGS_cache_size).c_str());
     printf("Num shard bits      : %u\n", FLAGS_num_shard_bits);
+    printf("Value bytes         : %u\n", FLAGS_value_bytes);
+    if (FLAGS_shifted_value_bytes > 0) {
+      printf("Shifted value bytes : %u (after %u%% of ops)\n",
+             FLAGS_shifted_value_bytes, FLAGS_value_bytes_shift_pct);
+    }
     printf("Max key             : %" PRIu64 "\n", max_key_);
     printf("Resident ratio      : %g\n", FLAGS_resident_ratio);
     printf("Skew degree         : %u\n", FLAGS_skew);
@@ -952,6 +992,12 @@ int cache_bench_tool(int argc, char** argv) {
     exit(1);
   }
 
+  if (FLAGS_value_bytes < 8 ||
+      (FLAGS_shifted_value_bytes > 0 && FLAGS_shifted_value_bytes < 8)) {
+    fprintf(stderr, "value_bytes and shifted_value_bytes must be >= 8\n");
+    exit(1);
+  }
+
   ROCKSDB_NAMESPACE::CacheBench bench;
   if (FLAGS_populate_cache) {
     bench.PopulateCache();
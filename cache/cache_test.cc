@@ -16,11 +16,15 @@
 #include <vector>
 
 #include "cache/lru_cache.h"
+#include "cache/miss_ratio_curve.h"
+#include "cache/tiny_lfu.h"
 #include "cache/typed_cache.h"
 #include "port/stack_trace.h"
+#include "rocksdb/statistics.h"
 #include "test_util/secondary_cache_test_util.h"
 #include "test_util/testharness.h"
 #include "util/coding.h"
+#include "util/hash.h"
 #include "util/hash_containers.h"
 #include "util/string_util.h"
 
@@ -1047,6 +1051,213 @@ TEST_P(CacheTest, CacheHostSeed) {
   fprintf(stderr, "kHostHashSeed -> %u\n", (unsigned)expected_seed);
 }
 
+TEST_P(CacheTest, MultiLookupAndRelease) {
+  // Spanning multiple batches and all shards
+  constexpr int kNumLookups = 150;
+  for (int i = 0; i < kNumLookups; i += 2) {
+    Insert(i, i + 1000);
+  }
+  std::vector<std::string> keys;
+  for (int i = 0; i < kNumLookups; ++i) {
+    // Includes duplicates
+    keys.push_back(EncodeKey(i < kNumLookups - 10 ? i : i % 10));
+  }
+  std::vector<Cache::AsyncLookupHandle> async_handles(kNumLookups);
+  for (int i = 0; i < kNumLookups; ++i) {
+    async_handles[i].key = keys[i];
+  }
+  cache_->MultiLookup(async_handles.data(), kNumLookups);
+  cache_->WaitAll(async_handles.data(), kNumLookups);
+
+  std::vector<Cache::Handle*> handles;
+  for (int i = 0; i < kNumLookups; ++i) {
+    Cache::Handle* h = async_handles[i].Result();
+    int k = DecodeKey(async_handles[i].key);
+    if (k % 2 == 0) {
+      ASSERT_NE(h, nullptr);
+      ASSERT_EQ(DecodeValue(cache_->Value(h)), k + 1000);
+    } else {
+      ASSERT_EQ(h, nullptr);
+    }
+    handles.push_back(h);
+  }
+  ASSERT_GT(cache_->GetPinnedUsage(), 0U);
+
+  // Erased while referenced, and freed on release
+  Erase(0);
+  ASSERT_TRUE(deleted_values_.empty());
+  cache_->MultiRelease(handles.data(), handles.size());
+  ASSERT_EQ(cache_->GetPinnedUsage(), 0U);
+  ASSERT_EQ(deleted_values_, std::vector<int>{1000});
+  ASSERT_EQ(Lookup(0), -1);
+  ASSERT_EQ(Lookup(2), 1002);
+}
+
+TEST(TinyLfuTest, EstimateAndAging) {
+  TinyLfu sketch(1000);
+  const uint64_t kHot = GetSliceHash64("hot");
+  const uint64_t kCold = GetSliceHash64("cold");
+  ASSERT_EQ(sketch.Estimate(kHot), 0U);
+  // The first access only goes into the doorkeeper
+  sketch.Record(kHot);
+  ASSERT_EQ(sketch.Estimate(kHot), 1U);
+  for (int i = 0; i < 5; ++i) {
+    sketch.Record(kHot);
+  }
+  ASSERT_EQ(sketch.Estimate(kHot), 6U);
+  sketch.Record(kCold);
+  ASSERT_TRUE(sketch.Admit(kHot, kCold));
+  ASSERT_FALSE(sketch.Admit(kCold, kHot));
+  ASSERT_FALSE(sketch.Admit(kCold, kCold));
+
+  // Counters saturate
+  for (uint32_t i = 0; i < 2 * TinyLfu::kMaxCount; ++i) {
+    sketch.Record(kHot);
+  }
+  ASSERT_EQ(sketch.Estimate(kHot), TinyLfu::kMaxCount + 1);
+
+  // Aging halves the counts, through accesses to other keys
+  size_t others = sketch.GetSampleSize();
+  for (size_t i = 0; i < others; ++i) {
+    sketch.Record(GetSliceHash64(std::to_string(i)));
+  }
+  uint32_t aged = sketch.Estimate(kHot);
+  ASSERT_LT(aged, TinyLfu::kMaxCount);
+  // (Other keys might have been counted in the same counters)
+  ASSERT_GE(aged, TinyLfu::kMaxCount / 2);
+}
+
+TEST_P(CacheTest, TinyLfuAdmission) {
+  // Admission only applies to blocks and the like
+  const Cache::CacheItemHelper kBlockHelper{CacheEntryRole::kDataBlock,
+                                            &CacheTest::Deleter};
+  constexpr int kCapacity = 100;
+  auto stats = CreateDBStatistics();
+  auto cache = NewCache(kCapacity, [&](ShardedCacheOptions& opts) {
+    opts.num_shard_bits = 0;
+    opts.metadata_charge_policy = kDontChargeCacheMetadata;
+    opts.tiny_lfu_admission = true;
+    opts.tiny_lfu_expected_entries = 1000;
+    opts.statistics = stats;
+  });
+
+  // Fill the cache with a working set, looked up a few times. No admission
+  // decisions while the cache has room.
+  for (int i = 0; i < kCapacity; ++i) {
+    ASSERT_EQ(Lookup(cache, i), -1);
+    ASSERT_OK(cache->Insert(EncodeKey(i), EncodeValue(i), &kBlockHelper, 1));
+  }
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < kCapacity; ++i) {
+      ASSERT_EQ(Lookup(cache, i), i);
+    }
+  }
+  ASSERT_EQ(stats->getTickerCount(BLOCK_CACHE_TINY_LFU_ADMIT), 0U);
+  ASSERT_EQ(stats->getTickerCount(BLOCK_CACHE_TINY_LFU_REJECT), 0U);
+  deleted_values_.clear();
+
+  // A scan of keys accessed once should not flush the working set
+  constexpr int kScanSize = 1000;
+  for (int i = kCapacity; i < kCapacity + kScanSize; ++i) {
+    ASSERT_EQ(Lookup(cache, i), -1);
+    // A rejected entry can still be used through its handle
+    Cache::Handle* handle = nullptr;
+    ASSERT_OK(cache->Insert(EncodeKey(i), EncodeValue(i), &kBlockHelper, 1,
+                            &handle));
+    ASSERT_NE(handle, nullptr);
+    ASSERT_EQ(DecodeValue(cache->Value(handle)), i);
+    cache->Release(handle);
+  }
+  int hits = 0;
+  for (int i = 0; i < kCapacity; ++i) {
+    hits += Lookup(cache, i) == i ? 1 : 0;
+  }
+  // Allow for some inaccuracy of the sketch
+  ASSERT_GE(hits, kCapacity * 9 / 10);
+  uint64_t rejects = stats->getTickerCount(BLOCK_CACHE_TINY_LFU_REJECT);
+  ASSERT_GT(rejects, stats->getTickerCount(BLOCK_CACHE_TINY_LFU_ADMIT));
+  // Rejected entries are freed
+  ASSERT_GE(deleted_values_.size(), rejects);
+  ASSERT_LE(cache->GetUsage(), size_t{kCapacity});
+
+  // Other entries, like memory reservations, are always admitted
+  const Cache::CacheItemHelper kMiscHelper{CacheEntryRole::kMisc,
+                                           &CacheTest::Deleter};
+  const int kReserved = kCapacity + kScanSize;
+  ASSERT_OK(cache->Insert(EncodeKey(kReserved), EncodeValue(kReserved),
+                          &kMiscHelper, 1));
+  ASSERT_EQ(Lookup(cache, kReserved), kReserved);
+}
+
+TEST(MissRatioCurveTest, CyclicAccesses) {
+  // Few enough sampled keys that only a fraction of the accesses is sampled
+  MissRatioCurveEstimator mrc(/*max_sampled_keys=*/500);
+  constexpr int kNumKeys = 2000;
+  constexpr size_t kCharge = 10;
+  constexpr size_t kWorkingSet = kNumKeys * kCharge;
+  ASSERT_EQ(mrc.EstimateHitRatios({kWorkingSet}),
+            std::vector<double>({0.0}));
+
+  // Cycling through more keys than an LRU cache holds never hits, and
+  // always hits once it holds all of them
+  uint64_t reuse_distance = 0;
+  uint64_t max_reuse_distance = 0;
+  for (int round = 0; round < 20; ++round) {
+    for (int i = 0; i < kNumKeys; ++i) {
+      uint64_t hash = GetSliceHash64(std::to_string(i));
+      if (round == 0) {
+        // Missed, then inserted
+        ASSERT_FALSE(mrc.RecordAccess(hash, 0, &reuse_distance));
+        mrc.RecordInsert(hash, kCharge);
+      } else if (mrc.RecordAccess(hash, kCharge, &reuse_distance)) {
+        max_reuse_distance = std::max(max_reuse_distance, reuse_distance);
+      }
+    }
+  }
+  ASSERT_LT(mrc.GetSamplingRate(), 0.5);
+  ASSERT_GT(max_reuse_distance, kWorkingSet / 2);
+  ASSERT_LT(max_reuse_distance, kWorkingSet * 2);
+
+  std::vector<double> hit_ratios =
+      mrc.EstimateHitRatios({kWorkingSet / 2, kWorkingSet * 2});
+  ASSERT_LT(hit_ratios[0], 0.05);
+  // All but the cold misses of the first round
+  ASSERT_GT(hit_ratios[1], 0.9);
+  ASSERT_LE(hit_ratios[1], 1.0);
+}
+
+TEST_P(CacheTest, EstimateHitRatios) {
+  constexpr int kCapacity = 1000;
+  std::vector<double> hit_ratios;
+  ASSERT_FALSE(cache_->EstimateHitRatios({kCapacity}, &hit_ratios));
+
+  auto stats = CreateDBStatistics();
+  auto cache = NewCache(kCapacity, [&](ShardedCacheOptions& opts) {
+    opts.metadata_charge_policy = kDontChargeCacheMetadata;
+    opts.estimate_miss_ratio_curve = true;
+    opts.statistics = stats;
+  });
+  // A working set of a fifth of the capacity
+  constexpr int kNumKeys = kCapacity / 5;
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < kNumKeys; ++i) {
+      if (Lookup(cache, i) == -1) {
+        ASSERT_OK(cache->Insert(EncodeKey(i), EncodeValue(i), &kHelper, 1));
+      }
+    }
+  }
+  ASSERT_TRUE(
+      cache->EstimateHitRatios({kNumKeys / 2, kCapacity}, &hit_ratios));
+  ASSERT_EQ(hit_ratios.size(), 2U);
+  ASSERT_LT(hit_ratios[0], 0.05);
+  ASSERT_GT(hit_ratios[1], 0.85);
+
+  HistogramData distances;
+  stats->histogramData(BLOCK_CACHE_REUSE_DISTANCE_BYTES, &distances);
+  ASSERT_EQ(distances.count, uint64_t{9 * kNumKeys});
+  ASSERT_EQ(distances.max, double{kNumKeys});
+}
+
 INSTANTIATE_TEST_CASE_P(CacheTestInstance, CacheTest,
                         secondary_cache_test_util::GetTestingCacheTypes());
 INSTANTIATE_TEST_CASE_P(CacheTestInstance, LRUCacheTest,
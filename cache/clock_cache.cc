@@ -19,6 +19,7 @@
 #include "monitoring/statistics_impl.h"
 #include "port/lang.h"
 #include "rocksdb/env.h"
+#include "util/fastrange.h"
 #include "util/hash.h"
 #include "util/math.h"
 #include "util/random.h"
@@ -126,66 +127,6 @@ void ClockHandleBasicData::FreeData(MemoryAllocator* allocator) const {
   }
 }
 
-HyperClockTable::HyperClockTable(
-    size_t capacity, bool /*strict_capacity_limit*/,
-    CacheMetadataChargePolicy metadata_charge_policy,
-    MemoryAllocator* allocator,
-    const Cache::EvictionCallback* eviction_callback, const uint32_t* hash_seed,
-    const Opts& opts)
-    : length_bits_(CalcHashBits(capacity, opts.estimated_value_size,
-                                metadata_charge_policy)),
-      length_bits_mask_((size_t{1} << length_bits_) - 1),
-      occupancy_limit_(static_cast<size_t>((uint64_t{1} << length_bits_) *
-                                           kStrictLoadFactor)),
-      array_(new HandleImpl[size_t{1} << length_bits_]),
-      allocator_(allocator),
-      eviction_callback_(*eviction_callback),
-      hash_seed_(*hash_seed) {
-  if (metadata_charge_policy ==
-      CacheMetadataChargePolicy::kFullChargeCacheMetadata) {
-    usage_ += size_t{GetTableSize()} * sizeof(HandleImpl);
-  }
-
-  static_assert(sizeof(HandleImpl) == 64U,
-                "Expecting size / alignment with common cache line size");
-}
-
-HyperClockTable::~HyperClockTable() {
-  // Assumes there are no references or active operations on any slot/element
-  // in the table.
-  for (size_t i = 0; i < GetTableSize(); i++) {
-    HandleImpl& h = array_[i];
-    switch (h.meta >> ClockHandle::kStateShift) {
-      case ClockHandle::kStateEmpty:
-        // noop
-        break;
-      case ClockHandle::kStateInvisible:  // rare but possible
-      case ClockHandle::kStateVisible:
-        assert(GetRefcount(h.meta) == 0);
-        h.FreeData(allocator_);
-#ifndef NDEBUG
-        Rollback(h.hashed_key, &h);
-        ReclaimEntryUsage(h.GetTotalCharge());
-#endif
-        break;
-      // otherwise
-      default:
-        assert(false);
-        break;
-    }
-  }
-
-#ifndef NDEBUG
-  for (size_t i = 0; i < GetTableSize(); i++) {
-    assert(array_[i].displacements.load() == 0);
-  }
-#endif
-
-  assert(usage_.load() == 0 ||
-         usage_.load() == size_t{GetTableSize()} * sizeof(HandleImpl));
-  assert(occupancy_ == 0);
-}
-
 // If an entry doesn't receive clock updates but is repeatedly referenced &
 // released, the acquire and release counters could overflow without some
 // intervention. This is that intervention, which should be inexpensive
@@ -259,7 +200,351 @@ inline void CorrectNearOverflow(uint64_t old_meta,
   }
 }
 
-inline Status HyperClockTable::ChargeUsageMaybeEvictStrict(
+namespace {
+
+// Optimistically transitions the slot from "empty" to "under construction"
+// (no effect on other states), returning the previous state. If that was
+// kStateEmpty, the calling thread has taken ownership of the slot.
+inline uint64_t ClaimIfEmpty(ClockHandle& h) {
+  uint64_t old_meta = h.meta.fetch_or(
+      uint64_t{ClockHandle::kStateOccupiedBit} << ClockHandle::kStateShift,
+      std::memory_order_acq_rel);
+  return old_meta >> ClockHandle::kStateShift;
+}
+
+// Transitions a slot owned by the inserting thread, with the data fields
+// already saved, from "under construction" to "visible", maybe with an
+// outstanding reference for the caller.
+inline void MakeSlotVisible(ClockHandle& h, uint64_t initial_countdown,
+                            bool keep_ref) {
+  uint64_t new_meta = uint64_t{ClockHandle::kStateVisible}
+                      << ClockHandle::kStateShift;
+
+  // Maybe with an outstanding reference
+  new_meta |= initial_countdown << ClockHandle::kAcquireCounterShift;
+  new_meta |= (initial_countdown - keep_ref)
+              << ClockHandle::kReleaseCounterShift;
+
+#ifndef NDEBUG
+  // Save the state transition, with assertion
+  uint64_t old_meta = h.meta.exchange(new_meta, std::memory_order_release);
+  assert(old_meta >> ClockHandle::kStateShift ==
+         ClockHandle::kStateConstruction);
+#else
+  // Save the state transition
+  h.meta.store(new_meta, std::memory_order_release);
+#endif
+}
+
+// For an existing entry found while inserting `proto`, returns true if it is
+// a visible entry for the same key, in which case its clock state has been
+// boosted (as if looked up `initial_countdown` times).
+inline bool MatchAndBoostExisting(const ClockHandleBasicData& proto,
+                                  ClockHandle& h,
+                                  uint64_t initial_countdown) {
+  // Existing, visible entry, which might be a match.
+  // But first, we need to acquire a ref to read it. In fact, number of
+  // refs for initial countdown, so that we boost the clock state if
+  // this is a match.
+  uint64_t old_meta =
+      h.meta.fetch_add(ClockHandle::kAcquireIncrement * initial_countdown,
+                       std::memory_order_acq_rel);
+  // Like Lookup
+  if ((old_meta >> ClockHandle::kStateShift) == ClockHandle::kStateVisible) {
+    // Acquired a read reference
+    if (h.hashed_key == proto.hashed_key) {
+      // Match. Release in a way that boosts the clock state
+      old_meta =
+          h.meta.fetch_add(ClockHandle::kReleaseIncrement * initial_countdown,
+                           std::memory_order_acq_rel);
+      // Correct for possible (but rare) overflow
+      CorrectNearOverflow(old_meta, h.meta);
+      return true;
+    } else {
+      // Mismatch. Pretend we never took the reference
+      h.meta.fetch_sub(ClockHandle::kAcquireIncrement * initial_countdown,
+                       std::memory_order_acq_rel);
+    }
+  } else if (UNLIKELY((old_meta >> ClockHandle::kStateShift) ==
+                      ClockHandle::kStateInvisible)) {
+    // Pretend we never took the reference
+    // WART: there's a tiny chance we release last ref to invisible
+    // entry here. If that happens, we let eviction take care of it.
+    h.meta.fetch_sub(ClockHandle::kAcquireIncrement * initial_countdown,
+                     std::memory_order_acq_rel);
+  } else {
+    // For other states, incrementing the acquire counter has no effect
+    // so we don't need to undo it.
+    // Slot not usable / touchable now.
+  }
+  return false;
+}
+
+// Lookup on a single slot: returns true, holding a reference, if the slot
+// holds a visible entry for `hashed_key`.
+inline bool TryAcquireVisibleMatch(ClockHandle& h,
+                                   const UniqueId64x2& hashed_key) {
+  // Optimistic lookup should pay off when the table is relatively
+  // sparse.
+  constexpr bool kOptimisticLookup = true;
+  uint64_t old_meta;
+  if (!kOptimisticLookup) {
+    old_meta = h.meta.load(std::memory_order_acquire);
+    if ((old_meta >> ClockHandle::kStateShift) != ClockHandle::kStateVisible) {
+      return false;
+    }
+  }
+  // (Optimistically) increment acquire counter
+  old_meta = h.meta.fetch_add(ClockHandle::kAcquireIncrement,
+                              std::memory_order_acquire);
+  // Check if it's an entry visible to lookups
+  if ((old_meta >> ClockHandle::kStateShift) == ClockHandle::kStateVisible) {
+    // Acquired a read reference
+    if (h.hashed_key == hashed_key) {
+      // Match
+      return true;
+    } else {
+      // Mismatch. Pretend we never took the reference
+      h.meta.fetch_sub(ClockHandle::kAcquireIncrement,
+                       std::memory_order_release);
+    }
+  } else if (UNLIKELY((old_meta >> ClockHandle::kStateShift) ==
+                      ClockHandle::kStateInvisible)) {
+    // Pretend we never took the reference
+    // WART: there's a tiny chance we release last ref to invisible
+    // entry here. If that happens, we let eviction take care of it.
+    h.meta.fetch_sub(ClockHandle::kAcquireIncrement,
+                     std::memory_order_release);
+  } else {
+    // For other states, incrementing the acquire counter has no effect
+    // so we don't need to undo it. Furthermore, we cannot safely undo
+    // it because we did not acquire a read reference to lock the
+    // entry in a Shareable state.
+  }
+  return false;
+}
+
+// Erase on a single slot: if the slot holds a visible entry for
+// `hashed_key`, makes it invisible. Returns true if this also took ownership
+// of the slot (no other references) for freeing the entry.
+inline bool TryEraseVisibleMatch(ClockHandle& h,
+                                 const UniqueId64x2& hashed_key) {
+  // Optimistically increment acquire counter
+  uint64_t old_meta = h.meta.fetch_add(ClockHandle::kAcquireIncrement,
+                                       std::memory_order_acquire);
+  // Check if it's an entry visible to lookups
+  if ((old_meta >> ClockHandle::kStateShift) == ClockHandle::kStateVisible) {
+    // Acquired a read reference
+    if (h.hashed_key == hashed_key) {
+      // Match. Set invisible.
+      old_meta =
+          h.meta.fetch_and(~(uint64_t{ClockHandle::kStateVisibleBit}
+                             << ClockHandle::kStateShift),
+                           std::memory_order_acq_rel);
+      // Apply update to local copy
+      old_meta &= ~(uint64_t{ClockHandle::kStateVisibleBit}
+                    << ClockHandle::kStateShift);
+      for (;;) {
+        uint64_t refcount = GetRefcount(old_meta);
+        assert(refcount > 0);
+        if (refcount > 1) {
+          // Not last ref at some point in time during this Erase call
+          // Pretend we never took the reference
+          h.meta.fetch_sub(ClockHandle::kAcquireIncrement,
+                           std::memory_order_release);
+          return false;
+        } else if (h.meta.compare_exchange_weak(
+                       old_meta,
+                       uint64_t{ClockHandle::kStateConstruction}
+                           << ClockHandle::kStateShift,
+                       std::memory_order_acq_rel)) {
+          // Took ownership
+          assert(hashed_key == h.hashed_key);
+          return true;
+        }
+      }
+    } else {
+      // Mismatch. Pretend we never took the reference
+      h.meta.fetch_sub(ClockHandle::kAcquireIncrement,
+                       std::memory_order_release);
+    }
+  } else if (UNLIKELY((old_meta >> ClockHandle::kStateShift) ==
+                      ClockHandle::kStateInvisible)) {
+    // Pretend we never took the reference
+    // WART: there's a tiny chance we release last ref to invisible
+    // entry here. If that happens, we let eviction take care of it.
+    h.meta.fetch_sub(ClockHandle::kAcquireIncrement,
+                     std::memory_order_release);
+  } else {
+    // For other states, incrementing the acquire counter has no effect
+    // so we don't need to undo it.
+  }
+  return false;
+}
+
+// Release of a reference. Returns true if the entry is to be erased on its
+// last reference (erase_if_last_ref or already invisible) and this was the
+// last reference, in which case the caller has taken ownership of the slot
+// for freeing the entry.
+inline bool ReleaseMaybeTakeOwnership(ClockHandle& h, bool useful,
+                                      bool erase_if_last_ref) {
+  uint64_t old_meta;
+  if (useful) {
+    // Increment release counter to indicate was used
+    old_meta = h.meta.fetch_add(ClockHandle::kReleaseIncrement,
+                                std::memory_order_release);
+  } else {
+    // Decrement acquire counter to pretend it never happened
+    old_meta = h.meta.fetch_sub(ClockHandle::kAcquireIncrement,
+                                std::memory_order_release);
+  }
+
+  assert((old_meta >> ClockHandle::kStateShift) &
+         ClockHandle::kStateShareableBit);
+  // No underflow
+  assert(((old_meta >> ClockHandle::kAcquireCounterShift) &
+          ClockHandle::kCounterMask) !=
+         ((old_meta >> ClockHandle::kReleaseCounterShift) &
+          ClockHandle::kCounterMask));
+
+  if (erase_if_last_ref || UNLIKELY(old_meta >> ClockHandle::kStateShift ==
+                                    ClockHandle::kStateInvisible)) {
+    // Update for last fetch_add op
+    if (useful) {
+      old_meta += ClockHandle::kReleaseIncrement;
+    } else {
+      old_meta -= ClockHandle::kAcquireIncrement;
+    }
+    // Take ownership if no refs
+    do {
+      if (GetRefcount(old_meta) != 0) {
+        // Not last ref at some point in time during this Release call
+        // Correct for possible (but rare) overflow
+        CorrectNearOverflow(old_meta, h.meta);
+        return false;
+      }
+      if ((old_meta & (uint64_t{ClockHandle::kStateShareableBit}
+                       << ClockHandle::kStateShift)) == 0) {
+        // Someone else took ownership
+        return false;
+      }
+      // Note that there's a small chance that we release, another thread
+      // replaces this entry with another, reaches zero refs, and then we end
+      // up erasing that other entry. That's an acceptable risk / imprecision.
+    } while (!h.meta.compare_exchange_weak(
+        old_meta,
+        uint64_t{ClockHandle::kStateConstruction} << ClockHandle::kStateShift,
+        std::memory_order_acquire));
+    // Took ownership
+    return true;
+  } else {
+    // Correct for possible (but rare) overflow
+    CorrectNearOverflow(old_meta, h.meta);
+    return false;
+  }
+}
+
+template <class HandleImpl>
+void ConstApplyToEntriesRangeImpl(
+    const std::function<void(const HandleImpl&)>& func, HandleImpl* begin,
+    HandleImpl* end, bool apply_if_will_be_deleted) {
+  uint64_t check_state_mask = ClockHandle::kStateShareableBit;
+  if (!apply_if_will_be_deleted) {
+    check_state_mask |= ClockHandle::kStateVisibleBit;
+  }
+
+  for (HandleImpl* h = begin; h < end; ++h) {
+    // Note: to avoid using compare_exchange, we have to be extra careful.
+    uint64_t old_meta = h->meta.load(std::memory_order_relaxed);
+    // Check if it's an entry visible to lookups
+    if ((old_meta >> ClockHandle::kStateShift) & check_state_mask) {
+      // Increment acquire counter. Note: it's possible that the entry has
+      // completely changed since we loaded old_meta, but incrementing acquire
+      // count is always safe. (Similar to optimistic Lookup here.)
+      old_meta = h->meta.fetch_add(ClockHandle::kAcquireIncrement,
+                                   std::memory_order_acquire);
+      // Check whether we actually acquired a reference.
+      if ((old_meta >> ClockHandle::kStateShift) &
+          ClockHandle::kStateShareableBit) {
+        // Apply func if appropriate
+        if ((old_meta >> ClockHandle::kStateShift) & check_state_mask) {
+          func(*h);
+        }
+        // Pretend we never took the reference
+        h->meta.fetch_sub(ClockHandle::kAcquireIncrement,
+                          std::memory_order_release);
+        // No net change, so don't need to check for overflow
+      } else {
+        // For other states, incrementing the acquire counter has no effect
+        // so we don't need to undo it. Furthermore, we cannot safely undo
+        // it because we did not acquire a read reference to lock the
+        // entry in a Shareable state.
+      }
+    }
+  }
+}
+
+// Among the first few entries from the clock pointer, finds the visible,
+// unreferenced one with the lowest clock countdown, i.e. the next likely to be
+// evicted. References are taken as in ConstApplyToEntriesRangeImpl to read
+// the key.
+template <class HandleImpl, class SlotFn>
+bool GetEvictionCandidateImpl(HandleImpl* array, size_t length,
+                              const SlotFn& slot, UniqueId64x2* victim) {
+  constexpr size_t kEntriesToCheck = 4;
+  constexpr size_t kMaxSlotsToCheck = 64;
+  const size_t max_slots = std::min(length, kMaxSlotsToCheck);
+  uint64_t best_countdown = UINT64_MAX;
+  size_t entries_checked = 0;
+  for (size_t i = 0; i < max_slots && entries_checked < kEntriesToCheck; ++i) {
+    HandleImpl* h = array + slot(i);
+    uint64_t old_meta = h->meta.load(std::memory_order_relaxed);
+    if ((old_meta >> ClockHandle::kStateShift) != ClockHandle::kStateVisible) {
+      continue;
+    }
+    old_meta = h->meta.fetch_add(ClockHandle::kAcquireIncrement,
+                                 std::memory_order_acquire);
+    if ((old_meta >> ClockHandle::kStateShift) &
+        ClockHandle::kStateShareableBit) {
+      uint64_t acquire_count = (old_meta >> ClockHandle::kAcquireCounterShift) &
+                               ClockHandle::kCounterMask;
+      uint64_t release_count = (old_meta >> ClockHandle::kReleaseCounterShift) &
+                               ClockHandle::kCounterMask;
+      ++entries_checked;
+      if ((old_meta >> ClockHandle::kStateShift) ==
+              ClockHandle::kStateVisible &&
+          acquire_count == release_count && acquire_count < best_countdown) {
+        best_countdown = acquire_count;
+        *victim = h->hashed_key;
+      }
+      h->meta.fetch_sub(ClockHandle::kAcquireIncrement,
+                        std::memory_order_release);
+    }
+  }
+  return best_countdown != UINT64_MAX;
+}
+
+// AutoHyperClockTable starts with (at most) this many slots
+constexpr int kAutoMinLengthBits = 6;
+// Chain links in AutoHyperClockTable are 1 + slot index, which must leave
+// the top bit free (kHeadLocked) and never reach kStandaloneNext
+constexpr int kAutoMaxLengthBits = 30;
+
+}  // namespace
+
+inline void BaseClockTable::ReclaimEntryUsage(size_t total_charge) {
+  auto old_occupancy = occupancy_.fetch_sub(1U, std::memory_order_release);
+  (void)old_occupancy;
+  // No underflow
+  assert(old_occupancy > 0);
+  auto old_usage = usage_.fetch_sub(total_charge, std::memory_order_relaxed);
+  (void)old_usage;
+  // No underflow
+  assert(old_usage >= total_charge);
+}
+
+template <class Table>
+inline Status BaseClockTable::ChargeUsageMaybeEvictStrict(
     size_t total_charge, size_t capacity, bool need_evict_for_occupancy) {
   if (total_charge > capacity) {
     return Status::MemoryLimit(
@@ -287,7 +572,8 @@ inline Status HyperClockTable::ChargeUsageMaybeEvictStrict(
   if (request_evict_charge > 0) {
     size_t evicted_charge = 0;
     size_t evicted_count = 0;
-    Evict(request_evict_charge, &evicted_charge, &evicted_count);
+    static_cast<Table*>(this)->Evict(request_evict_charge, &evicted_charge,
+                                     &evicted_count);
     occupancy_.fetch_sub(evicted_count, std::memory_order_release);
     if (LIKELY(evicted_charge > need_evict_charge)) {
       assert(evicted_count > 0);
@@ -316,7 +602,8 @@ inline Status HyperClockTable::ChargeUsageMaybeEvictStrict(
   return Status::OK();
 }
 
-inline bool HyperClockTable::ChargeUsageMaybeEvictNonStrict(
+template <class Table>
+inline bool BaseClockTable::ChargeUsageMaybeEvictNonStrict(
     size_t total_charge, size_t capacity, bool need_evict_for_occupancy) {
   // For simplicity, we consider that either the cache can accept the insert
   // with no evictions, or we must evict enough to make (at least) enough
@@ -354,7 +641,8 @@ inline bool HyperClockTable::ChargeUsageMaybeEvictNonStrict(
   size_t evicted_charge = 0;
   size_t evicted_count = 0;
   if (need_evict_charge > 0) {
-    Evict(need_evict_charge, &evicted_charge, &evicted_count);
+    static_cast<Table*>(this)->Evict(need_evict_charge, &evicted_charge,
+                                     &evicted_count);
     // Deal with potential occupancy deficit
     if (UNLIKELY(need_evict_for_occupancy) && evicted_count == 0) {
       assert(evicted_charge == 0);
@@ -373,7 +661,8 @@ inline bool HyperClockTable::ChargeUsageMaybeEvictNonStrict(
   return true;
 }
 
-inline HyperClockTable::HandleImpl* HyperClockTable::StandaloneInsert(
+template <class HandleImpl>
+inline HandleImpl* BaseClockTable::StandaloneInsert(
     const ClockHandleBasicData& proto) {
   // Heap allocated separate from table
   HandleImpl* h = new HandleImpl();
@@ -392,33 +681,60 @@ inline HyperClockTable::HandleImpl* HyperClockTable::StandaloneInsert(
   return h;
 }
 
-Status HyperClockTable::Insert(const ClockHandleBasicData& proto,
-                               HandleImpl** handle, Cache::Priority priority,
-                               size_t capacity, bool strict_capacity_limit) {
+inline void BaseClockTable::FinishEviction(ClockHandle& h,
+                                           size_t* freed_charge,
+                                           size_t* freed_count) {
+  *freed_charge += h.GetTotalCharge();
+  *freed_count += 1;
+  bool took_ownership = false;
+  if (eviction_callback_) {
+    // For key reconstructed from hash
+    UniqueId64x2 unhashed;
+    took_ownership =
+        eviction_callback_(ClockCacheShard<HyperClockTable>::ReverseHash(
+                               h.GetHash(), &unhashed, hash_seed_),
+                           reinterpret_cast<Cache::Handle*>(&h));
+  }
+  if (!took_ownership) {
+    h.FreeData(allocator_);
+  }
+  MarkEmpty(h);
+}
+
+template <class Table>
+Status BaseClockTable::Insert(const ClockHandleBasicData& proto,
+                              typename Table::HandleImpl** handle,
+                              Cache::Priority priority, size_t capacity,
+                              bool strict_capacity_limit) {
+  using HandleImpl = typename Table::HandleImpl;
+  Table& derived = static_cast<Table&>(*this);
+
   // Do we have the available occupancy? Optimistically assume we do
   // and deal with it if we don't.
   size_t old_occupancy = occupancy_.fetch_add(1, std::memory_order_acquire);
   auto revert_occupancy_fn = [&]() {
     occupancy_.fetch_sub(1, std::memory_order_relaxed);
   };
+  typename Table::InsertState state;
   // Whether we over-committed and need an eviction to make up for it
-  bool need_evict_for_occupancy = old_occupancy >= occupancy_limit_;
+  bool need_evict_for_occupancy =
+      !derived.GrowIfNeeded(old_occupancy + 1, state);
 
   // Usage/capacity handling is somewhat different depending on
   // strict_capacity_limit, but mostly pessimistic.
   bool use_standalone_insert = false;
   const size_t total_charge = proto.GetTotalCharge();
   if (strict_capacity_limit) {
-    Status s = ChargeUsageMaybeEvictStrict(total_charge, capacity,
-                                           need_evict_for_occupancy);
+    Status s = ChargeUsageMaybeEvictStrict<Table>(total_charge, capacity,
+                                                  need_evict_for_occupancy);
     if (!s.ok()) {
       revert_occupancy_fn();
       return s;
     }
   } else {
     // Case strict_capacity_limit == false
-    bool success = ChargeUsageMaybeEvictNonStrict(total_charge, capacity,
-                                                  need_evict_for_occupancy);
+    bool success = ChargeUsageMaybeEvictNonStrict<Table>(
+        total_charge, capacity, need_evict_for_occupancy);
     if (!success) {
       revert_occupancy_fn();
       if (handle == nullptr) {
@@ -451,115 +767,16 @@ Status HyperClockTable::Insert(const ClockHandleBasicData& proto,
     uint64_t initial_countdown = GetInitialCountdown(priority);
     assert(initial_countdown > 0);
 
-    size_t probe = 0;
-    HandleImpl* e = FindSlot(
-        proto.hashed_key,
-        [&](HandleImpl* h) {
-          // Optimistically transition the slot from "empty" to
-          // "under construction" (no effect on other states)
-          uint64_t old_meta =
-              h->meta.fetch_or(uint64_t{ClockHandle::kStateOccupiedBit}
-                                   << ClockHandle::kStateShift,
-                               std::memory_order_acq_rel);
-          uint64_t old_state = old_meta >> ClockHandle::kStateShift;
-
-          if (old_state == ClockHandle::kStateEmpty) {
-            // We've started inserting into an available slot, and taken
-            // ownership Save data fields
-            ClockHandleBasicData* h_alias = h;
-            *h_alias = proto;
-
-            // Transition from "under construction" state to "visible" state
-            uint64_t new_meta = uint64_t{ClockHandle::kStateVisible}
-                                << ClockHandle::kStateShift;
-
-            // Maybe with an outstanding reference
-            new_meta |= initial_countdown << ClockHandle::kAcquireCounterShift;
-            new_meta |= (initial_countdown - (handle != nullptr))
-                        << ClockHandle::kReleaseCounterShift;
-
-#ifndef NDEBUG
-            // Save the state transition, with assertion
-            old_meta = h->meta.exchange(new_meta, std::memory_order_release);
-            assert(old_meta >> ClockHandle::kStateShift ==
-                   ClockHandle::kStateConstruction);
-#else
-            // Save the state transition
-            h->meta.store(new_meta, std::memory_order_release);
-#endif
-            return true;
-          } else if (old_state != ClockHandle::kStateVisible) {
-            // Slot not usable / touchable now
-            return false;
-          }
-          // Existing, visible entry, which might be a match.
-          // But first, we need to acquire a ref to read it. In fact, number of
-          // refs for initial countdown, so that we boost the clock state if
-          // this is a match.
-          old_meta = h->meta.fetch_add(
-              ClockHandle::kAcquireIncrement * initial_countdown,
-              std::memory_order_acq_rel);
-          // Like Lookup
-          if ((old_meta >> ClockHandle::kStateShift) ==
-              ClockHandle::kStateVisible) {
-            // Acquired a read reference
-            if (h->hashed_key == proto.hashed_key) {
-              // Match. Release in a way that boosts the clock state
-              old_meta = h->meta.fetch_add(
-                  ClockHandle::kReleaseIncrement * initial_countdown,
-                  std::memory_order_acq_rel);
-              // Correct for possible (but rare) overflow
-              CorrectNearOverflow(old_meta, h->meta);
-              // Insert standalone instead (only if return handle needed)
-              use_standalone_insert = true;
-              return true;
-            } else {
-              // Mismatch. Pretend we never took the reference
-              old_meta = h->meta.fetch_sub(
-                  ClockHandle::kAcquireIncrement * initial_countdown,
-                  std::memory_order_acq_rel);
-            }
-          } else if (UNLIKELY((old_meta >> ClockHandle::kStateShift) ==
-                              ClockHandle::kStateInvisible)) {
-            // Pretend we never took the reference
-            // WART: there's a tiny chance we release last ref to invisible
-            // entry here. If that happens, we let eviction take care of it.
-            old_meta = h->meta.fetch_sub(
-                ClockHandle::kAcquireIncrement * initial_countdown,
-                std::memory_order_acq_rel);
-          } else {
-            // For other states, incrementing the acquire counter has no effect
-            // so we don't need to undo it.
-            // Slot not usable / touchable now.
-          }
-          (void)old_meta;
-          return false;
-        },
-        [&](HandleImpl* /*h*/) { return false; },
-        [&](HandleImpl* h) {
-          h->displacements.fetch_add(1, std::memory_order_relaxed);
-        },
-        probe);
-    if (e == nullptr) {
-      // Occupancy check and never abort FindSlot above should generally
-      // prevent this, except it's theoretically possible for other threads
-      // to evict and replace entries in the right order to hit every slot
-      // when it is populated. Assuming random hashing, the chance of that
-      // should be no higher than pow(kStrictLoadFactor, n) for n slots.
-      // That should be infeasible for roughly n >= 256, so if this assertion
-      // fails, that suggests something is going wrong.
-      assert(GetTableSize() < 256);
-      use_standalone_insert = true;
-    }
-    if (!use_standalone_insert) {
+    HandleImpl* e =
+        derived.DoInsert(proto, initial_countdown, handle != nullptr, state);
+    if (e) {
       // Successfully inserted
       if (handle) {
         *handle = e;
       }
       return Status::OK();
     }
-    // Roll back table insertion
-    Rollback(proto.hashed_key, e);
+    // Not inserted
     revert_occupancy_fn();
     // Maybe fall back on standalone insert
     if (handle == nullptr) {
@@ -568,12 +785,13 @@ Status HyperClockTable::Insert(const ClockHandleBasicData& proto,
       proto.FreeData(allocator_);
       return Status::OK();
     }
+    use_standalone_insert = true;
   }
 
   // Run standalone insert
   assert(use_standalone_insert);
 
-  *handle = StandaloneInsert(proto);
+  *handle = StandaloneInsert<HandleImpl>(proto);
 
   // The OkOverwritten status is used to count "redundant" insertions into
   // block cache. This implementation doesn't strictly check for redundant
@@ -583,13 +801,31 @@ Status HyperClockTable::Insert(const ClockHandleBasicData& proto,
   return Status::OkOverwritten();
 }
 
-HyperClockTable::HandleImpl* HyperClockTable::CreateStandalone(
+template <class Table>
+typename Table::HandleImpl* BaseClockTable::CreateStandalone(
     ClockHandleBasicData& proto, size_t capacity, bool strict_capacity_limit,
-    bool allow_uncharged) {
+    bool allow_uncharged, bool evict) {
   const size_t total_charge = proto.GetTotalCharge();
-  if (strict_capacity_limit) {
-    Status s = ChargeUsageMaybeEvictStrict(total_charge, capacity,
-                                           /*need_evict_for_occupancy=*/false);
+  if (!evict) {
+    // Charge without evicting, over capacity unless strict
+    size_t old_usage = usage_.load(std::memory_order_relaxed);
+    for (;;) {
+      if (strict_capacity_limit && old_usage + total_charge > capacity) {
+        if (allow_uncharged) {
+          proto.total_charge = 0;
+          break;
+        }
+        return nullptr;
+      }
+      if (usage_.compare_exchange_weak(old_usage, old_usage + total_charge,
+                                       std::memory_order_relaxed)) {
+        break;
+      }
+    }
+  } else if (strict_capacity_limit) {
+    Status s = ChargeUsageMaybeEvictStrict<Table>(
+        total_charge, capacity,
+        /*need_evict_for_occupancy=*/false);
     if (!s.ok()) {
       if (allow_uncharged) {
         proto.total_charge = 0;
@@ -599,183 +835,680 @@ HyperClockTable::HandleImpl* HyperClockTable::CreateStandalone(
     }
   } else {
     // Case strict_capacity_limit == false
-    bool success =
-        ChargeUsageMaybeEvictNonStrict(total_charge, capacity,
-                                       /*need_evict_for_occupancy=*/false);
+    bool success = ChargeUsageMaybeEvictNonStrict<Table>(
+        total_charge, capacity,
+        /*need_evict_for_occupancy=*/false);
     if (!success) {
       // Force the issue
       usage_.fetch_add(total_charge, std::memory_order_relaxed);
     }
   }
 
-  return StandaloneInsert(proto);
+  return StandaloneInsert<typename Table::HandleImpl>(proto);
 }
 
-HyperClockTable::HandleImpl* HyperClockTable::Lookup(
-    const UniqueId64x2& hashed_key) {
-  size_t probe = 0;
-  HandleImpl* e = FindSlot(
-      hashed_key,
-      [&](HandleImpl* h) {
-        // Mostly branch-free version (similar performance)
-        /*
-        uint64_t old_meta = h->meta.fetch_add(ClockHandle::kAcquireIncrement,
-                                     std::memory_order_acquire);
-        bool Shareable = (old_meta >> (ClockHandle::kStateShift + 1)) & 1U;
-        bool visible = (old_meta >> ClockHandle::kStateShift) & 1U;
-        bool match = (h->key == key) & visible;
-        h->meta.fetch_sub(static_cast<uint64_t>(Shareable & !match) <<
-        ClockHandle::kAcquireCounterShift, std::memory_order_release); return
-        match;
-        */
-        // Optimistic lookup should pay off when the table is relatively
-        // sparse.
-        constexpr bool kOptimisticLookup = true;
-        uint64_t old_meta;
-        if (!kOptimisticLookup) {
-          old_meta = h->meta.load(std::memory_order_acquire);
-          if ((old_meta >> ClockHandle::kStateShift) !=
-              ClockHandle::kStateVisible) {
-            return false;
-          }
-        }
-        // (Optimistically) increment acquire counter
-        old_meta = h->meta.fetch_add(ClockHandle::kAcquireIncrement,
-                                     std::memory_order_acquire);
-        // Check if it's an entry visible to lookups
-        if ((old_meta >> ClockHandle::kStateShift) ==
-            ClockHandle::kStateVisible) {
-          // Acquired a read reference
-          if (h->hashed_key == hashed_key) {
-            // Match
-            return true;
-          } else {
-            // Mismatch. Pretend we never took the reference
-            old_meta = h->meta.fetch_sub(ClockHandle::kAcquireIncrement,
-                                         std::memory_order_release);
-          }
-        } else if (UNLIKELY((old_meta >> ClockHandle::kStateShift) ==
-                            ClockHandle::kStateInvisible)) {
-          // Pretend we never took the reference
-          // WART: there's a tiny chance we release last ref to invisible
-          // entry here. If that happens, we let eviction take care of it.
-          old_meta = h->meta.fetch_sub(ClockHandle::kAcquireIncrement,
-                                       std::memory_order_release);
-        } else {
-          // For other states, incrementing the acquire counter has no effect
-          // so we don't need to undo it. Furthermore, we cannot safely undo
-          // it because we did not acquire a read reference to lock the
-          // entry in a Shareable state.
-        }
-        (void)old_meta;
-        return false;
-      },
-      [&](HandleImpl* h) {
-        return h->displacements.load(std::memory_order_relaxed) == 0;
-      },
-      [&](HandleImpl* /*h*/) {}, probe);
+void BaseClockTable::Ref(ClockHandle& h) {
+  // Increment acquire counter
+  uint64_t old_meta = h.meta.fetch_add(ClockHandle::kAcquireIncrement,
+                                       std::memory_order_acquire);
 
-  return e;
+  assert((old_meta >> ClockHandle::kStateShift) &
+         ClockHandle::kStateShareableBit);
+  // Must have already had a reference
+  assert(GetRefcount(old_meta) > 0);
+  (void)old_meta;
 }
 
-bool HyperClockTable::Release(HandleImpl* h, bool useful,
-                              bool erase_if_last_ref) {
-  // In contrast with LRUCache's Release, this function won't delete the handle
-  // when the cache is above capacity and the reference is the last one. Space
-  // is only freed up by EvictFromClock (called by Insert when space is needed)
-  // and Erase. We do this to avoid an extra atomic read of the variable usage_.
-
-  uint64_t old_meta;
-  if (useful) {
-    // Increment release counter to indicate was used
-    old_meta = h->meta.fetch_add(ClockHandle::kReleaseIncrement,
-                                 std::memory_order_release);
-  } else {
-    // Decrement acquire counter to pretend it never happened
-    old_meta = h->meta.fetch_sub(ClockHandle::kAcquireIncrement,
-                                 std::memory_order_release);
-  }
+void BaseClockTable::TEST_RefN(ClockHandle& h, size_t n) {
+  // Increment acquire counter
+  uint64_t old_meta = h.meta.fetch_add(n * ClockHandle::kAcquireIncrement,
+                                       std::memory_order_acquire);
 
   assert((old_meta >> ClockHandle::kStateShift) &
          ClockHandle::kStateShareableBit);
-  // No underflow
-  assert(((old_meta >> ClockHandle::kAcquireCounterShift) &
-          ClockHandle::kCounterMask) !=
-         ((old_meta >> ClockHandle::kReleaseCounterShift) &
-          ClockHandle::kCounterMask));
+  (void)old_meta;
+}
 
-  if (erase_if_last_ref || UNLIKELY(old_meta >> ClockHandle::kStateShift ==
-                                    ClockHandle::kStateInvisible)) {
-    // Update for last fetch_add op
-    if (useful) {
-      old_meta += ClockHandle::kReleaseIncrement;
-    } else {
-      old_meta -= ClockHandle::kAcquireIncrement;
+HyperClockTable::HyperClockTable(
+    size_t capacity, bool /*strict_capacity_limit*/,
+    CacheMetadataChargePolicy metadata_charge_policy,
+    MemoryAllocator* allocator,
+    const Cache::EvictionCallback* eviction_callback, const uint32_t* hash_seed,
+    const Opts& opts)
+    : BaseClockTable(metadata_charge_policy, allocator, eviction_callback,
+                     hash_seed),
+      length_bits_(CalcHashBits(capacity, opts.estimated_value_size,
+                                metadata_charge_policy)),
+      length_bits_mask_((size_t{1} << length_bits_) - 1),
+      occupancy_limit_(static_cast<size_t>((uint64_t{1} << length_bits_) *
+                                           kStrictLoadFactor)),
+      array_(new HandleImpl[size_t{1} << length_bits_]) {
+  if (metadata_charge_policy ==
+      CacheMetadataChargePolicy::kFullChargeCacheMetadata) {
+    usage_ += size_t{GetTableSize()} * sizeof(HandleImpl);
+  }
+
+  static_assert(sizeof(HandleImpl) == 64U,
+                "Expecting size / alignment with common cache line size");
+}
+
+HyperClockTable::~HyperClockTable() {
+  // Assumes there are no references or active operations on any slot/element
+  // in the table.
+  for (size_t i = 0; i < GetTableSize(); i++) {
+    HandleImpl& h = array_[i];
+    switch (h.meta >> ClockHandle::kStateShift) {
+      case ClockHandle::kStateEmpty:
+        // noop
+        break;
+      case ClockHandle::kStateInvisible:  // rare but possible
+      case ClockHandle::kStateVisible:
+        assert(GetRefcount(h.meta) == 0);
+        h.FreeData(allocator_);
+#ifndef NDEBUG
+        Rollback(h.hashed_key, &h);
+        ReclaimEntryUsage(h.GetTotalCharge());
+#endif
+        break;
+      // otherwise
+      default:
+        assert(false);
+        break;
     }
-    // Take ownership if no refs
-    do {
-      if (GetRefcount(old_meta) != 0) {
-        // Not last ref at some point in time during this Release call
-        // Correct for possible (but rare) overflow
-        CorrectNearOverflow(old_meta, h->meta);
+  }
+
+#ifndef NDEBUG
+  for (size_t i = 0; i < GetTableSize(); i++) {
+    assert(array_[i].displacements.load() == 0);
+  }
+#endif
+
+  assert(usage_.load() == 0 ||
+         usage_.load() == size_t{GetTableSize()} * sizeof(HandleImpl));
+  assert(occupancy_ == 0);
+}
+
+inline HyperClockTable::HandleImpl* HyperClockTable::DoInsert(
+    const ClockHandleBasicData& proto, uint64_t initial_countdown,
+    bool keep_ref, InsertState& /*state*/) {
+  bool already_matches = false;
+  size_t probe = 0;
+  HandleImpl* e = FindSlot(
+      proto.hashed_key,
+      [&](HandleImpl* h) {
+        uint64_t old_state = ClaimIfEmpty(*h);
+        if (old_state == ClockHandle::kStateEmpty) {
+          // We've started inserting into an available slot, and taken
+          // ownership Save data fields
+          ClockHandleBasicData* h_alias = h;
+          *h_alias = proto;
+          MakeSlotVisible(*h, initial_countdown, keep_ref);
+          return true;
+        } else if (old_state != ClockHandle::kStateVisible) {
+          // Slot not usable / touchable now
+          return false;
+        }
+        if (MatchAndBoostExisting(proto, *h, initial_countdown)) {
+          // Insert standalone instead (only if return handle needed)
+          already_matches = true;
+          return true;
+        }
         return false;
-      }
-      if ((old_meta & (uint64_t{ClockHandle::kStateShareableBit}
-                       << ClockHandle::kStateShift)) == 0) {
-        // Someone else took ownership
+      },
+      [&](HandleImpl* /*h*/) { return false; },
+      [&](HandleImpl* h) {
+        h->displacements.fetch_add(1, std::memory_order_relaxed);
+      },
+      probe);
+  if (e == nullptr) {
+    // Occupancy check and never abort FindSlot above should generally
+    // prevent this, except it's theoretically possible for other threads
+    // to evict and replace entries in the right order to hit every slot
+    // when it is populated. Assuming random hashing, the chance of that
+    // should be no higher than pow(kStrictLoadFactor, n) for n slots.
+    // That should be infeasible for roughly n >= 256, so if this assertion
+    // fails, that suggests something is going wrong.
+    assert(GetTableSize() < 256);
+  } else if (!already_matches) {
+    // Successfully inserted
+    return e;
+  }
+  // Roll back table insertion
+  Rollback(proto.hashed_key, e);
+  return nullptr;
+}
+
+HyperClockTable::HandleImpl* HyperClockTable::Lookup(
+    const UniqueId64x2& hashed_key) {
+  size_t probe = 0;
+  HandleImpl* e = FindSlot(
+      hashed_key,
+      [&](HandleImpl* h) { return TryAcquireVisibleMatch(*h, hashed_key); },
+      [&](HandleImpl* h) {
+        return h->displacements.load(std::memory_order_relaxed) == 0;
+      },
+      [&](HandleImpl* /*h*/) {}, probe);
+
+  return e;
+}
+
+void HyperClockTable::Prefetch(const UniqueId64x2& hashed_key) const {
+  PREFETCH(&array_[ModTableSize(hashed_key[1])], 0 /* rw */, 1 /* locality */);
+}
+
+bool HyperClockTable::Release(HandleImpl* h, bool useful,
+                              bool erase_if_last_ref) {
+  // In contrast with LRUCache's Release, this function won't delete the handle
+  // when the cache is above capacity and the reference is the last one. Space
+  // is only freed up by EvictFromClock (called by Insert when space is needed)
+  // and Erase. We do this to avoid an extra atomic read of the variable usage_.
+  if (!ReleaseMaybeTakeOwnership(*h, useful, erase_if_last_ref)) {
+    return false;
+  }
+  // Took ownership
+  size_t total_charge = h->GetTotalCharge();
+  if (UNLIKELY(h->IsStandalone())) {
+    h->FreeData(allocator_);
+    // Delete standalone handle
+    delete h;
+    standalone_usage_.fetch_sub(total_charge, std::memory_order_relaxed);
+    usage_.fetch_sub(total_charge, std::memory_order_relaxed);
+  } else {
+    Rollback(h->hashed_key, h);
+    FreeDataMarkEmpty(*h, allocator_);
+    ReclaimEntryUsage(total_charge);
+  }
+  return true;
+}
+
+void HyperClockTable::TEST_ReleaseN(HandleImpl* h, size_t n) {
+  if (n > 0) {
+    // Split into n - 1 and 1 steps.
+    uint64_t old_meta = h->meta.fetch_add(
+        (n - 1) * ClockHandle::kReleaseIncrement, std::memory_order_acquire);
+    assert((old_meta >> ClockHandle::kStateShift) &
+           ClockHandle::kStateShareableBit);
+    (void)old_meta;
+
+    Release(h, /*useful*/ true, /*erase_if_last_ref*/ false);
+  }
+}
+
+void HyperClockTable::Erase(const UniqueId64x2& hashed_key) {
+  size_t probe = 0;
+  (void)FindSlot(
+      hashed_key,
+      [&](HandleImpl* h) {
+        // Could be multiple entries in rare cases. Erase them all.
+        if (TryEraseVisibleMatch(*h, hashed_key)) {
+          // Took ownership
+          size_t total_charge = h->GetTotalCharge();
+          FreeDataMarkEmpty(*h, allocator_);
+          ReclaimEntryUsage(total_charge);
+          // We already have a copy of hashed_key in this case, so OK to
+          // delay Rollback until after releasing the entry
+          Rollback(hashed_key, h);
+        }
         return false;
+      },
+      [&](HandleImpl* h) {
+        return h->displacements.load(std::memory_order_relaxed) == 0;
+      },
+      [&](HandleImpl* /*h*/) {}, probe);
+}
+
+void HyperClockTable::ConstApplyToEntriesRange(
+    std::function<void(const HandleImpl&)> func, size_t index_begin,
+    size_t index_end, bool apply_if_will_be_deleted) const {
+  ConstApplyToEntriesRangeImpl(func, array_.get() + index_begin,
+                               array_.get() + index_end,
+                               apply_if_will_be_deleted);
+}
+
+bool HyperClockTable::GetEvictionCandidate(UniqueId64x2* victim) const {
+  uint64_t clock_pointer = clock_pointer_.load(std::memory_order_relaxed);
+  return GetEvictionCandidateImpl(
+      array_.get(), GetTableSize(),
+      [&](size_t i) { return ModTableSize(Lower32of64(clock_pointer + i)); },
+      victim);
+}
+
+void HyperClockTable::EraseUnRefEntries() {
+  for (size_t i = 0; i <= this->length_bits_mask_; i++) {
+    HandleImpl& h = array_[i];
+
+    uint64_t old_meta = h.meta.load(std::memory_order_relaxed);
+    if (old_meta & (uint64_t{ClockHandle::kStateShareableBit}
+                    << ClockHandle::kStateShift) &&
+        GetRefcount(old_meta) == 0 &&
+        h.meta.compare_exchange_strong(old_meta,
+                                       uint64_t{ClockHandle::kStateConstruction}
+                                           << ClockHandle::kStateShift,
+                                       std::memory_order_acquire)) {
+      // Took ownership
+      size_t total_charge = h.GetTotalCharge();
+      Rollback(h.hashed_key, &h);
+      FreeDataMarkEmpty(h, allocator_);
+      ReclaimEntryUsage(total_charge);
+    }
+  }
+}
+
+inline HyperClockTable::HandleImpl* HyperClockTable::FindSlot(
+    const UniqueId64x2& hashed_key, std::function<bool(HandleImpl*)> match_fn,
+    std::function<bool(HandleImpl*)> abort_fn,
+    std::function<void(HandleImpl*)> update_fn, size_t& probe) {
+  // NOTE: upper 32 bits of hashed_key[0] is used for sharding
+  //
+  // We use double-hashing probing. Every probe in the sequence is a
+  // pseudorandom integer, computed as a linear function of two random hashes,
+  // which we call base and increment. Specifically, the i-th probe is base + i
+  // * increment modulo the table size.
+  size_t base = static_cast<size_t>(hashed_key[1]);
+  // We use an odd increment, which is relatively prime with the power-of-two
+  // table size. This implies that we cycle back to the first probe only
+  // after probing every slot exactly once.
+  // TODO: we could also reconsider linear probing, though locality benefits
+  // are limited because each slot is a full cache line
+  size_t increment = static_cast<size_t>(hashed_key[0]) | 1U;
+  size_t current = ModTableSize(base + probe * increment);
+  while (probe <= length_bits_mask_) {
+    HandleImpl* h = &array_[current];
+    if (match_fn(h)) {
+      probe++;
+      return h;
+    }
+    if (abort_fn(h)) {
+      return nullptr;
+    }
+    probe++;
+    update_fn(h);
+    current = ModTableSize(current + increment);
+  }
+  // We looped back.
+  return nullptr;
+}
+
+inline void HyperClockTable::Rollback(const UniqueId64x2& hashed_key,
+                                      const HandleImpl* h) {
+  size_t current = ModTableSize(hashed_key[1]);
+  size_t increment = static_cast<size_t>(hashed_key[0]) | 1U;
+  while (&array_[current] != h) {
+    array_[current].displacements.fetch_sub(1, std::memory_order_relaxed);
+    current = ModTableSize(current + increment);
+  }
+}
+
+inline void HyperClockTable::Evict(size_t requested_charge,
+                                   size_t* freed_charge, size_t* freed_count) {
+  // precondition
+  assert(requested_charge > 0);
+
+  // TODO: make a tuning parameter?
+  constexpr size_t step_size = 4;
+
+  // First (concurrent) increment clock pointer
+  uint64_t old_clock_pointer =
+      clock_pointer_.fetch_add(step_size, std::memory_order_relaxed);
+
+  // Cap the eviction effort at this thread (along with those operating in
+  // parallel) circling through the whole structure kMaxCountdown times.
+  // In other words, this eviction run must find something/anything that is
+  // unreferenced at start of and during the eviction run that isn't reclaimed
+  // by a concurrent eviction run.
+  uint64_t max_clock_pointer =
+      old_clock_pointer + (ClockHandle::kMaxCountdown << length_bits_);
+
+  for (;;) {
+    for (size_t i = 0; i < step_size; i++) {
+      HandleImpl& h = array_[ModTableSize(Lower32of64(old_clock_pointer + i))];
+      bool evicting = ClockUpdate(h);
+      if (evicting) {
+        Rollback(h.hashed_key, &h);
+        FinishEviction(h, freed_charge, freed_count);
       }
-      // Note that there's a small chance that we release, another thread
-      // replaces this entry with another, reaches zero refs, and then we end
-      // up erasing that other entry. That's an acceptable risk / imprecision.
-    } while (!h->meta.compare_exchange_weak(
-        old_meta,
-        uint64_t{ClockHandle::kStateConstruction} << ClockHandle::kStateShift,
-        std::memory_order_acquire));
-    // Took ownership
-    size_t total_charge = h->GetTotalCharge();
-    if (UNLIKELY(h->IsStandalone())) {
-      h->FreeData(allocator_);
-      // Delete standalone handle
-      delete h;
-      standalone_usage_.fetch_sub(total_charge, std::memory_order_relaxed);
-      usage_.fetch_sub(total_charge, std::memory_order_relaxed);
+    }
+
+    // Loop exit condition
+    if (*freed_charge >= requested_charge) {
+      return;
+    }
+    if (old_clock_pointer >= max_clock_pointer) {
+      return;
+    }
+
+    // Advance clock pointer (concurrently)
+    old_clock_pointer =
+        clock_pointer_.fetch_add(step_size, std::memory_order_relaxed);
+  }
+}
+
+int HyperClockTable::CalcHashBits(
+    size_t capacity, size_t estimated_value_size,
+    CacheMetadataChargePolicy metadata_charge_policy) {
+  double average_slot_charge = estimated_value_size * kLoadFactor;
+  if (metadata_charge_policy == kFullChargeCacheMetadata) {
+    average_slot_charge += sizeof(HandleImpl);
+  }
+  assert(average_slot_charge > 0.0);
+  uint64_t num_slots =
+      static_cast<uint64_t>(capacity / average_slot_charge + 0.999999);
+
+  int hash_bits = FloorLog2((num_slots << 1) - 1);
+  if (metadata_charge_policy == kFullChargeCacheMetadata) {
+    // For very small estimated value sizes, it's possible to overshoot
+    while (hash_bits > 0 &&
+           uint64_t{sizeof(HandleImpl)} << hash_bits > capacity) {
+      hash_bits--;
+    }
+  }
+  return hash_bits;
+}
+
+AutoHyperClockTable::AutoHyperClockTable(
+    size_t capacity, bool /*strict_capacity_limit*/,
+    CacheMetadataChargePolicy metadata_charge_policy,
+    MemoryAllocator* allocator,
+    const Cache::EvictionCallback* eviction_callback, const uint32_t* hash_seed,
+    const Opts& opts)
+    : BaseClockTable(metadata_charge_policy, allocator, eviction_callback,
+                     hash_seed),
+      max_length_bits_(CalcMaxLengthBits(capacity, opts.min_avg_value_size,
+                                         metadata_charge_policy)),
+      occupancy_limit_(static_cast<size_t>((uint64_t{1} << max_length_bits_) *
+                                           kStrictLoadFactor)),
+      array_mem_(MemMapping::AllocateLazyZeroed(sizeof(HandleImpl)
+                                                << max_length_bits_)),
+      array_(static_cast<HandleImpl*>(array_mem_.Get())),
+      length_(size_t{1} << std::min(max_length_bits_, kAutoMinLengthBits)) {
+  // All-zero is the initial state of every slot: empty, heading an empty
+  // chain.
+  assert(array_ != nullptr);
+  if (metadata_charge_policy ==
+      CacheMetadataChargePolicy::kFullChargeCacheMetadata) {
+    usage_ += GetTableSize() * sizeof(HandleImpl);
+  }
+
+  static_assert(sizeof(HandleImpl) == 64U,
+                "Expecting size / alignment with common cache line size");
+}
+
+AutoHyperClockTable::~AutoHyperClockTable() {
+  // Assumes there are no references or active operations on any slot/element
+  // in the table.
+  const size_t length = GetTableSize();
+  for (size_t i = 0; i < length; i++) {
+    HandleImpl& h = array_[i];
+    switch (h.meta >> ClockHandle::kStateShift) {
+      case ClockHandle::kStateEmpty:
+        // noop
+        break;
+      case ClockHandle::kStateInvisible:  // rare but possible
+      case ClockHandle::kStateVisible:
+        assert(GetRefcount(h.meta) == 0);
+        h.FreeData(allocator_);
+#ifndef NDEBUG
+        Unlink(&h);
+        ReclaimEntryUsage(h.GetTotalCharge());
+#endif
+        break;
+      // otherwise
+      default:
+        assert(false);
+        break;
+    }
+  }
+
+#ifndef NDEBUG
+  for (size_t i = 0; i < length; i++) {
+    assert(array_[i].head.load() == 0);
+  }
+#endif
+
+  assert(usage_.load() == 0 || usage_.load() == length * sizeof(HandleImpl));
+  assert(occupancy_ == 0);
+}
+
+inline size_t AutoHyperClockTable::GetHome(const UniqueId64x2& hashed_key,
+                                           size_t length) {
+  assert(length > 0);
+  // NOTE: upper 32 bits of hashed_key[0] is used for sharding
+  int b = FloorLog2(length);
+  size_t home = static_cast<size_t>(hashed_key[1]) & ((size_t{2} << b) - 1);
+  if (home >= length) {
+    // That home has not been split off yet
+    home -= size_t{1} << b;
+  }
+  return home;
+}
+
+inline uint32_t AutoHyperClockTable::LockChain(HandleImpl& home) {
+  uint32_t head = home.head.load(std::memory_order_relaxed);
+  for (;;) {
+    if (head & kHeadLocked) {
+      // Chains are only locked for short, non-blocking chain updates
+      port::AsmVolatilePause();
+      head = home.head.load(std::memory_order_relaxed);
+    } else if (home.head.compare_exchange_weak(head, head | kHeadLocked,
+                                               std::memory_order_acquire,
+                                               std::memory_order_relaxed)) {
+      return head;
+    }
+  }
+}
+
+inline void AutoHyperClockTable::UnlockChain(HandleImpl& home, uint32_t head) {
+  assert(home.head.load(std::memory_order_relaxed) & kHeadLocked);
+  assert((head & kHeadLocked) == 0);
+  home.head.store(head, std::memory_order_release);
+}
+
+inline uint32_t AutoHyperClockTable::LockHomeChain(
+    const UniqueId64x2& hashed_key, HandleImpl** home) {
+  for (;;) {
+    HandleImpl* h = &array_[GetHome(hashed_key, GetTableSize())];
+    uint32_t head = LockChain(*h);
+    // A split of the chain while waiting for the lock might have moved the
+    // key to another home. (Only a split of this chain, which needs the
+    // lock, can do that.)
+    if (h == &array_[GetHome(hashed_key, GetTableSize())]) {
+      *home = h;
+      return head;
+    }
+    UnlockChain(*h, head);
+  }
+}
+
+inline void AutoHyperClockTable::Unlink(HandleImpl* h) {
+  HandleImpl* home;
+  uint32_t head = LockHomeChain(h->hashed_key, &home);
+  const uint32_t link = LinkOf(h);
+  // Leave h->next as is, for Lookups passing through
+  const uint32_t next = h->next.load(std::memory_order_relaxed);
+  if (head == link) {
+    UnlockChain(*home, next);
+    return;
+  }
+  bool found = false;
+  for (uint32_t prev_link = head; prev_link != 0;) {
+    HandleImpl* prev = &array_[prev_link - 1];
+    uint32_t cur = prev->next.load(std::memory_order_relaxed);
+    if (cur == link) {
+      prev->next.store(next, std::memory_order_release);
+      found = true;
+      break;
+    }
+    prev_link = cur;
+  }
+  assert(found);
+  (void)found;
+  UnlockChain(*home, head);
+}
+
+inline bool AutoHyperClockTable::GrowIfNeeded(size_t new_occupancy,
+                                              InsertState& state) {
+  size_t length = GetTableSize();
+  // Grow to keep the load factor within kLoadFactor, until the table can't
+  // grow anymore
+  while (static_cast<double>(new_occupancy) > length * kLoadFactor) {
+    if (length >= (size_t{1} << max_length_bits_)) {
+      return new_occupancy <= occupancy_limit_;
+    }
+    // Even if another thread wins the race to grow, the new slot at the end
+    // is the best place to start looking for an empty one
+    state.grown_from = std::min(state.grown_from, length);
+    Grow(length);
+    length = GetTableSize();
+  }
+  return true;
+}
+
+void AutoHyperClockTable::Grow(size_t old_length) {
+  const int b = FloorLog2(old_length);
+  const size_t split = old_length - (size_t{1} << b);
+  HandleImpl& old_home = array_[split];
+  HandleImpl& new_home = array_[old_length];
+
+  uint32_t head = LockChain(old_home);
+  if (GetTableSize() != old_length) {
+    // Another thread grew the table first
+    UnlockChain(old_home, head);
+    return;
+  }
+
+  // Entries with hash bit b set now belong to the new home. Relink them
+  // into two chains, keeping the order. Concurrent Lookups might follow a
+  // link into the other chain, which can only cause a (false) miss.
+  uint32_t heads[2] = {0, 0};
+  HandleImpl* tails[2] = {nullptr, nullptr};
+  for (uint32_t link = head; link != 0;) {
+    HandleImpl* h = &array_[link - 1];
+    uint32_t next = h->next.load(std::memory_order_relaxed);
+    assert(GetHome(h->hashed_key, old_length) == split);
+    size_t side = static_cast<size_t>(h->hashed_key[1] >> b) & 1;
+    if (tails[side] == nullptr) {
+      heads[side] = link;
     } else {
-      Rollback(h->hashed_key, h);
-      FreeDataMarkEmpty(*h, allocator_);
-      ReclaimEntryUsage(total_charge);
+      tails[side]->next.store(link, std::memory_order_release);
     }
-    return true;
-  } else {
-    // Correct for possible (but rare) overflow
-    CorrectNearOverflow(old_meta, h->meta);
-    return false;
+    tails[side] = h;
+    link = next;
+  }
+  for (HandleImpl* tail : tails) {
+    if (tail != nullptr) {
+      tail->next.store(0, std::memory_order_release);
+    }
+  }
+
+  // Publish the new chain before the new length, so that anything using
+  // the new length finds the moved entries
+  assert(new_home.head.load(std::memory_order_relaxed) == 0);
+  new_home.head.store(heads[1], std::memory_order_release);
+  if (metadata_charge_policy_ == kFullChargeCacheMetadata) {
+    usage_.fetch_add(sizeof(HandleImpl), std::memory_order_relaxed);
   }
+  length_.store(old_length + 1, std::memory_order_release);
+  UnlockChain(old_home, heads[0]);
 }
 
-void HyperClockTable::Ref(HandleImpl& h) {
-  // Increment acquire counter
-  uint64_t old_meta = h.meta.fetch_add(ClockHandle::kAcquireIncrement,
-                                       std::memory_order_acquire);
+inline AutoHyperClockTable::HandleImpl* AutoHyperClockTable::DoInsert(
+    const ClockHandleBasicData& proto, uint64_t initial_countdown,
+    bool keep_ref, InsertState& state) {
+  // Take ownership of any empty slot. Entries are found through chains, not
+  // probing, so probe pseudorandom slots rather than consecutive ones, which
+  // would cluster (the clock sweep frees slots in runs). Start with the slots
+  // just added, if any (see class comment).
+  const size_t length = GetTableSize();
+  uint64_t probe_hash = proto.hashed_key[0];
+  size_t i = state.grown_from < length ? state.grown_from
+                                       : FastRange64(probe_hash, length);
+  HandleImpl* e = nullptr;
+  for (size_t probes = 0; probes < length; ++probes) {
+    if (ClaimIfEmpty(array_[i]) == ClockHandle::kStateEmpty) {
+      e = &array_[i];
+      break;
+    }
+    // 64-bit LCG step; FastRange64 uses the (good) upper bits
+    probe_hash = probe_hash * 6364136223846793005U + 1442695040888963407U;
+    i = FastRange64(probe_hash, length);
+  }
+  if (e == nullptr) {
+    // Occupancy limit should generally prevent this (see
+    // HyperClockTable::DoInsert)
+    return nullptr;
+  }
+  // Save data fields before linking, because writers holding the chain lock
+  // rely on the hashed_key of every entry in the chain
+  ClockHandleBasicData* e_alias = e;
+  *e_alias = proto;
+
+  HandleImpl* home;
+  uint32_t head = LockHomeChain(proto.hashed_key, &home);
+  // Like HyperClockTable, don't insert if the key already has a visible
+  // entry (boosting that one instead)
+  for (uint32_t link = head; link != 0;) {
+    HandleImpl* h = &array_[link - 1];
+    if (MatchAndBoostExisting(proto, *h, initial_countdown)) {
+      UnlockChain(*home, head);
+      // Give back the slot
+      MarkEmpty(*e);
+      return nullptr;
+    }
+    link = h->next.load(std::memory_order_relaxed);
+  }
+  e->next.store(head, std::memory_order_relaxed);
+  UnlockChain(*home, LinkOf(e));
+  // Only reachable from Lookup once linked
+  MakeSlotVisible(*e, initial_countdown, keep_ref);
+  return e;
+}
 
-  assert((old_meta >> ClockHandle::kStateShift) &
-         ClockHandle::kStateShareableBit);
-  // Must have already had a reference
-  assert(GetRefcount(old_meta) > 0);
-  (void)old_meta;
+AutoHyperClockTable::HandleImpl* AutoHyperClockTable::Lookup(
+    const UniqueId64x2& hashed_key) {
+  const size_t length = GetTableSize();
+  uint32_t link = array_[GetHome(hashed_key, length)].head.load(
+                      std::memory_order_acquire) &
+                  ~kHeadLocked;
+  // The walk is bounded in case concurrent removal and reuse of slots we
+  // pass through links them (transiently) into a cycle
+  for (size_t steps = 0; link != 0 && steps < length; ++steps) {
+    HandleImpl* h = &array_[link - 1];
+    if (TryAcquireVisibleMatch(*h, hashed_key)) {
+      return h;
+    }
+    link = h->next.load(std::memory_order_acquire);
+  }
+  return nullptr;
 }
 
-void HyperClockTable::TEST_RefN(HandleImpl& h, size_t n) {
-  // Increment acquire counter
-  uint64_t old_meta = h.meta.fetch_add(n * ClockHandle::kAcquireIncrement,
-                                       std::memory_order_acquire);
+void AutoHyperClockTable::Prefetch(const UniqueId64x2& hashed_key) const {
+  PREFETCH(&array_[GetHome(hashed_key, GetTableSize())], 0 /* rw */,
+           1 /* locality */);
+}
 
-  assert((old_meta >> ClockHandle::kStateShift) &
-         ClockHandle::kStateShareableBit);
-  (void)old_meta;
+bool AutoHyperClockTable::Release(HandleImpl* h, bool useful,
+                                  bool erase_if_last_ref) {
+  // See HyperClockTable::Release
+  if (!ReleaseMaybeTakeOwnership(*h, useful, erase_if_last_ref)) {
+    return false;
+  }
+  // Took ownership
+  size_t total_charge = h->GetTotalCharge();
+  if (UNLIKELY(h->IsStandalone())) {
+    h->FreeData(allocator_);
+    // Delete standalone handle
+    delete h;
+    standalone_usage_.fetch_sub(total_charge, std::memory_order_relaxed);
+    usage_.fetch_sub(total_charge, std::memory_order_relaxed);
+  } else {
+    Unlink(h);
+    FreeDataMarkEmpty(*h, allocator_);
+    ReclaimEntryUsage(total_charge);
+  }
+  return true;
 }
 
-void HyperClockTable::TEST_ReleaseN(HandleImpl* h, size_t n) {
+void AutoHyperClockTable::TEST_ReleaseN(HandleImpl* h, size_t n) {
   if (n > 0) {
     // Split into n - 1 and 1 steps.
     uint64_t old_meta = h->meta.fetch_add(
@@ -788,120 +1521,63 @@ void HyperClockTable::TEST_ReleaseN(HandleImpl* h, size_t n) {
   }
 }
 
-void HyperClockTable::Erase(const UniqueId64x2& hashed_key) {
-  size_t probe = 0;
-  (void)FindSlot(
-      hashed_key,
-      [&](HandleImpl* h) {
-        // Could be multiple entries in rare cases. Erase them all.
-        // Optimistically increment acquire counter
-        uint64_t old_meta = h->meta.fetch_add(ClockHandle::kAcquireIncrement,
-                                              std::memory_order_acquire);
-        // Check if it's an entry visible to lookups
-        if ((old_meta >> ClockHandle::kStateShift) ==
-            ClockHandle::kStateVisible) {
-          // Acquired a read reference
-          if (h->hashed_key == hashed_key) {
-            // Match. Set invisible.
-            old_meta =
-                h->meta.fetch_and(~(uint64_t{ClockHandle::kStateVisibleBit}
-                                    << ClockHandle::kStateShift),
-                                  std::memory_order_acq_rel);
-            // Apply update to local copy
-            old_meta &= ~(uint64_t{ClockHandle::kStateVisibleBit}
-                          << ClockHandle::kStateShift);
-            for (;;) {
-              uint64_t refcount = GetRefcount(old_meta);
-              assert(refcount > 0);
-              if (refcount > 1) {
-                // Not last ref at some point in time during this Erase call
-                // Pretend we never took the reference
-                h->meta.fetch_sub(ClockHandle::kAcquireIncrement,
-                                  std::memory_order_release);
-                break;
-              } else if (h->meta.compare_exchange_weak(
-                             old_meta,
-                             uint64_t{ClockHandle::kStateConstruction}
-                                 << ClockHandle::kStateShift,
-                             std::memory_order_acq_rel)) {
-                // Took ownership
-                assert(hashed_key == h->hashed_key);
-                size_t total_charge = h->GetTotalCharge();
-                FreeDataMarkEmpty(*h, allocator_);
-                ReclaimEntryUsage(total_charge);
-                // We already have a copy of hashed_key in this case, so OK to
-                // delay Rollback until after releasing the entry
-                Rollback(hashed_key, h);
-                break;
-              }
-            }
-          } else {
-            // Mismatch. Pretend we never took the reference
-            h->meta.fetch_sub(ClockHandle::kAcquireIncrement,
-                              std::memory_order_release);
-          }
-        } else if (UNLIKELY((old_meta >> ClockHandle::kStateShift) ==
-                            ClockHandle::kStateInvisible)) {
-          // Pretend we never took the reference
-          // WART: there's a tiny chance we release last ref to invisible
-          // entry here. If that happens, we let eviction take care of it.
-          h->meta.fetch_sub(ClockHandle::kAcquireIncrement,
-                            std::memory_order_release);
+void AutoHyperClockTable::Erase(const UniqueId64x2& hashed_key) {
+  // Unlike Lookup, walk the chain under its lock, as a split of the chain
+  // or reuse of a slot we pass through could otherwise make us miss the
+  // entry and leave it in the cache. (Both need the lock: a slot is only
+  // reused after being unlinked.) Could be multiple entries in rare cases.
+  // Erase them one at a time, freeing each outside of the lock.
+  for (;;) {
+    HandleImpl* home;
+    uint32_t head = LockHomeChain(hashed_key, &home);
+    HandleImpl* erased = nullptr;
+    HandleImpl* prev = nullptr;
+    for (uint32_t link = head; link != 0;) {
+      HandleImpl* h = &array_[link - 1];
+      const uint32_t next = h->next.load(std::memory_order_relaxed);
+      if (TryEraseVisibleMatch(*h, hashed_key)) {
+        // Took ownership. Unlink as in Unlink(), leaving h->next as is for
+        // Lookups passing through.
+        if (prev == nullptr) {
+          head = next;
         } else {
-          // For other states, incrementing the acquire counter has no effect
-          // so we don't need to undo it.
+          prev->next.store(next, std::memory_order_release);
         }
-        return false;
-      },
-      [&](HandleImpl* h) {
-        return h->displacements.load(std::memory_order_relaxed) == 0;
-      },
-      [&](HandleImpl* /*h*/) {}, probe);
+        erased = h;
+        break;
+      }
+      prev = h;
+      link = next;
+    }
+    UnlockChain(*home, head);
+    if (erased == nullptr) {
+      return;
+    }
+    size_t total_charge = erased->GetTotalCharge();
+    FreeDataMarkEmpty(*erased, allocator_);
+    ReclaimEntryUsage(total_charge);
+  }
 }
 
-void HyperClockTable::ConstApplyToEntriesRange(
+void AutoHyperClockTable::ConstApplyToEntriesRange(
     std::function<void(const HandleImpl&)> func, size_t index_begin,
     size_t index_end, bool apply_if_will_be_deleted) const {
-  uint64_t check_state_mask = ClockHandle::kStateShareableBit;
-  if (!apply_if_will_be_deleted) {
-    check_state_mask |= ClockHandle::kStateVisibleBit;
-  }
-
-  for (size_t i = index_begin; i < index_end; i++) {
-    HandleImpl& h = array_[i];
+  index_end = std::min(index_end, GetTableSize());
+  ConstApplyToEntriesRangeImpl(func, array_ + index_begin, array_ + index_end,
+                               apply_if_will_be_deleted);
+}
 
-    // Note: to avoid using compare_exchange, we have to be extra careful.
-    uint64_t old_meta = h.meta.load(std::memory_order_relaxed);
-    // Check if it's an entry visible to lookups
-    if ((old_meta >> ClockHandle::kStateShift) & check_state_mask) {
-      // Increment acquire counter. Note: it's possible that the entry has
-      // completely changed since we loaded old_meta, but incrementing acquire
-      // count is always safe. (Similar to optimistic Lookup here.)
-      old_meta = h.meta.fetch_add(ClockHandle::kAcquireIncrement,
-                                  std::memory_order_acquire);
-      // Check whether we actually acquired a reference.
-      if ((old_meta >> ClockHandle::kStateShift) &
-          ClockHandle::kStateShareableBit) {
-        // Apply func if appropriate
-        if ((old_meta >> ClockHandle::kStateShift) & check_state_mask) {
-          func(h);
-        }
-        // Pretend we never took the reference
-        h.meta.fetch_sub(ClockHandle::kAcquireIncrement,
-                         std::memory_order_release);
-        // No net change, so don't need to check for overflow
-      } else {
-        // For other states, incrementing the acquire counter has no effect
-        // so we don't need to undo it. Furthermore, we cannot safely undo
-        // it because we did not acquire a read reference to lock the
-        // entry in a Shareable state.
-      }
-    }
-  }
+bool AutoHyperClockTable::GetEvictionCandidate(UniqueId64x2* victim) const {
+  const size_t length = GetTableSize();
+  uint64_t clock_pointer = clock_pointer_.load(std::memory_order_relaxed);
+  return GetEvictionCandidateImpl(
+      array_, length, [&](size_t i) { return (clock_pointer + i) % length; },
+      victim);
 }
 
-void HyperClockTable::EraseUnRefEntries() {
-  for (size_t i = 0; i <= this->length_bits_mask_; i++) {
+void AutoHyperClockTable::EraseUnRefEntries() {
+  const size_t length = GetTableSize();
+  for (size_t i = 0; i < length; i++) {
     HandleImpl& h = array_[i];
 
     uint64_t old_meta = h.meta.load(std::memory_order_relaxed);
@@ -914,111 +1590,40 @@ void HyperClockTable::EraseUnRefEntries() {
                                        std::memory_order_acquire)) {
       // Took ownership
       size_t total_charge = h.GetTotalCharge();
-      Rollback(h.hashed_key, &h);
+      Unlink(&h);
       FreeDataMarkEmpty(h, allocator_);
       ReclaimEntryUsage(total_charge);
     }
   }
 }
 
-inline HyperClockTable::HandleImpl* HyperClockTable::FindSlot(
-    const UniqueId64x2& hashed_key, std::function<bool(HandleImpl*)> match_fn,
-    std::function<bool(HandleImpl*)> abort_fn,
-    std::function<void(HandleImpl*)> update_fn, size_t& probe) {
-  // NOTE: upper 32 bits of hashed_key[0] is used for sharding
-  //
-  // We use double-hashing probing. Every probe in the sequence is a
-  // pseudorandom integer, computed as a linear function of two random hashes,
-  // which we call base and increment. Specifically, the i-th probe is base + i
-  // * increment modulo the table size.
-  size_t base = static_cast<size_t>(hashed_key[1]);
-  // We use an odd increment, which is relatively prime with the power-of-two
-  // table size. This implies that we cycle back to the first probe only
-  // after probing every slot exactly once.
-  // TODO: we could also reconsider linear probing, though locality benefits
-  // are limited because each slot is a full cache line
-  size_t increment = static_cast<size_t>(hashed_key[0]) | 1U;
-  size_t current = ModTableSize(base + probe * increment);
-  while (probe <= length_bits_mask_) {
-    HandleImpl* h = &array_[current];
-    if (match_fn(h)) {
-      probe++;
-      return h;
-    }
-    if (abort_fn(h)) {
-      return nullptr;
-    }
-    probe++;
-    update_fn(h);
-    current = ModTableSize(current + increment);
-  }
-  // We looped back.
-  return nullptr;
-}
-
-inline void HyperClockTable::Rollback(const UniqueId64x2& hashed_key,
-                                      const HandleImpl* h) {
-  size_t current = ModTableSize(hashed_key[1]);
-  size_t increment = static_cast<size_t>(hashed_key[0]) | 1U;
-  while (&array_[current] != h) {
-    array_[current].displacements.fetch_sub(1, std::memory_order_relaxed);
-    current = ModTableSize(current + increment);
-  }
-}
-
-inline void HyperClockTable::ReclaimEntryUsage(size_t total_charge) {
-  auto old_occupancy = occupancy_.fetch_sub(1U, std::memory_order_release);
-  (void)old_occupancy;
-  // No underflow
-  assert(old_occupancy > 0);
-  auto old_usage = usage_.fetch_sub(total_charge, std::memory_order_relaxed);
-  (void)old_usage;
-  // No underflow
-  assert(old_usage >= total_charge);
-}
-
-inline void HyperClockTable::Evict(size_t requested_charge,
-                                   size_t* freed_charge, size_t* freed_count) {
+inline void AutoHyperClockTable::Evict(size_t requested_charge,
+                                       size_t* freed_charge,
+                                       size_t* freed_count) {
   // precondition
   assert(requested_charge > 0);
 
   // TODO: make a tuning parameter?
   constexpr size_t step_size = 4;
 
+  // Slots added by concurrent growth are left for the next eviction
+  const size_t length = GetTableSize();
+
   // First (concurrent) increment clock pointer
   uint64_t old_clock_pointer =
       clock_pointer_.fetch_add(step_size, std::memory_order_relaxed);
 
-  // Cap the eviction effort at this thread (along with those operating in
-  // parallel) circling through the whole structure kMaxCountdown times.
-  // In other words, this eviction run must find something/anything that is
-  // unreferenced at start of and during the eviction run that isn't reclaimed
-  // by a concurrent eviction run.
+  // Cap the eviction effort as in HyperClockTable::Evict
   uint64_t max_clock_pointer =
-      old_clock_pointer + (ClockHandle::kMaxCountdown << length_bits_);
-
-  // For key reconstructed from hash
-  UniqueId64x2 unhashed;
+      old_clock_pointer + uint64_t{ClockHandle::kMaxCountdown} * length;
 
   for (;;) {
     for (size_t i = 0; i < step_size; i++) {
-      HandleImpl& h = array_[ModTableSize(Lower32of64(old_clock_pointer + i))];
+      HandleImpl& h = array_[(old_clock_pointer + i) % length];
       bool evicting = ClockUpdate(h);
       if (evicting) {
-        Rollback(h.hashed_key, &h);
-        *freed_charge += h.GetTotalCharge();
-        *freed_count += 1;
-        bool took_ownership = false;
-        if (eviction_callback_) {
-          took_ownership =
-              eviction_callback_(ClockCacheShard<HyperClockTable>::ReverseHash(
-                                     h.GetHash(), &unhashed, hash_seed_),
-                                 reinterpret_cast<Cache::Handle*>(&h));
-        }
-        if (!took_ownership) {
-          h.FreeData(allocator_);
-        }
-        MarkEmpty(h);
+        Unlink(&h);
+        FinishEviction(h, freed_charge, freed_count);
       }
     }
 
@@ -1036,6 +1641,29 @@ inline void HyperClockTable::Evict(size_t requested_charge,
   }
 }
 
+int AutoHyperClockTable::CalcMaxLengthBits(
+    size_t capacity, size_t min_avg_value_size,
+    CacheMetadataChargePolicy metadata_charge_policy) {
+  double average_slot_charge =
+      std::max(min_avg_value_size, size_t{1}) * kLoadFactor;
+  if (metadata_charge_policy == kFullChargeCacheMetadata) {
+    average_slot_charge += sizeof(HandleImpl);
+  }
+  uint64_t num_slots = std::max(
+      uint64_t{1},
+      static_cast<uint64_t>(capacity / average_slot_charge + 0.999999));
+
+  int length_bits = FloorLog2((num_slots << 1) - 1);
+  if (metadata_charge_policy == kFullChargeCacheMetadata) {
+    // For very small average value sizes, it's possible to overshoot
+    while (length_bits > 0 &&
+           uint64_t{sizeof(HandleImpl)} << length_bits > capacity) {
+      length_bits--;
+    }
+  }
+  return std::min(length_bits, kAutoMaxLengthBits);
+}
+
 template <class Table>
 ClockCacheShard<Table>::ClockCacheShard(
     size_t capacity, bool strict_capacity_limit,
@@ -1094,28 +1722,6 @@ void ClockCacheShard<Table>::ApplyToSomeEntries(
       index_begin, index_end, false);
 }
 
-int HyperClockTable::CalcHashBits(
-    size_t capacity, size_t estimated_value_size,
-    CacheMetadataChargePolicy metadata_charge_policy) {
-  double average_slot_charge = estimated_value_size * kLoadFactor;
-  if (metadata_charge_policy == kFullChargeCacheMetadata) {
-    average_slot_charge += sizeof(HandleImpl);
-  }
-  assert(average_slot_charge > 0.0);
-  uint64_t num_slots =
-      static_cast<uint64_t>(capacity / average_slot_charge + 0.999999);
-
-  int hash_bits = FloorLog2((num_slots << 1) - 1);
-  if (metadata_charge_policy == kFullChargeCacheMetadata) {
-    // For very small estimated value sizes, it's possible to overshoot
-    while (hash_bits > 0 &&
-           uint64_t{sizeof(HandleImpl)} << hash_bits > capacity) {
-      hash_bits--;
-    }
-  }
-  return hash_bits;
-}
-
 template <class Table>
 void ClockCacheShard<Table>::SetCapacity(size_t capacity) {
   capacity_.store(capacity, std::memory_order_relaxed);
@@ -1146,9 +1752,9 @@ Status ClockCacheShard<Table>::Insert(const Slice& key,
   proto.value = value;
   proto.helper = helper;
   proto.total_charge = charge;
-  return table_.Insert(proto, handle, priority,
-                       capacity_.load(std::memory_order_relaxed),
-                       strict_capacity_limit_.load(std::memory_order_relaxed));
+  return table_.template Insert<Table>(
+      proto, handle, priority, capacity_.load(std::memory_order_relaxed),
+      strict_capacity_limit_.load(std::memory_order_relaxed));
 }
 
 template <class Table>
@@ -1157,7 +1763,8 @@ ClockCacheShard<Table>::CreateStandalone(const Slice& key,
                                          const UniqueId64x2& hashed_key,
                                          Cache::ObjectPtr obj,
                                          const Cache::CacheItemHelper* helper,
-                                         size_t charge, bool allow_uncharged) {
+                                         size_t charge, bool allow_uncharged,
+                                         bool evict) {
   if (UNLIKELY(key.size() != kCacheKeySize)) {
     return nullptr;
   }
@@ -1166,9 +1773,10 @@ ClockCacheShard<Table>::CreateStandalone(const Slice& key,
   proto.value = obj;
   proto.helper = helper;
   proto.total_charge = charge;
-  return table_.CreateStandalone(
+  return table_.template CreateStandalone<Table>(
       proto, capacity_.load(std::memory_order_relaxed),
-      strict_capacity_limit_.load(std::memory_order_relaxed), allow_uncharged);
+      strict_capacity_limit_.load(std::memory_order_relaxed), allow_uncharged,
+      evict);
 }
 
 template <class Table>
@@ -1223,6 +1831,35 @@ void ClockCacheShard<Table>::Erase(const Slice& key,
   table_.Erase(hashed_key);
 }
 
+template <class Table>
+void ClockCacheShard<Table>::MultiLookup(const Slice* const* keys,
+                                         const UniqueId64x2* hashed_keys,
+                                         size_t n, HandleImpl** results) {
+  for (size_t i = 0; i < n; ++i) {
+    table_.Prefetch(hashed_keys[i]);
+  }
+  for (size_t i = 0; i < n; ++i) {
+    results[i] = Lookup(*keys[i], hashed_keys[i]);
+  }
+}
+
+template <class Table>
+void ClockCacheShard<Table>::MultiRelease(HandleImpl* const* handles, size_t n,
+                                          bool useful) {
+  for (size_t i = 0; i < n; ++i) {
+    Release(handles[i], useful, /*erase_if_last_ref=*/false);
+  }
+}
+
+template <class Table>
+bool ClockCacheShard<Table>::PeekEvictionCandidate(size_t charge,
+                                                   UniqueId64x2* victim) {
+  if (table_.GetUsage() + charge <= capacity_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  return table_.GetEvictionCandidate(victim);
+}
+
 template <class Table>
 size_t ClockCacheShard<Table>::GetUsage() const {
   return table_.GetUsage();
@@ -1284,9 +1921,38 @@ size_t ClockCacheShard<Table>::GetTableAddressCount() const {
 
 // Explicit instantiation
 template class ClockCacheShard<HyperClockTable>;
+template class ClockCacheShard<AutoHyperClockTable>;
+
+
+template <class Table>
+BaseHyperClockCache<Table>::BaseHyperClockCache(
+    const HyperClockCacheOptions& opts)
+    : ShardedCache<ClockCacheShard<Table>>(opts) {}
+
+template <class Table>
+Cache::ObjectPtr BaseHyperClockCache<Table>::Value(Handle* handle) {
+  return reinterpret_cast<const typename Table::HandleImpl*>(handle)->value;
+}
+
+template <class Table>
+size_t BaseHyperClockCache<Table>::GetCharge(Handle* handle) const {
+  return reinterpret_cast<const typename Table::HandleImpl*>(handle)
+      ->GetTotalCharge();
+}
+
+template <class Table>
+const Cache::CacheItemHelper* BaseHyperClockCache<Table>::GetCacheItemHelper(
+    Handle* handle) const {
+  auto h = reinterpret_cast<const typename Table::HandleImpl*>(handle);
+  return h->helper;
+}
+
+// Explicit instantiation
+template class BaseHyperClockCache<HyperClockTable>;
+template class BaseHyperClockCache<AutoHyperClockTable>;
 
 HyperClockCache::HyperClockCache(const HyperClockCacheOptions& opts)
-    : ShardedCache(opts) {
+    : BaseHyperClockCache(opts) {
   assert(opts.estimated_entry_charge > 0 ||
          opts.metadata_charge_policy != kDontChargeCacheMetadata);
   // TODO: should not need to go through two levels of pointer indirection to
@@ -1302,18 +1968,17 @@ HyperClockCache::HyperClockCache(const HyperClockCacheOptions& opts)
   });
 }
 
-Cache::ObjectPtr HyperClockCache::Value(Handle* handle) {
-  return reinterpret_cast<const HandleImpl*>(handle)->value;
-}
-
-size_t HyperClockCache::GetCharge(Handle* handle) const {
-  return reinterpret_cast<const HandleImpl*>(handle)->GetTotalCharge();
-}
-
-const Cache::CacheItemHelper* HyperClockCache::GetCacheItemHelper(
-    Handle* handle) const {
-  auto h = reinterpret_cast<const HandleImpl*>(handle);
-  return h->helper;
+AutoHyperClockCache::AutoHyperClockCache(const HyperClockCacheOptions& opts)
+    : BaseHyperClockCache(opts) {
+  size_t per_shard = GetPerShardCapacity();
+  MemoryAllocator* alloc = this->memory_allocator();
+  InitShards([&](Shard* cs) {
+    AutoHyperClockTable::Opts table_opts;
+    table_opts.min_avg_value_size = opts.min_avg_entry_charge;
+    new (cs) Shard(per_shard, opts.strict_capacity_limit,
+                   opts.metadata_charge_policy, alloc, &eviction_callback_,
+                   &hash_seed_, table_opts);
+  });
 }
 
 namespace {
@@ -1445,6 +2110,33 @@ void HyperClockCache::ReportProblems(
   }
 }
 
+void AutoHyperClockCache::ReportProblems(
+    const std::shared_ptr<Logger>& info_log) const {
+  // The table grows to fit entries as long as it can, so the only problem to
+  // report is the table reaching its maximum size, with occupancy limiting
+  // usage well below capacity.
+  uint32_t shard_count = GetNumShards();
+  int full_count = 0;
+  size_t min_recommendation = SIZE_MAX;
+  const_cast<AutoHyperClockCache*>(this)->ForEachShard([&](Shard* shard) {
+    size_t usage = shard->GetUsage() - shard->GetStandaloneUsage();
+    size_t occupancy = shard->GetOccupancyCount();
+    if (occupancy > 0 && occupancy >= shard->GetOccupancyLimit() * 0.95 &&
+        usage < shard->GetCapacity() * 0.8) {
+      ++full_count;
+      min_recommendation = std::min(min_recommendation, usage / occupancy);
+    }
+  });
+  if (full_count > 0) {
+    ROCKS_LOG_WARN(
+        info_log,
+        "AutoHyperClockCache@%p unable to use full capacity because the table "
+        "reached its maximum size in %d/%u cache shards (min_avg_entry_charge "
+        "too high). Recommend min_avg_entry_charge=%zu",
+        this, full_count, (unsigned)shard_count, min_recommendation);
+  }
+}
+
 }  // namespace clock_cache
 
 // DEPRECATED (see public API)
@@ -1470,8 +2162,12 @@ std::shared_ptr<Cache> HyperClockCacheOptions::MakeSharedCache() const {
     opts.num_shard_bits =
         GetDefaultCacheShardBits(opts.capacity, min_shard_size);
   }
-  std::shared_ptr<Cache> cache =
-      std::make_shared<clock_cache::HyperClockCache>(opts);
+  std::shared_ptr<Cache> cache;
+  if (opts.estimated_entry_charge == 0) {
+    cache = std::make_shared<clock_cache::AutoHyperClockCache>(opts);
+  } else {
+    cache = std::make_shared<clock_cache::HyperClockCache>(opts);
+  }
   if (opts.secondary_cache) {
     cache = std::make_shared<CacheWithSecondaryAdapter>(cache,
                                                         opts.secondary_cache);
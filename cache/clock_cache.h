@@ -20,6 +20,7 @@
 #include "cache/sharded_cache.h"
 #include "port/lang.h"
 #include "port/malloc.h"
+#include "port/mmap.h"
 #include "port/port.h"
 #include "rocksdb/cache.h"
 #include "rocksdb/secondary_cache.h"
@@ -49,7 +50,10 @@ class ClockCacheTest;
 // -----
 // * Hash table is not resizable (for lock-free efficiency) so capacity is not
 // dynamically changeable. Rely on an estimated average value (block) size for
-// space+time efficiency. (See estimated_entry_charge option details.)
+// space+time efficiency. (See estimated_entry_charge option details.) With
+// estimated_entry_charge=0, AutoHyperClockTable is used instead, which grows
+// incrementally without an estimate, at the cost of chain locks for writers
+// and an extra indirection for readers. (See AutoHyperClockTable below.)
 // * Insert usually does not (but might) overwrite a previous entry associated
 // with a cache key. This is OK for RocksDB uses of Cache.
 // * Only supports keys of exactly 16 bytes, which is what RocksDB uses for
@@ -378,7 +382,130 @@ struct ClockHandle : public ClockHandleBasicData {
   void* reserved_for_future_use = nullptr;
 };  // struct ClockHandle
 
-class HyperClockTable {
+// Shared logic and state for HyperClockTable and AutoHyperClockTable: usage
+// and occupancy accounting, charging with eviction, and standalone handles.
+// Table-specific operations are reached through the `Table` template
+// parameter of the member function templates, which must be the derived
+// table class.
+class BaseClockTable {
+ public:
+  BaseClockTable(CacheMetadataChargePolicy metadata_charge_policy,
+                 MemoryAllocator* allocator,
+                 const Cache::EvictionCallback* eviction_callback,
+                 const uint32_t* hash_seed)
+      : metadata_charge_policy_(metadata_charge_policy),
+        allocator_(allocator),
+        eviction_callback_(*eviction_callback),
+        hash_seed_(*hash_seed) {}
+
+  template <class Table>
+  typename Table::HandleImpl* CreateStandalone(ClockHandleBasicData& proto,
+                                               size_t capacity,
+                                               bool strict_capacity_limit,
+                                               bool allow_uncharged,
+                                               bool evict);
+
+  template <class Table>
+  Status Insert(const ClockHandleBasicData& proto,
+                typename Table::HandleImpl** handle, Cache::Priority priority,
+                size_t capacity, bool strict_capacity_limit);
+
+  void Ref(ClockHandle& handle);
+
+  size_t GetOccupancy() const {
+    return occupancy_.load(std::memory_order_relaxed);
+  }
+
+  size_t GetUsage() const { return usage_.load(std::memory_order_relaxed); }
+
+  size_t GetStandaloneUsage() const {
+    return standalone_usage_.load(std::memory_order_relaxed);
+  }
+
+  uint32_t GetHashSeed() const { return hash_seed_; }
+
+  // Acquire N references
+  void TEST_RefN(ClockHandle& handle, size_t n);
+
+ protected:  // functions
+  // Subtracts `total_charge` from `usage_` and 1 from `occupancy_`.
+  // Ideally this comes after releasing the entry itself so that we
+  // actually have the available occupancy/usage that is claimed.
+  // However, that means total_charge has to be saved from the handle
+  // before releasing it so that it can be provided to this function.
+  inline void ReclaimEntryUsage(size_t total_charge);
+
+  // Helper for updating `usage_` for new entry with given `total_charge`
+  // and evicting if needed under strict_capacity_limit=true rules. This
+  // means the operation might fail with Status::MemoryLimit. If
+  // `need_evict_for_occupancy`, then eviction of at least one entry is
+  // required, and the operation should fail if not possible.
+  // NOTE: Otherwise, occupancy_ is not managed in this function
+  template <class Table>
+  inline Status ChargeUsageMaybeEvictStrict(size_t total_charge,
+                                            size_t capacity,
+                                            bool need_evict_for_occupancy);
+
+  // Helper for updating `usage_` for new entry with given `total_charge`
+  // and evicting if needed under strict_capacity_limit=false rules. This
+  // means that updating `usage_` always succeeds even if forced to exceed
+  // capacity. If `need_evict_for_occupancy`, then eviction of at least one
+  // entry is required, and the operation should return false if such eviction
+  // is not possible. `usage_` is not updated in that case. Otherwise, returns
+  // true, indicating success.
+  // NOTE: occupancy_ is not managed in this function
+  template <class Table>
+  inline bool ChargeUsageMaybeEvictNonStrict(size_t total_charge,
+                                             size_t capacity,
+                                             bool need_evict_for_occupancy);
+
+  // Creates a "standalone" handle for returning from an Insert operation that
+  // cannot be completed by actually inserting into the table.
+  // Updates `standalone_usage_` but not `usage_` nor `occupancy_`.
+  template <class HandleImpl>
+  inline HandleImpl* StandaloneInsert(const ClockHandleBasicData& proto);
+
+  // Completes the eviction of an entry the clock update took ownership of
+  // (and that is no longer reachable in the table): counts it in the
+  // eviction totals, hands it to the eviction callback or frees it, and
+  // marks the slot empty.
+  inline void FinishEviction(ClockHandle& h, size_t* freed_charge,
+                             size_t* freed_count);
+
+  MemoryAllocator* GetAllocator() const { return allocator_; }
+
+ protected:  // data
+  const CacheMetadataChargePolicy metadata_charge_policy_;
+
+  // From Cache, for deleter
+  MemoryAllocator* const allocator_;
+
+  // A reference to Cache::eviction_callback_
+  const Cache::EvictionCallback& eviction_callback_;
+
+  // A reference to ShardedCacheBase::hash_seed_
+  const uint32_t& hash_seed_;
+
+  // We partition the following members into different cache lines
+  // to avoid false sharing among Lookup, Release, Erase and Insert
+  // operations in ClockCacheShard.
+
+  ALIGN_AS(CACHE_LINE_SIZE)
+  // Clock algorithm sweep pointer.
+  std::atomic<uint64_t> clock_pointer_{};
+
+  ALIGN_AS(CACHE_LINE_SIZE)
+  // Number of elements in the table.
+  std::atomic<size_t> occupancy_{};
+
+  // Memory usage by entries tracked by the cache (including standalone)
+  std::atomic<size_t> usage_{};
+
+  // Part of usage by standalone entries (not in table)
+  std::atomic<size_t> standalone_usage_{};
+};  // class BaseClockTable
+
+class HyperClockTable : public BaseClockTable {
  public:
   // Target size to be exactly a common cache line size (see static_assert in
   // clock_cache.cc)
@@ -410,19 +537,12 @@ class HyperClockTable {
                   const uint32_t* hash_seed, const Opts& opts);
   ~HyperClockTable();
 
-  Status Insert(const ClockHandleBasicData& proto, HandleImpl** handle,
-                Cache::Priority priority, size_t capacity,
-                bool strict_capacity_limit);
-
-  HandleImpl* CreateStandalone(ClockHandleBasicData& proto, size_t capacity,
-                               bool strict_capacity_limit,
-                               bool allow_uncharged);
-
   HandleImpl* Lookup(const UniqueId64x2& hashed_key);
 
-  bool Release(HandleImpl* handle, bool useful, bool erase_if_last_ref);
+  // Prefetches the first slot probed by Lookup
+  void Prefetch(const UniqueId64x2& hashed_key) const;
 
-  void Ref(HandleImpl& handle);
+  bool Release(HandleImpl* handle, bool useful, bool erase_if_last_ref);
 
   void Erase(const UniqueId64x2& hashed_key);
 
@@ -432,34 +552,43 @@ class HyperClockTable {
 
   void EraseUnRefEntries();
 
+  // Sets *victim to the hashed key of an entry the clock would soon evict,
+  // if one is found near the clock pointer, for cache admission
+  bool GetEvictionCandidate(UniqueId64x2* victim) const;
+
   size_t GetTableSize() const { return size_t{1} << length_bits_; }
 
   int GetLengthBits() const { return length_bits_; }
 
-  size_t GetOccupancy() const {
-    return occupancy_.load(std::memory_order_relaxed);
-  }
-
   size_t GetOccupancyLimit() const { return occupancy_limit_; }
 
-  size_t GetUsage() const { return usage_.load(std::memory_order_relaxed); }
-
-  size_t GetStandaloneUsage() const {
-    return standalone_usage_.load(std::memory_order_relaxed);
-  }
-
-  uint32_t GetHashSeed() const { return hash_seed_; }
-
-  // Acquire/release N references
-  void TEST_RefN(HandleImpl& handle, size_t n);
+  // Release N references
   void TEST_ReleaseN(HandleImpl* handle, size_t n);
 
  private:  // functions
+  friend class BaseClockTable;
+
   // Returns x mod 2^{length_bits_}.
-  inline size_t ModTableSize(uint64_t x) {
+  inline size_t ModTableSize(uint64_t x) const {
     return static_cast<size_t>(x) & length_bits_mask_;
   }
 
+  // State carried from GrowIfNeeded to DoInsert within one Insert
+  struct InsertState {};
+
+  // For BaseClockTable::Insert. The table is never resized, so this only
+  // reports whether `new_occupancy` is within the occupancy limit.
+  inline bool GrowIfNeeded(size_t new_occupancy, InsertState& /*state*/) {
+    return new_occupancy <= occupancy_limit_;
+  }
+
+  // For BaseClockTable::Insert. Returns the slot the entry was inserted
+  // into, or nullptr if a visible entry for the same key was found first (or
+  // no slot was available), in which case the table is left unchanged.
+  inline HandleImpl* DoInsert(const ClockHandleBasicData& proto,
+                              uint64_t initial_countdown, bool keep_ref,
+                              InsertState& state);
+
   // Runs the clock eviction algorithm trying to reclaim at least
   // requested_charge. Returns how much is evicted, which could be less
   // if it appears impossible to evict the requested amount without blocking.
@@ -487,42 +616,6 @@ class HyperClockTable {
   // until (not including) the given handle
   inline void Rollback(const UniqueId64x2& hashed_key, const HandleImpl* h);
 
-  // Subtracts `total_charge` from `usage_` and 1 from `occupancy_`.
-  // Ideally this comes after releasing the entry itself so that we
-  // actually have the available occupancy/usage that is claimed.
-  // However, that means total_charge has to be saved from the handle
-  // before releasing it so that it can be provided to this function.
-  inline void ReclaimEntryUsage(size_t total_charge);
-
-  // Helper for updating `usage_` for new entry with given `total_charge`
-  // and evicting if needed under strict_capacity_limit=true rules. This
-  // means the operation might fail with Status::MemoryLimit. If
-  // `need_evict_for_occupancy`, then eviction of at least one entry is
-  // required, and the operation should fail if not possible.
-  // NOTE: Otherwise, occupancy_ is not managed in this function
-  inline Status ChargeUsageMaybeEvictStrict(size_t total_charge,
-                                            size_t capacity,
-                                            bool need_evict_for_occupancy);
-
-  // Helper for updating `usage_` for new entry with given `total_charge`
-  // and evicting if needed under strict_capacity_limit=false rules. This
-  // means that updating `usage_` always succeeds even if forced to exceed
-  // capacity. If `need_evict_for_occupancy`, then eviction of at least one
-  // entry is required, and the operation should return false if such eviction
-  // is not possible. `usage_` is not updated in that case. Otherwise, returns
-  // true, indicating success.
-  // NOTE: occupancy_ is not managed in this function
-  inline bool ChargeUsageMaybeEvictNonStrict(size_t total_charge,
-                                             size_t capacity,
-                                             bool need_evict_for_occupancy);
-
-  // Creates a "standalone" handle for returning from an Insert operation that
-  // cannot be completed by actually inserting into the table.
-  // Updates `standalone_usage_` but not `usage_` nor `occupancy_`.
-  inline HandleImpl* StandaloneInsert(const ClockHandleBasicData& proto);
-
-  MemoryAllocator* GetAllocator() const { return allocator_; }
-
   // Returns the number of bits used to hash an element in the hash
   // table.
   static int CalcHashBits(size_t capacity, size_t estimated_value_size,
@@ -541,34 +634,190 @@ class HyperClockTable {
 
   // Array of slots comprising the hash table.
   const std::unique_ptr<HandleImpl[]> array_;
+};  // class HyperClockTable
 
-  // From Cache, for deleter
-  MemoryAllocator* const allocator_;
+// A variant of HyperClockTable that needs no estimate of the average entry
+// charge: the table starts small and grows one slot at a time, as entries
+// are added, using linear hashing. With the current length in [2^b, 2^(b+1)),
+// the "home" slot of a hashed key is its low b+1 hash bits when those are
+// below the length, and its low b bits otherwise. Growing by one slot splits
+// the chain of home slot (length - 2^b) between that slot and the new slot
+// at index `length`, so only the entries of one chain change homes and there
+// is never a stop-the-world rehash.
+//
+// Because entries cannot be moved between slots (they can be referenced at
+// any time), each home slot heads a singly-linked chain of the entries whose
+// hashes map to it, while the entries themselves sit in whichever slot was
+// empty at insertion time. (An insert that grew the table first tries the
+// new slot at the end, and the search otherwise probes pseudorandom slots,
+// so that the load stays even across the array.) The slot array is reserved
+// up front (as lazily mapped, zeroed memory) for the largest size the table
+// can reach given the capacity and Opts::min_avg_value_size, so growing
+// never moves the array.
+//
+// Concurrency: Lookup walks a chain without synchronization beyond the
+// usual acquire-ref / check-key protocol on each entry, and Release is
+// unchanged from HyperClockTable. Changes to a chain (linking a new entry,
+// unlinking a removed one, splitting it to grow) are serialized by a lock
+// bit in the chain's head word, held only for the chain operation itself.
+// A Lookup racing with a split might miss an entry that is present (a false
+// miss, which the cache contract allows), but never returns a wrong entry
+// because the key is checked under a reference. Erase must not miss an
+// entry, so it walks the chain under the lock.
+class AutoHyperClockTable : public BaseClockTable {
+ public:
+  // Lock bit in HandleImpl::head, held while changing the chain
+  static constexpr uint32_t kHeadLocked = uint32_t{1} << 31;
+  // HandleImpl::next value marking a standalone handle (never a valid link)
+  static constexpr uint32_t kStandaloneNext = UINT32_MAX;
 
-  // A reference to Cache::eviction_callback_
-  const Cache::EvictionCallback& eviction_callback_;
+  // Target size to be exactly a common cache line size (see static_assert in
+  // clock_cache.cc). Chain links are 1 + slot index, with 0 meaning none.
+  struct ALIGN_AS(64U) HandleImpl : public ClockHandle {
+    // Link to the first entry in the chain of entries whose home is this
+    // slot, plus kHeadLocked while a writer holds the chain.
+    std::atomic<uint32_t> head{};
 
-  // A reference to ShardedCacheBase::hash_seed_
-  const uint32_t& hash_seed_;
+    // Link to the next entry in the chain holding the entry in this slot,
+    // or kStandaloneNext for a standalone handle.
+    std::atomic<uint32_t> next{};
 
-  // We partition the following members into different cache lines
-  // to avoid false sharing among Lookup, Release, Erase and Insert
-  // operations in ClockCacheShard.
+    inline bool IsStandalone() const {
+      return next.load(std::memory_order_relaxed) == kStandaloneNext;
+    }
 
-  ALIGN_AS(CACHE_LINE_SIZE)
-  // Clock algorithm sweep pointer.
-  std::atomic<uint64_t> clock_pointer_{};
+    inline void SetStandalone() {
+      next.store(kStandaloneNext, std::memory_order_relaxed);
+    }
+  };  // struct HandleImpl
 
-  ALIGN_AS(CACHE_LINE_SIZE)
-  // Number of elements in the table.
-  std::atomic<size_t> occupancy_{};
+  struct Opts {
+    // Lower bound on the average entry charge that the table should be able
+    // to hold at full capacity. Only determines the maximum table size
+    // reserved up front; the table grows to fit what is actually inserted.
+    size_t min_avg_value_size;
+  };
 
-  // Memory usage by entries tracked by the cache (including standalone)
-  std::atomic<size_t> usage_{};
+  AutoHyperClockTable(size_t capacity, bool strict_capacity_limit,
+                      CacheMetadataChargePolicy metadata_charge_policy,
+                      MemoryAllocator* allocator,
+                      const Cache::EvictionCallback* eviction_callback,
+                      const uint32_t* hash_seed, const Opts& opts);
+  ~AutoHyperClockTable();
 
-  // Part of usage by standalone entries (not in table)
-  std::atomic<size_t> standalone_usage_{};
-};  // class HyperClockTable
+  HandleImpl* Lookup(const UniqueId64x2& hashed_key);
+
+  // Prefetches the home slot, with the head of the chain walked by Lookup
+  void Prefetch(const UniqueId64x2& hashed_key) const;
+
+  bool Release(HandleImpl* handle, bool useful, bool erase_if_last_ref);
+
+  void Erase(const UniqueId64x2& hashed_key);
+
+  void ConstApplyToEntriesRange(std::function<void(const HandleImpl&)> func,
+                                size_t index_begin, size_t index_end,
+                                bool apply_if_will_be_deleted) const;
+
+  void EraseUnRefEntries();
+
+  // As in HyperClockTable
+  bool GetEvictionCandidate(UniqueId64x2* victim) const;
+
+  // Current number of slots in use by the table, which only grows
+  size_t GetTableSize() const {
+    return length_.load(std::memory_order_acquire);
+  }
+
+  // Number of index bits for the largest size the table can grow to, which
+  // keeps ApplyToSomeEntries state stable as the table grows
+  int GetLengthBits() const { return max_length_bits_; }
+
+  size_t GetOccupancyLimit() const { return occupancy_limit_; }
+
+  // Release N references
+  void TEST_ReleaseN(HandleImpl* handle, size_t n);
+
+ private:  // functions
+  friend class BaseClockTable;
+
+  // Index of the home slot (chain head) for a hashed key, given the table
+  // length.
+  static inline size_t GetHome(const UniqueId64x2& hashed_key, size_t length);
+
+  // State carried from GrowIfNeeded to DoInsert within one Insert
+  struct InsertState {
+    // First slot added by growing the table for this insert, if any. New
+    // slots are only ever added at the end, so an insert that grew the table
+    // looks for an empty slot there first, keeping the load even.
+    size_t grown_from = SIZE_MAX;
+  };
+
+  // For BaseClockTable::Insert. Grows the table until it is within the
+  // target load factor for `new_occupancy` entries, or at its maximum size.
+  // Returns whether `new_occupancy` is within the occupancy limit.
+  inline bool GrowIfNeeded(size_t new_occupancy, InsertState& state);
+
+  // Adds a slot to the table by splitting the chain of the next home slot in
+  // linear hashing order, unless another thread already grew the table past
+  // `old_length`.
+  void Grow(size_t old_length);
+
+  // For BaseClockTable::Insert. Returns the slot the entry was inserted
+  // into, or nullptr if a visible entry for the same key was found first (or
+  // no slot was available), in which case the table is left unchanged.
+  inline HandleImpl* DoInsert(const ClockHandleBasicData& proto,
+                              uint64_t initial_countdown, bool keep_ref,
+                              InsertState& state);
+
+  // Runs the clock eviction algorithm trying to reclaim at least
+  // requested_charge. Returns how much is evicted, which could be less
+  // if it appears impossible to evict the requested amount without blocking.
+  inline void Evict(size_t requested_charge, size_t* freed_charge,
+                    size_t* freed_count);
+
+  // Waits for and takes the lock on the chain headed at `home`, returning
+  // the head link (without the lock bit).
+  inline uint32_t LockChain(HandleImpl& home);
+
+  // Releases the lock on the chain headed at `home`, setting its head link.
+  inline void UnlockChain(HandleImpl& home, uint32_t head);
+
+  // Locks the chain that `hashed_key` currently belongs to, which is
+  // returned in `*home` along with its head link.
+  inline uint32_t LockHomeChain(const UniqueId64x2& hashed_key,
+                                HandleImpl** home);
+
+  // Removes the entry in slot `h`, which the caller owns (construction
+  // state) with its data still intact, from its chain.
+  inline void Unlink(HandleImpl* h);
+
+  inline uint32_t LinkOf(const HandleImpl* h) const {
+    return static_cast<uint32_t>(h - array_) + 1;
+  }
+
+  // Returns the number of index bits for the largest table size.
+  static int CalcMaxLengthBits(
+      size_t capacity, size_t min_avg_value_size,
+      CacheMetadataChargePolicy metadata_charge_policy);
+
+ private:  // data
+  // The largest table size is 1 << max_length_bits_.
+  const int max_length_bits_;
+
+  // Maximum number of elements the user can store in the table, once the
+  // table reaches its largest size.
+  const size_t occupancy_limit_;
+
+  // Reserved memory for the largest size of the table.
+  const MemMapping array_mem_;
+
+  // Array of slots comprising the hash table (in array_mem_).
+  HandleImpl* const array_;
+
+  ALIGN_AS(CACHE_LINE_SIZE)
+  // Number of slots currently in use, only increasing (see Grow).
+  std::atomic<size_t> length_;
+};  // class AutoHyperClockTable
 
 // A single shard of sharded cache.
 template <class Table>
@@ -588,6 +837,7 @@ class ALIGN_AS(CACHE_LINE_SIZE) ClockCacheShard final : public CacheShardBase {
   static inline uint32_t HashPieceForSharding(HashCref hash) {
     return Upper32of64(hash[0]);
   }
+  static inline uint64_t HashForSketches(HashCref hash) { return hash[1]; }
   static inline HashVal ComputeHash(const Slice& key, uint32_t seed) {
     assert(key.size() == kCacheKeySize);
     HashVal in;
@@ -610,8 +860,8 @@ class ALIGN_AS(CACHE_LINE_SIZE) ClockCacheShard final : public CacheShardBase {
   }
 
   // Although capacity is dynamically changeable, the number of table slots is
-  // not, so growing capacity substantially could lead to hitting occupancy
-  // limit.
+  // not (beyond the maximum size of AutoHyperClockTable), so growing capacity
+  // substantially could lead to hitting occupancy limit.
   void SetCapacity(size_t capacity);
 
   void SetStrictCapacityLimit(bool strict_capacity_limit);
@@ -623,7 +873,8 @@ class ALIGN_AS(CACHE_LINE_SIZE) ClockCacheShard final : public CacheShardBase {
   HandleImpl* CreateStandalone(const Slice& key, const UniqueId64x2& hashed_key,
                                Cache::ObjectPtr obj,
                                const Cache::CacheItemHelper* helper,
-                               size_t charge, bool allow_uncharged);
+                               size_t charge, bool allow_uncharged,
+                               bool evict = true);
 
   HandleImpl* Lookup(const Slice& key, const UniqueId64x2& hashed_key);
 
@@ -631,10 +882,18 @@ class ALIGN_AS(CACHE_LINE_SIZE) ClockCacheShard final : public CacheShardBase {
 
   bool Release(HandleImpl* handle, bool erase_if_last_ref = false);
 
+  // Lock-free, so these only prefetch ahead of the lookups, and loop
+  void MultiLookup(const Slice* const* keys, const UniqueId64x2* hashed_keys,
+                   size_t n, HandleImpl** results);
+
+  void MultiRelease(HandleImpl* const* handles, size_t n, bool useful);
+
   bool Ref(HandleImpl* handle);
 
   void Erase(const Slice& key, const UniqueId64x2& hashed_key);
 
+  bool PeekEvictionCandidate(size_t charge, UniqueId64x2* victim);
+
   size_t GetCapacity() const;
 
   size_t GetUsage() const;
@@ -680,27 +939,51 @@ class ALIGN_AS(CACHE_LINE_SIZE) ClockCacheShard final : public CacheShardBase {
   std::atomic<bool> strict_capacity_limit_;
 };  // class ClockCacheShard
 
+template <class Table>
+class BaseHyperClockCache : public ShardedCache<ClockCacheShard<Table>> {
+ public:
+  using Shard = ClockCacheShard<Table>;
+  using Handle = Cache::Handle;
+  using CacheItemHelper = Cache::CacheItemHelper;
+
+  explicit BaseHyperClockCache(const HyperClockCacheOptions& opts);
+
+  Cache::ObjectPtr Value(Handle* handle) override;
+
+  size_t GetCharge(Handle* handle) const override;
+
+  const CacheItemHelper* GetCacheItemHelper(Handle* handle) const override;
+};  // class BaseHyperClockCache
+
 class HyperClockCache
 #ifdef NDEBUG
     final
 #endif
-    : public ShardedCache<ClockCacheShard<HyperClockTable>> {
+    : public BaseHyperClockCache<HyperClockTable> {
  public:
-  using Shard = ClockCacheShard<HyperClockTable>;
-
   explicit HyperClockCache(const HyperClockCacheOptions& opts);
 
   const char* Name() const override { return "HyperClockCache"; }
 
-  Cache::ObjectPtr Value(Handle* handle) override;
+  void ReportProblems(
+      const std::shared_ptr<Logger>& /*info_log*/) const override;
+};  // class HyperClockCache
 
-  size_t GetCharge(Handle* handle) const override;
+// HyperClockCache on AutoHyperClockTable, for
+// HyperClockCacheOptions::estimated_entry_charge == 0
+class AutoHyperClockCache
+#ifdef NDEBUG
+    final
+#endif
+    : public BaseHyperClockCache<AutoHyperClockTable> {
+ public:
+  explicit AutoHyperClockCache(const HyperClockCacheOptions& opts);
 
-  const CacheItemHelper* GetCacheItemHelper(Handle* handle) const override;
+  const char* Name() const override { return "AutoHyperClockCache"; }
 
   void ReportProblems(
       const std::shared_ptr<Logger>& /*info_log*/) const override;
-};  // class HyperClockCache
+};  // class AutoHyperClockCache
 
 }  // namespace clock_cache
 
@@ -7,10 +7,12 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <limits>
 #include <memory>
 
 #include "memory/memory_allocator_impl.h"
 #include "monitoring/perf_context_imp.h"
+#include "util/coding.h"
 #include "util/compression.h"
 #include "util/string_util.h"
 
@@ -20,6 +22,10 @@ CompressedSecondaryCache::CompressedSecondaryCache(
     const CompressedSecondaryCacheOptions& opts)
     : cache_(opts.LRUCacheOptions::MakeSharedCache()),
       cache_options_(opts),
+      use_dicts_(opts.max_dict_bytes > 0 &&
+                 (opts.compression_type == kZSTD ||
+                  opts.compression_type == kZSTDNotFinalCompression) &&
+                 ZSTD_TrainDictionarySupported()),
       cache_res_mgr_(std::make_shared<ConcurrentCacheReservationManager>(
           std::make_shared<CacheReservationManagerImpl<CacheEntryRole::kMisc>>(
               cache_))) {}
@@ -68,14 +74,32 @@ std::unique_ptr<SecondaryCacheResultHandle> CompressedSecondaryCache::Lookup(
     s = helper->create_cb(Slice(ptr->get(), handle_value_charge),
                           create_context, allocator, &value, &charge);
   } else {
+    Slice compressed(ptr->get(), handle_value_charge);
+    std::shared_ptr<const DictVersion> dict;
+    if (use_dicts_) {
+      uint32_t dict_id = 0;
+      if (!GetVarint32(&compressed, &dict_id)) {
+        cache_->Release(lru_handle, /*erase_if_last_ref=*/true);
+        return nullptr;
+      }
+      if (dict_id != 0) {
+        dict = GetDict(helper->role, dict_id);
+        if (dict == nullptr) {
+          // Compressed with a dictionary version no longer kept
+          cache_->Release(lru_handle, /*erase_if_last_ref=*/true);
+          return nullptr;
+        }
+      }
+    }
     UncompressionContext uncompression_context(cache_options_.compression_type);
-    UncompressionInfo uncompression_info(uncompression_context,
-                                         UncompressionDict::GetEmptyDict(),
-                                         cache_options_.compression_type);
+    UncompressionInfo uncompression_info(
+        uncompression_context,
+        dict ? dict->uncompression_dict : UncompressionDict::GetEmptyDict(),
+        cache_options_.compression_type);
 
     size_t uncompressed_size{0};
     CacheAllocationPtr uncompressed = UncompressData(
-        uncompression_info, (char*)ptr->get(), handle_value_charge,
+        uncompression_info, compressed.data(), compressed.size(),
         &uncompressed_size, cache_options_.compress_format_version, allocator);
 
     if (!uncompressed) {
@@ -139,11 +163,19 @@ Status CompressedSecondaryCache::Insert(const Slice& key,
   if (cache_options_.compression_type != kNoCompression &&
       !cache_options_.do_not_compress_roles.Contains(helper->role)) {
     PERF_COUNTER_ADD(compressed_sec_cache_uncompressed_bytes, size);
+    std::shared_ptr<const DictVersion> dict;
+    if (use_dicts_) {
+      MaybeTrainDict(helper->role, val);
+      dict = GetDict(helper->role, /*id=*/0);
+      // ZSTD_Compress() appends to the id
+      PutVarint32(&compressed_val, dict ? dict->id : 0);
+    }
     CompressionOptions compression_opts;
     CompressionContext compression_context(cache_options_.compression_type);
     uint64_t sample_for_compression{0};
     CompressionInfo compression_info(
-        compression_opts, compression_context, CompressionDict::GetEmptyDict(),
+        compression_opts, compression_context,
+        dict ? dict->compression_dict : CompressionDict::GetEmptyDict(),
         cache_options_.compression_type, sample_for_compression);
 
     bool success =
@@ -203,9 +235,77 @@ std::string CompressedSecondaryCache::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "    compress_format_version : %d\n",
            cache_options_.compress_format_version);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    max_dict_bytes : %u\n",
+           cache_options_.max_dict_bytes);
+  ret.append(buffer);
   return ret;
 }
 
+void CompressedSecondaryCache::MaybeTrainDict(CacheEntryRole role,
+                                              const Slice& value) {
+  const size_t training_bytes =
+      cache_options_.dict_training_bytes > 0
+          ? static_cast<size_t>(cache_options_.dict_training_bytes)
+          : size_t{100} * cache_options_.max_dict_bytes;
+  RoleDicts& dicts = dicts_[static_cast<size_t>(role)];
+  std::string samples;
+  std::vector<size_t> sample_lens;
+  {
+    MutexLock l(&dict_mutex_);
+    if (dicts.bytes_until_sampling > 0) {
+      dicts.bytes_until_sampling -=
+          std::min<uint64_t>(dicts.bytes_until_sampling, value.size());
+      return;
+    }
+    if (dicts.training) {
+      return;
+    }
+    dicts.samples.append(value.data(), value.size());
+    dicts.sample_lens.push_back(value.size());
+    if (dicts.samples.size() < training_bytes) {
+      return;
+    }
+    samples.swap(dicts.samples);
+    sample_lens.swap(dicts.sample_lens);
+    dicts.training = true;
+  }
+
+  // Without holding the mutex, which Lookup() needs
+  std::string dict = ZSTD_TrainDictionary(samples, sample_lens,
+                                          cache_options_.max_dict_bytes);
+
+  MutexLock l(&dict_mutex_);
+  dicts.training = false;
+  dicts.bytes_until_sampling = cache_options_.dict_retrain_bytes > 0
+                                   ? cache_options_.dict_retrain_bytes
+                                   : std::numeric_limits<uint64_t>::max();
+  if (!dict.empty()) {
+    dicts.versions.push_back(
+        std::make_shared<const DictVersion>(next_dict_id_++, dict));
+    if (dicts.versions.size() > kMaxDictVersions) {
+      dicts.versions.pop_front();
+    }
+  }
+}
+
+std::shared_ptr<const CompressedSecondaryCache::DictVersion>
+CompressedSecondaryCache::GetDict(CacheEntryRole role, uint32_t id) {
+  MutexLock l(&dict_mutex_);
+  const RoleDicts& dicts = dicts_[static_cast<size_t>(role)];
+  if (dicts.versions.empty()) {
+    return nullptr;
+  }
+  if (id == 0) {
+    return dicts.versions.back();
+  }
+  for (const auto& version : dicts.versions) {
+    if (version->id == id) {
+      return version;
+    }
+  }
+  return nullptr;
+}
+
 CompressedSecondaryCache::CacheValueChunk*
 CompressedSecondaryCache::SplitValueIntoChunks(const Slice& value,
                                                CompressionType compression_type,
@@ -7,7 +7,10 @@
 
 #include <array>
 #include <cstddef>
+#include <deque>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "cache/cache_reservation_manager.h"
 #include "cache/lru_cache.h"
@@ -67,6 +70,10 @@ class CompressedSecondaryCacheResultHandle : public SecondaryCacheResultHandle {
 // std::unique_ptr<rocksdb::SecondaryCache> cache =
 //      NewCompressedSecondaryCache(opts);
 // static_cast<CompressedSecondaryCache*>(cache.get())->Erase(key);
+//
+// With CompressedSecondaryCacheOptions::max_dict_bytes, the compressed value
+// of an entry is preceded by the varint32 id of the version of the dictionary
+// of its CacheEntryRole it was compressed with, 0 for none.
 
 class CompressedSecondaryCache : public SecondaryCache {
  public:
@@ -131,8 +138,49 @@ class CompressedSecondaryCache : public SecondaryCache {
 
   // TODO: clean up to use cleaner interfaces in typed_cache.h
   const Cache::CacheItemHelper* GetHelper(bool enable_custom_split_merge) const;
+
+  // A trained version of the dictionary of a CacheEntryRole
+  struct DictVersion {
+    DictVersion(uint32_t _id, const std::string& dict)
+        : id(_id),
+          compression_dict(dict, kZSTD,
+                           CompressionOptions::kDefaultCompressionLevel),
+          uncompression_dict(dict, /*using_zstd=*/true) {}
+
+    const uint32_t id;
+    CompressionDict compression_dict;
+    UncompressionDict uncompression_dict;
+  };
+
+  struct RoleDicts {
+    // The latest versions, oldest first
+    std::deque<std::shared_ptr<const DictVersion>> versions;
+    // The values sampled for the next version
+    std::string samples;
+    std::vector<size_t> sample_lens;
+    // The bytes of values to insert before sampling again
+    uint64_t bytes_until_sampling = 0;
+    bool training = false;
+  };
+
+  // The number of versions of a dictionary kept for decompression
+  static constexpr size_t kMaxDictVersions = 4;
+
+  // Samples value for the dictionary of role, training a new version once
+  // enough values were sampled
+  void MaybeTrainDict(CacheEntryRole role, const Slice& value);
+
+  // Returns the version of the dictionary of role with the given id, or the
+  // latest one if id is 0. nullptr if none.
+  std::shared_ptr<const DictVersion> GetDict(CacheEntryRole role,
+                                             uint32_t id);
+
   std::shared_ptr<Cache> cache_;
   CompressedSecondaryCacheOptions cache_options_;
+  const bool use_dicts_;
+  port::Mutex dict_mutex_;
+  std::array<RoleDicts, kNumCacheEntryRoles> dicts_;
+  uint32_t next_dict_id_ = 1;
   mutable port::Mutex capacity_mutex_;
   std::shared_ptr<ConcurrentCacheReservationManager> cache_res_mgr_;
 };
@@ -17,6 +17,7 @@
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
 #include "util/cast_util.h"
+#include "util/coding.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -976,6 +977,82 @@ TEST_P(CompressedSecondaryCacheTest, SplictValueAndMergeChunksTest) {
   SplictValueAndMergeChunksTest();
 }
 
+TEST_P(CompressedSecondaryCacheTest, DictionaryCompression) {
+  if (!ZSTD_TrainDictionarySupported()) {
+    ROCKSDB_GTEST_SKIP("This test requires ZSTD dictionary support.");
+    return;
+  }
+  CompressedSecondaryCacheOptions opts;
+  opts.capacity = 16 << 20;
+  opts.num_shard_bits = 0;
+  opts.compression_type = kZSTD;
+  opts.max_dict_bytes = 4 << 10;
+  opts.dict_training_bytes = 64000;
+  opts.dict_retrain_bytes = 256000;
+  std::shared_ptr<SecondaryCache> sec_cache = NewCompressedSecondaryCache(opts);
+
+  // Values made of words of a common vocabulary, which only repeat a few
+  // times within a value
+  Random rnd(301);
+  std::vector<std::string> words;
+  for (int i = 0; i < 256; ++i) {
+    words.push_back(rnd.RandomString(8));
+  }
+  std::vector<std::string> values;
+  auto insert = [&](int n) {
+    uint64_t compressed_bytes = 0;
+    for (int i = 0; i < n; ++i) {
+      std::string value;
+      while (value.size() < 1000) {
+        value += words[rnd.Uniform(static_cast<int>(words.size()))];
+      }
+      std::string key = "____    ____";
+      PutFixed32(&key, static_cast<uint32_t>(values.size()));
+      TestItem item(value.data(), value.size());
+      const Cache::CacheItemHelper* helper =
+          GetHelper(CacheEntryRole::kDataBlock);
+      get_perf_context()->Reset();
+      EXPECT_OK(sec_cache->Insert(key, &item, helper));
+      EXPECT_OK(sec_cache->Insert(key, &item, helper));
+      compressed_bytes +=
+          get_perf_context()->compressed_sec_cache_compressed_bytes;
+      values.push_back(std::move(value));
+    }
+    return compressed_bytes;
+  };
+  auto lookup = [&](size_t i) {
+    std::string key = "____    ____";
+    PutFixed32(&key, static_cast<uint32_t>(i));
+    bool kept_in_sec_cache{false};
+    std::unique_ptr<SecondaryCacheResultHandle> handle = sec_cache->Lookup(
+        key, GetHelper(CacheEntryRole::kDataBlock), this, true,
+        /*advise_erase=*/false, kept_in_sec_cache);
+    if (handle == nullptr) {
+      return false;
+    }
+    std::unique_ptr<TestItem> val(static_cast<TestItem*>(handle->Value()));
+    EXPECT_EQ(Slice(val->Buf(), val->Size()), Slice(values[i]));
+    return true;
+  };
+
+  // The first dictionary is trained from the first 64 values, and used to
+  // compress the last of them
+  uint64_t without_dict = insert(63);
+  uint64_t with_dict = insert(63);
+  ASSERT_LT(with_dict * 2, without_dict);
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_TRUE(lookup(i));
+  }
+
+  // A new version is trained from every 64 values after 256 values, and the
+  // fifth one (from value 1343 on) drops the first one (values 63 to 382).
+  // The other entries still decompress.
+  insert(1300);
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_EQ(lookup(i), i < 63 || i >= 383) << i;
+  }
+}
+
 class CompressedSecCacheTestWithTiered : public ::testing::Test {
  public:
   CompressedSecCacheTestWithTiered() {
@@ -13,23 +13,70 @@
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "cache/secondary_cache_adapter.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/statistics_impl.h"
 #include "port/lang.h"
 #include "util/distributed_mutex.h"
+#include "util/math.h"
 
 namespace ROCKSDB_NAMESPACE {
 namespace lru_cache {
 
+namespace {
+// Bit i set for each tag i of the kGroupSize (16) tags at group equal to tag
+inline uint32_t MatchTag(const uint8_t* group, uint8_t tag) {
+#ifdef __SSE2__
+  const __m128i cmp =
+      _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(tag)),
+                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(group)));
+  return static_cast<uint32_t>(_mm_movemask_epi8(cmp));
+#else
+  uint32_t mask = 0;
+  for (uint32_t i = 0; i < 16; ++i) {
+    mask |= uint32_t{group[i] == tag} << i;
+  }
+  return mask;
+#endif
+}
+
+// Bit i set for each tag i at group of an empty or deleted slot, the tags
+// with the high bit set
+inline uint32_t MatchFree(const uint8_t* group) {
+#ifdef __SSE2__
+  return static_cast<uint32_t>(_mm_movemask_epi8(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+  uint32_t mask = 0;
+  for (uint32_t i = 0; i < 16; ++i) {
+    mask |= uint32_t{group[i] >> 7} << i;
+  }
+  return mask;
+#endif
+}
+}  // namespace
+
 LRUHandleTable::LRUHandleTable(int max_upper_hash_bits,
-                               MemoryAllocator* allocator)
+                               MemoryAllocator* allocator,
+                               bool use_swiss_table)
     : length_bits_(/* historical starting size*/ 4),
       list_(new LRUHandle* [size_t{1} << length_bits_] {}),
       elems_(0),
+      deleted_(0),
       max_length_bits_(max_upper_hash_bits),
-      allocator_(allocator) {}
+      allocator_(allocator) {
+  static_assert(kGroupSize == 16, "MatchTag() and MatchFree()");
+  if (use_swiss_table) {
+    tags_.reset(new uint8_t[size_t{1} << length_bits_]);
+    memset(tags_.get(), kEmptyTag, size_t{1} << length_bits_);
+  }
+}
 
 LRUHandleTable::~LRUHandleTable() {
   auto alloc = allocator_;
@@ -43,10 +90,17 @@ LRUHandleTable::~LRUHandleTable() {
 }
 
 LRUHandle* LRUHandleTable::Lookup(const Slice& key, uint32_t hash) {
+  if (tags_) {
+    size_t slot = SwissFind(key, hash);
+    return slot == kNotFound ? nullptr : list_[slot];
+  }
   return *FindPointer(key, hash);
 }
 
 LRUHandle* LRUHandleTable::Insert(LRUHandle* h) {
+  if (tags_) {
+    return SwissInsert(h);
+  }
   LRUHandle** ptr = FindPointer(h->key(), h->hash);
   LRUHandle* old = *ptr;
   h->next_hash = (old == nullptr ? nullptr : old->next_hash);
@@ -63,6 +117,9 @@ LRUHandle* LRUHandleTable::Insert(LRUHandle* h) {
 }
 
 LRUHandle* LRUHandleTable::Remove(const Slice& key, uint32_t hash) {
+  if (tags_) {
+    return SwissRemove(key, hash);
+  }
   LRUHandle** ptr = FindPointer(key, hash);
   LRUHandle* result = *ptr;
   if (result != nullptr) {
@@ -114,13 +171,112 @@ void LRUHandleTable::Resize() {
   length_bits_ = new_length_bits;
 }
 
+size_t LRUHandleTable::SwissFind(const Slice& key, uint32_t hash) const {
+  const size_t mask = (size_t{1} << length_bits_) - 1;
+  const uint8_t tag = TagOf(hash);
+  // Terminates as there is always an empty slot (see SwissInsert)
+  for (size_t group = GroupStart(hash);; group = (group + kGroupSize) & mask) {
+    for (uint32_t m = MatchTag(&tags_[group], tag); m != 0; m &= m - 1) {
+      size_t slot = group + CountTrailingZeroBits(m);
+      LRUHandle* h = list_[slot];
+      if (h->hash == hash && key == h->key()) {
+        return slot;
+      }
+    }
+    if (MatchTag(&tags_[group], kEmptyTag) != 0) {
+      return kNotFound;
+    }
+  }
+}
+
+void LRUHandleTable::SwissPlace(LRUHandle* h) {
+  const size_t mask = (size_t{1} << length_bits_) - 1;
+  for (size_t group = GroupStart(h->hash);;
+       group = (group + kGroupSize) & mask) {
+    uint32_t m = MatchFree(&tags_[group]);
+    if (m != 0) {
+      size_t slot = group + CountTrailingZeroBits(m);
+      if (tags_[slot] == kDeletedTag) {
+        --deleted_;
+      }
+      tags_[slot] = TagOf(h->hash);
+      list_[slot] = h;
+      // For ApplyToEntriesRange
+      h->next_hash = nullptr;
+      return;
+    }
+  }
+}
+
+LRUHandle* LRUHandleTable::SwissInsert(LRUHandle* h) {
+  size_t slot = SwissFind(h->key(), h->hash);
+  if (slot != kNotFound) {
+    LRUHandle* old = list_[slot];
+    list_[slot] = h;
+    h->next_hash = nullptr;
+    return old;
+  }
+  // Keep at most 7/8 of the slots used or deleted, as probes only stop at
+  // a group with an empty slot
+  size_t length = size_t{1} << length_bits_;
+  if (elems_ + deleted_ + 1 > length - length / 8) {
+    // Only dropping the tombstones if that leaves the table at most half
+    // full. Unlike with chains, the table must grow past max_length_bits_ to
+    // hold more entries.
+    int new_length_bits = length_bits_;
+    if (elems_ + 1 > length / 2 && length_bits_ < 31) {
+      ++new_length_bits;
+    }
+    SwissRehash(new_length_bits);
+  }
+  SwissPlace(h);
+  ++elems_;
+  return nullptr;
+}
+
+LRUHandle* LRUHandleTable::SwissRemove(const Slice& key, uint32_t hash) {
+  size_t slot = SwissFind(key, hash);
+  if (slot == kNotFound) {
+    return nullptr;
+  }
+  LRUHandle* result = list_[slot];
+  list_[slot] = nullptr;
+  // No probe continues past a group with an empty slot, so only a full group
+  // needs a tombstone
+  if (MatchTag(&tags_[slot & ~(kGroupSize - 1)], kEmptyTag) != 0) {
+    tags_[slot] = kEmptyTag;
+  } else {
+    tags_[slot] = kDeletedTag;
+    ++deleted_;
+  }
+  --elems_;
+  return result;
+}
+
+void LRUHandleTable::SwissRehash(int new_length_bits) {
+  size_t old_length = size_t{1} << length_bits_;
+  size_t new_length = size_t{1} << new_length_bits;
+  std::unique_ptr<LRUHandle*[]> old_list = std::move(list_);
+  list_.reset(new LRUHandle* [new_length] {});
+  tags_.reset(new uint8_t[new_length]);
+  memset(tags_.get(), kEmptyTag, new_length);
+  length_bits_ = new_length_bits;
+  deleted_ = 0;
+  for (size_t i = 0; i < old_length; i++) {
+    if (old_list[i] != nullptr) {
+      SwissPlace(old_list[i]);
+    }
+  }
+}
+
 LRUCacheShard::LRUCacheShard(size_t capacity, bool strict_capacity_limit,
                              double high_pri_pool_ratio,
                              double low_pri_pool_ratio, bool use_adaptive_mutex,
                              CacheMetadataChargePolicy metadata_charge_policy,
                              int max_upper_hash_bits,
                              MemoryAllocator* allocator,
-                             const Cache::EvictionCallback* eviction_callback)
+                             const Cache::EvictionCallback* eviction_callback,
+                             bool use_swiss_table)
     : CacheShardBase(metadata_charge_policy),
       capacity_(0),
       high_pri_pool_usage_(0),
@@ -130,7 +286,7 @@ LRUCacheShard::LRUCacheShard(size_t capacity, bool strict_capacity_limit,
       high_pri_pool_capacity_(0),
       low_pri_pool_ratio_(low_pri_pool_ratio),
       low_pri_pool_capacity_(0),
-      table_(max_upper_hash_bits, allocator),
+      table_(max_upper_hash_bits, allocator, use_swiss_table),
       usage_(0),
       lru_usage_(0),
       mutex_(use_adaptive_mutex),
@@ -172,7 +328,9 @@ void LRUCacheShard::ApplyToSomeEntries(
     size_t average_entries_per_lock, size_t* state) {
   // The state is essentially going to be the starting hash, which works
   // nicely even if we resize between calls because we use upper-most
-  // hash bits for table indexes.
+  // hash bits for table indexes. (With use_swiss_table, entries are not
+  // ordered by slot, so ApplyToEntriesRange selects them by the upper bits
+  // of their hash, rather than by slot.)
   DMutexLock l(mutex_);
   int length_bits = table_.GetLengthBits();
   size_t length = size_t{1} << length_bits;
@@ -432,6 +590,10 @@ LRUHandle* LRUCacheShard::Lookup(const Slice& key, uint32_t hash,
                                  Cache::Priority /*priority*/,
                                  Statistics* /*stats*/) {
   DMutexLock l(mutex_);
+  return LookupUnderLock(key, hash);
+}
+
+LRUHandle* LRUCacheShard::LookupUnderLock(const Slice& key, uint32_t hash) {
   LRUHandle* e = table_.Lookup(key, hash);
   if (e != nullptr) {
     assert(e->InCache());
@@ -446,6 +608,19 @@ LRUHandle* LRUCacheShard::Lookup(const Slice& key, uint32_t hash,
   return e;
 }
 
+void LRUCacheShard::MultiLookup(const Slice* const* keys,
+                                const uint32_t* hashes, size_t n,
+                                LRUHandle** results) {
+  DMutexLock l(mutex_);
+  // Start fetching the buckets before walking any of them
+  for (size_t i = 0; i < n; ++i) {
+    table_.Prefetch(hashes[i]);
+  }
+  for (size_t i = 0; i < n; ++i) {
+    results[i] = LookupUnderLock(*keys[i], hashes[i]);
+  }
+}
+
 bool LRUCacheShard::Ref(LRUHandle* e) {
   DMutexLock l(mutex_);
   // To create another reference - entry must be already externally referenced.
@@ -477,27 +652,7 @@ bool LRUCacheShard::Release(LRUHandle* e, bool /*useful*/,
   bool was_in_cache;
   {
     DMutexLock l(mutex_);
-    must_free = e->Unref();
-    was_in_cache = e->InCache();
-    if (must_free && was_in_cache) {
-      // The item is still in cache, and nobody else holds a reference to it.
-      if (usage_ > capacity_ || erase_if_last_ref) {
-        // The LRU list must be empty since the cache is full.
-        assert(lru_.next == &lru_ || erase_if_last_ref);
-        // Take this opportunity and remove the item.
-        table_.Remove(e->key(), e->hash);
-        e->SetInCache(false);
-      } else {
-        // Put the item back on the LRU list, and don't free it.
-        LRU_Insert(e);
-        must_free = false;
-      }
-    }
-    // If about to be freed, then decrement the cache usage.
-    if (must_free) {
-      assert(usage_ >= e->total_charge);
-      usage_ -= e->total_charge;
-    }
+    must_free = ReleaseUnderLock(e, erase_if_last_ref, &was_in_cache);
   }
 
   // Free the entry here outside of mutex for performance reasons.
@@ -515,6 +670,51 @@ bool LRUCacheShard::Release(LRUHandle* e, bool /*useful*/,
   return must_free;
 }
 
+bool LRUCacheShard::ReleaseUnderLock(LRUHandle* e, bool erase_if_last_ref,
+                                     bool* was_in_cache) {
+  bool must_free = e->Unref();
+  *was_in_cache = e->InCache();
+  if (must_free && *was_in_cache) {
+    // The item is still in cache, and nobody else holds a reference to it.
+    if (usage_ > capacity_ || erase_if_last_ref) {
+      // The LRU list must be empty since the cache is full.
+      assert(lru_.next == &lru_ || erase_if_last_ref);
+      // Take this opportunity and remove the item.
+      table_.Remove(e->key(), e->hash);
+      e->SetInCache(false);
+    } else {
+      // Put the item back on the LRU list, and don't free it.
+      LRU_Insert(e);
+      must_free = false;
+    }
+  }
+  // If about to be freed, then decrement the cache usage.
+  if (must_free) {
+    assert(usage_ >= e->total_charge);
+    usage_ -= e->total_charge;
+  }
+  return must_free;
+}
+
+void LRUCacheShard::MultiRelease(LRUHandle* const* handles, size_t n,
+                                 bool /*useful*/) {
+  autovector<LRUHandle*> to_free;
+  {
+    DMutexLock l(mutex_);
+    for (size_t i = 0; i < n; ++i) {
+      bool was_in_cache;
+      if (ReleaseUnderLock(handles[i], /*erase_if_last_ref=*/false,
+                           &was_in_cache)) {
+        to_free.push_back(handles[i]);
+      }
+    }
+  }
+  // Free the entries outside of mutex, as in Release
+  for (LRUHandle* e : to_free) {
+    e->Free(table_.GetAllocator());
+  }
+}
+
 LRUHandle* LRUCacheShard::CreateHandle(const Slice& key, uint32_t hash,
                                        Cache::ObjectPtr value,
                                        const Cache::CacheItemHelper* helper,
@@ -558,7 +758,7 @@ LRUHandle* LRUCacheShard::CreateStandalone(const Slice& key, uint32_t hash,
                                            Cache::ObjectPtr value,
                                            const Cache::CacheItemHelper* helper,
                                            size_t charge,
-                                           bool allow_uncharged) {
+                                           bool allow_uncharged, bool evict) {
   LRUHandle* e = CreateHandle(key, hash, value, helper, charge);
   e->SetIsStandalone(true);
   e->Ref();
@@ -568,7 +768,9 @@ LRUHandle* LRUCacheShard::CreateStandalone(const Slice& key, uint32_t hash,
   {
     DMutexLock l(mutex_);
 
-    EvictFromLRU(e->total_charge, &last_reference_list);
+    if (evict) {
+      EvictFromLRU(e->total_charge, &last_reference_list);
+    }
 
     if (strict_capacity_limit_ && (usage_ + e->total_charge) > capacity_) {
       if (allow_uncharged) {
@@ -612,6 +814,16 @@ void LRUCacheShard::Erase(const Slice& key, uint32_t hash) {
   }
 }
 
+bool LRUCacheShard::PeekEvictionCandidate(size_t charge, uint32_t* victim) {
+  DMutexLock l(mutex_);
+  if (usage_ + charge <= capacity_ || lru_.next == &lru_) {
+    return false;
+  }
+  // Oldest entry, as in EvictFromLRU
+  *victim = lru_.next->hash;
+  return true;
+}
+
 size_t LRUCacheShard::GetUsage() const {
   DMutexLock l(mutex_);
   return usage_;
@@ -642,6 +854,8 @@ void LRUCacheShard::AppendPrintableOptions(std::string& str) const {
              high_pri_pool_ratio_);
     snprintf(buffer + strlen(buffer), kBufferSize - strlen(buffer),
              "    low_pri_pool_ratio: %.3lf\n", low_pri_pool_ratio_);
+    snprintf(buffer + strlen(buffer), kBufferSize - strlen(buffer),
+             "    use_swiss_table: %d\n", table_.UsesSwissTable());
   }
   str.append(buffer);
 }
@@ -654,7 +868,7 @@ LRUCache::LRUCache(const LRUCacheOptions& opts) : ShardedCache(opts) {
                            opts.high_pri_pool_ratio, opts.low_pri_pool_ratio,
                            opts.use_adaptive_mutex, opts.metadata_charge_policy,
                            /* max_upper_hash_bits */ 32 - opts.num_shard_bits,
-                           alloc, &eviction_callback_);
+                           alloc, &eviction_callback_, opts.use_swiss_table);
   });
 }
 
@@ -8,6 +8,7 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -209,17 +210,42 @@ struct LRUHandle {
 // table implementations in some of the compiler/runtime combinations
 // we have tested.  E.g., readrandom speeds up by ~5% over the g++
 // 4.4.3's builtin hashtable.
+//
+// With use_swiss_table, the table is instead open-addressed, Swiss table
+// style: list_[i] is the entry in slot i (without a next_hash chain) and
+// tags_[i] 7 bits of its hash, or kEmptyTag or kDeletedTag. The slots are
+// probed by groups of kGroupSize, whose tags are compared all at once, so a
+// lookup reads a cache line of tags and only dereferences the entries with a
+// matching tag, rather than each entry in the chain of its bucket.
 class LRUHandleTable {
  public:
-  explicit LRUHandleTable(int max_upper_hash_bits, MemoryAllocator* allocator);
+  LRUHandleTable(int max_upper_hash_bits, MemoryAllocator* allocator,
+                 bool use_swiss_table);
   ~LRUHandleTable();
 
   LRUHandle* Lookup(const Slice& key, uint32_t hash);
+  // Prefetches the first entry in the bucket for the hash, or the first
+  // group of tags to probe
+  void Prefetch(uint32_t hash) const {
+    if (tags_) {
+      PREFETCH(&tags_[GroupStart(hash)], 0 /* rw */, 1 /* locality */);
+    } else {
+      PREFETCH(list_[hash >> (32 - length_bits_)], 0 /* rw */,
+               1 /* locality */);
+    }
+  }
   LRUHandle* Insert(LRUHandle* h);
   LRUHandle* Remove(const Slice& key, uint32_t hash);
 
+  // Applies func to the entries whose home index (upper hash bits) is in
+  // [index_begin, index_end), so that a range of hashes is visited the same
+  // way before and after a resize.
   template <typename T>
   void ApplyToEntriesRange(T func, size_t index_begin, size_t index_end) {
+    if (tags_) {
+      SwissApplyToEntriesRange(func, index_begin, index_end);
+      return;
+    }
     for (size_t i = index_begin; i < index_end; i++) {
       LRUHandle* h = list_[i];
       while (h != nullptr) {
@@ -237,6 +263,8 @@ class LRUHandleTable {
 
   MemoryAllocator* GetAllocator() const { return allocator_; }
 
+  bool UsesSwissTable() const { return tags_ != nullptr; }
+
  private:
   // Return a pointer to slot that points to a cache entry that
   // matches key/hash.  If there is no such cache entry, return a
@@ -245,17 +273,80 @@ class LRUHandleTable {
 
   void Resize();
 
+  // For use_swiss_table
+  static constexpr uint8_t kEmptyTag = 0x80;
+  static constexpr uint8_t kDeletedTag = 0xFE;
+  static constexpr size_t kGroupSize = 16;
+  static constexpr size_t kNotFound = SIZE_MAX;
+
+  static uint8_t TagOf(uint32_t hash) {
+    // Mixing all the bits, as the upper ones select the group and the lower
+    // ones are the same for all the entries of a shard
+    return static_cast<uint8_t>((hash * uint32_t{0x9E3779B1}) >> 25);
+  }
+
+  size_t GroupStart(uint32_t hash) const {
+    return (hash >> (32 - length_bits_)) & ~(kGroupSize - 1);
+  }
+
+  // Returns the slot of the entry matching key/hash, or kNotFound
+  size_t SwissFind(const Slice& key, uint32_t hash) const;
+  // Puts h in the first free slot of its probe sequence
+  void SwissPlace(LRUHandle* h);
+  LRUHandle* SwissInsert(LRUHandle* h);
+  LRUHandle* SwissRemove(const Slice& key, uint32_t hash);
+  // Rehashes into 1 << new_length_bits slots, dropping the tombstones
+  void SwissRehash(int new_length_bits);
+
+  // An entry is not necessarily in the slot of its home index, but in the
+  // group of it or in a later one (wrapping around), with only full groups
+  // in between. So this scans from the group of index_begin up to the first
+  // group past index_end with an empty slot, and only applies func to the
+  // entries with their home index in range.
+  template <typename T>
+  void SwissApplyToEntriesRange(T func, size_t index_begin, size_t index_end) {
+    const size_t length = size_t{1} << length_bits_;
+    const size_t first_group = index_begin & ~(kGroupSize - 1);
+    for (size_t group = first_group; group < first_group + length;
+         group += kGroupSize) {
+      bool has_empty = false;
+      for (size_t i = 0; i < kGroupSize; i++) {
+        size_t slot = (group + i) & (length - 1);
+        LRUHandle* h = list_[slot];
+        if (h != nullptr) {
+          size_t home = h->hash >> (32 - length_bits_);
+          if (home >= index_begin && home < index_end) {
+            assert(h->InCache());
+            func(h);
+          }
+        } else if (tags_[slot] == kEmptyTag) {
+          has_empty = true;
+        }
+      }
+      if (group + kGroupSize >= index_end && has_empty) {
+        break;
+      }
+    }
+  }
+
   // Number of hash bits (upper because lower bits used for sharding)
   // used for table index. Length == 1 << length_bits_
   int length_bits_;
 
   // The table consists of an array of buckets where each bucket is
   // a linked list of cache entries that hash into the bucket.
+  // With use_swiss_table, the slots.
   std::unique_ptr<LRUHandle*[]> list_;
 
+  // With use_swiss_table, the tag of each slot, otherwise null.
+  std::unique_ptr<uint8_t[]> tags_;
+
   // Number of elements currently in the table.
   uint32_t elems_;
 
+  // With use_swiss_table, number of kDeletedTag slots.
+  uint32_t deleted_;
+
   // Set from max_upper_hash_bits (see constructor).
   const int max_length_bits_;
 
@@ -273,7 +364,8 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShardBase {
                 bool use_adaptive_mutex,
                 CacheMetadataChargePolicy metadata_charge_policy,
                 int max_upper_hash_bits, MemoryAllocator* allocator,
-                const Cache::EvictionCallback* eviction_callback);
+                const Cache::EvictionCallback* eviction_callback,
+                bool use_swiss_table);
 
  public:  // Type definitions expected as parameter to ShardedCache
   using HandleImpl = LRUHandle;
@@ -304,10 +396,13 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShardBase {
                 const Cache::CacheItemHelper* helper, size_t charge,
                 LRUHandle** handle, Cache::Priority priority);
 
+  // With evict=false, the entry is charged without evicting anything, over
+  // capacity unless strict_capacity_limit (for TinyLFU admission).
   LRUHandle* CreateStandalone(const Slice& key, uint32_t hash,
                               Cache::ObjectPtr obj,
                               const Cache::CacheItemHelper* helper,
-                              size_t charge, bool allow_uncharged);
+                              size_t charge, bool allow_uncharged,
+                              bool evict = true);
 
   LRUHandle* Lookup(const Slice& key, uint32_t hash,
                     const Cache::CacheItemHelper* helper,
@@ -315,8 +410,12 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShardBase {
                     Cache::Priority priority, Statistics* stats);
 
   bool Release(LRUHandle* handle, bool useful, bool erase_if_last_ref);
+  void MultiLookup(const Slice* const* keys, const uint32_t* hashes, size_t n,
+                   LRUHandle** results);
+  void MultiRelease(LRUHandle* const* handles, size_t n, bool useful);
   bool Ref(LRUHandle* handle);
   void Erase(const Slice& key, uint32_t hash);
+  bool PeekEvictionCandidate(size_t charge, uint32_t* victim);
 
   // Although in some platforms the update of size_t is atomic, to make sure
   // GetUsage() and GetPinnedUsage() work correctly under any platform, we'll
@@ -361,6 +460,12 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShardBase {
   void LRU_Remove(LRUHandle* e);
   void LRU_Insert(LRUHandle* e);
 
+  // Lookup and Release, except for freeing the entry, under mutex_.
+  // ReleaseUnderLock returns whether the entry must be freed.
+  LRUHandle* LookupUnderLock(const Slice& key, uint32_t hash);
+  bool ReleaseUnderLock(LRUHandle* e, bool erase_if_last_ref,
+                        bool* was_in_cache);
+
   // Overflow the last entry in high-pri pool to low-pri pool until size of
   // high-pri pool is no larger than the size specify by high_pri_pool_pct.
   void MaintainPoolSize();
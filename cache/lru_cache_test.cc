@@ -5,7 +5,9 @@
 
 #include "cache/lru_cache.h"
 
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -45,7 +47,8 @@ class LRUCacheTest : public testing::Test {
 
   void NewCache(size_t capacity, double high_pri_pool_ratio = 0.0,
                 double low_pri_pool_ratio = 1.0,
-                bool use_adaptive_mutex = kDefaultToAdaptiveMutex) {
+                bool use_adaptive_mutex = kDefaultToAdaptiveMutex,
+                bool use_swiss_table = false) {
     DeleteCache();
     cache_ = reinterpret_cast<LRUCacheShard*>(
         port::cacheline_aligned_alloc(sizeof(LRUCacheShard)));
@@ -53,7 +56,8 @@ class LRUCacheTest : public testing::Test {
                                high_pri_pool_ratio, low_pri_pool_ratio,
                                use_adaptive_mutex, kDontChargeCacheMetadata,
                                /*max_upper_hash_bits=*/24,
-                               /*allocator*/ nullptr, &eviction_callback_);
+                               /*allocator*/ nullptr, &eviction_callback_,
+                               use_swiss_table);
   }
 
   void Insert(const std::string& key,
@@ -81,6 +85,35 @@ class LRUCacheTest : public testing::Test {
 
   void Erase(const std::string& key) { cache_->Erase(key, 0 /*hash*/); }
 
+  void InsertWithHash(const std::string& key, uint32_t hash) {
+    EXPECT_OK(cache_->Insert(key, hash, nullptr /*value*/,
+                             &kNoopCacheItemHelper, 1 /*charge*/,
+                             nullptr /*handle*/, Cache::Priority::LOW));
+  }
+
+  void EraseWithHash(const std::string& key, uint32_t hash) {
+    cache_->Erase(key, hash);
+  }
+
+  // Calls ApplyToSomeEntries() until done, calling between_calls after each
+  // call, and returns the keys visited.
+  std::vector<std::string> ApplyToAllEntriesInSteps(
+      size_t average_entries_per_lock,
+      const std::function<void()>& between_calls) {
+    std::vector<std::string> keys;
+    size_t state = 0;
+    while (state != SIZE_MAX) {
+      cache_->ApplyToSomeEntries(
+          [&](const Slice& key, Cache::ObjectPtr, size_t,
+              const Cache::CacheItemHelper*) {
+            keys.push_back(key.ToString());
+          },
+          average_entries_per_lock, &state);
+      between_calls();
+    }
+    return keys;
+  }
+
   void ValidateLRUList(std::vector<std::string> keys,
                        size_t num_high_pri_pool_keys = 0,
                        size_t num_low_pri_pool_keys = 0,
@@ -175,6 +208,115 @@ TEST_F(LRUCacheTest, BasicLRU) {
   ValidateLRUList({"e", "z", "d", "u", "v"}, 0, 5);
 }
 
+TEST_F(LRUCacheTest, SwissTable) {
+  // The keys inserted here all have hash 0, so they probe past full groups
+  // of slots with the same tag.
+  NewCache(100, /*high_pri_pool_ratio=*/0.0, /*low_pri_pool_ratio=*/1.0,
+           kDefaultToAdaptiveMutex, /*use_swiss_table=*/true);
+  for (int i = 0; i < 100; i++) {
+    Insert(std::to_string(i));
+  }
+  for (int i = 0; i < 100; i++) {
+    ASSERT_TRUE(Lookup(std::to_string(i)));
+  }
+  for (int i = 0; i < 100; i += 2) {
+    Erase(std::to_string(i));
+  }
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(i % 2 == 1, Lookup(std::to_string(i)));
+  }
+  // Reusing the deleted slots
+  for (int i = 100; i < 150; i++) {
+    Insert(std::to_string(i));
+  }
+  for (int i = 0; i < 150; i++) {
+    ASSERT_EQ(i % 2 == 1 || i >= 100, Lookup(std::to_string(i)));
+  }
+  // Evicting in LRU order
+  for (int i = 150; i < 160; i++) {
+    Insert(std::to_string(i));
+  }
+  for (int i = 0; i < 160; i++) {
+    ASSERT_EQ((i % 2 == 1 && i > 20) || i >= 100, Lookup(std::to_string(i)));
+  }
+
+  // With distinct hashes, growing the table
+  LRUCacheOptions opts;
+  opts.capacity = 1 << 20;
+  opts.num_shard_bits = 0;
+  opts.metadata_charge_policy = kDontChargeCacheMetadata;
+  opts.use_swiss_table = true;
+  std::shared_ptr<Cache> cache = opts.MakeSharedCache();
+  Random rnd(301);
+  std::set<std::string> keys;
+  for (int i = 0; i < 20000; i++) {
+    std::string key = std::to_string(rnd.Uniform(5000));
+    if (rnd.OneIn(3)) {
+      cache->Erase(key);
+      keys.erase(key);
+    } else {
+      ASSERT_OK(cache->Insert(key, nullptr, &kNoopCacheItemHelper, 1));
+      keys.insert(key);
+    }
+  }
+  ASSERT_EQ(keys.size(), cache->GetOccupancyCount());
+  ASSERT_GE(cache->GetTableAddressCount(), keys.size() * 8 / 7);
+  for (int i = 0; i < 5000; i++) {
+    std::string key = std::to_string(i);
+    Cache::Handle* h = cache->Lookup(key);
+    ASSERT_EQ(keys.count(key) > 0, h != nullptr);
+    if (h != nullptr) {
+      cache->Release(h);
+    }
+  }
+  size_t count = 0;
+  cache->ApplyToAllEntries(
+      [&](const Slice& key, Cache::ObjectPtr, size_t,
+          const Cache::CacheItemHelper*) {
+        ASSERT_EQ(1U, keys.count(key.ToString()));
+        count++;
+      },
+      {});
+  ASSERT_EQ(keys.size(), count);
+}
+
+TEST_F(LRUCacheTest, SwissTableApplyToSomeEntries) {
+  // Entries present throughout are visited exactly once, even as the table
+  // is rehashed between calls and entries sit past their home slots, some
+  // wrapping around to the start of the table.
+  NewCache(1 << 20, /*high_pri_pool_ratio=*/0.0, /*low_pri_pool_ratio=*/1.0,
+           kDefaultToAdaptiveMutex, /*use_swiss_table=*/true);
+  Random rnd(301);
+  std::map<std::string, int> visits;
+  for (int i = 0; i < 300; i++) {
+    std::string key = "s" + std::to_string(i);
+    // A third of the entries share the highest home slots
+    InsertWithHash(key, i % 3 == 0 ? 0xFFFFFFFFU - i : rnd.Next());
+    visits[key] = 0;
+  }
+  int other = 0;
+  std::vector<std::string> keys = ApplyToAllEntriesInSteps(4, [&]() {
+    // Growing the table, and leaving tombstones
+    for (int i = 0; i < 20 && other < 4000; i++) {
+      std::string key = "o" + std::to_string(other++);
+      uint32_t hash = i % 4 == 0 ? 0xFFFFFFFFU - other : rnd.Next();
+      InsertWithHash(key, hash);
+      if (i % 2 == 0) {
+        EraseWithHash(key, hash);
+      }
+    }
+  });
+  for (const auto& key : keys) {
+    auto it = visits.find(key);
+    if (it != visits.end()) {
+      it->second++;
+    }
+  }
+  for (const auto& entry : visits) {
+    ASSERT_EQ(1, entry.second) << entry.first;
+  }
+}
+
 TEST_F(LRUCacheTest, LowPriorityMidpointInsertion) {
   // Allocate 2 cache entries to high-pri pool and 3 to low-pri pool.
   NewCache(5, /* high_pri_pool_ratio */ 0.40, /* low_pri_pool_ratio */ 0.60);
@@ -445,6 +587,14 @@ class ClockCacheTest : public testing::Test {
     return Slice(reinterpret_cast<const char*>(&hashed_key), 16U);
   }
 
+  // For tests through the public Cache API
+  static std::string NumKey(int k) {
+    std::string key;
+    PutFixed64(&key, static_cast<uint64_t>(k));
+    key.append(8, '\0');
+    return key;
+  }
+
   static inline UniqueId64x2 TestHashedKey(char key) {
     // For testing hash near-collision behavior, put the variance in
     // hashed_key in bits that are unlikely to be used as hash bits.
@@ -885,6 +1035,104 @@ TEST_F(ClockCacheTest, TableSizesTest) {
   }
 }
 
+// estimated_entry_charge = 0 selects a table that grows as entries are added,
+// so that shifting entry sizes neither strands capacity nor overfills it
+TEST_F(ClockCacheTest, AutoTableGrowthTest) {
+  constexpr size_t kCapacity = 1 << 20;
+  HyperClockCacheOptions opts(kCapacity, /*estimated_entry_charge*/ 0,
+                              /*num_shard_bits*/ 0,
+                              /*strict_capacity_limit*/ false,
+                              /*memory_allocator*/ nullptr,
+                              kDontChargeCacheMetadata);
+  opts.min_avg_entry_charge = 10;
+  auto cache = opts.MakeSharedCache();
+  EXPECT_EQ(std::string(cache->Name()), "AutoHyperClockCache");
+  EXPECT_LE(cache->GetTableAddressCount(), 64U);
+
+  // Shrink the entries (and grow their number) in phases
+  int key_num = 0;
+  for (size_t charge : {10000U, 100U, 10U}) {
+    SCOPED_TRACE("charge = " + std::to_string(charge));
+    const int first_key = key_num;
+    const size_t count = kCapacity / charge;
+    for (size_t i = 0; i < count; ++i) {
+      ASSERT_OK(cache->Insert(NumKey(key_num++), /*value*/ nullptr,
+                              &kNoopCacheItemHelper, charge));
+    }
+    EXPECT_LE(cache->GetUsage(), kCapacity);
+    // Within the load factor, so most of the capacity is used
+    EXPECT_GE(cache->GetTableAddressCount(),
+              cache->GetOccupancyCount() / kLoadFactor);
+    EXPECT_GE(cache->GetUsage(), kCapacity * 3 / 4);
+
+    // Most of the newest entries are still there
+    size_t found = 0;
+    for (int k = first_key; k < key_num; ++k) {
+      Cache::Handle* h = cache->Lookup(NumKey(k));
+      if (h) {
+        ++found;
+        cache->Release(h);
+      }
+    }
+    EXPECT_GE(found, count / 2);
+  }
+}
+
+TEST_F(ClockCacheTest, AutoTableConcurrentGrowthTest) {
+  constexpr int kThreads = 4;
+  constexpr int kKeysPerThread = 10000;
+  constexpr size_t kCharge = 100;
+  HyperClockCacheOptions opts(
+      2 * kThreads * kKeysPerThread * kCharge, /*estimated_entry_charge*/ 0,
+      /*num_shard_bits*/ 0, /*strict_capacity_limit*/ false,
+      /*memory_allocator*/ nullptr, kDontChargeCacheMetadata);
+  opts.min_avg_entry_charge = kCharge;
+  auto cache = opts.MakeSharedCache();
+
+  // Inserts, lookups and erases racing with table growth
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&cache, t]() {
+      for (int i = 0; i < kKeysPerThread; ++i) {
+        std::string key = NumKey(t * kKeysPerThread + i);
+        Cache::Handle* h = nullptr;
+        ASSERT_OK(cache->Insert(key, /*value*/ nullptr, &kNoopCacheItemHelper,
+                                kCharge, &h));
+        ASSERT_NE(h, nullptr);
+        cache->Release(h);
+        if (i % 10 == 0) {
+          cache->Erase(key);
+        }
+        // Could be a false miss during a concurrent split
+        h = cache->Lookup(NumKey(t * kKeysPerThread + i / 2));
+        if (h) {
+          cache->Release(h);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Nothing was evicted, and erased entries stay erased
+  size_t count = 0;
+  for (int k = 0; k < kThreads * kKeysPerThread; ++k) {
+    Cache::Handle* h = cache->Lookup(NumKey(k));
+    if (k % kKeysPerThread % 10 == 0) {
+      EXPECT_EQ(h, nullptr);
+    } else {
+      EXPECT_NE(h, nullptr);
+    }
+    if (h) {
+      ++count;
+      cache->Release(h);
+    }
+  }
+  EXPECT_EQ(cache->GetOccupancyCount(), count);
+  EXPECT_EQ(cache->GetUsage(), count * kCharge);
+}
+
 }  // namespace clock_cache
 
 class TestSecondaryCache : public SecondaryCache {
@@ -0,0 +1,204 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/miss_ratio_curve.h"
+
+#include <algorithm>
+
+#include "util/math.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Access times available between renumberings, per sampled key
+constexpr size_t kTimesPerKey = 4;
+// Sampled accesses between decays of the histogram, per sampled key
+constexpr size_t kAccessesPerKeyBetweenDecays = 32;
+}  // namespace
+
+MissRatioCurveEstimator::MissRatioCurveEstimator(size_t max_sampled_keys)
+    : max_sampled_keys_(std::max(max_sampled_keys, size_t{1})),
+      // Times are 1-based, as is the Fenwick tree
+      fenwick_(kTimesPerKey * max_sampled_keys_ + 2) {
+  samples_.reserve(max_sampled_keys_ + 1);
+}
+
+int MissRatioCurveEstimator::BucketOf(uint64_t distance) {
+  if (distance < 4) {
+    return static_cast<int>(distance);
+  }
+  int log2 = FloorLog2(distance);
+  int sub = static_cast<int>(distance >> (log2 - 2)) & 3;
+  return 4 * (log2 - 1) + sub;
+}
+
+uint64_t MissRatioCurveEstimator::BucketLowerBound(int bucket) {
+  if (bucket < 4) {
+    return static_cast<uint64_t>(bucket);
+  }
+  int log2 = bucket / 4 + 1;
+  return uint64_t{4 + static_cast<uint64_t>(bucket % 4)} << (log2 - 2);
+}
+
+void MissRatioCurveEstimator::FenwickAdd(uint32_t time, int64_t delta) {
+  for (size_t i = time; i < fenwick_.size(); i += i & (~i + 1)) {
+    fenwick_[i] += static_cast<uint64_t>(delta);
+  }
+}
+
+uint64_t MissRatioCurveEstimator::FenwickPrefixSum(uint32_t time) const {
+  uint64_t sum = 0;
+  for (size_t i = time; i > 0; i -= i & (~i + 1)) {
+    sum += fenwick_[i];
+  }
+  return sum;
+}
+
+uint32_t MissRatioCurveEstimator::NextTime() {
+  if (clock_ + 1 >= fenwick_.size()) {
+    // Renumber the last accesses 1..n, in the same order
+    std::vector<std::pair<uint32_t, Sample*>> order;
+    order.reserve(samples_.size());
+    for (auto& kv : samples_) {
+      order.emplace_back(kv.second.time, &kv.second);
+    }
+    std::sort(order.begin(), order.end());
+    std::fill(fenwick_.begin(), fenwick_.end(), 0);
+    clock_ = 0;
+    for (auto& entry : order) {
+      entry.second->time = ++clock_;
+      FenwickAdd(clock_, static_cast<int64_t>(entry.second->size));
+    }
+  }
+  return ++clock_;
+}
+
+void MissRatioCurveEstimator::LowerThreshold() {
+  uint32_t threshold = threshold_.load(std::memory_order_relaxed);
+  while (samples_.size() > max_sampled_keys_) {
+    // Stop sampling every key with the largest sample value (usually one)
+    threshold = by_sample_value_.rbegin()->first;
+    while (!by_sample_value_.empty() &&
+           by_sample_value_.rbegin()->first >= threshold) {
+      auto it = std::prev(by_sample_value_.end());
+      auto sample = samples_.find(it->second);
+      FenwickAdd(sample->second.time,
+                 -static_cast<int64_t>(sample->second.size));
+      samples_.erase(sample);
+      by_sample_value_.erase(it);
+    }
+  }
+  threshold_.store(threshold, std::memory_order_relaxed);
+}
+
+void MissRatioCurveEstimator::MaybeDecay() {
+  if (++accesses_since_decay_ >=
+      kAccessesPerKeyBetweenDecays * max_sampled_keys_) {
+    for (double& count : reuses_) {
+      count /= 2;
+    }
+    cold_accesses_ /= 2;
+    accesses_since_decay_ = 0;
+  }
+}
+
+bool MissRatioCurveEstimator::RecordAccess(uint64_t hash, size_t charge,
+                                           uint64_t* reuse_distance) {
+  uint32_t sample_value = SampleValue(hash);
+  MutexLock l(&mutex_);
+  uint32_t threshold = threshold_.load(std::memory_order_relaxed);
+  if (sample_value >= threshold) {
+    // Lost a race with LowerThreshold
+    return false;
+  }
+  double weight = static_cast<double>(kSampleModulus) / threshold;
+  MaybeDecay();
+
+  auto it = samples_.find(hash);
+  if (it == samples_.end()) {
+    cold_accesses_ += weight;
+    uint32_t time = NextTime();
+    samples_.emplace(hash, Sample{time, sample_value, charge});
+    by_sample_value_.emplace(sample_value, hash);
+    FenwickAdd(time, static_cast<int64_t>(charge));
+    if (samples_.size() > max_sampled_keys_) {
+      LowerThreshold();
+    }
+    return false;
+  }
+
+  Sample& sample = it->second;
+  if (charge > 0 && charge != sample.size) {
+    FenwickAdd(sample.time,
+               static_cast<int64_t>(charge) -
+                   static_cast<int64_t>(sample.size));
+    sample.size = charge;
+  }
+  // Total size of the other sampled keys accessed since, scaled up to all
+  // keys, plus this entry
+  uint64_t since = FenwickPrefixSum(clock_) - FenwickPrefixSum(sample.time);
+  uint64_t distance =
+      static_cast<uint64_t>(static_cast<double>(since) * weight) + sample.size;
+  reuses_[BucketOf(distance)] += weight;
+
+  FenwickAdd(sample.time, -static_cast<int64_t>(sample.size));
+  sample.time = NextTime();
+  FenwickAdd(sample.time, static_cast<int64_t>(sample.size));
+  *reuse_distance = distance;
+  return true;
+}
+
+void MissRatioCurveEstimator::RecordInsert(uint64_t hash, size_t charge) {
+  if (!IsSampled(hash)) {
+    return;
+  }
+  MutexLock l(&mutex_);
+  auto it = samples_.find(hash);
+  if (it != samples_.end() && it->second.size != charge) {
+    FenwickAdd(it->second.time, static_cast<int64_t>(charge) -
+                                    static_cast<int64_t>(it->second.size));
+    it->second.size = charge;
+  }
+}
+
+std::vector<double> MissRatioCurveEstimator::EstimateHitRatios(
+    const std::vector<size_t>& capacities) const {
+  std::vector<double> hit_ratios(capacities.size(), 0.0);
+  MutexLock l(&mutex_);
+  double total = cold_accesses_;
+  for (double count : reuses_) {
+    total += count;
+  }
+  if (total <= 0) {
+    return hit_ratios;
+  }
+  for (size_t i = 0; i < capacities.size(); ++i) {
+    // A reuse hits in an LRU cache at least as large as its reuse distance.
+    // Assume distances are uniform within a bucket.
+    double capacity = static_cast<double>(capacities[i]);
+    double hits = 0;
+    for (int b = 0; b < kNumBuckets; ++b) {
+      double lower = static_cast<double>(BucketLowerBound(b));
+      if (lower > capacity) {
+        break;
+      }
+      double upper = b + 1 < kNumBuckets
+                         ? static_cast<double>(BucketLowerBound(b + 1))
+                         : 2 * lower;
+      hits += reuses_[b] * std::min(1.0, (capacity - lower + 1) /
+                                             (upper - lower));
+    }
+    hit_ratios[i] = hits / total;
+  }
+  return hit_ratios;
+}
+
+double MissRatioCurveEstimator::GetSamplingRate() const {
+  return static_cast<double>(threshold_.load(std::memory_order_relaxed)) /
+         kSampleModulus;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,116 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Online estimator of the miss ratio curve (hit ratio as a function of
+// capacity) of an LRU cache, from the accesses to a live cache, using
+// spatially hashed sampling of reuse distances ("Efficient MRC Construction
+// with SHARDS", Waldspurger et al., FAST '15).
+//
+// Only keys whose hash falls under a threshold are tracked. For those, the
+// reuse distance of an access is the total size of the distinct sampled keys
+// accessed since the previous access to the same key (plus its own size),
+// scaled up by the inverse of the sampling rate: an LRU cache of at least
+// that capacity would have hit. The threshold starts at sampling every key
+// and is lowered as needed to track at most a fixed number of keys
+// (fixed-size SHARDS), so that memory is bounded and, in steady state, only a
+// small fraction of accesses takes the mutex. Older accesses are decayed so
+// that the curve follows changes in the workload.
+//
+// Thread-safe.
+class MissRatioCurveEstimator {
+ public:
+  explicit MissRatioCurveEstimator(size_t max_sampled_keys = 8192);
+
+  // Whether accesses to the key with the given hash are sampled. Cheap, for
+  // skipping work to prepare a RecordAccess.
+  bool IsSampled(uint64_t hash) const {
+    return SampleValue(hash) < threshold_.load(std::memory_order_relaxed);
+  }
+
+  // Records an access to the key with the given hash. `charge` is the size
+  // of the entry, or 0 when not known (on a miss; see RecordInsert). If the
+  // access is sampled and the key was accessed before, returns true with the
+  // estimated reuse distance in *reuse_distance.
+  bool RecordAccess(uint64_t hash, size_t charge, uint64_t* reuse_distance);
+
+  // Records the size of the entry for a key on insertion (after a miss).
+  void RecordInsert(uint64_t hash, size_t charge);
+
+  // Estimated hit ratios (in [0, 1]) of an LRU cache with each of the given
+  // capacities, from the accesses recorded so far
+  std::vector<double> EstimateHitRatios(
+      const std::vector<size_t>& capacities) const;
+
+  // Current sampling rate, in (0, 1]
+  double GetSamplingRate() const;
+
+ private:
+  // Sampling decisions are on 24 bits of a remix of the key hash
+  static constexpr uint32_t kSampleModulus = uint32_t{1} << 24;
+  static uint32_t SampleValue(uint64_t hash) {
+    return static_cast<uint32_t>((hash * 0x9E3779B97F4A7C15U) >> 40);
+  }
+
+  // Reuse distance histogram buckets: four per power of two
+  static constexpr int kNumBuckets = 4 * 64;
+  static int BucketOf(uint64_t distance);
+  static uint64_t BucketLowerBound(int bucket);
+
+  struct Sample {
+    // Position of the last access in the access order, for the Fenwick tree
+    uint32_t time;
+    uint32_t sample_value;
+    size_t size;
+  };
+
+  // Fenwick tree over access times of the sizes of the keys last accessed
+  // at that time, for the total size of keys accessed since a given time
+  void FenwickAdd(uint32_t time, int64_t delta);
+  uint64_t FenwickPrefixSum(uint32_t time) const;
+
+  // Gives a new time to an access, renumbering the last access times of all
+  // sampled keys when the tree is exhausted
+  uint32_t NextTime();
+
+  // Stops sampling the keys with the largest sample value until at most
+  // max_sampled_keys_ remain
+  void LowerThreshold();
+
+  // Halves the histogram when enough accesses have been recorded
+  void MaybeDecay();
+
+  const size_t max_sampled_keys_;
+  std::atomic<uint32_t> threshold_{kSampleModulus};
+
+  mutable port::Mutex mutex_;
+  std::unordered_map<uint64_t, Sample> samples_;
+  // (sample_value, hash) of sampled keys, for LowerThreshold
+  std::set<std::pair<uint32_t, uint64_t>> by_sample_value_;
+  std::vector<uint64_t> fenwick_;
+  uint32_t clock_ = 0;
+
+  // Accesses weighted by the inverse of the sampling rate: reuses by reuse
+  // distance bucket, and first accesses (cold misses)
+  std::array<double, kNumBuckets> reuses_{};
+  double cold_accesses_ = 0;
+  size_t accesses_since_decay_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
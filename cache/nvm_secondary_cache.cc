@@ -0,0 +1,435 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/nvm_secondary_cache.h"
+
+#include <cinttypes>
+#include <cstring>
+
+#include "util/coding.h"
+#include "util/crc32c.h"
+#include "util/hash.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+const std::string kSegmentFileSuffix = ".nvmcache";
+}  // namespace
+
+NvmSecondaryCache::NvmSecondaryCache(const NvmSecondaryCacheOptions& opts)
+    : opts_(opts),
+      fs_(opts.file_system ? opts.file_system : FileSystem::Default()),
+      capacity_(opts.capacity) {}
+
+NvmSecondaryCache::~NvmSecondaryCache() {
+  if (writer_) {
+    writer_->Close(IOOptions(), nullptr).PermitUncheckedError();
+    writer_.reset();
+  }
+  // Handles must not outlive the cache, so no read is in flight
+  for (auto& it : segments_by_id_) {
+    fs_->DeleteFile(it.second->file_name, IOOptions(), nullptr)
+        .PermitUncheckedError();
+  }
+}
+
+std::string NvmSecondaryCache::SegmentFileName(uint32_t id) const {
+  return opts_.path + "/" + std::to_string(id) + kSegmentFileSuffix;
+}
+
+size_t NvmSecondaryCache::MaxSealedSegments() const {
+  return capacity_.load(std::memory_order_relaxed) / opts_.segment_size - 1;
+}
+
+Status NvmSecondaryCache::Open() {
+  if (opts_.path.empty()) {
+    return Status::InvalidArgument("NvmSecondaryCache path is empty");
+  }
+  if (opts_.segment_size == 0 || opts_.segment_size > UINT32_MAX) {
+    return Status::InvalidArgument(
+        "NvmSecondaryCache segment_size must be in (0, 4GB)");
+  }
+  if (opts_.capacity < 2 * opts_.segment_size) {
+    return Status::InvalidArgument(
+        "NvmSecondaryCache capacity must be at least two segments");
+  }
+  IOOptions io_opts;
+  IOStatus s = fs_->CreateDirIfMissing(opts_.path, io_opts, nullptr);
+  if (!s.ok()) {
+    return s;
+  }
+  // Nothing survives a restart, so drop what a previous instance left
+  std::vector<std::string> children;
+  s = fs_->GetChildren(opts_.path, io_opts, &children, nullptr);
+  if (!s.ok()) {
+    return s;
+  }
+  for (const auto& child : children) {
+    if (EndsWith(child, kSegmentFileSuffix)) {
+      s = fs_->DeleteFile(opts_.path + "/" + child, io_opts, nullptr);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+  }
+  MutexLock l(&write_mutex_);
+  return StartNewSegment();
+}
+
+Status NvmSecondaryCache::StartNewSegment() {
+  write_mutex_.AssertHeld();
+  IOOptions io_opts;
+  if (writer_) {
+    writer_->Close(io_opts, nullptr).PermitUncheckedError();
+    writer_.reset();
+  }
+  if (active_) {
+    MutexLock l(&segments_mutex_);
+    sealed_.push_back(std::move(active_));
+  }
+  EvictSegments(MaxSealedSegments());
+
+  auto segment = std::make_shared<Segment>();
+  segment->id = next_segment_id_++;
+  segment->file_name = SegmentFileName(segment->id);
+  FileOptions file_opts;
+  IOStatus s =
+      fs_->NewWritableFile(segment->file_name, file_opts, &writer_, nullptr);
+  if (s.ok()) {
+    s = fs_->NewRandomAccessFile(segment->file_name, file_opts,
+                                 &segment->reader, nullptr);
+  }
+  if (!s.ok()) {
+    if (writer_) {
+      writer_->Close(io_opts, nullptr).PermitUncheckedError();
+      writer_.reset();
+    }
+    fs_->DeleteFile(segment->file_name, io_opts, nullptr)
+        .PermitUncheckedError();
+    // Inserts retry with another segment
+    active_offset_ = opts_.segment_size;
+    return s;
+  }
+  active_offset_ = 0;
+  MutexLock l(&segments_mutex_);
+  segments_by_id_[segment->id] = segment;
+  active_ = std::move(segment);
+  return Status::OK();
+}
+
+void NvmSecondaryCache::EvictSegments(size_t max_sealed) {
+  write_mutex_.AssertHeld();
+  for (;;) {
+    std::shared_ptr<Segment> victim;
+    {
+      MutexLock l(&segments_mutex_);
+      if (sealed_.size() <= max_sealed) {
+        return;
+      }
+      if (opts_.clock_eviction) {
+        // Give each segment with a hit since the last pass another round,
+        // but only once, so that eviction is bounded
+        for (size_t i = sealed_.size(); i > 0; --i) {
+          auto& front = sealed_.front();
+          if (!front->referenced.exchange(false, std::memory_order_relaxed)) {
+            break;
+          }
+          sealed_.push_back(std::move(front));
+          sealed_.pop_front();
+        }
+      }
+      victim = std::move(sealed_.front());
+      sealed_.pop_front();
+      segments_by_id_.erase(victim->id);
+    }
+    for (uint64_t key_hash : victim->key_hashes) {
+      IndexShard& shard = GetIndexShard(key_hash);
+      MutexLock l(&shard.mutex);
+      auto it = shard.map.find(key_hash);
+      if (it != shard.map.end() && it->second.segment_id == victim->id) {
+        shard.map.erase(it);
+      }
+    }
+    // Reads in flight keep the file open (on POSIX, readable after delete)
+    fs_->DeleteFile(victim->file_name, IOOptions(), nullptr)
+        .PermitUncheckedError();
+  }
+}
+
+std::shared_ptr<NvmSecondaryCache::Segment> NvmSecondaryCache::GetSegment(
+    uint32_t id) {
+  MutexLock l(&segments_mutex_);
+  auto it = segments_by_id_.find(id);
+  return it == segments_by_id_.end() ? nullptr : it->second;
+}
+
+Status NvmSecondaryCache::Insert(const Slice& key, Cache::ObjectPtr value,
+                                 const Cache::CacheItemHelper* helper) {
+  if (!helper || !helper->IsSecondaryCacheCompatible()) {
+    return Status::OK();
+  }
+  size_t value_size = helper->size_cb(value);
+  size_t record_size = kRecordHeaderSize + key.size() + value_size;
+  if (record_size > opts_.segment_size) {
+    return Status::OK();
+  }
+  std::unique_ptr<char[]> record(new char[record_size]);
+  EncodeFixed32(record.get() + 4, static_cast<uint32_t>(key.size()));
+  EncodeFixed32(record.get() + 8, static_cast<uint32_t>(value_size));
+  memcpy(record.get() + kRecordHeaderSize, key.data(), key.size());
+  Status s = helper->saveto_cb(value, 0, value_size,
+                               record.get() + kRecordHeaderSize + key.size());
+  if (!s.ok()) {
+    return s;
+  }
+  EncodeFixed32(record.get(), crc32c::Mask(crc32c::Value(record.get() + 4,
+                                                         record_size - 4)));
+  uint64_t key_hash = GetSliceNPHash64(key);
+
+  MutexLock l(&write_mutex_);
+  if (active_offset_ + record_size > opts_.segment_size) {
+    s = StartNewSegment();
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  IOOptions io_opts;
+  IOStatus io_s =
+      writer_->Append(Slice(record.get(), record_size), io_opts, nullptr);
+  if (io_s.ok()) {
+    // Make the record visible to the readers
+    io_s = writer_->Flush(io_opts, nullptr);
+  }
+  if (!io_s.ok()) {
+    // The tail of the segment is in an unknown state, so move on
+    active_offset_ = opts_.segment_size;
+    return io_s;
+  }
+  Location loc{active_->id, static_cast<uint32_t>(active_offset_),
+               static_cast<uint32_t>(record_size)};
+  active_offset_ += record_size;
+  active_->key_hashes.push_back(key_hash);
+  IndexShard& shard = GetIndexShard(key_hash);
+  MutexLock sl(&shard.mutex);
+  shard.map[key_hash] = loc;
+  return Status::OK();
+}
+
+std::unique_ptr<SecondaryCacheResultHandle> NvmSecondaryCache::Lookup(
+    const Slice& key, const Cache::CacheItemHelper* helper,
+    Cache::CreateContext* create_context, bool wait, bool /*advise_erase*/,
+    bool& kept_in_sec_cache) {
+  assert(helper);
+  // Records stay until their segment is evicted
+  kept_in_sec_cache = true;
+  if (!helper->create_cb) {
+    return nullptr;
+  }
+  uint64_t key_hash = GetSliceNPHash64(key);
+  Location loc;
+  {
+    IndexShard& shard = GetIndexShard(key_hash);
+    MutexLock l(&shard.mutex);
+    auto it = shard.map.find(key_hash);
+    if (it == shard.map.end()) {
+      return nullptr;
+    }
+    loc = it->second;
+  }
+  std::shared_ptr<Segment> segment = GetSegment(loc.segment_id);
+  if (!segment) {
+    return nullptr;
+  }
+  segment->referenced.store(true, std::memory_order_relaxed);
+
+  std::unique_ptr<NvmSecondaryCacheResultHandle> handle(
+      new NvmSecondaryCacheResultHandle(this, key, helper, create_context));
+  handle->StartRead(std::move(segment), loc.offset, loc.size, wait);
+  if (handle->IsReady() && handle->Value() == nullptr) {
+    return nullptr;
+  }
+  return handle;
+}
+
+void NvmSecondaryCache::Erase(const Slice& key) {
+  uint64_t key_hash = GetSliceNPHash64(key);
+  IndexShard& shard = GetIndexShard(key_hash);
+  MutexLock l(&shard.mutex);
+  shard.map.erase(key_hash);
+}
+
+void NvmSecondaryCache::WaitAll(
+    std::vector<SecondaryCacheResultHandle*> handles) {
+  std::vector<void*> io_handles;
+  for (auto* h : handles) {
+    auto* handle = static_cast<NvmSecondaryCacheResultHandle*>(h);
+    if (!handle->IsReady() && handle->io_handle_ && !handle->read_done_) {
+      io_handles.push_back(handle->io_handle_);
+    }
+  }
+  if (!io_handles.empty()) {
+    fs_->Poll(io_handles, io_handles.size()).PermitUncheckedError();
+  }
+  for (auto* h : handles) {
+    auto* handle = static_cast<NvmSecondaryCacheResultHandle*>(h);
+    if (!handle->IsReady()) {
+      handle->Finish();
+    }
+  }
+}
+
+Status NvmSecondaryCache::SetCapacity(size_t capacity) {
+  if (capacity < 2 * opts_.segment_size) {
+    return Status::InvalidArgument(
+        "NvmSecondaryCache capacity must be at least two segments");
+  }
+  MutexLock l(&write_mutex_);
+  capacity_.store(capacity, std::memory_order_relaxed);
+  EvictSegments(MaxSealedSegments());
+  return Status::OK();
+}
+
+Status NvmSecondaryCache::GetCapacity(size_t& capacity) {
+  capacity = capacity_.load(std::memory_order_relaxed);
+  return Status::OK();
+}
+
+std::string NvmSecondaryCache::GetPrintableOptions() const {
+  std::string ret;
+  ret.reserve(20000);
+  const int kBufferSize = 200;
+  char buffer[kBufferSize];
+  snprintf(buffer, kBufferSize, "    path : %s\n", opts_.path.c_str());
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    capacity : %" ROCKSDB_PRIszt "\n",
+           capacity_.load(std::memory_order_relaxed));
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    segment_size : %" ROCKSDB_PRIszt "\n",
+           opts_.segment_size);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    clock_eviction : %d\n",
+           opts_.clock_eviction);
+  ret.append(buffer);
+  return ret;
+}
+
+size_t NvmSecondaryCache::TEST_GetNumSegments() {
+  MutexLock l(&segments_mutex_);
+  return segments_by_id_.size();
+}
+
+NvmSecondaryCacheResultHandle::NvmSecondaryCacheResultHandle(
+    NvmSecondaryCache* cache, const Slice& key,
+    const Cache::CacheItemHelper* helper, Cache::CreateContext* create_context)
+    : cache_(cache),
+      key_(key.ToString()),
+      helper_(helper),
+      create_context_(create_context) {}
+
+NvmSecondaryCacheResultHandle::~NvmSecondaryCacheResultHandle() {
+  if (!ready_) {
+    // Reap the read without creating a value
+    std::vector<void*> io_handles;
+    if (io_handle_ && !read_done_) {
+      io_handles.push_back(io_handle_);
+      cache_->fs_->Poll(io_handles, 1).PermitUncheckedError();
+    }
+    if (io_handle_ && del_fn_) {
+      del_fn_(io_handle_);
+    }
+  }
+}
+
+void NvmSecondaryCacheResultHandle::StartRead(
+    std::shared_ptr<NvmSecondaryCache::Segment>&& segment, uint32_t offset,
+    uint32_t size, bool wait) {
+  segment_ = std::move(segment);
+  buf_.reset(new char[size]);
+  req_.offset = offset;
+  req_.len = size;
+  req_.scratch = buf_.get();
+  IOOptions io_opts;
+  if (!wait) {
+    IOStatus s = segment_->reader->ReadAsync(req_, io_opts, &OnReadDone, this,
+                                             &io_handle_, &del_fn_, nullptr);
+    if (s.ok()) {
+      if (read_done_) {
+        // Completed inline
+        Finish();
+      }
+      return;
+    }
+    // Not supported, or failed to submit
+    io_handle_ = nullptr;
+    del_fn_ = nullptr;
+  }
+  req_.status = segment_->reader->Read(offset, size, io_opts, &req_.result,
+                                       buf_.get(), nullptr);
+  read_done_ = true;
+  Finish();
+}
+
+void NvmSecondaryCacheResultHandle::OnReadDone(const FSReadRequest& req,
+                                               void* arg) {
+  auto* handle = static_cast<NvmSecondaryCacheResultHandle*>(arg);
+  handle->req_.status = req.status;
+  handle->req_.result = req.result;
+  handle->read_done_ = true;
+}
+
+void NvmSecondaryCacheResultHandle::Finish() {
+  if (io_handle_) {
+    if (!read_done_) {
+      std::vector<void*> io_handles{io_handle_};
+      cache_->fs_->Poll(io_handles, 1).PermitUncheckedError();
+    }
+    if (del_fn_) {
+      del_fn_(io_handle_);
+    }
+    io_handle_ = nullptr;
+  }
+  ready_ = true;
+
+  const Slice& rec = req_.result;
+  if (read_done_ && req_.status.ok() && rec.size() == req_.len &&
+      rec.size() >= NvmSecondaryCache::kRecordHeaderSize) {
+    uint32_t key_size = DecodeFixed32(rec.data() + 4);
+    uint32_t value_size = DecodeFixed32(rec.data() + 8);
+    if (NvmSecondaryCache::kRecordHeaderSize + uint64_t{key_size} +
+                value_size ==
+            rec.size() &&
+        crc32c::Unmask(DecodeFixed32(rec.data())) ==
+            crc32c::Value(rec.data() + 4, rec.size() - 4) &&
+        Slice(rec.data() + NvmSecondaryCache::kRecordHeaderSize, key_size) ==
+            Slice(key_)) {
+      Slice value(rec.data() + NvmSecondaryCache::kRecordHeaderSize + key_size,
+                  value_size);
+      Status s = helper_->create_cb(value, create_context_,
+                                    /*allocator=*/nullptr, &value_, &size_);
+      if (!s.ok()) {
+        value_ = nullptr;
+        size_ = 0;
+      }
+    }
+  }
+  req_.status.PermitUncheckedError();
+  buf_.reset();
+  segment_.reset();
+}
+
+void NvmSecondaryCacheResultHandle::Wait() { cache_->WaitAll({this}); }
+
+Status NewNvmSecondaryCache(const NvmSecondaryCacheOptions& opts,
+                            std::shared_ptr<SecondaryCache>* result) {
+  auto cache = std::make_shared<NvmSecondaryCache>(opts);
+  Status s = cache->Open();
+  if (s.ok()) {
+    *result = std::move(cache);
+  }
+  return s;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
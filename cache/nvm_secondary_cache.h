@@ -0,0 +1,201 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/file_system.h"
+#include "rocksdb/secondary_cache.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class NvmSecondaryCache;
+
+// NvmSecondaryCache is a SecondaryCache on local storage, typically an NVMe
+// SSD, for blocks that miss in RAM when the SST files are on slower (e.g.
+// network) storage.
+//
+// Entries are appended, as records of key, value and checksum, to the active
+// segment file, and located through an in-memory index from a 64-bit hash of
+// the key to the segment and offset of the record. (The key in the record is
+// checked on read, so hash collisions only cost a miss.) When the active
+// segment is full, it is sealed and a new one started, and when that exceeds
+// the capacity, a whole sealed segment is evicted: the oldest one (FIFO), or
+// with clock eviction, the oldest one without a hit since the clock last
+// passed it. Records replaced or erased stay on disk until their segment is
+// evicted.
+//
+// Lookups with wait=false submit the read with FSRandomAccessFile::ReadAsync
+// (io_uring for the default FileSystem on Linux) and complete it in Wait()
+// or WaitAll(), so a batch of lookups, as from MultiGet, overlaps its reads.
+// Because FileSystem::Poll() reaps the I/O of the calling thread, a handle
+// must be waited on by the thread that looked it up. When ReadAsync is not
+// supported, lookups read synchronously.
+class NvmSecondaryCache : public SecondaryCache {
+ public:
+  explicit NvmSecondaryCache(const NvmSecondaryCacheOptions& opts);
+  ~NvmSecondaryCache() override;
+
+  const char* Name() const override { return "NvmSecondaryCache"; }
+
+  // Deletes segment files left in the directory and prepares the first
+  // segment. Must succeed before the cache is used.
+  Status Open();
+
+  Status Insert(const Slice& key, Cache::ObjectPtr value,
+                const Cache::CacheItemHelper* helper) override;
+
+  std::unique_ptr<SecondaryCacheResultHandle> Lookup(
+      const Slice& key, const Cache::CacheItemHelper* helper,
+      Cache::CreateContext* create_context, bool wait, bool advise_erase,
+      bool& kept_in_sec_cache) override;
+
+  bool SupportForceErase() const override { return false; }
+
+  void Erase(const Slice& key) override;
+
+  void WaitAll(std::vector<SecondaryCacheResultHandle*> handles) override;
+
+  Status SetCapacity(size_t capacity) override;
+
+  Status GetCapacity(size_t& capacity) override;
+
+  std::string GetPrintableOptions() const override;
+
+  // Number of segment files, including the active one
+  size_t TEST_GetNumSegments();
+
+ private:
+  friend class NvmSecondaryCacheResultHandle;
+
+  // Record header: masked crc32c of the rest of the record, key size, value
+  // size
+  static constexpr size_t kRecordHeaderSize = 12;
+
+  struct Segment {
+    uint32_t id = 0;
+    std::string file_name;
+    // Shared with in-flight reads (through the Segment), so that the file of
+    // an evicted segment stays open until they finish
+    std::unique_ptr<FSRandomAccessFile> reader;
+    // Key hashes of the records appended, to drop their index entries on
+    // eviction. Protected by write_mutex_.
+    std::vector<uint64_t> key_hashes;
+    // Set on a hit, cleared when the clock passes the segment
+    std::atomic<bool> referenced{false};
+  };
+
+  // Location of a record, in the index
+  struct Location {
+    uint32_t segment_id;
+    uint32_t offset;
+    uint32_t size;
+  };
+
+  struct IndexShard {
+    port::Mutex mutex;
+    std::unordered_map<uint64_t, Location> map;
+  };
+  static constexpr size_t kNumIndexShards = 16;
+
+  IndexShard& GetIndexShard(uint64_t key_hash) {
+    return index_[key_hash % kNumIndexShards];
+  }
+
+  std::string SegmentFileName(uint32_t id) const;
+
+  // Seals the active segment (if any), evicts segments down to the capacity,
+  // and starts a new active segment. REQUIRES: write_mutex_ held
+  Status StartNewSegment();
+
+  // Evicts sealed segments until at most `max_sealed` remain.
+  // REQUIRES: write_mutex_ held
+  void EvictSegments(size_t max_sealed);
+
+  // Returns the segment with the given id, or nullptr if it was evicted
+  std::shared_ptr<Segment> GetSegment(uint32_t id);
+
+  size_t MaxSealedSegments() const;
+
+  NvmSecondaryCacheOptions opts_;
+  std::shared_ptr<FileSystem> fs_;
+  std::atomic<size_t> capacity_;
+
+  IndexShard index_[kNumIndexShards];
+
+  // Serializes Insert and segment changes
+  port::Mutex write_mutex_;
+  std::unique_ptr<FSWritableFile> writer_;
+  uint64_t active_offset_ = 0;
+  uint32_t next_segment_id_ = 0;
+
+  // Protects the segment lists below
+  port::Mutex segments_mutex_;
+  std::shared_ptr<Segment> active_;
+  // Sealed segments, in clock order (oldest or next to check first)
+  std::deque<std::shared_ptr<Segment>> sealed_;
+  std::unordered_map<uint32_t, std::shared_ptr<Segment>> segments_by_id_;
+};
+
+// Result of a NvmSecondaryCache lookup, with the read maybe in flight
+class NvmSecondaryCacheResultHandle : public SecondaryCacheResultHandle {
+ public:
+  NvmSecondaryCacheResultHandle(NvmSecondaryCache* cache, const Slice& key,
+                                const Cache::CacheItemHelper* helper,
+                                Cache::CreateContext* create_context);
+  ~NvmSecondaryCacheResultHandle() override;
+
+  NvmSecondaryCacheResultHandle(const NvmSecondaryCacheResultHandle&) = delete;
+  NvmSecondaryCacheResultHandle& operator=(
+      const NvmSecondaryCacheResultHandle&) = delete;
+
+  bool IsReady() override { return ready_; }
+
+  void Wait() override;
+
+  Cache::ObjectPtr Value() override { return value_; }
+
+  size_t Size() override { return size_; }
+
+ private:
+  friend class NvmSecondaryCache;
+
+  // Starts reading the record, asynchronously unless `wait` (or unsupported)
+  void StartRead(std::shared_ptr<NvmSecondaryCache::Segment>&& segment,
+                 uint32_t offset, uint32_t size, bool wait);
+
+  static void OnReadDone(const FSReadRequest& req, void* arg);
+
+  // Checks the record and creates the value. Sets ready_.
+  void Finish();
+
+  NvmSecondaryCache* const cache_;
+  const std::string key_;
+  const Cache::CacheItemHelper* const helper_;
+  Cache::CreateContext* const create_context_;
+
+  std::shared_ptr<NvmSecondaryCache::Segment> segment_;
+  std::unique_ptr<char[]> buf_;
+  FSReadRequest req_;
+  // For a read submitted with ReadAsync and not yet reaped
+  void* io_handle_ = nullptr;
+  IOHandleDeleter del_fn_;
+  bool read_done_ = false;
+
+  bool ready_ = false;
+  Cache::ObjectPtr value_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,305 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/nvm_secondary_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/convenience.h"
+#include "test_util/secondary_cache_test_util.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+using secondary_cache_test_util::GetTestingCacheTypes;
+using secondary_cache_test_util::WithCacheType;
+using secondary_cache_test_util::WithCacheTypeParam;
+
+namespace {
+// 16 bytes for HCC compatibility
+std::string Key(int i) {
+  char buf[17];
+  snprintf(buf, sizeof(buf), "____    key%05d", i);
+  return buf;
+}
+}  // namespace
+
+class NvmSecondaryCacheTest : public testing::Test, public WithCacheType {
+ public:
+  NvmSecondaryCacheTest()
+      : path_(test::PerThreadDBPath("nvm_secondary_cache_test")) {}
+
+  const std::string& Type() override { return type_; }
+
+ protected:
+  std::shared_ptr<NvmSecondaryCache> NewSecondaryCache(
+      size_t capacity, size_t segment_size, bool clock_eviction = true) {
+    NvmSecondaryCacheOptions opts(path_, capacity);
+    opts.segment_size = segment_size;
+    opts.clock_eviction = clock_eviction;
+    auto sec_cache = std::make_shared<NvmSecondaryCache>(opts);
+    EXPECT_OK(sec_cache->Open());
+    return sec_cache;
+  }
+
+  // Returns the value of `key` in `sec_cache`, or "" on a miss
+  std::string Get(SecondaryCache* sec_cache, const std::string& key,
+                  bool wait = true) {
+    bool kept_in_sec_cache = false;
+    std::unique_ptr<SecondaryCacheResultHandle> handle = sec_cache->Lookup(
+        key, GetHelper(), this, wait, /*advise_erase=*/false,
+        kept_in_sec_cache);
+    if (!handle) {
+      return "";
+    }
+    EXPECT_TRUE(kept_in_sec_cache);
+    handle->Wait();
+    EXPECT_TRUE(handle->IsReady());
+    std::unique_ptr<TestItem> val(static_cast<TestItem*>(handle->Value()));
+    if (!val) {
+      return "";
+    }
+    EXPECT_EQ(handle->Size(), val->Size());
+    return val->ToString();
+  }
+
+  std::string type_ = kLRU;
+  std::string path_;
+};
+
+TEST_F(NvmSecondaryCacheTest, BasicTest) {
+  auto sec_cache = NewSecondaryCache(1 << 20, 64 << 10);
+  ASSERT_EQ(Get(sec_cache.get(), Key(0)), "");
+
+  Random rnd(301);
+  std::string str1 = rnd.RandomString(1000);
+  TestItem item1(str1.data(), str1.length());
+  ASSERT_OK(sec_cache->Insert(Key(1), &item1, GetHelper()));
+  ASSERT_EQ(Get(sec_cache.get(), Key(1)), str1);
+  // Still there after a hit
+  ASSERT_EQ(Get(sec_cache.get(), Key(1)), str1);
+  ASSERT_EQ(Get(sec_cache.get(), Key(2)), "");
+
+  // A newer value replaces the old one
+  std::string str2 = rnd.RandomString(500);
+  TestItem item2(str2.data(), str2.length());
+  ASSERT_OK(sec_cache->Insert(Key(1), &item2, GetHelper()));
+  ASSERT_EQ(Get(sec_cache.get(), Key(1)), str2);
+
+  // Not secondary cache compatible
+  ASSERT_OK(sec_cache->Insert(Key(3), &item1, GetHelper(
+                                                  CacheEntryRole::kDataBlock,
+                                                  /*secondary_compatible=*/
+                                                  false)));
+  ASSERT_EQ(Get(sec_cache.get(), Key(3)), "");
+
+  sec_cache->Erase(Key(1));
+  ASSERT_EQ(Get(sec_cache.get(), Key(1)), "");
+
+  // Failing to create the object is a miss
+  ASSERT_OK(sec_cache->Insert(Key(4), &item1, GetHelper()));
+  SetFailCreate(true);
+  ASSERT_EQ(Get(sec_cache.get(), Key(4)), "");
+  SetFailCreate(false);
+  ASSERT_EQ(Get(sec_cache.get(), Key(4)), str1);
+}
+
+TEST_F(NvmSecondaryCacheTest, AsyncLookupTest) {
+  auto sec_cache = NewSecondaryCache(1 << 20, 64 << 10);
+  Random rnd(302);
+  std::vector<std::string> values;
+  for (int i = 0; i < 20; ++i) {
+    values.push_back(rnd.RandomString(100 + i * 50));
+    TestItem item(values.back().data(), values.back().size());
+    ASSERT_OK(sec_cache->Insert(Key(i), &item, GetHelper()));
+  }
+
+  // Start all the lookups, including misses, then wait for them together
+  std::vector<std::unique_ptr<SecondaryCacheResultHandle>> handles;
+  std::vector<SecondaryCacheResultHandle*> pending;
+  for (int i = 0; i < 25; ++i) {
+    bool kept_in_sec_cache = false;
+    handles.push_back(sec_cache->Lookup(Key(i), GetHelper(), this,
+                                        /*wait=*/false,
+                                        /*advise_erase=*/false,
+                                        kept_in_sec_cache));
+    if (i >= 20) {
+      ASSERT_EQ(handles.back(), nullptr);
+    } else {
+      ASSERT_NE(handles.back(), nullptr);
+      pending.push_back(handles.back().get());
+    }
+  }
+  sec_cache->WaitAll(pending);
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_TRUE(handles[i]->IsReady());
+    std::unique_ptr<TestItem> val(static_cast<TestItem*>(handles[i]->Value()));
+    ASSERT_NE(val, nullptr);
+    ASSERT_EQ(val->ToString(), values[i]);
+  }
+
+  // Handles dropped without waiting (when the read is still in flight)
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(Get(sec_cache.get(), Key(i), /*wait=*/false), values[i]);
+    bool kept_in_sec_cache = false;
+    auto handle = sec_cache->Lookup(Key(i), GetHelper(), this, /*wait=*/false,
+                                    /*advise_erase=*/false, kept_in_sec_cache);
+    ASSERT_NE(handle, nullptr);
+    if (handle->IsReady()) {
+      // Read synchronously, so the value is ours
+      delete static_cast<TestItem*>(handle->Value());
+    }
+  }
+}
+
+TEST_F(NvmSecondaryCacheTest, EvictionTest) {
+  for (bool clock_eviction : {false, true}) {
+    SCOPED_TRACE("clock_eviction=" + std::to_string(clock_eviction));
+    // Three 1000 byte values per segment, and at most one sealed segment
+    auto sec_cache = NewSecondaryCache(8 << 10, 4 << 10, clock_eviction);
+    Random rnd(303);
+    std::vector<std::string> values;
+    for (int i = 0; i < 6; ++i) {
+      values.push_back(rnd.RandomString(1000));
+      TestItem item(values.back().data(), values.back().size());
+      ASSERT_OK(sec_cache->Insert(Key(i), &item, GetHelper()));
+    }
+    ASSERT_EQ(sec_cache->TEST_GetNumSegments(), 2U);
+    // A hit in the older segment
+    ASSERT_EQ(Get(sec_cache.get(), Key(0)), values[0]);
+
+    values.push_back(rnd.RandomString(1000));
+    TestItem item(values.back().data(), values.back().size());
+    ASSERT_OK(sec_cache->Insert(Key(6), &item, GetHelper()));
+    ASSERT_EQ(sec_cache->TEST_GetNumSegments(), 2U);
+    ASSERT_EQ(Get(sec_cache.get(), Key(6)), values[6]);
+    if (clock_eviction) {
+      // The segment with the hit got a second chance
+      ASSERT_EQ(Get(sec_cache.get(), Key(0)), values[0]);
+      ASSERT_EQ(Get(sec_cache.get(), Key(3)), "");
+    } else {
+      ASSERT_EQ(Get(sec_cache.get(), Key(0)), "");
+      ASSERT_EQ(Get(sec_cache.get(), Key(3)), values[3]);
+    }
+
+    // Too big for a segment
+    std::string big = rnd.RandomString(5000);
+    TestItem big_item(big.data(), big.size());
+    ASSERT_OK(sec_cache->Insert(Key(7), &big_item, GetHelper()));
+    ASSERT_EQ(Get(sec_cache.get(), Key(7)), "");
+
+    ASSERT_NOK(sec_cache->SetCapacity(4 << 10));
+    size_t capacity = 0;
+    ASSERT_OK(sec_cache->GetCapacity(capacity));
+    ASSERT_EQ(capacity, size_t{8} << 10);
+  }
+}
+
+TEST_F(NvmSecondaryCacheTest, InvalidOptionsTest) {
+  std::shared_ptr<SecondaryCache> sec_cache;
+  NvmSecondaryCacheOptions opts("", 1 << 20);
+  ASSERT_NOK(NewNvmSecondaryCache(opts, &sec_cache));
+  opts.path = path_;
+  opts.segment_size = 1 << 20;
+  ASSERT_NOK(NewNvmSecondaryCache(opts, &sec_cache));
+  opts.segment_size = 0;
+  ASSERT_NOK(NewNvmSecondaryCache(opts, &sec_cache));
+  ASSERT_EQ(sec_cache, nullptr);
+  opts.segment_size = 64 << 10;
+  ASSERT_OK(NewNvmSecondaryCache(opts, &sec_cache));
+  ASSERT_NE(sec_cache, nullptr);
+}
+
+TEST_F(NvmSecondaryCacheTest, CreateFromStringTest) {
+  ConfigOptions config_options;
+  std::shared_ptr<SecondaryCache> sec_cache;
+  ASSERT_OK(SecondaryCache::CreateFromString(
+      config_options,
+      "nvm_secondary_cache://path=" + path_ +
+          ";capacity=1048576;segment_size=65536;clock_eviction=false",
+      &sec_cache));
+  ASSERT_NE(sec_cache, nullptr);
+  ASSERT_STREQ(sec_cache->Name(), "NvmSecondaryCache");
+  size_t capacity = 0;
+  ASSERT_OK(sec_cache->GetCapacity(capacity));
+  ASSERT_EQ(capacity, size_t{1} << 20);
+}
+
+class NvmSecondaryCacheWithCacheTest : public testing::Test,
+                                       public WithCacheTypeParam {
+ public:
+  NvmSecondaryCacheWithCacheTest()
+      : path_(test::PerThreadDBPath("nvm_secondary_cache_test")) {}
+
+ protected:
+  std::string path_;
+};
+
+TEST_P(NvmSecondaryCacheWithCacheTest, BasicIntegrationTest) {
+  NvmSecondaryCacheOptions sec_cache_opts(path_, 1 << 20);
+  sec_cache_opts.segment_size = 64 << 10;
+  std::shared_ptr<SecondaryCache> sec_cache;
+  ASSERT_OK(NewNvmSecondaryCache(sec_cache_opts, &sec_cache));
+  std::shared_ptr<Cache> cache = NewCache(
+      /*capacity=*/2300, /*num_shard_bits=*/0,
+      /*strict_capacity_limit=*/false, sec_cache);
+
+  // Three values, only two of which fit in the primary cache, so that
+  // evictions spill into the secondary cache
+  Random rnd(304);
+  std::vector<std::string> values;
+  for (int i = 0; i < 3; ++i) {
+    values.push_back(rnd.RandomString(1000 + i * 10));
+    auto item =
+        std::make_unique<TestItem>(values.back().data(), values.back().size());
+    ASSERT_OK(cache->Insert(Key(i), item.get(), GetHelper(),
+                            values.back().size()));
+    item.release();
+  }
+
+  for (int i = 0; i < 3; ++i) {
+    Cache::Handle* handle =
+        cache->Lookup(Key(i), GetHelper(), this, Cache::Priority::LOW);
+    ASSERT_NE(handle, nullptr);
+    ASSERT_EQ(static_cast<TestItem*>(cache->Value(handle))->ToString(),
+              values[i]);
+    cache->Release(handle);
+  }
+
+  // Async lookups through the primary cache, waited on together
+  std::string keys[4];
+  Cache::AsyncLookupHandle async_handles[4];
+  for (int i = 0; i < 4; ++i) {
+    keys[i] = Key(i);
+    async_handles[i].key = keys[i];
+    async_handles[i].helper = GetHelper();
+    async_handles[i].create_context = this;
+    cache->StartAsyncLookup(async_handles[i]);
+  }
+  cache->WaitAll(async_handles, 4);
+  for (int i = 0; i < 3; ++i) {
+    Cache::Handle* handle = async_handles[i].Result();
+    ASSERT_NE(handle, nullptr);
+    ASSERT_EQ(static_cast<TestItem*>(cache->Value(handle))->ToString(),
+              values[i]);
+    cache->Release(handle);
+  }
+  ASSERT_EQ(async_handles[3].Result(), nullptr);
+}
+
+INSTANTIATE_TEST_CASE_P(NvmSecondaryCacheWithCacheTest,
+                        NvmSecondaryCacheWithCacheTest, GetTestingCacheTypes());
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
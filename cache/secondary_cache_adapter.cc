@@ -300,6 +300,26 @@ void CacheWithSecondaryAdapter::StartAsyncLookupOnMySecondary(
 void CacheWithSecondaryAdapter::StartAsyncLookup(
     AsyncLookupHandle& async_handle) {
   target_->StartAsyncLookup(async_handle);
+  ProcessPrimaryResult(async_handle);
+}
+
+void CacheWithSecondaryAdapter::MultiLookup(AsyncLookupHandle* async_handles,
+                                            size_t count) {
+  target_->MultiLookup(async_handles, count);
+  for (size_t i = 0; i < count; ++i) {
+    ProcessPrimaryResult(async_handles[i]);
+  }
+}
+
+void CacheWithSecondaryAdapter::MultiRelease(Handle** handles, size_t count,
+                                             bool useful) {
+  // Nothing to do for secondary cache reservations without
+  // erase_if_last_ref (see Release)
+  target_->MultiRelease(handles, count, useful);
+}
+
+void CacheWithSecondaryAdapter::ProcessPrimaryResult(
+    AsyncLookupHandle& async_handle) {
   if (!async_handle.IsPending()) {
     bool secondary_compatible =
         async_handle.helper &&
@@ -38,6 +38,11 @@ class CacheWithSecondaryAdapter : public CacheWrapper {
 
   void WaitAll(AsyncLookupHandle* async_handles, size_t count) override;
 
+  void MultiLookup(AsyncLookupHandle* async_handles, size_t count) override;
+
+  void MultiRelease(Handle** handles, size_t count,
+                    bool useful = true) override;
+
   std::string GetPrintableOptions() const override;
 
   const char* Name() const override;
@@ -51,6 +56,10 @@ class CacheWithSecondaryAdapter : public CacheWrapper {
 
   void StartAsyncLookupOnMySecondary(AsyncLookupHandle& async_handle);
 
+  // After the primary cache lookup of an async handle, for a dummy entry or
+  // a miss
+  void ProcessPrimaryResult(AsyncLookupHandle& async_handle);
+
   Handle* Promote(
       std::unique_ptr<SecondaryCacheResultHandle>&& secondary_handle,
       const Slice& key, const CacheItemHelper* helper, Priority priority,
@@ -14,6 +14,7 @@
 #include <memory>
 
 #include "env/unique_id_gen.h"
+#include "monitoring/statistics_impl.h"
 #include "rocksdb/env.h"
 #include "util/hash.h"
 #include "util/math.h"
@@ -55,6 +56,28 @@ uint32_t DetermineSeed(int32_t hash_seed_option) {
     return val & kSeedMask;
   }
 }
+
+// Typical size of a data block, for sizing the TinyLFU sketch by default
+constexpr size_t kDefaultAdmissionEntryCharge = 4096;
+
+std::unique_ptr<TinyLfu> MakeTinyLfu(const ShardedCacheOptions& opts) {
+  if (!opts.tiny_lfu_admission) {
+    return nullptr;
+  }
+  size_t expected_entries = opts.tiny_lfu_expected_entries;
+  if (expected_entries == 0) {
+    expected_entries = opts.capacity / kDefaultAdmissionEntryCharge;
+  }
+  return std::make_unique<TinyLfu>(expected_entries);
+}
+
+std::unique_ptr<MissRatioCurveEstimator> MakeMissRatioCurveEstimator(
+    const ShardedCacheOptions& opts) {
+  if (!opts.estimate_miss_ratio_curve) {
+    return nullptr;
+  }
+  return std::make_unique<MissRatioCurveEstimator>();
+}
 }  // namespace
 
 ShardedCacheBase::ShardedCacheBase(const ShardedCacheOptions& opts)
@@ -62,6 +85,9 @@ ShardedCacheBase::ShardedCacheBase(const ShardedCacheOptions& opts)
       last_id_(1),
       shard_mask_((uint32_t{1} << opts.num_shard_bits) - 1),
       hash_seed_(DetermineSeed(opts.hash_seed)),
+      tiny_lfu_(MakeTinyLfu(opts)),
+      mrc_(MakeMissRatioCurveEstimator(opts)),
+      statistics_(opts.statistics),
       strict_capacity_limit_(opts.strict_capacity_limit),
       capacity_(opts.capacity) {}
 
@@ -74,6 +100,33 @@ size_t ShardedCacheBase::GetPerShardCapacity() const {
   return ComputePerShardCapacity(GetCapacity());
 }
 
+bool ShardedCacheBase::AdmitInsert(uint64_t candidate_hash,
+                                   uint64_t victim_hash) {
+  bool admit = tiny_lfu_->Admit(candidate_hash, victim_hash);
+  RecordTick(statistics_.get(),
+             admit ? BLOCK_CACHE_TINY_LFU_ADMIT : BLOCK_CACHE_TINY_LFU_REJECT);
+  return admit;
+}
+
+void ShardedCacheBase::RecordSampledLookup(uint64_t sketch_hash,
+                                           size_t charge) {
+  uint64_t reuse_distance;
+  if (mrc_->RecordAccess(sketch_hash, charge, &reuse_distance)) {
+    RecordInHistogram(statistics_.get(), BLOCK_CACHE_REUSE_DISTANCE_BYTES,
+                      reuse_distance);
+  }
+}
+
+bool ShardedCacheBase::EstimateHitRatios(
+    const std::vector<size_t>& capacities,
+    std::vector<double>* hit_ratios) const {
+  if (mrc_ == nullptr) {
+    return false;
+  }
+  *hit_ratios = mrc_->EstimateHitRatios(capacities);
+  return true;
+}
+
 uint64_t ShardedCacheBase::NewId() {
   return last_id_.fetch_add(1, std::memory_order_relaxed);
 }
@@ -112,6 +165,12 @@ std::string ShardedCacheBase::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "    memory_allocator : %s\n",
            memory_allocator() ? memory_allocator()->Name() : "None");
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    tiny_lfu_admission : %d\n",
+           tiny_lfu_ != nullptr);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    estimate_miss_ratio_curve : %d\n",
+           mrc_ != nullptr);
+  ret.append(buffer);
   AppendPrintableOptions(ret);
   return ret;
 }
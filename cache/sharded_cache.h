@@ -9,11 +9,17 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <cstdint>
+#include <memory>
 #include <string>
 
+#include "cache/miss_ratio_curve.h"
+#include "cache/tiny_lfu.h"
 #include "port/lang.h"
+#include "port/likely.h"
 #include "port/port.h"
 #include "rocksdb/advanced_cache.h"
 #include "util/hash.h"
@@ -40,6 +46,9 @@ class CacheShardBase {
   static inline uint32_t HashPieceForSharding(HashCref hash) {
     return Lower32of64(hash);
   }
+  // For the TinyLFU frequency sketch and miss ratio curve sampling, 64 bits
+  // of the hash not used for sharding where possible
+  static inline uint64_t HashForSketches(HashCref hash) { return hash; }
   void AppendPrintableOptions(std::string& /*str*/) const {}
 
   // Must be provided for concept CacheShard (TODO with C++20 support)
@@ -55,13 +64,19 @@ class CacheShardBase {
                 bool standalone) = 0;
   Handle* CreateStandalone(const Slice& key, HashCref hash, ObjectPtr obj,
                            const CacheItemHelper* helper,
-                           size_t charge, bool allow_uncharged) = 0;
+                           size_t charge, bool allow_uncharged,
+                           bool evict = true) = 0;
   HandleImpl* Lookup(const Slice& key, HashCref hash,
                         const Cache::CacheItemHelper* helper,
                         Cache::CreateContext* create_context,
                         Cache::Priority priority,
                         Statistics* stats) = 0;
   bool Release(HandleImpl* handle, bool useful, bool erase_if_last_ref) = 0;
+  // Batched Lookup (without secondary cache parameters) and Release of
+  // entries all in this shard, for Cache::MultiLookup and MultiRelease
+  void MultiLookup(const Slice* const* keys, const HashVal* hashes, size_t n,
+                   HandleImpl** results) = 0;
+  void MultiRelease(HandleImpl* const* handles, size_t n, bool useful) = 0;
   bool Ref(HandleImpl* handle) = 0;
   void Erase(const Slice& key, HashCref hash) = 0;
   void SetCapacity(size_t capacity) = 0;
@@ -80,6 +95,10 @@ class CacheShardBase {
                                const Cache::CacheItemHelper* helper)>& callback,
       size_t average_entries_per_lock, size_t* state) = 0;
   void EraseUnRefEntries() = 0;
+  // For TinyLFU admission. If inserting an entry with `charge` would need to
+  // evict, and an entry that would be evicted first is found, sets `*victim`
+  // to its hash and returns true. Otherwise returns false.
+  bool PeekEvictionCandidate(size_t charge, HashVal* victim) = 0;
   */
 
  protected:
@@ -106,16 +125,40 @@ class ShardedCacheBase : public Cache {
 
   uint32_t GetHashSeed() const override { return hash_seed_; }
 
+  bool EstimateHitRatios(const std::vector<size_t>& capacities,
+                         std::vector<double>* hit_ratios) const override;
+
  protected:  // fns
   virtual void AppendPrintableOptions(std::string& str) const = 0;
   size_t GetPerShardCapacity() const;
   size_t ComputePerShardCapacity(size_t capacity) const;
 
+  // Whether inserting an entry with the given helper can be refused by
+  // TinyLFU admission: blocks, but not memory reservations and placeholders
+  static inline bool IsSubjectToAdmission(const CacheItemHelper* helper) {
+    return helper->role <= CacheEntryRole::kOtherBlock ||
+           helper->role == CacheEntryRole::kBlobValue;
+  }
+
+  // TinyLFU decision on inserting a key (by hash for admission) into a full
+  // shard in place of `victim_hash`, recorded in the tickers
+  bool AdmitInsert(uint64_t candidate_hash, uint64_t victim_hash);
+
+  // Records a lookup of a key sampled by the miss ratio curve estimator
+  // (`charge` 0 on a miss), and the reuse distance in the histogram
+  void RecordSampledLookup(uint64_t sketch_hash, size_t charge);
+
  protected:                        // data
   std::atomic<uint64_t> last_id_;  // For NewId
   const uint32_t shard_mask_;
   const uint32_t hash_seed_;
 
+  // For ShardedCacheOptions::tiny_lfu_admission, otherwise nullptr
+  const std::unique_ptr<TinyLfu> tiny_lfu_;
+  // For ShardedCacheOptions::estimate_miss_ratio_curve, otherwise nullptr
+  const std::unique_ptr<MissRatioCurveEstimator> mrc_;
+  const std::shared_ptr<Statistics> statistics_;
+
   // Dynamic configuration parameters, guarded by config_mutex_
   bool strict_capacity_limit_;
   size_t capacity_;
@@ -176,8 +219,36 @@ class ShardedCache : public ShardedCacheBase {
     assert(helper);
     HashVal hash = CacheShard::ComputeHash(key, hash_seed_);
     auto h_out = reinterpret_cast<HandleImpl**>(handle);
-    return GetShard(hash).Insert(key, hash, obj, helper, charge, h_out,
-                                 priority);
+    CacheShard& shard = GetShard(hash);
+    if (UNLIKELY(tiny_lfu_ != nullptr) && IsSubjectToAdmission(helper)) {
+      HashVal victim;
+      if (shard.PeekEvictionCandidate(charge, &victim) &&
+          !AdmitInsert(CacheShard::HashForSketches(hash),
+                       CacheShard::HashForSketches(victim))) {
+        // As if inserted and evicted right away. (Also drop any older entry
+        // for the key, which the insertion would have replaced.)
+        shard.Erase(key, hash);
+        if (h_out == nullptr) {
+          if (helper->del_cb) {
+            helper->del_cb(obj, memory_allocator());
+          }
+          return Status::OK();
+        }
+        // Charged while referenced, but without evicting anything
+        *h_out = shard.CreateStandalone(key, hash, obj, helper, charge,
+                                        /*allow_uncharged=*/false,
+                                        /*evict=*/false);
+        if (*h_out != nullptr) {
+          return Status::OK();
+        }
+        // Over a strict capacity limit (or key not supported); let Insert
+        // evict or report the error
+      }
+    }
+    if (UNLIKELY(mrc_ != nullptr)) {
+      mrc_->RecordInsert(CacheShard::HashForSketches(hash), charge);
+    }
+    return shard.Insert(key, hash, obj, helper, charge, h_out, priority);
   }
 
   Handle* CreateStandalone(const Slice& key, ObjectPtr obj,
@@ -195,11 +266,88 @@ class ShardedCache : public ShardedCacheBase {
                  Priority priority = Priority::LOW,
                  Statistics* stats = nullptr) override {
     HashVal hash = CacheShard::ComputeHash(key, hash_seed_);
+    if (UNLIKELY(tiny_lfu_ != nullptr)) {
+      tiny_lfu_->Record(CacheShard::HashForSketches(hash));
+    }
     HandleImpl* result = GetShard(hash).Lookup(key, hash, helper,
                                                create_context, priority, stats);
+    if (UNLIKELY(mrc_ != nullptr)) {
+      MaybeRecordSampledLookup(hash, result);
+    }
     return reinterpret_cast<Handle*>(result);
   }
 
+  void MultiLookup(AsyncLookupHandle* async_handles, size_t count) override {
+    for (size_t begin = 0; begin < count; begin += kMultiOpBatchSize) {
+      size_t n = std::min(count - begin, kMultiOpBatchSize);
+      AsyncLookupHandle* batch = async_handles + begin;
+      std::array<HashVal, kMultiOpBatchSize> hashes;
+      std::array<uint32_t, kMultiOpBatchSize> shard_of;
+      std::array<uint32_t, kMultiOpBatchSize> order;
+      for (size_t i = 0; i < n; ++i) {
+        batch[i].found_dummy_entry = false;  // in case re-used
+        assert(!batch[i].IsPending());
+        hashes[i] = CacheShard::ComputeHash(batch[i].key, hash_seed_);
+        if (UNLIKELY(tiny_lfu_ != nullptr)) {
+          tiny_lfu_->Record(CacheShard::HashForSketches(hashes[i]));
+        }
+        shard_of[i] = CacheShard::HashPieceForSharding(hashes[i]) & shard_mask_;
+        order[i] = static_cast<uint32_t>(i);
+      }
+      SortByShard(order.data(), n, shard_of.data());
+
+      std::array<const Slice*, kMultiOpBatchSize> keys;
+      std::array<HashVal, kMultiOpBatchSize> sorted_hashes;
+      std::array<HandleImpl*, kMultiOpBatchSize> results;
+      for (size_t j = 0; j < n; ++j) {
+        keys[j] = &batch[order[j]].key;
+        sorted_hashes[j] = hashes[order[j]];
+      }
+      ForEachShardRun(order.data(), n, shard_of.data(),
+                      [&](uint32_t shard, size_t j, size_t run) {
+                        shards_[shard].MultiLookup(
+                            &keys[j], &sorted_hashes[j], run, &results[j]);
+                      });
+      for (size_t j = 0; j < n; ++j) {
+        batch[order[j]].result_handle = reinterpret_cast<Handle*>(results[j]);
+        if (UNLIKELY(mrc_ != nullptr)) {
+          MaybeRecordSampledLookup(sorted_hashes[j], results[j]);
+        }
+      }
+    }
+  }
+
+  void MultiRelease(Handle** handles, size_t count,
+                    bool useful = true) override {
+    for (size_t begin = 0; begin < count; begin += kMultiOpBatchSize) {
+      size_t limit = std::min(count - begin, kMultiOpBatchSize);
+      std::array<HandleImpl*, kMultiOpBatchSize> batch;
+      std::array<uint32_t, kMultiOpBatchSize> shard_of;
+      std::array<uint32_t, kMultiOpBatchSize> order;
+      size_t n = 0;
+      for (size_t i = 0; i < limit; ++i) {
+        auto h = reinterpret_cast<HandleImpl*>(handles[begin + i]);
+        if (h != nullptr) {
+          batch[n] = h;
+          shard_of[n] = CacheShard::HashPieceForSharding(h->GetHash()) &
+                        shard_mask_;
+          order[n] = static_cast<uint32_t>(n);
+          ++n;
+        }
+      }
+      SortByShard(order.data(), n, shard_of.data());
+
+      std::array<HandleImpl*, kMultiOpBatchSize> sorted;
+      for (size_t j = 0; j < n; ++j) {
+        sorted[j] = batch[order[j]];
+      }
+      ForEachShardRun(order.data(), n, shard_of.data(),
+                      [&](uint32_t shard, size_t j, size_t run) {
+                        shards_[shard].MultiRelease(&sorted[j], run, useful);
+                      });
+    }
+  }
+
   void Erase(const Slice& key) override {
     HashVal hash = CacheShard::ComputeHash(key, hash_seed_);
     GetShard(hash).Erase(key, hash);
@@ -298,6 +446,45 @@ class ShardedCache : public ShardedCacheBase {
   }
 
  private:
+  // For estimate_miss_ratio_curve, with the result of a lookup. Only the
+  // sampled lookups need the charge of the entry found.
+  void MaybeRecordSampledLookup(HashCref hash, HandleImpl* result) {
+    uint64_t sketch_hash = CacheShard::HashForSketches(hash);
+    if (mrc_->IsSampled(sketch_hash)) {
+      RecordSampledLookup(
+          sketch_hash,
+          result ? GetCharge(reinterpret_cast<Handle*>(result)) : 0);
+    }
+  }
+
+  // Operations of MultiLookup and MultiRelease are grouped by shard in
+  // batches of up to this many
+  static constexpr size_t kMultiOpBatchSize = 64;
+
+  // Orders indexes `order[0..n)` by their shard in `shard_of`
+  static void SortByShard(uint32_t* order, size_t n,
+                          const uint32_t* shard_of) {
+    std::sort(order, order + n, [shard_of](uint32_t a, uint32_t b) {
+      return shard_of[a] < shard_of[b];
+    });
+  }
+
+  // Calls fn(shard, begin, length) for each run of sorted indexes into the
+  // same shard
+  template <typename Fn>
+  static void ForEachShardRun(const uint32_t* order, size_t n,
+                              const uint32_t* shard_of, const Fn& fn) {
+    for (size_t j = 0; j < n;) {
+      uint32_t shard = shard_of[order[j]];
+      size_t end = j + 1;
+      while (end < n && shard_of[order[end]] == shard) {
+        ++end;
+      }
+      fn(shard, j, end - j);
+      j = end;
+    }
+  }
+
   CacheShard* const shards_;
   bool destroy_shards_in_dtor_;
 };
@@ -0,0 +1,142 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/tiny_lfu.h"
+
+#include <algorithm>
+
+#include "util/hash.h"
+#include "util/math.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Bounds on the counters per row of the sketch
+constexpr size_t kMinWidth = 64;
+constexpr size_t kMaxWidth = size_t{1} << 26;
+
+size_t SketchWidth(size_t expected_entries) {
+  size_t width = std::min(std::max(expected_entries, kMinWidth), kMaxWidth);
+  // Round up to a power of two
+  int bits = FloorLog2(width);
+  if ((size_t{1} << bits) < width) {
+    ++bits;
+  }
+  return size_t{1} << bits;
+}
+
+constexpr uint64_t kLowThreeBitsOfNibbles = 0x7777777777777777U;
+}  // namespace
+
+TinyLfu::TinyLfu(size_t expected_entries)
+    : width_mask_(static_cast<uint32_t>(SketchWidth(expected_entries) - 1)),
+      // One byte of doorkeeper per counter of a row, for a false positive
+      // rate of a few percent at the expected number of entries
+      doorkeeper_mask_(static_cast<uint32_t>(8 * (width_mask_ + 1) - 1)),
+      sample_size_(10 * (size_t{width_mask_} + 1)),
+      counters_(new std::atomic<uint64_t>[kDepth * (width_mask_ + 1) /
+                                          kCountersPerWord]()),
+      doorkeeper_(new std::atomic<uint64_t>[(doorkeeper_mask_ + 1) / 64]()) {}
+
+TinyLfu::Indexes TinyLfu::GetIndexes(uint64_t hash) const {
+  Indexes indexes;
+  // Double hashing from two halves of a remix of the hash, which might not
+  // have entropy in all bits (e.g. only 32 bits)
+  uint64_t h = (hash ^ (hash >> 31)) * 0x9E3779B97F4A7C15U;
+  uint32_t a = Upper32of64(h);
+  uint32_t b = Lower32of64(h) | 1;
+  for (int i = 0; i < kDepth; ++i) {
+    indexes.counter[i] = i * (width_mask_ + 1) + ((a + i * b) & width_mask_);
+  }
+  uint64_t h2 = (h ^ (h >> 29)) * 0xBF58476D1CE4E5B9U;
+  indexes.doorkeeper[0] = Lower32of64(h2) & doorkeeper_mask_;
+  indexes.doorkeeper[1] = Upper32of64(h2) & doorkeeper_mask_;
+  return indexes;
+}
+
+uint32_t TinyLfu::GetCounter(uint32_t index) const {
+  uint64_t word = counters_[index / kCountersPerWord].load(
+      std::memory_order_relaxed);
+  return static_cast<uint32_t>(word >> (4 * (index % kCountersPerWord))) & 15;
+}
+
+bool TinyLfu::DoorkeeperTest(const Indexes& indexes) const {
+  for (uint32_t bit : indexes.doorkeeper) {
+    uint64_t word = doorkeeper_[bit / 64].load(std::memory_order_relaxed);
+    if ((word & (uint64_t{1} << (bit % 64))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TinyLfu::DoorkeeperTestAndSet(const Indexes& indexes) {
+  bool was_set = true;
+  for (uint32_t bit : indexes.doorkeeper) {
+    uint64_t mask = uint64_t{1} << (bit % 64);
+    auto& word = doorkeeper_[bit / 64];
+    // Avoid dirtying the cache line when already set
+    if ((word.load(std::memory_order_relaxed) & mask) == 0) {
+      was_set &= (word.fetch_or(mask, std::memory_order_relaxed) & mask) != 0;
+    }
+  }
+  return was_set;
+}
+
+void TinyLfu::Record(uint64_t hash) {
+  Indexes indexes = GetIndexes(hash);
+  if (DoorkeeperTestAndSet(indexes)) {
+    // Increment the smallest counters (conservative update), which keeps
+    // the overestimates of count-min down
+    uint32_t min_count = kMaxCount;
+    for (uint32_t index : indexes.counter) {
+      min_count = std::min(min_count, GetCounter(index));
+    }
+    if (min_count < kMaxCount) {
+      for (uint32_t index : indexes.counter) {
+        auto& word = counters_[index / kCountersPerWord];
+        int shift = 4 * (index % kCountersPerWord);
+        uint64_t old_word = word.load(std::memory_order_relaxed);
+        while (((old_word >> shift) & 15) == min_count &&
+               !word.compare_exchange_weak(old_word,
+                                           old_word + (uint64_t{1} << shift),
+                                           std::memory_order_relaxed)) {
+        }
+      }
+    }
+  }
+  if (additions_.fetch_add(1, std::memory_order_relaxed) + 1 ==
+      sample_size_) {
+    Age();
+  }
+}
+
+uint32_t TinyLfu::Estimate(uint64_t hash) const {
+  Indexes indexes = GetIndexes(hash);
+  uint32_t min_count = kMaxCount;
+  for (uint32_t index : indexes.counter) {
+    min_count = std::min(min_count, GetCounter(index));
+  }
+  // The doorkeeper holds the first access since the last aging
+  return min_count + (DoorkeeperTest(indexes) ? 1 : 0);
+}
+
+void TinyLfu::Age() {
+  size_t num_words = kDepth * (size_t{width_mask_} + 1) / kCountersPerWord;
+  for (size_t i = 0; i < num_words; ++i) {
+    uint64_t old_word = counters_[i].load(std::memory_order_relaxed);
+    while (!counters_[i].compare_exchange_weak(
+        old_word, (old_word >> 1) & kLowThreeBitsOfNibbles,
+        std::memory_order_relaxed)) {
+    }
+  }
+  size_t num_doorkeeper_words = (size_t{doorkeeper_mask_} + 1) / 64;
+  for (size_t i = 0; i < num_doorkeeper_words; ++i) {
+    doorkeeper_[i].store(0, std::memory_order_relaxed);
+  }
+  additions_.fetch_sub(sample_size_ / 2, std::memory_order_relaxed);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
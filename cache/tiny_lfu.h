@@ -0,0 +1,92 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Frequency estimator for a TinyLFU cache admission policy (see "TinyLFU: A
+// Highly Efficient Cache Admission Policy", Einziger, Friedman and Manes):
+// a new entry is only admitted into a full cache if its key has recently
+// been accessed more often than the key of the entry it would evict, so that
+// a burst of one-time accesses (e.g. a scan) does not flush the working set.
+//
+// Access counts are kept in a count-min sketch of 4-bit saturating counters,
+// behind a "doorkeeper" Bloom filter that absorbs the first access to each
+// key, so that the many keys accessed only once do not inflate the counters.
+// After a number of recorded accesses proportional to the sketch size, all
+// counters are halved and the doorkeeper is cleared (aging), so that the
+// estimates follow changes in the workload.
+//
+// Thread-safe and lock-free. Concurrent updates can be lost (and aging can
+// race with them), which only makes the estimates slightly less accurate.
+class TinyLfu {
+ public:
+  // `expected_entries` is roughly the number of entries in the cache.
+  explicit TinyLfu(size_t expected_entries);
+
+  // Records an access to the key with the given hash.
+  void Record(uint64_t hash);
+
+  // Returns the estimated number of recent accesses to the key with the given
+  // hash, at most kMaxCount + 1.
+  uint32_t Estimate(uint64_t hash) const;
+
+  // Whether a new entry for `candidate_hash` should be admitted in place of
+  // the entry for `victim_hash`.
+  bool Admit(uint64_t candidate_hash, uint64_t victim_hash) const {
+    return Estimate(candidate_hash) > Estimate(victim_hash);
+  }
+
+  // Number of recorded accesses between agings
+  size_t GetSampleSize() const { return sample_size_; }
+
+  static constexpr uint32_t kMaxCount = 15;
+
+ private:
+  // Rows of the count-min sketch
+  static constexpr int kDepth = 4;
+  static constexpr int kCountersPerWord = 16;
+
+  // Halves all counters and clears the doorkeeper.
+  void Age();
+
+  // Indexes of the counters for a key in each row, and of its doorkeeper
+  // bits, from the key hash
+  struct Indexes {
+    uint32_t counter[kDepth];
+    uint32_t doorkeeper[2];
+  };
+  Indexes GetIndexes(uint64_t hash) const;
+
+  uint32_t GetCounter(uint32_t index) const;
+
+  // Returns whether both doorkeeper bits were already set.
+  bool DoorkeeperTestAndSet(const Indexes& indexes);
+
+  bool DoorkeeperTest(const Indexes& indexes) const;
+
+  // Counters per row (a power of two), minus one
+  const uint32_t width_mask_;
+  // Bits in the doorkeeper (a power of two), minus one
+  const uint32_t doorkeeper_mask_;
+  const size_t sample_size_;
+
+  // kDepth rows of width_mask_ + 1 counters, packed kCountersPerWord to a
+  // word
+  std::unique_ptr<std::atomic<uint64_t>[]> counters_;
+  std::unique_ptr<std::atomic<uint64_t>[]> doorkeeper_;
+
+  // Accesses recorded since the last aging (roughly)
+  std::atomic<size_t> additions_{0};
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -360,6 +360,20 @@ class FullTypedCacheInterface
           async_handle);
     }
   }
+
+  // Batched StartAsyncLookupFull, with Cache::MultiLookup
+  inline void MultiLookupFull(
+      TypedAsyncLookupHandle* async_handles, size_t count,
+      CacheTier lowest_used_cache_tier = CacheTier::kNonVolatileBlockTier) {
+    const CacheItemHelper* helper =
+        lowest_used_cache_tier == CacheTier::kNonVolatileBlockTier
+            ? GetFullHelper()
+            : nullptr;
+    for (size_t i = 0; i < count; ++i) {
+      async_handles[i].helper = helper;
+    }
+    this->cache_->MultiLookup(async_handles, count);
+  }
 };
 
 // FullTypedSharedCacheInterface - Like FullTypedCacheInterface but with a
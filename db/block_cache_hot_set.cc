@@ -0,0 +1,90 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/block_cache_hot_set.h"
+
+#include <algorithm>
+
+#include "util/coding.h"
+#include "util/crc32c.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+std::string BlockCacheHotSetFileName(const std::string& dbname) {
+  return dbname + "/BLOCK_CACHE_HOT_SET";
+}
+
+void EncodeBlockCacheHotSet(const std::vector<BlockCacheHotSetFile>& set,
+                            std::string* dst) {
+  const size_t start = dst->size();
+  PutVarint64(dst, set.size());
+  for (const BlockCacheHotSetFile& file : set) {
+    assert(std::is_sorted(file.data_block_offsets.begin(),
+                          file.data_block_offsets.end()));
+    PutVarint32Varint64(dst, file.column_family_id, file.file_number);
+    PutVarint32(dst, static_cast<uint32_t>(file.level));
+    dst->push_back(file.index_and_filter ? 1 : 0);
+    PutVarint64(dst, file.data_block_offsets.size());
+    uint64_t prev = 0;
+    for (uint64_t offset : file.data_block_offsets) {
+      PutVarint64(dst, offset - prev);
+      prev = offset;
+    }
+  }
+  PutFixed32(dst, crc32c::Mask(crc32c::Value(dst->data() + start,
+                                             dst->size() - start)));
+}
+
+Status DecodeBlockCacheHotSet(Slice input,
+                              std::vector<BlockCacheHotSetFile>* set) {
+  if (input.size() < sizeof(uint32_t)) {
+    return Status::Corruption("Block cache hot set too short");
+  }
+  input.remove_suffix(sizeof(uint32_t));
+  uint32_t expected = crc32c::Unmask(DecodeFixed32(input.data() +
+                                                   input.size()));
+  if (crc32c::Value(input.data(), input.size()) != expected) {
+    return Status::Corruption("Block cache hot set checksum mismatch");
+  }
+  uint64_t num_files = 0;
+  if (!GetVarint64(&input, &num_files)) {
+    return Status::Corruption("Invalid block cache hot set size");
+  }
+  set->clear();
+  for (uint64_t i = 0; i < num_files; ++i) {
+    BlockCacheHotSetFile file;
+    uint32_t level = 0;
+    uint64_t num_blocks = 0;
+    if (!GetVarint32(&input, &file.column_family_id) ||
+        !GetVarint64(&input, &file.file_number) ||
+        !GetVarint32(&input, &level) || input.empty()) {
+      return Status::Corruption("Invalid block cache hot set file");
+    }
+    file.level = static_cast<int>(level);
+    file.index_and_filter = input[0] != 0;
+    input.remove_prefix(1);
+    if (!GetVarint64(&input, &num_blocks) || num_blocks > input.size()) {
+      return Status::Corruption("Invalid block cache hot set blocks");
+    }
+    file.data_block_offsets.reserve(static_cast<size_t>(num_blocks));
+    uint64_t offset = 0;
+    for (uint64_t j = 0; j < num_blocks; ++j) {
+      uint64_t delta = 0;
+      if (!GetVarint64(&input, &delta)) {
+        return Status::Corruption("Invalid block cache hot set block");
+      }
+      offset += delta;
+      file.data_block_offsets.push_back(offset);
+    }
+    set->push_back(std::move(file));
+  }
+  if (!input.empty()) {
+    return Status::Corruption("Trailing data in block cache hot set");
+  }
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
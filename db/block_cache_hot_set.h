@@ -0,0 +1,61 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// The blocks of one table file found in the block cache when the hot set was
+// recorded (DBOptions::block_cache_hot_set_persist_period_sec).
+struct BlockCacheHotSetFile {
+  uint32_t column_family_id = 0;
+  uint64_t file_number = 0;
+  int level = 0;
+  // Whether index or filter blocks (or partitions) were cached
+  bool index_and_filter = false;
+  // The offsets of the cached data blocks, ascending
+  std::vector<uint64_t> data_block_offsets;
+
+  uint64_t NumBlocks() const {
+    return data_block_offsets.size() + (index_and_filter ? 1 : 0);
+  }
+};
+
+// The hot set lists the files hottest first: index and filter blocks are
+// needed by every read of a file, and the lower the level, the more recent
+// and frequently read the data. It is loaded by DBOptions::
+// block_cache_warm_up_threads in this order.
+inline bool HotterBlockCacheFile(const BlockCacheHotSetFile& a,
+                                 const BlockCacheHotSetFile& b) {
+  if (a.level != b.level) {
+    return a.level < b.level;
+  }
+  return a.NumBlocks() > b.NumBlocks();
+}
+
+// The file, in the DB directory, holding the last recorded hot set
+extern std::string BlockCacheHotSetFileName(const std::string& dbname);
+
+// The hot set is a list of files followed by a checksum of the encoding:
+//   varint64 number of files
+//   per file:
+//     varint32 column family id, varint64 file number, varint32 level,
+//     byte index_and_filter, varint64 number of data blocks, and the
+//     varint64 deltas of their offsets
+//   fixed32 masked crc32c of the above
+extern void EncodeBlockCacheHotSet(const std::vector<BlockCacheHotSetFile>& set,
+                                   std::string* dst);
+extern Status DecodeBlockCacheHotSet(Slice input,
+                                     std::vector<BlockCacheHotSetFile>* set);
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -451,4 +451,111 @@ Status BuildTable(
   return s;
 }
 
+Status BuildTableFromSortedEntries(
+    const TableBuilderOptions& tboptions, FileMetaData* meta,
+    const std::function<Status(TableBuilder*, FileMetaData*)>& add_entries) {
+  auto& ioptions = tboptions.ioptions;
+  // Everything BuildTable would do to the entries besides copying them
+  if (tboptions.moptions.enable_blob_files) {
+    return Status::NotSupported("blob files need BuildTable");
+  }
+  if (ioptions.compaction_filter_factory != nullptr &&
+      ioptions.compaction_filter_factory->ShouldFilterTableFileCreation(
+          tboptions.reason)) {
+    return Status::NotSupported("compaction filter needs BuildTable");
+  }
+  if (tboptions.internal_comparator.user_comparator()->timestamp_size() > 0 &&
+      !ioptions.persist_user_defined_timestamps) {
+    return Status::NotSupported("stripping timestamps needs BuildTable");
+  }
+  FileSystem* fs = ioptions.fs.get();
+  assert(fs);
+  std::string fname = TableFileName(ioptions.cf_paths, meta->fd.GetNumber(),
+                                    meta->fd.GetPathId());
+  meta->fd.file_size = 0;
+
+  FileOptions file_options;
+  file_options.use_direct_writes =
+      ioptions.use_direct_io_for_flush_and_compaction;
+  std::unique_ptr<FSWritableFile> file;
+  IOStatus io_s = NewWritableFile(fs, fname, &file, file_options);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  FileTypeSet tmp_set = ioptions.checksum_handoff_file_types;
+  std::unique_ptr<WritableFileWriter> file_writer(new WritableFileWriter(
+      std::move(file), fname, file_options, ioptions.clock,
+      nullptr /* io_tracer */, ioptions.stats, ioptions.listeners,
+      ioptions.file_checksum_gen_factory.get(),
+      tmp_set.Contains(FileType::kTableFile), false));
+  std::unique_ptr<TableBuilder> builder(
+      NewTableBuilder(tboptions, file_writer.get()));
+
+  Status s = add_entries(builder.get(), meta);
+  const bool empty = builder->IsEmpty();
+  if (!s.ok() || empty) {
+    builder->Abandon();
+  } else {
+    s = builder->Finish();
+  }
+  if (s.ok()) {
+    s = builder->io_status();
+  }
+  if (s.ok() && !empty) {
+    meta->fd.file_size = builder->FileSize();
+    meta->tail_size = builder->GetTailSize();
+  }
+  builder.reset();
+
+  if (s.ok() && !empty) {
+    StopWatch sw(ioptions.clock, ioptions.stats, TABLE_SYNC_MICROS);
+    s = file_writer->Sync(ioptions.use_fsync);
+  }
+  if (s.ok() && !empty) {
+    s = file_writer->Close();
+  }
+  if (s.ok() && !empty) {
+    meta->file_checksum = file_writer->GetFileChecksum();
+    meta->file_checksum_func_name = file_writer->GetFileChecksumFuncName();
+    if (!tboptions.db_id.empty() && !tboptions.db_session_id.empty()) {
+      if (!GetSstInternalUniqueId(tboptions.db_id, tboptions.db_session_id,
+                                  meta->fd.GetNumber(), &(meta->unique_id))
+               .ok()) {
+        meta->unique_id = kNullUniqueId64x2;
+      }
+    }
+  }
+  if (!s.ok() || empty) {
+    meta->fd.file_size = 0;
+    file_writer.reset();
+    Status ignored = fs->DeleteFile(fname, IOOptions(), nullptr);
+    ignored.PermitUncheckedError();
+  }
+  return s;
+}
+
+Status BuildTableFromSortedIterator(const TableBuilderOptions& tboptions,
+                                    InternalIterator* iter,
+                                    FileMetaData* meta) {
+  return BuildTableFromSortedEntries(
+      tboptions, meta, [iter](TableBuilder* builder, FileMetaData* m) {
+        Status s;
+        for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+          const Slice key = iter->key();
+          const Slice value = iter->value();
+          ParsedInternalKey ikey;
+          s = ParseInternalKey(key, &ikey, true /* log_err_key */);
+          if (!s.ok()) {
+            return s;
+          }
+          builder->Add(key, value);
+          s = m->UpdateBoundaries(key, value, ikey.sequence, ikey.type);
+          if (!s.ok()) {
+            return s;
+          }
+        }
+        return iter->status();
+      });
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -6,6 +6,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #pragma once
+#include <functional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -75,4 +76,21 @@ extern Status BuildTable(
     uint64_t* memtable_payload_bytes = nullptr,
     uint64_t* memtable_garbage_bytes = nullptr);
 
+// Write sorted entries verbatim into the table file named by meta, as
+// MemTableRep::ConvertToSST does.  add_entries is called once to Add() all
+// entries, in internal key order without duplicated internal keys, and to
+// update the boundaries of meta.  No compaction filter, merge or snapshot
+// processing is applied, so NotSupported is returned for options that need
+// them.  On success, meta is filled like BuildTable, except for the seqno
+// range that is left to the caller.  On failure the partial file is deleted
+// and the caller may fall back to BuildTable.
+extern Status BuildTableFromSortedEntries(
+    const TableBuilderOptions& tboptions, FileMetaData* meta,
+    const std::function<Status(TableBuilder*, FileMetaData*)>& add_entries);
+
+// BuildTableFromSortedEntries with the entries of *iter
+extern Status BuildTableFromSortedIterator(const TableBuilderOptions& tboptions,
+                                           InternalIterator* iter,
+                                           FileMetaData* meta);
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -607,6 +607,16 @@ ColumnFamilyData::ColumnFamilyData(
                           internal_stats_->GetBlobFileReadHist(), io_tracer));
     blob_source_.reset(new BlobSource(ioptions(), db_id, db_session_id,
                                       blob_file_cache_.get()));
+    // A compaction filter or FIFO compaction may change what a read at an
+    // old sequence number returns
+    if (db_options.get_result_cache && !db_options.unordered_write &&
+        !db_options.two_write_queues &&
+        ioptions_.user_comparator->timestamp_size() == 0 &&
+        ioptions_.compaction_filter == nullptr &&
+        ioptions_.compaction_filter_factory == nullptr &&
+        ioptions_.compaction_style != kCompactionStyleFIFO) {
+      get_result_cache_stripes_.reset(new GetResultCacheStripes());
+    }
 
     if (ioptions_.compaction_style == kCompactionStyleLevel) {
       compaction_picker_.reset(
@@ -15,6 +15,7 @@
 #include <vector>
 
 #include "cache/cache_reservation_manager.h"
+#include "db/get_result_cache.h"
 #include "db/memtable_list.h"
 #include "db/table_cache.h"
 #include "db/table_properties_collector.h"
@@ -382,6 +383,10 @@ class ColumnFamilyData {
 
   TableCache* table_cache() const { return table_cache_.get(); }
   BlobSource* blob_source() const { return blob_source_.get(); }
+  // nullptr unless DBOptions::get_result_cache applies to this column family
+  GetResultCacheStripes* get_result_cache_stripes() const {
+    return get_result_cache_stripes_.get();
+  }
 
   // See documentation in compaction_picker.h
   // REQUIRES: DB mutex held
@@ -587,6 +592,7 @@ class ColumnFamilyData {
   std::unique_ptr<TableCache> table_cache_;
   std::unique_ptr<BlobFileCache> blob_file_cache_;
   std::unique_ptr<BlobSource> blob_source_;
+  std::unique_ptr<GetResultCacheStripes> get_result_cache_stripes_;
 
   std::unique_ptr<InternalStats> internal_stats_;
 
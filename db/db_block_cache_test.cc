@@ -15,6 +15,7 @@
 #include "cache/cache_key.h"
 #include "cache/lru_cache.h"
 #include "cache/typed_cache.h"
+#include "db/block_cache_hot_set.h"
 #include "db/column_family.h"
 #include "db/db_impl/db_impl.h"
 #include "db/db_test_util.h"
@@ -886,6 +887,61 @@ TEST_F(DBBlockCacheTest, ParanoidFileChecks) {
             TestGetTickerCount(options, BLOCK_CACHE_ADD));
 }
 
+TEST_F(DBBlockCacheTest, WarmUpFromHotSet) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  options.block_cache_hot_set_persist_period_sec = 3600;
+  options.block_cache_warm_up_threads = 2;
+  options.block_cache_warm_up_bytes_per_sec = 1 << 20;
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(8 << 20);
+  table_options.cache_index_and_filter_blocks = true;
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10));
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  for (int i = 0; i < 200; ++i) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(1000)));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 200; i += 10) {
+    ASSERT_NE("NOT_FOUND", Get(Key(i)));
+  }
+  const uint64_t hot_blocks =
+      TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS);
+  ASSERT_GT(hot_blocks, 1U);
+
+  // Recorded on close
+  Close();
+  ASSERT_OK(env_->FileExists(BlockCacheHotSetFileName(dbname_)));
+
+  // And loaded into a new cache on open
+  SyncPoint::GetInstance()->LoadDependency(
+      {{"DBImpl::BlockCacheWarmUp:Done",
+        "DBBlockCacheTest::WarmUpFromHotSet:WarmedUp"}});
+  SyncPoint::GetInstance()->EnableProcessing();
+  table_options.block_cache = NewLRUCache(8 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  Reopen(options);
+  TEST_SYNC_POINT("DBBlockCacheTest::WarmUpFromHotSet:WarmedUp");
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_EQ(hot_blocks,
+            TestGetTickerCount(options, BLOCK_CACHE_WARM_UP_BLOCKS));
+  ASSERT_GE(TestGetTickerCount(options, BLOCK_CACHE_WARM_UP_BYTES),
+            hot_blocks * 1000);
+
+  // So reading the same keys again misses nothing
+  const uint64_t misses = TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS);
+  for (int i = 0; i < 200; i += 10) {
+    ASSERT_NE("NOT_FOUND", Get(Key(i)));
+  }
+  ASSERT_EQ(misses, TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+}
+
 TEST_F(DBBlockCacheTest, CacheCompressionDict) {
   const int kNumFiles = 4;
   const int kNumEntriesPerFile = 128;
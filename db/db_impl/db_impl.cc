@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "db/arena_wrapped_db_iter.h"
+#include "db/block_cache_hot_set.h"
 #include "db/builder.h"
 #include "db/compaction/compaction_job.h"
 #include "db/db_info_dumper.h"
@@ -319,6 +320,9 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       periodic_task_scheduler_(),
       two_write_queues_(options.two_write_queues),
       manual_wal_flush_(options.manual_wal_flush),
+      wal_gather_write_(options.enable_wal_gather_write &&
+                        !options.two_write_queues && !options.unordered_write &&
+                        options.wal_compression == kNoCompression),
       // last_sequencee_ is always maintained by the main queue that also writes
       // to the memtable. When two_write_queues_ is disabled last seq in
       // memtable is the same as last seq published to the readers. When it is
@@ -371,6 +375,9 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
   periodic_task_functions_.emplace(
       PeriodicTaskType::kRecordSeqnoTime,
       [this]() { this->RecordSeqnoToTimeMapping(); });
+  periodic_task_functions_.emplace(
+      PeriodicTaskType::kPersistBlockCacheHotSet,
+      [this]() { this->PersistBlockCacheHotSet(); });
 
   versions_.reset(new VersionSet(dbname_, &immutable_db_options_, file_options_,
                                  table_cache_.get(), write_buffer_manager_,
@@ -378,6 +385,14 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
                                  io_tracer_, db_id_, db_session_id_));
   column_family_memtables_.reset(
       new ColumnFamilyMemTablesImpl(versions_->GetColumnFamilySet()));
+  // WritePrepared/WriteUnprepared transactions publish sequence numbers
+  // apart from the memtable writes
+  if (immutable_db_options_.get_result_cache &&
+      !immutable_db_options_.unordered_write && !two_write_queues_ &&
+      !seq_per_batch_) {
+    get_result_cache_.reset(
+        new GetResultCache(immutable_db_options_.get_result_cache));
+  }
 
   DumpRocksDBBuildVersion(immutable_db_options_.info_log.get());
   DumpDBFileSummary(immutable_db_options_, dbname_, db_session_id_);
@@ -665,6 +680,12 @@ Status DBImpl::CloseHelper() {
   // (to consider: moving all the waiting into CancelAllBackgroundWork(true))
   CancelAllBackgroundWork(false);
 
+  StopBlockCacheWarmUp();
+  if (block_cache_hot_set_registered_) {
+    // With the periodic task unregistered above
+    PersistBlockCacheHotSet();
+  }
+
   // Cancel manual compaction if there's any
   if (HasPendingManualCompaction()) {
     DisableManualCompaction();
@@ -2144,6 +2165,35 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
     }
   }
 
+  // Only the plain reads of the latest value go through get_result_cache_
+  GetResultCacheStripes* result_cache_stripes = nullptr;
+  if (get_result_cache_ && get_impl_options.get_value &&
+      get_impl_options.value != nullptr &&
+      get_impl_options.columns == nullptr &&
+      get_impl_options.timestamp == nullptr &&
+      get_impl_options.value_found == nullptr &&
+      get_impl_options.callback == nullptr &&
+      get_impl_options.is_blob_index == nullptr &&
+      read_options.snapshot == nullptr && read_options.timestamp == nullptr &&
+      read_options.read_tier == kReadAllTier &&
+      !read_options.ignore_range_deletions) {
+    result_cache_stripes = cfd->get_result_cache_stripes();
+  }
+  if (result_cache_stripes != nullptr) {
+    Status s;
+    if (get_result_cache_->Lookup(cfd->GetID(), *result_cache_stripes, key,
+                                  get_impl_options.value, &s)) {
+      RecordTick(stats_, GET_RESULT_CACHE_HIT);
+      RecordTick(stats_, NUMBER_KEYS_READ);
+      size_t size = s.ok() ? get_impl_options.value->size() : 0;
+      RecordTick(stats_, BYTES_READ, size);
+      PERF_COUNTER_ADD(get_read_bytes, size);
+      RecordInHistogram(stats_, BYTES_PER_READ, size);
+      return s;
+    }
+    RecordTick(stats_, GET_RESULT_CACHE_MISS);
+  }
+
   if (get_impl_options.get_merge_operands_options != nullptr) {
     for (int i = 0; i < get_impl_options.get_merge_operands_options
                             ->expected_max_number_of_operands;
@@ -2379,6 +2429,12 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
       PERF_COUNTER_ADD(get_read_bytes, size);
     }
 
+    if (result_cache_stripes != nullptr && read_options.fill_cache &&
+        (s.ok() || s.IsNotFound())) {
+      get_result_cache_->Insert(cfd->GetID(), key, snapshot, s,
+                                *get_impl_options.value);
+    }
+
     if (!read_options.pinning_tls)
       ReturnAndCleanupSuperVersion(cfd, sv);
 
@@ -4849,6 +4905,10 @@ Status DBImpl::DeleteFile(std::string name) {
     }
     edit.SetColumnFamily(cfd->GetID());
     edit.DeleteFile(level, number);
+    if (cfd->get_result_cache_stripes() != nullptr) {
+      cfd->get_result_cache_stripes()->RecordWriteAll(
+          versions_->LastSequence() + 1);
+    }
     status = versions_->LogAndApply(cfd, *cfd->GetLatestMutableCFOptions(),
                                     read_options, &edit, &mutex_,
                                     directories_.GetDbDir());
@@ -4939,6 +4999,10 @@ Status DBImpl::DeleteFilesInRanges(ColumnFamilyHandle* column_family,
       return status;
     }
     input_version->Ref();
+    if (cfd->get_result_cache_stripes() != nullptr) {
+      cfd->get_result_cache_stripes()->RecordWriteAll(
+          versions_->LastSequence() + 1);
+    }
     status = versions_->LogAndApply(cfd, *cfd->GetLatestMutableCFOptions(),
                                     read_options, &edit, &mutex_,
                                     directories_.GetDbDir());
@@ -5256,6 +5320,9 @@ Status DestroyDB(const std::string& dbname, const Options& options,
         }
       }
     }
+    // Not parsed as a DB file, see
+    // DBOptions::block_cache_hot_set_persist_period_sec
+    env->DeleteFile(BlockCacheHotSetFileName(dbname)).PermitUncheckedError();
 
     std::set<std::string> paths;
     for (const DbPath& db_path : options.db_paths) {
@@ -5976,6 +6043,13 @@ Status DBImpl::IngestExternalFiles(
         }
         assert(0 == num_entries);
       }
+      // The ingested keys may be visible at older sequence numbers
+      for (ColumnFamilyData* cfd : cfds_to_commit) {
+        if (cfd->get_result_cache_stripes() != nullptr) {
+          cfd->get_result_cache_stripes()->RecordWriteAll(
+              versions_->LastSequence() + 1);
+        }
+      }
       status = versions_->LogAndApply(cfds_to_commit, mutable_cf_options_list,
                                       read_options, edit_lists, &mutex_,
                                       directories_.GetDbDir());
@@ -28,6 +28,7 @@
 #include "db/external_sst_file_ingestion_job.h"
 #include "db/flush_job.h"
 #include "db/flush_scheduler.h"
+#include "db/get_result_cache.h"
 #include "db/import_column_family_job.h"
 #include "db/internal_stats.h"
 #include "db/log_writer.h"
@@ -1206,6 +1207,10 @@ class DBImpl : public DB {
   // record current sequence number to time mapping
   void RecordSeqnoToTimeMapping();
 
+  // record the table file blocks in the block cache for the warm-up on the
+  // next DB::Open, see db_impl_block_cache_hot_set.cc
+  void PersistBlockCacheHotSet();
+
   // Interface to block and signal the DB in case of stalling writes by
   // WriteBufferManager. Each DBImpl object contains ptr to WBMStallInterface.
   // When DB needs to be blocked or signalled by WriteBufferManager,
@@ -1290,6 +1295,8 @@ class DBImpl : public DB {
   std::unique_ptr<Tracer> tracer_;
   InstrumentedMutex trace_mutex_;
   BlockCacheTracer block_cache_tracer_;
+  // DBOptions::get_result_cache, nullptr if disabled or not applicable
+  std::unique_ptr<GetResultCache> get_result_cache_;
 
   // constant false canceled flag, used when the compaction is not manual
   const std::atomic<bool> kManualCompactionCanceledFalse_{false};
@@ -1872,6 +1879,34 @@ class DBImpl : public DB {
   Status WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
                                      MemTable* mem, VersionEdit* edit);
 
+  // A memtable flush at recovery time, in three steps so that the table file
+  // can be built outside of the mutex, possibly in another thread:
+  // PrepareRecoveryFlush() with the mutex held, BuildRecoveryFlush() without
+  // it, then InstallRecoveryFlush() with the mutex held again.
+  struct RecoveryFlush {
+    int job_id = 0;
+    ColumnFamilyData* cfd = nullptr;
+    MemTable* mem = nullptr;
+    uint64_t start_micros = 0;
+    FileMetaData meta;
+    std::vector<BlobFileAddition> blob_file_additions;
+    std::unique_ptr<std::list<uint64_t>::iterator>
+        pending_outputs_inserted_elem;
+    MutableCFOptions mutable_cf_options;
+    Env::WriteLifeTimeHint write_hint = Env::WLTH_NOT_SET;
+    Version* version = nullptr;
+    Status status;
+  };
+  void PrepareRecoveryFlush(int job_id, ColumnFamilyData* cfd, MemTable* mem,
+                            RecoveryFlush* flush);
+  void BuildRecoveryFlush(RecoveryFlush* flush);
+  Status InstallRecoveryFlush(RecoveryFlush* flush, VersionEdit* edit);
+
+  // Replays the WALs of RecoverLogFiles() with
+  // DBOptions::wal_recovery_threads, see db_impl_open.cc
+  class ParallelWalReplay;
+  bool CanReplayWalsInParallel() const;
+
   // Get the size of a log file and, if truncate is true, truncate the
   // log file to its actual size, thereby freeing preallocated space.
   // Return success even if truncate fails
@@ -2024,6 +2059,14 @@ class DBImpl : public DB {
                       Env::IOPriority rate_limiter_priority,
                       LogFileNumberSize& log_file_number_size);
 
+  // Writes the record made of parts[0, num_parts), see
+  // log::Writer::AddRecord
+  IOStatus WriteToWAL(const Slice* parts, const uint32_t* part_crcs,
+                      size_t num_parts, log::Writer* log_writer,
+                      uint64_t* log_used, uint64_t* log_size,
+                      Env::IOPriority rate_limiter_priority,
+                      LogFileNumberSize& log_file_number_size);
+
   IOStatus WriteToWAL(const WriteThread::WriteGroup& write_group,
                       log::Writer* log_writer, uint64_t* log_used,
                       bool need_log_sync, bool need_log_dir_sync,
@@ -2115,6 +2158,12 @@ class DBImpl : public DB {
 
   Status RegisterRecordSeqnoTimeWorker();
 
+  // Registers PersistBlockCacheHotSet() and starts loading the last recorded
+  // hot set with DBOptions::block_cache_warm_up_threads
+  Status StartBlockCacheWarmUp();
+  // Waits for the warm-up threads to stop, on close
+  void StopBlockCacheWarmUp();
+
   void PrintStatistics();
 
   size_t EstimateInMemoryStatsHistorySize() const;
@@ -2454,6 +2503,10 @@ private:
 
   WriteThread write_thread_;
   WriteBatch tmp_batch_;
+  // The parts of a gathered WAL record, like tmp_batch_ only used by the
+  // write group leader in WriteToWAL(write_group)
+  std::vector<Slice> tmp_wal_parts_;
+  std::vector<uint32_t> tmp_wal_part_crcs_;
   // The write thread when the writers have no memtable write. This will be used
   // in 2PC to batch the prepares separately from the serial commit.
   WriteThread nonmem_write_thread_;
@@ -2627,10 +2680,19 @@ private:
   // It contains the implementations for each periodic task.
   std::map<PeriodicTaskType, const PeriodicTaskFunc> periodic_task_functions_;
 
+  // The threads of DBOptions::block_cache_warm_up_threads, if running
+  class BlockCacheWarmUp;
+  std::shared_ptr<BlockCacheWarmUp> block_cache_warm_up_;
+  // Whether PersistBlockCacheHotSet() runs periodically, and on close
+  bool block_cache_hot_set_registered_ = false;
+
   // When set, we use a separate queue for writes that don't write to memtable.
   // In 2PC these are the writes at Prepare phase.
   const bool two_write_queues_;
   const bool manual_wal_flush_;
+  // Writers prepare their WAL payloads for WriteToWAL(write_group), see
+  // DBOptions::enable_wal_gather_write
+  const bool wal_gather_write_;
 
   // LastSequence also indicates last published sequence visibile to the
   // readers. Otherwise LastPublishedSequence should be used.
@@ -0,0 +1,366 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// Recording the hot set of the block cache
+// (DBOptions::block_cache_hot_set_persist_period_sec) and loading it on
+// DB::Open (DBOptions::block_cache_warm_up_threads).
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "cache/cache_entry_roles.h"
+#include "cache/cache_key.h"
+#include "db/block_cache_hot_set.h"
+#include "db/db_impl/db_impl.h"
+#include "logging/logging.h"
+#include "monitoring/statistics_impl.h"
+#include "rocksdb/rate_limiter.h"
+#include "table/block_based/block_based_table_reader.h"
+#include "test_util/sync_point.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// The blocks of a file are found in the block cache by the common prefix of
+// their cache keys, which follows from the base cache key of the file, and
+// their offsets recovered from the rest of the keys (see
+// BlockBasedTable::GetCacheKey()).
+void DBImpl::PersistBlockCacheHotSet() {
+  TEST_SYNC_POINT("DBImpl::PersistBlockCacheHotSet:Entry");
+  const uint64_t start_micros = immutable_db_options_.clock->NowMicros();
+
+  autovector<std::pair<ColumnFamilyData*, Version*>> versions;
+  {
+    InstrumentedMutexLock l(&mutex_);
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (cfd->IsDropped() || !cfd->initialized()) {
+        continue;
+      }
+      cfd->Ref();
+      cfd->current()->Ref();
+      versions.emplace_back(cfd, cfd->current());
+    }
+  }
+
+  std::vector<BlockCacheHotSetFile> files;
+  // The rest of the base cache key of each file
+  std::vector<uint64_t> base_offsets;
+  std::unordered_map<uint64_t, size_t> file_by_prefix;
+  std::unordered_set<Cache*> caches;
+  ReadOptions ro;
+  for (const auto& cfd_and_version : versions) {
+    ColumnFamilyData* cfd = cfd_and_version.first;
+    Version* version = cfd_and_version.second;
+    auto* table_factory = cfd->ioptions()->table_factory.get();
+    assert(table_factory != nullptr);
+    Cache* cache =
+        table_factory->GetOptions<Cache>(TableFactory::kBlockCacheOpts());
+    if (cache == nullptr) {
+      continue;
+    }
+    caches.insert(cache);
+    const MutableCFOptions& mutable_cf_options =
+        version->GetMutableCFOptions();
+    const VersionStorageInfo* vstorage = version->storage_info();
+    for (int level = 0; level < vstorage->num_levels(); ++level) {
+      for (FileMetaData* meta : vstorage->LevelFiles(level)) {
+        // Tables evicted from the table cache are not reopened for this
+        std::shared_ptr<const TableProperties> props;
+        Status s = cfd->table_cache()->GetTableProperties(
+            file_options_, ro, cfd->internal_comparator(), *meta, &props,
+            mutable_cf_options.block_protection_bytes_per_key,
+            mutable_cf_options.prefix_extractor, /*no_io=*/true);
+        if (!s.ok()) {
+          continue;
+        }
+        OffsetableCacheKey base;
+        BlockBasedTable::SetupBaseCacheKey(props.get(), db_session_id_,
+                                           meta->fd.GetNumber(), &base,
+                                           /*out_is_stable=*/nullptr);
+        Slice base_key = base.WithOffset(0).AsSlice();
+        uint64_t prefix = 0;
+        uint64_t base_offset = 0;
+        std::memcpy(&prefix, base_key.data(), sizeof(prefix));
+        std::memcpy(&base_offset, base_key.data() + sizeof(prefix),
+                    sizeof(base_offset));
+        if (!file_by_prefix.emplace(prefix, files.size()).second) {
+          continue;
+        }
+        files.emplace_back();
+        files.back().column_family_id = cfd->GetID();
+        files.back().file_number = meta->fd.GetNumber();
+        files.back().level = level;
+        base_offsets.push_back(base_offset);
+      }
+    }
+  }
+  {
+    InstrumentedMutexLock l(&mutex_);
+    for (const auto& cfd_and_version : versions) {
+      cfd_and_version.second->Unref();
+      cfd_and_version.first->UnrefAndTryDelete();
+    }
+  }
+
+  for (Cache* cache : caches) {
+    cache->ApplyToAllEntries(
+        [&](const Slice& key, Cache::ObjectPtr /*value*/, size_t /*charge*/,
+            const Cache::CacheItemHelper* helper) {
+          if (helper == nullptr || key.size() != kCacheKeySize) {
+            return;
+          }
+          uint64_t prefix = 0;
+          uint64_t offset_etc64 = 0;
+          std::memcpy(&prefix, key.data(), sizeof(prefix));
+          auto it = file_by_prefix.find(prefix);
+          if (it == file_by_prefix.end()) {
+            return;
+          }
+          std::memcpy(&offset_etc64, key.data() + sizeof(prefix),
+                      sizeof(offset_etc64));
+          BlockCacheHotSetFile& file = files[it->second];
+          switch (helper->role) {
+            case CacheEntryRole::kDataBlock:
+              file.data_block_offsets.push_back(
+                  (offset_etc64 ^ base_offsets[it->second]) << 2);
+              break;
+            case CacheEntryRole::kFilterBlock:
+            case CacheEntryRole::kFilterMetaBlock:
+            case CacheEntryRole::kIndexBlock:
+              file.index_and_filter = true;
+              break;
+            default:
+              break;
+          }
+        },
+        {});
+  }
+
+  files.erase(std::remove_if(files.begin(), files.end(),
+                             [](const BlockCacheHotSetFile& file) {
+                               return file.NumBlocks() == 0;
+                             }),
+              files.end());
+  for (BlockCacheHotSetFile& file : files) {
+    std::sort(file.data_block_offsets.begin(), file.data_block_offsets.end());
+  }
+  std::sort(files.begin(), files.end(), HotterBlockCacheFile);
+  uint64_t num_blocks = 0;
+  size_t num_files = 0;
+  const uint64_t max_blocks =
+      immutable_db_options_.block_cache_hot_set_max_blocks;
+  for (; num_files < files.size() && num_blocks < max_blocks; ++num_files) {
+    BlockCacheHotSetFile& file = files[num_files];
+    const uint64_t budget = max_blocks - num_blocks;
+    if (file.NumBlocks() > budget) {
+      const size_t excess = static_cast<size_t>(file.NumBlocks() - budget);
+      file.data_block_offsets.resize(file.data_block_offsets.size() - excess);
+    }
+    num_blocks += file.NumBlocks();
+  }
+  files.resize(num_files);
+
+  std::string data;
+  EncodeBlockCacheHotSet(files, &data);
+  const std::string fname = BlockCacheHotSetFileName(dbname_);
+  const std::string tmp_fname = fname + ".tmp";
+  IOStatus io_s = WriteStringToFile(fs_.get(), data, tmp_fname,
+                                    /*should_sync=*/true);
+  if (io_s.ok()) {
+    io_s = fs_->RenameFile(tmp_fname, fname, IOOptions(), nullptr);
+  }
+  if (io_s.ok()) {
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "Recorded %" PRIu64 " blocks of %" ROCKSDB_PRIszt
+                   " files in the block cache hot set in %" PRIu64 " us",
+                   num_blocks, num_files,
+                   immutable_db_options_.clock->NowMicros() - start_micros);
+  } else {
+    ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                   "Failed to record the block cache hot set: %s",
+                   io_s.ToString().c_str());
+  }
+  TEST_SYNC_POINT("DBImpl::PersistBlockCacheHotSet:Done");
+}
+
+// Threads take the files of the hot set in order, so the hottest are loaded
+// first, and each loads the blocks of a file with as few reads as possible.
+class DBImpl::BlockCacheWarmUp {
+ public:
+  BlockCacheWarmUp(DBImpl* db, std::vector<BlockCacheHotSetFile>&& files)
+      : db_(db),
+        files_(std::move(files)),
+        start_micros_(db->immutable_db_options_.clock->NowMicros()) {
+    const uint64_t bytes_per_sec =
+        db->immutable_db_options_.block_cache_warm_up_bytes_per_sec;
+    if (bytes_per_sec > 0) {
+      rate_limiter_.reset(NewGenericRateLimiter(
+          static_cast<int64_t>(bytes_per_sec),
+          100 * 1000 /* refill_period_us */, 10 /* fairness */,
+          RateLimiter::Mode::kAllIo));
+    }
+    const int num_threads =
+        db->immutable_db_options_.block_cache_warm_up_threads;
+    running_.store(num_threads, std::memory_order_relaxed);
+    for (int i = 0; i < num_threads; ++i) {
+      threads_.emplace_back([this] { Run(); });
+    }
+  }
+
+  ~BlockCacheWarmUp() { Join(); }
+
+  // Returns once the threads have stopped, early if the DB is shutting down
+  void Join() {
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+    threads_.clear();
+  }
+
+ private:
+  void Run() {
+    for (size_t i = next_file_.fetch_add(1, std::memory_order_relaxed);
+         i < files_.size() &&
+         !db_->shutting_down_.load(std::memory_order_acquire);
+         i = next_file_.fetch_add(1, std::memory_order_relaxed)) {
+      WarmUp(files_[i]);
+    }
+    if (running_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      ROCKS_LOG_INFO(
+          db_->immutable_db_options_.info_log,
+          "Block cache warm-up %s: %" PRIu64 " blocks, %" PRIu64
+          " bytes of %" ROCKSDB_PRIszt " files in %" PRIu64 " us",
+          db_->shutting_down_.load(std::memory_order_acquire) ? "stopped"
+                                                              : "done",
+          blocks_.load(std::memory_order_relaxed),
+          bytes_.load(std::memory_order_relaxed), files_.size(),
+          db_->immutable_db_options_.clock->NowMicros() - start_micros_);
+      TEST_SYNC_POINT("DBImpl::BlockCacheWarmUp:Done");
+    }
+  }
+
+  void WarmUp(const BlockCacheHotSetFile& file) {
+    ColumnFamilyData* cfd = nullptr;
+    Version* version = nullptr;
+    FileMetaData* meta = nullptr;
+    {
+      InstrumentedMutexLock l(&db_->mutex_);
+      cfd = db_->versions_->GetColumnFamilySet()->GetColumnFamily(
+          file.column_family_id);
+      if (cfd == nullptr || cfd->IsDropped() || !cfd->initialized()) {
+        return;
+      }
+      version = cfd->current();
+      // The file may have been compacted since the hot set was recorded
+      meta =
+          version->storage_info()->GetFileMetaDataByNumber(file.file_number);
+      if (meta == nullptr) {
+        return;
+      }
+      cfd->Ref();
+      version->Ref();
+    }
+
+    ReadOptions ro;
+    const MutableCFOptions& mutable_cf_options =
+        version->GetMutableCFOptions();
+    TableCache::TypedHandle* handle = nullptr;
+    uint64_t blocks = 0;
+    uint64_t bytes = 0;
+    Status s = cfd->table_cache()->FindTable(
+        ro, db_->file_options_, cfd->internal_comparator(), *meta, &handle,
+        mutable_cf_options.block_protection_bytes_per_key,
+        mutable_cf_options.prefix_extractor, /*no_io=*/false,
+        /*file_read_hist=*/nullptr, /*skip_filters=*/false, file.level);
+    if (s.ok()) {
+      TableReader* table_reader =
+          cfd->table_cache()->GetTableReaderFromHandle(handle);
+      s = table_reader->WarmUpBlockCache(ro, file.data_block_offsets,
+                                         file.index_and_filter,
+                                         rate_limiter_.get(), &blocks, &bytes);
+      cfd->table_cache()->ReleaseHandle(handle);
+    }
+    if (!s.ok() && !s.IsNotSupported()) {
+      ROCKS_LOG_WARN(db_->immutable_db_options_.info_log,
+                     "Block cache warm-up of file %" PRIu64 " failed: %s",
+                     file.file_number, s.ToString().c_str());
+    }
+    blocks_.fetch_add(blocks, std::memory_order_relaxed);
+    bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    Statistics* stats = db_->immutable_db_options_.stats;
+    RecordTick(stats, BLOCK_CACHE_WARM_UP_BLOCKS, blocks);
+    RecordTick(stats, BLOCK_CACHE_WARM_UP_BYTES, bytes);
+
+    InstrumentedMutexLock l(&db_->mutex_);
+    version->Unref();
+    cfd->UnrefAndTryDelete();
+  }
+
+  DBImpl* const db_;
+  const std::vector<BlockCacheHotSetFile> files_;
+  const uint64_t start_micros_;
+  std::unique_ptr<RateLimiter> rate_limiter_;
+  std::atomic<size_t> next_file_{0};
+  std::atomic<int> running_{0};
+  std::atomic<uint64_t> blocks_{0};
+  std::atomic<uint64_t> bytes_{0};
+  std::vector<port::Thread> threads_;
+};
+
+Status DBImpl::StartBlockCacheWarmUp() {
+  const uint64_t period_sec =
+      immutable_db_options_.block_cache_hot_set_persist_period_sec;
+  if (period_sec > 0) {
+    Status s = periodic_task_scheduler_.Register(
+        PeriodicTaskType::kPersistBlockCacheHotSet,
+        periodic_task_functions_.at(PeriodicTaskType::kPersistBlockCacheHotSet),
+        period_sec);
+    if (!s.ok()) {
+      return s;
+    }
+    block_cache_hot_set_registered_ = true;
+  }
+  if (immutable_db_options_.block_cache_warm_up_threads <= 0) {
+    return Status::OK();
+  }
+
+  // Not finding or decoding the hot set only makes DB::Open slower to warm up
+  const std::string fname = BlockCacheHotSetFileName(dbname_);
+  std::string data;
+  Status s = ReadFileToString(fs_.get(), fname, &data);
+  std::vector<BlockCacheHotSetFile> files;
+  if (s.ok()) {
+    s = DecodeBlockCacheHotSet(data, &files);
+  }
+  if (!s.ok()) {
+    if (!s.IsNotFound() && !s.IsPathNotFound()) {
+      ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                     "Failed to read the block cache hot set %s: %s",
+                     fname.c_str(), s.ToString().c_str());
+    }
+    return Status::OK();
+  }
+  if (!files.empty()) {
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "Starting block cache warm-up of %" ROCKSDB_PRIszt
+                   " files with %d threads",
+                   files.size(),
+                   immutable_db_options_.block_cache_warm_up_threads);
+    block_cache_warm_up_ =
+        std::make_shared<BlockCacheWarmUp>(this, std::move(files));
+  }
+  return Status::OK();
+}
+
+void DBImpl::StopBlockCacheWarmUp() {
+  if (block_cache_warm_up_) {
+    block_cache_warm_up_->Join();
+    block_cache_warm_up_.reset();
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -7,6 +7,9 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #include <cinttypes>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 
 #include "db/builder.h"
 #include "db/db_impl/db_impl.h"
@@ -25,6 +28,7 @@
 #include "rocksdb/wal_filter.h"
 #include "test_util/sync_point.h"
 #include "util/rate_limiter_impl.h"
+#include "util/threadpool_imp.h"
 #include "util/udt_util.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -1056,26 +1060,463 @@ bool DBImpl::InvokeWalFilterIfNeededOnWalRecord(uint64_t wal_number,
   return true;
 }
 
+namespace {
+struct LogReporter : public log::Reader::Reporter {
+  Env* env;
+  Logger* info_log;
+  const char* fname;
+  Status* status;  // nullptr if immutable_db_options_.paranoid_checks==false
+  void Corruption(size_t bytes, const Status& s) override {
+    ROCKS_LOG_WARN(info_log, "%s%s: dropping %d bytes; %s",
+                   (status == nullptr ? "(ignoring error) " : ""), fname,
+                   static_cast<int>(bytes), s.ToString().c_str());
+    if (status != nullptr && status->ok()) {
+      *status = s;
+    }
+  }
+};
+
+void InitLogReporter(const ImmutableDBOptions& db_options, Env* env,
+                     const std::string& fname, Status* status,
+                     LogReporter* reporter) {
+  reporter->env = env;
+  reporter->info_log = db_options.info_log.get();
+  reporter->fname = fname.c_str();
+  if (!db_options.paranoid_checks ||
+      db_options.wal_recovery_mode ==
+          WALRecoveryMode::kSkipAnyCorruptedRecords) {
+    reporter->status = nullptr;
+  } else {
+    reporter->status = status;
+  }
+}
+
+// Turns a WAL record into a WriteBatch with protection info, a failure means
+// the WAL cannot be replayed
+Status DecodeWalRecord(const Slice& record, uint64_t record_checksum,
+                       const UnorderedMap<uint32_t, size_t>& running_ts_sz,
+                       const UnorderedMap<uint32_t, size_t>& record_ts_sz,
+                       WriteBatch* batch) {
+  Status status = WriteBatchInternal::SetContents(batch, record);
+  if (!status.ok()) {
+    return status;
+  }
+  // TODO(yuzhangyu): update mode to kReconcileInconsistency when user
+  // comparator can be changed.
+  status = HandleWriteBatchTimestampSizeDifference(
+      batch, running_ts_sz, record_ts_sz,
+      TimestampSizeConsistencyMode::kVerifyConsistency);
+  if (!status.ok()) {
+    return status;
+  }
+  TEST_SYNC_POINT_CALLBACK(
+      "DBImpl::RecoverLogFiles:BeforeUpdateProtectionInfo:batch", batch);
+  TEST_SYNC_POINT_CALLBACK(
+      "DBImpl::RecoverLogFiles:BeforeUpdateProtectionInfo:checksum",
+      &record_checksum);
+  return WriteBatchInternal::UpdateProtectionInfo(
+      batch, 8 /* bytes_per_key */, &record_checksum);
+}
+
+// A WAL record read ahead of its replay by DBImpl::ParallelWalReplay
+struct PrefetchedWalRecord {
+  enum Kind : uint8_t {
+    kRecord,
+    // The WAL could not be opened, status tells why
+    kOpenFailed,
+    // Follows the last record of a WAL, status is the error reported by the
+    // log reader that stopped reading the WAL, if any
+    kEndOfWal,
+  };
+  Kind kind = kRecord;
+  // kRecord: non-OK if DecodeWalRecord() failed
+  Status status;
+  size_t record_size = 0;
+  WriteBatch batch;
+  // See WriteBatchInternal::HasOnlyPointWrites()
+  bool point_writes_only = false;
+};
+}  // namespace
+
+// Replays the WALs with DBOptions::wal_recovery_threads. A prefetch thread
+// reads, checksums and decodes the records of all the WALs to replay, in
+// order, the way the sequential replay of RecoverLogFiles() does. The batches
+// with only point writes are queued into a group whose batches the recovery
+// threads insert into the memtables concurrently, any other batch is a
+// barrier that RecoverLogFiles() inserts itself once the group before it is
+// in. Memtables that fill up are switched right away and flushed by the
+// recovery threads, the table files are installed in the order of the
+// flushes.
+class DBImpl::ParallelWalReplay {
+ public:
+  // Point writes of a group are inserted together, sized to keep all the
+  // threads busy without holding back barriers for long. The memtables are
+  // only checked for a flush between groups, so a group is also kept to
+  // 1/kGroupsPerWriteBuffer of the smallest write buffer, which bounds how
+  // far a memtable can grow past it.
+  static constexpr size_t kMaxGroupBatches = 1024;
+  static constexpr size_t kMaxGroupBytes = 4 << 20;
+  static constexpr size_t kGroupsPerWriteBuffer = 8;
+  static constexpr size_t kMaxPrefetchBytes = 32 << 20;
+
+  // REQUIRES: mutex_ held, wal_numbers are all the WALs RecoverLogFiles()
+  // replays, in order
+  ParallelWalReplay(DBImpl* db, std::vector<uint64_t> wal_numbers, int job_id)
+      : db_(db),
+        job_id_(job_id),
+        num_threads_(db->immutable_db_options_.wal_recovery_threads),
+        max_group_bytes_(MaxGroupBytes(db)),
+        wal_numbers_(std::move(wal_numbers)),
+        running_ts_sz_(db->versions_->GetRunningColumnFamiliesTimestampSize()) {
+    pool_.SetHostEnv(db_->env_);
+    pool_.SetBackgroundThreads(num_threads_);
+    prefetch_thread_ = port::Thread([this] { Prefetch(); });
+  }
+
+  // REQUIRES: mutex_ held. Drops the flushes not installed yet, which only
+  // happens when the recovery failed.
+  ~ParallelWalReplay() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    queue_cv_.notify_all();
+    db_->mutex_.Unlock();
+    prefetch_thread_.join();
+    pool_.WaitForJobsAndJoinAllThreads();
+    db_->mutex_.Lock();
+    for (auto& pending : flushes_) {
+      pending->flush.version->Unref();
+      db_->ReleaseFileNumberFromPendingOutputs(
+          pending->flush.pending_outputs_inserted_elem);
+      delete pending->flush.mem->Unref();
+    }
+  }
+
+  // Returns the next record. The records of each WAL are followed by one
+  // kEndOfWal, or there is only kOpenFailed.
+  std::unique_ptr<PrefetchedWalRecord> Next() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    queue_cv_.wait(lock, [this] { return !queue_.empty(); });
+    std::unique_ptr<PrefetchedWalRecord> record = std::move(queue_.front());
+    queue_.pop_front();
+    queued_bytes_ -= record->record_size;
+    queue_cv_.notify_all();
+    return record;
+  }
+
+  // REQUIRES: record->point_writes_only
+  void AddToGroup(std::unique_ptr<PrefetchedWalRecord> record) {
+    assert(record->point_writes_only);
+    group_bytes_ += record->record_size;
+    group_.push_back(std::move(record));
+  }
+
+  bool GroupFull() const {
+    return group_.size() >= kMaxGroupBatches ||
+           group_bytes_ >= max_group_bytes_;
+  }
+
+  // Inserts the batches of the group, sets *has_valid_writes if any of them
+  // has a write for a column family that was not flushed past wal_number.
+  // Fails with the first batch that could not be inserted and whose error is
+  // not ignored, the batches after it are inserted as well so the recovery
+  // has to fail.
+  // REQUIRES: mutex_ held
+  Status InsertGroup(uint64_t wal_number, bool* has_valid_writes);
+
+  // Switches the memtable of cfd and flushes the old one in the background
+  // into edit. Fails if an earlier flush failed.
+  // REQUIRES: mutex_ held
+  Status ScheduleFlush(ColumnFamilyData* cfd, VersionEdit* edit,
+                       SequenceNumber next_sequence);
+
+  // Waits for the scheduled flushes and installs them
+  // REQUIRES: mutex_ held
+  Status FinishFlushes() {
+    Status s;
+    while (!flushes_.empty()) {
+      Status install_s = InstallOldestFlush();
+      if (s.ok()) {
+        s = install_s;
+      }
+    }
+    return s;
+  }
+
+ private:
+  struct Group {
+    std::vector<std::unique_ptr<PrefetchedWalRecord>> records;
+    std::vector<Status> statuses;
+    std::unique_ptr<bool[]> has_valid_writes;
+    uint64_t wal_number = 0;
+    std::atomic<size_t> next{0};
+    // Helpers that start after the group is closed leave it alone
+    std::mutex mutex;
+    std::condition_variable cv;
+    int active = 0;
+    bool closed = false;
+  };
+
+  struct PendingFlush {
+    RecoveryFlush flush;
+    VersionEdit* edit = nullptr;
+    bool built = false;  // protected by ParallelWalReplay::mutex_
+  };
+
+  // REQUIRES: mutex_ held
+  static size_t MaxGroupBytes(DBImpl* db) {
+    size_t max_bytes = kMaxGroupBytes;
+    for (auto cfd : *db->versions_->GetColumnFamilySet()) {
+      max_bytes = std::min(
+          max_bytes, cfd->GetLatestMutableCFOptions()->write_buffer_size /
+                         kGroupsPerWriteBuffer);
+    }
+    return max_bytes;
+  }
+
+  void Prefetch();
+  bool Push(std::unique_ptr<PrefetchedWalRecord> record);
+  void InsertBatches(Group* group);
+  Status InstallOldestFlush();
+
+  DBImpl* const db_;
+  const int job_id_;
+  const int num_threads_;
+  const size_t max_group_bytes_;
+  const std::vector<uint64_t> wal_numbers_;
+  const UnorderedMap<uint32_t, size_t> running_ts_sz_;
+  ThreadPoolImpl pool_;
+  port::Thread prefetch_thread_;
+
+  std::mutex mutex_;
+  std::condition_variable queue_cv_;
+  std::condition_variable flush_cv_;
+  std::deque<std::unique_ptr<PrefetchedWalRecord>> queue_;
+  size_t queued_bytes_ = 0;
+  bool stopped_ = false;
+
+  std::vector<std::unique_ptr<PrefetchedWalRecord>> group_;
+  size_t group_bytes_ = 0;
+  std::deque<std::shared_ptr<PendingFlush>> flushes_;
+};
+
+bool DBImpl::ParallelWalReplay::Push(
+    std::unique_ptr<PrefetchedWalRecord> record) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  queue_cv_.wait(lock, [this] {
+    return stopped_ || queued_bytes_ < kMaxPrefetchBytes;
+  });
+  if (stopped_) {
+    return false;
+  }
+  queued_bytes_ += record->record_size;
+  queue_.push_back(std::move(record));
+  queue_cv_.notify_all();
+  return true;
+}
+
+void DBImpl::ParallelWalReplay::Prefetch() {
+  const ImmutableDBOptions& db_options = db_->immutable_db_options_;
+  for (uint64_t wal_number : wal_numbers_) {
+    std::string fname = LogFileName(db_options.GetWalDir(), wal_number);
+    auto end = std::make_unique<PrefetchedWalRecord>();
+    std::unique_ptr<SequentialFileReader> file_reader;
+    {
+      std::unique_ptr<FSSequentialFile> file;
+      IOStatus io_s = db_->fs_->NewSequentialFile(
+          fname, db_->fs_->OptimizeForLogRead(db_->file_options_), &file,
+          nullptr);
+      if (!io_s.ok()) {
+        end->kind = PrefetchedWalRecord::kOpenFailed;
+        end->status = io_s;
+        if (!Push(std::move(end))) {
+          return;
+        }
+        continue;
+      }
+      file_reader.reset(new SequentialFileReader(
+          std::move(file), fname, db_options.log_readahead_size,
+          db_->io_tracer_));
+    }
+
+    Status status;
+    LogReporter reporter;
+    InitLogReporter(db_options, db_->env_, fname, &status, &reporter);
+    log::Reader reader(db_options.info_log, std::move(file_reader), &reporter,
+                       true /*checksum*/, wal_number);
+    std::string scratch;
+    Slice record;
+    uint64_t record_checksum;
+    TEST_SYNC_POINT_CALLBACK("DBImpl::RecoverLogFiles:BeforeReadWal",
+                             /*arg=*/nullptr);
+    while (reader.ReadRecord(&record, &scratch, db_options.wal_recovery_mode,
+                             &record_checksum) &&
+           status.ok()) {
+      if (record.size() < WriteBatchInternal::kHeader) {
+        reporter.Corruption(record.size(),
+                            Status::Corruption("log record too small"));
+        continue;
+      }
+      auto prefetched = std::make_unique<PrefetchedWalRecord>();
+      prefetched->record_size = record.size();
+      prefetched->status = DecodeWalRecord(
+          record, record_checksum, running_ts_sz_,
+          reader.GetRecordedTimestampSize(), &prefetched->batch);
+      if (prefetched->status.ok()) {
+        prefetched->point_writes_only =
+            WriteBatchInternal::HasOnlyPointWrites(&prefetched->batch);
+      }
+      // Keep reading after a record that failed to decode, the replay may
+      // have stopped before it
+      if (!Push(std::move(prefetched))) {
+        return;
+      }
+    }
+    end->kind = PrefetchedWalRecord::kEndOfWal;
+    end->status = status;
+    if (!Push(std::move(end))) {
+      return;
+    }
+  }
+}
+
+void DBImpl::ParallelWalReplay::InsertBatches(Group* group) {
+  // Each thread needs its own cursor over the column families
+  ColumnFamilyMemTablesImpl memtables(db_->column_family_memtables_.get());
+  const size_t num = group->records.size();
+  for (size_t i = group->next.fetch_add(1, std::memory_order_relaxed);
+       i < num; i = group->next.fetch_add(1, std::memory_order_relaxed)) {
+    bool has_valid_writes = false;
+    group->statuses[i] = WriteBatchInternal::InsertInto(
+        &group->records[i]->batch, &memtables, &db_->flush_scheduler_,
+        &db_->trim_history_scheduler_, true, group->wal_number, db_,
+        true /* concurrent_memtable_writes */, nullptr /* next_seq */,
+        &has_valid_writes, db_->seq_per_batch_, db_->batch_per_txn_);
+    group->has_valid_writes[i] = has_valid_writes;
+  }
+}
+
+Status DBImpl::ParallelWalReplay::InsertGroup(uint64_t wal_number,
+                                              bool* has_valid_writes) {
+  db_->mutex_.AssertHeld();
+  if (group_.empty()) {
+    return Status::OK();
+  }
+  TEST_SYNC_POINT("DBImpl::ParallelWalReplay::InsertGroup");
+  auto group = std::make_shared<Group>();
+  group->records.swap(group_);
+  group_bytes_ = 0;
+  const size_t num = group->records.size();
+  group->statuses.resize(num);
+  group->has_valid_writes.reset(new bool[num]());
+  group->wal_number = wal_number;
+
+  const size_t num_helpers =
+      std::min(static_cast<size_t>(num_threads_ - 1), num - 1);
+  for (size_t i = 0; i < num_helpers; ++i) {
+    pool_.SubmitJob([this, group] {
+      {
+        std::lock_guard<std::mutex> lock(group->mutex);
+        if (group->closed) {
+          return;
+        }
+        ++group->active;
+      }
+      InsertBatches(group.get());
+      std::lock_guard<std::mutex> lock(group->mutex);
+      if (--group->active == 0) {
+        group->cv.notify_all();
+      }
+    });
+  }
+  InsertBatches(group.get());
+  {
+    std::unique_lock<std::mutex> lock(group->mutex);
+    group->closed = true;
+    group->cv.wait(lock, [&group] { return group->active == 0; });
+  }
+
+  for (size_t i = 0; i < num; ++i) {
+    Status s = std::move(group->statuses[i]);
+    db_->MaybeIgnoreError(&s);
+    if (!s.ok()) {
+      ROCKS_LOG_ERROR(db_->immutable_db_options_.info_log,
+                      "Failed to replay a batch of log #%" PRIu64 ": %s",
+                      wal_number, s.ToString().c_str());
+      for (size_t j = i + 1; j < num; ++j) {
+        group->statuses[j].PermitUncheckedError();
+      }
+      return s;
+    }
+    *has_valid_writes |= group->has_valid_writes[i];
+  }
+  return Status::OK();
+}
+
+Status DBImpl::ParallelWalReplay::ScheduleFlush(ColumnFamilyData* cfd,
+                                                VersionEdit* edit,
+                                                SequenceNumber next_sequence) {
+  db_->mutex_.AssertHeld();
+  // Each pending flush holds a full memtable
+  if (flushes_.size() >= static_cast<size_t>(num_threads_)) {
+    Status s = InstallOldestFlush();
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  auto pending = std::make_shared<PendingFlush>();
+  pending->edit = edit;
+  MemTable* mem = cfd->mem();
+  TEST_SYNC_POINT_CALLBACK("DBImpl::ParallelWalReplay::ScheduleFlush", mem);
+  mem->Ref();
+  db_->PrepareRecoveryFlush(job_id_, cfd, mem, &pending->flush);
+  cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(), next_sequence);
+  flushes_.push_back(pending);
+  pool_.SubmitJob([this, pending] {
+    db_->BuildRecoveryFlush(&pending->flush);
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending->built = true;
+    flush_cv_.notify_all();
+  });
+  return Status::OK();
+}
+
+Status DBImpl::ParallelWalReplay::InstallOldestFlush() {
+  std::shared_ptr<PendingFlush> pending = std::move(flushes_.front());
+  flushes_.pop_front();
+  db_->mutex_.Unlock();
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    flush_cv_.wait(lock, [&pending] { return pending->built; });
+  }
+  db_->mutex_.Lock();
+  Status s = db_->InstallRecoveryFlush(&pending->flush, pending->edit);
+  delete pending->flush.mem->Unref();
+  return s;
+}
+
+bool DBImpl::CanReplayWalsInParallel() const {
+  if (immutable_db_options_.wal_recovery_threads <= 1 ||
+      immutable_db_options_.wal_filter != nullptr || allow_2pc() ||
+      seq_per_batch_) {
+    return false;
+  }
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    const ImmutableOptions* ioptions = cfd->ioptions();
+    if (!ioptions->memtable_factory->IsInsertConcurrentlySupported() ||
+        ioptions->inplace_update_support) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // REQUIRES: wal_numbers are sorted in ascending order
 Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
                                SequenceNumber* next_sequence, bool read_only,
                                bool* corrupted_wal_found,
                                RecoveryContext* recovery_ctx) {
-  struct LogReporter : public log::Reader::Reporter {
-    Env* env;
-    Logger* info_log;
-    const char* fname;
-    Status* status;  // nullptr if immutable_db_options_.paranoid_checks==false
-    void Corruption(size_t bytes, const Status& s) override {
-      ROCKS_LOG_WARN(info_log, "%s%s: dropping %d bytes; %s",
-                     (status == nullptr ? "(ignoring error) " : ""), fname,
-                     static_cast<int>(bytes), s.ToString().c_str());
-      if (status != nullptr && status->ok()) {
-        *status = s;
-      }
-    }
-  };
-
   mutex_.AssertHeld();
   Status status;
   std::unordered_map<int, VersionEdit> version_edits;
@@ -1111,6 +1552,19 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
     min_wal_number =
         std::max(min_wal_number, versions_->MinLogNumberWithUnflushedData());
   }
+  std::unique_ptr<ParallelWalReplay> parallel_replay;
+  if (CanReplayWalsInParallel()) {
+    std::vector<uint64_t> replayed_wal_numbers;
+    for (auto wal_number : wal_numbers) {
+      if (wal_number >= min_wal_number) {
+        replayed_wal_numbers.push_back(wal_number);
+      }
+    }
+    if (!replayed_wal_numbers.empty()) {
+      parallel_replay.reset(new ParallelWalReplay(
+          this, std::move(replayed_wal_numbers), job_id));
+    }
+  }
   for (auto wal_number : wal_numbers) {
     if (wal_number < min_wal_number) {
       ROCKS_LOG_INFO(immutable_db_options_.info_log,
@@ -1143,164 +1597,245 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
       continue;
     }
 
-    std::unique_ptr<SequentialFileReader> file_reader;
-    {
-      std::unique_ptr<FSSequentialFile> file;
-      status = fs_->NewSequentialFile(
-          fname, fs_->OptimizeForLogRead(file_options_), &file, nullptr);
-      if (!status.ok()) {
+    if (parallel_replay != nullptr) {
+      // Same as the sequential replay below, except that the records come
+      // from the prefetch thread, and that the batches with only point writes
+      // are inserted in groups and the full memtables flushed in the
+      // background by parallel_replay.
+      std::unique_ptr<PrefetchedWalRecord> prefetched = parallel_replay->Next();
+      if (prefetched->kind == PrefetchedWalRecord::kOpenFailed) {
+        status = prefetched->status;
         MaybeIgnoreError(&status);
         if (!status.ok()) {
           return status;
-        } else {
-          // Fail with one log file, but that's ok.
-          // Try next one.
+        }
+        continue;
+      }
+      LogReporter reporter;
+      InitLogReporter(immutable_db_options_, env_, fname, &status, &reporter);
+      auto schedule_flushes = [&](bool has_valid_writes) {
+        Status s;
+        if (!has_valid_writes || read_only) {
+          return s;
+        }
+        ColumnFamilyData* cfd;
+        while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
+          cfd->UnrefAndTryDelete();
+          assert(cfd->GetLogNumber() <= wal_number);
+          auto iter = version_edits.find(cfd->GetID());
+          assert(iter != version_edits.end());
+          s = parallel_replay->ScheduleFlush(cfd, &iter->second,
+                                             *next_sequence);
+          if (!s.ok()) {
+            break;
+          }
+          flushed = true;
+        }
+        return s;
+      };
+      auto insert_group = [&]() {
+        bool has_valid_writes = false;
+        Status s = parallel_replay->InsertGroup(wal_number, &has_valid_writes);
+        if (s.ok()) {
+          s = schedule_flushes(has_valid_writes);
+        }
+        return s;
+      };
+      // Set when the sequential replay would have stopped reading this WAL,
+      // its remaining records are dropped
+      bool dropped = false;
+      for (; prefetched->kind == PrefetchedWalRecord::kRecord;
+           prefetched = parallel_replay->Next()) {
+        if (dropped || !status.ok()) {
+          continue;
+        }
+        if (!prefetched->status.ok()) {
+          return prefetched->status;
+        }
+        WriteBatch* batch = &prefetched->batch;
+        SequenceNumber sequence = WriteBatchInternal::Sequence(batch);
+        if (immutable_db_options_.wal_recovery_mode ==
+            WALRecoveryMode::kPointInTimeRecovery) {
+          if (sequence == *next_sequence) {
+            stop_replay_for_corruption = false;
+          }
+          if (stop_replay_for_corruption) {
+            logFileDropped();
+            dropped = true;
+            continue;
+          }
+        }
+        if (prefetched->point_writes_only) {
+          *next_sequence = sequence + WriteBatchInternal::Count(batch);
+          parallel_replay->AddToGroup(std::move(prefetched));
+          if (parallel_replay->GroupFull()) {
+            Status s = insert_group();
+            if (!s.ok()) {
+              return s;
+            }
+          }
+          continue;
+        }
+        // A barrier, the group before it goes first
+        Status s = insert_group();
+        if (!s.ok()) {
+          return s;
+        }
+        bool has_valid_writes = false;
+        status = WriteBatchInternal::InsertInto(
+            batch, column_family_memtables_.get(), &flush_scheduler_,
+            &trim_history_scheduler_, true, wal_number, this,
+            false /* concurrent_memtable_writes */, next_sequence,
+            &has_valid_writes, seq_per_batch_, batch_per_txn_);
+        MaybeIgnoreError(&status);
+        if (!status.ok()) {
+          reporter.Corruption(prefetched->record_size, status);
           continue;
         }
+        s = schedule_flushes(has_valid_writes);
+        if (!s.ok()) {
+          return s;
+        }
+      }
+      assert(prefetched->kind == PrefetchedWalRecord::kEndOfWal);
+      Status s = insert_group();
+      if (!s.ok()) {
+        return s;
+      }
+      if (!dropped && status.ok()) {
+        status = prefetched->status;
       }
-      file_reader.reset(new SequentialFileReader(
-          std::move(file), fname, immutable_db_options_.log_readahead_size,
-          io_tracer_));
-    }
-
-    // Create the log reader.
-    LogReporter reporter;
-    reporter.env = env_;
-    reporter.info_log = immutable_db_options_.info_log.get();
-    reporter.fname = fname.c_str();
-    if (!immutable_db_options_.paranoid_checks ||
-        immutable_db_options_.wal_recovery_mode ==
-            WALRecoveryMode::kSkipAnyCorruptedRecords) {
-      reporter.status = nullptr;
     } else {
-      reporter.status = &status;
-    }
-    // We intentially make log::Reader do checksumming even if
-    // paranoid_checks==false so that corruptions cause entire commits
-    // to be skipped instead of propagating bad information (like overly
-    // large sequence numbers).
-    log::Reader reader(immutable_db_options_.info_log, std::move(file_reader),
-                       &reporter, true /*checksum*/, wal_number);
-
-    // Determine if we should tolerate incomplete records at the tail end of the
-    // Read all the records and add to a memtable
-    std::string scratch;
-    Slice record;
-
-    const UnorderedMap<uint32_t, size_t>& running_ts_sz =
-        versions_->GetRunningColumnFamiliesTimestampSize();
-
-    TEST_SYNC_POINT_CALLBACK("DBImpl::RecoverLogFiles:BeforeReadWal",
-                             /*arg=*/nullptr);
-    uint64_t record_checksum;
-    while (!stop_replay_by_wal_filter &&
-           reader.ReadRecord(&record, &scratch,
-                             immutable_db_options_.wal_recovery_mode,
-                             &record_checksum) &&
-           status.ok()) {
-      if (record.size() < WriteBatchInternal::kHeader) {
-        reporter.Corruption(record.size(),
-                            Status::Corruption("log record too small"));
-        continue;
+      std::unique_ptr<SequentialFileReader> file_reader;
+      {
+        std::unique_ptr<FSSequentialFile> file;
+        status = fs_->NewSequentialFile(
+            fname, fs_->OptimizeForLogRead(file_options_), &file, nullptr);
+        if (!status.ok()) {
+          MaybeIgnoreError(&status);
+          if (!status.ok()) {
+            return status;
+          } else {
+            // Fail with one log file, but that's ok.
+            // Try next one.
+            continue;
+          }
+        }
+        file_reader.reset(new SequentialFileReader(
+            std::move(file), fname, immutable_db_options_.log_readahead_size,
+            io_tracer_));
       }
 
-      // We create a new batch and initialize with a valid prot_info_ to store
-      // the data checksums
-      WriteBatch batch;
+      // Create the log reader.
+      LogReporter reporter;
+      InitLogReporter(immutable_db_options_, env_, fname, &status, &reporter);
+      // We intentially make log::Reader do checksumming even if
+      // paranoid_checks==false so that corruptions cause entire commits
+      // to be skipped instead of propagating bad information (like overly
+      // large sequence numbers).
+      log::Reader reader(immutable_db_options_.info_log, std::move(file_reader),
+                         &reporter, true /*checksum*/, wal_number);
+
+      // Determine if we should tolerate incomplete records at the tail end of
+      // the Read all the records and add to a memtable
+      std::string scratch;
+      Slice record;
+
+      const UnorderedMap<uint32_t, size_t>& running_ts_sz =
+          versions_->GetRunningColumnFamiliesTimestampSize();
+
+      TEST_SYNC_POINT_CALLBACK("DBImpl::RecoverLogFiles:BeforeReadWal",
+                               /*arg=*/nullptr);
+      uint64_t record_checksum;
+      while (!stop_replay_by_wal_filter &&
+             reader.ReadRecord(&record, &scratch,
+                               immutable_db_options_.wal_recovery_mode,
+                               &record_checksum) &&
+             status.ok()) {
+        if (record.size() < WriteBatchInternal::kHeader) {
+          reporter.Corruption(record.size(),
+                              Status::Corruption("log record too small"));
+          continue;
+        }
 
-      status = WriteBatchInternal::SetContents(&batch, record);
-      if (!status.ok()) {
-        return status;
-      }
+        // We create a new batch and initialize with a valid prot_info_ to store
+        // the data checksums
+        WriteBatch batch;
 
-      const UnorderedMap<uint32_t, size_t>& record_ts_sz =
-          reader.GetRecordedTimestampSize();
-      // TODO(yuzhangyu): update mode to kReconcileInconsistency when user
-      // comparator can be changed.
-      status = HandleWriteBatchTimestampSizeDifference(
-          &batch, running_ts_sz, record_ts_sz,
-          TimestampSizeConsistencyMode::kVerifyConsistency);
-      if (!status.ok()) {
-        return status;
-      }
-      TEST_SYNC_POINT_CALLBACK(
-          "DBImpl::RecoverLogFiles:BeforeUpdateProtectionInfo:batch", &batch);
-      TEST_SYNC_POINT_CALLBACK(
-          "DBImpl::RecoverLogFiles:BeforeUpdateProtectionInfo:checksum",
-          &record_checksum);
-      status = WriteBatchInternal::UpdateProtectionInfo(
-          &batch, 8 /* bytes_per_key */, &record_checksum);
-      if (!status.ok()) {
-        return status;
-      }
+        status = DecodeWalRecord(record, record_checksum, running_ts_sz,
+                                 reader.GetRecordedTimestampSize(), &batch);
+        if (!status.ok()) {
+          return status;
+        }
 
-      SequenceNumber sequence = WriteBatchInternal::Sequence(&batch);
+        SequenceNumber sequence = WriteBatchInternal::Sequence(&batch);
 
-      if (immutable_db_options_.wal_recovery_mode ==
-          WALRecoveryMode::kPointInTimeRecovery) {
-        // In point-in-time recovery mode, if sequence id of log files are
-        // consecutive, we continue recovery despite corruption. This could
-        // happen when we open and write to a corrupted DB, where sequence id
-        // will start from the last sequence id we recovered.
-        if (sequence == *next_sequence) {
-          stop_replay_for_corruption = false;
-        }
-        if (stop_replay_for_corruption) {
-          logFileDropped();
-          break;
+        if (immutable_db_options_.wal_recovery_mode ==
+            WALRecoveryMode::kPointInTimeRecovery) {
+          // In point-in-time recovery mode, if sequence id of log files are
+          // consecutive, we continue recovery despite corruption. This could
+          // happen when we open and write to a corrupted DB, where sequence id
+          // will start from the last sequence id we recovered.
+          if (sequence == *next_sequence) {
+            stop_replay_for_corruption = false;
+          }
+          if (stop_replay_for_corruption) {
+            logFileDropped();
+            break;
+          }
         }
-      }
 
-      // For the default case of wal_filter == nullptr, always performs no-op
-      // and returns true.
-      if (!InvokeWalFilterIfNeededOnWalRecord(wal_number, fname, reporter,
-                                              status, stop_replay_by_wal_filter,
-                                              batch)) {
-        continue;
-      }
+        // For the default case of wal_filter == nullptr, always performs no-op
+        // and returns true.
+        if (!InvokeWalFilterIfNeededOnWalRecord(
+                wal_number, fname, reporter, status, stop_replay_by_wal_filter,
+                batch)) {
+          continue;
+        }
 
-      // If column family was not found, it might mean that the WAL write
-      // batch references to the column family that was dropped after the
-      // insert. We don't want to fail the whole write batch in that case --
-      // we just ignore the update.
-      // That's why we set ignore missing column families to true
-      bool has_valid_writes = false;
-      status = WriteBatchInternal::InsertInto(
-          &batch, column_family_memtables_.get(), &flush_scheduler_,
-          &trim_history_scheduler_, true, wal_number, this,
-          false /* concurrent_memtable_writes */, next_sequence,
-          &has_valid_writes, seq_per_batch_, batch_per_txn_);
-      MaybeIgnoreError(&status);
-      if (!status.ok()) {
-        // We are treating this as a failure while reading since we read valid
-        // blocks that do not form coherent data
-        reporter.Corruption(record.size(), status);
-        continue;
-      }
+        // If column family was not found, it might mean that the WAL write
+        // batch references to the column family that was dropped after the
+        // insert. We don't want to fail the whole write batch in that case --
+        // we just ignore the update.
+        // That's why we set ignore missing column families to true
+        bool has_valid_writes = false;
+        status = WriteBatchInternal::InsertInto(
+            &batch, column_family_memtables_.get(), &flush_scheduler_,
+            &trim_history_scheduler_, true, wal_number, this,
+            false /* concurrent_memtable_writes */, next_sequence,
+            &has_valid_writes, seq_per_batch_, batch_per_txn_);
+        MaybeIgnoreError(&status);
+        if (!status.ok()) {
+          // We are treating this as a failure while reading since we read
+          // valid blocks that do not form coherent data
+          reporter.Corruption(record.size(), status);
+          continue;
+        }
 
-      if (has_valid_writes && !read_only) {
-        // we can do this because this is called before client has access to the
-        // DB and there is only a single thread operating on DB
-        ColumnFamilyData* cfd;
+        if (has_valid_writes && !read_only) {
+          // we can do this because this is called before client has access to
+          // the DB and there is only a single thread operating on DB
+          ColumnFamilyData* cfd;
+
+          while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
+            cfd->UnrefAndTryDelete();
+            // If this asserts, it means that InsertInto failed in
+            // filtering updates to already-flushed column families
+            assert(cfd->GetLogNumber() <= wal_number);
+            auto iter = version_edits.find(cfd->GetID());
+            assert(iter != version_edits.end());
+            VersionEdit* edit = &iter->second;
+            status = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
+            if (!status.ok()) {
+              // Reflect errors immediately so that conditions like full
+              // file-systems cause the DB::Open() to fail.
+              return status;
+            }
+            flushed = true;
 
-        while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
-          cfd->UnrefAndTryDelete();
-          // If this asserts, it means that InsertInto failed in
-          // filtering updates to already-flushed column families
-          assert(cfd->GetLogNumber() <= wal_number);
-          auto iter = version_edits.find(cfd->GetID());
-          assert(iter != version_edits.end());
-          VersionEdit* edit = &iter->second;
-          status = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
-          if (!status.ok()) {
-            // Reflect errors immediately so that conditions like full
-            // file-systems cause the DB::Open() to fail.
-            return status;
+            cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
+                                   *next_sequence);
           }
-          flushed = true;
-
-          cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
-                                 *next_sequence);
         }
       }
     }
@@ -1358,6 +1893,13 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
       versions_->SetLastSequence(last_sequence);
     }
   }
+  if (parallel_replay != nullptr) {
+    Status s = parallel_replay->FinishFlushes();
+    if (!s.ok()) {
+      return s;
+    }
+    parallel_replay.reset();
+  }
   // Compare the corrupted log number to all columnfamily's current log number.
   // Abort Open() if any column family's log number is greater than
   // the corrupted log number, which means CF contains data beyond the point of
@@ -1577,6 +2119,16 @@ Status DBImpl::RestoreAliveLogFiles(const std::vector<uint64_t>& wal_numbers) {
 
 Status DBImpl::WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
                                            MemTable* mem, VersionEdit* edit) {
+  RecoveryFlush flush;
+  PrepareRecoveryFlush(job_id, cfd, mem, &flush);
+  mutex_.Unlock();
+  BuildRecoveryFlush(&flush);
+  mutex_.Lock();
+  return InstallRecoveryFlush(&flush, edit);
+}
+
+void DBImpl::PrepareRecoveryFlush(int job_id, ColumnFamilyData* cfd,
+                                  MemTable* mem, RecoveryFlush* flush) {
   mutex_.AssertHeld();
   assert(cfd);
   assert(cfd->imm());
@@ -1584,103 +2136,108 @@ Status DBImpl::WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
   assert(std::numeric_limits<uint64_t>::max() ==
          cfd->imm()->GetEarliestMemTableID());
 
-  const uint64_t start_micros = immutable_db_options_.clock->NowMicros();
+  flush->job_id = job_id;
+  flush->cfd = cfd;
+  flush->mem = mem;
+  flush->start_micros = immutable_db_options_.clock->NowMicros();
 
-  FileMetaData meta;
-  std::vector<BlobFileAddition> blob_file_additions;
-
-  std::unique_ptr<std::list<uint64_t>::iterator> pending_outputs_inserted_elem(
+  FileMetaData& meta = flush->meta;
+  flush->pending_outputs_inserted_elem.reset(
       new std::list<uint64_t>::iterator(
           CaptureCurrentFileNumberInPendingOutputs()));
   meta.fd = FileDescriptor(versions_->NewFileNumber(), 0, 0);
+  ROCKS_LOG_DEBUG(immutable_db_options_.info_log,
+                  "[%s] [WriteLevel0TableForRecovery]"
+                  " Level-0 table #%" PRIu64 ": started",
+                  cfd->GetName().c_str(), meta.fd.GetNumber());
+
+  // Get the latest mutable cf options while the mutex is still locked
+  flush->mutable_cf_options = *cfd->GetLatestMutableCFOptions();
+
+  int64_t _current_time = 0;
+  immutable_db_options_.clock->GetCurrentTime(&_current_time)
+      .PermitUncheckedError();  // ignore error
+  const uint64_t current_time = static_cast<uint64_t>(_current_time);
+  meta.oldest_ancester_time = current_time;
+  meta.epoch_number = cfd->NewEpochNumber();
+  flush->write_hint = cfd->CalculateSSTWriteHint(0);
+  flush->version = cfd->current();
+  flush->version->Ref();
+}
+
+void DBImpl::BuildRecoveryFlush(RecoveryFlush* flush) {
+  ColumnFamilyData* cfd = flush->cfd;
+  const MutableCFOptions& mutable_cf_options = flush->mutable_cf_options;
+  FileMetaData& meta = flush->meta;
   ReadOptions ro;
   ro.total_order_seek = true;
   ro.io_activity = Env::IOActivity::kDBOpen;
   Arena arena;
-  Status s;
-  TableProperties table_properties;
-  {
-    ScopedArenaIterator iter(mem->NewIterator(ro, &arena));
-    ROCKS_LOG_DEBUG(immutable_db_options_.info_log,
-                    "[%s] [WriteLevel0TableForRecovery]"
-                    " Level-0 table #%" PRIu64 ": started",
-                    cfd->GetName().c_str(), meta.fd.GetNumber());
-
-    // Get the latest mutable cf options while the mutex is still locked
-    const MutableCFOptions mutable_cf_options =
-        *cfd->GetLatestMutableCFOptions();
-    bool paranoid_file_checks =
-        cfd->GetLatestMutableCFOptions()->paranoid_file_checks;
-
-    int64_t _current_time = 0;
-    immutable_db_options_.clock->GetCurrentTime(&_current_time)
-        .PermitUncheckedError();  // ignore error
-    const uint64_t current_time = static_cast<uint64_t>(_current_time);
-    meta.oldest_ancester_time = current_time;
-    meta.epoch_number = cfd->NewEpochNumber();
-    {
-      auto write_hint = cfd->CalculateSSTWriteHint(0);
-      mutex_.Unlock();
-
-      SequenceNumber earliest_write_conflict_snapshot;
-      std::vector<SequenceNumber> snapshot_seqs =
-          snapshots_.GetAll(&earliest_write_conflict_snapshot);
-      auto snapshot_checker = snapshot_checker_.get();
-      if (use_custom_gc_ && snapshot_checker == nullptr) {
-        snapshot_checker = DisableGCSnapshotChecker::Instance();
-      }
-      std::vector<std::unique_ptr<FragmentedRangeTombstoneIterator>>
-          range_del_iters;
-      auto range_del_iter =
-          // This is called during recovery, where a live memtable is flushed
-          // directly. In this case, no fragmented tombstone list is cached in
-          // this memtable yet.
-          mem->NewRangeTombstoneIterator(ro, kMaxSequenceNumber,
-                                         false /* immutable_memtable */);
-      if (range_del_iter != nullptr) {
-        range_del_iters.emplace_back(range_del_iter);
-      }
-
-      IOStatus io_s;
-      TableBuilderOptions tboptions(
-          *cfd->ioptions(), mutable_cf_options, cfd->internal_comparator(),
-          cfd->int_tbl_prop_collector_factories(),
-          GetCompressionFlush(*cfd->ioptions(), mutable_cf_options),
-          mutable_cf_options.compression_opts, cfd->GetID(), cfd->GetName(),
-          0 /* level */, false /* is_bottommost */,
-          TableFileCreationReason::kRecovery, 0 /* oldest_key_time */,
-          0 /* file_creation_time */, db_id_, db_session_id_,
-          0 /* target_file_size */, meta.fd.GetNumber());
-      SeqnoToTimeMapping empty_seqno_time_mapping;
-      Version* version = cfd->current();
-      version->Ref();
-      const ReadOptions read_option(Env::IOActivity::kDBOpen);
-      s = BuildTable(
-          dbname_, versions_.get(), immutable_db_options_, tboptions,
-          file_options_for_compaction_, read_option, cfd->table_cache(),
-          iter.get(), std::move(range_del_iters), &meta, &blob_file_additions,
-          snapshot_seqs, earliest_write_conflict_snapshot, kMaxSequenceNumber,
-          snapshot_checker, paranoid_file_checks, cfd->internal_stats(), &io_s,
-          io_tracer_, BlobFileCreationReason::kRecovery,
-          empty_seqno_time_mapping, &event_logger_, job_id, Env::IO_HIGH,
-          nullptr /* table_properties */, write_hint,
-          nullptr /*full_history_ts_low*/, &blob_callback_, version);
-      version->Unref();
-      LogFlush(immutable_db_options_.info_log);
-      ROCKS_LOG_DEBUG(immutable_db_options_.info_log,
-                      "[%s] [WriteLevel0TableForRecovery]"
-                      " Level-0 table #%" PRIu64 ": %" PRIu64 " bytes %s",
-                      cfd->GetName().c_str(), meta.fd.GetNumber(),
-                      meta.fd.GetFileSize(), s.ToString().c_str());
-      mutex_.Lock();
-
-      // TODO(AR) is this ok?
-      if (!io_s.ok() && s.ok()) {
-        s = io_s;
-      }
-    }
+  ScopedArenaIterator iter(flush->mem->NewIterator(ro, &arena));
+
+  SequenceNumber earliest_write_conflict_snapshot;
+  std::vector<SequenceNumber> snapshot_seqs =
+      snapshots_.GetAll(&earliest_write_conflict_snapshot);
+  auto snapshot_checker = snapshot_checker_.get();
+  if (use_custom_gc_ && snapshot_checker == nullptr) {
+    snapshot_checker = DisableGCSnapshotChecker::Instance();
+  }
+  std::vector<std::unique_ptr<FragmentedRangeTombstoneIterator>>
+      range_del_iters;
+  auto range_del_iter =
+      // This is called during recovery, where a live memtable is flushed
+      // directly. In this case, no fragmented tombstone list is cached in
+      // this memtable yet.
+      flush->mem->NewRangeTombstoneIterator(ro, kMaxSequenceNumber,
+                                            false /* immutable_memtable */);
+  if (range_del_iter != nullptr) {
+    range_del_iters.emplace_back(range_del_iter);
   }
-  ReleaseFileNumberFromPendingOutputs(pending_outputs_inserted_elem);
+
+  IOStatus io_s;
+  TableBuilderOptions tboptions(
+      *cfd->ioptions(), mutable_cf_options, cfd->internal_comparator(),
+      cfd->int_tbl_prop_collector_factories(),
+      GetCompressionFlush(*cfd->ioptions(), mutable_cf_options),
+      mutable_cf_options.compression_opts, cfd->GetID(), cfd->GetName(),
+      0 /* level */, false /* is_bottommost */,
+      TableFileCreationReason::kRecovery, 0 /* oldest_key_time */,
+      0 /* file_creation_time */, db_id_, db_session_id_,
+      0 /* target_file_size */, meta.fd.GetNumber());
+  SeqnoToTimeMapping empty_seqno_time_mapping;
+  const ReadOptions read_option(Env::IOActivity::kDBOpen);
+  Status s = BuildTable(
+      dbname_, versions_.get(), immutable_db_options_, tboptions,
+      file_options_for_compaction_, read_option, cfd->table_cache(),
+      iter.get(), std::move(range_del_iters), &meta,
+      &flush->blob_file_additions, snapshot_seqs,
+      earliest_write_conflict_snapshot, kMaxSequenceNumber, snapshot_checker,
+      mutable_cf_options.paranoid_file_checks, cfd->internal_stats(), &io_s,
+      io_tracer_, BlobFileCreationReason::kRecovery, empty_seqno_time_mapping,
+      &event_logger_, flush->job_id, Env::IO_HIGH,
+      nullptr /* table_properties */, flush->write_hint,
+      nullptr /*full_history_ts_low*/, &blob_callback_, flush->version);
+  LogFlush(immutable_db_options_.info_log);
+  ROCKS_LOG_DEBUG(immutable_db_options_.info_log,
+                  "[%s] [WriteLevel0TableForRecovery]"
+                  " Level-0 table #%" PRIu64 ": %" PRIu64 " bytes %s",
+                  cfd->GetName().c_str(), meta.fd.GetNumber(),
+                  meta.fd.GetFileSize(), s.ToString().c_str());
+
+  // TODO(AR) is this ok?
+  if (!io_s.ok() && s.ok()) {
+    s = io_s;
+  }
+  flush->status = s;
+}
+
+Status DBImpl::InstallRecoveryFlush(RecoveryFlush* flush, VersionEdit* edit) {
+  mutex_.AssertHeld();
+  ColumnFamilyData* cfd = flush->cfd;
+  const FileMetaData& meta = flush->meta;
+  flush->version->Unref();
+  flush->version = nullptr;
+  ReleaseFileNumberFromPendingOutputs(flush->pending_outputs_inserted_elem);
 
   // Note that if file_size is zero, the file has been deleted and
   // should not be added to the manifest.
@@ -1688,7 +2245,7 @@ Status DBImpl::WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
 
   constexpr int level = 0;
 
-  if (s.ok() && has_output) {
+  if (flush->status.ok() && has_output) {
     edit->AddFile(
         level, meta.fd.GetNumber(), meta.fd.GetPathId(), meta.fd.GetFileSize(),
         meta.smallest, meta.largest, meta.fd.smallest_seqno,
@@ -1698,13 +2255,14 @@ Status DBImpl::WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
         meta.file_checksum_func_name, meta.unique_id,
         meta.compensated_range_deletion_size, meta.tail_size);
 
-    for (const auto& blob : blob_file_additions) {
+    for (const auto& blob : flush->blob_file_additions) {
       edit->AddBlobFile(blob);
     }
   }
 
   InternalStats::CompactionStats stats(CompactionReason::kFlush, 1);
-  stats.micros = immutable_db_options_.clock->NowMicros() - start_micros;
+  stats.micros =
+      immutable_db_options_.clock->NowMicros() - flush->start_micros;
 
   if (has_output) {
     stats.bytes_written = meta.fd.GetFileSize();
@@ -1723,7 +2281,7 @@ Status DBImpl::WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
       InternalStats::BYTES_FLUSHED,
       stats.bytes_written + stats.bytes_written_blob);
   RecordTick(stats_, COMPACT_WRITE_BYTES, meta.fd.GetFileSize());
-  return s;
+  return flush->status;
 }
 
 Status DB::Open(const Options& options, const std::string& dbname, DB** dbptr) {
@@ -2204,6 +2762,9 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
   if (s.ok()) {
     s = impl->RegisterRecordSeqnoTimeWorker();
   }
+  if (s.ok()) {
+    s = impl->StartBlockCacheWarmUp();
+  }
   if (!s.ok()) {
     for (auto* h : *handles) {
       delete h;
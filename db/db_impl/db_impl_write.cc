@@ -16,6 +16,7 @@
 #include "options/options_helper.h"
 #include "test_util/sync_point.h"
 #include "util/cast_util.h"
+#include "util/crc32c.h"
 
 namespace ROCKSDB_NAMESPACE {
 // Convenience methods
@@ -308,6 +309,9 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
                         post_memtable_callback);
   StopWatch write_sw(immutable_db_options_.clock, stats_, DB_WRITE);
 
+  if (wal_gather_write_ && !write_options.disableWAL) {
+    w.PrepareWalPayload();
+  }
   write_thread_.JoinBatchGroup(&w);
   if (w.state == WriteThread::STATE_PARALLEL_MEMTABLE_WRITER) {
     // we are a non-leader in a parallel group
@@ -666,6 +670,9 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
   WriteThread::Writer w(write_options, my_batch, callback, log_ref,
                         disable_memtable, /*_batch_cnt=*/0,
                         /*_pre_release_callback=*/nullptr);
+  if (wal_gather_write_ && !write_options.disableWAL) {
+    w.PrepareWalPayload();
+  }
   write_thread_.JoinBatchGroup(&w);
   TEST_SYNC_POINT("DBImplWrite::PipelinedWriteImpl:AfterJoinBatchGroup");
   if (w.state == WriteThread::STATE_GROUP_LEADER) {
@@ -1361,6 +1368,43 @@ IOStatus DBImpl::WriteToWAL(const WriteBatch& merged_batch,
   return io_s;
 }
 
+IOStatus DBImpl::WriteToWAL(const Slice* parts, const uint32_t* part_crcs,
+                            size_t num_parts, log::Writer* log_writer,
+                            uint64_t* log_used, uint64_t* log_size,
+                            Env::IOPriority rate_limiter_priority,
+                            LogFileNumberSize& log_file_number_size) {
+  assert(log_size != nullptr);
+  *log_size = 0;
+  for (size_t i = 0; i < num_parts; ++i) {
+    *log_size += parts[i].size();
+  }
+  // See WriteToWAL(merged_batch) for the locking
+  const bool needs_locking = manual_wal_flush_ && !two_write_queues_;
+  if (UNLIKELY(needs_locking)) {
+    log_write_mutex_.Lock();
+  }
+  IOStatus io_s = log_writer->MaybeAddUserDefinedTimestampSizeRecord(
+      versions_->GetColumnFamiliesTimestampSizeForRecord(),
+      rate_limiter_priority);
+  if (io_s.ok()) {
+    io_s = log_writer->AddRecord(parts, part_crcs, num_parts,
+                                 rate_limiter_priority);
+  }
+  if (UNLIKELY(needs_locking)) {
+    log_write_mutex_.Unlock();
+  }
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  if (log_used != nullptr) {
+    *log_used = logfile_number_;
+  }
+  total_log_size_ += *log_size;
+  log_file_number_size.AddSize(*log_size);
+  log_empty_ = false;
+  return io_s;
+}
+
 IOStatus DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
                             log::Writer* log_writer, uint64_t* log_used,
                             bool need_log_sync, bool need_log_dir_sync,
@@ -1372,27 +1416,72 @@ IOStatus DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
   // Same holds for all in the batch group
   size_t write_with_wal = 0;
   WriteBatch* to_be_cached_state = nullptr;
-  WriteBatch* merged_batch;
-  io_s = status_to_io_status(MergeBatch(write_group, &tmp_batch_, &merged_batch,
-                                        &write_with_wal, &to_be_cached_state));
-  if (UNLIKELY(!io_s.ok())) {
-    return io_s;
-  }
+  WriteBatch* merged_batch = nullptr;
+  uint64_t log_size;
 
-  if (merged_batch == write_group.leader->batch) {
-    write_group.leader->log_used = logfile_number_;
-  } else if (write_with_wal > 1) {
+  bool gather = wal_gather_write_;
+  for (auto writer : write_group) {
+    gather = gather && (writer->wal_payload_ready || writer->CallbackFailed());
+  }
+  if (gather) {
+    // The record is the header of the merged batch followed by the WAL
+    // payloads of the writers, which already computed their checksums
+    char header[WriteBatchInternal::kHeader];
+    auto& parts = tmp_wal_parts_;
+    auto& part_crcs = tmp_wal_part_crcs_;
+    parts.clear();
+    part_crcs.clear();
+    parts.emplace_back(header, sizeof(header));
+    part_crcs.push_back(0);
+    uint32_t count = 0;
     for (auto writer : write_group) {
+      if (writer->CallbackFailed()) {
+        continue;
+      }
+      Slice log_entry = WriteBatchInternal::Contents(writer->batch);
+      TEST_SYNC_POINT_CALLBACK("DBImpl::WriteToWAL:log_entry", &log_entry);
+      io_s = status_to_io_status(writer->batch->VerifyChecksum());
+      if (UNLIKELY(!io_s.ok())) {
+        return io_s;
+      }
+      parts.push_back(writer->wal_payload);
+      part_crcs.push_back(writer->wal_payload_crc);
+      count += writer->wal_payload_count;
+      if (WriteBatchInternal::IsLatestPersistentState(writer->batch)) {
+        to_be_cached_state = writer->batch;
+      }
       writer->log_used = logfile_number_;
+      write_with_wal++;
+    }
+    EncodeFixed64(header, sequence);
+    EncodeFixed32(header + 8, count);
+    part_crcs[0] = crc32c::Value(header, sizeof(header));
+    io_s = WriteToWAL(parts.data(), part_crcs.data(), parts.size(), log_writer,
+                      log_used, &log_size,
+                      write_group.leader->rate_limiter_priority,
+                      log_file_number_size);
+  } else {
+    io_s = status_to_io_status(MergeBatch(write_group, &tmp_batch_,
+                                          &merged_batch, &write_with_wal,
+                                          &to_be_cached_state));
+    if (UNLIKELY(!io_s.ok())) {
+      return io_s;
+    }
+
+    if (merged_batch == write_group.leader->batch) {
+      write_group.leader->log_used = logfile_number_;
+    } else if (write_with_wal > 1) {
+      for (auto writer : write_group) {
+        writer->log_used = logfile_number_;
+      }
     }
-  }
 
-  WriteBatchInternal::SetSequence(merged_batch, sequence);
+    WriteBatchInternal::SetSequence(merged_batch, sequence);
 
-  uint64_t log_size;
-  io_s = WriteToWAL(*merged_batch, log_writer, log_used, &log_size,
-                    write_group.leader->rate_limiter_priority,
-                    log_file_number_size);
+    io_s = WriteToWAL(*merged_batch, log_writer, log_used, &log_size,
+                      write_group.leader->rate_limiter_priority,
+                      log_file_number_size);
+  }
   if (to_be_cached_state) {
     cached_recoverable_state_ = *to_be_cached_state;
     cached_recoverable_state_empty_ = false;
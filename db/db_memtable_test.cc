@@ -387,6 +387,219 @@ TEST_F(DBMemTableTest, ColumnFamilyId) {
   }
 }
 
+TEST_F(DBMemTableTest, AdaptiveRadixTree) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.allow_concurrent_memtable_write = true;
+  options.memtable_factory.reset(new AdaptiveRadixTreeRepFactory());
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  std::map<std::string, std::string> expected;
+  for (int i = 0; i < 1000; ++i) {
+    std::string key = "key" + std::to_string(rnd.Uniform(300));
+    std::string value = rnd.RandomString(10);
+    ASSERT_OK(Put(key, value));
+    expected[key] = value;
+  }
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(Put("key1", "new"));
+  ASSERT_OK(Delete("key2"));
+  ASSERT_EQ("NOT_FOUND", Get("key2"));
+  ASSERT_EQ(expected.count("key2") ? expected["key2"] : "NOT_FOUND",
+            Get("key2", snapshot));
+  db_->ReleaseSnapshot(snapshot);
+  expected["key1"] = "new";
+  expected.erase("key2");
+
+  auto verify = [&]() {
+    for (auto& kv : expected) {
+      ASSERT_EQ(kv.second, Get(kv.first));
+    }
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    auto it = expected.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++it) {
+      ASSERT_TRUE(it != expected.end());
+      ASSERT_EQ(it->first, iter->key().ToString());
+      ASSERT_EQ(it->second, iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(it == expected.end());
+  };
+  verify();
+  // the flush goes through ConvertToSST
+  ASSERT_OK(Flush());
+  ASSERT_EQ(1, NumTableFilesAtLevel(0));
+  verify();
+  Reopen(options);
+  verify();
+
+  // non-bytewise comparator falls back to skip list
+  options.comparator = ReverseBytewiseComparator();
+  DestroyAndReopen(options);
+  ASSERT_OK(Put("a", "1"));
+  ASSERT_OK(Put("b", "2"));
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  iter->SeekToFirst();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("b", iter->key().ToString());
+}
+
+TEST_F(DBMemTableTest, SkipListConvertToSST) {
+  for (bool plain_table : {false, true}) {
+    Options options = CurrentOptions();
+    options.create_if_missing = true;
+    options.memtable_factory.reset(new SkipListFactory(0, true));
+    if (plain_table) {
+      options.table_factory.reset(NewPlainTableFactory());
+      options.allow_mmap_reads = true;
+    }
+    DestroyAndReopen(options);
+
+    ASSERT_OK(Put("a", "v1"));
+    ASSERT_OK(Put("b", "v1"));
+    ASSERT_OK(Put("a", "v2"));
+    ASSERT_OK(Delete("c"));
+    ASSERT_OK(Flush());
+    ASSERT_EQ(1, NumTableFilesAtLevel(0));
+
+    // the list is copied verbatim, including the overwritten version
+    TablePropertiesCollection props;
+    ASSERT_OK(db_->GetPropertiesOfAllTables(&props));
+    ASSERT_EQ(1u, props.size());
+    ASSERT_EQ(4u, props.begin()->second->num_entries);
+
+    std::vector<LiveFileMetaData> files;
+    db_->GetLiveFilesMetaData(&files);
+    ASSERT_EQ(1u, files.size());
+    ASSERT_EQ("a", files[0].smallestkey);
+    ASSERT_EQ("c", files[0].largestkey);
+
+    ASSERT_EQ("v2", Get("a"));
+    ASSERT_EQ("v1", Get("b"));
+    ASSERT_EQ("NOT_FOUND", Get("c"));
+    Reopen(options);
+    ASSERT_EQ("v2", Get("a"));
+    ASSERT_EQ("v1", Get("b"));
+  }
+}
+
+TEST_F(DBMemTableTest, PartitionedRep) {
+  for (bool hash_rep : {false, true}) {
+    Options options = CurrentOptions();
+    options.create_if_missing = true;
+    options.allow_concurrent_memtable_write = true;
+    std::shared_ptr<MemTableRepFactory> rep;
+    if (hash_rep) {
+      rep.reset(NewHashLinkListRepFactory(64));
+      options.prefix_extractor.reset(NewFixedPrefixTransform(3));
+    } else {
+      rep = std::make_shared<VectorRepFactory>();
+    }
+    ASSERT_FALSE(rep->IsInsertConcurrentlySupported());
+    options.memtable_factory.reset(new PartitionedRepFactory(rep, 4));
+    ASSERT_TRUE(options.memtable_factory->IsInsertConcurrentlySupported());
+    DestroyAndReopen(options);
+
+    // writers of one write group insert into the partitions concurrently
+    const int kThreads = 4;
+    const int kKeysPerThread = 300;
+    std::vector<port::Thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+      threads.emplace_back([&, t]() {
+        for (int i = 0; i < kKeysPerThread; ++i) {
+          char key[16];
+          snprintf(key, sizeof(key), "key%05d", i * kThreads + t);
+          ASSERT_OK(Put(key, std::string(key) + "_v1"));
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    const Snapshot* snapshot = db_->GetSnapshot();
+    ASSERT_OK(Put("key00001", "v2"));
+    ASSERT_OK(Delete("key00002"));
+    ASSERT_EQ("v2", Get("key00001"));
+    ASSERT_EQ("NOT_FOUND", Get("key00002"));
+    ASSERT_EQ("key00002_v1", Get("key00002", snapshot));
+    db_->ReleaseSnapshot(snapshot);
+
+    std::map<std::string, std::string> expected;
+    for (int i = 0; i < kThreads * kKeysPerThread; ++i) {
+      char key[16];
+      snprintf(key, sizeof(key), "key%05d", i);
+      expected[key] = std::string(key) + "_v1";
+    }
+    expected["key00001"] = "v2";
+    expected.erase("key00002");
+
+    auto verify = [&]() {
+      for (auto& kv : expected) {
+        ASSERT_EQ(kv.second, Get(kv.first));
+      }
+      ReadOptions ro;
+      ro.total_order_seek = true;
+      std::unique_ptr<Iterator> iter(db_->NewIterator(ro));
+      auto it = expected.begin();
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++it) {
+        ASSERT_TRUE(it != expected.end());
+        ASSERT_EQ(it->first, iter->key().ToString());
+        ASSERT_EQ(it->second, iter->value().ToString());
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_TRUE(it == expected.end());
+      auto rit = expected.rbegin();
+      for (iter->SeekToLast(); iter->Valid(); iter->Prev(), ++rit) {
+        ASSERT_TRUE(rit != expected.rend());
+        ASSERT_EQ(rit->first, iter->key().ToString());
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_TRUE(rit == expected.rend());
+      // change direction in the middle of the merged partitions
+      iter->Seek("key00500");
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ("key00500", iter->key().ToString());
+      iter->Prev();
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ("key00499", iter->key().ToString());
+      iter->Next();
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ("key00500", iter->key().ToString());
+      iter->SeekForPrev("key00002");
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ("key00001", iter->key().ToString());
+      iter->Next();
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ("key00003", iter->key().ToString());
+    };
+    verify();
+    ASSERT_OK(Flush());
+    verify();
+    Reopen(options);
+    verify();
+  }
+}
+
+TEST_F(DBMemTableTest, PartitionedRepSinglePartition) {
+  // A single partition is the sub-rep itself, without a partition lock
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.allow_concurrent_memtable_write = true;
+  auto rep = std::make_shared<VectorRepFactory>();
+  options.memtable_factory.reset(new PartitionedRepFactory(rep, 1));
+  ASSERT_FALSE(options.memtable_factory->IsInsertConcurrentlySupported());
+  Destroy(options);
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+
+  options.memtable_factory.reset(
+      new PartitionedRepFactory(std::make_shared<SkipListFactory>(), 1));
+  ASSERT_TRUE(options.memtable_factory->IsInsertConcurrentlySupported());
+  ASSERT_OK(TryReopen(options));
+  ASSERT_OK(Put("key", "value"));
+  ASSERT_EQ("value", Get("key"));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
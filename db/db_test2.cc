@@ -5639,6 +5639,103 @@ TEST_F(DBTest2, RowCacheSnapshot) {
   db_->ReleaseSnapshot(s3);
 }
 
+TEST_F(DBTest2, GetResultCache) {
+  Options options = CurrentOptions();
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  options.get_result_cache = NewLRUCache(8 * 8192);
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  DestroyAndReopen(options);
+
+  auto hits = [&]() {
+    return TestGetTickerCount(options, GET_RESULT_CACHE_HIT);
+  };
+  auto misses = [&]() {
+    return TestGetTickerCount(options, GET_RESULT_CACHE_MISS);
+  };
+
+  ASSERT_OK(Put("foo", "bar1"));
+  ASSERT_EQ(Get("foo"), "bar1");
+  ASSERT_EQ(hits(), 0);
+  ASSERT_EQ(misses(), 1);
+  ASSERT_EQ(Get("foo"), "bar1");
+  ASSERT_EQ(hits(), 1);
+
+  // Flushes and compactions do not change the result
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(Get("foo"), "bar1");
+  ASSERT_EQ(hits(), 2);
+
+  // Writes do, as well as not found keys
+  ASSERT_OK(Put("foo", "bar2"));
+  ASSERT_EQ(Get("foo"), "bar2");
+  ASSERT_EQ(hits(), 2);
+  ASSERT_EQ(misses(), 2);
+  ASSERT_OK(Merge("foo", "bar3"));
+  ASSERT_EQ(Get("foo"), "bar2,bar3");
+  ASSERT_EQ(Get("foo"), "bar2,bar3");
+  ASSERT_EQ(hits(), 3);
+  ASSERT_OK(Delete("foo"));
+  ASSERT_EQ(Get("foo"), "NOT_FOUND");
+  ASSERT_EQ(Get("foo"), "NOT_FOUND");
+  ASSERT_EQ(hits(), 4);
+  ASSERT_EQ(misses(), 4);
+
+  // Snapshot reads go around the cache
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(Put("foo", "bar4"));
+  ASSERT_EQ(Get("foo", snapshot), "NOT_FOUND");
+  ASSERT_EQ(Get("foo"), "bar4");
+  ASSERT_EQ(Get("foo"), "bar4");
+  ASSERT_EQ(hits(), 5);
+  ASSERT_EQ(misses(), 5);
+  db_->ReleaseSnapshot(snapshot);
+
+  // A range deletion invalidates every key
+  ASSERT_OK(Put("baz", "qux"));
+  ASSERT_EQ(Get("baz"), "qux");
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             "a", "b"));
+  ASSERT_EQ(Get("baz"), "NOT_FOUND");
+  ASSERT_EQ(Get("foo"), "bar4");
+  ASSERT_EQ(hits(), 5);
+  ASSERT_EQ(misses(), 8);
+
+  // Not used with a compaction filter
+  options.compaction_filter_factory =
+      std::make_shared<test::ChanglingCompactionFilterFactory>("keep");
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  Reopen(options);
+  ASSERT_EQ(Get("foo"), "bar4");
+  ASSERT_EQ(Get("foo"), "bar4");
+  ASSERT_EQ(TestGetTickerCount(options, GET_RESULT_CACHE_HIT), 0);
+  ASSERT_EQ(TestGetTickerCount(options, GET_RESULT_CACHE_MISS), 0);
+}
+
+TEST_F(DBTest2, GetResultCacheDeleteFile) {
+  Options options = CurrentOptions();
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  options.get_result_cache = NewLRUCache(8 * 8192);
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("foo", "bar"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(Get("foo"), "bar");
+  ASSERT_EQ(Get("foo"), "bar");
+  ASSERT_EQ(TestGetTickerCount(options, GET_RESULT_CACHE_HIT), 1);
+
+  // Deleting the file serving a cached result invalidates it
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(1, files.size());
+  ASSERT_OK(db_->DeleteFile(files[0].name));
+  ASSERT_EQ(Get("foo"), "NOT_FOUND");
+  ASSERT_EQ(TestGetTickerCount(options, GET_RESULT_CACHE_HIT), 1);
+  ASSERT_EQ(TestGetTickerCount(options, GET_RESULT_CACHE_MISS), 2);
+}
+
 // When DB is reopened with multiple column families, the manifest file
 // is written after the first CF is flushed, and it is written again
 // after each flush. If DB crashes between the flushes, the flushed CF
@@ -16,6 +16,7 @@
 #include "test_util/sync_point.h"
 #include "utilities/fault_injection_env.h"
 #include "utilities/fault_injection_fs.h"
+#include "utilities/merge_operators.h"
 
 namespace ROCKSDB_NAMESPACE {
 class DBWALTestBase : public DBTestBase {
@@ -1176,6 +1177,91 @@ TEST_F(DBWALTest, RecoverWithLargeLog) {
   } while (ChangeWalOptions());
 }
 
+TEST_F(DBWALTest, RecoverWithParallelReplay) {
+  Options options = CurrentOptions();
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  // Batches of point writes, with a merge or a range deletion now and then
+  // that the replay has to apply in order
+  std::map<std::string, std::string> expected[2];
+  Random rnd(301);
+  for (int i = 0; i < 3000; ++i) {
+    WriteBatch batch;
+    for (int j = 0; j < 4; ++j) {
+      const int cf = static_cast<int>(rnd.Uniform(2));
+      const std::string key = Key(static_cast<int>(rnd.Uniform(1000)));
+      if (rnd.OneIn(5)) {
+        ASSERT_OK(batch.Delete(handles_[cf], key));
+        expected[cf].erase(key);
+      } else {
+        const std::string value = rnd.RandomString(100);
+        ASSERT_OK(batch.Put(handles_[cf], key, value));
+        expected[cf][key] = value;
+      }
+    }
+    if (i % 97 == 0) {
+      const std::string key = Key(static_cast<int>(rnd.Uniform(1000)));
+      ASSERT_OK(batch.Merge(handles_[1], key, "m"));
+      auto it = expected[1].find(key);
+      if (it == expected[1].end()) {
+        expected[1][key] = "m";
+      } else {
+        it->second += ",m";
+      }
+    } else if (i % 211 == 0) {
+      const int begin = static_cast<int>(rnd.Uniform(990));
+      ASSERT_OK(batch.DeleteRange(handles_[0], Key(begin), Key(begin + 10)));
+      expected[0].erase(expected[0].lower_bound(Key(begin)),
+                        expected[0].lower_bound(Key(begin + 10)));
+    }
+    ASSERT_OK(db_->Write(WriteOptions(), &batch));
+  }
+  ASSERT_EQ(NumTableFilesAtLevel(0, 0), 0);
+  ASSERT_EQ(NumTableFilesAtLevel(0, 1), 0);
+
+  int num_groups = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::ParallelWalReplay::InsertGroup",
+      [&](void* /*arg*/) { ++num_groups; });
+  // A memtable grows past the write buffer by at most a group and a batch
+  uint64_t max_flushed_data_size = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::ParallelWalReplay::ScheduleFlush", [&](void* arg) {
+        max_flushed_data_size =
+            std::max(max_flushed_data_size,
+                     static_cast<MemTable*>(arg)->get_data_size());
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // A small write buffer makes the replay flush in the middle of the WAL
+  options.write_buffer_size = 128 << 10;
+  options.disable_auto_compactions = true;
+  options.wal_recovery_threads = 4;
+  ReopenWithColumnFamilies({"default", "pikachu"}, options);
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  ASSERT_GT(num_groups, 1);
+  ASSERT_GT(max_flushed_data_size, 0);
+  ASSERT_LE(max_flushed_data_size, options.write_buffer_size +
+                                       options.write_buffer_size / 8 + 1024);
+  ASSERT_GT(NumTableFilesAtLevel(0, 0), 1);
+  ASSERT_GT(NumTableFilesAtLevel(0, 1), 1);
+  for (int cf = 0; cf < 2; ++cf) {
+    std::unique_ptr<Iterator> iter(
+        db_->NewIterator(ReadOptions(), handles_[cf]));
+    auto expected_it = expected[cf].begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++expected_it) {
+      ASSERT_NE(expected_it, expected[cf].end());
+      ASSERT_EQ(expected_it->first, iter->key().ToString());
+      ASSERT_EQ(expected_it->second, iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(expected_it, expected[cf].end());
+  }
+}
+
 // In https://reviews.facebook.net/D20661 we change
 // recovery behavior: previously for each log file each column family
 // memtable was flushed, even it was empty. Now it's changed:
@@ -780,6 +780,65 @@ TEST_P(DBWriteTest, ConcurrentlyDisabledWAL) {
   ASSERT_LE(bytes_num, 1024 * 100);
 }
 
+TEST_P(DBWriteTest, WalGatherWrite) {
+  Options options = GetOptions();
+  options.enable_wal_gather_write = true;
+  Reopen(options);
+  constexpr int kNumThreads = 8;
+  constexpr int kNumWrites = 200;
+  // Every gathered batch is seen at the log_entry sync point
+  std::atomic<int> log_entries{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::WriteToWAL:log_entry",
+      [&](void* /*arg*/) { log_entries.fetch_add(1); });
+  SyncPoint::GetInstance()->EnableProcessing();
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([t, this] {
+      for (int i = 0; i < kNumWrites; i++) {
+        WriteBatch batch;
+        for (int j = 0; j <= i % 4; j++) {
+          std::string key = "key" + std::to_string(t) + "_" +
+                            std::to_string(i) + "_" + std::to_string(j);
+          ASSERT_OK(batch.Put(key, "value" + key));
+        }
+        ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+      }
+    });
+  }
+  // Only the part before the termination point goes to the WAL
+  WriteBatch batch;
+  ASSERT_OK(batch.Put("wal", "1"));
+  batch.MarkWalTerminationPoint();
+  ASSERT_OK(batch.Put("memtable_only", "1"));
+  ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_EQ("1", Get("memtable_only"));
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  if (options.two_write_queues) {
+    // Gathering is off, so each merged group is one entry
+    ASSERT_GT(log_entries.load(), 0);
+  } else {
+    ASSERT_EQ(kNumThreads * kNumWrites + 1, log_entries.load());
+  }
+
+  Reopen(options);
+  for (int t = 0; t < kNumThreads; t++) {
+    for (int i = 0; i < kNumWrites; i++) {
+      for (int j = 0; j <= i % 4; j++) {
+        std::string key = "key" + std::to_string(t) + "_" + std::to_string(i) +
+                          "_" + std::to_string(j);
+        ASSERT_EQ("value" + key, Get(key));
+      }
+    }
+  }
+  ASSERT_EQ("1", Get("wal"));
+  ASSERT_EQ("NOT_FOUND", Get("memtable_only"));
+}
+
 INSTANTIATE_TEST_CASE_P(DBWriteTestInstance, DBWriteTest,
                         testing::Values(DBTestBase::kDefault,
                                         DBTestBase::kConcurrentWALWrites,
@@ -0,0 +1,97 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/get_result_cache.h"
+
+#include "cache/typed_cache.h"
+#include "util/coding.h"
+#include "util/hash.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+using ResultCacheInterface =
+    BasicTypedCacheInterface<std::string, CacheEntryRole::kMisc>;
+
+// Sequence number and found flag
+constexpr size_t kEntryHeaderSize = sizeof(uint64_t) + 1;
+}  // namespace
+
+GetResultCacheStripes::GetResultCacheStripes() {
+  for (auto& stripe : stripes_) {
+    stripe.store(0, std::memory_order_relaxed);
+  }
+  all_.store(0, std::memory_order_relaxed);
+}
+
+size_t GetResultCacheStripes::StripeOf(const Slice& user_key) {
+  return GetSliceHash(user_key) % kNumStripes;
+}
+
+GetResultCache::GetResultCache(std::shared_ptr<Cache> cache)
+    : cache_(std::move(cache)) {
+  PutVarint64(&cache_id_, cache_->NewId());
+}
+
+void GetResultCache::SetKey(uint32_t cf_id, const Slice& user_key,
+                            std::string* key) const {
+  key->reserve(cache_id_.size() + 5 + user_key.size());
+  key->assign(cache_id_);
+  PutVarint32(key, cf_id);
+  key->append(user_key.data(), user_key.size());
+}
+
+bool GetResultCache::Lookup(uint32_t cf_id,
+                            const GetResultCacheStripes& stripes,
+                            const Slice& user_key, PinnableSlice* value,
+                            Status* s) {
+  std::string key;
+  SetKey(cf_id, user_key, &key);
+  ResultCacheInterface cache{cache_.get()};
+  auto handle = cache.Lookup(key);
+  if (handle == nullptr) {
+    return false;
+  }
+  const std::string& entry = *cache.Value(handle);
+  assert(entry.size() >= kEntryHeaderSize);
+  if (!stripes.IsValid(user_key, DecodeFixed64(entry.data()))) {
+    cache.Release(handle);
+    return false;
+  }
+  if (entry[sizeof(uint64_t)] != 0) {
+    value->Reset();
+    value->PinSlice(Slice(entry.data() + kEntryHeaderSize,
+                          entry.size() - kEntryHeaderSize),
+                    nullptr);
+    cache.RegisterReleaseAsCleanup(handle, *value);
+    *s = Status::OK();
+  } else {
+    cache.Release(handle);
+    *s = Status::NotFound();
+  }
+  return true;
+}
+
+void GetResultCache::Insert(uint32_t cf_id, const Slice& user_key,
+                            SequenceNumber seq, const Status& s,
+                            const Slice& value) {
+  assert(s.ok() || s.IsNotFound());
+  std::string key;
+  SetKey(cf_id, user_key, &key);
+  auto entry = new std::string();
+  entry->reserve(kEntryHeaderSize + (s.ok() ? value.size() : 0));
+  PutFixed64(entry, seq);
+  entry->push_back(s.ok() ? 1 : 0);
+  if (s.ok()) {
+    entry->append(value.data(), value.size());
+  }
+  size_t charge = entry->capacity() + sizeof(std::string);
+  ResultCacheInterface cache{cache_.get()};
+  // If the cache is full, it's OK to continue.
+  cache.Insert(key, entry, charge).PermitUncheckedError();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
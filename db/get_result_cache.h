@@ -0,0 +1,88 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "rocksdb/advanced_cache.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "rocksdb/types.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// The versions validating the DBOptions::get_result_cache entries of a column
+// family. Each stripe holds the largest sequence number written to any of the
+// user keys hashing to it, and all_ the largest sequence number of a change
+// to the whole column family (DeleteRange, file ingestion or deletion). A
+// result read at sequence number seq is still the latest if neither its
+// stripe nor all_ went past seq.
+//
+// The write path records a write before publishing its sequence number, so a
+// reader not seeing it in the stripe cannot have seen it published.
+class GetResultCacheStripes {
+ public:
+  GetResultCacheStripes();
+
+  void RecordWrite(const Slice& user_key, SequenceNumber seq) {
+    Advance(&stripes_[StripeOf(user_key)], seq);
+  }
+
+  void RecordWriteAll(SequenceNumber seq) { Advance(&all_, seq); }
+
+  bool IsValid(const Slice& user_key, SequenceNumber seq) const {
+    return stripes_[StripeOf(user_key)].load(std::memory_order_acquire) <=
+               seq &&
+           all_.load(std::memory_order_acquire) <= seq;
+  }
+
+ private:
+  static constexpr size_t kNumStripes = 1024;
+
+  static size_t StripeOf(const Slice& user_key);
+
+  static void Advance(std::atomic<SequenceNumber>* version,
+                      SequenceNumber seq) {
+    SequenceNumber cur = version->load(std::memory_order_relaxed);
+    while (cur < seq &&
+           !version->compare_exchange_weak(cur, seq,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+    }
+  }
+
+  std::atomic<SequenceNumber> stripes_[kNumStripes];
+  std::atomic<SequenceNumber> all_;
+};
+
+// DBOptions::get_result_cache as used by DBImpl::GetImpl. An entry, keyed by
+// column family id and user key, is the sequence number it was read at and
+// whether the key was found, followed by the value.
+class GetResultCache {
+ public:
+  explicit GetResultCache(std::shared_ptr<Cache> cache);
+
+  // Returns true, with the value (pinned in the cache) or NotFound in *s, if
+  // the cached result of user_key is still the latest.
+  bool Lookup(uint32_t cf_id, const GetResultCacheStripes& stripes,
+              const Slice& user_key, PinnableSlice* value, Status* s);
+
+  // Caches the result of reading user_key at seq, which is either s.ok()
+  // with value or s.IsNotFound().
+  void Insert(uint32_t cf_id, const Slice& user_key, SequenceNumber seq,
+              const Status& s, const Slice& value);
+
+ private:
+  void SetKey(uint32_t cf_id, const Slice& user_key, std::string* key) const;
+
+  std::shared_ptr<Cache> cache_;
+  std::string cache_id_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -341,6 +341,8 @@ static const std::string estimate_oldest_key_time = "estimate-oldest-key-time";
 static const std::string block_cache_capacity = "block-cache-capacity";
 static const std::string block_cache_usage = "block-cache-usage";
 static const std::string block_cache_pinned_usage = "block-cache-pinned-usage";
+static const std::string block_cache_miss_ratio_curve =
+    "block-cache-miss-ratio-curve";
 static const std::string options_statistics = "options-statistics";
 static const std::string num_blob_files = "num-blob-files";
 static const std::string blob_stats = "blob-stats";
@@ -448,6 +450,8 @@ const std::string DB::Properties::kBlockCacheUsage =
     rocksdb_prefix + block_cache_usage;
 const std::string DB::Properties::kBlockCachePinnedUsage =
     rocksdb_prefix + block_cache_pinned_usage;
+const std::string DB::Properties::kBlockCacheMissRatioCurve =
+    rocksdb_prefix + block_cache_miss_ratio_curve;
 const std::string DB::Properties::kOptionsStatistics =
     rocksdb_prefix + options_statistics;
 const std::string DB::Properties::kLiveSstFilesSizeAtTemperature =
@@ -630,6 +634,9 @@ const UnorderedMap<std::string, DBPropertyInfo>
         {DB::Properties::kBlockCachePinnedUsage,
          {false, nullptr, &InternalStats::HandleBlockCachePinnedUsage, nullptr,
           nullptr}},
+        {DB::Properties::kBlockCacheMissRatioCurve,
+         {true, &InternalStats::HandleBlockCacheMissRatioCurve, nullptr,
+          &InternalStats::HandleBlockCacheMissRatioCurveMap, nullptr}},
         {DB::Properties::kOptionsStatistics,
          {true, nullptr, nullptr, nullptr,
           &DBImpl::GetPropertyHandleOptionsStatistics}},
@@ -1568,6 +1575,55 @@ bool InternalStats::HandleBlockCachePinnedUsage(uint64_t* value, DBImpl* /*db*/,
   return false;
 }
 
+bool InternalStats::GetBlockCacheMissRatioCurve(
+    std::vector<size_t>* capacities, std::vector<double>* hit_ratios) {
+  Cache* block_cache = GetBlockCacheForStats();
+  if (!block_cache) {
+    return false;
+  }
+  // Around the current capacity, in eighths
+  static const int kEighths[] = {1, 2, 4, 6, 8, 12, 16, 32, 64};
+  size_t capacity = block_cache->GetCapacity();
+  capacities->clear();
+  for (int eighths : kEighths) {
+    capacities->push_back(capacity / 8 * eighths);
+  }
+  return block_cache->EstimateHitRatios(*capacities, hit_ratios);
+}
+
+bool InternalStats::HandleBlockCacheMissRatioCurve(std::string* value,
+                                                   Slice /*suffix*/) {
+  std::vector<size_t> capacities;
+  std::vector<double> hit_ratios;
+  if (!GetBlockCacheMissRatioCurve(&capacities, &hit_ratios)) {
+    return false;
+  }
+  std::ostringstream str;
+  str << "Estimated block cache hit ratio(capacity,hit%):";
+  for (size_t i = 0; i < capacities.size(); ++i) {
+    str << " (" << BytesToHumanString(capacities[i]) << ","
+        << (100.0 * hit_ratios[i]) << "%)";
+  }
+  str << "\n";
+  *value = str.str();
+  return true;
+}
+
+bool InternalStats::HandleBlockCacheMissRatioCurveMap(
+    std::map<std::string, std::string>* values, Slice /*suffix*/) {
+  std::vector<size_t> capacities;
+  std::vector<double> hit_ratios;
+  if (!GetBlockCacheMissRatioCurve(&capacities, &hit_ratios)) {
+    return false;
+  }
+  values->clear();
+  for (size_t i = 0; i < capacities.size(); ++i) {
+    // Capacity in bytes -> estimated hit ratio
+    (*values)[std::to_string(capacities[i])] = std::to_string(hit_ratios[i]);
+  }
+  return true;
+}
+
 void InternalStats::DumpDBMapStats(
     std::map<std::string, std::string>* db_stats) {
   for (int i = 0; i < static_cast<int>(kIntStatsNumMax); ++i) {
@@ -840,6 +840,11 @@ class InternalStats {
   bool HandleBlockCacheUsage(uint64_t* value, DBImpl* db, Version* version);
   bool HandleBlockCachePinnedUsage(uint64_t* value, DBImpl* db,
                                    Version* version);
+  bool GetBlockCacheMissRatioCurve(std::vector<size_t>* capacities,
+                                   std::vector<double>* hit_ratios);
+  bool HandleBlockCacheMissRatioCurve(std::string* value, Slice suffix);
+  bool HandleBlockCacheMissRatioCurveMap(
+      std::map<std::string, std::string>* values, Slice suffix);
   bool HandleBlockCacheEntryStatsInternal(std::string* value, bool fast);
   bool HandleBlockCacheEntryStatsMapInternal(
       std::map<std::string, std::string>* values, bool fast);
@@ -349,6 +349,38 @@ TEST_P(LogTest, Fragmentation) {
   ASSERT_EQ("EOF", Read());
 }
 
+TEST_P(LogTest, GatheredRecord) {
+  Random rnd(301);
+  std::vector<std::string> records;
+  for (int i = 0; i < 50; ++i) {
+    // cut each record into parts, some of them empty, some spanning blocks
+    std::string record = rnd.RandomString(static_cast<int>(
+        rnd.OneIn(10) ? rnd.Uniform(3 * kBlockSize) : rnd.Uniform(1000)));
+    std::vector<Slice> parts;
+    std::vector<uint32_t> part_crcs;
+    for (size_t pos = 0; pos < record.size() || parts.empty();) {
+      size_t len = std::min<size_t>(record.size() - pos,
+                                    rnd.OneIn(5) ? 0 : rnd.Skewed(16));
+      parts.emplace_back(record.data() + pos, len);
+      part_crcs.push_back(crc32c::Value(record.data() + pos, len));
+      pos += len;
+    }
+    ASSERT_OK(writer_->AddRecord(parts.data(),
+                                 i % 2 ? part_crcs.data() : nullptr,
+                                 parts.size()));
+    records.push_back(std::move(record));
+    if (i % 7 == 0) {
+      Write("plain");
+      records.push_back("plain");
+    }
+  }
+  for (auto& record : records) {
+    ASSERT_EQ(record, Read());
+  }
+  ASSERT_EQ("EOF", Read());
+  ASSERT_EQ(0U, DroppedBytes());
+}
+
 TEST_P(LogTest, MarginalTrailer) {
   // Make a trailer that is exactly the same length as an empty record.
   int header_size =
@@ -11,6 +11,9 @@
 
 #include <stdint.h>
 
+#include <algorithm>
+#include <string>
+
 #include "file/writable_file_writer.h"
 #include "rocksdb/env.h"
 #include "rocksdb/io_status.h"
@@ -159,6 +162,102 @@ IOStatus Writer::AddRecord(const Slice& slice,
   return s;
 }
 
+IOStatus Writer::AddRecord(const Slice* parts, const uint32_t* part_crcs,
+                           size_t num_parts,
+                           Env::IOPriority rate_limiter_priority) {
+  if (compress_) {
+    // The compressor needs the record in one piece
+    std::string record;
+    for (size_t i = 0; i < num_parts; ++i) {
+      record.append(parts[i].data(), parts[i].size());
+    }
+    return AddRecord(Slice(record), rate_limiter_priority);
+  }
+  size_t left = 0;
+  for (size_t i = 0; i < num_parts; ++i) {
+    left += parts[i].size();
+  }
+
+  const int header_size =
+      recycle_log_files_ ? kRecyclableHeaderSize : kHeaderSize;
+
+  // Current position in parts
+  size_t part = 0;
+  size_t part_offset = 0;
+  bool begin = true;
+  IOStatus s;
+  do {
+    const int64_t leftover = kBlockSize - block_offset_;
+    assert(leftover >= 0);
+    if (leftover < header_size) {
+      // Switch to a new block
+      if (leftover > 0) {
+        assert(header_size <= 11);
+        s = dest_->Append(Slice("\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00",
+                                static_cast<size_t>(leftover)),
+                          0 /* crc32c_checksum */, rate_limiter_priority);
+        if (!s.ok()) {
+          break;
+        }
+      }
+      block_offset_ = 0;
+    }
+    assert(static_cast<int64_t>(kBlockSize - block_offset_) >= header_size);
+
+    const size_t avail = kBlockSize - block_offset_ - header_size;
+    const size_t fragment_length = (left < avail) ? left : avail;
+
+    RecordType type;
+    const bool end = (left == fragment_length);
+    if (begin && end) {
+      type = recycle_log_files_ ? kRecyclableFullType : kFullType;
+    } else if (begin) {
+      type = recycle_log_files_ ? kRecyclableFirstType : kFirstType;
+    } else if (end) {
+      type = recycle_log_files_ ? kRecyclableLastType : kLastType;
+    } else {
+      type = recycle_log_files_ ? kRecyclableMiddleType : kMiddleType;
+    }
+
+    // Cut the parts covered by this fragment
+    fragment_parts_.clear();
+    fragment_crcs_.clear();
+    for (size_t need = fragment_length; need > 0;) {
+      assert(part < num_parts);
+      const Slice& p = parts[part];
+      const size_t len = std::min(p.size() - part_offset, need);
+      if (len > 0) {
+        fragment_parts_.emplace_back(p.data() + part_offset, len);
+        if (part_crcs != nullptr && len == p.size()) {
+          fragment_crcs_.push_back(part_crcs[part]);
+        } else {
+          fragment_crcs_.push_back(crc32c::Value(p.data() + part_offset, len));
+        }
+      }
+      part_offset += len;
+      need -= len;
+      if (part_offset == p.size()) {
+        ++part;
+        part_offset = 0;
+      }
+    }
+
+    s = EmitPhysicalRecord(type, fragment_parts_.data(), fragment_crcs_.data(),
+                           fragment_parts_.size(), fragment_length,
+                           rate_limiter_priority);
+    left -= fragment_length;
+    begin = false;
+  } while (s.ok() && left > 0);
+
+  if (s.ok()) {
+    if (!manual_flush_) {
+      s = dest_->Flush(rate_limiter_priority);
+    }
+  }
+
+  return s;
+}
+
 IOStatus Writer::AddCompressionTypeRecord() {
   // Should be the first record
   assert(block_offset_ == 0);
@@ -227,6 +326,15 @@ bool Writer::BufferIsEmpty() { return dest_->BufferIsEmpty(); }
 
 IOStatus Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n,
                                     Env::IOPriority rate_limiter_priority) {
+  Slice part(ptr, n);
+  uint32_t part_crc = crc32c::Value(ptr, n);
+  return EmitPhysicalRecord(t, &part, &part_crc, 1, n, rate_limiter_priority);
+}
+
+IOStatus Writer::EmitPhysicalRecord(RecordType t, const Slice* parts,
+                                    const uint32_t* part_crcs,
+                                    size_t num_parts, size_t n,
+                                    Env::IOPriority rate_limiter_priority) {
   assert(n <= 0xffff);  // Must fit in two bytes
 
   size_t header_size;
@@ -258,7 +366,11 @@ IOStatus Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n,
   }
 
   // Compute the crc of the record type and the payload.
-  uint32_t payload_crc = crc32c::Value(ptr, n);
+  uint32_t payload_crc = num_parts > 0 ? part_crcs[0] : 0;
+  for (size_t i = 1; i < num_parts; ++i) {
+    payload_crc =
+        crc32c::Crc32cCombine(payload_crc, part_crcs[i], parts[i].size());
+  }
   crc = crc32c::Crc32cCombine(crc, payload_crc, n);
   crc = crc32c::Mask(crc);  // Adjust for storage
   TEST_SYNC_POINT_CALLBACK("LogWriter::EmitPhysicalRecord:BeforeEncodeChecksum",
@@ -268,8 +380,8 @@ IOStatus Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n,
   // Write the header and the payload
   IOStatus s = dest_->Append(Slice(buf, header_size), 0 /* crc32c_checksum */,
                              rate_limiter_priority);
-  if (s.ok()) {
-    s = dest_->Append(Slice(ptr, n), payload_crc, rate_limiter_priority);
+  for (size_t i = 0; s.ok() && i < num_parts; ++i) {
+    s = dest_->Append(parts[i], part_crcs[i], rate_limiter_priority);
   }
   block_offset_ += header_size + n;
   return s;
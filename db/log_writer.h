@@ -88,6 +88,15 @@ class Writer {
 
   IOStatus AddRecord(const Slice& slice,
                      Env::IOPriority rate_limiter_priority = Env::IO_TOTAL);
+
+  // Adds one record made of the concatenation of parts[0, num_parts),
+  // without copying them into a contiguous buffer first. If part_crcs is not
+  // nullptr, part_crcs[i] must be crc32c::Value() of parts[i], and is used
+  // instead of reading parts[i] again for the checksums of physical records
+  // covering the whole part.
+  IOStatus AddRecord(const Slice* parts, const uint32_t* part_crcs,
+                     size_t num_parts,
+                     Env::IOPriority rate_limiter_priority = Env::IO_TOTAL);
   IOStatus AddCompressionTypeRecord();
 
   // If there are column families in `cf_to_ts_sz` not included in
@@ -121,10 +130,21 @@ class Writer {
   // record type stored in the header.
   uint32_t type_crc_[kMaxRecordType + 1];
 
+  // Reused by AddRecord(parts) for the parts of a physical record
+  std::vector<Slice> fragment_parts_;
+  std::vector<uint32_t> fragment_crcs_;
+
   IOStatus EmitPhysicalRecord(
       RecordType type, const char* ptr, size_t length,
       Env::IOPriority rate_limiter_priority = Env::IO_TOTAL);
 
+  // Emits a physical record whose payload is parts[0, num_parts) with
+  // crc32c part_crcs[0, num_parts), of length bytes in total
+  IOStatus EmitPhysicalRecord(RecordType type, const Slice* parts,
+                              const uint32_t* part_crcs, size_t num_parts,
+                              size_t length,
+                              Env::IOPriority rate_limiter_priority);
+
   // If true, it does not flush after each write. Instead it relies on the upper
   // layer to manually does the flush by calling ::WriteBuffer()
   bool manual_flush_;
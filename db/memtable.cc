@@ -82,7 +82,12 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
                write_buffer_manager->cost_to_cache()))
                  ? &mem_tracker_
                  : nullptr,
-             mutable_cf_options.memtable_huge_page_size),
+             mutable_cf_options.memtable_huge_page_size,
+             mutable_cf_options.memtable_numa_aware,
+             write_buffer_manager != nullptr
+                 ? write_buffer_manager->arena_block_pool()
+                 : nullptr,
+             mutable_cf_options.memtable_transparent_huge_page),
       table_(ioptions.memtable_factory->CreateMemTableRep(
           ioptions.cf_paths[0].path, // level0_dir
           mutable_cf_options,
@@ -234,6 +239,21 @@ bool MemTable::ShouldFlushNow() {
   return arena_.AllocatedAndUnused() < kArenaBlockSize / 4;
 }
 
+void MemTable::RecordArenaStats() {
+  if (moptions_.statistics == nullptr ||
+      moptions_.memtable_huge_page_size == 0) {
+    return;
+  }
+  ArenaHugePageStats stats = arena_.GetHugePageStats();
+  RecordTick(moptions_.statistics, MEMTABLE_HUGE_PAGE_BLOCKS_REUSED,
+             stats.blocks_reused);
+  RecordTick(moptions_.statistics, MEMTABLE_HUGE_PAGE_BLOCKS_MAPPED,
+             stats.blocks_mapped);
+  RecordTick(moptions_.statistics, MEMTABLE_HUGE_PAGE_FALLBACKS,
+             stats.fallbacks);
+  RecordTick(moptions_.statistics, MEMTABLE_HUGE_PAGE_BYTES, stats.bytes);
+}
+
 void MemTable::UpdateFlushState() {
   auto state = flush_state_.load(std::memory_order_relaxed);
   if (state == FLUSH_NOT_REQUESTED && ShouldFlushNow()) {
@@ -338,6 +358,39 @@ KeyHandle MemTableRep::Allocate(const size_t len, char** buf) {
   return static_cast<KeyHandle>(*buf);
 }
 
+void MemTableRep::AllocateBatch(const size_t* lens, size_t num, char** bufs,
+                                KeyHandle* handles) {
+  for (size_t i = 0; i < num; ++i) {
+    handles[i] = Allocate(lens[i], &bufs[i]);
+  }
+}
+
+size_t MemTableRep::InsertKeyBatch(const KeyHandle* handles, size_t num,
+                                   bool* inserted) {
+  size_t count = 0;
+  for (size_t i = 0; i < num; ++i) {
+    bool ok = InsertKey(handles[i]);
+    if (inserted != nullptr) {
+      inserted[i] = ok;
+    }
+    count += ok;
+  }
+  return count;
+}
+
+size_t MemTableRep::InsertKeyBatchConcurrently(const KeyHandle* handles,
+                                               size_t num, bool* inserted) {
+  size_t count = 0;
+  for (size_t i = 0; i < num; ++i) {
+    bool ok = InsertKeyConcurrently(handles[i]);
+    if (inserted != nullptr) {
+      inserted[i] = ok;
+    }
+    count += ok;
+  }
+  return count;
+}
+
 void MemTableRep::Iterator::Seek(const Slice& ikey) { Seek(ikey, nullptr); }
 void MemTableRep::Iterator::SeekForPrev(const Slice& ikey) {
   return SeekForPrev(ikey, nullptr);
@@ -825,6 +878,137 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
   return Status::OK();
 }
 
+Status MemTable::AddSortedRun(SequenceNumber seq, const ValueType* types,
+                              const Slice* keys, const Slice* values,
+                              size_t num, bool allow_concurrent,
+                              MemTablePostProcessInfo* post_process_info) {
+  assert(num > 0 && num <= kMaxSortedRun);
+  assert(CanAddSortedRun());
+  size_t lens[kMaxSortedRun];
+  char* bufs[kMaxSortedRun];
+  KeyHandle handles[kMaxSortedRun];
+  uint64_t data_size = 0;
+  uint64_t raw_key_size = 0;
+  uint64_t raw_value_size = 0;
+  uint64_t num_deletes = 0;
+  for (size_t i = 0; i < num; ++i) {
+    size_t ikey_size = keys[i].size_ + 8;
+    lens[i] = VarintLength(ikey_size) + ikey_size +
+              VarintLength(values[i].size_) + values[i].size_;
+    data_size += lens[i];
+    raw_key_size += ikey_size;
+    raw_value_size += values[i].size_;
+    num_deletes += types[i] != kTypeValue;
+  }
+  table_->AllocateBatch(lens, num, bufs, handles);
+  for (size_t i = 0; i < num; ++i) {
+    assert(types[i] == kTypeValue || types[i] == kTypeDeletion ||
+           types[i] == kTypeDeletionWithTimestamp ||
+           types[i] == kTypeSingleDeletion);
+    char* p = EncodeVarint32(bufs[i], uint32_t(keys[i].size_ + 8));
+    memcpy(p, keys[i].data_, keys[i].size_);
+    p += keys[i].size_;
+    EncodeFixed64(p, PackSequenceAndType(seq + i, types[i]));
+    p = EncodeVarint32(p + 8, uint32_t(values[i].size_));
+    memcpy(p, values[i].data_, values[i].size_);
+  }
+  size_t inserted =
+      allow_concurrent
+          ? table_->InsertKeyBatchConcurrently(handles, num, nullptr)
+          : table_->InsertKeyBatch(handles, num, nullptr);
+  if (UNLIKELY(inserted != num)) {
+    // Sequence numbers are unique, so this is a caller bug
+    assert(false);
+    return Status::Corruption("duplicated key+seq in sorted run");
+  }
+
+  const SequenceNumber last_seq = seq + num - 1;
+  if (!allow_concurrent) {
+    num_entries_.store(num_entries_.load(std::memory_order_relaxed) + num,
+                       std::memory_order_relaxed);
+    data_size_.store(data_size_.load(std::memory_order_relaxed) + data_size,
+                     std::memory_order_relaxed);
+    raw_key_size_.store(raw_key_size_.load(std::memory_order_relaxed) +
+                            raw_key_size,
+                        std::memory_order_relaxed);
+    raw_value_size_.store(raw_value_size_.load(std::memory_order_relaxed) +
+                              raw_value_size,
+                          std::memory_order_relaxed);
+    if (num_deletes) {
+      num_deletes_.store(num_deletes_.load(std::memory_order_relaxed) +
+                             num_deletes,
+                         std::memory_order_relaxed);
+    }
+    if (largest_seqno_.load(std::memory_order_relaxed) < last_seq) {
+      largest_seqno_.store(last_seq, std::memory_order_relaxed);
+    }
+  } else {
+    assert(post_process_info != nullptr);
+    post_process_info->num_entries += num;
+    post_process_info->data_size += data_size;
+    post_process_info->num_deletes += num_deletes;
+    post_process_info->raw_key_size += raw_key_size;
+    post_process_info->raw_value_size += raw_value_size;
+    if (post_process_info->largest_seqno < last_seq) {
+      post_process_info->largest_seqno = last_seq;
+    }
+  }
+
+  if (bloom_filter_) {
+  #if defined(TOPLINGDB_WITH_TIMESTAMP)
+    size_t ts_sz = GetInternalKeyComparator().user_comparator()->timestamp_size();
+  #endif
+    for (size_t i = 0; i < num; ++i) {
+    #if defined(TOPLINGDB_WITH_TIMESTAMP)
+      Slice key_without_ts = StripTimestampFromUserKey(keys[i], ts_sz);
+    #else
+      const Slice& key_without_ts = keys[i];
+    #endif
+      if (prefix_extractor_ && prefix_extractor_->InDomain(key_without_ts)) {
+        Slice prefix = prefix_extractor_->Transform(key_without_ts);
+        if (allow_concurrent) {
+          bloom_filter_->AddConcurrently(prefix);
+        } else {
+          bloom_filter_->Add(prefix);
+        }
+      }
+      if (moptions_.memtable_whole_key_filtering) {
+        if (allow_concurrent) {
+          bloom_filter_->AddConcurrently(key_without_ts);
+        } else {
+          bloom_filter_->Add(key_without_ts);
+        }
+      }
+    }
+  }
+
+  if (!allow_concurrent) {
+    assert(first_seqno_ == 0 || seq >= first_seqno_);
+    if (first_seqno_ == 0) {
+      first_seqno_.store(seq, std::memory_order_relaxed);
+      if (earliest_seqno_ == kMaxSequenceNumber) {
+        earliest_seqno_.store(GetFirstSequenceNumber(),
+                              std::memory_order_relaxed);
+      }
+      assert(first_seqno_.load() >= earliest_seqno_.load());
+    }
+    UpdateFlushState();
+  } else {
+    uint64_t cur_seq_num = first_seqno_.load(std::memory_order_relaxed);
+    while ((cur_seq_num == 0 || seq < cur_seq_num) &&
+           !first_seqno_.compare_exchange_weak(cur_seq_num, seq)) {
+    }
+    uint64_t cur_earliest_seqno =
+        earliest_seqno_.load(std::memory_order_relaxed);
+    while ((cur_earliest_seqno == kMaxSequenceNumber ||
+            seq < cur_earliest_seqno) &&
+           !earliest_seqno_.compare_exchange_weak(cur_earliest_seqno, seq)) {
+    }
+  }
+  UpdateOldestKeyTime();
+  return Status::OK();
+}
+
 // Callback from MemTable::Get()
 namespace {
 
@@ -277,6 +277,32 @@ class MemTable {
              MemTablePostProcessInfo* post_process_info = nullptr,
              void** hint = nullptr);
 
+  // Upper bound of num for AddSortedRun()
+  static constexpr size_t kMaxSortedRun = 256;
+
+  // Whether AddSortedRun() can be used instead of Add(), which is not the
+  // case with insert hints, inplace updates, or reps only implementing
+  // MemTableRep::InsertKeyValue().
+  bool CanAddSortedRun() const {
+    return insert_with_hint_prefix_extractor_ == nullptr &&
+           !moptions_.inplace_update_support &&
+           table_->SupportInsertKeyBatch();
+  }
+
+  // Same as calling Add(seq + i, types[i], keys[i], values[i], nullptr,
+  // allow_concurrent, post_process_info) for i in [0, num), but the entries
+  // are allocated with MemTableRep::AllocateBatch() and inserted with one
+  // MemTableRep::InsertKeyBatch() call.
+  //
+  // REQUIRES: keys are strictly increasing user keys, types are
+  // kTypeValue, kTypeDeletion, kTypeDeletionWithTimestamp or
+  // kTypeSingleDeletion, num <= kMaxSortedRun, CanAddSortedRun(), and the
+  // same synchronization as Add().
+  Status AddSortedRun(SequenceNumber seq, const ValueType* types,
+                      const Slice* keys, const Slice* values, size_t num,
+                      bool allow_concurrent = false,
+                      MemTablePostProcessInfo* post_process_info = nullptr);
+
   // Used to Get value associated with key or Get Merge Operands associated
   // with key.
   // If do_merge = true the default behavior which is Get value for key is
@@ -505,6 +531,7 @@ class MemTable {
   void MarkImmutable() {
     table_->MarkReadOnly();
     mem_tracker_.DoneAllocating();
+    RecordArenaStats();
   }
 
   // Notify the underlying storage that all data it contained has been
@@ -691,6 +718,9 @@ class MemTable {
 
   void UpdateOldestKeyTime();
 
+  // Records the huge page usage of arena_ in statistics
+  void RecordArenaStats();
+
 
   // Always returns non-null and assumes certain pre-checks (e.g.,
   // is_range_del_table_empty_) are done. This is only valid during the lifetime
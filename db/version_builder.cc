@@ -1335,6 +1335,9 @@ class VersionBuilder::Rep {
           file_meta->table_reader_handle = handle;
           // Load table_reader
           file_meta->fd.table_reader = table_cache_->get_cache().Value(handle);
+          if (file_meta->tail_size == 0) {
+            BackfillTailSize(file_meta);
+          }
         }
       }
     });
@@ -1357,6 +1360,28 @@ class VersionBuilder::Rep {
     }
     return ret;
   }
+
+  // Files written before the tail size was recorded in the manifest get it
+  // from their table properties once their table reader is loaded. The file
+  // is not part of any installed version yet, and the tail size is persisted
+  // with the next full write of the manifest, such as the one at DB open, so
+  // that later opens prefetch the tail in one exact-sized read.
+  static void BackfillTailSize(FileMetaData* file_meta) {
+    assert(file_meta->fd.table_reader != nullptr);
+    std::shared_ptr<const TableProperties> props =
+        file_meta->fd.table_reader->GetTableProperties();
+    if (props == nullptr) {
+      return;
+    }
+    const uint64_t file_size = file_meta->fd.GetFileSize();
+    bool contain_no_data_blocks =
+        props->num_entries > 0 &&
+        (props->num_entries == props->num_range_deletions);
+    if ((props->tail_start_offset > 0 || contain_no_data_blocks) &&
+        props->tail_start_offset <= file_size) {
+      file_meta->tail_size = file_size - props->tail_start_offset;
+    }
+  }
 };
 
 VersionBuilder::VersionBuilder(
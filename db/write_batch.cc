@@ -478,6 +478,150 @@ Status ReadRecordFromWriteBatch(Slice* input, char* tag,
   return Status::OK();
 }
 
+namespace {
+
+enum RecordField : uint8_t {
+  kRecordHasColumnFamily = 1,
+  kRecordHasKey = 2,
+  kRecordHasValue = 4,
+  kRecordBadTag = 8,
+};
+
+// Which fields follow the tag of a WriteBatch record, must be kept in sync
+// with ReadRecordFromWriteBatch()
+inline uint8_t RecordFields(char tag) {
+  switch (tag) {
+    case kTypeColumnFamilyValue:
+    case kTypeColumnFamilyRangeDeletion:
+    case kTypeColumnFamilyMerge:
+    case kTypeColumnFamilyBlobIndex:
+    case kTypeColumnFamilyWideColumnEntity:
+      return kRecordHasColumnFamily | kRecordHasKey | kRecordHasValue;
+    case kTypeValue:
+    case kTypeRangeDeletion:
+    case kTypeMerge:
+    case kTypeBlobIndex:
+    case kTypeWideColumnEntity:
+    case kTypeCommitXIDAndTimestamp:
+      return kRecordHasKey | kRecordHasValue;
+    case kTypeColumnFamilyDeletion:
+    case kTypeColumnFamilySingleDeletion:
+      return kRecordHasColumnFamily | kRecordHasKey;
+    case kTypeDeletion:
+    case kTypeSingleDeletion:
+      return kRecordHasKey;
+    case kTypeLogData:
+    case kTypeEndPrepareXID:
+    case kTypeCommitXID:
+    case kTypeRollbackXID:
+      return kRecordHasValue;
+    case kTypeNoop:
+    case kTypeBeginPrepareXID:
+    case kTypeBeginPersistedPrepareXID:
+    case kTypeBeginUnprepareXID:
+      return 0;
+    default:
+      return kRecordBadTag;
+  }
+}
+
+// Decodes a varint32 like GetVarint32Ptr(), but when a whole 8 byte word is
+// readable it locates the terminating byte of the varint with one bit scan
+// over the word instead of testing byte by byte, which avoids the branch
+// mispredictions of mixed 1 and 2 byte lengths in a WriteBatch.
+inline const char* DecodeVarint32Word(const char* p, const char* limit,
+                                      uint32_t* value) {
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  if (LIKELY(limit - p >= 8)) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    // The lowest clear high bit ends the varint
+    const uint64_t stops = ~word & 0x8080808080808080ULL;
+    if (UNLIKELY(stops == 0)) {
+      return nullptr;
+    }
+    const size_t len = (__builtin_ctzll(stops) >> 3) + 1;
+    if (UNLIKELY(len > 5)) {
+      return nullptr;
+    }
+    word &= ~0ULL >> (64 - 8 * len);
+    *value = static_cast<uint32_t>(
+        (word & 0x7f) | ((word >> 1) & (0x7fULL << 7)) |
+        ((word >> 2) & (0x7fULL << 14)) | ((word >> 3) & (0x7fULL << 21)) |
+        ((word >> 4) & (0x7fULL << 28)));
+    return p + len;
+  }
+#endif
+  return GetVarint32Ptr(p, limit, value);
+}
+
+// Reads the records of a WriteBatch one by one from its representation
+class StreamRecordReader {
+ public:
+  static constexpr bool kColumnar = false;
+
+  explicit StreamRecordReader(const Slice& input) : input_(input) {}
+
+  bool Done() const { return input_.empty(); }
+
+  Status Read(char* tag, uint32_t* column_family, Slice* key, Slice* value,
+              Slice* blob, Slice* xid) {
+    return ReadRecordFromWriteBatch(&input_, tag, column_family, key, value,
+                                    blob, xid);
+  }
+
+ private:
+  Slice input_;
+};
+
+// Reads the records of a WriteBatch from its ParsedWriteBatch
+class ParsedRecordReader {
+ public:
+  static constexpr bool kColumnar = true;
+
+  explicit ParsedRecordReader(const ParsedWriteBatch& parsed)
+      : parsed_(parsed) {}
+
+  bool Done() const { return pos_ == parsed_.size(); }
+
+  Status Read(char* tag, uint32_t* column_family, Slice* key, Slice* value,
+              Slice* blob, Slice* xid) {
+    assert(pos_ < parsed_.size());
+    *tag = parsed_.tag(pos_);
+    *column_family = parsed_.column_family(pos_);
+    *key = parsed_.key(pos_);
+    *value = parsed_.value(pos_);
+    *blob = *value;
+    *xid = *value;
+    ++pos_;
+    return Status::OK();
+  }
+
+  const ParsedWriteBatch& parsed() const { return parsed_; }
+  size_t pos() const { return pos_; }
+  void Skip(size_t n) {
+    assert(pos_ + n <= parsed_.size());
+    pos_ += n;
+  }
+
+ private:
+  const ParsedWriteBatch& parsed_;
+  size_t pos_ = 0;
+};
+
+// Whether a handler can consume a run of parsed records in one call:
+//   size_t InsertSortedRun(const ParsedWriteBatch&, size_t pos, Status*)
+// returns the number of records consumed starting at pos, 0 if none.
+template <class HandlerType, class = void>
+struct HasInsertSortedRun : std::false_type {};
+
+template <class HandlerType>
+struct HasInsertSortedRun<
+    HandlerType, std::void_t<decltype(&HandlerType::InsertSortedRun)>>
+    : std::true_type {};
+
+}  // namespace
+
 Status WriteBatch::Iterate(Handler* handler) const {
   if (rep_.size() < WriteBatchInternal::kHeader) {
     return Status::Corruption("malformed WriteBatch (too small)");
@@ -497,7 +641,140 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
   Slice input(wb->rep_.data() + begin, static_cast<size_t>(end - begin));
   bool whole_batch =
       (begin == WriteBatchInternal::kHeader) && (end == wb->rep_.size());
+  StreamRecordReader reader(input);
+  return IterateRecords(wb, handler, &reader, whole_batch);
+}
 
+namespace {
+class PointWritesChecker : public WriteBatch::Handler {
+ public:
+  Status PutCF(uint32_t, const Slice&, const Slice&) override {
+    return Status::OK();
+  }
+  Status PutEntityCF(uint32_t, const Slice&, const Slice&) override {
+    return Status::OK();
+  }
+  Status DeleteCF(uint32_t, const Slice&) override { return Status::OK(); }
+  Status SingleDeleteCF(uint32_t, const Slice&) override {
+    return Status::OK();
+  }
+  Status DeleteRangeCF(uint32_t, const Slice&, const Slice&) override {
+    return Status::NotSupported();
+  }
+  Status MergeCF(uint32_t, const Slice&, const Slice&) override {
+    return Status::NotSupported();
+  }
+  Status PutBlobIndexCF(uint32_t, const Slice&, const Slice&) override {
+    return Status::NotSupported();
+  }
+  void LogData(const Slice&) override {}
+  Status MarkBeginPrepare(bool) override { return Status::NotSupported(); }
+  Status MarkEndPrepare(const Slice&) override {
+    return Status::NotSupported();
+  }
+  Status MarkNoop(bool) override { return Status::OK(); }
+  Status MarkRollback(const Slice&) override { return Status::NotSupported(); }
+  Status MarkCommit(const Slice&) override { return Status::NotSupported(); }
+  Status MarkCommitWithTimestamp(const Slice&, const Slice&) override {
+    return Status::NotSupported();
+  }
+};
+}  // namespace
+
+bool WriteBatchInternal::HasOnlyPointWrites(const WriteBatch* b) {
+  PointWritesChecker checker;
+  return b->Iterate(&checker).ok();
+}
+
+Status WriteBatchInternal::Parse(const WriteBatch* b,
+                                 ParsedWriteBatch* parsed) {
+  parsed->clear();
+  const std::string& rep = b->rep_;
+  if (rep.size() < kHeader) {
+    return Status::Corruption("malformed WriteBatch (too small)");
+  }
+  if (rep.size() > std::numeric_limits<uint32_t>::max()) {
+    return Status::NotSupported("WriteBatch too large to be parsed");
+  }
+  const char* const base = rep.data();
+  const char* const limit = base + rep.size();
+  // Count() is not trusted for a corrupted batch, each record is at least
+  // one byte
+  const size_t num = std::min<size_t>(Count(b), rep.size() - kHeader);
+  parsed->data_ = base;
+  parsed->tags_.reserve(num);
+  parsed->column_families_.reserve(num);
+  parsed->key_offsets_.reserve(num);
+  parsed->key_sizes_.reserve(num);
+  parsed->value_offsets_.reserve(num);
+  parsed->value_sizes_.reserve(num);
+  const char* p = base + kHeader;
+  while (p < limit) {
+    const char* const record = p;
+    const char tag = *p++;
+    const uint8_t fields = RecordFields(tag);
+    uint32_t column_family = 0;
+    uint32_t key_offset = 0, key_size = 0;
+    uint32_t value_offset = 0, value_size = 0;
+    bool ok = (fields & kRecordBadTag) == 0;
+    if (ok && (fields & kRecordHasColumnFamily)) {
+      p = DecodeVarint32Word(p, limit, &column_family);
+      ok = p != nullptr;
+    }
+    if (ok && (fields & kRecordHasKey)) {
+      p = DecodeVarint32Word(p, limit, &key_size);
+      ok = p != nullptr && size_t(limit - p) >= key_size;
+      if (ok) {
+        key_offset = static_cast<uint32_t>(p - base);
+        p += key_size;
+      }
+    }
+    if (ok && (fields & kRecordHasValue)) {
+      p = DecodeVarint32Word(p, limit, &value_size);
+      ok = p != nullptr && size_t(limit - p) >= value_size;
+      if (ok) {
+        value_offset = static_cast<uint32_t>(p - base);
+        p += value_size;
+      }
+    }
+    if (UNLIKELY(!ok)) {
+      // Decode the record again the slow way for the exact error message
+      Slice input(record, limit - record);
+      char ignored_tag;
+      uint32_t ignored_cf;
+      Slice key, value, blob, xid;
+      Status s = ReadRecordFromWriteBatch(&input, &ignored_tag, &ignored_cf,
+                                          &key, &value, &blob, &xid);
+      assert(!s.ok());
+      parsed->clear();
+      return s.ok() ? Status::Corruption("bad WriteBatch record") : s;
+    }
+    parsed->tags_.push_back(tag);
+    parsed->column_families_.push_back(column_family);
+    parsed->key_offsets_.push_back(key_offset);
+    parsed->key_sizes_.push_back(key_size);
+    parsed->value_offsets_.push_back(value_offset);
+    parsed->value_sizes_.push_back(value_size);
+  }
+  return Status::OK();
+}
+
+Status WriteBatchInternal::Iterate(const WriteBatch* b,
+                                   const ParsedWriteBatch& parsed,
+                                   WriteBatch::Handler* handler) {
+  assert(parsed.empty() || parsed.data_ == b->rep_.data());
+  if (b->rep_.size() < kHeader) {
+    return Status::Corruption("malformed WriteBatch (too small)");
+  }
+  ParsedRecordReader reader(parsed);
+  return IterateRecords(b, handler, &reader, true /* whole_batch */);
+}
+
+template <class HandlerType, class RecordReader>
+Status WriteBatchInternal::IterateRecords(const WriteBatch* wb,
+                                          HandlerType* handler,
+                                          RecordReader* reader,
+                                          bool whole_batch) {
   Slice key, value, blob, xid;
 
   // Sometimes a sub-batch starts with a Noop. We want to exclude such Noops as
@@ -511,7 +788,7 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
   uint32_t column_family = 0;  // default
   bool last_was_try_again = false;
   bool handler_continue = true;
-  while (((s.ok() && !input.empty()) || UNLIKELY(s.IsTryAgain()))) {
+  while (((s.ok() && !reader->Done()) || UNLIKELY(s.IsTryAgain()))) {
     handler_continue = handler->Continue();
     if (!handler_continue) {
       break;
@@ -519,11 +796,24 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
 
     if (LIKELY(!s.IsTryAgain())) {
       last_was_try_again = false;
+      if constexpr (RecordReader::kColumnar &&
+                    HasInsertSortedRun<HandlerType>::value) {
+        size_t n =
+            handler->InsertSortedRun(reader->parsed(), reader->pos(), &s);
+        if (n != 0) {
+          reader->Skip(n);
+          empty_batch = false;
+          found += static_cast<uint32_t>(n);
+          continue;
+        }
+        if (!s.ok()) {
+          break;
+        }
+      }
       tag = 0;
       column_family = 0;  // default
 
-      s = ReadRecordFromWriteBatch(&input, &tag, &column_family, &key, &value,
-                                   &blob, &xid);
+      s = reader->Read(&tag, &column_family, &key, &value, &blob, &xid);
       if (!s.ok()) {
         return s;
       }
@@ -607,7 +897,7 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
       case kTypeBeginPrepareXID:
         assert(wb->content_flags_.load(std::memory_order_relaxed) &
                (ContentFlags::DEFERRED | ContentFlags::HAS_BEGIN_PREPARE));
-        s = handler->MarkBeginPrepare();
+        s = handler->MarkBeginPrepare(false /* unprepared */);
         assert(s.ok());
         empty_batch = false;
         if (handler->WriteAfterCommit() ==
@@ -629,7 +919,7 @@ Status WriteBatchInternal::Iterate(const WriteBatch* wb,
       case kTypeBeginPersistedPrepareXID:
         assert(wb->content_flags_.load(std::memory_order_relaxed) &
                (ContentFlags::DEFERRED | ContentFlags::HAS_BEGIN_PREPARE));
-        s = handler->MarkBeginPrepare();
+        s = handler->MarkBeginPrepare(false /* unprepared */);
         assert(s.ok());
         empty_batch = false;
         if (handler->WriteAfterCommit() ==
@@ -1739,7 +2029,7 @@ Status WriteBatch::VerifyChecksum() const {
 
 namespace {
 
-class MemTableInserter : public WriteBatch::Handler {
+class MemTableInserter final : public WriteBatch::Handler {
   SequenceNumber sequence_;
   ColumnFamilyMemTables* const cf_mems_;
   FlushScheduler* const flush_scheduler_;
@@ -1781,6 +2071,9 @@ class MemTableInserter : public WriteBatch::Handler {
   using HintMap = terark::SmartMap<MemTable*, void*, 1>;
   HintMap hint_;
   uint32_t curr_cf_id_ = UINT32_MAX;
+  // Records of the parsed batch before this position can not start a sorted
+  // run, see InsertSortedRun()
+  size_t sorted_run_pos_ = 0;
 
   union { DuplicateDetector duplicate_detector_; };
 
@@ -1815,6 +2108,23 @@ class MemTableInserter : public WriteBatch::Handler {
     return res;
   }
 
+  // Invalidates the DBOptions::get_result_cache entries of key in the current
+  // column family, before sequence_ gets published
+  void RecordGetResultWrite(const Slice& key) {
+    ColumnFamilyData* cfd = cf_mems_->current();
+    if (cfd != nullptr && cfd->get_result_cache_stripes() != nullptr) {
+      cfd->get_result_cache_stripes()->RecordWrite(key, sequence_);
+    }
+  }
+
+  // Same as above for all the keys of the current column family
+  void RecordGetResultWriteAll() {
+    ColumnFamilyData* cfd = cf_mems_->current();
+    if (cfd != nullptr && cfd->get_result_cache_stripes() != nullptr) {
+      cfd->get_result_cache_stripes()->RecordWriteAll(sequence_);
+    }
+  }
+
   void DecrementProtectionInfoIdxForTryAgain() {
     if (prot_info_ != nullptr) --prot_info_idx_;
   }
@@ -1825,6 +2135,7 @@ class MemTableInserter : public WriteBatch::Handler {
   }
 
  protected:
+  friend class ROCKSDB_NAMESPACE::WriteBatchInternal;
   Handler::OptionState WriteBeforePrepare() const override {
     return write_before_prepare_ ? Handler::OptionState::kEnabled
                                  : Handler::OptionState::kDisabled;
@@ -2100,6 +2411,7 @@ class MemTableInserter : public WriteBatch::Handler {
       const bool kBatchBoundary = true;
       MaybeAdvanceSeq(kBatchBoundary);
     } else if (ret_status.ok()) {
+      RecordGetResultWrite(key);
       MaybeAdvanceSeq();
       CheckMemtableFull();
     }
@@ -2178,6 +2490,11 @@ class MemTableInserter : public WriteBatch::Handler {
       const bool kBatchBoundary = true;
       MaybeAdvanceSeq(kBatchBoundary);
     } else if (ret_status.ok()) {
+      if (delete_type == kTypeRangeDeletion) {
+        RecordGetResultWriteAll();
+      } else {
+        RecordGetResultWrite(key);
+      }
       MaybeAdvanceSeq();
       CheckMemtableFull();
     }
@@ -2306,6 +2623,91 @@ class MemTableInserter : public WriteBatch::Handler {
     return ret_status;
   }
 
+  // Shortest run worth an InsertSortedRun()
+  static constexpr size_t kMinSortedRun = 4;
+
+  // Inserts the records of parsed starting at pos with one
+  // MemTable::AddSortedRun() if they begin a run of at least kMinSortedRun
+  // Put/Delete/SingleDelete of the same column family in strictly increasing
+  // user key order, as produced by sorted writers and bulk loads. Returns the
+  // number of records inserted, 0 if the record at pos has to go through
+  // PutCF()/DeleteCF()/SingleDeleteCF() instead.
+  size_t InsertSortedRun(const ParsedWriteBatch& parsed, size_t pos,
+                         Status* s) {
+    if (seq_per_batch_ || rebuilding_trx_ != nullptr ||
+        prot_info_ != nullptr ||
+        (hint_per_batch_ && concurrent_memtable_writes_)) {
+      return 0;
+    }
+    if (pos == 0) {
+      sorted_run_pos_ = 0;  // a new batch
+    } else if (pos < sorted_run_pos_) {
+      return 0;
+    }
+    ValueType types[MemTable::kMaxSortedRun];
+    Slice keys[MemTable::kMaxSortedRun];
+    Slice values[MemTable::kMaxSortedRun];
+    const uint32_t column_family_id = parsed.column_family(pos);
+    if (!SortedRunType(parsed.tag(pos), &types[0])) {
+      return 0;
+    }
+    Status seek_status;
+    if (!SeekToColumnFamily(column_family_id, &seek_status)) {
+      sorted_run_pos_ = pos + 1;
+      return 0;
+    }
+    MemTable* mem = cf_mems_->GetMemTable();
+    if (!mem->CanAddSortedRun()) {
+      sorted_run_pos_ = pos + 1;
+      return 0;
+    }
+    const Comparator* ucmp = mem->GetInternalKeyComparator().user_comparator();
+    const size_t limit = std::min(parsed.size() - pos, MemTable::kMaxSortedRun);
+    keys[0] = parsed.key(pos);
+    values[0] = parsed.value(pos);
+    size_t n = 1;
+    for (; n < limit; ++n) {
+      if (parsed.column_family(pos + n) != column_family_id ||
+          !SortedRunType(parsed.tag(pos + n), &types[n])) {
+        break;
+      }
+      keys[n] = parsed.key(pos + n);
+      if (ucmp->Compare(keys[n - 1], keys[n]) >= 0) {
+        break;
+      }
+      values[n] = parsed.value(pos + n);
+    }
+    sorted_run_pos_ = pos + n;
+    if (n < kMinSortedRun) {
+      // A run starting after pos ends at the same record
+      return 0;
+    }
+    ColumnFamilyData* cfd = cf_mems_->current();
+    if (cfd && cfd->user_comparator() &&
+        cfd->user_comparator()->timestamp_size() != 0) {
+      for (size_t i = 0; i < n; ++i) {
+        if (types[i] == kTypeDeletion) {
+          types[i] = kTypeDeletionWithTimestamp;
+        }
+      }
+    }
+    Status add_status = mem->AddSortedRun(
+        sequence_, types, keys, values, n, concurrent_memtable_writes_,
+        get_post_process_info(mem));
+    if (UNLIKELY(!add_status.ok())) {
+      *s = add_status;
+      return 0;
+    }
+    if (cfd != nullptr && cfd->get_result_cache_stripes() != nullptr) {
+      for (size_t i = 0; i < n; ++i) {
+        cfd->get_result_cache_stripes()->RecordWrite(keys[i], sequence_ + i);
+      }
+    }
+    sequence_ += n;
+    CheckMemtableFull();
+    return n;
+  }
+
   Status DeleteRangeCF(uint32_t column_family_id, const Slice& begin_key,
                        const Slice& end_key) override {
     const auto* kv_prot_info = NextProtectionInfo();
@@ -2537,6 +2939,7 @@ class MemTableInserter : public WriteBatch::Handler {
       const bool kBatchBoundary = true;
       MaybeAdvanceSeq(kBatchBoundary);
     } else if (ret_status.ok()) {
+      RecordGetResultWrite(key);
       MaybeAdvanceSeq();
       CheckMemtableFull();
     }
@@ -2841,6 +3244,26 @@ class MemTableInserter : public WriteBatch::Handler {
   }
 
  private:
+  // The memtable entry type of a record which can be part of a sorted run
+  static bool SortedRunType(char tag, ValueType* type) {
+    switch (tag) {
+      case kTypeColumnFamilyValue:
+      case kTypeValue:
+        *type = kTypeValue;
+        return true;
+      case kTypeColumnFamilyDeletion:
+      case kTypeDeletion:
+        *type = kTypeDeletion;
+        return true;
+      case kTypeColumnFamilySingleDeletion:
+      case kTypeSingleDeletion:
+        *type = kTypeSingleDeletion;
+        return true;
+      default:
+        return false;
+    }
+  }
+
   MemTablePostProcessInfo* get_post_process_info(MemTable* mem) {
     if (!concurrent_memtable_writes_) {
       // No need to batch counters locally if we don't use concurrent mode.
@@ -2852,6 +3275,31 @@ class MemTableInserter : public WriteBatch::Handler {
 
 }  // anonymous namespace
 
+template <class InserterType>
+Status WriteBatchInternal::IterateForInsert(const WriteBatch* b,
+                                            InserterType* inserter) {
+  // Parsing pays off only if there may be sorted runs
+  constexpr uint32_t kMinParsedCount = 16;
+  // Larger batches are parsed into a temporary to not pin their size
+  constexpr uint32_t kMaxCachedCount = 4096;
+  if (b->rep_.size() < kHeader || Count(b) < kMinParsedCount ||
+      b->rep_.size() > std::numeric_limits<uint32_t>::max()) {
+    return b->Iterate(inserter);
+  }
+  static thread_local ParsedWriteBatch tls_parsed;
+  ParsedWriteBatch local_parsed;
+  ParsedWriteBatch* parsed =
+      Count(b) <= kMaxCachedCount ? &tls_parsed : &local_parsed;
+  if (!Parse(b, parsed).ok()) {
+    // Let Iterate() apply the records before the corruption, as it always did
+    return b->Iterate(inserter);
+  }
+  ParsedRecordReader reader(*parsed);
+  Status s = IterateRecords(b, inserter, &reader, true /* whole_batch */);
+  parsed->clear();
+  return s;
+}
+
 // This function can only be called in these conditions:
 // 1) During Recovery()
 // 2) During Write(), in a single-threaded write thread
@@ -2882,7 +3330,7 @@ Status WriteBatchInternal::InsertInto(
     SetSequence(w->batch, inserter.sequence());
     inserter.set_log_number_ref(w->log_ref);
     inserter.set_prot_info(w->batch->prot_info_.get());
-    w->status = w->batch->Iterate(&inserter);
+    w->status = IterateForInsert(w->batch, &inserter);
     if (!w->status.ok()) {
       return w->status;
     }
@@ -2912,7 +3360,7 @@ Status WriteBatchInternal::InsertInto(
   SetSequence(writer->batch, sequence);
   inserter.set_log_number_ref(writer->log_ref);
   inserter.set_prot_info(writer->batch->prot_info_.get());
-  Status s = writer->batch->Iterate(&inserter);
+  Status s = IterateForInsert(writer->batch, &inserter);
   assert(!seq_per_batch || batch_cnt != 0);
   assert(!seq_per_batch || inserter.sequence() - sequence == batch_cnt);
   if (concurrent_memtable_writes) {
@@ -2933,7 +3381,7 @@ Status WriteBatchInternal::InsertInto(
                             ignore_missing_column_families, log_number, db,
                             concurrent_memtable_writes, batch->prot_info_.get(),
                             has_valid_writes, seq_per_batch, batch_per_txn);
-  Status s = batch->Iterate(&inserter);
+  Status s = IterateForInsert(batch, &inserter);
   if (next_seq != nullptr) {
     *next_seq = inserter.sequence();
   }
@@ -73,6 +73,50 @@ struct WriteBatch::ProtectionInfo {
   size_t GetBytesPerKey() const { return 8; }
 };
 
+// Columnar view of all records of a WriteBatch, filled by
+// WriteBatchInternal::Parse() in one pass so that consumers can look at many
+// records at once instead of decoding them one by one. key() and value()
+// point into the batch, which must outlive the view and must not be modified.
+// As in ReadRecordFromWriteBatch(), key() is the begin key and value() the end
+// key of a range deletion, and key() is the commit timestamp of
+// kTypeCommitXIDAndTimestamp. value() is the blob of kTypeLogData and the xid
+// of the prepare/commit/rollback markers.
+class ParsedWriteBatch {
+ public:
+  size_t size() const { return tags_.size(); }
+  bool empty() const { return tags_.empty(); }
+
+  char tag(size_t i) const { return tags_[i]; }
+  uint32_t column_family(size_t i) const { return column_families_[i]; }
+  Slice key(size_t i) const {
+    return Slice(data_ + key_offsets_[i], key_sizes_[i]);
+  }
+  Slice value(size_t i) const {
+    return Slice(data_ + value_offsets_[i], value_sizes_[i]);
+  }
+
+  void clear() {
+    data_ = nullptr;
+    tags_.clear();
+    column_families_.clear();
+    key_offsets_.clear();
+    key_sizes_.clear();
+    value_offsets_.clear();
+    value_sizes_.clear();
+  }
+
+ private:
+  friend class WriteBatchInternal;
+
+  const char* data_ = nullptr;
+  std::vector<char> tags_;
+  std::vector<uint32_t> column_families_;
+  std::vector<uint32_t> key_offsets_;
+  std::vector<uint32_t> key_sizes_;
+  std::vector<uint32_t> value_offsets_;
+  std::vector<uint32_t> value_sizes_;
+};
+
 // WriteBatchInternal provides static methods for manipulating a
 // WriteBatch that we don't want in the public WriteBatch interface.
 class WriteBatchInternal {
@@ -219,6 +263,21 @@ class WriteBatchInternal {
   static Status Iterate(const WriteBatch* wb, WriteBatch::Handler* handler,
                         size_t begin, size_t end);
 
+  // Decodes all records of b into *parsed, returns Corruption with the same
+  // message as Iterate() if b is malformed. Batches of 4GB or more are not
+  // supported.
+  static Status Parse(const WriteBatch* b, ParsedWriteBatch* parsed);
+
+  // Same as b->Iterate(handler), with the records taken from parsed, which
+  // must be the result of Parse(b) and b must not have changed since then.
+  static Status Iterate(const WriteBatch* b, const ParsedWriteBatch& parsed,
+                        WriteBatch::Handler* handler);
+
+  // Returns true if b is well formed and only has Put, PutEntity, Delete and
+  // SingleDelete records (besides LogData and Noop markers), which can be
+  // inserted into the memtables concurrently with other such batches.
+  static bool HasOnlyPointWrites(const WriteBatch* b);
+
   // This write batch includes the latest state that should be persisted. Such
   // state meant to be used only during recovery.
   static void SetAsLatestPersistentState(WriteBatch* b);
@@ -239,6 +298,18 @@ class WriteBatchInternal {
   // If checksum is provided, the batch content is verfied against the checksum.
   static Status UpdateProtectionInfo(WriteBatch* wb, size_t bytes_per_key,
                                      uint64_t* checksum = nullptr);
+
+ private:
+  // The record loop shared by both Iterate(), templated on the concrete
+  // handler so that a final handler class gets its calls devirtualized.
+  template <class HandlerType, class RecordReader>
+  static Status IterateRecords(const WriteBatch* wb, HandlerType* handler,
+                               RecordReader* reader, bool whole_batch);
+
+  // Iterate() used by InsertInto(), which parses large batches first so
+  // that MemTableInserter can insert sorted runs of records in bulk.
+  template <class InserterType>
+  static Status IterateForInsert(const WriteBatch* b, InserterType* inserter);
 };
 
 // LocalSavePoint is similar to a scope guard
@@ -1120,6 +1120,132 @@ TEST_F(WriteBatchTest, CommitWithTimestamp) {
             handler.seen);
 }
 
+TEST_F(WriteBatchTest, ParsedIterate) {
+  WriteBatch batch;
+  // Lengths which need 1, 2 and 3 byte varints
+  const std::string long_key(200, 'k');
+  const std::string long_value(20000, 'v');
+  ASSERT_OK(batch.Put("foo", "bar"));
+  ASSERT_OK(batch.Put(long_key, long_value));
+  ASSERT_OK(batch.Delete("box"));
+  ASSERT_OK(batch.SingleDelete(long_key));
+  ASSERT_OK(batch.DeleteRange("bar", "foo"));
+  ASSERT_OK(batch.Merge("omom", "nom"));
+  ASSERT_OK(batch.PutLogData("blob"));
+  ASSERT_OK(WriteBatchInternal::InsertNoop(&batch));
+  ASSERT_OK(WriteBatchInternal::Put(&batch, 3, "cf3", long_value));
+  ASSERT_OK(WriteBatchInternal::Delete(&batch, 7, "cf7"));
+  ASSERT_OK(WriteBatchInternal::MarkCommit(&batch, "xid1"));
+  ASSERT_OK(WriteBatchInternal::MarkCommitWithTimestamp(&batch, "xid2",
+                                                        "12345678"));
+  ASSERT_OK(WriteBatchInternal::MarkRollback(&batch, "xid3"));
+  ASSERT_OK(batch.Put("", ""));
+
+  TestHandler expected;
+  ASSERT_OK(batch.Iterate(&expected));
+  ParsedWriteBatch parsed;
+  ASSERT_OK(WriteBatchInternal::Parse(&batch, &parsed));
+  ASSERT_EQ(14u, parsed.size());
+  TestHandler handler;
+  ASSERT_OK(WriteBatchInternal::Iterate(&batch, parsed, &handler));
+  ASSERT_EQ(expected.seen, handler.seen);
+
+  // Every truncation is reported as Iterate() reports it
+  const std::string contents = WriteBatchInternal::Contents(&batch).ToString();
+  for (size_t size = WriteBatchInternal::kHeader; size < contents.size();
+       ++size) {
+    WriteBatch truncated;
+    ASSERT_OK(WriteBatchInternal::SetContents(
+        &truncated, Slice(contents.data(), size)));
+    TestHandler ignored;
+    Status iterate_status = truncated.Iterate(&ignored);
+    Status parse_status = WriteBatchInternal::Parse(&truncated, &parsed);
+    if (parse_status.ok()) {
+      // Truncated at a record boundary, only the count is wrong
+      parse_status = WriteBatchInternal::Iterate(&truncated, parsed, &ignored);
+    } else {
+      ASSERT_TRUE(parsed.empty());
+    }
+    ASSERT_EQ(iterate_status.ToString(), parse_status.ToString());
+  }
+
+  std::string bad_tag = contents;
+  bad_tag[WriteBatchInternal::kHeader] = '\x7f';
+  WriteBatch bad;
+  ASSERT_OK(WriteBatchInternal::SetContents(&bad, bad_tag));
+  Status s = WriteBatchInternal::Parse(&bad, &parsed);
+  ASSERT_TRUE(s.IsCorruption());
+  TestHandler ignored;
+  ASSERT_EQ(bad.Iterate(&ignored).ToString(), s.ToString());
+}
+
+TEST_F(WriteBatchTest, SortedRunInsert) {
+  WriteBatch batch;
+  WriteBatchInternal::SetSequence(&batch, 100);
+  // user key -> "Type(key[, value])@seq" of each record, newest first
+  std::map<std::string, std::vector<std::string>> expected;
+  SequenceNumber seq = 100;
+  auto key = [](int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%06d", i);
+    return std::string(buf);
+  };
+  auto put = [&](const std::string& k, const std::string& value) {
+    ASSERT_OK(batch.Put(k, value));
+    expected[k].insert(expected[k].begin(),
+                       "Put(" + k + ", " + value + ")@" + std::to_string(seq));
+    ++seq;
+  };
+  auto del = [&](const std::string& k) {
+    ASSERT_OK(batch.Delete(k));
+    expected[k].insert(expected[k].begin(),
+                       "Delete(" + k + ")@" + std::to_string(seq));
+    ++seq;
+  };
+  auto single_del = [&](const std::string& k) {
+    ASSERT_OK(batch.SingleDelete(k));
+    expected[k].insert(expected[k].begin(),
+                       "SingleDelete(" + k + ")@" + std::to_string(seq));
+    ++seq;
+  };
+  // A run longer than MemTable::kMaxSortedRun
+  for (int i = 0; i < 300; ++i) {
+    put(key(i), "v" + std::to_string(i));
+  }
+  // A run of mixed types over the same keys
+  for (int i = 0; i < 40; i += 2) {
+    del(key(i));
+    single_del(key(i + 1));
+  }
+  // Too short runs and unsorted keys
+  put(key(7), "x");
+  put(key(3), "y");
+  put(key(5), "z");
+  del(key(5));
+  ASSERT_OK(batch.Merge(key(9), "m"));
+  expected[key(9)].insert(expected[key(9)].begin(),
+                          "Merge(" + key(9) + ", m)@" + std::to_string(seq));
+  ++seq;
+  for (int i = 299; i >= 280; --i) {
+    put(key(i), "r" + std::to_string(i));
+  }
+  // Runs are broken by records which are not puts or deletes
+  for (int i = 400; i < 420; ++i) {
+    put(key(i), "w");
+    if (i % 5 == 0) {
+      ASSERT_OK(batch.PutLogData("log"));
+    }
+  }
+
+  std::string expected_state;
+  for (auto& entry : expected) {
+    for (auto& record : entry.second) {
+      expected_state.append(record);
+    }
+  }
+  ASSERT_EQ(expected_state, PrintContents(&batch));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -9,9 +9,11 @@
 #include <thread>
 
 #include "db/column_family.h"
+#include "db/write_batch_internal.h"
 #include "monitoring/perf_context_imp.h"
 #include "port/port.h"
 #include "test_util/sync_point.h"
+#include "util/crc32c.h"
 #include "util/random.h"
 #if defined(OS_LINUX)
   #include <linux/futex.h>
@@ -267,6 +269,25 @@ void WriteThread::SetState(Writer* w, uint8_t new_state) {
  }
 }
 
+void WriteThread::Writer::PrepareWalPayload() {
+  assert(batch != nullptr);
+  assert(state == STATE_INIT);
+  const Slice contents = WriteBatchInternal::Contents(batch);
+  const SavePoint& wal_end = batch->GetWalTerminationPoint();
+  size_t end = contents.size();
+  if (wal_end.is_cleared()) {
+    wal_payload_count = WriteBatchInternal::Count(batch);
+  } else {
+    end = wal_end.size;
+    wal_payload_count = wal_end.count;
+  }
+  assert(end >= WriteBatchInternal::kHeader);
+  wal_payload = Slice(contents.data() + WriteBatchInternal::kHeader,
+                      end - WriteBatchInternal::kHeader);
+  wal_payload_crc = crc32c::Value(wal_payload.data(), wal_payload.size());
+  wal_payload_ready = true;
+}
+
 bool WriteThread::LinkOne(Writer* w, std::atomic<Writer*>* newest_writer) {
   assert(newest_writer != nullptr);
   assert(w->state == STATE_INIT);
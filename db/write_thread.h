@@ -135,6 +135,15 @@ class WriteThread {
     Status status;
     Status callback_status;  // status returned by callback->Callback()
 
+    // The part of batch written to the WAL, without the batch header, with
+    // its entry count and crc32c. Set by PrepareWalPayload() on the writer's
+    // own thread before joining a group, so that the leader can append it to
+    // the WAL as is.
+    Slice wal_payload;
+    uint32_t wal_payload_count;
+    uint32_t wal_payload_crc;
+    bool wal_payload_ready;
+
     std::aligned_storage<sizeof(std::mutex)>::type state_mutex_bytes;
     std::aligned_storage<sizeof(std::condition_variable)>::type state_cv_bytes;
     Writer* link_older;  // read/write only before linking, or as leader
@@ -159,6 +168,9 @@ class WriteThread {
           state(STATE_INIT),
           write_group(nullptr),
           sequence(kMaxSequenceNumber),
+          wal_payload_count(0),
+          wal_payload_crc(0),
+          wal_payload_ready(false),
           link_older(nullptr),
           link_newer(nullptr) {}
 
@@ -185,6 +197,9 @@ class WriteThread {
           state(STATE_INIT),
           write_group(nullptr),
           sequence(kMaxSequenceNumber),
+          wal_payload_count(0),
+          wal_payload_crc(0),
+          wal_payload_ready(false),
           link_older(nullptr),
           link_newer(nullptr) {}
 
@@ -197,6 +212,9 @@ class WriteThread {
       callback_status.PermitUncheckedError();
     }
 
+    // See wal_payload. REQUIRES: not linked yet
+    void PrepareWalPayload();
+
     bool CheckCallback(DB* db) {
       if (callback != nullptr) {
         callback_status = callback->Callback(db);
@@ -130,10 +130,12 @@ std::shared_ptr<Cache> StressTest::NewCache(size_t capacity,
   if (FLAGS_cache_type == "clock_cache") {
     fprintf(stderr, "Old clock cache implementation has been removed.\n");
     exit(1);
-  } else if (FLAGS_cache_type == "hyper_clock_cache") {
+  } else if (FLAGS_cache_type == "hyper_clock_cache" ||
+             FLAGS_cache_type == "auto_hyper_clock_cache") {
+    size_t estimated_entry_charge =
+        FLAGS_cache_type == "hyper_clock_cache" ? FLAGS_block_size : 0;
     HyperClockCacheOptions opts(static_cast<size_t>(capacity),
-                                FLAGS_block_size /*estimated_entry_charge*/,
-                                num_shard_bits);
+                                estimated_entry_charge, num_shard_bits);
     opts.secondary_cache = std::move(secondary_cache);
     return opts.MakeSharedCache();
   } else if (FLAGS_cache_type == "lru_cache") {
@@ -466,6 +466,75 @@ TEST_P(PrefetchTailTest, UpgradeToTailSizeInManifest) {
   Close();
 }
 
+TEST_P(PrefetchTailTest, BackfillTailSizeInManifest) {
+  if (UseDirectIO()) {
+    ROCKSDB_GTEST_BYPASS("Direct IO is not needed to check the tail size");
+  }
+
+  std::unique_ptr<Env> env(GetEnv());
+  Options options;
+  SetGenericOptions(env.get(), false /* use_direct_io*/, options);
+  options.max_open_files = -1;
+  options.disable_auto_compactions = true;
+
+  BlockBasedTableOptions table_options;
+  SetBlockBasedTableOptions(table_options);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  SyncPoint::GetInstance()->EnableProcessing();
+  // To simulate files written before tail size was recorded in manifest
+  SyncPoint::GetInstance()->SetCallBack(
+      "FileMetaData::FileMetaData", [&](void* arg) {
+        FileMetaData* meta = static_cast<FileMetaData*>(arg);
+        meta->tail_size = 0;
+      });
+
+  ASSERT_OK(TryReopen(options));
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 1000; ++j) {
+      ASSERT_OK(Put("k" + std::to_string(j), "v" + std::to_string(i)));
+    }
+    ASSERT_OK(Flush());
+  }
+  SyncPoint::GetInstance()->ClearCallBack("FileMetaData::FileMetaData");
+
+  std::vector<size_t> prefetch_lens;
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTable::Open::TailPrefetchLen", [&](void* arg) {
+        auto* prefetch_off_len_pair =
+            static_cast<std::pair<size_t*, size_t*>*>(arg);
+        prefetch_lens.push_back(*prefetch_off_len_pair->second);
+      });
+  // Table readers opened with no tail size fill it in from their table
+  // properties, and it is persisted in the manifest written at DB open
+  ASSERT_OK(TryReopen(options));
+  ASSERT_EQ(3U, prefetch_lens.size());
+
+  prefetch_lens.clear();
+  ASSERT_OK(TryReopen(options));
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  SyncPoint::GetInstance()->DisableProcessing();
+
+  // The next open prefetches exactly the tail of each file
+  std::multiset<size_t> expected_tail_sizes;
+  std::vector<LiveFileMetaData> live_files;
+  db_->GetLiveFilesMetaData(&live_files);
+  ASSERT_EQ(3U, live_files.size());
+  TablePropertiesCollection all_table_props;
+  ASSERT_OK(db_->GetPropertiesOfAllTables(&all_table_props));
+  for (const auto& file : live_files) {
+    auto it = all_table_props.find(file.directory + file.name);
+    ASSERT_NE(it, all_table_props.end());
+    ASSERT_GT(it->second->tail_start_offset, 0U);
+    expected_tail_sizes.insert(
+        static_cast<size_t>(file.size - it->second->tail_start_offset));
+  }
+  ASSERT_EQ(expected_tail_sizes, std::multiset<size_t>(prefetch_lens.begin(),
+                                                       prefetch_lens.end()));
+
+  Close();
+}
+
 // This test verifies BlockBasedTableOptions.max_auto_readahead_size is
 // configured dynamically.
 TEST_P(PrefetchTest, ConfigureAutoMaxReadaheadSize) {
@@ -11,6 +11,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "rocksdb/cache.h"
 #include "rocksdb/memory_allocator.h"
@@ -510,6 +511,31 @@ class Cache {
   // WaitAlls()).
   virtual void WaitAll(AsyncLookupHandle* /*async_handles*/, size_t /*count*/);
 
+  // Equivalent to StartAsyncLookup() on each of an array of async handles,
+  // but a cache can do the batch with less overhead than separate lookups,
+  // e.g. by grouping keys by shard, taking each shard lock once, and
+  // prefetching table memory ahead of the probes. As with StartAsyncLookup(),
+  // WaitAll() is required for any handles left pending.
+  //
+  // Default implementation calls StartAsyncLookup() on each handle.
+  virtual void MultiLookup(AsyncLookupHandle* async_handles, size_t count);
+
+  // Equivalent to Release(handles[i], useful, /*erase_if_last_ref*/ false)
+  // for each of an array of handles (nullptr entries are skipped), e.g. from
+  // MultiLookup(), with the same batching opportunities as MultiLookup().
+  //
+  // Default implementation calls Release() on each handle.
+  virtual void MultiRelease(Handle** handles, size_t count, bool useful = true);
+
+  // Estimates the hit ratio (in [0, 1]) the cache would have had on recent
+  // lookups with each of the given capacities, e.g. for sizing the cache.
+  // Returns false if not supported or not enabled (see
+  // ShardedCacheOptions::estimate_miss_ratio_curve).
+  virtual bool EstimateHitRatios(const std::vector<size_t>& /*capacities*/,
+                                 std::vector<double>* /*hit_ratios*/) const {
+    return false;
+  }
+
   // For a function called on cache entries about to be evicted. The function
   // returns `true` if it has taken ownership of the Value (object), or
   // `false` if the cache should destroy it as usual. Regardless, Ref() and
@@ -612,6 +638,15 @@ class CacheWrapper : public Cache {
     target_->WaitAll(async_handles, count);
   }
 
+  bool EstimateHitRatios(const std::vector<size_t>& capacities,
+                         std::vector<double>* hit_ratios) const override {
+    return target_->EstimateHitRatios(capacities, hit_ratios);
+  }
+
+  // NOTE: MultiLookup() and MultiRelease() are intentionally not forwarded,
+  // so that the default implementations go through any Lookup(),
+  // StartAsyncLookup() or Release() overridden by a derived wrapper.
+
  protected:
   std::shared_ptr<Cache> target_;
 };
@@ -484,6 +484,25 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   size_t memtable_huge_page_size = 0;
 
+  // If true and the host has more than one NUMA node, the memtable arena
+  // refills its per-core allocation caches from per-node block pools bound
+  // to the node of the core (with mbind if built with libnuma, otherwise by
+  // first touch). Memtable entries then end up local to the socket of the
+  // writer that inserted them. Only matters with concurrent memtable writes,
+  // see WriteBufferManager::SetNumaNodeBufferSize() to cap the memory per
+  // node.
+  //
+  // Dynamically changeable through SetOptions() API
+  bool memtable_numa_aware = false;
+
+  // If true, the huge pages of memtable_huge_page_size are transparent huge
+  // pages: anonymous memory aligned to memtable_huge_page_size and marked
+  // with madvise(MADV_HUGEPAGE), which needs no reserved huge pages, instead
+  // of MAP_HUGETLB. Has no effect if memtable_huge_page_size is 0.
+  //
+  // Dynamically changeable through SetOptions() API
+  bool memtable_transparent_huge_page = false;
+
   // If non-nullptr, memtable will use the specified function to extract
   // prefixes for keys, and for each prefix maintain a hint of insert location
   // to reduce CPU usage for inserting keys with the prefix. Keys out of
@@ -23,7 +23,10 @@ namespace ROCKSDB_NAMESPACE {
 
 class Cache;  // defined in advanced_cache.h
 struct ConfigOptions;
+class FileSystem;
 class SecondaryCache;
+class Statistics;
+class Status;
 
 // These definitions begin source compatibility for a future change in which
 // a specific class for block cache is split away from general caches, so that
@@ -188,6 +191,38 @@ struct ShardedCacheOptions {
   //   repeatable behavior on a host, for diagnostic purposes.
   int32_t hash_seed = kHostHashSeed;
 
+  // EXPERIMENTAL. If true, the cache keeps a TinyLFU estimate of how often
+  // each key has been looked up recently, and a block (see CacheEntryRole)
+  // inserted into a full cache shard is only admitted if its key is estimated
+  // to be accessed more often than the key of the entry that would be evicted
+  // first. This keeps one-time accesses, such as a large scan, from flushing
+  // the working set. A rejected insertion succeeds as if the entry were
+  // inserted and evicted right away (a handle, if requested, is to a
+  // standalone entry, charged while referenced but evicting nothing).
+  // Entries for memory reservations (e.g. kWriteBuffer, kMisc) are always
+  // admitted.
+  bool tiny_lfu_admission = false;
+
+  // For tiny_lfu_admission, about the number of entries the cache holds,
+  // which sizes the frequency sketch (about 3 bytes per entry). 0 means
+  // capacity / 4KB.
+  size_t tiny_lfu_expected_entries = 0;
+
+  // EXPERIMENTAL. If true, the cache keeps an online estimate of its miss
+  // ratio curve, the hit ratio it would have at other capacities, from a
+  // small spatially hashed sample of the lookups (SHARDS). The estimate
+  // assumes LRU replacement and is available from Cache::EstimateHitRatios
+  // and the DB property "rocksdb.block-cache-miss-ratio-curve". Costs a few
+  // hundred KB of memory, and a mutex on about 1 in 1000 lookups on a cache
+  // with millions of entries (all lookups for much fewer entries).
+  bool estimate_miss_ratio_curve = false;
+
+  // Where to record the BLOCK_CACHE_TINY_LFU_ADMIT and
+  // BLOCK_CACHE_TINY_LFU_REJECT tickers (for tiny_lfu_admission) and the
+  // BLOCK_CACHE_REUSE_DISTANCE_BYTES histogram (for
+  // estimate_miss_ratio_curve). Optional.
+  std::shared_ptr<Statistics> statistics;
+
   ShardedCacheOptions() {}
   ShardedCacheOptions(
       size_t _capacity, int _num_shard_bits, bool _strict_capacity_limit,
@@ -242,6 +277,15 @@ struct LRUCacheOptions : public ShardedCacheOptions {
   // -DROCKSDB_DEFAULT_TO_ADAPTIVE_MUTEX, false otherwise.
   bool use_adaptive_mutex = kDefaultToAdaptiveMutex;
 
+  // EXPERIMENTAL. If true, each shard finds its entries with an
+  // open-addressed hash table of 1-byte hash tags, compared 16 at a time
+  // (with SSE2, Swiss table style), instead of chaining the entries of each
+  // bucket. A lookup then reads one cache line of tags and only the entries
+  // whose tag matches, rather than each entry in its bucket, which saves
+  // cache misses for large caches with many entries. Uses about 9 bytes per
+  // slot instead of 8.
+  bool use_swiss_table = false;
+
   LRUCacheOptions() {}
   LRUCacheOptions(size_t _capacity, int _num_shard_bits,
                   bool _strict_capacity_limit, double _high_pri_pool_ratio,
@@ -309,6 +353,23 @@ struct CompressedSecondaryCacheOptions : LRUCacheOptions {
   // (Filter blocks are essentially non-compressible but others usually are.)
   CacheEntryRoleSet do_not_compress_roles = {CacheEntryRole::kFilterBlock};
 
+  // If positive and compression_type is kZSTD, a zstd dictionary of up to
+  // this many bytes is trained for each kind of entry (CacheEntryRole) from
+  // the values inserted, and used to compress the following ones. Blocks of
+  // a few KB compress much better with a dictionary. Each entry records the
+  // version of the dictionary it was compressed with, and the latest few
+  // versions of each dictionary are kept to decompress them.
+  // Default: 0 (no dictionary)
+  uint32_t max_dict_bytes = 0;
+
+  // The bytes of inserted values a dictionary is trained from. 0 means 100
+  // times max_dict_bytes.
+  uint64_t dict_training_bytes = 0;
+
+  // A dictionary is retrained from the values inserted after each time this
+  // many bytes of values were inserted with the previous one. 0 means never.
+  uint64_t dict_retrain_bytes = 256 << 20;
+
   CompressedSecondaryCacheOptions() {}
   CompressedSecondaryCacheOptions(
       size_t _capacity, int _num_shard_bits, bool _strict_capacity_limit,
@@ -367,6 +428,43 @@ inline std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
   return opts.MakeSharedSecondaryCache();
 }
 
+// EXPERIMENTAL
+// Options for a SecondaryCache on local storage, such as an NVMe SSD, for
+// blocks that miss in the RAM caches when the SST files are on slower (e.g.
+// network) storage. Entries are appended to segment files under `path` and
+// evicted a whole segment at a time. Lookups that don't wait, as from
+// MultiGet, read with FSRandomAccessFile::ReadAsync (io_uring with the
+// default FileSystem on Linux), so that their reads overlap. The cache starts
+// empty: segment files found under `path` are deleted.
+struct NvmSecondaryCacheOptions {
+  // Directory for the segment files, created if missing. It should not be
+  // used for anything else.
+  std::string path;
+
+  // Total size of the segment files. Must be at least 2 * segment_size.
+  size_t capacity = 0;
+
+  // Size of each segment file, the unit of eviction, below 4GB. Entries that
+  // don't fit in a segment are not cached.
+  size_t segment_size = 64 << 20;
+
+  // If true, the sealed segment to evict is chosen by a clock: a segment with
+  // a hit since the clock last passed it gets a second chance. Otherwise the
+  // oldest segment is evicted (FIFO).
+  bool clock_eviction = true;
+
+  // File system for the segment files. FileSystem::Default() if nullptr.
+  std::shared_ptr<FileSystem> file_system;
+
+  NvmSecondaryCacheOptions() {}
+  NvmSecondaryCacheOptions(const std::string& _path, size_t _capacity)
+      : path(_path), capacity(_capacity) {}
+};
+
+// Creates a NvmSecondaryCache, after clearing out its directory.
+Status NewNvmSecondaryCache(const NvmSecondaryCacheOptions& opts,
+                            std::shared_ptr<SecondaryCache>* result);
+
 // HyperClockCache - A lock-free Cache alternative for RocksDB block cache
 // that offers much improved CPU efficiency vs. LRUCache under high parallel
 // load or high contention, with some caveats:
@@ -375,7 +473,8 @@ inline std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
 // compatible with HyperClockCache.
 // * Requires an extra tuning parameter: see estimated_entry_charge below.
 // Similarly, substantially changing the capacity with SetCapacity could
-// harm efficiency.
+// harm efficiency. (Or set estimated_entry_charge=0 for a table that grows
+// as needed; see below.)
 // * Cache priorities are less aggressively enforced, which could cause
 // cache dilution from long range scans (unless they use fill_cache=false).
 // * Can be worse for small caches, because if almost all of a cache shard is
@@ -414,8 +513,24 @@ struct HyperClockCacheOptions : public ShardedCacheOptions {
   // GetOccupancyCount(). However, when the average value size might vary
   // (e.g. balance between metadata and data blocks in cache), it is better
   // to estimate toward the lower side than the higher side.
+  //
+  // A value of 0 means there is no estimate: the cache then uses a hash
+  // table that starts small and grows incrementally (without blocking
+  // readers) as entries are added, which is recommended when the average
+  // entry charge is unknown or changes over time (e.g. with a varying mix of
+  // data, index and filter blocks, or compressed blocks in cache). It is
+  // somewhat slower on writes than a table sized with a good estimate.
   size_t estimated_entry_charge;
 
+  // Only for estimated_entry_charge == 0: a lower bound on the average
+  // `charge` of cache entries, which bounds how large the hash table can
+  // grow for a given capacity (table memory for the maximum size is reserved
+  // but only used as the table grows). If the true average is lower, the
+  // cache might not use its full capacity, because of a limit on occupancy
+  // of the table. The default is suitable for block sizes of a few KB and
+  // larger, or for a mix of blocks with some smaller ones.
+  size_t min_avg_entry_charge = 450;
+
   HyperClockCacheOptions(
       size_t _capacity, size_t _estimated_entry_charge,
       int _num_shard_bits = -1, bool _strict_capacity_limit = false,
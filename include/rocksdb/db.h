@@ -1159,6 +1159,13 @@ class DB {
     //      entries being pinned.
     static const std::string kBlockCachePinnedUsage;
 
+    //  "rocksdb.block-cache-miss-ratio-curve" - returns a string or map with
+    //      the estimated hit ratio of the block cache at capacities from 1/8
+    //      to 8 times its current capacity (in the map form, keyed by
+    //      capacity in bytes). Only available with
+    //      ShardedCacheOptions::estimate_miss_ratio_curve.
+    static const std::string kBlockCacheMissRatioCurve;
+
     // "rocksdb.options-statistics" - returns multi-line string
     //      of options.statistics
     static const std::string kOptionsStatistics;
@@ -203,4 +203,21 @@ extern const FilterPolicy* NewBloomFilterPolicy(
 extern const FilterPolicy* NewRibbonFilterPolicy(
     double bloom_equivalent_bits_per_key, int bloom_before_level = 0);
 
+// EXPERIMENTAL
+// A range filter: besides point and prefix queries, it can tell that a
+// table has no key in [seek key, ReadOptions::iterate_upper_bound), so that
+// bounded iterator seeks skip the index and data blocks of such tables, or
+// of such filter partitions. It stores the keys truncated to their
+// distinguishing prefixes in a succinct trie (SuRF-Base, Zhang et al.,
+// SIGMOD 2018). Its size depends on the keys rather than on a bits per key
+// setting, and its false positive rate for point queries is higher than a
+// Bloom filter's, so it pays off mostly for short range scans over sparse
+// key spaces.
+//
+// Range queries are only answered for tables ordered by
+// BytewiseComparator(), without user-defined timestamps, and with
+// whole_key_filtering. Other built-in filter policies can read these
+// filters; older versions treat them as matching everything.
+extern const FilterPolicy* NewSuccinctRangeFilterPolicy();
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,97 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// MemoryGovernor divides one memory budget between the block cache, the row
+// cache and the memtables (WriteBufferManager) shared by one or more DBs, and
+// periodically moves memory to where it is most useful as the workload
+// shifts between reads and writes.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class Cache;
+class Logger;
+class Statistics;
+class SystemClock;
+class WriteBufferManager;
+
+struct MemoryGovernorOptions {
+  // Bytes shared by the consumers below. 0 means the sum of their sizes when
+  // the governor is created.
+  size_t total_budget = 0;
+
+  // The consumers of the budget, any of which may be nullptr (but at least
+  // two are needed for the governor to do anything). Their sizes when the
+  // governor is created are the initial split, scaled to total_budget.
+  //
+  // If write_buffer_manager charges memtables to a cache, it must be
+  // block_cache, whose capacity is then set to its share plus the write
+  // buffer share, so that memtable charges come out of the latter.
+  std::shared_ptr<Cache> block_cache;
+  std::shared_ptr<Cache> row_cache;
+  std::shared_ptr<WriteBufferManager> write_buffer_manager;
+
+  // Required. The Statistics of the DBs using the consumers above, for the
+  // BLOCK_CACHE_HIT/MISS, ROW_CACHE_HIT/MISS and STALL_MICROS tickers.
+  // Caches that estimate their miss ratio curve (see
+  // ShardedCacheOptions::estimate_miss_ratio_curve) are compared by the
+  // estimated hits to gain or lose from a change of capacity, others by
+  // their misses.
+  std::shared_ptr<Statistics> statistics;
+
+  // How often to rebalance. 0 means only on MemoryGovernor::Rebalance().
+  uint64_t rebalance_period_sec = 60;
+
+  // The fraction of total_budget moved by a rebalance
+  double step_fraction = 0.05;
+
+  // No consumer goes below this fraction of total_budget
+  double min_fraction = 0.1;
+
+  // Optional, for logging the moves
+  std::shared_ptr<Logger> info_log;
+
+  // nullptr means SystemClock::Default()
+  std::shared_ptr<SystemClock> clock;
+};
+
+// Thread-safe. MemoryGovernor is NOT an extensible interface but a public
+// interface for result of NewMemoryGovernor. Any derived classes must be
+// RocksDB internal.
+class MemoryGovernor {
+ public:
+  virtual ~MemoryGovernor() {}
+
+  // Moves up to one step of memory between the consumers based on the
+  // tickers since the last rebalance. Called periodically in the background
+  // if rebalance_period_sec > 0.
+  virtual void Rebalance() = 0;
+
+  // Changes the budget, keeping the proportions of the current split
+  virtual void SetTotalBudget(size_t total_budget) = 0;
+  virtual size_t GetTotalBudget() const = 0;
+
+  // The current split of the budget (0 for absent consumers)
+  struct Split {
+    size_t block_cache = 0;
+    size_t row_cache = 0;
+    size_t write_buffer = 0;
+  };
+  virtual Split GetSplit() const = 0;
+};
+
+// Creates a MemoryGovernor and applies the initial split to the consumers.
+// Returns nullptr and sets *status (if not nullptr) on invalid options.
+extern MemoryGovernor* NewMemoryGovernor(const MemoryGovernorOptions& options,
+                                         Status* status = nullptr);
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -186,6 +186,35 @@ class MemTableRep {
     return true;
   }
 
+  // Same as calling Allocate() num times, storing the results in bufs[] and
+  // handles[], but a rep may carve the buffers out of fewer allocations.
+  virtual void AllocateBatch(const size_t* lens, size_t num, char** bufs,
+                             KeyHandle* handles);
+
+  // Insert num keys that are sorted in internal key order, e.g. consecutive
+  // entries of a sorted WriteBatch, which lets a rep locate all the insert
+  // positions in one pass instead of one search per key.
+  //
+  // If inserted is not nullptr, inserted[i] is set to false iff handles[i]
+  // was rejected as a duplicated <key, seq> (see InsertKey).  Returns the
+  // number of keys inserted.
+  //
+  // Default: inserts the keys one by one.
+  // REQUIRES: no concurrent modifications to the table in progress
+  virtual size_t InsertKeyBatch(const KeyHandle* handles, size_t num,
+                                bool* inserted);
+
+  // Like InsertKeyBatch, but may be called concurrently with other
+  // concurrent inserts.
+  virtual size_t InsertKeyBatchConcurrently(const KeyHandle* handles,
+                                            size_t num, bool* inserted);
+
+  // Return true if entries may be added with AllocateBatch() and
+  // InsertKeyBatch() instead of InsertKeyValue(). Reps that only implement
+  // the key/value entry points must return false.
+  // Default: false
+  virtual bool SupportInsertKeyBatch() const { return false; }
+
   // Returns true iff an entry that compares equal to key is in the collection.
   virtual bool Contains(const Slice& internal_key) const = 0;
 
@@ -358,9 +387,15 @@ class MemTableRepFactory : public Customizable {
 //     search from the previously visited record (doing at most 'lookahead'
 //     steps). This is an optimization for the access pattern including many
 //     seeks with consecutive keys.
+//   convert_to_sst: If true, flush writes the already sorted list straight
+//     into the SST (MemTableRep::ConvertToSST) instead of going through
+//     BuildTable. With PlainTable this is a single pass without per-entry
+//     virtual calls. Obsolete versions are not dropped by such a flush, and
+//     it is skipped for blob files, flush-time compaction filters and
+//     timestamp stripping.
 class SkipListFactory : public MemTableRepFactory {
  public:
-  explicit SkipListFactory(size_t lookahead = 0);
+  explicit SkipListFactory(size_t lookahead = 0, bool convert_to_sst = false);
 
   // Methods for Configurable/Customizable class overrides
   static const char* kClassName() { return "SkipListFactory"; }
@@ -381,6 +416,38 @@ class SkipListFactory : public MemTableRepFactory {
 
  private:
   size_t lookahead_;
+  bool convert_to_sst_;
+};
+
+// This uses an adaptive radix tree (ART) ordered by the bytes of the user key.
+// Compared to the skip list, point lookups and inserts touch O(key length)
+// compact nodes instead of O(log N) scattered ones, and concurrent inserts are
+// lock-free for readers (optimistic lock coupling). Get() only visits the
+// entries of the looked up user key, and flush writes the SST directly from
+// the tree (ConvertToSST).
+//
+// The tree requires the forward bytewise comparator without timestamps; for
+// any other comparator a skip list memtable is created instead.
+class AdaptiveRadixTreeRepFactory : public MemTableRepFactory {
+ public:
+  // Methods for Configurable/Customizable class overrides
+  static const char* kClassName() { return "AdaptiveRadixTreeRepFactory"; }
+  static const char* kNickName() { return "art"; }
+  const char* Name() const override { return kClassName(); }
+  const char* NickName() const override { return kNickName(); }
+
+  // Methods for MemTableRepFactory class overrides
+  using MemTableRepFactory::CreateMemTableRep;
+  MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator&, Allocator*,
+                                 const SliceTransform*,
+                                 Logger* logger) override;
+
+  bool IsInsertConcurrentlySupported() const override { return true; }
+
+  bool CanHandleDuplicatedKey() const override { return true; }
+
+ private:
+  SkipListFactory fallback_;
 };
 
 // This creates MemTableReps that are backed by an std::vector. On iteration,
@@ -410,6 +477,58 @@ class VectorRepFactory : public MemTableRepFactory {
                                          Logger* logger) override;
 };
 
+// This splits each memtable into num_partitions sub-reps created by rep, and
+// routes every entry to one of them by a hash of its user key. Inserts into
+// different partitions only contend on a per-partition spin lock, so reps
+// without concurrent insert support (vector, hash_linkedlist, prefix_hash)
+// can be used with allow_concurrent_memtable_write. Get() searches a single
+// partition; iterators merge the iterators of all partitions.
+//
+// Entries passed to Insert*(KeyHandle) instead of InsertKeyValue*() are
+// copied into their partition, as the partition is unknown at Allocate()
+// time. Insert hints are ignored.
+//
+// Parameters:
+//   rep: Factory of the sub-reps. Default: VectorRepFactory.
+//   num_partitions: Number of sub-reps. With 1 or less, the rep is used
+//     directly, so concurrent inserts need a rep supporting them.
+//     Default: 8.
+class PartitionedRepFactory : public MemTableRepFactory {
+ public:
+  explicit PartitionedRepFactory(
+      const std::shared_ptr<MemTableRepFactory>& rep = nullptr,
+      size_t num_partitions = 8);
+
+  // Methods for Configurable/Customizable class overrides
+  static const char* kClassName() { return "PartitionedRepFactory"; }
+  static const char* kNickName() { return "partitioned"; }
+  const char* Name() const override { return kClassName(); }
+  const char* NickName() const override { return kNickName(); }
+
+  // Methods for MemTableRepFactory class overrides
+  using MemTableRepFactory::CreateMemTableRep;
+  MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator&, Allocator*,
+                                 const SliceTransform*,
+                                 Logger* logger) override;
+  MemTableRep* CreateMemTableRep(const std::string& level0_dir,
+                                 const MutableCFOptions&,
+                                 const MemTableRep::KeyComparator&, Allocator*,
+                                 const SliceTransform*, Logger* logger,
+                                 uint32_t column_family_id) override;
+
+  bool IsInsertConcurrentlySupported() const override {
+    return num_partitions_ > 1 || rep_->IsInsertConcurrentlySupported();
+  }
+
+  bool CanHandleDuplicatedKey() const override {
+    return rep_->CanHandleDuplicatedKey();
+  }
+
+ private:
+  std::shared_ptr<MemTableRepFactory> rep_;
+  size_t num_partitions_;
+};
+
 // This class contains a fixed array of buckets, each
 // pointing to a skiplist (null if the bucket is empty).
 // bucket_count: number of fixed array buckets
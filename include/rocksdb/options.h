@@ -1099,6 +1099,20 @@ struct DBOptions {
   // Default: false
   bool unordered_write = false;
 
+  // If true, each writer computes the checksum of the part of its WriteBatch
+  // that goes to the WAL before joining a write group, and the group leader
+  // appends the parts of all writers to the WAL as one record directly from
+  // the writers' batches, instead of first copying them into one merged batch
+  // and checksumming that. This moves the per-byte WAL work of a write group
+  // off the leader and onto the writers, in parallel, which helps many
+  // concurrent writers of small batches. The WAL format is not changed.
+  //
+  // Not used with two_write_queues or unordered_write, or with
+  // wal_compression.
+  //
+  // Default: false
+  bool enable_wal_gather_write = false;
+
   // If true, allow multi-writers to update mem tables in parallel.
   // Only some memtable_factory-s support concurrent writes; currently it
   // is implemented only for SkipListFactory.  Concurrent memtable writes
@@ -1165,6 +1179,26 @@ struct DBOptions {
   // Default: kPointInTimeRecovery
   WALRecoveryMode wal_recovery_mode = WALRecoveryMode::kPointInTimeRecovery;
 
+  // Number of threads used to replay the WALs on DB open. With more than one
+  // thread, a background thread reads, checksums and decodes the WAL records
+  // ahead of the replay, consecutive write batches that only contain point
+  // writes (Put, PutEntity, Delete, SingleDelete) are inserted into the
+  // memtables concurrently, and memtables filled up during recovery are
+  // flushed in the background. Other write batches are replayed one at a
+  // time, in WAL order, so the recovered state does not depend on this option.
+  // Memtables are checked for a flush after each group of concurrently
+  // inserted batches, so a memtable can exceed write_buffer_size during
+  // recovery by up to 1/8 of the smallest write_buffer_size of all column
+  // families (at most 4MB), plus one batch.
+  //
+  // Only used when all column families use a memtable that supports
+  // concurrent inserts and none sets inplace_update_support, and when
+  // wal_filter is not set, allow_2pc is false and the DB does not write one
+  // sequence number per batch (WritePrepared/WriteUnprepared transactions).
+  //
+  // Default: 1
+  int wal_recovery_threads = 1;
+
   // if set to false then recovery will fail when a prepared
   // transaction is encountered in the WAL
   bool allow_2pc = false;
@@ -1173,6 +1207,42 @@ struct DBOptions {
   // Default: nullptr (disabled)
   std::shared_ptr<GeneralCache> row_cache = nullptr;
 
+  // If positive, the table file blocks in the block cache are recorded every
+  // this many seconds, and on close, in a BLOCK_CACHE_HOT_SET file in the DB
+  // directory, for block_cache_warm_up_threads to load on the next DB::Open.
+  // Default: 0 (disabled)
+  uint64_t block_cache_hot_set_persist_period_sec = 0;
+
+  // The most blocks recorded in the hot set, those of the lower levels first.
+  // Default: 1M
+  uint64_t block_cache_hot_set_max_blocks = 1 << 20;
+
+  // If positive, DB::Open starts this many background threads loading the
+  // blocks of the recorded hot set that are still in live table files into
+  // the block cache, the files of the lower levels first, reading adjacent
+  // blocks together. DB::Open does not wait for them. The progress is
+  // reported by the BLOCK_CACHE_WARM_UP_* tickers and in the info log.
+  // Default: 0 (disabled)
+  int block_cache_warm_up_threads = 0;
+
+  // Limits the read rate of the warm-up, in bytes per second. 0 means
+  // unlimited.
+  // Default: 0
+  uint64_t block_cache_warm_up_bytes_per_sec = 0;
+
+  // A cache of the results of DB::Get at the latest sequence number, keyed by
+  // column family and user key. Writes to a key invalidate its cached result
+  // by bumping one of a set of per-column family version stripes, so a hit
+  // costs a single cache lookup and no memtable or table file access.
+  // Only used for DB::Get without a snapshot, timestamp or callback, with
+  // read_tier == kReadAllTier, and only for column families without a
+  // compaction filter, user-defined timestamps or FIFO compaction. Ignored
+  // with unordered_write, two_write_queues or WritePrepared/WriteUnprepared
+  // transactions. Unlike row_cache, which caches the value of a key within a
+  // table file, this caches the final result of the whole read path.
+  // Default: nullptr (disabled)
+  std::shared_ptr<GeneralCache> get_result_cache = nullptr;
+
   // A filter object supplied to be invoked while processing write-ahead-logs
   // (WALs) during recovery. The filter provides a way to inspect log
   // records, ignoring a particular record or skipping replay.
@@ -516,6 +516,31 @@ enum Tickers : uint32_t {
   LCOMPACT_WRITE_BYTES_RAW,
   DCOMPACT_WRITE_BYTES_RAW,
 
+  // Huge page blocks of memtable arenas (see memtable_huge_page_size): taken
+  // from the WriteBufferManager's pool of freed blocks, newly mapped, failed
+  // to be allocated and fell back to malloc, and their total bytes. Recorded
+  // when a memtable becomes immutable.
+  MEMTABLE_HUGE_PAGE_BLOCKS_REUSED,
+  MEMTABLE_HUGE_PAGE_BLOCKS_MAPPED,
+  MEMTABLE_HUGE_PAGE_FALLBACKS,
+  MEMTABLE_HUGE_PAGE_BYTES,
+
+  // With ShardedCacheOptions::tiny_lfu_admission, # of blocks inserted into
+  // a full cache shard that were admitted, or rejected, by the TinyLFU
+  // admission policy
+  BLOCK_CACHE_TINY_LFU_ADMIT,
+  BLOCK_CACHE_TINY_LFU_REJECT,
+
+  // With DBOptions::block_cache_warm_up_threads, # of blocks and bytes read
+  // into the block cache by the warm-up on DB open
+  BLOCK_CACHE_WARM_UP_BLOCKS,
+  BLOCK_CACHE_WARM_UP_BYTES,
+
+  // With DBOptions::get_result_cache, # of DB::Get calls answered by the
+  // cache, and # of eligible calls that were not
+  GET_RESULT_CACHE_HIT,
+  GET_RESULT_CACHE_MISS,
+
   TICKER_ENUM_MAX
 };
 
@@ -661,6 +686,11 @@ enum Histograms : uint32_t {
 
   READ_ZBS_RECORD_MICROS, // toplingdb ZipTable
 
+  // With ShardedCacheOptions::estimate_miss_ratio_curve, estimated reuse
+  // distances (bytes of distinct entries looked up since the last lookup of
+  // the same key) of the sampled block cache lookups
+  BLOCK_CACHE_REUSE_DISTANCE_BYTES,
+
   HISTOGRAM_ENUM_MAX
 };
 
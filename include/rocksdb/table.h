@@ -230,7 +230,30 @@ struct BlockBasedTableOptions {
     //    e.g. when prefix changes.
     // Makes the index significantly bigger (2x or more), especially when keys
     // are long.
-    kBinarySearchWithFirstKey = 0x03
+    kBinarySearchWithFirstKey = 0x03,
+
+    // EXPERIMENTAL
+    // Like kBinarySearch, with a piecewise linear model of the index keys
+    // stored next to the index block. Seek() in the index evaluates the model
+    // and binary searches a window of a few entries around its prediction.
+    // Works best for keys ordered by BytewiseComparator() whose leading bytes
+    // after a common prefix behave like integers, e.g. fixed width big-endian
+    // ids; for other keys the model is not built or has large errors, and
+    // lookups fall back to searching the whole index block.
+    // index_block_restart_interval is always 1 with this index type.
+    kLearnedIndexSearch = 0x04,
+
+    // EXPERIMENTAL
+    // The index keys are stored in a succinct trie (LOUDS-Sparse, as in
+    // SuRF) in a metablock, with the block handles packed next to it, and
+    // are searched in place. Keys sharing long prefixes, e.g. composite keys
+    // of a few tenants or tables, take much less space than in a
+    // prefix-compressed index block. The whole index is held in the table
+    // reader's memory, like the prefix metadata of kHashSearch. Only used for
+    // tables ordered by BytewiseComparator(), without user-defined
+    // timestamps, whose index keys don't need sequence numbers; other tables
+    // get a kBinarySearch index block.
+    kTrieIndexSearch = 0x05
   );
 
   IndexType index_type = kBinarySearch;
@@ -247,6 +270,18 @@ struct BlockBasedTableOptions {
   // kDataBlockBinaryAndHash.
   double data_block_hash_table_util_ratio = 0.75;
 
+  // EXPERIMENTAL
+  // If true, data blocks also store the first 8 bytes of each restart key, as
+  // integers in an array next to the restart array, at a cost of 8 bytes per
+  // restart point. Seeks within a data block search that array, with SIMD
+  // compares where available, and then only decode and compare the restart
+  // keys sharing their first 8 bytes with the target.
+  //
+  // Only used for tables ordered by BytewiseComparator() without
+  // user-defined timestamps. Data blocks written with it can not be read by
+  // older versions.
+  bool data_block_restart_key_prefixes = false;
+
   // Option hash_index_allow_collision is now deleted.
   // It will behave as if hash_index_allow_collision=true.
 
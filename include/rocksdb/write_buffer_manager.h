@@ -21,6 +21,7 @@
 #include "rocksdb/cache.h"
 
 namespace ROCKSDB_NAMESPACE {
+class ArenaBlockPool;
 class CacheReservationManager;
 
 // Interface to block and signal DB instances, intended for RocksDB
@@ -36,6 +37,10 @@ class StallInterface {
 
 class WriteBufferManager final {
  public:
+  // Memory of NUMA-aware memtables is accounted per node for up to this
+  // many nodes, see SetNumaNodeBufferSize().
+  static constexpr int kMaxNumaNodes = 8;
+
   // Parameters:
   // _buffer_size: _buffer_size = 0 indicates no limit. Memory won't be capped.
   // memory_usage() won't be valid and ShouldFlush() will always return true.
@@ -86,10 +91,50 @@ class WriteBufferManager final {
     assert(new_size > 0);
     buffer_size_.store(new_size, std::memory_order_relaxed);
     mutable_limit_.store(new_size * 7 / 8, std::memory_order_relaxed);
+    UpdateArenaBlockPoolCapacity();
     // Check if stall is active and can be ended.
     MaybeEndWriteStall();
   }
 
+  // Caps the memory of active memtables bound to any one NUMA node (see
+  // ColumnFamilyOptions::memtable_numa_aware) at node_size: once a node
+  // exceeds it, ShouldFlush() returns true even if the total is below
+  // buffer_size(). This keeps writers of one socket from filling their
+  // node while the other nodes are idle. 0 means no per-node limit.
+  // Only effective if enabled().
+  void SetNumaNodeBufferSize(size_t node_size) {
+    numa_node_buffer_size_.store(node_size, std::memory_order_relaxed);
+  }
+
+  size_t numa_node_buffer_size() const {
+    return numa_node_buffer_size_.load(std::memory_order_relaxed);
+  }
+
+  // Returns the memory of active memtables bound to NUMA node `node`.
+  size_t numa_node_memory_usage(int node) const {
+    return node >= 0 && node < kMaxNumaNodes
+               ? numa_node_memory_active_[node].load(std::memory_order_relaxed)
+               : 0;
+  }
+
+  // Keeps up to pool_size bytes of the arena blocks of freed memtables for
+  // reuse by new memtables, so that a memtable switch neither frees nor
+  // allocates and page faults in fresh memory. While pooling is enabled,
+  // regular arena blocks are mmap-ed and pre-faulted, and huge page blocks
+  // (see ColumnFamilyOptions::memtable_huge_page_size) are pooled as well.
+  // The pool never holds more than buffer_size() bytes if enabled(). Pooled
+  // blocks are not counted in memory_usage().
+  // 0 (the default) disables pooling.
+  void SetArenaBlockPoolSize(size_t pool_size);
+
+  size_t arena_block_pool_size() const {
+    return arena_block_pool_size_.load(std::memory_order_relaxed);
+  }
+
+  // Returns the pool of arena blocks shared by the memtables using this
+  // WriteBufferManager. Should only be called by RocksDB internally.
+  ArenaBlockPool* arena_block_pool() const { return arena_block_pool_.get(); }
+
   void SetAllowStall(bool new_allow_stall) {
     allow_stall_.store(new_allow_stall, std::memory_order_relaxed);
     MaybeEndWriteStall();
@@ -112,6 +157,9 @@ class WriteBufferManager final {
         // triggering more flush may not help. We will hold it instead.
         return true;
       }
+      if (IsNumaNodeLimitExceeded()) {
+        return true;
+      }
     }
     return false;
   }
@@ -149,6 +197,11 @@ class WriteBufferManager final {
 
   void FreeMem(size_t mem);
 
+  // Like ReserveMem and ScheduleFreeMem, for the part of the memory that is
+  // bound to NUMA node `node`. Called in addition to them.
+  void ReserveNumaNodeMem(size_t mem, int node);
+  void ScheduleFreeNumaNodeMem(size_t mem, int node);
+
   // Add the DB instance to the queue and block the DB.
   // Should only be called by RocksDB internally.
   void BeginWriteStall(StallInterface* wbm_stall);
@@ -169,6 +222,8 @@ class WriteBufferManager final {
   std::atomic<size_t> memory_active_;
   std::shared_ptr<Cache> cache_;
   std::shared_ptr<CacheReservationManager> cache_res_mgr_;
+  std::shared_ptr<ArenaBlockPool> arena_block_pool_;
+  std::atomic<size_t> arena_block_pool_size_;
   // Protects cache_res_mgr_
   std::mutex cache_res_mgr_mu_;
 
@@ -180,6 +235,26 @@ class WriteBufferManager final {
   // while holding mu_, but it can be read without a lock.
   std::atomic<bool> stall_active_;
 
+  std::atomic<size_t> numa_node_buffer_size_;
+  // Memory of active memtables on each NUMA node
+  std::atomic<size_t> numa_node_memory_active_[kMaxNumaNodes];
+
+  // Caps the pool at buffer_size()
+  void UpdateArenaBlockPoolCapacity();
+
+  bool IsNumaNodeLimitExceeded() const {
+    size_t limit = numa_node_buffer_size();
+    if (limit == 0) {
+      return false;
+    }
+    for (auto& usage : numa_node_memory_active_) {
+      if (usage.load(std::memory_order_relaxed) > limit) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   void ReserveMemWithCache(size_t mem);
   void FreeMemWithCache(size_t mem);
 };
@@ -39,7 +39,8 @@ class AllocTracker {
   void operator=(const AllocTracker&) = delete;
 
   ~AllocTracker();
-  void Allocate(size_t bytes);
+  // numa_node: the NUMA node the memory is bound to, or -1 if unknown.
+  void Allocate(size_t bytes, int numa_node = -1);
   // Call when we're finished allocating memory so we can free it from
   // the write buffer's limit.
   void DoneAllocating();
@@ -51,6 +52,9 @@ class AllocTracker {
  private:
   WriteBufferManager* write_buffer_manager_;
   std::atomic<size_t> bytes_allocated_;
+  // Part of bytes_allocated_ known to be on each NUMA node
+  std::atomic<size_t>
+      numa_bytes_allocated_[WriteBufferManager::kMaxNumaNodes];
   bool done_allocating_;
   bool freed_;
 };
@@ -13,6 +13,7 @@
 
 #include "logging/logging.h"
 #include "port/malloc.h"
+#include "port/numa.h"
 #include "port/port.h"
 #include "rocksdb/env.h"
 #include "test_util/sync_point.h"
@@ -33,8 +34,16 @@ size_t Arena::OptimizeBlockSize(size_t block_size) {
   return block_size;
 }
 
-Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size)
-    : kBlockSize(OptimizeBlockSize(block_size)), tracker_(tracker) {
+Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size,
+             int numa_node, ArenaBlockPool* block_pool,
+             bool transparent_huge_page)
+    : kBlockSize(OptimizeBlockSize(block_size)),
+      numa_node_(numa_node),
+      block_pool_(block_pool),
+      huge_page_kind_(transparent_huge_page
+                          ? ArenaBlockPool::Kind::kTransparentHuge
+                          : ArenaBlockPool::Kind::kHugeTlb),
+      tracker_(tracker) {
   assert(kBlockSize >= kMinBlockSize && kBlockSize <= kMaxBlockSize &&
          kBlockSize % kAlignUnit == 0);
   TEST_SYNC_POINT_CALLBACK("Arena::Arena:0", const_cast<size_t*>(&kBlockSize));
@@ -43,17 +52,23 @@ Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size)
   aligned_alloc_ptr_ = inline_block_;
   unaligned_alloc_ptr_ = inline_block_ + alloc_bytes_remaining_;
   if (MemMapping::kHugePageSupported) {
+    huge_page_size_ = huge_page_size;
     hugetlb_size_ = huge_page_size;
     if (hugetlb_size_ && kBlockSize > hugetlb_size_) {
       hugetlb_size_ = ((kBlockSize - 1U) / hugetlb_size_ + 1U) * hugetlb_size_;
     }
   }
   if (tracker_ != nullptr) {
-    tracker_->Allocate(kInlineSize);
+    tracker_->Allocate(kInlineSize, numa_node_);
   }
 }
 
 Arena::~Arena() {
+  if (block_pool_ != nullptr) {
+    for (auto& block : mapped_blocks_) {
+      block_pool_->Release(std::move(block));
+    }
+  }
   if (tracker_ != nullptr) {
     assert(tracker_->is_freed());
     tracker_->FreeMem();
@@ -73,7 +88,7 @@ char* Arena::AllocateFallback(size_t bytes, bool aligned) {
   char* block_head = nullptr;
   if (MemMapping::kHugePageSupported && hugetlb_size_ > 0) {
     size = hugetlb_size_;
-    block_head = AllocateFromHugePage(size);
+    block_head = AllocateFromHugePage(size, huge_page_size_);
   }
   if (!block_head) {
     size = kBlockSize;
@@ -92,14 +107,45 @@ char* Arena::AllocateFallback(size_t bytes, bool aligned) {
   }
 }
 
-char* Arena::AllocateFromHugePage(size_t bytes) {
-  MemMapping mm = MemMapping::AllocateHuge(bytes);
+char* Arena::AllocateFromHugePage(size_t bytes, size_t page_size) {
+  ArenaBlockPool::Block block;
+  bool reused = false;
+  // The pool does not know about NUMA nodes
+  bool ok =
+      block_pool_ != nullptr && numa_node_ < 0
+          ? block_pool_->Acquire(huge_page_kind_, page_size, bytes, &block,
+                                 &reused)
+          : ArenaBlockPool::Map(huge_page_kind_, page_size, bytes, &block);
+  if (!ok) {
+    ++huge_page_stats_.fallbacks;
+    return nullptr;
+  }
+  auto addr = static_cast<char*>(block.mapping.Get());
+  if (numa_node_ >= 0) {
+    port::NumaBindMemory(addr, bytes, numa_node_);
+  }
+  ++(reused ? huge_page_stats_.blocks_reused : huge_page_stats_.blocks_mapped);
+  huge_page_stats_.bytes += bytes;
+  mapped_blocks_.push_back(std::move(block));
+  blocks_memory_ += bytes;
+  if (tracker_ != nullptr) {
+    tracker_->Allocate(bytes, numa_node_);
+  }
+  return addr;
+}
+
+char* Arena::AllocateOnNumaNode(size_t bytes) {
+  // A private mapping is needed both for mbind, which works on whole pages,
+  // and for first touch, since malloc may return pages already faulted in
+  // by another thread.
+  MemMapping mm = MemMapping::AllocateLazyZeroed(bytes);
   auto addr = static_cast<char*>(mm.Get());
   if (addr) {
-    huge_blocks_.push_back(std::move(mm));
+    port::NumaBindMemory(addr, bytes, numa_node_);
+    numa_blocks_.push_back(std::move(mm));
     blocks_memory_ += bytes;
     if (tracker_ != nullptr) {
-      tracker_->Allocate(bytes);
+      tracker_->Allocate(bytes, numa_node_);
     }
   }
   return addr;
@@ -114,7 +160,7 @@ char* Arena::AllocateAligned(size_t bytes, size_t huge_page_size,
         ((bytes - 1U) / huge_page_size + 1U) * huge_page_size;
     assert(reserved_size >= bytes);
 
-    char* addr = AllocateFromHugePage(reserved_size);
+    char* addr = AllocateFromHugePage(reserved_size, huge_page_size);
     if (addr == nullptr) {
       ROCKS_LOG_WARN(logger,
                      "AllocateAligned fail to allocate huge TLB pages: %s",
@@ -142,7 +188,38 @@ char* Arena::AllocateAligned(size_t bytes, size_t huge_page_size,
   return result;
 }
 
+char* Arena::AllocateFromBlockPool(size_t bytes) {
+  ArenaBlockPool::Block block;
+  bool reused = false;
+  if (!block_pool_->Acquire(ArenaBlockPool::Kind::kRegular, 0, bytes, &block,
+                            &reused)) {
+    return nullptr;
+  }
+  auto addr = static_cast<char*>(block.mapping.Get());
+  mapped_blocks_.push_back(std::move(block));
+  blocks_memory_ += bytes;
+  if (tracker_ != nullptr) {
+    tracker_->Allocate(bytes, numa_node_);
+  }
+  return addr;
+}
+
 char* Arena::AllocateNewBlock(size_t block_bytes) {
+  if (numa_node_ >= 0) {
+    char* block = AllocateOnNumaNode(block_bytes);
+    if (block != nullptr) {
+      return block;
+    }
+    // fall back to malloc
+  } else if (block_pool_ != nullptr && block_bytes == kBlockSize &&
+             block_pool_->GetCapacity() > 0) {
+    // Only regular sized blocks are worth keeping
+    char* block = AllocateFromBlockPool(block_bytes);
+    if (block != nullptr) {
+      return block;
+    }
+    // fall back to malloc
+  }
   // NOTE: std::make_unique zero-initializes the block so is not appropriate
   // here
   char* block = new char[block_bytes];
@@ -162,7 +239,7 @@ char* Arena::AllocateNewBlock(size_t block_bytes) {
 #endif  // ROCKSDB_MALLOC_USABLE_SIZE
   blocks_memory_ += allocated_size;
   if (tracker_ != nullptr) {
-    tracker_->Allocate(allocated_size);
+    tracker_->Allocate(allocated_size, numa_node_);
   }
   return block;
 }
@@ -17,11 +17,31 @@
 #include <deque>
 
 #include "memory/allocator.h"
+#include "memory/arena_block_pool.h"
 #include "port/mmap.h"
 #include "rocksdb/env.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+// Huge page usage of an arena
+struct ArenaHugePageStats {
+  // Huge page blocks reused from the ArenaBlockPool
+  uint64_t blocks_reused = 0;
+  // Huge page blocks newly mapped
+  uint64_t blocks_mapped = 0;
+  // Huge page allocations that failed and fell back to malloc
+  uint64_t fallbacks = 0;
+  // Bytes of all huge page blocks
+  uint64_t bytes = 0;
+
+  void Add(const ArenaHugePageStats& other) {
+    blocks_reused += other.blocks_reused;
+    blocks_mapped += other.blocks_mapped;
+    fallbacks += other.fallbacks;
+    bytes += other.bytes;
+  }
+};
+
 class Arena : public Allocator {
  public:
   // No copying allowed
@@ -39,8 +59,18 @@ class Arena : public Allocator {
   // huge_page_size: if 0, don't use huge page TLB. If > 0 (should set to the
   // supported hugepage size of the system), block allocation will try huge
   // page TLB first. If allocation fails, will fall back to normal case.
+  // numa_node: if >= 0, blocks are mmap-ed and bound to that NUMA node (or
+  // placed by first touch if binding is not supported), and are accounted
+  // to that node in tracker.
+  // block_pool: if not nullptr, huge page blocks, and regular blocks while
+  // its capacity is not 0, are taken from and given back to it (except for
+  // NUMA node bound arenas).
+  // transparent_huge_page: use madvise(MADV_HUGEPAGE)-ed memory aligned to
+  // huge_page_size rather than MAP_HUGETLB for huge pages.
   explicit Arena(size_t block_size = kMinBlockSize,
-                 AllocTracker* tracker = nullptr, size_t huge_page_size = 0);
+                 AllocTracker* tracker = nullptr, size_t huge_page_size = 0,
+                 int numa_node = -1, ArenaBlockPool* block_pool = nullptr,
+                 bool transparent_huge_page = false);
   ~Arena();
 
   char* Allocate(size_t bytes) override;
@@ -78,8 +108,14 @@ class Arena : public Allocator {
 
   size_t BlockSize() const override { return kBlockSize; }
 
+  int NumaNode() const { return numa_node_; }
+
+  const ArenaHugePageStats& GetHugePageStats() const {
+    return huge_page_stats_;
+  }
+
   bool IsInInlineBlock() const {
-    return blocks_.empty() && huge_blocks_.empty();
+    return blocks_.empty() && mapped_blocks_.empty() && numa_blocks_.empty();
   }
 
   // check and adjust the block_size so that the return value is
@@ -93,8 +129,10 @@ class Arena : public Allocator {
   const size_t kBlockSize;
   // Allocated memory blocks
   std::deque<std::unique_ptr<char[]>> blocks_;
-  // Huge page allocations
-  std::deque<MemMapping> huge_blocks_;
+  // Huge page allocations and regular blocks from block_pool_
+  std::deque<ArenaBlockPool::Block> mapped_blocks_;
+  // NUMA node bound allocations
+  std::deque<MemMapping> numa_blocks_;
   size_t irregular_block_num = 0;
 
   // Stats for current active block.
@@ -107,9 +145,19 @@ class Arena : public Allocator {
   // How many bytes left in currently active block?
   size_t alloc_bytes_remaining_ = 0;
 
+  // Huge page size, and block size when using huge pages
+  size_t huge_page_size_ = 0;
   size_t hugetlb_size_ = 0;
 
-  char* AllocateFromHugePage(size_t bytes);
+  const int numa_node_;
+
+  ArenaBlockPool* const block_pool_;
+  const ArenaBlockPool::Kind huge_page_kind_;
+  ArenaHugePageStats huge_page_stats_;
+
+  char* AllocateFromHugePage(size_t bytes, size_t page_size);
+  char* AllocateOnNumaNode(size_t bytes);
+  char* AllocateFromBlockPool(size_t bytes);
   char* AllocateFallback(size_t bytes, bool aligned);
   char* AllocateNewBlock(size_t block_bytes);
 
@@ -0,0 +1,97 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "memory/arena_block_pool.h"
+
+#include <cassert>
+#include <utility>
+
+namespace ROCKSDB_NAMESPACE {
+
+bool ArenaBlockPool::Map(Kind kind, size_t page_size, size_t bytes,
+                         Block* block) {
+  assert(kind == Kind::kRegular || page_size == 0 || bytes % page_size == 0);
+  block->kind = kind;
+  block->page_size = page_size;
+  switch (kind) {
+    case Kind::kHugeTlb:
+      if (!MemMapping::kHugePageSupported) {
+        return false;
+      }
+      block->mapping = MemMapping::AllocateHuge(bytes, page_size);
+      break;
+    case Kind::kTransparentHuge:
+      block->mapping = MemMapping::AllocateTransparentHuge(bytes, page_size);
+      break;
+    case Kind::kRegular:
+      block->page_size = 0;
+      block->mapping = MemMapping::AllocatePrefaulted(bytes);
+      break;
+  }
+  return block->mapping.Get() != nullptr;
+}
+
+bool ArenaBlockPool::Acquire(Kind kind, size_t page_size, size_t bytes,
+                             Block* block, bool* reused) {
+  *reused = false;
+  if (kind == Kind::kRegular) {
+    page_size = 0;
+  }
+  if (free_bytes_.load(std::memory_order_relaxed) > 0) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = free_blocks_.find(Key(kind, page_size, bytes));
+    if (it != free_blocks_.end() && !it->second.empty()) {
+      block->kind = kind;
+      block->page_size = page_size;
+      block->mapping = std::move(it->second.back());
+      it->second.pop_back();
+      free_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+      *reused = true;
+      return true;
+    }
+  }
+  return Map(kind, page_size, bytes, block);
+}
+
+void ArenaBlockPool::Release(Block&& block) {
+  size_t bytes = block.mapping.Length();
+  if (block.mapping.Get() == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mu_);
+  if (free_bytes_.load(std::memory_order_relaxed) + bytes > GetCapacity()) {
+    // unmapped by the owner of block
+    return;
+  }
+  free_blocks_[Key(block.kind, block.page_size, bytes)].push_back(
+      std::move(block.mapping));
+  free_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void ArenaBlockPool::SetCapacity(size_t capacity) {
+  capacity_.store(capacity, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(mu_);
+  EvictLocked(capacity);
+}
+
+void ArenaBlockPool::EvictLocked(size_t capacity) {
+  for (auto it = free_blocks_.begin();
+       it != free_blocks_.end() &&
+       free_bytes_.load(std::memory_order_relaxed) > capacity;) {
+    auto& blocks = it->second;
+    while (!blocks.empty() &&
+           free_bytes_.load(std::memory_order_relaxed) > capacity) {
+      free_bytes_.fetch_sub(blocks.back().Length(), std::memory_order_relaxed);
+      blocks.pop_back();
+    }
+    if (blocks.empty()) {
+      it = free_blocks_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
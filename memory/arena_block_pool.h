@@ -0,0 +1,83 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include "port/mmap.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A pool of mmap-ed arena blocks. Arenas draw their huge page blocks, and
+// while the pool has a non-zero capacity also their regular blocks, from it
+// and give them back when destroyed, so that a memtable switch reuses the
+// already faulted-in blocks of a flushed memtable instead of freeing them
+// and faulting in new ones.  One pool is shared by all the memtables of a
+// WriteBufferManager.  Thread-safe.
+class ArenaBlockPool {
+ public:
+  enum class Kind : uint8_t {
+    // MAP_HUGETLB, needs reserved huge pages (vm.nr_hugepages)
+    kHugeTlb,
+    // madvise(MADV_HUGEPAGE), backed by huge pages at the kernel's discretion
+    kTransparentHuge,
+    // Regular pages, pre-faulted when mapped
+    kRegular,
+  };
+
+  struct Block {
+    Kind kind = Kind::kHugeTlb;
+    size_t page_size = 0;
+    MemMapping mapping = MemMapping::AllocateLazyZeroed(0);
+  };
+
+  // capacity: max bytes of free blocks kept, 0 means no caching
+  explicit ArenaBlockPool(size_t capacity = 0) : capacity_(capacity) {}
+
+  // Maps a new block of bytes (a multiple of page_size) without any pool.
+  // page_size is ignored for kRegular. Returns false if the memory could not
+  // be mapped, e.g. when no huge pages are reserved.
+  static bool Map(Kind kind, size_t page_size, size_t bytes, Block* block);
+
+  // Like Map, but reuses a free block of the same kind and size if there
+  // is one, in which case *reused is set to true.
+  bool Acquire(Kind kind, size_t page_size, size_t bytes, Block* block,
+               bool* reused);
+
+  // Keeps block for reuse if the capacity allows, otherwise unmaps it.
+  void Release(Block&& block);
+
+  // Unmaps free blocks until at most capacity bytes are kept
+  void SetCapacity(size_t capacity);
+
+  size_t GetCapacity() const {
+    return capacity_.load(std::memory_order_relaxed);
+  }
+
+  // Bytes of the free blocks
+  size_t GetFreeBytes() const {
+    return free_bytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // kind, page size, block size
+  using Key = std::tuple<Kind, size_t, size_t>;
+
+  void EvictLocked(size_t capacity);
+
+  std::atomic<size_t> capacity_;
+  std::atomic<size_t> free_bytes_{0};
+  std::mutex mu_;
+  std::map<Key, std::vector<MemMapping>> free_blocks_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -12,7 +12,14 @@
 #ifndef OS_WIN
 #include <sys/resource.h>
 #endif
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "memory/concurrent_arena.h"
+#include "port/numa.h"
 #include "port/port.h"
+#include "rocksdb/write_buffer_manager.h"
 #include "test_util/testharness.h"
 #include "util/random.h"
 
@@ -286,6 +293,170 @@ TEST_F(ArenaTest, UnmappedAllocation) {
   }
 }
 
+TEST(MmapTest, AllocateTransparentHuge) {
+  if (!MemMapping::kHugePageSupported) {
+    ROCKSDB_GTEST_SKIP("Huge pages not supported");
+    return;
+  }
+  const size_t kPageSize = kHugePageSize;
+  MemMapping mm = MemMapping::AllocateTransparentHuge(3 * kPageSize, kPageSize);
+  ASSERT_NE(mm.Get(), nullptr);
+  ASSERT_EQ(3 * kPageSize, mm.Length());
+  ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(mm.Get()) % kPageSize);
+  memset(mm.Get(), 1, mm.Length());
+}
+
+TEST_F(ArenaTest, HugePageBlockPool) {
+  if (!MemMapping::kHugePageSupported) {
+    ROCKSDB_GTEST_SKIP("Huge pages not supported");
+    return;
+  }
+  // Transparent huge pages need no reserved huge pages
+  const size_t kBlockSize = 256 * 1024;
+  const size_t kAllocSize = kBlockSize / 4;
+  const size_t kAllocsPerHugePage = kHugePageSize / kAllocSize;
+  ArenaBlockPool pool(4 * kHugePageSize);
+  {
+    Arena arena(kBlockSize, nullptr, kHugePageSize, -1 /*numa_node*/, &pool,
+                true /*transparent_huge_page*/);
+    for (size_t i = 0; i < 3 * kAllocsPerHugePage; ++i) {
+      memset(arena.Allocate(kAllocSize), static_cast<int>(i), kAllocSize);
+    }
+    const ArenaHugePageStats& stats = arena.GetHugePageStats();
+    ASSERT_EQ(3U, stats.blocks_mapped);
+    ASSERT_EQ(0U, stats.blocks_reused);
+    ASSERT_EQ(0U, stats.fallbacks);
+    ASSERT_EQ(3 * kHugePageSize, stats.bytes);
+    ASSERT_EQ(0U, pool.GetFreeBytes());
+  }
+  // returned to the pool
+  ASSERT_EQ(3 * kHugePageSize, pool.GetFreeBytes());
+  {
+    Arena arena(kBlockSize, nullptr, kHugePageSize, -1 /*numa_node*/, &pool,
+                true /*transparent_huge_page*/);
+    for (size_t i = 0; i < 4 * kAllocsPerHugePage; ++i) {
+      memset(arena.Allocate(kAllocSize), static_cast<int>(i), kAllocSize);
+    }
+    const ArenaHugePageStats& stats = arena.GetHugePageStats();
+    ASSERT_EQ(3U, stats.blocks_reused);
+    ASSERT_EQ(1U, stats.blocks_mapped);
+    ASSERT_EQ(0U, pool.GetFreeBytes());
+  }
+  // only up to the capacity is kept
+  ASSERT_EQ(4 * kHugePageSize, pool.GetFreeBytes());
+  pool.SetCapacity(kHugePageSize);
+  ASSERT_EQ(kHugePageSize, pool.GetFreeBytes());
+  pool.SetCapacity(0);
+  ASSERT_EQ(0U, pool.GetFreeBytes());
+}
+
+TEST_F(ArenaTest, RegularBlockPool) {
+  const size_t kBlockSize = 64 * 1024;
+  const size_t kAllocSize = kBlockSize / 4;
+  ArenaBlockPool pool;
+  {
+    // no capacity, blocks are malloc-ed
+    Arena arena(kBlockSize, nullptr, 0, -1 /*numa_node*/, &pool);
+    for (int i = 0; i < 8; ++i) {
+      arena.Allocate(kAllocSize);
+    }
+  }
+  ASSERT_EQ(0U, pool.GetFreeBytes());
+
+  pool.SetCapacity(4 * kBlockSize);
+  {
+    Arena arena(kBlockSize, nullptr, 0, -1 /*numa_node*/, &pool);
+    for (int i = 0; i < 4 * 4; ++i) {
+      memset(arena.Allocate(kAllocSize), i, kAllocSize);
+    }
+    // irregular blocks are not pooled
+    arena.Allocate(kBlockSize);
+    ASSERT_EQ(0U, pool.GetFreeBytes());
+  }
+  ASSERT_EQ(4 * kBlockSize, pool.GetFreeBytes());
+  {
+    Arena arena(kBlockSize, nullptr, 0, -1 /*numa_node*/, &pool);
+    for (int i = 0; i < 2 * 4; ++i) {
+      arena.Allocate(kAllocSize);
+    }
+    ASSERT_EQ(2 * kBlockSize, pool.GetFreeBytes());
+  }
+  ASSERT_EQ(4 * kBlockSize, pool.GetFreeBytes());
+}
+
+TEST(MmapTest, AllocatePrefaulted) {
+  const size_t kLength = 1024 * 1024 + 100;
+  MemMapping mm = MemMapping::AllocatePrefaulted(kLength);
+  ASSERT_NE(mm.Get(), nullptr);
+  ASSERT_EQ(kLength, mm.Length());
+  // zero-initialized
+  const char* p = static_cast<const char*>(mm.Get());
+  for (size_t i = 0; i < kLength; i += 512) {
+    ASSERT_EQ(0, p[i]);
+  }
+}
+
+TEST_F(ArenaTest, NumaNodeArena) {
+  // Works on any host, without NUMA support the blocks are just mmap-ed
+  WriteBufferManager wbm(64 << 20);
+  AllocTracker tracker(&wbm);
+  {
+    const int node = port::NumaNumNodes() - 1;
+    Arena arena(Arena::kMinBlockSize, &tracker, 0 /*huge_page_size*/, node);
+    ASSERT_EQ(node, arena.NumaNode());
+    for (size_t i = 1; i < 3000; ++i) {
+      char* p = (i % 2) ? arena.Allocate(i) : arena.AllocateAligned(i);
+      memset(p, static_cast<int>(i & 255), i);
+    }
+    ASSERT_GT(arena.MemoryAllocatedBytes(), size_t{3000});
+    // everything is accounted to the node
+    ASSERT_EQ(wbm.memory_usage(), arena.MemoryAllocatedBytes());
+    ASSERT_EQ(wbm.memory_usage(), wbm.numa_node_memory_usage(node));
+
+    tracker.DoneAllocating();
+    ASSERT_EQ(0U, wbm.numa_node_memory_usage(node));
+    tracker.FreeMem();
+  }
+  ASSERT_EQ(0U, wbm.memory_usage());
+}
+
+TEST_F(ArenaTest, ConcurrentArenaNumaAware) {
+  // On a single node host this is the regular ConcurrentArena
+  ConcurrentArena arena(64 << 10, nullptr /*tracker*/, 0 /*huge_page_size*/,
+                        true /*numa_aware*/);
+  ASSERT_EQ(port::NumaNumNodes() > 1, arena.IsNumaAware());
+  const int kThreads = 8;
+  const int kAllocs = 10000;
+  std::vector<std::vector<std::pair<char*, size_t>>> allocs(kThreads);
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&arena, &allocs, t]() {
+      Random rnd(t + 1);
+      for (int i = 0; i < kAllocs; ++i) {
+        size_t bytes = 1 + rnd.Uniform(200);
+        char* p = rnd.OneIn(2) ? arena.Allocate(bytes)
+                               : arena.AllocateAligned(bytes);
+        memset(p, t, bytes);
+        allocs[t].emplace_back(p, bytes);
+      }
+    });
+  }
+  size_t total = 0;
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (int t = 0; t < kThreads; ++t) {
+    for (auto& a : allocs[t]) {
+      for (size_t i = 0; i < a.second; ++i) {
+        ASSERT_EQ(static_cast<char>(t), a.first[i]);
+      }
+      total += a.second;
+    }
+  }
+  ASSERT_GE(arena.ApproximateMemoryUsage(), total);
+  ASSERT_GE(arena.MemoryAllocatedBytes(), total + arena.AllocatedAndUnused());
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
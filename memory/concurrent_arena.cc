@@ -11,6 +11,7 @@
 
 #include <thread>
 
+#include "port/numa.h"
 #include "port/port.h"
 #include "util/random.h"
 
@@ -27,13 +28,73 @@ const size_t kMaxShardBlockSize = size_t{128 * 1024};
 }  // namespace
 
 ConcurrentArena::ConcurrentArena(size_t block_size, AllocTracker* tracker,
-                                 size_t huge_page_size)
+                                 size_t huge_page_size, bool numa_aware,
+                                 ArenaBlockPool* block_pool,
+                                 bool transparent_huge_page)
     : shard_block_size_(std::min(kMaxShardBlockSize, block_size / 8)),
       shards_(),
-      arena_(block_size, tracker, huge_page_size) {
+      arena_(block_size, tracker, huge_page_size, -1 /*numa_node*/,
+             block_pool, transparent_huge_page),
+      numa_memory_allocated_bytes_(0),
+      numa_allocated_and_unused_(0),
+      block_size_(block_size),
+      huge_page_size_(huge_page_size),
+      tracker_(tracker),
+      block_pool_(block_pool),
+      transparent_huge_page_(transparent_huge_page) {
+  const int num_nodes = port::NumaNumNodes();
+  if (numa_aware && num_nodes > 1) {
+    numa_arenas_.reset(new NumaNodeArena[num_nodes]);
+    shard_numa_node_.reset(new int[shards_.Size()]);
+    for (size_t i = 0; i < shards_.Size(); ++i) {
+      shard_numa_node_[i] =
+          std::min(port::NumaNodeOfCpu(static_cast<int>(i)), num_nodes - 1);
+    }
+  }
   Fixup();
 }
 
+char* ConcurrentArena::AllocateFromNumaNode(int node, size_t bytes) {
+  NumaNodeArena& node_arena = numa_arenas_[node];
+  std::lock_guard<SpinMutex> lock(node_arena.mutex);
+  if (!node_arena.arena) {
+    node_arena.arena.reset(new Arena(block_size_, tracker_, huge_page_size_,
+                                     node, block_pool_,
+                                     transparent_huge_page_));
+    numa_memory_allocated_bytes_.fetch_add(
+        node_arena.arena->MemoryAllocatedBytes(), std::memory_order_relaxed);
+    numa_allocated_and_unused_.fetch_add(
+        node_arena.arena->AllocatedAndUnused(), std::memory_order_relaxed);
+  }
+  Arena* arena = node_arena.arena.get();
+  size_t allocated = arena->MemoryAllocatedBytes();
+  size_t unused = arena->AllocatedAndUnused();
+  char* rv = arena->AllocateAligned(bytes);
+  numa_memory_allocated_bytes_.fetch_add(
+      arena->MemoryAllocatedBytes() - allocated, std::memory_order_relaxed);
+  numa_allocated_and_unused_.fetch_add(arena->AllocatedAndUnused(),
+                                       std::memory_order_relaxed);
+  numa_allocated_and_unused_.fetch_sub(unused, std::memory_order_relaxed);
+  return rv;
+}
+
+ArenaHugePageStats ConcurrentArena::GetHugePageStats() const {
+  ArenaHugePageStats stats;
+  {
+    std::lock_guard<SpinMutex> lock(arena_mutex_);
+    stats = arena_.GetHugePageStats();
+  }
+  if (IsNumaAware()) {
+    for (int node = 0; node < port::NumaNumNodes(); ++node) {
+      std::lock_guard<SpinMutex> lock(numa_arenas_[node].mutex);
+      if (numa_arenas_[node].arena) {
+        stats.Add(numa_arenas_[node].arena->GetHugePageStats());
+      }
+    }
+  }
+  return stats;
+}
+
 ConcurrentArena::Shard* ConcurrentArena::Repick() {
   auto shard_and_index = shards_.AccessElementAndIndex();
   // even if we are cpu 0, use a non-zero tls_cpuid so we can tell we
@@ -39,15 +39,23 @@ class Logger;
 // only if ConcurrentArena actually notices concurrent use, and they
 // adjust their size so that there is no fragmentation waste when the
 // shard blocks are allocated from the underlying main arena.
+//
+// In NUMA-aware mode the shards instead refill from one arena per NUMA
+// node, whose blocks are bound to that node, and each shard uses the node
+// of its core.  So a writer allocates memtable nodes local to its socket.
 class ConcurrentArena : public Allocator {
  public:
-  // block_size and huge_page_size are the same as for Arena (and are
-  // in fact just passed to the constructor of arena_.  The core-local
-  // shards compute their shard_block_size as a fraction of block_size
-  // that varies according to the hardware concurrency level.
+  // block_size, huge_page_size, block_pool and transparent_huge_page are
+  // the same as for Arena (and are in fact just passed to the constructor
+  // of arena_.  The core-local shards compute their shard_block_size as a
+  // fraction of block_size that varies according to the hardware
+  // concurrency level.
+  // numa_aware has no effect on a single node host.
   explicit ConcurrentArena(size_t block_size = Arena::kMinBlockSize,
                            AllocTracker* tracker = nullptr,
-                           size_t huge_page_size = 0);
+                           size_t huge_page_size = 0, bool numa_aware = false,
+                           ArenaBlockPool* block_pool = nullptr,
+                           bool transparent_huge_page = false);
 
   char* Allocate(size_t bytes) override {
     return AllocateImpl(bytes, false /*force_arena*/,
@@ -70,15 +78,20 @@ class ConcurrentArena : public Allocator {
   size_t ApproximateMemoryUsage() const {
     std::unique_lock<SpinMutex> lock(arena_mutex_, std::defer_lock);
     lock.lock();
-    return arena_.ApproximateMemoryUsage() - ShardAllocatedAndUnused();
+    return arena_.ApproximateMemoryUsage() +
+           numa_memory_allocated_bytes_.load(std::memory_order_relaxed) -
+           numa_allocated_and_unused_.load(std::memory_order_relaxed) -
+           ShardAllocatedAndUnused();
   }
 
   size_t MemoryAllocatedBytes() const {
-    return memory_allocated_bytes_.load(std::memory_order_relaxed);
+    return memory_allocated_bytes_.load(std::memory_order_relaxed) +
+           numa_memory_allocated_bytes_.load(std::memory_order_relaxed);
   }
 
   size_t AllocatedAndUnused() const {
     return arena_allocated_and_unused_.load(std::memory_order_relaxed) +
+           numa_allocated_and_unused_.load(std::memory_order_relaxed) +
            ShardAllocatedAndUnused();
   }
 
@@ -88,6 +101,18 @@ class ConcurrentArena : public Allocator {
 
   size_t BlockSize() const override { return arena_.BlockSize(); }
 
+  // Sum over the underlying arenas
+  ArenaHugePageStats GetHugePageStats() const;
+
+  bool IsNumaAware() const { return numa_arenas_ != nullptr; }
+
+  // NUMA node whose arena the shard of core_idx refills from
+  int ShardNumaNode(size_t core_idx) const {
+    return IsNumaAware()
+               ? shard_numa_node_[core_idx & (shards_.Size() - 1)]
+               : 0;
+  }
+
  private:
   struct Shard {
     char padding[40] ROCKSDB_FIELD_UNUSED;
@@ -112,10 +137,28 @@ class ConcurrentArena : public Allocator {
   std::atomic<size_t> memory_allocated_bytes_;
   std::atomic<size_t> irregular_block_num_;
 
+  // NUMA-aware mode only, nullptr otherwise
+  struct NumaNodeArena {
+    mutable SpinMutex mutex;
+    // created on first use
+    std::unique_ptr<Arena> arena;
+  };
+  std::unique_ptr<NumaNodeArena[]> numa_arenas_;
+  std::unique_ptr<int[]> shard_numa_node_;
+  std::atomic<size_t> numa_memory_allocated_bytes_;
+  std::atomic<size_t> numa_allocated_and_unused_;
+  const size_t block_size_;
+  const size_t huge_page_size_;
+  AllocTracker* const tracker_;
+  ArenaBlockPool* const block_pool_;
+  const bool transparent_huge_page_;
+
   char padding1[56] ROCKSDB_FIELD_UNUSED;
 
   Shard* Repick();
 
+  char* AllocateFromNumaNode(int node, size_t bytes);
+
   size_t ShardAllocatedAndUnused() const {
     size_t total = 0;
     for (size_t i = 0; i < shards_.Size(); ++i) {
@@ -151,12 +194,18 @@ class ConcurrentArena : public Allocator {
     Shard* s = shards_.AccessAtCore(cpu & (shards_.Size() - 1));
     if (!s->mutex.try_lock()) {
       s = Repick();
+      cpu = tls_cpuid;
       s->mutex.lock();
     }
     std::unique_lock<SpinMutex> lock(s->mutex, std::adopt_lock);
 
     size_t avail = s->allocated_and_unused_.load(std::memory_order_relaxed);
-    if (avail < bytes) {
+    if (avail < bytes && IsNumaAware()) {
+      // reload from the arena of the shard's node, the main arena is only
+      // used for the large allocations above
+      avail = shard_block_size_;
+      s->free_begin_ = AllocateFromNumaNode(ShardNumaNode(cpu), avail);
+    } else if (avail < bytes) {
       // reload
       std::lock_guard<SpinMutex> reload_lock(arena_mutex_);
 
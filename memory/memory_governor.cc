@@ -0,0 +1,346 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/memory_governor.h"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <vector>
+
+#include "logging/logging.h"
+#include "port/port.h"
+#include "rocksdb/advanced_cache.h"
+#include "rocksdb/env.h"
+#include "rocksdb/statistics.h"
+#include "rocksdb/system_clock.h"
+#include "rocksdb/write_buffer_manager.h"
+#include "util/mutexlock.h"
+#include "util/timer.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+enum Consumer : int { kBlockCache, kRowCache, kWriteBuffer, kNumConsumers };
+
+const char* const kConsumerNames[kNumConsumers] = {"block cache", "row cache",
+                                                   "write buffers"};
+
+// Tickers read on each rebalance, for the change since the last one
+enum LastTicker : int {
+  kBlockCacheHit,
+  kBlockCacheMiss,
+  kRowCacheHit,
+  kRowCacheMiss,
+  kStallMicros,
+  kNumLastTickers
+};
+
+const Tickers kLastTickers[kNumLastTickers] = {
+    BLOCK_CACHE_HIT, BLOCK_CACHE_MISS, ROW_CACHE_HIT, ROW_CACHE_MISS,
+    STALL_MICROS};
+
+// Memory only moves between caches for this much more gain than loss, so
+// that it does not go back and forth on noise
+constexpr double kHysteresis = 0.1;
+
+class MemoryGovernorImpl : public MemoryGovernor {
+ public:
+  explicit MemoryGovernorImpl(const MemoryGovernorOptions& options);
+  ~MemoryGovernorImpl() override;
+
+  Status Init();
+
+  void Rebalance() override;
+  void SetTotalBudget(size_t total_budget) override;
+  size_t GetTotalBudget() const override;
+  Split GetSplit() const override;
+
+ private:
+  bool IsPresent(int consumer) const { return present_[consumer]; }
+
+  // Estimated hits gained (and lost) over the last period by growing (and
+  // shrinking) a cache by one step
+  struct CacheSignal {
+    double gain = 0;
+    double loss = 0;
+  };
+  CacheSignal GetCacheSignal(Cache* cache, size_t share, size_t step,
+                             uint64_t hits, uint64_t misses) const;
+
+  // Sets the sizes of the consumers to their shares.
+  // REQUIRES: mutex_ held
+  void ApplyShares();
+
+  const MemoryGovernorOptions options_;
+  std::array<bool, kNumConsumers> present_;
+  std::unique_ptr<Timer> timer_;
+
+  mutable port::Mutex mutex_;
+  size_t total_budget_ = 0;
+  std::array<size_t, kNumConsumers> shares_{};
+  std::array<uint64_t, kNumLastTickers> last_tickers_{};
+};
+
+MemoryGovernorImpl::MemoryGovernorImpl(const MemoryGovernorOptions& options)
+    : options_(options),
+      present_({options.block_cache != nullptr, options.row_cache != nullptr,
+                options.write_buffer_manager != nullptr}) {}
+
+MemoryGovernorImpl::~MemoryGovernorImpl() {
+  if (timer_) {
+    timer_->Shutdown();
+  }
+}
+
+Status MemoryGovernorImpl::Init() {
+  if (options_.statistics == nullptr) {
+    return Status::InvalidArgument("MemoryGovernor requires statistics");
+  }
+  int num_present =
+      static_cast<int>(std::count(present_.begin(), present_.end(), true));
+  if (!(options_.step_fraction > 0 && options_.step_fraction <= 1) ||
+      !(options_.min_fraction >= 0 &&
+        options_.min_fraction * std::max(num_present, 1) <= 1)) {
+    return Status::InvalidArgument(
+        "MemoryGovernor step_fraction or min_fraction out of range");
+  }
+
+  // Initial split from the current sizes
+  std::array<size_t, kNumConsumers> sizes{};
+  WriteBufferManager* wbm = options_.write_buffer_manager.get();
+  if (IsPresent(kWriteBuffer)) {
+    sizes[kWriteBuffer] = wbm->buffer_size();
+  }
+  if (IsPresent(kBlockCache)) {
+    sizes[kBlockCache] = options_.block_cache->GetCapacity();
+    if (IsPresent(kWriteBuffer) && wbm->cost_to_cache()) {
+      sizes[kBlockCache] -=
+          std::min(sizes[kBlockCache], sizes[kWriteBuffer]);
+    }
+  }
+  if (IsPresent(kRowCache)) {
+    sizes[kRowCache] = options_.row_cache->GetCapacity();
+  }
+  size_t total_size = 0;
+  for (size_t size : sizes) {
+    total_size += size;
+  }
+  size_t total_budget =
+      options_.total_budget > 0 ? options_.total_budget : total_size;
+  if (total_budget == 0) {
+    return Status::InvalidArgument(
+        "MemoryGovernor requires total_budget or sized consumers");
+  }
+
+  MutexLock l(&mutex_);
+  total_budget_ = total_budget;
+  size_t assigned = 0;
+  for (int c = 0; c < kNumConsumers; ++c) {
+    if (IsPresent(c)) {
+      shares_[c] = total_size > 0 ? static_cast<size_t>(
+                                        static_cast<double>(sizes[c]) /
+                                        total_size * total_budget)
+                                  : total_budget / num_present;
+      assigned += shares_[c];
+    }
+  }
+  // Rounding, then minimum shares, at the expense of the largest share
+  auto largest = std::max_element(shares_.begin(), shares_.end());
+  *largest += total_budget - std::min(assigned, total_budget);
+  size_t min_share =
+      static_cast<size_t>(options_.min_fraction * total_budget_);
+  for (int c = 0; c < kNumConsumers; ++c) {
+    if (IsPresent(c) && shares_[c] < min_share) {
+      largest = std::max_element(shares_.begin(), shares_.end());
+      *largest -= min_share - shares_[c];
+      shares_[c] = min_share;
+    }
+  }
+  for (int i = 0; i < kNumLastTickers; ++i) {
+    last_tickers_[i] = options_.statistics->getTickerCount(kLastTickers[i]);
+  }
+  ApplyShares();
+
+  if (options_.rebalance_period_sec > 0) {
+    SystemClock* clock = options_.clock ? options_.clock.get()
+                                        : SystemClock::Default().get();
+    uint64_t period_us = options_.rebalance_period_sec * 1000000;
+    timer_.reset(new Timer(clock));
+    timer_->Add([this]() { Rebalance(); }, "MemoryGovernor::Rebalance",
+                period_us, period_us);
+    timer_->Start();
+  }
+  return Status::OK();
+}
+
+MemoryGovernorImpl::CacheSignal MemoryGovernorImpl::GetCacheSignal(
+    Cache* cache, size_t share, size_t step, uint64_t hits,
+    uint64_t misses) const {
+  CacheSignal signal;
+  uint64_t lookups = hits + misses;
+  std::vector<double> hit_ratios;
+  if (lookups > 0 &&
+      cache->EstimateHitRatios({share - std::min(share, step), share,
+                                share + step},
+                               &hit_ratios)) {
+    signal.gain = (hit_ratios[2] - hit_ratios[1]) * lookups;
+    signal.loss = (hit_ratios[1] - hit_ratios[0]) * lookups;
+  } else {
+    // Without a miss ratio curve, assume the misses would shrink (or grow)
+    // in proportion to the capacity
+    signal.gain = static_cast<double>(misses) * step / std::max(share, step);
+    signal.loss = signal.gain;
+  }
+  return signal;
+}
+
+void MemoryGovernorImpl::Rebalance() {
+  MutexLock l(&mutex_);
+  std::array<uint64_t, kNumLastTickers> deltas;
+  for (int i = 0; i < kNumLastTickers; ++i) {
+    uint64_t count = options_.statistics->getTickerCount(kLastTickers[i]);
+    // (The Statistics might have been reset)
+    deltas[i] = count - std::min(count, last_tickers_[i]);
+    last_tickers_[i] = count;
+  }
+
+  size_t step = std::max(
+      size_t{1}, static_cast<size_t>(options_.step_fraction * total_budget_));
+  size_t min_share =
+      static_cast<size_t>(options_.min_fraction * total_budget_);
+  auto can_shrink = [&](int c) {
+    return IsPresent(c) && shares_[c] >= min_share + step;
+  };
+
+  std::array<CacheSignal, kNumConsumers> signals;
+  if (IsPresent(kBlockCache)) {
+    signals[kBlockCache] = GetCacheSignal(
+        options_.block_cache.get(), shares_[kBlockCache], step,
+        deltas[kBlockCacheHit], deltas[kBlockCacheMiss]);
+  }
+  if (IsPresent(kRowCache)) {
+    signals[kRowCache] =
+        GetCacheSignal(options_.row_cache.get(), shares_[kRowCache], step,
+                       deltas[kRowCacheHit], deltas[kRowCacheMiss]);
+  }
+  // The caches that would lose the least, and gain the most, from a step
+  int cheapest = -1;
+  int neediest = -1;
+  for (int c : {kBlockCache, kRowCache}) {
+    if (can_shrink(c) &&
+        (cheapest < 0 || signals[c].loss < signals[cheapest].loss)) {
+      cheapest = c;
+    }
+    if (IsPresent(c) && signals[c].gain > 0 &&
+        (neediest < 0 || signals[c].gain > signals[neediest].gain)) {
+      neediest = c;
+    }
+  }
+
+  int from = -1;
+  int to = -1;
+  bool write_pressure = false;
+  if (IsPresent(kWriteBuffer)) {
+    // Writes stalled, or memtables at the flush trigger (7/8 of the buffer
+    // size) so that memtable sizes are limited by the write buffers
+    WriteBufferManager* wbm = options_.write_buffer_manager.get();
+    size_t usage = wbm->memory_usage();
+    write_pressure = deltas[kStallMicros] > 0 || wbm->IsStallActive() ||
+                     usage >= shares_[kWriteBuffer] / 8 * 7;
+    if (write_pressure) {
+      from = cheapest;
+      to = kWriteBuffer;
+    } else if (usage < shares_[kWriteBuffer] / 2 &&
+               can_shrink(kWriteBuffer)) {
+      from = kWriteBuffer;
+      to = neediest;
+    }
+  }
+  if (!write_pressure && (from < 0 || to < 0) && cheapest >= 0 &&
+      neediest >= 0 && cheapest != neediest &&
+      signals[neediest].gain >
+          signals[cheapest].loss * (1 + kHysteresis)) {
+    from = cheapest;
+    to = neediest;
+  }
+  if (from < 0 || to < 0) {
+    return;
+  }
+  shares_[from] -= step;
+  shares_[to] += step;
+  ApplyShares();
+  ROCKS_LOG_INFO(options_.info_log.get(),
+                 "[MemoryGovernor] Moved %" ROCKSDB_PRIszt
+                 " bytes from %s to %s (block cache %" ROCKSDB_PRIszt
+                 ", row cache %" ROCKSDB_PRIszt
+                 ", write buffers %" ROCKSDB_PRIszt ")",
+                 step, kConsumerNames[from], kConsumerNames[to],
+                 shares_[kBlockCache], shares_[kRowCache],
+                 shares_[kWriteBuffer]);
+}
+
+void MemoryGovernorImpl::ApplyShares() {
+  mutex_.AssertHeld();
+  WriteBufferManager* wbm = options_.write_buffer_manager.get();
+  if (IsPresent(kWriteBuffer)) {
+    wbm->SetBufferSize(std::max(shares_[kWriteBuffer], size_t{1}));
+  }
+  if (IsPresent(kBlockCache)) {
+    size_t capacity = shares_[kBlockCache];
+    if (IsPresent(kWriteBuffer) && wbm->cost_to_cache()) {
+      capacity += shares_[kWriteBuffer];
+    }
+    options_.block_cache->SetCapacity(capacity);
+  }
+  if (IsPresent(kRowCache)) {
+    options_.row_cache->SetCapacity(shares_[kRowCache]);
+  }
+}
+
+void MemoryGovernorImpl::SetTotalBudget(size_t total_budget) {
+  MutexLock l(&mutex_);
+  if (total_budget == 0 || total_budget == total_budget_) {
+    return;
+  }
+  double scale = static_cast<double>(total_budget) / total_budget_;
+  size_t assigned = 0;
+  for (size_t& share : shares_) {
+    share = static_cast<size_t>(share * scale);
+    assigned += share;
+  }
+  *std::max_element(shares_.begin(), shares_.end()) +=
+      total_budget - std::min(assigned, total_budget);
+  total_budget_ = total_budget;
+  ApplyShares();
+}
+
+size_t MemoryGovernorImpl::GetTotalBudget() const {
+  MutexLock l(&mutex_);
+  return total_budget_;
+}
+
+MemoryGovernor::Split MemoryGovernorImpl::GetSplit() const {
+  MutexLock l(&mutex_);
+  Split split;
+  split.block_cache = shares_[kBlockCache];
+  split.row_cache = shares_[kRowCache];
+  split.write_buffer = shares_[kWriteBuffer];
+  return split;
+}
+}  // namespace
+
+MemoryGovernor* NewMemoryGovernor(const MemoryGovernorOptions& options,
+                                  Status* status) {
+  std::unique_ptr<MemoryGovernorImpl> governor(
+      new MemoryGovernorImpl(options));
+  Status s = governor->Init();
+  if (status) {
+    *status = s;
+  }
+  return s.ok() ? governor.release() : nullptr;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
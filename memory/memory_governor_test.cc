@@ -0,0 +1,200 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/memory_governor.h"
+
+#include <memory>
+#include <string>
+
+#include "monitoring/statistics_impl.h"
+#include "rocksdb/advanced_cache.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/statistics.h"
+#include "rocksdb/write_buffer_manager.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class MemoryGovernorTest : public testing::Test {
+ public:
+  MemoryGovernorTest() : stats_(CreateDBStatistics()) {}
+
+  std::shared_ptr<Cache> NewCache(size_t capacity,
+                                  bool estimate_miss_ratio_curve = false) {
+    LRUCacheOptions opts(capacity, /*num_shard_bits=*/0,
+                         /*strict_capacity_limit=*/false,
+                         /*high_pri_pool_ratio=*/0.0);
+    opts.metadata_charge_policy = kDontChargeCacheMetadata;
+    opts.estimate_miss_ratio_curve = estimate_miss_ratio_curve;
+    return opts.MakeSharedCache();
+  }
+
+  std::unique_ptr<MemoryGovernor> NewGovernor(
+      const MemoryGovernorOptions& options) {
+    Status s;
+    std::unique_ptr<MemoryGovernor> governor(NewMemoryGovernor(options, &s));
+    EXPECT_OK(s);
+    return governor;
+  }
+
+  MemoryGovernorOptions Options() {
+    MemoryGovernorOptions options;
+    options.statistics = stats_;
+    options.rebalance_period_sec = 0;
+    options.step_fraction = 0.05;
+    options.min_fraction = 0.1;
+    return options;
+  }
+
+  std::shared_ptr<Statistics> stats_;
+};
+
+TEST_F(MemoryGovernorTest, InitialSplit) {
+  auto block_cache = NewCache(600);
+  auto row_cache = NewCache(200);
+  auto wbm = std::make_shared<WriteBufferManager>(200);
+  MemoryGovernorOptions options = Options();
+  options.total_budget = 2000;
+  options.block_cache = block_cache;
+  options.row_cache = row_cache;
+  options.write_buffer_manager = wbm;
+
+  // Statistics are required
+  options.statistics = nullptr;
+  Status s;
+  ASSERT_EQ(NewMemoryGovernor(options, &s), nullptr);
+  ASSERT_TRUE(s.IsInvalidArgument());
+  options.statistics = stats_;
+
+  // Scaled to the budget
+  auto governor = NewGovernor(options);
+  ASSERT_EQ(governor->GetTotalBudget(), 2000U);
+  ASSERT_EQ(governor->GetSplit().block_cache, 1200U);
+  ASSERT_EQ(governor->GetSplit().row_cache, 400U);
+  ASSERT_EQ(governor->GetSplit().write_buffer, 400U);
+  ASSERT_EQ(block_cache->GetCapacity(), 1200U);
+  ASSERT_EQ(row_cache->GetCapacity(), 400U);
+  ASSERT_EQ(wbm->buffer_size(), 400U);
+
+  governor->SetTotalBudget(1000);
+  ASSERT_EQ(block_cache->GetCapacity(), 600U);
+  ASSERT_EQ(row_cache->GetCapacity(), 200U);
+  ASSERT_EQ(wbm->buffer_size(), 200U);
+
+  // Without a row cache, with memtables charged to the block cache
+  governor.reset();
+  auto charged_wbm = std::make_shared<WriteBufferManager>(100, block_cache);
+  block_cache->SetCapacity(400);
+  options.total_budget = 0;
+  options.row_cache = nullptr;
+  options.write_buffer_manager = charged_wbm;
+  governor = NewGovernor(options);
+  ASSERT_EQ(governor->GetTotalBudget(), 400U);
+  ASSERT_EQ(governor->GetSplit().block_cache, 300U);
+  ASSERT_EQ(governor->GetSplit().row_cache, 0U);
+  ASSERT_EQ(governor->GetSplit().write_buffer, 100U);
+  ASSERT_EQ(block_cache->GetCapacity(), 400U);
+}
+
+TEST_F(MemoryGovernorTest, WriteStallsGrowWriteBuffers) {
+  auto block_cache = NewCache(600);
+  auto row_cache = NewCache(200);
+  auto wbm = std::make_shared<WriteBufferManager>(200);
+  MemoryGovernorOptions options = Options();
+  options.block_cache = block_cache;
+  options.row_cache = row_cache;
+  options.write_buffer_manager = wbm;
+  auto governor = NewGovernor(options);
+
+  // Taken from the cache that would lose the least
+  RecordTick(stats_.get(), BLOCK_CACHE_MISS, 1000);
+  RecordTick(stats_.get(), STALL_MICROS, 10);
+  governor->Rebalance();
+  ASSERT_EQ(governor->GetSplit().block_cache, 600U);
+  ASSERT_EQ(governor->GetSplit().row_cache, 150U);
+  ASSERT_EQ(governor->GetSplit().write_buffer, 250U);
+  ASSERT_EQ(row_cache->GetCapacity(), 150U);
+  ASSERT_EQ(wbm->buffer_size(), 250U);
+
+  // Nothing changes while nothing happens
+  governor->Rebalance();
+  ASSERT_EQ(wbm->buffer_size(), 250U);
+
+  // Unused write buffers go back to a cache missing blocks
+  RecordTick(stats_.get(), BLOCK_CACHE_MISS, 1000);
+  governor->Rebalance();
+  ASSERT_EQ(governor->GetSplit().block_cache, 650U);
+  ASSERT_EQ(governor->GetSplit().row_cache, 150U);
+  ASSERT_EQ(governor->GetSplit().write_buffer, 200U);
+  ASSERT_EQ(block_cache->GetCapacity(), 650U);
+  ASSERT_EQ(wbm->buffer_size(), 200U);
+}
+
+TEST_F(MemoryGovernorTest, MissesMoveMemoryBetweenCaches) {
+  auto block_cache = NewCache(500);
+  auto row_cache = NewCache(500);
+  MemoryGovernorOptions options = Options();
+  options.block_cache = block_cache;
+  options.row_cache = row_cache;
+  auto governor = NewGovernor(options);
+
+  // Down to the minimum share
+  for (int i = 0; i < 20; ++i) {
+    RecordTick(stats_.get(), BLOCK_CACHE_MISS, 10);
+    RecordTick(stats_.get(), ROW_CACHE_MISS, 1000);
+    governor->Rebalance();
+  }
+  ASSERT_EQ(block_cache->GetCapacity(), 100U);
+  ASSERT_EQ(row_cache->GetCapacity(), 900U);
+
+  // And back as the workload changes
+  RecordTick(stats_.get(), BLOCK_CACHE_MISS, 1000);
+  governor->Rebalance();
+  ASSERT_EQ(block_cache->GetCapacity(), 150U);
+  ASSERT_EQ(row_cache->GetCapacity(), 850U);
+
+  // Not on small differences
+  RecordTick(stats_.get(), BLOCK_CACHE_MISS, 100);
+  RecordTick(stats_.get(), ROW_CACHE_MISS, 600);
+  governor->Rebalance();
+  ASSERT_EQ(block_cache->GetCapacity(), 150U);
+}
+
+TEST_F(MemoryGovernorTest, MissRatioCurve) {
+  auto block_cache = NewCache(500, /*estimate_miss_ratio_curve=*/true);
+  auto row_cache = NewCache(500);
+  MemoryGovernorOptions options = Options();
+  options.block_cache = block_cache;
+  options.row_cache = row_cache;
+  auto governor = NewGovernor(options);
+
+  // A working set much smaller than the block cache, which would not gain
+  // or lose hits from a step of capacity despite its (cold) misses
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < 100; ++i) {
+      std::string key = "key" + std::to_string(i);
+      Cache::Handle* handle = block_cache->Lookup(key);
+      if (handle) {
+        RecordTick(stats_.get(), BLOCK_CACHE_HIT);
+        block_cache->Release(handle);
+      } else {
+        RecordTick(stats_.get(), BLOCK_CACHE_MISS);
+        ASSERT_OK(block_cache->Insert(key, nullptr, &kNoopCacheItemHelper, 1));
+      }
+    }
+  }
+  RecordTick(stats_.get(), ROW_CACHE_MISS, 10);
+  governor->Rebalance();
+  ASSERT_EQ(block_cache->GetCapacity(), 450U);
+  ASSERT_EQ(row_cache->GetCapacity(), 550U);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -19,16 +19,25 @@ AllocTracker::AllocTracker(WriteBufferManager* write_buffer_manager)
     : write_buffer_manager_(write_buffer_manager),
       bytes_allocated_(0),
       done_allocating_(false),
-      freed_(false) {}
+      freed_(false) {
+  for (auto& bytes : numa_bytes_allocated_) {
+    bytes.store(0, std::memory_order_relaxed);
+  }
+}
 
 AllocTracker::~AllocTracker() { FreeMem(); }
 
-void AllocTracker::Allocate(size_t bytes) {
+void AllocTracker::Allocate(size_t bytes, int numa_node) {
   assert(write_buffer_manager_ != nullptr);
   if (write_buffer_manager_->enabled() ||
       write_buffer_manager_->cost_to_cache()) {
     bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
     write_buffer_manager_->ReserveMem(bytes);
+    if (numa_node >= 0 && numa_node < WriteBufferManager::kMaxNumaNodes) {
+      numa_bytes_allocated_[numa_node].fetch_add(bytes,
+                                                 std::memory_order_relaxed);
+      write_buffer_manager_->ReserveNumaNodeMem(bytes, numa_node);
+    }
   }
 }
 
@@ -38,6 +47,13 @@ void AllocTracker::DoneAllocating() {
         write_buffer_manager_->cost_to_cache()) {
       write_buffer_manager_->ScheduleFreeMem(
           bytes_allocated_.load(std::memory_order_relaxed));
+      for (int node = 0; node < WriteBufferManager::kMaxNumaNodes; ++node) {
+        size_t bytes =
+            numa_bytes_allocated_[node].load(std::memory_order_relaxed);
+        if (bytes > 0) {
+          write_buffer_manager_->ScheduleFreeNumaNodeMem(bytes, node);
+        }
+      }
     } else {
       assert(bytes_allocated_.load(std::memory_order_relaxed) == 0);
     }
@@ -0,0 +1,1406 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "memtable/art.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <new>
+#include <string>
+
+#include "db/dbformat.h"
+#include "port/port.h"
+#include "util/coding.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace ROCKSDB_NAMESPACE {
+
+// An Entry is allocated by AllocateKey, the memtable key is stored in the
+// bytes immediately after the struct.
+struct AdaptiveRadixTree::Entry {
+  std::atomic<Entry*> next;
+
+  const char* Key() const { return reinterpret_cast<const char*>(this + 1); }
+};
+
+// All entries of one user key, sorted by descending tag.  The head is
+// never null once the leaf is reachable from the tree.
+struct AdaptiveRadixTree::Leaf {
+  std::atomic<Entry*> head;
+};
+
+struct AdaptiveRadixTree::Node {
+  enum Type : uint8_t { kNode4, kNode16, kNode48, kNode256 };
+
+  explicit Node(Type t) : type(t) {}
+
+  // Optimistic lock word: bit 0 is set when the node has been replaced by a
+  // bigger one, bit 1 is set while a writer holds the node, and the upper
+  // bits count completed modifications.
+  std::atomic<uint64_t> version{0};
+  const Type type;
+  std::atomic<uint16_t> num_children{0};
+  // The compressed path of this node.  prefix points into the (immutable)
+  // user key of some entry.  A path split only ever drops bytes from the
+  // front, and stores prefix_len before publishing prefix with a release
+  // store, so any (prefix, prefix_len) pair a reader can observe stays in
+  // bounds of the original key.
+  std::atomic<uint32_t> prefix_len{0};
+  std::atomic<const char*> prefix{nullptr};
+  // Leaf of the user key ending exactly after prefix, it sorts before all
+  // children.
+  std::atomic<Leaf*> value{nullptr};
+};
+
+struct AdaptiveRadixTree::Node4 : public Node {
+  Node4() : Node(kNode4) {}
+  uint8_t keys[4];
+  std::atomic<void*> children[4];
+};
+
+struct AdaptiveRadixTree::Node16 : public Node {
+  Node16() : Node(kNode16) {}
+  uint8_t keys[16];
+  std::atomic<void*> children[16];
+};
+
+struct AdaptiveRadixTree::Node48 : public Node {
+  Node48() : Node(kNode48) { memset(child_index, 0, sizeof(child_index)); }
+  // 0 means no child, otherwise index + 1 into children
+  uint8_t child_index[256];
+  std::atomic<void*> children[48];
+};
+
+struct AdaptiveRadixTree::Node256 : public Node {
+  Node256() : Node(kNode256) {
+    for (auto& c : children) {
+      c.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+  std::atomic<void*> children[256];
+};
+
+namespace {
+
+constexpr uint64_t kObsoleteBit = 1;
+constexpr uint64_t kLockedBit = 2;
+
+// Child pointers to leaves are tagged with the lowest bit.
+inline bool IsLeafPtr(const void* p) {
+  return (reinterpret_cast<uintptr_t>(p) & 1) != 0;
+}
+
+inline Slice EntryInternalKey(const char* key) {
+  return GetLengthPrefixedSlice(key);
+}
+
+// Number of keys in the sorted array which are less than b
+inline size_t CountLess(const uint8_t* keys, size_t n, uint8_t b) {
+  size_t i = 0;
+  while (i < n && keys[i] < b) {
+    ++i;
+  }
+  return i;
+}
+
+inline size_t CountLess16(const uint8_t* keys, size_t n, uint8_t b) {
+#ifdef __SSE2__
+  const __m128i flip = _mm_set1_epi8(static_cast<char>(0x80));
+  const __m128i k = _mm_xor_si128(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys)), flip);
+  const __m128i t = _mm_xor_si128(_mm_set1_epi8(static_cast<char>(b)), flip);
+  unsigned mask =
+      static_cast<unsigned>(_mm_movemask_epi8(_mm_cmplt_epi8(k, t)));
+  mask &= (1u << n) - 1;
+  return static_cast<size_t>(__builtin_popcount(mask));
+#else
+  return CountLess(keys, n, b);
+#endif
+}
+
+inline int FindIndex16(const uint8_t* keys, size_t n, uint8_t b) {
+#ifdef __SSE2__
+  const __m128i cmp =
+      _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(b)),
+                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys)));
+  unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(cmp));
+  mask &= (1u << n) - 1;
+  return mask ? __builtin_ctz(mask) : -1;
+#else
+  for (size_t i = 0; i < n; ++i) {
+    if (keys[i] == b) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+#endif
+}
+
+}  // namespace
+
+#define ART_NODE(T, n) static_cast<T*>(n)
+#define ART_CNODE(T, n) static_cast<const T*>(n)
+
+namespace {
+
+template <class NodeT, size_t kCap>
+inline size_t NumChildren(const NodeT* n) {
+  return std::min<size_t>(n->num_children.load(std::memory_order_relaxed),
+                          kCap);
+}
+
+}  // namespace
+
+// Node operations.  Readers may call them on nodes being modified
+// concurrently, so every index read from a node is clamped to the node
+// capacity, and the result is only trusted after version validation.
+struct AdaptiveRadixTree::NodeOps {
+  static bool ReadLock(const Node* n, uint64_t* version) {
+    uint64_t v = n->version.load(std::memory_order_acquire);
+    if (v & (kObsoleteBit | kLockedBit)) {
+      return false;
+    }
+    *version = v;
+    return true;
+  }
+
+  static bool Validate(const Node* n, uint64_t version) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return n->version.load(std::memory_order_relaxed) == version;
+  }
+
+  static bool Upgrade(Node* n, uint64_t version) {
+    if (n->version.compare_exchange_strong(version, version + kLockedBit,
+                                           std::memory_order_acquire)) {
+      std::atomic_thread_fence(std::memory_order_release);
+      return true;
+    }
+    return false;
+  }
+
+  static void Unlock(Node* n) {
+    n->version.fetch_add(kLockedBit, std::memory_order_release);
+  }
+
+  static void UnlockObsolete(Node* n) {
+    n->version.fetch_add(kLockedBit | kObsoleteBit, std::memory_order_release);
+  }
+
+  static void* FindChild(const Node* n, uint8_t b) {
+    switch (n->type) {
+      case Node::kNode4: {
+        auto* n4 = ART_CNODE(Node4, n);
+        size_t cnt = NumChildren<Node4, 4>(n4);
+        for (size_t i = 0; i < cnt; ++i) {
+          if (n4->keys[i] == b) {
+            return n4->children[i].load(std::memory_order_acquire);
+          }
+        }
+        return nullptr;
+      }
+      case Node::kNode16: {
+        auto* n16 = ART_CNODE(Node16, n);
+        int i = FindIndex16(n16->keys, NumChildren<Node16, 16>(n16), b);
+        return i < 0 ? nullptr
+                     : n16->children[i].load(std::memory_order_acquire);
+      }
+      case Node::kNode48: {
+        auto* n48 = ART_CNODE(Node48, n);
+        uint8_t idx = n48->child_index[b];
+        return idx == 0 || idx > 48
+                   ? nullptr
+                   : n48->children[idx - 1].load(std::memory_order_acquire);
+      }
+      case Node::kNode256:
+        return ART_CNODE(Node256, n)->children[b].load(
+            std::memory_order_acquire);
+    }
+    return nullptr;
+  }
+
+  // First child whose byte >= b, its byte is stored in *key
+  static void* ChildAtOrAfter(const Node* n, int b, uint8_t* key) {
+    assert(b >= 0 && b <= 255);
+    switch (n->type) {
+      case Node::kNode4:
+      case Node::kNode16: {
+        const uint8_t* keys;
+        const std::atomic<void*>* children;
+        size_t cnt, i;
+        if (n->type == Node::kNode4) {
+          auto* n4 = ART_CNODE(Node4, n);
+          keys = n4->keys;
+          children = n4->children;
+          cnt = NumChildren<Node4, 4>(n4);
+          i = CountLess(keys, cnt, static_cast<uint8_t>(b));
+        } else {
+          auto* n16 = ART_CNODE(Node16, n);
+          keys = n16->keys;
+          children = n16->children;
+          cnt = NumChildren<Node16, 16>(n16);
+          i = CountLess16(keys, cnt, static_cast<uint8_t>(b));
+        }
+        if (i < cnt) {
+          *key = keys[i];
+          return children[i].load(std::memory_order_acquire);
+        }
+        return nullptr;
+      }
+      case Node::kNode48: {
+        auto* n48 = ART_CNODE(Node48, n);
+        for (int i = b; i < 256; ++i) {
+          uint8_t idx = n48->child_index[i];
+          if (idx != 0 && idx <= 48) {
+            *key = static_cast<uint8_t>(i);
+            return n48->children[idx - 1].load(std::memory_order_acquire);
+          }
+        }
+        return nullptr;
+      }
+      case Node::kNode256: {
+        auto* n256 = ART_CNODE(Node256, n);
+        for (int i = b; i < 256; ++i) {
+          void* c = n256->children[i].load(std::memory_order_acquire);
+          if (c != nullptr) {
+            *key = static_cast<uint8_t>(i);
+            return c;
+          }
+        }
+        return nullptr;
+      }
+    }
+    return nullptr;
+  }
+
+  // Last child whose byte <= b, its byte is stored in *key
+  static void* ChildAtOrBefore(const Node* n, int b, uint8_t* key) {
+    assert(b >= 0 && b <= 255);
+    switch (n->type) {
+      case Node::kNode4:
+      case Node::kNode16: {
+        const uint8_t* keys;
+        const std::atomic<void*>* children;
+        size_t cnt, i;
+        if (n->type == Node::kNode4) {
+          auto* n4 = ART_CNODE(Node4, n);
+          keys = n4->keys;
+          children = n4->children;
+          cnt = NumChildren<Node4, 4>(n4);
+          i = CountLess(keys, cnt, static_cast<uint8_t>(b));
+        } else {
+          auto* n16 = ART_CNODE(Node16, n);
+          keys = n16->keys;
+          children = n16->children;
+          cnt = NumChildren<Node16, 16>(n16);
+          i = CountLess16(keys, cnt, static_cast<uint8_t>(b));
+        }
+        // keys[i] is the first key >= b
+        if (i < cnt && keys[i] == b) {
+          *key = keys[i];
+          return children[i].load(std::memory_order_acquire);
+        }
+        if (i > 0) {
+          *key = keys[i - 1];
+          return children[i - 1].load(std::memory_order_acquire);
+        }
+        return nullptr;
+      }
+      case Node::kNode48: {
+        auto* n48 = ART_CNODE(Node48, n);
+        for (int i = b; i >= 0; --i) {
+          uint8_t idx = n48->child_index[i];
+          if (idx != 0 && idx <= 48) {
+            *key = static_cast<uint8_t>(i);
+            return n48->children[idx - 1].load(std::memory_order_acquire);
+          }
+        }
+        return nullptr;
+      }
+      case Node::kNode256: {
+        auto* n256 = ART_CNODE(Node256, n);
+        for (int i = b; i >= 0; --i) {
+          void* c = n256->children[i].load(std::memory_order_acquire);
+          if (c != nullptr) {
+            *key = static_cast<uint8_t>(i);
+            return c;
+          }
+        }
+        return nullptr;
+      }
+    }
+    return nullptr;
+  }
+
+  static bool IsFull(const Node* n) {
+    uint16_t cnt = n->num_children.load(std::memory_order_relaxed);
+    switch (n->type) {
+      case Node::kNode4:
+        return cnt == 4;
+      case Node::kNode16:
+        return cnt == 16;
+      case Node::kNode48:
+        return cnt == 48;
+      case Node::kNode256:
+        return false;
+    }
+    return false;
+  }
+
+  template <class NodeT, size_t kCap>
+  static void InsertSorted(NodeT* n, uint8_t b, void* child) {
+    size_t cnt = n->num_children.load(std::memory_order_relaxed);
+    assert(cnt < kCap);
+    size_t pos = kCap == 16 ? CountLess16(n->keys, cnt, b)
+                            : CountLess(n->keys, cnt, b);
+    assert(pos == cnt || n->keys[pos] != b);
+    for (size_t i = cnt; i > pos; --i) {
+      n->keys[i] = n->keys[i - 1];
+      n->children[i].store(n->children[i - 1].load(std::memory_order_relaxed),
+                           std::memory_order_relaxed);
+    }
+    n->keys[pos] = b;
+    n->children[pos].store(child, std::memory_order_release);
+    n->num_children.store(static_cast<uint16_t>(cnt + 1),
+                          std::memory_order_release);
+  }
+
+  // REQUIRES: n is write locked (or unpublished) and not full
+  static void AddChild(Node* n, uint8_t b, void* child) {
+    switch (n->type) {
+      case Node::kNode4:
+        InsertSorted<Node4, 4>(ART_NODE(Node4, n), b, child);
+        break;
+      case Node::kNode16:
+        InsertSorted<Node16, 16>(ART_NODE(Node16, n), b, child);
+        break;
+      case Node::kNode48: {
+        auto* n48 = ART_NODE(Node48, n);
+        uint16_t cnt = n48->num_children.load(std::memory_order_relaxed);
+        assert(cnt < 48 && n48->child_index[b] == 0);
+        n48->children[cnt].store(child, std::memory_order_release);
+        n48->child_index[b] = static_cast<uint8_t>(cnt + 1);
+        n48->num_children.store(cnt + 1, std::memory_order_release);
+        break;
+      }
+      case Node::kNode256: {
+        auto* n256 = ART_NODE(Node256, n);
+        assert(n256->children[b].load(std::memory_order_relaxed) == nullptr);
+        n256->children[b].store(child, std::memory_order_release);
+        n256->num_children.fetch_add(1, std::memory_order_relaxed);
+        break;
+      }
+    }
+  }
+
+  // REQUIRES: n is write locked and has a child at b
+  static void ReplaceChild(Node* n, uint8_t b, void* child) {
+    switch (n->type) {
+      case Node::kNode4: {
+        auto* n4 = ART_NODE(Node4, n);
+        size_t cnt = NumChildren<Node4, 4>(n4);
+        for (size_t i = 0; i < cnt; ++i) {
+          if (n4->keys[i] == b) {
+            n4->children[i].store(child, std::memory_order_release);
+            return;
+          }
+        }
+        break;
+      }
+      case Node::kNode16: {
+        auto* n16 = ART_NODE(Node16, n);
+        int i = FindIndex16(n16->keys, NumChildren<Node16, 16>(n16), b);
+        assert(i >= 0);
+        n16->children[i].store(child, std::memory_order_release);
+        return;
+      }
+      case Node::kNode48: {
+        auto* n48 = ART_NODE(Node48, n);
+        assert(n48->child_index[b] != 0);
+        n48->children[n48->child_index[b] - 1].store(
+            child, std::memory_order_release);
+        return;
+      }
+      case Node::kNode256:
+        ART_NODE(Node256, n)->children[b].store(child,
+                                                std::memory_order_release);
+        return;
+    }
+    assert(false);
+  }
+
+  static void CopyHeader(const Node* from, Node* to) {
+    to->prefix_len.store(from->prefix_len.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+    to->prefix.store(from->prefix.load(std::memory_order_relaxed),
+                     std::memory_order_relaxed);
+    to->value.store(from->value.load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+  }
+
+  // Returns an unpublished copy of the full node n with the next bigger
+  // capacity.
+  // REQUIRES: n is write locked
+  static Node* Grow(Allocator* allocator, const Node* n) {
+    switch (n->type) {
+      case Node::kNode4: {
+        auto* from = ART_CNODE(Node4, n);
+        auto* to = new (allocator->AllocateAligned(sizeof(Node16))) Node16();
+        CopyHeader(from, to);
+        for (size_t i = 0; i < 4; ++i) {
+          to->keys[i] = from->keys[i];
+          to->children[i].store(
+              from->children[i].load(std::memory_order_relaxed),
+              std::memory_order_relaxed);
+        }
+        to->num_children.store(4, std::memory_order_relaxed);
+        return to;
+      }
+      case Node::kNode16: {
+        auto* from = ART_CNODE(Node16, n);
+        auto* to = new (allocator->AllocateAligned(sizeof(Node48))) Node48();
+        CopyHeader(from, to);
+        for (size_t i = 0; i < 16; ++i) {
+          to->children[i].store(
+              from->children[i].load(std::memory_order_relaxed),
+              std::memory_order_relaxed);
+          to->child_index[from->keys[i]] = static_cast<uint8_t>(i + 1);
+        }
+        to->num_children.store(16, std::memory_order_relaxed);
+        return to;
+      }
+      case Node::kNode48: {
+        auto* from = ART_CNODE(Node48, n);
+        auto* to = new (allocator->AllocateAligned(sizeof(Node256))) Node256();
+        CopyHeader(from, to);
+        for (int b = 0; b < 256; ++b) {
+          uint8_t idx = from->child_index[b];
+          if (idx != 0) {
+            to->children[b].store(
+                from->children[idx - 1].load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+          }
+        }
+        to->num_children.store(48, std::memory_order_relaxed);
+        return to;
+      }
+      case Node::kNode256:
+        break;
+    }
+    assert(false);
+    return nullptr;
+  }
+};
+
+#undef ART_NODE
+#undef ART_CNODE
+
+namespace {
+
+inline void* TagLeaf(void* leaf) {
+  return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(leaf) | 1);
+}
+
+}  // namespace
+
+static inline const char* UntagLeafPtr(const void* p) {
+  return reinterpret_cast<const char*>(reinterpret_cast<uintptr_t>(p) &
+                                       ~uintptr_t(1));
+}
+
+#define ART_LEAF(p) \
+  reinterpret_cast<AdaptiveRadixTree::Leaf*>(const_cast<char*>(UntagLeafPtr(p)))
+
+static inline void RestartPause() { port::AsmVolatilePause(); }
+
+namespace {
+
+// Result of a single optimistic insert attempt
+enum InsertResult { kRestart, kInserted, kDuplicate };
+
+}  // namespace
+
+AdaptiveRadixTree::AdaptiveRadixTree(Allocator* allocator)
+    : allocator_(allocator),
+      root_(new (allocator->AllocateAligned(sizeof(Node256))) Node256()),
+      num_leaves_(0),
+      num_entries_(0) {}
+
+char* AdaptiveRadixTree::AllocateKey(size_t key_size) {
+  char* raw = allocator_->AllocateAligned(sizeof(Entry) + key_size);
+  Entry* x = new (raw) Entry();
+  x->next.store(nullptr, std::memory_order_relaxed);
+  return const_cast<char*>(x->Key());
+}
+
+AdaptiveRadixTree::Leaf* AdaptiveRadixTree::NewLeaf(Entry* entry) {
+  Leaf* leaf = new (allocator_->AllocateAligned(sizeof(Leaf))) Leaf();
+  entry->next.store(nullptr, std::memory_order_relaxed);
+  leaf->head.store(entry, std::memory_order_relaxed);
+  return leaf;
+}
+
+AdaptiveRadixTree::Node4* AdaptiveRadixTree::NewNode4(const char* prefix,
+                                                      uint32_t prefix_len) {
+  Node4* n = new (allocator_->AllocateAligned(sizeof(Node4))) Node4();
+  n->prefix_len.store(prefix_len, std::memory_order_relaxed);
+  n->prefix.store(prefix, std::memory_order_relaxed);
+  return n;
+}
+
+struct AdaptiveRadixTree::EntryOps {
+  using Tree = AdaptiveRadixTree;
+
+  static Slice UserKey(const Tree::Entry* e) {
+    return ExtractUserKey(EntryInternalKey(e->Key()));
+  }
+
+  static uint64_t Tag(const Tree::Entry* e) {
+    return ExtractInternalKeyFooter(EntryInternalKey(e->Key()));
+  }
+
+  static Slice LeafKey(const Tree::Leaf* leaf) {
+    return UserKey(leaf->head.load(std::memory_order_acquire));
+  }
+
+  static Tree::Entry* FromKey(const char* key) {
+    return reinterpret_cast<Tree::Entry*>(const_cast<char*>(key)) - 1;
+  }
+
+  // Link entry into the tag-sorted list of leaf.  Entries are never removed,
+  // so a CAS on the predecessor link is all the synchronization needed.
+  static bool Link(Tree::Leaf* leaf, Tree::Entry* entry, uint64_t tag) {
+    std::atomic<Tree::Entry*>* prev = &leaf->head;
+    Tree::Entry* cur = prev->load(std::memory_order_acquire);
+    for (;;) {
+      if (cur != nullptr) {
+        uint64_t cur_tag = Tag(cur);
+        if (cur_tag > tag) {
+          prev = &cur->next;
+          cur = prev->load(std::memory_order_acquire);
+          continue;
+        }
+        if (cur_tag == tag) {
+          return false;
+        }
+      }
+      entry->next.store(cur, std::memory_order_relaxed);
+      if (prev->compare_exchange_weak(cur, entry, std::memory_order_release,
+                                      std::memory_order_acquire)) {
+        return true;
+      }
+    }
+  }
+};
+
+
+bool AdaptiveRadixTree::Insert(const char* key) {
+  return InsertImpl(EntryOps::FromKey(key));
+}
+
+bool AdaptiveRadixTree::InsertConcurrently(const char* key) {
+  return InsertImpl(EntryOps::FromKey(key));
+}
+
+bool AdaptiveRadixTree::InsertImpl(Entry* entry) {
+  const Slice ikey = EntryInternalKey(entry->Key());
+  const Slice ukey = ExtractUserKey(ikey);
+  const uint64_t tag = ExtractInternalKeyFooter(ikey);
+  const char* k = ukey.data();
+  const size_t klen = ukey.size();
+  Leaf* new_leaf = nullptr;
+  auto leaf_ptr = [&]() {
+    if (new_leaf == nullptr) {
+      new_leaf = NewLeaf(entry);
+    }
+    return new_leaf;
+  };
+  auto link = [&](Leaf* leaf) {
+    if (EntryOps::Link(leaf, entry, tag)) {
+      num_entries_.fetch_add(1, std::memory_order_relaxed);
+      return kInserted;
+    }
+    return kDuplicate;
+  };
+  auto added_leaf = [&]() {
+    num_leaves_.fetch_add(1, std::memory_order_relaxed);
+    num_entries_.fetch_add(1, std::memory_order_relaxed);
+    return kInserted;
+  };
+
+  auto attempt = [&]() -> InsertResult {
+    Node* parent = nullptr;
+    uint64_t parent_v = 0;
+    uint8_t parent_byte = 0;
+    Node* node = root_;
+    uint64_t v;
+    if (!NodeOps::ReadLock(node, &v)) {
+      return kRestart;
+    }
+    size_t depth = 0;
+    for (;;) {
+      const char* prefix = node->prefix.load(std::memory_order_acquire);
+      const uint32_t plen = node->prefix_len.load(std::memory_order_relaxed);
+      const size_t max_match = std::min<size_t>(plen, klen - depth);
+      size_t match = 0;
+      while (match < max_match && prefix[match] == k[depth + match]) {
+        ++match;
+      }
+      if (match < plen) {
+        // The key leaves the compressed path of node: put a Node4 holding
+        // the common part above node, and shorten the path of node.
+        assert(parent != nullptr);
+        if (!NodeOps::Upgrade(parent, parent_v)) {
+          return kRestart;
+        }
+        if (!NodeOps::Upgrade(node, v)) {
+          NodeOps::Unlock(parent);
+          return kRestart;
+        }
+        Node4* n4 = NewNode4(prefix, static_cast<uint32_t>(match));
+        if (depth + match == klen) {
+          n4->value.store(leaf_ptr(), std::memory_order_relaxed);
+        } else {
+          NodeOps::AddChild(n4, static_cast<uint8_t>(k[depth + match]),
+                        TagLeaf(leaf_ptr()));
+        }
+        NodeOps::AddChild(n4, static_cast<uint8_t>(prefix[match]), node);
+        node->prefix_len.store(static_cast<uint32_t>(plen - match - 1),
+                               std::memory_order_relaxed);
+        node->prefix.store(prefix + match + 1, std::memory_order_release);
+        NodeOps::ReplaceChild(parent, parent_byte, n4);
+        NodeOps::Unlock(node);
+        NodeOps::Unlock(parent);
+        return added_leaf();
+      }
+      depth += plen;
+      if (depth == klen) {
+        Leaf* leaf = node->value.load(std::memory_order_acquire);
+        if (!NodeOps::Validate(node, v)) {
+          return kRestart;
+        }
+        if (leaf != nullptr) {
+          return link(leaf);
+        }
+        if (!NodeOps::Upgrade(node, v)) {
+          return kRestart;
+        }
+        node->value.store(leaf_ptr(), std::memory_order_release);
+        NodeOps::Unlock(node);
+        return added_leaf();
+      }
+      const uint8_t b = static_cast<uint8_t>(k[depth]);
+      void* child = NodeOps::FindChild(node, b);
+      if (!NodeOps::Validate(node, v)) {
+        return kRestart;
+      }
+      if (child == nullptr) {
+        if (NodeOps::IsFull(node)) {
+          // The root is a Node256, so a full node always has a parent
+          assert(parent != nullptr);
+          if (!NodeOps::Upgrade(parent, parent_v)) {
+            return kRestart;
+          }
+          if (!NodeOps::Upgrade(node, v)) {
+            NodeOps::Unlock(parent);
+            return kRestart;
+          }
+          Node* bigger = NodeOps::Grow(allocator_, node);
+          NodeOps::AddChild(bigger, b, TagLeaf(leaf_ptr()));
+          NodeOps::ReplaceChild(parent, parent_byte, bigger);
+          NodeOps::UnlockObsolete(node);
+          NodeOps::Unlock(parent);
+        } else {
+          if (!NodeOps::Upgrade(node, v)) {
+            return kRestart;
+          }
+          NodeOps::AddChild(node, b, TagLeaf(leaf_ptr()));
+          NodeOps::Unlock(node);
+        }
+        return added_leaf();
+      }
+      if (IsLeafPtr(child)) {
+        Leaf* other = ART_LEAF(child);
+        const Slice other_key = EntryOps::LeafKey(other);
+        if (other_key == ukey) {
+          return link(other);
+        }
+        // Two different keys share the path up to depth + 1, push them
+        // down into a new Node4 whose prefix is their common part.
+        if (!NodeOps::Upgrade(node, v)) {
+          return kRestart;
+        }
+        const size_t d = depth + 1;
+        const size_t max_common = std::min(klen, other_key.size()) - d;
+        size_t common = 0;
+        while (common < max_common && k[d + common] == other_key[d + common]) {
+          ++common;
+        }
+        Node4* n4 = NewNode4(k + d, static_cast<uint32_t>(common));
+        const size_t nd = d + common;
+        if (klen == nd) {
+          n4->value.store(leaf_ptr(), std::memory_order_relaxed);
+        } else {
+          NodeOps::AddChild(n4, static_cast<uint8_t>(k[nd]),
+                            TagLeaf(leaf_ptr()));
+        }
+        if (other_key.size() == nd) {
+          n4->value.store(other, std::memory_order_relaxed);
+        } else {
+          NodeOps::AddChild(n4, static_cast<uint8_t>(other_key[nd]), child);
+        }
+        NodeOps::ReplaceChild(node, b, n4);
+        NodeOps::Unlock(node);
+        return added_leaf();
+      }
+      Node* child_node = static_cast<Node*>(child);
+      uint64_t child_v;
+      if (!NodeOps::ReadLock(child_node, &child_v)) {
+        return kRestart;
+      }
+      if (!NodeOps::Validate(node, v)) {
+        return kRestart;
+      }
+      parent = node;
+      parent_v = v;
+      parent_byte = b;
+      node = child_node;
+      v = child_v;
+      depth += 1;
+    }
+  };
+
+  for (;;) {
+    InsertResult r = attempt();
+    if (r != kRestart) {
+      return r == kInserted;
+    }
+    RestartPause();
+  }
+}
+
+const AdaptiveRadixTree::Leaf* AdaptiveRadixTree::FindLeaf(
+    const Slice& user_key) const {
+  const char* k = user_key.data();
+  const size_t klen = user_key.size();
+  auto attempt = [&](const Leaf** result) {
+    const Node* node = root_;
+    uint64_t v;
+    if (!NodeOps::ReadLock(node, &v)) {
+      return false;
+    }
+    size_t depth = 0;
+    for (;;) {
+      const char* prefix = node->prefix.load(std::memory_order_acquire);
+      const uint32_t plen = node->prefix_len.load(std::memory_order_relaxed);
+      if (klen - depth < plen || memcmp(prefix, k + depth, plen) != 0) {
+        *result = nullptr;
+        return NodeOps::Validate(node, v);
+      }
+      depth += plen;
+      if (depth == klen) {
+        *result = node->value.load(std::memory_order_acquire);
+        return NodeOps::Validate(node, v);
+      }
+      const void* child =
+          NodeOps::FindChild(node, static_cast<uint8_t>(k[depth]));
+      if (!NodeOps::Validate(node, v)) {
+        return false;
+      }
+      if (child == nullptr) {
+        *result = nullptr;
+        return true;
+      }
+      if (IsLeafPtr(child)) {
+        const Leaf* leaf = ART_LEAF(child);
+        *result = EntryOps::LeafKey(leaf) == user_key ? leaf : nullptr;
+        return true;
+      }
+      const Node* child_node = static_cast<const Node*>(child);
+      uint64_t child_v;
+      if (!NodeOps::ReadLock(child_node, &child_v) ||
+          !NodeOps::Validate(node, v)) {
+        return false;
+      }
+      node = child_node;
+      v = child_v;
+      depth += 1;
+    }
+  };
+  const Leaf* result = nullptr;
+  while (!attempt(&result)) {
+    RestartPause();
+  }
+  return result;
+}
+
+bool AdaptiveRadixTree::Contains(const char* key) const {
+  const Slice ikey = EntryInternalKey(key);
+  const uint64_t tag = ExtractInternalKeyFooter(ikey);
+  const Leaf* leaf = FindLeaf(ExtractUserKey(ikey));
+  if (leaf == nullptr) {
+    return false;
+  }
+  for (const Entry* e = leaf->head.load(std::memory_order_acquire);
+       e != nullptr; e = e->next.load(std::memory_order_acquire)) {
+    uint64_t t = EntryOps::Tag(e);
+    if (t <= tag) {
+      return t == tag;
+    }
+  }
+  return false;
+}
+
+bool AdaptiveRadixTree::MinimumFrom(const void* child, const Leaf** result,
+                                    std::vector<PathEntry>* path) const {
+  for (;;) {
+    if (IsLeafPtr(child)) {
+      *result = ART_LEAF(child);
+      return true;
+    }
+    const Node* node = static_cast<const Node*>(child);
+    uint64_t v;
+    if (!NodeOps::ReadLock(node, &v)) {
+      return false;
+    }
+    const Leaf* leaf = node->value.load(std::memory_order_acquire);
+    if (leaf != nullptr) {
+      if (!NodeOps::Validate(node, v)) {
+        return false;
+      }
+      path->push_back({node, v, -1});
+      *result = leaf;
+      return true;
+    }
+    uint8_t key = 0;
+    const void* next = NodeOps::ChildAtOrAfter(node, 0, &key);
+    if (!NodeOps::Validate(node, v)) {
+      return false;
+    }
+    if (next == nullptr) {
+      // only the empty root has neither value nor children
+      *result = nullptr;
+      return true;
+    }
+    path->push_back({node, v, key});
+    child = next;
+  }
+}
+
+bool AdaptiveRadixTree::MaximumFrom(const void* child, const Leaf** result,
+                                    std::vector<PathEntry>* path) const {
+  for (;;) {
+    if (IsLeafPtr(child)) {
+      *result = ART_LEAF(child);
+      return true;
+    }
+    const Node* node = static_cast<const Node*>(child);
+    uint64_t v;
+    if (!NodeOps::ReadLock(node, &v)) {
+      return false;
+    }
+    uint8_t key = 0;
+    const void* next = NodeOps::ChildAtOrBefore(node, 255, &key);
+    if (next != nullptr) {
+      if (!NodeOps::Validate(node, v)) {
+        return false;
+      }
+      path->push_back({node, v, key});
+      child = next;
+      continue;
+    }
+    const Leaf* leaf = node->value.load(std::memory_order_acquire);
+    if (!NodeOps::Validate(node, v)) {
+      return false;
+    }
+    if (leaf != nullptr) {
+      path->push_back({node, v, -1});
+    }
+    *result = leaf;
+    return true;
+  }
+}
+
+bool AdaptiveRadixTree::LowerBoundFrom(const Node* node, uint64_t v,
+                                       size_t depth, const Slice& target,
+                                       bool strict, const Leaf** result,
+                                       std::vector<PathEntry>* path) const {
+  const char* prefix = node->prefix.load(std::memory_order_acquire);
+  const uint32_t plen = node->prefix_len.load(std::memory_order_relaxed);
+  const size_t n = std::min<size_t>(plen, target.size() - depth);
+  int c = memcmp(prefix, target.data() + depth, n);
+  if (c == 0 && n < plen) {
+    c = 1;  // target ends inside the path, all keys below are longer
+  }
+  if (c != 0) {
+    if (!NodeOps::Validate(node, v)) {
+      return false;
+    }
+    if (c < 0) {
+      *result = nullptr;
+      return true;
+    }
+    return MinimumFrom(node, result, path);
+  }
+  depth += plen;
+  const size_t path_size = path->size();
+  int from = 0;
+  if (depth == target.size()) {
+    if (!strict) {
+      const Leaf* leaf = node->value.load(std::memory_order_acquire);
+      if (!NodeOps::Validate(node, v)) {
+        return false;
+      }
+      if (leaf != nullptr) {
+        path->push_back({node, v, -1});
+        *result = leaf;
+        return true;
+      }
+    }
+  } else {
+    const uint8_t b = static_cast<uint8_t>(target[depth]);
+    uint8_t key = 0;
+    const void* child = NodeOps::ChildAtOrAfter(node, b, &key);
+    if (!NodeOps::Validate(node, v)) {
+      return false;
+    }
+    if (child == nullptr) {
+      *result = nullptr;
+      return true;
+    }
+    path->push_back({node, v, key});
+    if (key != b) {
+      return MinimumFrom(child, result, path);
+    }
+    if (IsLeafPtr(child)) {
+      const Leaf* leaf = ART_LEAF(child);
+      int c2 = EntryOps::LeafKey(leaf).compare(target);
+      if (c2 > 0 || (c2 == 0 && !strict)) {
+        *result = leaf;
+        return true;
+      }
+    } else {
+      const Node* child_node = static_cast<const Node*>(child);
+      uint64_t child_v;
+      if (!NodeOps::ReadLock(child_node, &child_v) ||
+          !NodeOps::Validate(node, v)) {
+        return false;
+      }
+      if (!LowerBoundFrom(child_node, child_v, depth + 1, target, strict,
+                          result, path)) {
+        return false;
+      }
+      if (*result != nullptr) {
+        return true;
+      }
+    }
+    path->resize(path_size);
+    if (b == 255) {
+      *result = nullptr;
+      return NodeOps::Validate(node, v);
+    }
+    from = b + 1;
+  }
+  // Every child from `from` on is greater than target
+  uint8_t key = 0;
+  const void* child = NodeOps::ChildAtOrAfter(node, from, &key);
+  if (!NodeOps::Validate(node, v)) {
+    return false;
+  }
+  if (child == nullptr) {
+    *result = nullptr;
+    return true;
+  }
+  path->push_back({node, v, key});
+  return MinimumFrom(child, result, path);
+}
+
+bool AdaptiveRadixTree::UpperBoundFrom(const Node* node, uint64_t v,
+                                       size_t depth, const Slice& target,
+                                       bool strict, const Leaf** result,
+                                       std::vector<PathEntry>* path) const {
+  const char* prefix = node->prefix.load(std::memory_order_acquire);
+  const uint32_t plen = node->prefix_len.load(std::memory_order_relaxed);
+  const size_t n = std::min<size_t>(plen, target.size() - depth);
+  int c = memcmp(prefix, target.data() + depth, n);
+  if (c == 0 && n < plen) {
+    c = 1;
+  }
+  if (c != 0) {
+    if (!NodeOps::Validate(node, v)) {
+      return false;
+    }
+    if (c > 0) {
+      *result = nullptr;
+      return true;
+    }
+    return MaximumFrom(node, result, path);
+  }
+  depth += plen;
+  const size_t path_size = path->size();
+  auto value_or_null = [&]() {
+    const Leaf* leaf = node->value.load(std::memory_order_acquire);
+    if (!NodeOps::Validate(node, v)) {
+      return false;
+    }
+    if (leaf != nullptr) {
+      path->push_back({node, v, -1});
+    }
+    *result = leaf;
+    return true;
+  };
+  if (depth == target.size()) {
+    // all children are greater than target
+    if (strict) {
+      *result = nullptr;
+      return NodeOps::Validate(node, v);
+    }
+    return value_or_null();
+  }
+  const uint8_t b = static_cast<uint8_t>(target[depth]);
+  uint8_t key = 0;
+  const void* child = NodeOps::ChildAtOrBefore(node, b, &key);
+  if (!NodeOps::Validate(node, v)) {
+    return false;
+  }
+  if (child != nullptr && key == b) {
+    path->push_back({node, v, key});
+    if (IsLeafPtr(child)) {
+      const Leaf* leaf = ART_LEAF(child);
+      int c2 = EntryOps::LeafKey(leaf).compare(target);
+      if (c2 < 0 || (c2 == 0 && !strict)) {
+        *result = leaf;
+        return true;
+      }
+    } else {
+      const Node* child_node = static_cast<const Node*>(child);
+      uint64_t child_v;
+      if (!NodeOps::ReadLock(child_node, &child_v) ||
+          !NodeOps::Validate(node, v)) {
+        return false;
+      }
+      if (!UpperBoundFrom(child_node, child_v, depth + 1, target, strict,
+                          result, path)) {
+        return false;
+      }
+      if (*result != nullptr) {
+        return true;
+      }
+    }
+    path->resize(path_size);
+    if (b == 0) {
+      return value_or_null();
+    }
+    child = NodeOps::ChildAtOrBefore(node, b - 1, &key);
+    if (!NodeOps::Validate(node, v)) {
+      return false;
+    }
+  }
+  if (child != nullptr) {
+    path->push_back({node, v, key});
+    return MaximumFrom(child, result, path);
+  }
+  return value_or_null();
+}
+
+const AdaptiveRadixTree::Leaf* AdaptiveRadixTree::LowerBound(
+    const Slice& target, bool strict, std::vector<PathEntry>* path) const {
+  for (;;) {
+    path->clear();
+    uint64_t v;
+    const Leaf* result = nullptr;
+    if (NodeOps::ReadLock(root_, &v) &&
+        LowerBoundFrom(root_, v, 0, target, strict, &result, path)) {
+      return result;
+    }
+    RestartPause();
+  }
+}
+
+const AdaptiveRadixTree::Leaf* AdaptiveRadixTree::UpperBound(
+    const Slice& target, bool strict, std::vector<PathEntry>* path) const {
+  for (;;) {
+    path->clear();
+    uint64_t v;
+    const Leaf* result = nullptr;
+    if (NodeOps::ReadLock(root_, &v) &&
+        UpperBoundFrom(root_, v, 0, target, strict, &result, path)) {
+      return result;
+    }
+    RestartPause();
+  }
+}
+
+const AdaptiveRadixTree::Leaf* AdaptiveRadixTree::First(
+    std::vector<PathEntry>* path) const {
+  for (;;) {
+    path->clear();
+    const Leaf* result = nullptr;
+    if (MinimumFrom(root_, &result, path)) {
+      return result;
+    }
+    RestartPause();
+  }
+}
+
+const AdaptiveRadixTree::Leaf* AdaptiveRadixTree::Last(
+    std::vector<PathEntry>* path) const {
+  for (;;) {
+    path->clear();
+    const Leaf* result = nullptr;
+    if (MaximumFrom(root_, &result, path)) {
+      return result;
+    }
+    RestartPause();
+  }
+}
+
+bool AdaptiveRadixTree::StepForward(std::vector<PathEntry>* path,
+                                    const Leaf** leaf) const {
+  while (!path->empty()) {
+    PathEntry& pe = path->back();
+    if (pe.byte < 255) {
+      uint8_t key = 0;
+      const void* child = NodeOps::ChildAtOrAfter(pe.node, pe.byte + 1, &key);
+      if (!NodeOps::Validate(pe.node, pe.version)) {
+        return false;
+      }
+      if (child != nullptr) {
+        pe.byte = key;
+        return MinimumFrom(child, leaf, path);
+      }
+    }
+    path->pop_back();
+  }
+  *leaf = nullptr;
+  return true;
+}
+
+bool AdaptiveRadixTree::StepBackward(std::vector<PathEntry>* path,
+                                     const Leaf** leaf) const {
+  while (!path->empty()) {
+    PathEntry& pe = path->back();
+    if (pe.byte > 0) {
+      uint8_t key = 0;
+      const void* child = NodeOps::ChildAtOrBefore(pe.node, pe.byte - 1, &key);
+      if (!NodeOps::Validate(pe.node, pe.version)) {
+        return false;
+      }
+      if (child != nullptr) {
+        pe.byte = key;
+        return MaximumFrom(child, leaf, path);
+      }
+    }
+    if (pe.byte >= 0) {
+      const Leaf* value = pe.node->value.load(std::memory_order_acquire);
+      if (!NodeOps::Validate(pe.node, pe.version)) {
+        return false;
+      }
+      if (value != nullptr) {
+        pe.byte = -1;
+        *leaf = value;
+        return true;
+      }
+    }
+    path->pop_back();
+  }
+  *leaf = nullptr;
+  return true;
+}
+
+void AdaptiveRadixTree::ValidateNode(const Node* node, size_t depth,
+                                     std::string* prefix,
+                                     std::string* last_key) const {
+  uint64_t v = node->version.load(std::memory_order_relaxed);
+  assert((v & (kObsoleteBit | kLockedBit)) == 0);
+  (void)v;
+  const size_t saved = prefix->size();
+  const uint32_t plen = node->prefix_len.load(std::memory_order_relaxed);
+  prefix->append(node->prefix.load(std::memory_order_relaxed), plen);
+  depth += plen;
+  auto check_leaf = [&](const Leaf* leaf) {
+    Slice k = EntryOps::LeafKey(leaf);
+    assert(k.starts_with(*prefix));
+    assert(last_key->empty() || Slice(*last_key).compare(k) < 0);
+    last_key->assign(k.data(), k.size());
+    const Entry* e = leaf->head.load(std::memory_order_relaxed);
+    assert(e != nullptr);
+    for (const Entry* n = e->next.load(std::memory_order_relaxed);
+         n != nullptr; e = n, n = n->next.load(std::memory_order_relaxed)) {
+      assert(EntryOps::UserKey(n) == k);
+      assert(EntryOps::Tag(e) > EntryOps::Tag(n));
+    }
+  };
+  const Leaf* value = node->value.load(std::memory_order_relaxed);
+  if (value != nullptr) {
+    assert(EntryOps::LeafKey(value).size() == depth);
+    check_leaf(value);
+  }
+  size_t num_children = 0;
+  uint8_t key = 0;
+  for (int b = 0; b < 256; b = key + 1) {
+    const void* child = NodeOps::ChildAtOrAfter(node, b, &key);
+    if (child == nullptr) {
+      break;
+    }
+    ++num_children;
+    assert(NodeOps::FindChild(node, key) == child);
+    prefix->push_back(static_cast<char>(key));
+    if (IsLeafPtr(child)) {
+      check_leaf(ART_LEAF(child));
+    } else {
+      ValidateNode(static_cast<const Node*>(child), depth + 1, prefix,
+                   last_key);
+    }
+    prefix->pop_back();
+    if (key == 255) {
+      break;
+    }
+  }
+  assert(num_children == node->num_children.load(std::memory_order_relaxed));
+  (void)num_children;
+  prefix->resize(saved);
+}
+
+void AdaptiveRadixTree::TEST_Validate() const {
+  std::string prefix, last_key;
+  ValidateNode(root_, 0, &prefix, &last_key);
+}
+
+AdaptiveRadixTree::Iterator::Iterator(const AdaptiveRadixTree* tree)
+    : tree_(tree) {}
+
+const char* AdaptiveRadixTree::Iterator::key() const {
+  assert(Valid());
+  return entry_->Key();
+}
+
+void AdaptiveRadixTree::Iterator::SetLeafFirst(const Leaf* leaf) {
+  leaf_ = leaf;
+  entry_ = leaf ? leaf->head.load(std::memory_order_acquire) : nullptr;
+}
+
+void AdaptiveRadixTree::Iterator::SetLeafLast(const Leaf* leaf) {
+  leaf_ = leaf;
+  entry_ = nullptr;
+  if (leaf != nullptr) {
+    const Entry* e = leaf->head.load(std::memory_order_acquire);
+    for (const Entry* n; (n = e->next.load(std::memory_order_acquire));) {
+      e = n;
+    }
+    entry_ = e;
+  }
+}
+
+void AdaptiveRadixTree::Iterator::Next() {
+  assert(Valid());
+  const Entry* next = entry_->next.load(std::memory_order_acquire);
+  if (next != nullptr) {
+    entry_ = next;
+    return;
+  }
+  const Leaf* leaf = nullptr;
+  if (!tree_->StepForward(&path_, &leaf)) {
+    leaf = tree_->LowerBound(EntryOps::LeafKey(leaf_), true, &path_);
+  }
+  SetLeafFirst(leaf);
+}
+
+void AdaptiveRadixTree::Iterator::Prev() {
+  assert(Valid());
+  const Entry* e = leaf_->head.load(std::memory_order_acquire);
+  if (e != entry_) {
+    for (const Entry* n; (n = e->next.load(std::memory_order_acquire)) !=
+                         entry_;) {
+      e = n;
+    }
+    entry_ = e;
+    return;
+  }
+  const Leaf* leaf = nullptr;
+  if (!tree_->StepBackward(&path_, &leaf)) {
+    leaf = tree_->UpperBound(EntryOps::LeafKey(leaf_), true, &path_);
+  }
+  SetLeafLast(leaf);
+}
+
+void AdaptiveRadixTree::Iterator::Seek(const Slice& internal_key) {
+  const Slice ukey = ExtractUserKey(internal_key);
+  const uint64_t tag = ExtractInternalKeyFooter(internal_key);
+  const Leaf* leaf = tree_->LowerBound(ukey, false, &path_);
+  if (leaf != nullptr && EntryOps::LeafKey(leaf) == ukey) {
+    // internal keys of the same user key are ordered by descending tag
+    const Entry* e = leaf->head.load(std::memory_order_acquire);
+    while (e != nullptr && EntryOps::Tag(e) > tag) {
+      e = e->next.load(std::memory_order_acquire);
+    }
+    if (e != nullptr) {
+      leaf_ = leaf;
+      entry_ = e;
+      return;
+    }
+    if (!tree_->StepForward(&path_, &leaf)) {
+      leaf = tree_->LowerBound(ukey, true, &path_);
+    }
+  }
+  SetLeafFirst(leaf);
+}
+
+void AdaptiveRadixTree::Iterator::SeekForPrev(const Slice& internal_key) {
+  const Slice ukey = ExtractUserKey(internal_key);
+  const uint64_t tag = ExtractInternalKeyFooter(internal_key);
+  const Leaf* leaf = tree_->UpperBound(ukey, false, &path_);
+  if (leaf != nullptr && EntryOps::LeafKey(leaf) == ukey) {
+    const Entry* last = nullptr;
+    for (const Entry* e = leaf->head.load(std::memory_order_acquire);
+         e != nullptr && EntryOps::Tag(e) >= tag;
+         e = e->next.load(std::memory_order_acquire)) {
+      last = e;
+    }
+    if (last != nullptr) {
+      leaf_ = leaf;
+      entry_ = last;
+      return;
+    }
+    if (!tree_->StepBackward(&path_, &leaf)) {
+      leaf = tree_->UpperBound(ukey, true, &path_);
+    }
+  }
+  SetLeafLast(leaf);
+}
+
+void AdaptiveRadixTree::Iterator::SeekToFirst() {
+  SetLeafFirst(tree_->First(&path_));
+}
+
+void AdaptiveRadixTree::Iterator::SeekToLast() {
+  SetLeafLast(tree_->Last(&path_));
+}
+
+void AdaptiveRadixTree::Iterator::SeekUserKey(const Slice& user_key,
+                                              uint64_t tag) {
+  path_.clear();
+  leaf_ = tree_->FindLeaf(user_key);
+  entry_ = nullptr;
+  if (leaf_ != nullptr) {
+    const Entry* e = leaf_->head.load(std::memory_order_acquire);
+    while (e != nullptr && EntryOps::Tag(e) > tag) {
+      e = e->next.load(std::memory_order_acquire);
+    }
+    entry_ = e;
+  }
+}
+
+void AdaptiveRadixTree::Iterator::NextSameUserKey() {
+  assert(Valid());
+  entry_ = entry_->next.load(std::memory_order_acquire);
+}
+
+#undef ART_LEAF
+
+}  // namespace ROCKSDB_NAMESPACE
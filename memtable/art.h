@@ -0,0 +1,216 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// AdaptiveRadixTree is an ordered index of memtable entries keyed by the
+// bytes of the user key, following "The Adaptive Radix Tree: ARTful Indexing
+// for Main-Memory Databases" (Leis et al., ICDE 2013).  Inner nodes adapt
+// their fan-out (4, 16, 48 or 256 children) to the number of distinct bytes
+// seen at their depth, and common key fragments are collapsed into a
+// per-node prefix, so a lookup touches O(key length) mostly cache-resident
+// nodes instead of O(log N) randomly placed skip list nodes.
+//
+// Entries use the regular memtable encoding (varint32 internal key length,
+// internal key, varint32 value length, value).  Since the tree is ordered by
+// raw bytes of the user key, it only supports the bytewise comparator.  All
+// entries that share a user key hang off a single leaf, in a singly linked
+// list sorted by descending (sequence, type) tag, which is exactly the
+// internal key order.
+//
+// Thread safety -------------
+//
+// Like InlineSkipList, Insert requires external synchronization, while
+// InsertConcurrently may be called concurrently with reads and with other
+// concurrent inserts.  Concurrency control on inner nodes uses Optimistic
+// Lock Coupling ("The ART of Practical Synchronization", Leis et al., DaMoN
+// 2016): every inner node carries a version word, writers lock the (at most
+// two) nodes they modify, and readers never write shared memory -- they
+// validate the versions they read and restart on conflict.
+//
+// Invariants:
+//
+// (1) Nothing is freed before the tree is destroyed.  Nodes replaced by a
+// bigger node are only marked obsolete, so readers still traversing them
+// always dereference valid memory; the version check sends them back to the
+// root.
+//
+// (2) An entry is immutable once linked into its leaf, and a leaf never
+// leaves the tree, so readers positioned on an entry can always continue.
+
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <vector>
+
+#include "memory/allocator.h"
+#include "port/likely.h"
+#include "rocksdb/slice.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class AdaptiveRadixTree {
+ private:
+  struct Entry;
+  struct Leaf;
+  struct Node;
+  struct Node4;
+  struct Node16;
+  struct Node48;
+  struct Node256;
+  struct NodeOps;
+  struct EntryOps;
+
+  // One step of a root-to-leaf path, see Iterator::path_
+  struct PathEntry {
+    const Node* node;
+    uint64_t version;
+    // Byte of the child on the path, -1 if the path ends at node's value
+    int byte;
+  };
+
+ public:
+  // Objects allocated in the allocator must remain allocated for the
+  // lifetime of the tree.
+  explicit AdaptiveRadixTree(Allocator* allocator);
+  // No copying allowed
+  AdaptiveRadixTree(const AdaptiveRadixTree&) = delete;
+  AdaptiveRadixTree& operator=(const AdaptiveRadixTree&) = delete;
+
+  // Allocates an entry of key_size bytes, returning a pointer to the key
+  // portion.  Thread-safe if the allocator is thread-safe.
+  char* AllocateKey(size_t key_size);
+
+  // Inserts a key allocated by AllocateKey, after it has been filled in.
+  // Returns false if an entry with the same internal key already exists.
+  //
+  // REQUIRES: no concurrent calls to any of inserts.
+  bool Insert(const char* key);
+
+  // Like Insert, but external synchronization is not required.
+  bool InsertConcurrently(const char* key);
+
+  // Returns true iff an entry whose internal key equals the internal key of
+  // the memtable key `key` is in the tree.
+  bool Contains(const char* key) const;
+
+  // Number of distinct user keys and of entries in the tree.
+  size_t NumLeaves() const {
+    return num_leaves_.load(std::memory_order_relaxed);
+  }
+  size_t NumEntries() const {
+    return num_entries_.load(std::memory_order_relaxed);
+  }
+
+  // Validate the structure of the tree.  Only valid when there are no
+  // concurrent writers.
+  void TEST_Validate() const;
+
+  // Iteration over the entries in internal key order.
+  class Iterator {
+   public:
+    // Initialize an iterator over the specified tree.
+    // The returned iterator is not valid.
+    explicit Iterator(const AdaptiveRadixTree* tree);
+
+    // Returns true iff the iterator is positioned at a valid entry.
+    bool Valid() const { return entry_ != nullptr; }
+
+    // Returns the memtable key at the current position.
+    // REQUIRES: Valid()
+    const char* key() const;
+
+    // Advances to the next position.
+    // REQUIRES: Valid()
+    void Next();
+
+    // Advances to the previous position.
+    // REQUIRES: Valid()
+    void Prev();
+
+    // Advance to the first entry with an internal key >= target, target is
+    // an internal key (not length prefixed).
+    void Seek(const Slice& internal_key);
+
+    // Retreat to the last entry with an internal key <= target
+    void SeekForPrev(const Slice& internal_key);
+
+    // Position at the first entry in the tree.
+    // Final state of iterator is Valid() iff the tree is not empty.
+    void SeekToFirst();
+
+    // Position at the last entry in the tree.
+    // Final state of iterator is Valid() iff the tree is not empty.
+    void SeekToLast();
+
+    // Position at the newest entry of `user_key` whose tag is not greater
+    // than `tag`, entries of other user keys are never visited.
+    // Final state of iterator is Valid() iff such entry exists.
+    void SeekUserKey(const Slice& user_key, uint64_t tag);
+
+    // Advances to the next entry with the same user key.
+    // REQUIRES: Valid()
+    void NextSameUserKey();
+
+   private:
+    void SetLeafFirst(const Leaf* leaf);
+    void SetLeafLast(const Leaf* leaf);
+
+    const AdaptiveRadixTree* tree_;
+    const Leaf* leaf_ = nullptr;
+    const Entry* entry_ = nullptr;
+    // Path of inner nodes from root to leaf_, used to step to the adjacent
+    // leaf without descending from the root.  Stale paths are detected by
+    // version validation, then the iterator falls back to a full descent.
+    std::vector<PathEntry> path_;
+  };
+
+ private:
+  Allocator* const allocator_;
+  Node256* const root_;
+  std::atomic<size_t> num_leaves_;
+  std::atomic<size_t> num_entries_;
+
+  bool InsertImpl(Entry* entry);
+
+  Leaf* NewLeaf(Entry* entry);
+  Node4* NewNode4(const char* prefix, uint32_t prefix_len);
+
+  // Returns the leaf of user_key, or nullptr if absent.
+  const Leaf* FindLeaf(const Slice& user_key) const;
+
+  // Leaf with the smallest user key >= (or > if strict) target.  Fills path
+  // (if not null) with the inner nodes leading to the result.
+  const Leaf* LowerBound(const Slice& target, bool strict,
+                         std::vector<PathEntry>* path) const;
+  // Leaf with the largest user key <= (or < if strict) target.
+  const Leaf* UpperBound(const Slice& target, bool strict,
+                         std::vector<PathEntry>* path) const;
+  const Leaf* First(std::vector<PathEntry>* path) const;
+  const Leaf* Last(std::vector<PathEntry>* path) const;
+
+  // Step to the adjacent leaf using `path`, returns false if the path is
+  // stale and caller must fall back to LowerBound/UpperBound.
+  bool StepForward(std::vector<PathEntry>* path, const Leaf** leaf) const;
+  bool StepBackward(std::vector<PathEntry>* path, const Leaf** leaf) const;
+
+  // Recursive helpers, return false if a restart is required.
+  bool LowerBoundFrom(const Node* node, uint64_t version, size_t depth,
+                      const Slice& target, bool strict, const Leaf** result,
+                      std::vector<PathEntry>* path) const;
+  bool UpperBoundFrom(const Node* node, uint64_t version, size_t depth,
+                      const Slice& target, bool strict, const Leaf** result,
+                      std::vector<PathEntry>* path) const;
+  bool MinimumFrom(const void* child, const Leaf** result,
+                   std::vector<PathEntry>* path) const;
+  bool MaximumFrom(const void* child, const Leaf** result,
+                   std::vector<PathEntry>* path) const;
+
+  void ValidateNode(const Node* node, size_t depth, std::string* prefix,
+                    std::string* last_key) const;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
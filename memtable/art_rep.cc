@@ -0,0 +1,169 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+#include "db/builder.h"
+#include "db/memtable.h"
+#include "memory/arena.h"
+#include "memtable/art.h"
+#include "rocksdb/comparator.h"
+#include "rocksdb/memtablerep.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+class AdaptiveRadixTreeRep : public MemTableRep {
+  AdaptiveRadixTree tree_;
+
+ public:
+  explicit AdaptiveRadixTreeRep(Allocator* allocator)
+      : MemTableRep(allocator), tree_(allocator) {}
+
+  KeyHandle Allocate(const size_t len, char** buf) override {
+    *buf = tree_.AllocateKey(len);
+    return static_cast<KeyHandle>(*buf);
+  }
+
+  void Insert(KeyHandle handle) override {
+    tree_.Insert(static_cast<char*>(handle));
+  }
+
+  bool InsertKey(KeyHandle handle) override {
+    return tree_.Insert(static_cast<char*>(handle));
+  }
+
+  // The tree has no use for hints, a lookup is already O(key length)
+  void InsertWithHint(KeyHandle handle, void** /*hint*/) override {
+    tree_.Insert(static_cast<char*>(handle));
+  }
+
+  bool InsertKeyWithHint(KeyHandle handle, void** /*hint*/) override {
+    return tree_.Insert(static_cast<char*>(handle));
+  }
+
+  void InsertWithHintConcurrently(KeyHandle handle, void** /*hint*/) override {
+    tree_.InsertConcurrently(static_cast<char*>(handle));
+  }
+
+  bool InsertKeyWithHintConcurrently(KeyHandle handle,
+                                     void** /*hint*/) override {
+    return tree_.InsertConcurrently(static_cast<char*>(handle));
+  }
+
+  void InsertConcurrently(KeyHandle handle) override {
+    tree_.InsertConcurrently(static_cast<char*>(handle));
+  }
+
+  bool InsertKeyConcurrently(KeyHandle handle) override {
+    return tree_.InsertConcurrently(static_cast<char*>(handle));
+  }
+
+  // Returns true iff an entry that compares equal to key is in the tree.
+  bool Contains(const Slice& internal_key) const override {
+    return ContainsForwardToLegacy(tree_, internal_key);
+  }
+
+  size_t ApproximateMemoryUsage() override {
+    // All memory is allocated through allocator; nothing to report here
+    return 0;
+  }
+
+  // Only visits the entries of k.user_key(), newest first
+  void Get(const ReadOptions&, const LookupKey& k, void* callback_args,
+           bool (*callback_func)(void* arg, const KeyValuePair&)) override {
+    Slice ikey = k.internal_key();
+    AdaptiveRadixTree::Iterator iter(&tree_);
+    for (iter.SeekUserKey(ExtractUserKey(ikey), ExtractInternalKeyFooter(ikey));
+         iter.Valid() && callback_func(callback_args, KeyValuePair(iter.key()));
+         iter.NextSameUserKey()) {
+    }
+  }
+
+  bool NeedsUserKeyCompareInGet() const override { return false; }
+
+  bool SupportConvertToSST() const override { return true; }
+
+  Status ConvertToSST(FileMetaData* meta,
+                      const TableBuilderOptions& tbo) override {
+    Iterator iter(&tree_);
+    return BuildTableFromSortedIterator(tbo, &iter, meta);
+  }
+
+  ~AdaptiveRadixTreeRep() override {}
+
+  // Iteration over the contents of the tree
+  class Iterator : public MemTableRep::Iterator {
+    AdaptiveRadixTree::Iterator iter_;
+
+   public:
+    // Initialize an iterator over the specified tree.
+    // The returned iterator is not valid.
+    explicit Iterator(const AdaptiveRadixTree* tree) : iter_(tree) {}
+
+    ~Iterator() override {}
+
+    // Returns true iff the iterator is positioned at a valid node.
+    bool Valid() const override { return iter_.Valid(); }
+
+    // Returns the key at the current position.
+    // REQUIRES: Valid()
+    const char* varlen_key() const override { return iter_.key(); }
+    using MemTableRep::Iterator::Seek;
+    using MemTableRep::Iterator::SeekForPrev;
+
+    // Advances to the next position.
+    // REQUIRES: Valid()
+    void Next() override { iter_.Next(); }
+
+    // Advances to the previous position.
+    // REQUIRES: Valid()
+    void Prev() override { iter_.Prev(); }
+
+    // Advance to the first entry with a key >= target
+    void Seek(const Slice& internal_key, const char* memtable_key) override {
+      if (memtable_key != nullptr) {
+        iter_.Seek(GetLengthPrefixedSlice(memtable_key));
+      } else {
+        iter_.Seek(internal_key);
+      }
+    }
+
+    // Retreat to the last entry with a key <= target
+    void SeekForPrev(const Slice& internal_key,
+                     const char* memtable_key) override {
+      if (memtable_key != nullptr) {
+        iter_.SeekForPrev(GetLengthPrefixedSlice(memtable_key));
+      } else {
+        iter_.SeekForPrev(internal_key);
+      }
+    }
+
+    // Position at the first entry in the tree.
+    // Final state of iterator is Valid() iff the tree is not empty.
+    void SeekToFirst() override { iter_.SeekToFirst(); }
+
+    // Position at the last entry in the tree.
+    // Final state of iterator is Valid() iff the tree is not empty.
+    void SeekToLast() override { iter_.SeekToLast(); }
+  };
+
+  MemTableRep::Iterator* GetIterator(Arena* arena = nullptr) override {
+    void* mem = arena ? arena->AllocateAligned(sizeof(Iterator))
+                      : operator new(sizeof(Iterator));
+    return new (mem) Iterator(&tree_);
+  }
+};
+}  // namespace
+
+MemTableRep* AdaptiveRadixTreeRepFactory::CreateMemTableRep(
+    const MemTableRep::KeyComparator& compare, Allocator* allocator,
+    const SliceTransform* transform, Logger* logger) {
+  const Comparator* ucmp = compare.icomparator()->user_comparator();
+  if (!IsForwardBytewiseComparator(ucmp) || ucmp->timestamp_size() != 0) {
+    // The tree is ordered by raw key bytes
+    return fallback_.CreateMemTableRep(compare, allocator, transform, logger);
+  }
+  return new AdaptiveRadixTreeRep(allocator);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,310 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "memtable/art.h"
+
+#include <atomic>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "memory/concurrent_arena.h"
+#include "rocksdb/comparator.h"
+#include "test_util/testharness.h"
+#include "util/coding.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// Internal key of (user_key, seq), ordered by InternalKeyComparator
+std::string IKey(const std::string& user_key, SequenceNumber seq) {
+  std::string ikey;
+  AppendInternalKey(&ikey, ParsedInternalKey(user_key, seq, kTypeValue));
+  return ikey;
+}
+
+struct IKeyLess {
+  InternalKeyComparator icmp{BytewiseComparator()};
+  bool operator()(const std::string& a, const std::string& b) const {
+    return icmp.Compare(a, b) < 0;
+  }
+};
+
+using Model = std::set<std::string, IKeyLess>;
+
+Slice KeyOf(const char* memtable_key) {
+  return GetLengthPrefixedSlice(memtable_key);
+}
+
+}  // namespace
+
+class ARTTest : public testing::Test {
+ public:
+  ARTTest() : tree_(&arena_) {}
+
+  // Encodes ikey in the memtable format with an empty value
+  const char* Encode(const std::string& ikey) {
+    size_t len = VarintLength(ikey.size()) + ikey.size() + 1;
+    char* buf = tree_.AllocateKey(len);
+    char* p = EncodeVarint32(buf, static_cast<uint32_t>(ikey.size()));
+    memcpy(p, ikey.data(), ikey.size());
+    p[ikey.size()] = 0;
+    return buf;
+  }
+
+  bool Insert(const std::string& user_key, SequenceNumber seq) {
+    std::string ikey = IKey(user_key, seq);
+    bool inserted = tree_.Insert(Encode(ikey));
+    if (inserted) {
+      model_.insert(ikey);
+    }
+    return inserted;
+  }
+
+  void CheckIteration() {
+    AdaptiveRadixTree::Iterator iter(&tree_);
+    iter.SeekToFirst();
+    for (auto& k : model_) {
+      ASSERT_TRUE(iter.Valid());
+      ASSERT_EQ(KeyOf(iter.key()), Slice(k));
+      iter.Next();
+    }
+    ASSERT_FALSE(iter.Valid());
+
+    iter.SeekToLast();
+    for (auto it = model_.rbegin(); it != model_.rend(); ++it) {
+      ASSERT_TRUE(iter.Valid());
+      ASSERT_EQ(KeyOf(iter.key()), Slice(*it));
+      iter.Prev();
+    }
+    ASSERT_FALSE(iter.Valid());
+  }
+
+  void CheckSeek(const std::string& target) {
+    AdaptiveRadixTree::Iterator iter(&tree_);
+    iter.Seek(target);
+    auto lb = model_.lower_bound(target);
+    if (lb == model_.end()) {
+      ASSERT_FALSE(iter.Valid());
+    } else {
+      ASSERT_TRUE(iter.Valid());
+      ASSERT_EQ(KeyOf(iter.key()), Slice(*lb));
+      // stepping back lands on the predecessor
+      iter.Prev();
+      if (lb == model_.begin()) {
+        ASSERT_FALSE(iter.Valid());
+      } else {
+        ASSERT_TRUE(iter.Valid());
+        ASSERT_EQ(KeyOf(iter.key()), Slice(*std::prev(lb)));
+      }
+    }
+
+    iter.SeekForPrev(target);
+    auto ub = model_.upper_bound(target);
+    if (ub == model_.begin()) {
+      ASSERT_FALSE(iter.Valid());
+    } else {
+      --ub;
+      ASSERT_TRUE(iter.Valid());
+      ASSERT_EQ(KeyOf(iter.key()), Slice(*ub));
+      iter.Next();
+      if (++ub == model_.end()) {
+        ASSERT_FALSE(iter.Valid());
+      } else {
+        ASSERT_TRUE(iter.Valid());
+        ASSERT_EQ(KeyOf(iter.key()), Slice(*ub));
+      }
+    }
+  }
+
+ protected:
+  ConcurrentArena arena_;
+  AdaptiveRadixTree tree_;
+  Model model_;
+};
+
+TEST_F(ARTTest, Empty) {
+  AdaptiveRadixTree::Iterator iter(&tree_);
+  ASSERT_FALSE(iter.Valid());
+  iter.SeekToFirst();
+  ASSERT_FALSE(iter.Valid());
+  iter.SeekToLast();
+  ASSERT_FALSE(iter.Valid());
+  iter.Seek(IKey("foo", 100));
+  ASSERT_FALSE(iter.Valid());
+  iter.SeekForPrev(IKey("foo", 100));
+  ASSERT_FALSE(iter.Valid());
+  ASSERT_EQ(0u, tree_.NumEntries());
+  tree_.TEST_Validate();
+}
+
+TEST_F(ARTTest, PrefixKeysAndVersions) {
+  // keys that are prefixes of each other, including the empty key
+  const std::vector<std::string> user_keys = {
+      "", "a", "ab", "abc", "abcd", "abd", "b", "ba", "bab", "zzzzzzzz",
+      "zzzzzzzza", std::string("\0", 1), std::string("a\0b", 3),
+      std::string("\xff\xff", 2)};
+  SequenceNumber seq = 1;
+  for (int round = 0; round < 3; ++round) {
+    for (auto& k : user_keys) {
+      ASSERT_TRUE(Insert(k, seq++));
+    }
+  }
+  // duplicated internal key is rejected
+  ASSERT_FALSE(Insert("abc", 4));
+  ASSERT_EQ(user_keys.size(), tree_.NumLeaves());
+  ASSERT_EQ(model_.size(), tree_.NumEntries());
+  tree_.TEST_Validate();
+  CheckIteration();
+
+  for (auto& k : user_keys) {
+    for (SequenceNumber s = 0; s <= seq; ++s) {
+      CheckSeek(IKey(k, s));
+    }
+    CheckSeek(IKey(k + "0", kMaxSequenceNumber));
+    CheckSeek(IKey(k + "\xff", 0));
+  }
+
+  std::string memtable_key;
+  for (auto& ikey : model_) {
+    ASSERT_TRUE(tree_.Contains(EncodeKey(&memtable_key, ikey)));
+  }
+  ASSERT_FALSE(tree_.Contains(EncodeKey(&memtable_key, IKey("abc", 1000))));
+  ASSERT_FALSE(tree_.Contains(EncodeKey(&memtable_key, IKey("abcde", 1))));
+}
+
+TEST_F(ARTTest, GetUserKey) {
+  ASSERT_TRUE(Insert("key", 10));
+  ASSERT_TRUE(Insert("key", 20));
+  ASSERT_TRUE(Insert("key", 30));
+  ASSERT_TRUE(Insert("key1", 25));
+  AdaptiveRadixTree::Iterator iter(&tree_);
+  iter.SeekUserKey("key", PackSequenceAndType(25, kValueTypeForSeek));
+  ASSERT_TRUE(iter.Valid());
+  ASSERT_EQ(KeyOf(iter.key()), Slice(IKey("key", 20)));
+  iter.NextSameUserKey();
+  ASSERT_TRUE(iter.Valid());
+  ASSERT_EQ(KeyOf(iter.key()), Slice(IKey("key", 10)));
+  iter.NextSameUserKey();
+  ASSERT_FALSE(iter.Valid());
+  iter.SeekUserKey("key", PackSequenceAndType(5, kValueTypeForSeek));
+  ASSERT_FALSE(iter.Valid());
+  iter.SeekUserKey("ke", kMaxSequenceNumber);
+  ASSERT_FALSE(iter.Valid());
+}
+
+TEST_F(ARTTest, NodeGrowth) {
+  // fill every fan-out of every node type: one shared prefix, then all
+  // possible bytes, then a second level under a few of them
+  SequenceNumber seq = 1;
+  for (int b = 0; b < 256; ++b) {
+    std::string k = "prefix";
+    k.push_back(static_cast<char>(b));
+    ASSERT_TRUE(Insert(k, seq++));
+    if (b == 3 || b == 15 || b == 47 || b == 255) {
+      tree_.TEST_Validate();
+      CheckIteration();
+    }
+    if (b % 64 == 0) {
+      for (int c = 255; c >= 0; --c) {
+        ASSERT_TRUE(Insert(k + static_cast<char>(c), seq++));
+      }
+    }
+  }
+  tree_.TEST_Validate();
+  CheckIteration();
+  Random rnd(301);
+  for (int i = 0; i < 1000; ++i) {
+    CheckSeek(IKey("prefix" + rnd.RandomBinaryString(rnd.Uniform(3)),
+                   rnd.Uniform(static_cast<int>(seq))));
+  }
+}
+
+TEST_F(ARTTest, RandomInsertAndSeek) {
+  Random rnd(test::RandomSeed());
+  SequenceNumber seq = 1;
+  std::vector<std::string> user_keys;
+  for (int i = 0; i < 5000; ++i) {
+    std::string k;
+    if (!user_keys.empty() && rnd.OneIn(3)) {
+      // extend or reuse an existing key to create shared paths
+      k = user_keys[rnd.Uniform(static_cast<int>(user_keys.size()))];
+      if (rnd.OneIn(2)) {
+        k += rnd.RandomBinaryString(rnd.Uniform(4));
+      }
+    } else {
+      k = rnd.RandomBinaryString(rnd.Uniform(12));
+    }
+    user_keys.push_back(k);
+    Insert(k, seq++);
+  }
+  tree_.TEST_Validate();
+  CheckIteration();
+  for (int i = 0; i < 2000; ++i) {
+    std::string k = rnd.OneIn(2)
+                        ? user_keys[rnd.Uniform(
+                              static_cast<int>(user_keys.size()))]
+                        : rnd.RandomBinaryString(rnd.Uniform(12));
+    CheckSeek(IKey(k, rnd.Uniform(static_cast<int>(seq) + 1)));
+  }
+}
+
+TEST_F(ARTTest, ConcurrentInsert) {
+  const int kThreads = 4;
+  const int kPerThread = 20000;
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([this, t]() {
+      Random rnd(t + 1);
+      for (int i = 0; i < kPerThread; ++i) {
+        // overlapping user keys, unique sequence numbers
+        std::string k = std::to_string(rnd.Uniform(kPerThread));
+        std::string ikey = IKey(k, static_cast<SequenceNumber>(i) * kThreads +
+                                       t + 1);
+        ASSERT_TRUE(tree_.InsertConcurrently(Encode(ikey)));
+      }
+    });
+  }
+  // a concurrent reader only ever observes ordered data
+  std::atomic<bool> done{false};
+  port::Thread reader([this, &done]() {
+    IKeyLess less;
+    while (!done.load()) {
+      AdaptiveRadixTree::Iterator iter(&tree_);
+      std::string prev;
+      for (iter.SeekToFirst(); iter.Valid(); iter.Next()) {
+        std::string cur = KeyOf(iter.key()).ToString();
+        ASSERT_TRUE(prev.empty() || less(prev, cur));
+        prev = std::move(cur);
+      }
+    }
+  });
+  for (auto& t : threads) {
+    t.join();
+  }
+  done.store(true);
+  reader.join();
+
+  ASSERT_EQ(static_cast<size_t>(kThreads * kPerThread), tree_.NumEntries());
+  tree_.TEST_Validate();
+  AdaptiveRadixTree::Iterator iter(&tree_);
+  size_t count = 0;
+  for (iter.SeekToFirst(); iter.Valid(); iter.Next()) {
+    ++count;
+  }
+  ASSERT_EQ(tree_.NumEntries(), count);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
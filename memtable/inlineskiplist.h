@@ -119,6 +119,32 @@ class InlineSkipList {
   // Like Insert, but external synchronization is not required.
   bool InsertConcurrently(const char* key);
 
+  // Allocates num keys of key_sizes[i] bytes each, like AllocateKey, but
+  // carves the nodes out of as few allocations as possible and stores the
+  // key pointers in keys[].  Nodes of one run end up adjacent in memory,
+  // which helps both InsertSortedRun and later scans of the run.  This
+  // method is thread-safe if the allocator is thread-safe.
+  void AllocateKeys(const size_t* key_sizes, size_t num, char** keys);
+
+  // Inserts num keys allocated by AllocateKey(s), sorted in ascending order,
+  // e.g. consecutive puts of a sorted WriteBatch.  All the keys share one
+  // splice, so after the first key only the levels that the next key leaves
+  // are searched again (O(log D) instead of O(log N) per key, D being the
+  // distance between adjacent keys of the run), and the node of the next
+  // key is prefetched while the current one is linked.
+  //
+  // If inserted is not nullptr, inserted[i] tells whether keys[i] was
+  // inserted (false if it is a duplicate).  Returns the number of keys
+  // inserted.
+  //
+  // REQUIRES: keys[i] < keys[i + 1], except duplicates which are rejected
+  // REQUIRES: no concurrent calls to any of inserts.
+  size_t InsertSortedRun(const char* const* keys, size_t num, bool* inserted);
+
+  // Like InsertSortedRun, but external synchronization is not required.
+  size_t InsertSortedRunConcurrently(const char* const* keys, size_t num,
+                                     bool* inserted);
+
   // Inserts a node into the skip list.  key must have been allocated by
   // AllocateKey and then filled in by the caller.  If UseCAS is true,
   // then external synchronization is not required, otherwise this method
@@ -134,7 +160,10 @@ class InlineSkipList {
   // inserted immediately after the splice.  allow_partial_splice_fix ==
   // false has worse running time for the non-sequential case O(log N),
   // but a better constant factor.
-  template <bool UseCAS>
+  //
+  // kAscending means key is known to be greater than the key inserted last
+  // with this splice, so the splice is only checked on the right side.
+  template <bool UseCAS, bool kAscending = false>
   bool Insert(const char* key, Splice* splice, bool allow_partial_splice_fix);
 
   // Returns true iff an entry that compares equal to key is in the list.
@@ -756,6 +785,101 @@ bool InlineSkipList<Comparator>::InsertWithHintConcurrently(const char* key,
   return Insert<true>(key, splice, true);
 }
 
+template <class Comparator>
+void InlineSkipList<Comparator>::AllocateKeys(const size_t* key_sizes,
+                                              size_t num, char** keys) {
+  // Nodes are carved out of chunks of at most a quarter block, since bigger
+  // requests make the arena allocate a dedicated block for each of them.
+  const size_t max_chunk = allocator_->BlockSize() / 4;
+  constexpr size_t kAlign = alignof(Node);
+  constexpr size_t kMaxNodesPerChunk = 64;
+  int heights[kMaxNodesPerChunk];
+  size_t node_bytes[kMaxNodesPerChunk];
+  size_t begin = 0;
+  while (begin < num) {
+    size_t chunk = 0;
+    size_t end = begin;
+    for (; end < num && end - begin < kMaxNodesPerChunk; ++end) {
+      int height = RandomHeight();
+      size_t bytes = sizeof(std::atomic<Node*>) * (height - 1) + sizeof(Node) +
+                     key_sizes[end];
+      bytes = (bytes + kAlign - 1) & ~(kAlign - 1);
+      if (end > begin && chunk + bytes > max_chunk) {
+        break;
+      }
+      heights[end - begin] = height;
+      node_bytes[end - begin] = bytes;
+      chunk += bytes;
+    }
+    char* raw = allocator_->AllocateAligned(chunk);
+    for (size_t i = begin; i < end; ++i) {
+      // Same layout as AllocateNode
+      int height = heights[i - begin];
+      Node* x = reinterpret_cast<Node*>(
+          raw + sizeof(std::atomic<Node*>) * (height - 1));
+      x->StashHeight(height);
+      keys[i] = const_cast<char*>(x->Key());
+      raw += node_bytes[i - begin];
+    }
+    begin = end;
+  }
+}
+
+template <class Comparator>
+size_t InlineSkipList<Comparator>::InsertSortedRun(const char* const* keys,
+                                                   size_t num,
+                                                   bool* inserted) {
+  size_t count = 0;
+  for (size_t i = 0; i < num; ++i) {
+    if (i + 1 < num) {
+      // Height and key of the next node, needed right at the start of the
+      // next Insert
+      PREFETCH(keys[i + 1] - sizeof(Node), 1, 3);
+    }
+    bool ok = i == 0 ? Insert<false>(keys[i], seq_splice_, true)
+                     : Insert<false, true>(keys[i], seq_splice_, true);
+    if (inserted != nullptr) {
+      inserted[i] = ok;
+    }
+    count += ok;
+    // The successor is the first node the next key is compared against
+    Node* next = seq_splice_->next_[0];
+    if (next != nullptr) {
+      PREFETCH(next->Key(), 0, 1);
+    }
+  }
+  return count;
+}
+
+template <class Comparator>
+size_t InlineSkipList<Comparator>::InsertSortedRunConcurrently(
+    const char* const* keys, size_t num, bool* inserted) {
+  Node* prev[kMaxPossibleHeight];
+  Node* next[kMaxPossibleHeight];
+  Splice splice;
+  splice.prev_ = prev;
+  splice.next_ = next;
+  splice.height_ = 0;
+  size_t count = 0;
+  for (size_t i = 0; i < num; ++i) {
+    if (i + 1 < num) {
+      PREFETCH(keys[i + 1] - sizeof(Node), 1, 3);
+    }
+    // A failed CAS resets the splice height, then the next key does a full
+    // descent, which does not rely on kAscending
+    bool ok = i == 0 ? Insert<true>(keys[i], &splice, true)
+                     : Insert<true, true>(keys[i], &splice, true);
+    if (inserted != nullptr) {
+      inserted[i] = ok;
+    }
+    count += ok;
+    if (splice.height_ > 0 && splice.next_[0] != nullptr) {
+      PREFETCH(splice.next_[0]->Key(), 0, 1);
+    }
+  }
+  return count;
+}
+
 template <class Comparator>
 template <bool prefetch_before>
 void InlineSkipList<Comparator>::FindSpliceForLevel(const DecodedKey& key,
@@ -798,7 +922,7 @@ void InlineSkipList<Comparator>::RecomputeSpliceLevels(const DecodedKey& key,
 }
 
 template <class Comparator>
-template <bool UseCAS>
+template <bool UseCAS, bool kAscending>
 bool InlineSkipList<Comparator>::Insert(const char* key, Splice* splice,
                                         bool allow_partial_splice_fix) {
   Node* x = reinterpret_cast<Node*>(const_cast<char*>(key)) - 1;
@@ -869,7 +993,7 @@ bool InlineSkipList<Comparator>::Insert(const char* key, Splice* splice,
         // pessimistic about
         // our chances of success.
         ++recompute_height;
-      } else if (splice->prev_[recompute_height] != head_ &&
+      } else if (!kAscending && splice->prev_[recompute_height] != head_ &&
                  !KeyIsAfterNode(key_decoded,
                                  splice->prev_[recompute_height])) {
         // key is from before splice
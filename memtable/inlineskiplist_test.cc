@@ -9,8 +9,11 @@
 
 #include "memtable/inlineskiplist.h"
 
+#include <algorithm>
+#include <atomic>
 #include <set>
 #include <unordered_set>
+#include <vector>
 
 #include "memory/concurrent_arena.h"
 #include "rocksdb/env.h"
@@ -309,6 +312,105 @@ TEST_F(InlineSkipTest, InsertWithHint_CompatibleWithInsertWithoutHint) {
   Validate(&list);
 }
 
+TEST_F(InlineSkipTest, InsertSortedRun) {
+  const int N = 200;
+  const int kRunSize = 50;
+  Random rnd(301);
+  ConcurrentArena arena;
+  TestComparator cmp;
+  TestInlineSkipList list(cmp, &arena);
+  std::set<Key> model;
+  for (int n = 0; n < N; n++) {
+    // a sorted run, possibly with duplicates inside the run and against
+    // keys already in the list
+    std::vector<Key> run;
+    for (int i = 0; i < kRunSize; i++) {
+      run.push_back(rnd.Uniform(10000));
+    }
+    std::sort(run.begin(), run.end());
+    std::vector<size_t> sizes(run.size(), sizeof(Key));
+    std::vector<char*> bufs(run.size());
+    list.AllocateKeys(sizes.data(), run.size(), bufs.data());
+    size_t expected = 0;
+    bool expected_inserted[kRunSize];
+    for (size_t i = 0; i < run.size(); i++) {
+      memcpy(bufs[i], &run[i], sizeof(Key));
+      expected_inserted[i] = model.insert(run[i]).second;
+      expected += expected_inserted[i];
+    }
+    bool inserted[kRunSize];
+    ASSERT_EQ(expected,
+              list.InsertSortedRun(bufs.data(), run.size(), inserted));
+    for (size_t i = 0; i < run.size(); i++) {
+      ASSERT_EQ(expected_inserted[i], inserted[i]);
+      ASSERT_TRUE(list.Contains(bufs[i]));
+    }
+    // interleave with single inserts, which share the sequential splice
+    if (n % 3 == 0) {
+      Key key = rnd.Uniform(10000);
+      if (model.insert(key).second) {
+        char* buf = list.AllocateKey(sizeof(Key));
+        memcpy(buf, &key, sizeof(Key));
+        ASSERT_TRUE(list.Insert(buf));
+      }
+    }
+  }
+  list.TEST_Validate();
+  TestInlineSkipList::Iterator iter(&list);
+  iter.SeekToFirst();
+  for (Key key : model) {
+    ASSERT_TRUE(iter.Valid());
+    ASSERT_EQ(key, Decode(iter.key()));
+    iter.Next();
+  }
+  ASSERT_FALSE(iter.Valid());
+}
+
+TEST_F(InlineSkipTest, InsertSortedRunConcurrently) {
+  const int kThreads = 4;
+  const int kRuns = 200;
+  const int kRunSize = 32;
+  ConcurrentArena arena;
+  TestComparator cmp;
+  TestInlineSkipList list(cmp, &arena);
+  std::atomic<size_t> total{0};
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t]() {
+      Random rnd(t + 1);
+      for (int n = 0; n < kRuns; n++) {
+        // disjoint key spaces per thread, overlapping ranges across threads
+        std::vector<Key> run;
+        for (int i = 0; i < kRunSize; i++) {
+          run.push_back(rnd.Uniform(1 << 20) * kThreads + t);
+        }
+        std::sort(run.begin(), run.end());
+        std::vector<size_t> sizes(run.size(), sizeof(Key));
+        std::vector<char*> bufs(run.size());
+        list.AllocateKeys(sizes.data(), run.size(), bufs.data());
+        for (size_t i = 0; i < run.size(); i++) {
+          memcpy(bufs[i], &run[i], sizeof(Key));
+        }
+        total += list.InsertSortedRunConcurrently(bufs.data(), run.size(),
+                                                  nullptr);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  list.TEST_Validate();
+  TestInlineSkipList::Iterator iter(&list);
+  size_t count = 0;
+  Key prev = 0;
+  for (iter.SeekToFirst(); iter.Valid(); iter.Next()) {
+    ASSERT_TRUE(count == 0 || prev < Decode(iter.key()));
+    prev = Decode(iter.key());
+    ++count;
+  }
+  ASSERT_EQ(total.load(), count);
+}
+
 #if !defined(ROCKSDB_VALGRIND_RUN) || defined(ROCKSDB_FULL_VALGRIND_RUN)
 // We want to make sure that with a single writer and multiple
 // concurrent readers (with no synchronization other than when a
@@ -15,6 +15,7 @@ int main() {
 }
 #else
 
+#include <algorithm>
 #include <atomic>
 #include <iostream>
 #include <memory>
@@ -25,6 +26,8 @@ int main() {
 #include "db/dbformat.h"
 #include "db/memtable.h"
 #include "memory/arena.h"
+#include "memory/concurrent_arena.h"
+#include "port/numa.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/comparator.h"
@@ -47,6 +50,11 @@ DEFINE_string(benchmarks, "fillrandom",
               "Comma-separated list of benchmarks to run. Options:\n"
               "\tfillrandom             -- write N random values\n"
               "\tfillseq                -- write N values in sequential order\n"
+              "\tfillrandomconcurrent   -- N threads write random values "
+              "concurrently\n"
+              "\tfillrandombatch        -- write N random values in sorted "
+              "batches of\n"
+              "\t                          --batch_size keys\n"
               "\treadrandom             -- read N values in random order\n"
               "\treadseq                -- scan the DB\n"
               "\treadwrite              -- 1 thread writes while N - 1 threads "
@@ -60,6 +68,7 @@ DEFINE_string(memtablerep, "skiplist",
               "include/memtablerep.h for\n"
               "  more details. Options:\n"
               "\tskiplist            -- backed by a skiplist\n"
+              "\tart                 -- backed by an adaptive radix tree\n"
               "\tvector              -- backed by an std::vector\n"
               "\thashskiplist        -- backed by a hash skip list\n"
               "\thashlinklist        -- backed by a hash linked list\n"
@@ -113,6 +122,9 @@ DEFINE_int32(num_scans, 10,
 
 DEFINE_int32(item_size, 100, "Number of bytes each item should be");
 
+DEFINE_int32(batch_size, 1000,
+             "Number of keys per sorted batch for fillrandombatch");
+
 DEFINE_int32(prefix_length, 8,
              "Prefix length to pass into NewFixedPrefixTransform");
 
@@ -120,10 +132,33 @@ DEFINE_int32(prefix_length, 8,
 DEFINE_int64(vectorrep_count, 0,
              "Number of entries to reserve on VectorRep initialization");
 
+/* PartitionedRep settings */
+DEFINE_int32(num_partitions, 0,
+             "If > 1, split the memtablerep into this many partitions with "
+             "PartitionedRepFactory, which also enables fillrandomconcurrent "
+             "for reps without concurrent insert");
+
 DEFINE_int64(seed, 0,
              "Seed base for random number generators. "
              "When 0 it is deterministic.");
 
+/* NUMA settings */
+DEFINE_bool(numa_aware, false,
+            "Use a NUMA-aware arena (see memtable_numa_aware) for "
+            "fillrandomconcurrent");
+
+DEFINE_int32(numa_write_node, -1,
+             "If >= 0, pin the writer threads to this NUMA node");
+
+DEFINE_bool(numa_spread_writers, false,
+            "Pin the writer threads of fillrandomconcurrent round robin to "
+            "all NUMA nodes, overrides numa_write_node");
+
+DEFINE_int32(numa_read_node, -1,
+             "If >= 0, pin the reader threads to this NUMA node. Reading on "
+             "another node than numa_write_node measures the cost of remote "
+             "memtable accesses");
+
 bool g_is_cspp = false;
 
 namespace ROCKSDB_NAMESPACE {
@@ -202,6 +237,14 @@ class KeyGenerator {
   std::vector<uint64_t> values_;
 };
 
+// Pins the calling thread to the cpus of node, if node >= 0
+void PinToNumaNode(int node) {
+  if (node >= 0 && !port::NumaRunOnNode(node)) {
+    fprintf(stderr, "Failed to pin thread to NUMA node %d of %d\n", node,
+            port::NumaNumNodes());
+  }
+}
+
 class BenchmarkThread {
  public:
   explicit BenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
@@ -281,6 +324,52 @@ class FillBenchmarkThread : public BenchmarkThread {
   }
 };
 
+class FillBatchBenchmarkThread : public FillBenchmarkThread {
+ public:
+  using FillBenchmarkThread::FillBenchmarkThread;
+
+  // Inserts num keys as one sorted run through MemTableRep::InsertKeyBatch
+  void FillBatch(uint64_t num) {
+    const uint32_t internal_key_size = 16;
+    const size_t encoded_len =
+        FLAGS_item_size + VarintLength(internal_key_size) + internal_key_size;
+    std::vector<size_t> lens(num, encoded_len);
+    std::vector<char*> bufs(num);
+    std::vector<KeyHandle> handles(num);
+    table_->AllocateBatch(lens.data(), num, bufs.data(), handles.data());
+    for (uint64_t i = 0; i < num; ++i) {
+      char* p = EncodeVarint32(bufs[i], internal_key_size);
+      // big endian, so that the bytewise order is the numeric order
+      PutBigEndian64(p, key_gen_->Next());
+      EncodeFixed64(p + 8, ++(*sequence_));
+      Slice bytes = generator_.Generate(FLAGS_item_size);
+      memcpy(p + internal_key_size, bytes.data(), FLAGS_item_size);
+    }
+    // user keys are unique, so comparing them is enough
+    std::sort(handles.begin(), handles.end(), [](KeyHandle a, KeyHandle b) {
+      return memcmp(static_cast<const char*>(a) + 1,
+                    static_cast<const char*>(b) + 1, 8) < 0;
+    });
+    table_->InsertKeyBatch(handles.data(), num, nullptr);
+    *bytes_written_ += encoded_len * num;
+  }
+
+  void operator()() override {
+    const uint64_t batch_size = std::max(FLAGS_batch_size, 1);
+    for (uint64_t i = 0; i < num_ops_; i += batch_size) {
+      FillBatch(std::min(batch_size, num_ops_ - i));
+    }
+  }
+
+ private:
+  static void PutBigEndian64(char* p, uint64_t v) {
+    for (int i = 7; i >= 0; --i) {
+      p[i] = static_cast<char>(v & 0xff);
+      v >>= 8;
+    }
+  }
+};
+
 class ConcurrentFillBenchmarkThread : public FillBenchmarkThread {
  public:
   ConcurrentFillBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
@@ -294,6 +383,7 @@ class ConcurrentFillBenchmarkThread : public FillBenchmarkThread {
   }
 
   void operator()() override {
+    PinToNumaNode(FLAGS_numa_write_node);
     // # of read threads will be total threads - write threads (always 1). Loop
     // while all reads complete.
     while ((*threads_done_).load() < (FLAGS_num_threads - 1)) {
@@ -305,6 +395,51 @@ class ConcurrentFillBenchmarkThread : public FillBenchmarkThread {
   std::atomic_int* threads_done_;
 };
 
+class FillConcurrentlyBenchmarkThread : public BenchmarkThread {
+ public:
+  FillConcurrentlyBenchmarkThread(MemTableRep* table, uint64_t* bytes_written,
+                                  std::atomic<uint64_t>* sequence,
+                                  uint64_t num_ops, uint64_t seed,
+                                  int thread_idx)
+      : BenchmarkThread(table, nullptr, bytes_written, nullptr, nullptr,
+                        num_ops, nullptr),
+        atomic_sequence_(sequence),
+        rand_(seed),
+        thread_idx_(thread_idx) {}
+
+  void operator()() override {
+    PinToNumaNode(FLAGS_numa_spread_writers
+                      ? thread_idx_ % port::NumaNumNodes()
+                      : FLAGS_numa_write_node);
+    auto internal_key_size = 16;
+    auto encoded_len =
+        FLAGS_item_size + VarintLength(internal_key_size) + internal_key_size;
+    uint64_t written = 0;
+    for (unsigned int i = 0; i < num_ops_; ++i) {
+      char* buf = nullptr;
+      KeyHandle handle = table_->Allocate(encoded_len, &buf);
+      assert(buf != nullptr);
+      char* p = EncodeVarint32(buf, internal_key_size);
+      EncodeFixed64(p, rand_.Next() % FLAGS_num_operations);
+      p += 8;
+      EncodeFixed64(p, atomic_sequence_->fetch_add(1) + 1);
+      p += 8;
+      Slice bytes = generator_.Generate(FLAGS_item_size);
+      memcpy(p, bytes.data(), FLAGS_item_size);
+      table_->InsertConcurrently(handle);
+      written += encoded_len;
+    }
+    static port::Mutex mutex;
+    MutexLock lock(&mutex);
+    *bytes_written_ += written;
+  }
+
+ private:
+  std::atomic<uint64_t>* atomic_sequence_;
+  Random64 rand_;
+  int thread_idx_;
+};
+
 class ReadBenchmarkThread : public BenchmarkThread {
   ReadOptions read_opt_;
   bool needs_user_key_cmp_;
@@ -362,6 +497,7 @@ class ReadBenchmarkThread : public BenchmarkThread {
     }
   }
   void operator()() override {
+    PinToNumaNode(FLAGS_numa_read_node);
     for (unsigned int i = 0; i < num_ops_; ++i) {
       ReadOne();
     }
@@ -387,6 +523,7 @@ class SeqReadBenchmarkThread : public BenchmarkThread {
   }
 
   void operator()() override {
+    PinToNumaNode(FLAGS_numa_read_node);
     for (unsigned int i = 0; i < num_ops_; ++i) {
       { ReadOneSeq(); }
     }
@@ -406,6 +543,7 @@ class ConcurrentReadBenchmarkThread : public ReadBenchmarkThread {
   }
 
   void operator()() override {
+    PinToNumaNode(FLAGS_numa_read_node);
     for (unsigned int i = 0; i < num_ops_; ++i) {
       ReadOne();
     }
@@ -429,6 +567,7 @@ class SeqConcurrentReadBenchmarkThread : public SeqReadBenchmarkThread {
   }
 
   void operator()() override {
+    PinToNumaNode(FLAGS_numa_read_node);
     for (unsigned int i = 0; i < num_ops_; ++i) {
       ReadOneSeq();
     }
@@ -511,6 +650,45 @@ class FillBenchmark : public Benchmark {
   }
 };
 
+class FillBatchBenchmark : public Benchmark {
+ public:
+  explicit FillBatchBenchmark(MemTableRep* table, KeyGenerator* key_gen,
+                              uint64_t* sequence)
+      : Benchmark(table, key_gen, sequence, 1) {
+    num_write_ops_per_thread_ = FLAGS_num_operations;
+  }
+
+  void RunThreads(std::vector<port::Thread>* /*threads*/,
+                  uint64_t* bytes_written, uint64_t* bytes_read, bool /*write*/,
+                  uint64_t* read_hits) override {
+    FillBatchBenchmarkThread(table_, key_gen_, bytes_written, bytes_read,
+                             sequence_, num_write_ops_per_thread_, read_hits)();
+  }
+};
+
+class FillConcurrentlyBenchmark : public Benchmark {
+ public:
+  explicit FillConcurrentlyBenchmark(MemTableRep* table, uint64_t* sequence)
+      : Benchmark(table, nullptr, sequence, FLAGS_num_threads) {
+    num_write_ops_per_thread_ = FLAGS_num_operations / FLAGS_num_threads;
+  }
+
+  void RunThreads(std::vector<port::Thread>* threads, uint64_t* bytes_written,
+                  uint64_t* /*bytes_read*/, bool /*write*/,
+                  uint64_t* /*read_hits*/) override {
+    std::atomic<uint64_t> sequence(*sequence_);
+    for (int i = 0; i < FLAGS_num_threads; ++i) {
+      threads->emplace_back(FillConcurrentlyBenchmarkThread(
+          table_, bytes_written, &sequence, num_write_ops_per_thread_,
+          FLAGS_seed + i + 1, i));
+    }
+    for (auto& thread : *threads) {
+      thread.join();
+    }
+    *sequence_ = sequence.load();
+  }
+};
+
 class ReadBenchmark : public Benchmark {
  public:
   explicit ReadBenchmark(MemTableRep* table, KeyGenerator* key_gen,
@@ -620,6 +798,8 @@ int main(int argc, char** argv) {
   std::unique_ptr<ROCKSDB_NAMESPACE::MemTableRepFactory> factory;
   if (FLAGS_memtablerep == "skiplist") {
     factory.reset(new ROCKSDB_NAMESPACE::SkipListFactory);
+  } else if (FLAGS_memtablerep == "art") {
+    factory.reset(new ROCKSDB_NAMESPACE::AdaptiveRadixTreeRepFactory);
 #ifdef HAS_TOPLING_CSPP_MEMTABLE
   } else if (FLAGS_memtablerep.substr(0, 5) == "cspp:") {
     std::string jstr = FLAGS_memtablerep.substr(5);
@@ -655,16 +835,24 @@ int main(int argc, char** argv) {
       exit(1);
     }
   }
+  if (FLAGS_num_partitions > 1) {
+    factory.reset(new ROCKSDB_NAMESPACE::PartitionedRepFactory(
+        std::move(factory), FLAGS_num_partitions));
+  }
 
   ROCKSDB_NAMESPACE::InternalKeyComparator internal_key_comp(
       ROCKSDB_NAMESPACE::BytewiseComparator());
   ROCKSDB_NAMESPACE::MemTable::KeyComparator key_comp(internal_key_comp);
   ROCKSDB_NAMESPACE::Arena arena;
+  // Only for fillrandomconcurrent, Arena is not thread-safe
+  ROCKSDB_NAMESPACE::ConcurrentArena concurrent_arena(
+      ROCKSDB_NAMESPACE::Arena::kMinBlockSize, nullptr /*tracker*/,
+      0 /*huge_page_size*/, FLAGS_numa_aware);
   ROCKSDB_NAMESPACE::WriteBufferManager wb(FLAGS_write_buffer_size);
   uint64_t sequence;
-  auto createMemtableRep = [&] {
+  auto createMemtableRep = [&](ROCKSDB_NAMESPACE::Allocator* allocator) {
     sequence = 0;
-    return factory->CreateMemTableRep(key_comp, &arena,
+    return factory->CreateMemTableRep(key_comp, allocator,
                                       options.prefix_extractor.get(),
                                       options.info_log.get());
   };
@@ -684,17 +872,33 @@ int main(int argc, char** argv) {
     }
     std::unique_ptr<ROCKSDB_NAMESPACE::Benchmark> benchmark;
     if (name == ROCKSDB_NAMESPACE::Slice("fillseq")) {
-      memtablerep.reset(createMemtableRep());
+      memtablerep.reset(createMemtableRep(&arena));
       key_gen.reset(new ROCKSDB_NAMESPACE::KeyGenerator(
           &rng, ROCKSDB_NAMESPACE::SEQUENTIAL, FLAGS_num_operations));
       benchmark.reset(new ROCKSDB_NAMESPACE::FillBenchmark(
           memtablerep.get(), key_gen.get(), &sequence));
     } else if (name == ROCKSDB_NAMESPACE::Slice("fillrandom")) {
-      memtablerep.reset(createMemtableRep());
+      memtablerep.reset(createMemtableRep(&arena));
       key_gen.reset(new ROCKSDB_NAMESPACE::KeyGenerator(
           &rng, ROCKSDB_NAMESPACE::UNIQUE_RANDOM, FLAGS_num_operations));
       benchmark.reset(new ROCKSDB_NAMESPACE::FillBenchmark(
           memtablerep.get(), key_gen.get(), &sequence));
+    } else if (name == ROCKSDB_NAMESPACE::Slice("fillrandombatch")) {
+      memtablerep.reset(createMemtableRep(&arena));
+      key_gen.reset(new ROCKSDB_NAMESPACE::KeyGenerator(
+          &rng, ROCKSDB_NAMESPACE::UNIQUE_RANDOM, FLAGS_num_operations));
+      benchmark.reset(new ROCKSDB_NAMESPACE::FillBatchBenchmark(
+          memtablerep.get(), key_gen.get(), &sequence));
+    } else if (name == ROCKSDB_NAMESPACE::Slice("fillrandomconcurrent")) {
+      if (!factory->IsInsertConcurrentlySupported()) {
+        std::cout << "WARNING: skipping " << name.ToString() << ", "
+                  << factory->Name() << " does not support concurrent insert"
+                  << std::endl;
+        continue;
+      }
+      memtablerep.reset(createMemtableRep(&concurrent_arena));
+      benchmark.reset(new ROCKSDB_NAMESPACE::FillConcurrentlyBenchmark(
+          memtablerep.get(), &sequence));
     } else if (name == ROCKSDB_NAMESPACE::Slice("readrandom")) {
       key_gen.reset(new ROCKSDB_NAMESPACE::KeyGenerator(
           &rng, ROCKSDB_NAMESPACE::RANDOM, FLAGS_num_operations));
@@ -706,14 +910,14 @@ int main(int argc, char** argv) {
       benchmark.reset(new ROCKSDB_NAMESPACE::SeqReadBenchmark(memtablerep.get(),
                                                               &sequence));
     } else if (name == ROCKSDB_NAMESPACE::Slice("readwrite")) {
-      memtablerep.reset(createMemtableRep());
+      memtablerep.reset(createMemtableRep(&arena));
       key_gen.reset(new ROCKSDB_NAMESPACE::KeyGenerator(
           &rng, ROCKSDB_NAMESPACE::RANDOM, FLAGS_num_operations));
       benchmark.reset(new ROCKSDB_NAMESPACE::ReadWriteBenchmark<
                       ROCKSDB_NAMESPACE::ConcurrentReadBenchmarkThread>(
           memtablerep.get(), key_gen.get(), &sequence));
     } else if (name == ROCKSDB_NAMESPACE::Slice("seqreadwrite")) {
-      memtablerep.reset(createMemtableRep());
+      memtablerep.reset(createMemtableRep(&arena));
       key_gen.reset(new ROCKSDB_NAMESPACE::KeyGenerator(
           &rng, ROCKSDB_NAMESPACE::RANDOM, FLAGS_num_operations));
       benchmark.reset(new ROCKSDB_NAMESPACE::ReadWriteBenchmark<
@@ -0,0 +1,417 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "db/memtable.h"
+#include "memory/arena.h"
+#include "port/port.h"
+#include "rocksdb/comparator.h"
+#include "rocksdb/memtablerep.h"
+#include "rocksdb/utilities/options_type.h"
+#include "util/fastrange.h"
+#include "util/hash.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+class PartitionedRep : public MemTableRep {
+ public:
+  // Takes ownership of the sub-reps
+  PartitionedRep(const KeyComparator& compare, Allocator* allocator,
+                 std::vector<MemTableRep*>&& reps, bool concurrent_reps)
+      : MemTableRep(allocator),
+        compare_(compare),
+        ts_sz_(compare.icomparator()->user_comparator()->timestamp_size()),
+        concurrent_reps_(concurrent_reps),
+        num_partitions_(reps.size()),
+        partitions_(new Partition[reps.size()]) {
+    for (size_t i = 0; i < num_partitions_; ++i) {
+      partitions_[i].rep.reset(reps[i]);
+    }
+  }
+
+  bool InsertKeyValue(const Slice& internal_key, const Slice& value) override {
+    Partition& p = PartitionOf(internal_key);
+    bool res = p.rep->InsertKeyValue(internal_key, value);
+    p.num_entries.fetch_add(res, std::memory_order_relaxed);
+    return res;
+  }
+
+  // A hint belongs to one sub-rep, while the keys of one hint prefix are
+  // spread over all partitions
+  bool InsertKeyValueWithHint(const Slice& internal_key, const Slice& value,
+                              void** /*hint*/) override {
+    return InsertKeyValue(internal_key, value);
+  }
+
+  bool InsertKeyValueConcurrently(const Slice& internal_key,
+                                  const Slice& value) override {
+    Partition& p = PartitionOf(internal_key);
+    bool res;
+    if (concurrent_reps_) {
+      res = p.rep->InsertKeyValueConcurrently(internal_key, value);
+    } else {
+      std::lock_guard<SpinMutex> lock(p.mutex);
+      res = p.rep->InsertKeyValue(internal_key, value);
+    }
+    p.num_entries.fetch_add(res, std::memory_order_relaxed);
+    return res;
+  }
+
+  bool InsertKeyValueWithHintConcurrently(const Slice& internal_key,
+                                          const Slice& value,
+                                          void** /*hint*/) override {
+    return InsertKeyValueConcurrently(internal_key, value);
+  }
+
+  // The handle is allocated before its partition is known, so Insert*()
+  // copies the entry into the partition
+  void Insert(KeyHandle handle) override { InsertKey(handle); }
+
+  bool InsertKey(KeyHandle handle) override {
+    Slice internal_key, value;
+    Decode(handle, &internal_key, &value);
+    return InsertKeyValue(internal_key, value);
+  }
+
+  bool InsertKeyWithHint(KeyHandle handle, void** /*hint*/) override {
+    return InsertKey(handle);
+  }
+
+  void InsertConcurrently(KeyHandle handle) override {
+    InsertKeyConcurrently(handle);
+  }
+
+  bool InsertKeyConcurrently(KeyHandle handle) override {
+    Slice internal_key, value;
+    Decode(handle, &internal_key, &value);
+    return InsertKeyValueConcurrently(internal_key, value);
+  }
+
+  bool InsertKeyWithHintConcurrently(KeyHandle handle,
+                                     void** /*hint*/) override {
+    return InsertKeyConcurrently(handle);
+  }
+
+  bool Contains(const Slice& internal_key) const override {
+    return PartitionOf(internal_key).rep->Contains(internal_key);
+  }
+
+  void MarkReadOnly() override {
+    for (size_t i = 0; i < num_partitions_; ++i) {
+      partitions_[i].rep->MarkReadOnly();
+    }
+  }
+
+  void MarkFlushed() override {
+    for (size_t i = 0; i < num_partitions_; ++i) {
+      partitions_[i].rep->MarkFlushed();
+    }
+  }
+
+  // All versions of a user key live in the same partition
+  void Get(const ReadOptions& read_options, const LookupKey& k,
+           void* callback_args,
+           bool (*callback_func)(void* arg, const KeyValuePair&)) override {
+    PartitionOf(k.internal_key())
+        .rep->Get(read_options, k, callback_args, callback_func);
+  }
+
+  uint64_t ApproximateNumEntries(const Slice& start_ikey,
+                                 const Slice& end_ikey) override {
+    uint64_t num = 0;
+    for (size_t i = 0; i < num_partitions_; ++i) {
+      num += partitions_[i].rep->ApproximateNumEntries(start_ikey, end_ikey);
+    }
+    return num;
+  }
+
+  // Samples every partition in proportion to its number of entries
+  void UniqueRandomSample(const uint64_t num_entries,
+                          const uint64_t target_sample_size,
+                          std::unordered_set<const char*>* entries) override {
+    for (size_t i = 0; i < num_partitions_; ++i) {
+      uint64_t n = partitions_[i].num_entries.load(std::memory_order_relaxed);
+      if (n == 0 || num_entries == 0) {
+        continue;
+      }
+      partitions_[i].rep->UniqueRandomSample(
+          n, target_sample_size * n / num_entries, entries);
+    }
+  }
+
+  size_t ApproximateMemoryUsage() override {
+    size_t usage = sizeof(Partition) * num_partitions_;
+    for (size_t i = 0; i < num_partitions_; ++i) {
+      usage += partitions_[i].rep->ApproximateMemoryUsage();
+    }
+    return usage;
+  }
+
+  bool IsMergeOperatorSupported() const override {
+    return partitions_[0].rep->IsMergeOperatorSupported();
+  }
+
+  bool IsSnapshotSupported() const override {
+    return partitions_[0].rep->IsSnapshotSupported();
+  }
+
+  bool NeedsUserKeyCompareInGet() const override {
+    return partitions_[0].rep->NeedsUserKeyCompareInGet();
+  }
+
+  ~PartitionedRep() override {}
+
+  // Merges the iterators of all partitions. Partitions never share an
+  // internal key, and the number of partitions is small, so the smallest
+  // (largest) child is found by a linear scan.
+  class Iterator : public MemTableRep::Iterator {
+   public:
+    Iterator(const KeyComparator& compare, bool arena_mode)
+        : compare_(compare), arena_mode_(arena_mode) {}
+
+    ~Iterator() override {
+      for (auto* child : children_) {
+        if (arena_mode_) {
+          child->~Iterator();
+        } else {
+          delete child;
+        }
+      }
+    }
+
+    void AddChild(MemTableRep::Iterator* child) { children_.push_back(child); }
+
+    bool Valid() const override { return current_ != nullptr; }
+
+    const char* varlen_key() const override { return current_->varlen_key(); }
+    using MemTableRep::Iterator::Seek;
+    using MemTableRep::Iterator::SeekForPrev;
+
+    void Next() override {
+      assert(Valid());
+      if (!forward_) {
+        // Every other child is positioned before key(), move it after
+        const char* target = current_->varlen_key();
+        Slice internal_key = GetLengthPrefixedSlice(target);
+        for (auto* child : children_) {
+          if (child != current_) {
+            child->Seek(internal_key, target);
+          }
+        }
+        forward_ = true;
+      }
+      current_->Next();
+      FindSmallest();
+    }
+
+    void Prev() override {
+      assert(Valid());
+      if (forward_) {
+        // Not all reps implement SeekForPrev(), so position every other child
+        // at its last key before key() with Seek() and Prev()
+        const char* target = current_->varlen_key();
+        Slice internal_key = GetLengthPrefixedSlice(target);
+        for (auto* child : children_) {
+          if (child != current_) {
+            child->Seek(internal_key, target);
+            if (child->Valid()) {
+              child->Prev();
+            } else {
+              child->SeekToLast();
+            }
+          }
+        }
+        forward_ = false;
+      }
+      current_->Prev();
+      FindLargest();
+    }
+
+    void Seek(const Slice& internal_key, const char* memtable_key) override {
+      for (auto* child : children_) {
+        child->Seek(internal_key, memtable_key);
+      }
+      forward_ = true;
+      FindSmallest();
+    }
+
+    void SeekForPrev(const Slice& internal_key,
+                     const char* memtable_key) override {
+      Slice target = memtable_key != nullptr
+                         ? GetLengthPrefixedSlice(memtable_key)
+                         : internal_key;
+      for (auto* child : children_) {
+        child->Seek(internal_key, memtable_key);
+        if (!child->Valid()) {
+          child->SeekToLast();
+        } else if (compare_(child->varlen_key(), target) > 0) {
+          child->Prev();
+        }
+      }
+      forward_ = false;
+      FindLargest();
+    }
+
+    void SeekToFirst() override {
+      for (auto* child : children_) {
+        child->SeekToFirst();
+      }
+      forward_ = true;
+      FindSmallest();
+    }
+
+    void SeekToLast() override {
+      for (auto* child : children_) {
+        child->SeekToLast();
+      }
+      forward_ = false;
+      FindLargest();
+    }
+
+   private:
+    void FindSmallest() {
+      current_ = nullptr;
+      for (auto* child : children_) {
+        if (child->Valid() &&
+            (current_ == nullptr ||
+             compare_(child->varlen_key(), current_->varlen_key()) < 0)) {
+          current_ = child;
+        }
+      }
+    }
+
+    void FindLargest() {
+      current_ = nullptr;
+      for (auto* child : children_) {
+        if (child->Valid() &&
+            (current_ == nullptr ||
+             compare_(child->varlen_key(), current_->varlen_key()) > 0)) {
+          current_ = child;
+        }
+      }
+    }
+
+    const KeyComparator& compare_;
+    const bool arena_mode_;
+    bool forward_ = true;
+    MemTableRep::Iterator* current_ = nullptr;
+    std::vector<MemTableRep::Iterator*> children_;
+  };
+
+  MemTableRep::Iterator* GetIterator(Arena* arena) override {
+    Iterator* iter = NewIterator(arena);
+    for (size_t i = 0; i < num_partitions_; ++i) {
+      iter->AddChild(partitions_[i].rep->GetIterator(arena));
+    }
+    return iter;
+  }
+
+  MemTableRep::Iterator* GetDynamicPrefixIterator(Arena* arena) override {
+    Iterator* iter = NewIterator(arena);
+    for (size_t i = 0; i < num_partitions_; ++i) {
+      iter->AddChild(partitions_[i].rep->GetDynamicPrefixIterator(arena));
+    }
+    return iter;
+  }
+
+ private:
+  struct ALIGN_AS(CACHE_LINE_SIZE) Partition {
+    // Serializes concurrent inserts if the sub-rep does not support them
+    SpinMutex mutex;
+    std::atomic<uint64_t> num_entries{0};
+    std::unique_ptr<MemTableRep> rep;
+  };
+
+  Partition& PartitionOf(const Slice& internal_key) const {
+    assert(internal_key.size() >= kNumInternalBytes + ts_sz_);
+    // Hash without the timestamp to keep all versions of a user key together
+    Slice user_key(internal_key.data(),
+                   internal_key.size() - kNumInternalBytes - ts_sz_);
+    return partitions_[FastRange64(GetSliceNPHash64(user_key),
+                                   num_partitions_)];
+  }
+
+  static void Decode(KeyHandle handle, Slice* internal_key, Slice* value) {
+    *internal_key = GetLengthPrefixedSlice(static_cast<const char*>(handle));
+    *value = GetLengthPrefixedSlice(internal_key->data() +
+                                    internal_key->size());
+  }
+
+  Iterator* NewIterator(Arena* arena) const {
+    void* mem = arena ? arena->AllocateAligned(sizeof(Iterator))
+                      : operator new(sizeof(Iterator));
+    return new (mem) Iterator(compare_, arena != nullptr);
+  }
+
+  const KeyComparator& compare_;
+  const size_t ts_sz_;
+  const bool concurrent_reps_;
+  const size_t num_partitions_;
+  std::unique_ptr<Partition[]> partitions_;
+};
+}  // namespace
+
+static std::unordered_map<std::string, OptionTypeInfo> partitioned_rep_info = {
+    {"rep",
+     OptionTypeInfo::AsCustomSharedPtr<MemTableRepFactory>(
+         0, OptionVerificationType::kByName, OptionTypeFlags::kNone)},
+};
+
+static std::unordered_map<std::string, OptionTypeInfo>
+    partitioned_rep_count_info = {
+        {"num_partitions",
+         {0, OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+};
+
+PartitionedRepFactory::PartitionedRepFactory(
+    const std::shared_ptr<MemTableRepFactory>& rep, size_t num_partitions)
+    : rep_(rep ? rep : std::make_shared<VectorRepFactory>()),
+      num_partitions_(num_partitions) {
+  RegisterOptions("PartitionedRepFactoryRep", &rep_, &partitioned_rep_info);
+  RegisterOptions("PartitionedRepFactoryOptions", &num_partitions_,
+                  &partitioned_rep_count_info);
+}
+
+MemTableRep* PartitionedRepFactory::CreateMemTableRep(
+    const MemTableRep::KeyComparator& compare, Allocator* allocator,
+    const SliceTransform* transform, Logger* logger) {
+  if (num_partitions_ <= 1) {
+    return rep_->CreateMemTableRep(compare, allocator, transform, logger);
+  }
+  std::vector<MemTableRep*> reps(num_partitions_);
+  for (auto& rep : reps) {
+    rep = rep_->CreateMemTableRep(compare, allocator, transform, logger);
+  }
+  return new PartitionedRep(compare, allocator, std::move(reps),
+                            rep_->IsInsertConcurrentlySupported());
+}
+
+MemTableRep* PartitionedRepFactory::CreateMemTableRep(
+    const std::string& level0_dir, const MutableCFOptions& mcf_options,
+    const MemTableRep::KeyComparator& compare, Allocator* allocator,
+    const SliceTransform* transform, Logger* logger,
+    uint32_t column_family_id) {
+  if (num_partitions_ <= 1) {
+    return rep_->CreateMemTableRep(level0_dir, mcf_options, compare, allocator,
+                                   transform, logger, column_family_id);
+  }
+  std::vector<MemTableRep*> reps(num_partitions_);
+  for (auto& rep : reps) {
+    rep = rep_->CreateMemTableRep(level0_dir, mcf_options, compare, allocator,
+                                  transform, logger, column_family_id);
+  }
+  return new PartitionedRep(compare, allocator, std::move(reps),
+                            rep_->IsInsertConcurrentlySupported());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
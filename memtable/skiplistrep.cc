@@ -5,11 +5,16 @@
 //
 #include <random>
 
+#include "db/builder.h"
 #include "db/memtable.h"
+#include "db/version_edit.h"
 #include "memory/arena.h"
 #include "memtable/inlineskiplist.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/utilities/options_type.h"
+#include "table/plain/plain_table_builder.h"
+#include "table/plain/plain_table_factory.h"
+#include "util/cast_util.h"
 #include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -19,18 +24,20 @@ class SkipListRep : public MemTableRep {
   const MemTableRep::KeyComparator& cmp_;
   const SliceTransform* transform_;
   const size_t lookahead_;
+  const bool convert_to_sst_;
 
   friend class LookaheadIterator;
 
  public:
   explicit SkipListRep(const MemTableRep::KeyComparator& compare,
                        Allocator* allocator, const SliceTransform* transform,
-                       const size_t lookahead)
+                       const size_t lookahead, bool convert_to_sst)
       : MemTableRep(allocator),
         skip_list_(compare, allocator),
         cmp_(compare),
         transform_(transform),
-        lookahead_(lookahead) {}
+        lookahead_(lookahead),
+        convert_to_sst_(convert_to_sst) {}
 
   KeyHandle Allocate(const size_t len, char** buf) override {
     *buf = skip_list_.AllocateKey(len);
@@ -72,6 +79,28 @@ class SkipListRep : public MemTableRep {
     return skip_list_.InsertConcurrently(static_cast<char*>(handle));
   }
 
+  void AllocateBatch(const size_t* lens, size_t num, char** bufs,
+                     KeyHandle* handles) override {
+    skip_list_.AllocateKeys(lens, num, bufs);
+    for (size_t i = 0; i < num; ++i) {
+      handles[i] = static_cast<KeyHandle>(bufs[i]);
+    }
+  }
+
+  size_t InsertKeyBatch(const KeyHandle* handles, size_t num,
+                        bool* inserted) override {
+    return skip_list_.InsertSortedRun(
+        reinterpret_cast<const char* const*>(handles), num, inserted);
+  }
+
+  size_t InsertKeyBatchConcurrently(const KeyHandle* handles, size_t num,
+                                    bool* inserted) override {
+    return skip_list_.InsertSortedRunConcurrently(
+        reinterpret_cast<const char* const*>(handles), num, inserted);
+  }
+
+  bool SupportInsertKeyBatch() const override { return true; }
+
   // Returns true iff an entry that compares equal to key is in the list.
   bool Contains(const Slice& internal_key) const override {
     return ContainsForwardToLegacy(skip_list_, internal_key);
@@ -161,6 +190,58 @@ class SkipListRep : public MemTableRep {
     }
   }
 
+  bool SupportConvertToSST() const override { return convert_to_sst_; }
+
+  Status ConvertToSST(FileMetaData* meta,
+                      const TableBuilderOptions& tbo) override {
+    if (tbo.ioptions.table_factory->CheckedCast<PlainTableFactory>() ==
+        nullptr) {
+      SkipListRep::Iterator iter(&skip_list_);
+      return BuildTableFromSortedIterator(tbo, &iter, meta);
+    }
+    return BuildTableFromSortedEntries(
+        tbo, meta, [this](TableBuilder* builder, FileMetaData* m) {
+          return AddToPlainTable(
+              static_cast_with_check<PlainTableBuilder>(builder), m);
+        });
+  }
+
+  // Copy the whole list into a plain table in one pass.  PlainTableBuilder
+  // is final and the list is walked directly, so there is no virtual call
+  // per entry, and the boundaries of meta only need the first and the last
+  // key (plus blob indexes for the oldest blob file).
+  Status AddToPlainTable(PlainTableBuilder* builder, FileMetaData* meta) {
+    InlineSkipList<const MemTableRep::KeyComparator&>::Iterator iter(
+        &skip_list_);
+    Slice ikey, value;
+    iter.SeekToFirst();
+    for (bool first = true; iter.Valid(); iter.Next()) {
+      ikey = GetLengthPrefixedSlice(iter.key());
+      value = GetLengthPrefixedSlice(ikey.data() + ikey.size());
+      builder->Add(ikey, value);
+      ValueType type;
+      SequenceNumber seq;
+      UnPackSequenceAndType(ExtractInternalKeyFooter(ikey), &seq, &type);
+      if (UNLIKELY(first || type == kTypeBlobIndex)) {
+        Status s = meta->UpdateBoundaries(ikey, value, seq, type);
+        if (!s.ok()) {
+          return s;
+        }
+        first = false;
+      }
+    }
+    if (!ikey.empty()) {
+      ValueType type;
+      SequenceNumber seq;
+      UnPackSequenceAndType(ExtractInternalKeyFooter(ikey), &seq, &type);
+      Status s = meta->UpdateBoundaries(ikey, value, seq, type);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+    return builder->status();
+  }
+
   ~SkipListRep() override {}
 
   // Iteration over the contents of a skip list
@@ -350,9 +431,19 @@ static std::unordered_map<std::string, OptionTypeInfo> skiplist_factory_info = {
       OptionTypeFlags::kDontSerialize /*Since it is part of the ID*/}},
 };
 
-SkipListFactory::SkipListFactory(size_t lookahead) : lookahead_(lookahead) {
+static std::unordered_map<std::string, OptionTypeInfo>
+    skiplist_convert_to_sst_info = {
+        {"convert_to_sst",
+         {0, OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+};
+
+SkipListFactory::SkipListFactory(size_t lookahead, bool convert_to_sst)
+    : lookahead_(lookahead), convert_to_sst_(convert_to_sst) {
   RegisterOptions("SkipListFactoryOptions", &lookahead_,
                   &skiplist_factory_info);
+  RegisterOptions("SkipListFactoryConvertToSSTOptions", &convert_to_sst_,
+                  &skiplist_convert_to_sst_info);
 }
 
 std::string SkipListFactory::GetId() const {
@@ -366,7 +457,8 @@ std::string SkipListFactory::GetId() const {
 MemTableRep* SkipListFactory::CreateMemTableRep(
     const MemTableRep::KeyComparator& compare, Allocator* allocator,
     const SliceTransform* transform, Logger* /*logger*/) {
-  return new SkipListRep(compare, allocator, transform, lookahead_);
+  return new SkipListRep(compare, allocator, transform, lookahead_,
+                         convert_to_sst_);
 }
 
 }  // namespace ROCKSDB_NAMESPACE
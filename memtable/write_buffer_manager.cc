@@ -9,11 +9,13 @@
 
 #include "rocksdb/write_buffer_manager.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "cache/cache_entry_roles.h"
 #include "cache/cache_reservation_manager.h"
 #include "db/db_impl/db_impl.h"
+#include "memory/arena_block_pool.h"
 #include "rocksdb/status.h"
 #include "util/coding.h"
 
@@ -27,8 +29,14 @@ WriteBufferManager::WriteBufferManager(size_t _buffer_size,
       memory_active_(0),
       cache_(cache),
       cache_res_mgr_(nullptr),
+      arena_block_pool_(std::make_shared<ArenaBlockPool>()),
+      arena_block_pool_size_(0),
       allow_stall_(allow_stall),
-      stall_active_(false) {
+      stall_active_(false),
+      numa_node_buffer_size_(0) {
+  for (auto& usage : numa_node_memory_active_) {
+    usage.store(0, std::memory_order_relaxed);
+  }
   if (cache) {
     // Memtable's memory usage tends to fluctuate frequently
     // therefore we set delayed_decrease = true to save some dummy entry
@@ -54,6 +62,19 @@ std::size_t WriteBufferManager::dummy_entries_in_cache_usage() const {
   }
 }
 
+void WriteBufferManager::SetArenaBlockPoolSize(size_t pool_size) {
+  arena_block_pool_size_.store(pool_size, std::memory_order_relaxed);
+  UpdateArenaBlockPoolCapacity();
+}
+
+void WriteBufferManager::UpdateArenaBlockPoolCapacity() {
+  size_t capacity = arena_block_pool_size();
+  if (enabled()) {
+    capacity = std::min(capacity, buffer_size());
+  }
+  arena_block_pool_->SetCapacity(capacity);
+}
+
 void WriteBufferManager::ReserveMem(size_t mem) {
   if (cache_res_mgr_ != nullptr) {
     ReserveMemWithCache(mem);
@@ -90,6 +111,20 @@ void WriteBufferManager::ScheduleFreeMem(size_t mem) {
   }
 }
 
+void WriteBufferManager::ReserveNumaNodeMem(size_t mem, int node) {
+  assert(node >= 0 && node < kMaxNumaNodes);
+  if (enabled()) {
+    numa_node_memory_active_[node].fetch_add(mem, std::memory_order_relaxed);
+  }
+}
+
+void WriteBufferManager::ScheduleFreeNumaNodeMem(size_t mem, int node) {
+  assert(node >= 0 && node < kMaxNumaNodes);
+  if (enabled()) {
+    numa_node_memory_active_[node].fetch_sub(mem, std::memory_order_relaxed);
+  }
+}
+
 void WriteBufferManager::FreeMem(size_t mem) {
   if (cache_res_mgr_ != nullptr) {
     FreeMemWithCache(mem);
@@ -9,6 +9,7 @@
 
 #include "rocksdb/write_buffer_manager.h"
 
+#include "memory/arena.h"
 #include "rocksdb/advanced_cache.h"
 #include "test_util/testharness.h"
 
@@ -78,6 +79,68 @@ TEST_F(WriteBufferManagerTest, ShouldFlush) {
   ASSERT_FALSE(wbf->ShouldFlush());
 }
 
+TEST_F(WriteBufferManagerTest, ShouldFlushNumaNode) {
+  // A write buffer manager of size 10MB, at most 3MB per NUMA node
+  std::unique_ptr<WriteBufferManager> wbf(
+      new WriteBufferManager(10 * 1024 * 1024));
+  wbf->SetNumaNodeBufferSize(3 * 1024 * 1024);
+
+  wbf->ReserveMem(3 * 1024 * 1024);
+  wbf->ReserveNumaNodeMem(2 * 1024 * 1024, 0);
+  wbf->ReserveNumaNodeMem(1 * 1024 * 1024, 1);
+  ASSERT_EQ(size_t{2 * 1024 * 1024}, wbf->numa_node_memory_usage(0));
+  ASSERT_FALSE(wbf->ShouldFlush());
+
+  // node 1 goes over its limit while the total is far below
+  wbf->ReserveMem(3 * 1024 * 1024);
+  wbf->ReserveNumaNodeMem(3 * 1024 * 1024, 1);
+  ASSERT_TRUE(wbf->ShouldFlush());
+
+  // Scheduling for freeing will release the condition
+  wbf->ScheduleFreeMem(3 * 1024 * 1024);
+  wbf->ScheduleFreeNumaNodeMem(3 * 1024 * 1024, 1);
+  ASSERT_FALSE(wbf->ShouldFlush());
+
+  // no per node limit
+  wbf->ReserveMem(3 * 1024 * 1024);
+  wbf->ReserveNumaNodeMem(3 * 1024 * 1024, 1);
+  ASSERT_TRUE(wbf->ShouldFlush());
+  wbf->SetNumaNodeBufferSize(0);
+  ASSERT_FALSE(wbf->ShouldFlush());
+  ASSERT_EQ(0U, wbf->numa_node_memory_usage(WriteBufferManager::kMaxNumaNodes));
+}
+
+TEST_F(WriteBufferManagerTest, ArenaBlockPool) {
+  const size_t kBlockSize = 1024 * 1024;
+  std::unique_ptr<WriteBufferManager> wbf(
+      new WriteBufferManager(3 * kBlockSize));
+  ArenaBlockPool* pool = wbf->arena_block_pool();
+  ASSERT_NE(pool, nullptr);
+  ASSERT_EQ(0U, pool->GetCapacity());
+
+  // bounded by buffer_size()
+  wbf->SetArenaBlockPoolSize(10 * kBlockSize);
+  ASSERT_EQ(10 * kBlockSize, wbf->arena_block_pool_size());
+  ASSERT_EQ(3 * kBlockSize, pool->GetCapacity());
+
+  {
+    Arena arena(kBlockSize, nullptr, 0, -1 /*numa_node*/, pool);
+    for (int i = 0; i < 5 * 4; ++i) {
+      arena.Allocate(kBlockSize / 4);
+    }
+  }
+  ASSERT_EQ(3 * kBlockSize, pool->GetFreeBytes());
+
+  wbf->SetBufferSize(2 * kBlockSize);
+  ASSERT_EQ(2 * kBlockSize, pool->GetCapacity());
+  ASSERT_EQ(2 * kBlockSize, pool->GetFreeBytes());
+  wbf->SetBufferSize(20 * kBlockSize);
+  ASSERT_EQ(10 * kBlockSize, pool->GetCapacity());
+
+  wbf->SetArenaBlockPoolSize(0);
+  ASSERT_EQ(0U, pool->GetFreeBytes());
+}
+
 class ChargeWriteBufferTest : public testing::Test {};
 
 TEST_F(ChargeWriteBufferTest, Basic) {
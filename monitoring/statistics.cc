@@ -260,6 +260,18 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {BYTES_DECOMPRESSED_TO, "rocksdb.bytes.decompressed.to"},
     {LCOMPACT_WRITE_BYTES_RAW, "rocksdb.lcompact.write.bytes.raw"},
     {DCOMPACT_WRITE_BYTES_RAW, "rocksdb.dcompact.write.bytes.raw"},
+    {MEMTABLE_HUGE_PAGE_BLOCKS_REUSED,
+     "rocksdb.memtable.huge.page.blocks.reused"},
+    {MEMTABLE_HUGE_PAGE_BLOCKS_MAPPED,
+     "rocksdb.memtable.huge.page.blocks.mapped"},
+    {MEMTABLE_HUGE_PAGE_FALLBACKS, "rocksdb.memtable.huge.page.fallbacks"},
+    {MEMTABLE_HUGE_PAGE_BYTES, "rocksdb.memtable.huge.page.bytes"},
+    {BLOCK_CACHE_TINY_LFU_ADMIT, "rocksdb.block.cache.tiny.lfu.admit"},
+    {BLOCK_CACHE_TINY_LFU_REJECT, "rocksdb.block.cache.tiny.lfu.reject"},
+    {BLOCK_CACHE_WARM_UP_BLOCKS, "rocksdb.block.cache.warm.up.blocks"},
+    {BLOCK_CACHE_WARM_UP_BYTES, "rocksdb.block.cache.warm.up.bytes"},
+    {GET_RESULT_CACHE_HIT, "rocksdb.get.result.cache.hit"},
+    {GET_RESULT_CACHE_MISS, "rocksdb.get.result.cache.miss"},
 };
 
 const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
@@ -340,6 +352,8 @@ const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
     {HISTOGRAM_COND_WAIT_NANOS, "rocksdb.cond.wait.nanos"},
 
     {READ_ZBS_RECORD_MICROS, "rocksdb.read.zbs.record.micros"},
+    {BLOCK_CACHE_REUSE_DISTANCE_BYTES,
+     "rocksdb.block.cache.reuse.distance.bytes"},
 };
 
 std::shared_ptr<Statistics> CreateDBStatistics() {
@@ -343,6 +343,14 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, memtable_huge_page_size),
           OptionType::kSizeT, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"memtable_numa_aware",
+         {offsetof(struct MutableCFOptions, memtable_numa_aware),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"memtable_transparent_huge_page",
+         {offsetof(struct MutableCFOptions, memtable_transparent_huge_page),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"memtable_prefix_bloom_huge_page_tlb_size",
          {0, OptionType::kSizeT, OptionVerificationType::kDeprecated,
           OptionTypeFlags::kMutable}},
@@ -1049,6 +1057,10 @@ void MutableCFOptions::Dump(Logger* log) const {
   ROCKS_LOG_INFO(log,
                  "                  memtable_huge_page_size: %" ROCKSDB_PRIszt,
                  memtable_huge_page_size);
+  ROCKS_LOG_INFO(log, "                      memtable_numa_aware: %d",
+                 memtable_numa_aware);
+  ROCKS_LOG_INFO(log, "           memtable_transparent_huge_page: %d",
+                 memtable_transparent_huge_page);
   ROCKS_LOG_INFO(log,
                  "                    max_successive_merges: %" ROCKSDB_PRIszt,
                  max_successive_merges);
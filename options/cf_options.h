@@ -120,6 +120,8 @@ struct MutableCFOptions {
             options.memtable_prefix_bloom_size_ratio),
         memtable_whole_key_filtering(options.memtable_whole_key_filtering),
         memtable_huge_page_size(options.memtable_huge_page_size),
+        memtable_numa_aware(options.memtable_numa_aware),
+        memtable_transparent_huge_page(options.memtable_transparent_huge_page),
         max_successive_merges(options.max_successive_merges),
         inplace_update_num_locks(options.inplace_update_num_locks),
         prefix_extractor(options.prefix_extractor),
@@ -189,6 +191,8 @@ struct MutableCFOptions {
         memtable_prefix_bloom_size_ratio(0),
         memtable_whole_key_filtering(false),
         memtable_huge_page_size(0),
+        memtable_numa_aware(false),
+        memtable_transparent_huge_page(false),
         max_successive_merges(0),
         inplace_update_num_locks(0),
         prefix_extractor(nullptr),
@@ -255,6 +259,8 @@ struct MutableCFOptions {
   double memtable_prefix_bloom_size_ratio;
   bool memtable_whole_key_filtering;
   size_t memtable_huge_page_size;
+  bool memtable_numa_aware;
+  bool memtable_transparent_huge_page;
   size_t max_successive_merges;
   size_t inplace_update_num_locks;
   std::shared_ptr<const SliceTransform> prefix_extractor;
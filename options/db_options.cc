@@ -141,6 +141,7 @@ static std::unordered_map<std::string, OptionTypeInfo>
         /*
          // not yet supported
           std::shared_ptr<Cache> row_cache;
+          std::shared_ptr<Cache> get_result_cache;
           std::shared_ptr<DeleteScheduler> delete_scheduler;
           std::shared_ptr<Logger> info_log;
           std::shared_ptr<RateLimiter> rate_limiter;
@@ -328,6 +329,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, unordered_write),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"enable_wal_gather_write",
+         {offsetof(struct ImmutableDBOptions, enable_wal_gather_write),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"allow_concurrent_memtable_write",
          {offsetof(struct ImmutableDBOptions, allow_concurrent_memtable_write),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -336,6 +341,28 @@ static std::unordered_map<std::string, OptionTypeInfo>
          OptionTypeInfo::Enum<WALRecoveryMode>(
              offsetof(struct ImmutableDBOptions, wal_recovery_mode),
              &wal_recovery_mode_string_map)},
+        {"wal_recovery_threads",
+         {offsetof(struct ImmutableDBOptions, wal_recovery_threads),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"block_cache_hot_set_persist_period_sec",
+         {offsetof(struct ImmutableDBOptions,
+                   block_cache_hot_set_persist_period_sec),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"block_cache_hot_set_max_blocks",
+         {offsetof(struct ImmutableDBOptions, block_cache_hot_set_max_blocks),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"block_cache_warm_up_threads",
+         {offsetof(struct ImmutableDBOptions, block_cache_warm_up_threads),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"block_cache_warm_up_bytes_per_sec",
+         {offsetof(struct ImmutableDBOptions,
+                   block_cache_warm_up_bytes_per_sec),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"enable_write_thread_adaptive_yield",
          {offsetof(struct ImmutableDBOptions,
                    enable_write_thread_adaptive_yield),
@@ -728,6 +755,7 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       enable_thread_tracking(options.enable_thread_tracking),
       enable_pipelined_write(options.enable_pipelined_write),
       unordered_write(options.unordered_write),
+      enable_wal_gather_write(options.enable_wal_gather_write),
       allow_concurrent_memtable_write(options.allow_concurrent_memtable_write),
       enable_write_thread_adaptive_yield(
           options.enable_write_thread_adaptive_yield),
@@ -737,8 +765,16 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       skip_checking_sst_file_sizes_on_db_open(
           options.skip_checking_sst_file_sizes_on_db_open),
       wal_recovery_mode(options.wal_recovery_mode),
+      wal_recovery_threads(options.wal_recovery_threads),
       allow_2pc(options.allow_2pc),
       row_cache(options.row_cache),
+      block_cache_hot_set_persist_period_sec(
+          options.block_cache_hot_set_persist_period_sec),
+      block_cache_hot_set_max_blocks(options.block_cache_hot_set_max_blocks),
+      block_cache_warm_up_threads(options.block_cache_warm_up_threads),
+      block_cache_warm_up_bytes_per_sec(
+          options.block_cache_warm_up_bytes_per_sec),
+      get_result_cache(options.get_result_cache),
       wal_filter(options.wal_filter),
       fail_if_options_file_error(options.fail_if_options_file_error),
       dump_malloc_stats(options.dump_malloc_stats),
@@ -866,12 +902,16 @@ void ImmutableDBOptions::Dump(Logger* log) const {
       sst_file_manager ? sst_file_manager->GetDeleteRateBytesPerSecond() : 0);
   ROCKS_LOG_HEADER(log, "                      Options.wal_recovery_mode: %d",
                    static_cast<int>(wal_recovery_mode));
+  ROCKS_LOG_HEADER(log, "                   Options.wal_recovery_threads: %d",
+                   wal_recovery_threads);
   ROCKS_LOG_HEADER(log, "                 Options.enable_thread_tracking: %d",
                    enable_thread_tracking);
   ROCKS_LOG_HEADER(log, "                 Options.enable_pipelined_write: %d",
                    enable_pipelined_write);
   ROCKS_LOG_HEADER(log, "                 Options.unordered_write: %d",
                    unordered_write);
+  ROCKS_LOG_HEADER(log, "                Options.enable_wal_gather_write: %d",
+                   enable_wal_gather_write);
   ROCKS_LOG_HEADER(log, "        Options.allow_concurrent_memtable_write: %d",
                    allow_concurrent_memtable_write);
   ROCKS_LOG_HEADER(log, "     Options.enable_write_thread_adaptive_yield: %d",
@@ -891,6 +931,26 @@ void ImmutableDBOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "                              Options.row_cache: None");
   }
+  ROCKS_LOG_HEADER(log,
+                   " Options.block_cache_hot_set_persist_period_sec: %" PRIu64,
+                   block_cache_hot_set_persist_period_sec);
+  ROCKS_LOG_HEADER(log,
+                   "         Options.block_cache_hot_set_max_blocks: %" PRIu64,
+                   block_cache_hot_set_max_blocks);
+  ROCKS_LOG_HEADER(log, "            Options.block_cache_warm_up_threads: %d",
+                   block_cache_warm_up_threads);
+  ROCKS_LOG_HEADER(log,
+                   "      Options.block_cache_warm_up_bytes_per_sec: %" PRIu64,
+                   block_cache_warm_up_bytes_per_sec);
+  if (get_result_cache) {
+    ROCKS_LOG_HEADER(
+        log,
+        "                       Options.get_result_cache: %" ROCKSDB_PRIszt,
+        get_result_cache->GetCapacity());
+  } else {
+    ROCKS_LOG_HEADER(log,
+                     "                       Options.get_result_cache: None");
+  }
   ROCKS_LOG_HEADER(log, "                             Options.wal_filter: %s",
                    wal_filter ? wal_filter->Name() : "None");
 
@@ -68,6 +68,7 @@ struct ImmutableDBOptions {
   bool enable_thread_tracking;
   bool enable_pipelined_write;
   bool unordered_write;
+  bool enable_wal_gather_write;
   bool allow_concurrent_memtable_write;
   bool enable_write_thread_adaptive_yield;
   uint64_t write_thread_max_yield_usec;
@@ -75,8 +76,14 @@ struct ImmutableDBOptions {
   bool skip_stats_update_on_db_open;
   bool skip_checking_sst_file_sizes_on_db_open;
   WALRecoveryMode wal_recovery_mode;
+  int wal_recovery_threads;
   bool allow_2pc;
   std::shared_ptr<Cache> row_cache;
+  uint64_t block_cache_hot_set_persist_period_sec;
+  uint64_t block_cache_hot_set_max_blocks;
+  int block_cache_warm_up_threads;
+  uint64_t block_cache_warm_up_bytes_per_sec;
+  std::shared_ptr<Cache> get_result_cache;
   WalFilter* wal_filter;
   bool fail_if_options_file_error;
   bool dump_malloc_stats;
@@ -57,6 +57,8 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
           options.memtable_prefix_bloom_size_ratio),
       memtable_whole_key_filtering(options.memtable_whole_key_filtering),
       memtable_huge_page_size(options.memtable_huge_page_size),
+      memtable_numa_aware(options.memtable_numa_aware),
+      memtable_transparent_huge_page(options.memtable_transparent_huge_page),
       memtable_insert_with_hint_prefix_extractor(
           options.memtable_insert_with_hint_prefix_extractor),
       bloom_locality(options.bloom_locality),
@@ -401,6 +403,10 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
 
     ROCKS_LOG_HEADER(log, "  Options.memtable_huge_page_size: %" ROCKSDB_PRIszt,
                      memtable_huge_page_size);
+    ROCKS_LOG_HEADER(log, "      Options.memtable_numa_aware: %d",
+                     memtable_numa_aware);
+    ROCKS_LOG_HEADER(log, "  Options.memtable_transparent_huge_page: %d",
+                     memtable_transparent_huge_page);
     ROCKS_LOG_HEADER(log,
                      "                          Options.bloom_locality: %d",
                      bloom_locality);
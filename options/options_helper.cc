@@ -131,6 +131,8 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.delayed_write_rate = mutable_db_options.delayed_write_rate;
   options.enable_pipelined_write = immutable_db_options.enable_pipelined_write;
   options.unordered_write = immutable_db_options.unordered_write;
+  options.enable_wal_gather_write =
+      immutable_db_options.enable_wal_gather_write;
   options.allow_concurrent_memtable_write =
       immutable_db_options.allow_concurrent_memtable_write;
   options.enable_write_thread_adaptive_yield =
@@ -146,8 +148,18 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.skip_checking_sst_file_sizes_on_db_open =
       immutable_db_options.skip_checking_sst_file_sizes_on_db_open;
   options.wal_recovery_mode = immutable_db_options.wal_recovery_mode;
+  options.wal_recovery_threads = immutable_db_options.wal_recovery_threads;
   options.allow_2pc = immutable_db_options.allow_2pc;
   options.row_cache = immutable_db_options.row_cache;
+  options.block_cache_hot_set_persist_period_sec =
+      immutable_db_options.block_cache_hot_set_persist_period_sec;
+  options.block_cache_hot_set_max_blocks =
+      immutable_db_options.block_cache_hot_set_max_blocks;
+  options.block_cache_warm_up_threads =
+      immutable_db_options.block_cache_warm_up_threads;
+  options.block_cache_warm_up_bytes_per_sec =
+      immutable_db_options.block_cache_warm_up_bytes_per_sec;
+  options.get_result_cache = immutable_db_options.get_result_cache;
   options.wal_filter = immutable_db_options.wal_filter;
   options.fail_if_options_file_error =
       immutable_db_options.fail_if_options_file_error;
@@ -202,6 +214,9 @@ void UpdateColumnFamilyOptions(const MutableCFOptions& moptions,
       moptions.memtable_prefix_bloom_size_ratio;
   cf_opts->memtable_whole_key_filtering = moptions.memtable_whole_key_filtering;
   cf_opts->memtable_huge_page_size = moptions.memtable_huge_page_size;
+  cf_opts->memtable_numa_aware = moptions.memtable_numa_aware;
+  cf_opts->memtable_transparent_huge_page =
+      moptions.memtable_transparent_huge_page;
   cf_opts->max_successive_merges = moptions.max_successive_merges;
   cf_opts->inplace_update_num_locks = moptions.inplace_update_num_locks;
   cf_opts->prefix_extractor = moptions.prefix_extractor;
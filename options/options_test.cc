@@ -1235,6 +1235,35 @@ TEST_F(OptionsTest, GetMemTableRepFactoryFromString) {
   ASSERT_NOK(GetMemTableRepFactoryFromString("vector:1024:invalid_opt",
                                              &new_mem_factory));
 
+  ASSERT_OK(GetMemTableRepFactoryFromString("art", &new_mem_factory));
+  ASSERT_EQ(std::string(new_mem_factory->Name()),
+            "AdaptiveRadixTreeRepFactory");
+  ASSERT_OK(GetMemTableRepFactoryFromString("AdaptiveRadixTreeRepFactory",
+                                            &new_mem_factory));
+  ASSERT_NOK(GetMemTableRepFactoryFromString("art:16", &new_mem_factory));
+
+  ASSERT_OK(GetMemTableRepFactoryFromString("partitioned", &new_mem_factory));
+  ASSERT_EQ(std::string(new_mem_factory->Name()), "PartitionedRepFactory");
+  ASSERT_OK(
+      GetMemTableRepFactoryFromString("partitioned:16", &new_mem_factory));
+  const size_t* num_partitions =
+      new_mem_factory->GetOptions<size_t>("PartitionedRepFactoryOptions");
+  ASSERT_NE(num_partitions, nullptr);
+  ASSERT_EQ(*num_partitions, 16U);
+  ASSERT_OK(GetMemTableRepFactoryFromString(
+      "id=partitioned; num_partitions=4; rep=hash_linkedlist:1000",
+      &new_mem_factory));
+  num_partitions =
+      new_mem_factory->GetOptions<size_t>("PartitionedRepFactoryOptions");
+  ASSERT_EQ(*num_partitions, 4U);
+  const auto* sub_rep =
+      new_mem_factory->GetOptions<std::shared_ptr<MemTableRepFactory>>(
+          "PartitionedRepFactoryRep");
+  ASSERT_NE(sub_rep, nullptr);
+  ASSERT_STREQ((*sub_rep)->Name(), "HashLinkListRepFactory");
+  ASSERT_NOK(GetMemTableRepFactoryFromString("partitioned:16:invalid_opt",
+                                             &new_mem_factory));
+
   ASSERT_NOK(GetMemTableRepFactoryFromString("cuckoo", &new_mem_factory));
   // CuckooHash memtable is already removed.
   ASSERT_NOK(GetMemTableRepFactoryFromString("cuckoo:1024", &new_mem_factory));
@@ -48,7 +48,8 @@ MemMapping& MemMapping::operator=(MemMapping&& other) noexcept {
   return *this;
 }
 
-MemMapping MemMapping::AllocateAnonymous(size_t length, bool huge) {
+MemMapping MemMapping::AllocateAnonymous(size_t length, bool huge,
+                                         size_t huge_page_size) {
   MemMapping mm;
   mm.length_ = length;
   assert(mm.addr_ == nullptr);
@@ -58,6 +59,7 @@ MemMapping MemMapping::AllocateAnonymous(size_t length, bool huge) {
   }
   int huge_flag = 0;
 #ifdef OS_WIN
+  (void)huge_page_size;
   if (huge) {
 #ifdef FILE_MAP_LARGE_PAGES
     huge_flag = FILE_MAP_LARGE_PAGES;
@@ -76,6 +78,16 @@ MemMapping MemMapping::AllocateAnonymous(size_t length, bool huge) {
   if (huge) {
 #ifdef MAP_HUGETLB
     huge_flag = MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+    if (huge_page_size > 0 && (huge_page_size & (huge_page_size - 1)) == 0) {
+      // log2 of the page size selects the hugetlb pool, e.g. MAP_HUGE_1GB
+      int shift = 0;
+      while ((size_t{1} << shift) < huge_page_size) {
+        ++shift;
+      }
+      huge_flag |= shift << MAP_HUGE_SHIFT;
+    }
+#endif  // MAP_HUGE_SHIFT
 #endif  // MAP_HUGE_TLB
   }
   mm.addr_ = mmap(nullptr, length, PROT_READ | PROT_WRITE,
@@ -91,8 +103,72 @@ MemMapping MemMapping::AllocateHuge(size_t length) {
   return AllocateAnonymous(length, /*huge*/ true);
 }
 
+MemMapping MemMapping::AllocateHuge(size_t length, size_t huge_page_size) {
+  return AllocateAnonymous(length, /*huge*/ true, huge_page_size);
+}
+
+MemMapping MemMapping::AllocateTransparentHuge(size_t length,
+                                               size_t huge_page_size) {
+#if defined(OS_WIN) || !defined(MADV_HUGEPAGE)
+  (void)huge_page_size;
+  return AllocateAnonymous(length, /*huge*/ false);
+#else
+  if (huge_page_size == 0 || length == 0) {
+    return AllocateAnonymous(length, /*huge*/ false);
+  }
+  // Over-allocate so that an aligned range can be cut out, the kernel only
+  // uses huge pages for aligned ranges.
+  MemMapping mm = AllocateAnonymous(length + huge_page_size, /*huge*/ false);
+  if (mm.addr_ == nullptr) {
+    return mm;
+  }
+  char* begin = static_cast<char*>(mm.addr_);
+  char* aligned = reinterpret_cast<char*>(
+      (reinterpret_cast<uintptr_t>(begin) + huge_page_size - 1) &
+      ~(uintptr_t{huge_page_size} - 1));
+  char* end = begin + mm.length_;
+  if (aligned > begin) {
+    munmap(begin, aligned - begin);
+  }
+  if (end > aligned + length) {
+    munmap(aligned + length, end - (aligned + length));
+  }
+  mm.addr_ = aligned;
+  mm.length_ = length;
+  // Best effort, e.g. THP may be disabled entirely
+  (void)madvise(mm.addr_, mm.length_, MADV_HUGEPAGE);
+  return mm;
+#endif  // OS_WIN || !MADV_HUGEPAGE
+}
+
 MemMapping MemMapping::AllocateLazyZeroed(size_t length) {
   return AllocateAnonymous(length, /*huge*/ false);
 }
 
+MemMapping MemMapping::AllocatePrefaulted(size_t length) {
+#if !defined(OS_WIN) && defined(MAP_POPULATE)
+  MemMapping mm;
+  mm.length_ = length;
+  if (length == 0) {
+    return mm;
+  }
+  mm.addr_ = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+  if (mm.addr_ == MAP_FAILED) {
+    mm.addr_ = nullptr;
+  }
+  return mm;
+#else
+  MemMapping mm = AllocateAnonymous(length, /*huge*/ false);
+  if (mm.addr_ != nullptr) {
+    // Touch every page
+    volatile char* p = static_cast<char*>(mm.addr_);
+    for (size_t i = 0; i < length; i += 4096) {
+      p[i] = 0;
+    }
+  }
+  return mm;
+#endif  // !OS_WIN && MAP_POPULATE
+}
+
 }  // namespace ROCKSDB_NAMESPACE
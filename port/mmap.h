@@ -32,6 +32,17 @@ class MemMapping {
   // Allocate memory requesting to be backed by huge pages
   static MemMapping AllocateHuge(size_t length);
 
+  // Like AllocateHuge, but requesting huge pages of huge_page_size (e.g. 2MB
+  // or 1GB) rather than the system default size, where supported.
+  static MemMapping AllocateHuge(size_t length, size_t huge_page_size);
+
+  // Allocate lazily mapped memory aligned to huge_page_size and advise the
+  // kernel to back it with transparent huge pages (madvise MADV_HUGEPAGE).
+  // Unlike AllocateHuge this needs no reserved huge pages, but whether huge
+  // pages are actually used is up to the kernel.
+  static MemMapping AllocateTransparentHuge(size_t length,
+                                            size_t huge_page_size);
+
   // Allocate memory that is only lazily mapped to resident memory and
   // guaranteed to be zero-initialized. Note that some platforms like
   // Linux allow memory over-commit, where only the used portion of memory
@@ -39,6 +50,11 @@ class MemMapping {
   // back the full mapping.
   static MemMapping AllocateLazyZeroed(size_t length);
 
+  // Like AllocateLazyZeroed, but the memory is faulted in up front
+  // (MAP_POPULATE where supported), so first writes to it take no page
+  // faults.
+  static MemMapping AllocatePrefaulted(size_t length);
+
   // No copies
   MemMapping(const MemMapping&) = delete;
   MemMapping& operator=(const MemMapping&) = delete;
@@ -64,7 +80,8 @@ class MemMapping {
   HANDLE page_file_handle_ = NULL;
 #endif  // OS_WIN
 
-  static MemMapping AllocateAnonymous(size_t length, bool huge);
+  static MemMapping AllocateAnonymous(size_t length, bool huge,
+                                      size_t huge_page_size = 0);
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,139 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "port/numa.h"
+
+#ifdef NUMA
+#include <numa.h>
+#elif defined(OS_LINUX)
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#endif
+
+namespace ROCKSDB_NAMESPACE {
+namespace port {
+
+#ifdef NUMA
+
+int NumaNumNodes() {
+  static const int num_nodes =
+      numa_available() < 0 ? 1 : numa_max_node() + 1;
+  return num_nodes;
+}
+
+int NumaNodeOfCpu(int cpu) {
+  if (NumaNumNodes() <= 1 || cpu < 0) {
+    return 0;
+  }
+  int node = numa_node_of_cpu(cpu);
+  return node < 0 ? 0 : node;
+}
+
+bool NumaBindMemory(void* addr, size_t len, int node) {
+  if (NumaNumNodes() <= 1 || node < 0 || node >= NumaNumNodes()) {
+    return false;
+  }
+  // Uses mbind(MPOL_BIND) under the hood
+  numa_tonode_memory(addr, len, node);
+  return true;
+}
+
+bool NumaRunOnNode(int node) {
+  if (NumaNumNodes() <= 1) {
+    return false;
+  }
+  return numa_run_on_node(node) == 0;
+}
+
+#elif defined(OS_LINUX)
+
+namespace {
+// Returns the largest N of the "<prefix>N" entries of dir, or -1
+int MaxNumberedEntry(const char* dir, const char* prefix) {
+  DIR* d = opendir(dir);
+  if (d == nullptr) {
+    return -1;
+  }
+  size_t prefix_len = strlen(prefix);
+  int max_n = -1;
+  while (struct dirent* e = readdir(d)) {
+    int n;
+    if (strncmp(e->d_name, prefix, prefix_len) == 0 &&
+        sscanf(e->d_name + prefix_len, "%d", &n) == 1 && n > max_n) {
+      max_n = n;
+    }
+  }
+  closedir(d);
+  return max_n;
+}
+}  // namespace
+
+int NumaNumNodes() {
+  static const int num_nodes = [] {
+    int max_node = MaxNumberedEntry("/sys/devices/system/node", "node");
+    return max_node < 0 ? 1 : max_node + 1;
+  }();
+  return num_nodes;
+}
+
+int NumaNodeOfCpu(int cpu) {
+  if (NumaNumNodes() <= 1 || cpu < 0) {
+    return 0;
+  }
+  static const std::vector<int> cpu_to_node = [] {
+    std::vector<int> nodes(std::max(sysconf(_SC_NPROCESSORS_CONF), 1L), 0);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      // /sys/devices/system/cpu/cpuN/ contains a "nodeM" link
+      char dir[64];
+      snprintf(dir, sizeof(dir), "/sys/devices/system/cpu/cpu%zu", i);
+      nodes[i] = std::max(MaxNumberedEntry(dir, "node"), 0);
+    }
+    return nodes;
+  }();
+  return static_cast<size_t>(cpu) < cpu_to_node.size() ? cpu_to_node[cpu] : 0;
+}
+
+bool NumaBindMemory(void* /*addr*/, size_t /*len*/, int /*node*/) {
+  return false;
+}
+
+bool NumaRunOnNode(int node) {
+  int num_nodes = NumaNumNodes();
+  if (num_nodes <= 1 || node < 0 || node >= num_nodes) {
+    return false;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  long num_cpus = sysconf(_SC_NPROCESSORS_CONF);
+  for (int cpu = 0; cpu < num_cpus && cpu < CPU_SETSIZE; ++cpu) {
+    if (NumaNodeOfCpu(cpu) == node) {
+      CPU_SET(cpu, &set);
+    }
+  }
+  return CPU_COUNT(&set) > 0 && sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+#else
+
+int NumaNumNodes() { return 1; }
+
+int NumaNodeOfCpu(int /*cpu*/) { return 0; }
+
+bool NumaBindMemory(void* /*addr*/, size_t /*len*/, int /*node*/) {
+  return false;
+}
+
+bool NumaRunOnNode(int /*node*/) { return false; }
+
+#endif  // NUMA
+
+}  // namespace port
+}  // namespace ROCKSDB_NAMESPACE
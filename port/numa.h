@@ -0,0 +1,37 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// Minimal NUMA topology and placement helpers. With -DNUMA (libnuma) memory
+// can be bound to a node with mbind(); otherwise on Linux the topology is
+// read from sysfs and placement relies on the first-touch policy, and on
+// other platforms everything is reported as a single node.
+
+#pragma once
+
+#include <cstddef>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace port {
+
+// Number of NUMA nodes, 1 if unknown or not supported
+int NumaNumNodes();
+
+// Returns the NUMA node of cpu, or 0 if unknown
+int NumaNodeOfCpu(int cpu);
+
+// Binds the pages of [addr, addr + len) to node, addr must be page aligned.
+// Must be called before the memory is touched. Returns false if binding is
+// not supported, in which case the pages end up on the node of the thread
+// that first touches them.
+bool NumaBindMemory(void* addr, size_t len, int node);
+
+// Restricts the calling thread to the cpus of node.
+// Returns false on failure or if not supported.
+bool NumaRunOnNode(int node);
+
+}  // namespace port
+}  // namespace ROCKSDB_NAMESPACE
@@ -20,10 +20,13 @@ LIB_SOURCES =                                                   \
   cache/charged_cache.cc                                        \
   cache/clock_cache.cc                                          \
   cache/lru_cache.cc                                            \
+  cache/miss_ratio_curve.cc                                     \
   cache/compressed_secondary_cache.cc                           \
+  cache/nvm_secondary_cache.cc                                  \
   cache/secondary_cache.cc                                      \
   cache/secondary_cache_adapter.cc                              \
   cache/sharded_cache.cc                                        \
+  cache/tiny_lfu.cc                                             \
   db/arena_wrapped_db_iter.cc                                   \
   db/blob/blob_contents.cc                                      \
   db/blob/blob_fetcher.cc                                       \
@@ -39,6 +42,7 @@ LIB_SOURCES =                                                   \
   db/blob/blob_log_writer.cc                                    \
   db/blob/blob_source.cc                                        \
   db/blob/prefetch_buffer_collection.cc                         \
+  db/block_cache_hot_set.cc                                     \
   db/builder.cc                                                 \
   db/c.cc                                                       \
   db/column_family.cc                                           \
@@ -59,6 +63,7 @@ LIB_SOURCES =                                                   \
   db/db_filesnapshot.cc                                         \
   db/db_impl/compacted_db_impl.cc                               \
   db/db_impl/db_impl.cc                                         \
+  db/db_impl/db_impl_block_cache_hot_set.cc                     \
   db/db_impl/db_impl_compaction_flush.cc                        \
   db/db_impl/db_impl_debug.cc                                   \
   db/db_impl/db_impl_experimental.cc                            \
@@ -78,6 +83,7 @@ LIB_SOURCES =                                                   \
   db/flush_job.cc                                               \
   db/flush_scheduler.cc                                         \
   db/forward_iterator.cc                                        \
+  db/get_result_cache.cc                                        \
   db/import_column_family_job.cc                                \
   db/internal_stats.cc                                          \
   db/logs_with_prep_tracker.cc                                  \
@@ -139,13 +145,18 @@ LIB_SOURCES =                                                   \
   logging/event_logger.cc                                       \
   logging/log_buffer.cc                                         \
   memory/arena.cc                                               \
+  memory/arena_block_pool.cc                                    \
   memory/concurrent_arena.cc                                    \
   memory/jemalloc_nodump_allocator.cc                           \
   memory/memkind_kmem_allocator.cc                              \
   memory/memory_allocator.cc                                    \
+  memory/memory_governor.cc                                     \
   memtable/alloc_tracker.cc                                     \
+  memtable/art.cc                                               \
+  memtable/art_rep.cc                                           \
   memtable/hash_linklist_rep.cc                                 \
   memtable/hash_skiplist_rep.cc                                 \
+  memtable/partitioned_rep.cc                                   \
   memtable/skiplistrep.cc                                       \
   memtable/vectorrep.cc                                         \
   memtable/write_buffer_manager.cc                              \
@@ -171,6 +182,7 @@ LIB_SOURCES =                                                   \
   options/options_helper.cc                                     \
   options/options_parser.cc                                     \
   port/mmap.cc                                                  \
+  port/numa.cc                                                  \
   port/port_posix.cc                                            \
   port/win/env_default.cc                                       \
   port/win/env_win.cc                                           \
@@ -199,11 +211,15 @@ LIB_SOURCES =                                                   \
   table/block_based/hash_index_reader.cc                        \
   table/block_based/index_builder.cc                            \
   table/block_based/index_reader_common.cc                      \
+  table/block_based/learned_index.cc                            \
+  table/block_based/learned_index_reader.cc                     \
   table/block_based/parsed_full_filter_block.cc                 \
   table/block_based/partitioned_filter_block.cc                 \
   table/block_based/partitioned_index_iterator.cc               \
   table/block_based/partitioned_index_reader.cc                 \
   table/block_based/reader_common.cc                            \
+  table/block_based/succinct_trie.cc                            \
+  table/block_based/trie_index_reader.cc                        \
   table/block_based/uncompression_dict_reader.cc                \
   table/block_fetcher.cc                                        \
   table/cuckoo/cuckoo_table_builder.cc                          \
@@ -447,6 +463,7 @@ TEST_MAIN_SOURCES =                                                     \
   cache/cache_reservation_manager_test.cc                               \
   cache/lru_cache_test.cc                                               \
   cache/compressed_secondary_cache_test.cc                              \
+  cache/nvm_secondary_cache_test.cc                                     \
   db/blob/blob_counting_iterator_test.cc                                \
   db/blob/blob_file_addition_test.cc                                    \
   db/blob/blob_file_builder_test.cc                                     \
@@ -557,6 +574,8 @@ TEST_MAIN_SOURCES =                                                     \
   logging/event_logger_test.cc                                          \
   memory/arena_test.cc                                                  \
   memory/memory_allocator_test.cc                                       \
+  memory/memory_governor_test.cc                                        \
+  memtable/art_test.cc                                                  \
   memtable/inlineskiplist_test.cc                                       \
   memtable/skiplist_test.cc                                             \
   memtable/write_buffer_manager_test.cc                                 \
@@ -572,7 +591,9 @@ TEST_MAIN_SOURCES =                                                     \
   table/block_based/block_test.cc                                       \
   table/block_based/data_block_hash_index_test.cc                       \
   table/block_based/full_filter_block_test.cc                           \
+  table/block_based/learned_index_test.cc                               \
   table/block_based/partitioned_filter_block_test.cc                    \
+  table/block_based/succinct_trie_test.cc                               \
   table/cleanable_test.cc                                               \
   table/cuckoo/cuckoo_table_builder_test.cc                             \
   table/cuckoo/cuckoo_table_reader_test.cc                              \
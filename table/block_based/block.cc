@@ -11,7 +11,12 @@
 
 #include "table/block_based/block.h"
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 #include <algorithm>
+#include <limits>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -22,8 +27,10 @@
 #include "rocksdb/comparator.h"
 #include "table/block_based/block_prefix_index.h"
 #include "table/block_based/data_block_footer.h"
+#include "table/block_based/learned_index.h"
 #include "table/format.h"
 #include "util/coding.h"
+#include "util/math.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -474,6 +481,8 @@ void IndexBlockIter::SeekImpl(const Slice& target) {
     // restart interval must be one when hash search is enabled so the binary
     // search simply lands at the right place.
     skip_linear_scan = true;
+  } else if (learned_index_) {
+    ok = LearnedSeek(seek_key, &index, &skip_linear_scan);
   } else if (value_delta_encoded_) {
     ok = BinarySeek<DecodeKeyV4>(seek_key, &index, &skip_linear_scan);
   } else {
@@ -791,6 +800,66 @@ void BlockIter<TValue>::FindKeyAfterBinarySeek(const Slice& target,
   }
 }
 
+namespace {
+// Returns the number of the n sorted fixed64 values at p that are less than
+// x. A branchless binary search narrows them down to a window of at most
+// kWindow values, which are then compared all at once.
+uint32_t CountRestartKeyPrefixesLessThan(const char* p, uint32_t n,
+                                         uint64_t x) {
+  constexpr uint32_t kWindow = 8;
+  uint32_t base = 0;
+  while (n > kWindow) {
+    uint32_t half = n / 2;
+    // The first half are all less than x, or the count is within it.
+    base += DecodeFixed64(p + (base + half - 1) * sizeof(uint64_t)) < x
+                ? half
+                : 0;
+    n -= half;
+  }
+  p += base * sizeof(uint64_t);
+  uint32_t count = 0;
+  uint32_t i = 0;
+#ifdef __AVX2__
+  // Unsigned compares, as signed compares of values with the sign bit flipped
+  const __m256i sign = _mm256_set1_epi64x(std::numeric_limits<int64_t>::min());
+  const __m256i target =
+      _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(x)), sign);
+  for (; i + 4 <= n; i += 4) {
+    __m256i values = _mm256_xor_si256(
+        _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(p + i * sizeof(uint64_t))),
+        sign);
+    __m256i less = _mm256_cmpgt_epi64(target, values);
+    count += static_cast<uint32_t>(
+        BitsSetToOne(_mm256_movemask_pd(_mm256_castsi256_pd(less))));
+  }
+#endif
+  for (; i < n; ++i) {
+    count += DecodeFixed64(p + i * sizeof(uint64_t)) < x ? 1 : 0;
+  }
+  return base + count;
+}
+}  // namespace
+
+// Restart keys with a smaller prefix than the target are smaller, and those
+// with a larger prefix are larger, so only the restart keys with the same
+// prefix need to be compared.
+template <class TValue>
+void BlockIter<TValue>::NarrowByRestartKeyPrefixes(const Slice& target,
+                                                   int64_t* left,
+                                                   int64_t* right) const {
+  assert(!raw_key_.IsUserKey());
+  const uint64_t prefix = RestartKeyPrefix(ExtractUserKey(target));
+  *left = static_cast<int64_t>(CountRestartKeyPrefixesLessThan(
+              restart_key_prefixes_, num_restarts_, prefix)) -
+          1;
+  if (prefix < std::numeric_limits<uint64_t>::max()) {
+    *right = static_cast<int64_t>(CountRestartKeyPrefixesLessThan(
+                 restart_key_prefixes_, num_restarts_, prefix + 1)) -
+             1;
+  }
+}
+
 // Binary searches in restart array to find the starting restart point for the
 // linear scan, and stores it in `*index`. Assumes restart array does not
 // contain duplicate keys. It is guaranteed that the restart key at `*index + 1`
@@ -821,6 +890,9 @@ bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
   // - Any restart keys after index `right` are strictly greater than the target
   //   key.
   int64_t left = -1, right = num_restarts_ - 1;
+  if (restart_key_prefixes_ != nullptr) {
+    NarrowByRestartKeyPrefixes(target, &left, &right);
+  }
   while (left != right) {
     // The `mid` is computed by rounding up so it lands in (`left`, `right`].
     int64_t mid = left + (right - left + 1) / 2;
@@ -880,6 +952,76 @@ int IndexBlockIter::CompareBlockKey(uint32_t block_index, const Slice& target) {
   return CompareCurrentKey(target);
 }
 
+bool IndexBlockIter::LearnedSeek(const Slice& target, uint32_t* index,
+                                 bool* skip_linear_scan) {
+  if (restarts_ == 0) {
+    // See BinarySeek()
+    return false;
+  }
+  assert(learned_index_->NumEntries() == num_restarts_);
+  uint32_t lo, hi;
+  const Slice user_key =
+      raw_key_.IsUserKey() ? target : ExtractUserKey(target);
+  learned_index_->Predict(user_key, &lo, &hi);
+
+  *skip_linear_scan = false;
+  // Same loop invariants as BinarySeek(). The model may be off for keys it
+  // could not tell apart, so each bound of the window is checked before
+  // narrowing the search to it, falling back to the rest of the block.
+  int64_t left = -1, right = num_restarts_ - 1;
+  if (lo > 0) {
+    int cmp = CompareBlockKey(lo - 1, target);
+    if (!status_.ok()) {
+      return false;
+    }
+    if (cmp < 0) {
+      left = lo - 1;
+    } else if (cmp > 0) {
+      right = static_cast<int64_t>(lo) - 2;
+    } else {
+      *skip_linear_scan = true;
+      left = right = lo - 1;
+    }
+  }
+  if (static_cast<int64_t>(hi) < right) {
+    int cmp = CompareBlockKey(hi + 1, target);
+    if (!status_.ok()) {
+      return false;
+    }
+    if (cmp < 0) {
+      left = hi + 1;
+    } else if (cmp > 0) {
+      right = hi;
+    } else {
+      *skip_linear_scan = true;
+      left = right = hi + 1;
+    }
+  }
+  while (left != right) {
+    int64_t mid = left + (right - left + 1) / 2;
+    int cmp = CompareBlockKey(static_cast<uint32_t>(mid), target);
+    if (!status_.ok()) {
+      return false;
+    }
+    if (cmp < 0) {
+      left = mid;
+    } else if (cmp > 0) {
+      right = mid - 1;
+    } else {
+      *skip_linear_scan = true;
+      left = right = mid;
+    }
+  }
+
+  if (left == -1) {
+    *skip_linear_scan = true;
+    *index = 0;
+  } else {
+    *index = static_cast<uint32_t>(left);
+  }
+  return true;
+}
+
 // Binary search in block_ids to find the first block
 // with a key >= target
 bool IndexBlockIter::BinaryBlockIndexSeek(const Slice& target,
@@ -1003,13 +1145,19 @@ uint32_t Block::NumRestarts() const {
     // Such check is for backward compatibility. We can ensure legacy block
     // with a vary large num_restarts i.e. >= 0x80000000 can be interpreted
     // correctly as no HashIndex even if the MSB of num_restarts is set.
-    return num_restarts;
+    return num_restarts & ~kRestartKeyPrefixesFlag;
   }
   BlockBasedTableOptions::DataBlockIndexType index_type;
   UnPackIndexTypeAndNumRestarts(block_footer, &index_type, &num_restarts);
   return num_restarts;
 }
 
+bool Block::HasRestartKeyPrefixes() const {
+  assert(size_ >= 2 * sizeof(uint32_t));
+  uint32_t block_footer = DecodeFixed32(data_ + size_ - sizeof(uint32_t));
+  return (block_footer & kRestartKeyPrefixesFlag) != 0;
+}
+
 BlockBasedTableOptions::DataBlockIndexType Block::IndexType() const {
   assert(size_ >= 2 * sizeof(uint32_t));
   if (size_ > kMaxBlockSizeSupportedByHashIndex) {
@@ -1043,10 +1191,19 @@ Block::Block(BlockContents&& contents, size_t read_amp_bytes_per_bit,
   } else {
     // Should only decode restart points for uncompressed blocks
     num_restarts_ = NumRestarts();
+    uint32_t restart_key_prefixes_size = 0;
+    if (HasRestartKeyPrefixes()) {
+      // Bounded by the block size, so that the offsets below cannot wrap
+      // around by more than the block size
+      restart_key_prefixes_size = static_cast<uint32_t>(
+          std::min<uint64_t>(uint64_t{num_restarts_} * sizeof(uint64_t),
+                             size_));
+    }
     switch (IndexType()) {
       case BlockBasedTableOptions::kDataBlockBinarySearch:
         restart_offset_ = static_cast<uint32_t>(size_) -
-                          (1 + num_restarts_) * sizeof(uint32_t);
+                          (1 + num_restarts_) * sizeof(uint32_t) -
+                          restart_key_prefixes_size;
         if (restart_offset_ > size_ - sizeof(uint32_t)) {
           // The size is too small for NumRestarts() and therefore
           // restart_offset_ wrapped around.
@@ -1066,7 +1223,8 @@ Block::Block(BlockContents&& contents, size_t read_amp_bytes_per_bit,
                                                                 NUM_RESTARTS*/
             &map_offset);
 
-        restart_offset_ = map_offset - num_restarts_ * sizeof(uint32_t);
+        restart_offset_ = map_offset - num_restarts_ * sizeof(uint32_t) -
+                          restart_key_prefixes_size;
 
         if (restart_offset_ > map_offset) {
           // map_offset is too small for NumRestarts() and
@@ -1078,6 +1236,10 @@ Block::Block(BlockContents&& contents, size_t read_amp_bytes_per_bit,
       default:
         size_ = 0;  // Error marker
     }
+    if (size_ != 0 && restart_key_prefixes_size > 0) {
+      restart_key_prefixes_ =
+          data_ + restart_offset_ + num_restarts_ * sizeof(uint32_t);
+    }
   }
   if (read_amp_bytes_per_bit != 0 && statistics && size_ != 0) {
     read_amp_bitmap_.reset(new BlockReadAmpBitmap(
@@ -1252,7 +1414,8 @@ DataBlockIter* Block::NewDataIterator(const Comparator* raw_ucmp,
         read_amp_bitmap_.get(), block_contents_pinned,
         user_defined_timestamps_persisted,
         data_block_hash_index_.Valid() ? &data_block_hash_index_ : nullptr,
-        protection_bytes_per_key_, kv_checksum_, block_restart_interval_);
+        restart_key_prefixes_, protection_bytes_per_key_, kv_checksum_,
+        block_restart_interval_);
     if (read_amp_bitmap_) {
       if (read_amp_bitmap_->GetStatistics() != stats) {
         // DB changed the Statistics pointer, we need to notify read_amp_bitmap_
@@ -1269,7 +1432,7 @@ IndexBlockIter* Block::NewIndexIterator(
     IndexBlockIter* iter, Statistics* /*stats*/, bool total_order_seek,
     bool have_first_key, bool key_includes_seq, bool value_is_full,
     bool block_contents_pinned, bool user_defined_timestamps_persisted,
-    BlockPrefixIndex* prefix_index) {
+    BlockPrefixIndex* prefix_index, const LearnedIndexModel* learned_index) {
   IndexBlockIter* ret_iter;
   if (iter != nullptr) {
     ret_iter = iter;
@@ -1287,11 +1450,18 @@ IndexBlockIter* Block::NewIndexIterator(
   } else {
     BlockPrefixIndex* prefix_index_ptr =
         total_order_seek ? nullptr : prefix_index;
+    // The model gives the position of each index entry, so it only applies
+    // to blocks with a restart point per entry.
+    if (learned_index != nullptr &&
+        learned_index->NumEntries() != num_restarts_) {
+      learned_index = nullptr;
+    }
     ret_iter->Initialize(
         raw_ucmp, data_, restart_offset_, num_restarts_, global_seqno,
         prefix_index_ptr, have_first_key, key_includes_seq, value_is_full,
         block_contents_pinned, user_defined_timestamps_persisted,
-        protection_bytes_per_key_, kv_checksum_, block_restart_interval_);
+        protection_bytes_per_key_, kv_checksum_, block_restart_interval_,
+        learned_index);
   }
 
   return ret_iter;
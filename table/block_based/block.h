@@ -39,6 +39,7 @@ class DataBlockIter;
 class IndexBlockIter;
 class MetaBlockIter;
 class BlockPrefixIndex;
+class LearnedIndexModel;
 
 // BlockReadAmpBitmap is a bitmap that map the ROCKSDB_NAMESPACE::Block data
 // bytes to a bitmap with ratio bytes_per_bit. Whenever we access a range of
@@ -172,6 +173,10 @@ class Block {
 
   BlockBasedTableOptions::DataBlockIndexType IndexType() const;
 
+  // Whether the restart array is followed by restart key prefixes, which
+  // data block seeks search before comparing restart keys.
+  bool HasRestartKeyPrefixes() const;
+
   // raw_ucmp is a raw (i.e., not wrapped by `UserComparatorWrapper`) user key
   // comparator.
   //
@@ -227,6 +232,9 @@ class Block {
   // If `prefix_index` is not nullptr this block will do hash lookup for the key
   // prefix. If total_order_seek is true, prefix_index_ is ignored.
   //
+  // If `learned_index` is not nullptr, seeks only binary search the window of
+  // restart points it predicts, which requires a restart interval of 1.
+  //
   // `have_first_key` controls whether IndexValue will contain
   // first_internal_key. It affects data serialization format, so the same value
   // have_first_key must be used when writing and reading index.
@@ -239,7 +247,8 @@ class Block {
       bool have_first_key, bool key_includes_seq, bool value_is_full,
       bool block_contents_pinned = false,
       bool user_defined_timestamps_persisted = true,
-      BlockPrefixIndex* prefix_index = nullptr);
+      BlockPrefixIndex* prefix_index = nullptr,
+      const LearnedIndexModel* learned_index = nullptr);
 
   // Report an approximation of how much memory has been used.
   size_t ApproximateMemoryUsage() const;
@@ -288,6 +297,8 @@ class Block {
   uint32_t block_restart_interval_{0};
   uint8_t protection_bytes_per_key_{0};
   DataBlockHashIndex data_block_hash_index_;
+  // RestartKeyPrefix() of each restart key, fixed64 encoded, or nullptr
+  const char* restart_key_prefixes_{nullptr};
 };
 
 // A `BlockIter` iterates over the entries in a `Block`'s data buffer. The
@@ -459,6 +470,9 @@ class BlockIter : public InternalIteratorBase<TValue> {
   // partitioned index blocks. In summary, this only applies to block whose key
   // are real user keys or internal keys created from user keys.
   bool pad_min_timestamp_;
+  // RestartKeyPrefix() of each restart key, fixed64 encoded, if the block
+  // has them and the keys are internal keys. Set by DataBlockIter.
+  const char* restart_key_prefixes_ = nullptr;
 
   // Per key-value checksum related states
   const char* kv_checksum_;
@@ -671,6 +685,11 @@ class BlockIter : public InternalIteratorBase<TValue> {
   }
 
  protected:
+  // Narrows the initial [left, right] range of BinarySeek() to the restart
+  // points whose key prefix is the same as the target's.
+  void NarrowByRestartKeyPrefixes(const Slice& target, int64_t* left,
+                                  int64_t* right) const;
+
   template <typename DecodeKeyFunc>
   inline bool BinarySeek(const Slice& target, uint32_t* index,
                          bool* is_index_key_result);
@@ -699,6 +718,7 @@ class DataBlockIter final : public BlockIter<Slice> {
                   bool block_contents_pinned,
                   bool user_defined_timestamps_persisted,
                   DataBlockHashIndex* data_block_hash_index,
+                  const char* restart_key_prefixes,
                   uint8_t protection_bytes_per_key, const char* kv_checksum,
                   uint32_t block_restart_interval) {
     InitializeBase(raw_ucmp, data, restarts, num_restarts, global_seqno,
@@ -709,6 +729,8 @@ class DataBlockIter final : public BlockIter<Slice> {
     read_amp_bitmap_ = read_amp_bitmap;
     last_bitmap_offset_ = current_ + 1;
     data_block_hash_index_ = data_block_hash_index;
+    // Only written for keys without timestamps
+    restart_key_prefixes_ = ts_sz_ == 0 ? restart_key_prefixes : nullptr;
   }
 
   Slice value() const override {
@@ -831,7 +853,8 @@ class MetaBlockIter final : public BlockIter<Slice> {
 
 class IndexBlockIter final : public BlockIter<IndexValue> {
  public:
-  IndexBlockIter() : BlockIter(), prefix_index_(nullptr) {}
+  IndexBlockIter()
+      : BlockIter(), prefix_index_(nullptr), learned_index_(nullptr) {}
 
   // key_includes_seq, default true, means that the keys are in internal key
   // format.
@@ -844,13 +867,15 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
                   bool value_is_full, bool block_contents_pinned,
                   bool user_defined_timestamps_persisted,
                   uint8_t protection_bytes_per_key, const char* kv_checksum,
-                  uint32_t block_restart_interval) {
+                  uint32_t block_restart_interval,
+                  const LearnedIndexModel* learned_index = nullptr) {
     InitializeBase(raw_ucmp, data, restarts, num_restarts,
                    kDisableGlobalSequenceNumber, block_contents_pinned,
                    user_defined_timestamps_persisted, protection_bytes_per_key,
                    kv_checksum, block_restart_interval);
     raw_key_.SetIsUserKey(!key_includes_seq);
     prefix_index_ = prefix_index;
+    learned_index_ = learned_index;
     value_delta_encoded_ = !value_is_full;
     have_first_key_ = have_first_key;
     if (have_first_key_ && global_seqno != kDisableGlobalSequenceNumber) {
@@ -920,6 +945,7 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
   bool value_delta_encoded_;
   bool have_first_key_;  // value includes first_internal_key
   BlockPrefixIndex* prefix_index_;
+  const LearnedIndexModel* learned_index_;
   // Whether the value is delta encoded. In that case the value is assumed to be
   // BlockHandle. The first value in each restart interval is the full encoded
   // BlockHandle; the restart of encoded size part of the BlockHandle. The
@@ -958,6 +984,10 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
                             uint32_t left, uint32_t right, uint32_t* index,
                             bool* prefix_may_exist);
   inline int CompareBlockKey(uint32_t block_index, const Slice& target);
+  // Same as BinarySeek(), but only searches the restart points in the window
+  // predicted by learned_index_, after checking its bounds.
+  bool LearnedSeek(const Slice& target, uint32_t* index,
+                   bool* skip_linear_scan);
 
   inline bool ParseNextIndexKey();
 
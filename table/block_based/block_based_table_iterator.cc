@@ -29,7 +29,9 @@ void BlockBasedTableIterator::SeekImpl(const Slice* target,
   seek_stat_state_ = kNone;
   bool filter_checked = false;
   if (target &&
-      !CheckPrefixMayMatch(*target, IterDirection::kForward, &filter_checked)) {
+      (!CheckPrefixMayMatch(*target, IterDirection::kForward,
+                            &filter_checked) ||
+       !CheckRangeMayMatch(*target, &filter_checked))) {
     ResetDataIter();
     RecordTick(table_->GetStatistics(), is_last_level_
                                             ? LAST_LEVEL_SEEK_FILTERED
@@ -40,6 +40,7 @@
 #include "rocksdb/filter_policy.h"
 #include "rocksdb/iterator.h"
 #include "rocksdb/options.h"
+#include "rocksdb/rate_limiter.h"
 #include "rocksdb/snapshot.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/system_clock.h"
@@ -56,8 +57,10 @@
 #include "table/block_based/filter_policy_internal.h"
 #include "table/block_based/full_filter_block.h"
 #include "table/block_based/hash_index_reader.h"
+#include "table/block_based/learned_index_reader.h"
 #include "table/block_based/partitioned_filter_block.h"
 #include "table/block_based/partitioned_index_reader.h"
+#include "table/block_based/trie_index_reader.h"
 #include "table/block_fetcher.h"
 #include "table/format.h"
 #include "table/get_context.h"
@@ -124,6 +127,8 @@ namespace ROCKSDB_NAMESPACE {
 extern const uint64_t kBlockBasedTableMagicNumber;
 extern const std::string kHashIndexPrefixesBlock;
 extern const std::string kHashIndexPrefixesMetadataBlock;
+extern const std::string kLearnedIndexBlock;
+extern const std::string kTrieIndexBlock;
 
 BlockBasedTable::~BlockBasedTable() { delete rep_; }
 
@@ -938,6 +943,13 @@ Status BlockBasedTable::ReadPropertiesBlock(
     rep_->prefix_filtering &= IsFeatureSupported(
         *(rep_->table_properties),
         BlockBasedTablePropertyNames::kPrefixFiltering, rep_->ioptions.logger);
+    const Comparator* const ucmp = rep_->internal_comparator.user_comparator();
+    rep_->range_filtering =
+        rep_->whole_key_filtering &&
+        rep_->table_properties->filter_policy_name ==
+            SuccinctRangeFilterPolicy::kClassName() &&
+        ucmp->timestamp_size() == 0 &&
+        ucmp->GetRootComparator() == BytewiseComparator();
 
     rep_->index_key_includes_seq =
         rep_->table_properties->index_key_is_user_key == 0;
@@ -1865,6 +1877,27 @@ bool BlockBasedTable::PrefixRangeMayMatch(
   return may_match;
 }
 
+bool BlockBasedTable::RangeMayMatch(const Slice& internal_key,
+                                    const ReadOptions& read_options,
+                                    BlockCacheLookupContext* lookup_context,
+                                    bool* filter_checked) const {
+  FilterBlockReader* const filter = rep_->filter.get();
+  if (!rep_->range_filtering || filter == nullptr ||
+      read_options.iterate_upper_bound == nullptr) {
+    return true;
+  }
+  const Slice user_key = ExtractUserKey(internal_key);
+  const Slice& upper_bound = *read_options.iterate_upper_bound;
+  if (BytewiseComparator()->Compare(user_key, upper_bound) >= 0) {
+    // Empty range, left to the upper bound checks of the iterator
+    return true;
+  }
+  *filter_checked = true;
+  const bool no_io = read_options.read_tier == kBlockCacheTier;
+  return filter->RangeMayMatch(user_key, upper_bound, no_io, &internal_key,
+                               lookup_context, read_options);
+}
+
 bool BlockBasedTable::PrefixExtractorChanged(
     const SliceTransform* prefix_extractor) const {
   if (prefix_extractor == nullptr) {
@@ -1901,16 +1934,18 @@ InternalIterator* BlockBasedTable::NewIterator(
         this, read_options, rep_->internal_comparator, std::move(index_iter),
         !skip_filters && !read_options.total_order_seek &&
             prefix_extractor != nullptr,
-        need_upper_bound_check, prefix_extractor, caller,
-        compaction_readahead_size, allow_unprepared_value);
+        !skip_filters /* check_range_filter */, need_upper_bound_check,
+        prefix_extractor, caller, compaction_readahead_size,
+        allow_unprepared_value);
   } else {
     auto* mem = arena->AllocateAligned(sizeof(BlockBasedTableIterator));
     return new (mem) BlockBasedTableIterator(
         this, read_options, rep_->internal_comparator, std::move(index_iter),
         !skip_filters && !read_options.total_order_seek &&
             prefix_extractor != nullptr,
-        need_upper_bound_check, prefix_extractor, caller,
-        compaction_readahead_size, allow_unprepared_value);
+        !skip_filters /* check_range_filter */, need_upper_bound_check,
+        prefix_extractor, caller, compaction_readahead_size,
+        allow_unprepared_value);
   }
 }
 
@@ -2357,6 +2392,110 @@ Status BlockBasedTable::Prefetch(const ReadOptions& read_options,
   return Status::OK();
 }
 
+Status BlockBasedTable::WarmUpBlockCache(const ReadOptions& read_options,
+                                         const std::vector<uint64_t>& offsets,
+                                         bool index_and_filter,
+                                         RateLimiter* rate_limiter,
+                                         uint64_t* blocks, uint64_t* bytes) {
+  assert(std::is_sorted(offsets.begin(), offsets.end()));
+  assert(blocks != nullptr && bytes != nullptr);
+  if (!rep_->table_options.block_cache) {
+    return Status::OK();
+  }
+  if (index_and_filter) {
+    // Reads all the partitions of each with one I/O
+    Status s = rep_->index_reader->CacheDependencies(
+        read_options, /*pin=*/false, /*prefetch_buffer=*/nullptr);
+    if (s.ok() && rep_->filter) {
+      s = rep_->filter->CacheDependencies(read_options, /*pin=*/false,
+                                          /*prefetch_buffer=*/nullptr);
+    }
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  if (offsets.empty()) {
+    return Status::OK();
+  }
+
+  BlockCacheLookupContext lookup_context{TableReaderCaller::kPrefetch};
+  IndexBlockIter iiter_on_stack;
+  auto iiter = NewIndexIterator(read_options, /*need_upper_bound_check=*/false,
+                                &iiter_on_stack, /*get_context=*/nullptr,
+                                &lookup_context);
+  std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
+  if (iiter != &iiter_on_stack) {
+    iiter_unique_ptr.reset(iiter);
+  }
+
+  // Data blocks are in file order, so the index and the offsets are merged
+  std::vector<BlockHandle> handles;
+  auto next = offsets.begin();
+  for (iiter->SeekToFirst(); iiter->Valid() && next != offsets.end();
+       iiter->Next()) {
+    const BlockHandle& handle = iiter->value().handle;
+    next = std::lower_bound(next, offsets.end(), handle.offset());
+    if (next != offsets.end() && *next == handle.offset()) {
+      handles.push_back(handle);
+    }
+  }
+  Status s = iiter->status();
+  if (!s.ok() || handles.empty()) {
+    return s;
+  }
+
+  // Blocks less than a block apart are read together, up to
+  // max_auto_readahead_size at a time
+  const uint64_t max_gap = rep_->table_options.block_size;
+  const uint64_t max_read_size = std::max<uint64_t>(
+      rep_->table_options.max_auto_readahead_size, max_gap);
+  std::unique_ptr<FilePrefetchBuffer> prefetch_buffer;
+  rep_->CreateFilePrefetchBuffer(
+      0, 0, &prefetch_buffer, false /*Implicit auto readahead*/,
+      0 /*num_reads_*/, 0 /*num_file_reads_for_auto_readahead*/);
+  IOOptions opts;
+  s = rep_->file->PrepareIOOptions(read_options, opts);
+  size_t end = 0;
+  for (size_t begin = 0; s.ok() && begin < handles.size(); begin = end) {
+    const uint64_t read_offset = handles[begin].offset();
+    uint64_t read_end = read_offset + BlockSizeWithTrailer(handles[begin]);
+    for (end = begin + 1; end < handles.size(); ++end) {
+      const uint64_t block_end =
+          handles[end].offset() + BlockSizeWithTrailer(handles[end]);
+      if (handles[end].offset() > read_end + max_gap ||
+          block_end - read_offset > max_read_size) {
+        break;
+      }
+      read_end = block_end;
+    }
+    const size_t read_size = static_cast<size_t>(read_end - read_offset);
+    if (rate_limiter) {
+      for (size_t left = read_size; left > 0;) {
+        left -= rate_limiter->RequestToken(left, /*alignment=*/0, Env::IO_LOW,
+                                           rep_->ioptions.stats,
+                                           RateLimiter::OpType::kRead);
+      }
+    }
+    s = prefetch_buffer->Prefetch(opts, rep_->file.get(), read_offset,
+                                  read_size,
+                                  read_options.rate_limiter_priority);
+    for (size_t i = begin; s.ok() && i < end; ++i) {
+      DataBlockIter biter;
+      Status tmp_status;
+      NewDataBlockIterator<DataBlockIter>(
+          read_options, handles[i], &biter, /*type=*/BlockType::kData,
+          /*get_context=*/nullptr, &lookup_context, prefetch_buffer.get(),
+          /*for_compaction=*/false, /*async_read=*/false, tmp_status);
+      s = biter.status();
+    }
+    if (s.ok()) {
+      *blocks += end - begin;
+      *bytes += read_size;
+    }
+  }
+  return s;
+}
+
 Status BlockBasedTable::VerifyChecksum(const ReadOptions& read_options,
                                        TableReaderCaller caller) {
   Status s;
@@ -2463,6 +2602,14 @@ BlockType BlockBasedTable::GetBlockTypeForMetaBlockByName(
     return BlockType::kHashIndexMetadata;
   }
 
+  if (meta_block_name == kLearnedIndexBlock) {
+    return BlockType::kLearnedIndex;
+  }
+
+  if (meta_block_name == kTrieIndexBlock) {
+    return BlockType::kTrieIndex;
+  }
+
   if (meta_block_name.starts_with(kObsoleteFilterBlockPrefix)) {
     // Obsolete but possible in old files
     return BlockType::kInvalid;
@@ -2578,6 +2725,16 @@ Status BlockBasedTable::CreateIndexReader(
                                        index_reader);
       }
     }
+    case BlockBasedTableOptions::kLearnedIndexSearch: {
+      return LearnedIndexReader::Create(this, ro, prefetch_buffer, meta_iter,
+                                        use_cache, prefetch, pin,
+                                        lookup_context, index_reader);
+    }
+    case BlockBasedTableOptions::kTrieIndexSearch: {
+      return TrieIndexReader::Create(this, ro, prefetch_buffer, meta_iter,
+                                     use_cache, prefetch, pin, lookup_context,
+                                     index_reader);
+    }
     default: {
       std::string error_message =
           "Unrecognized index type: " + std::to_string(rep_->index_type);
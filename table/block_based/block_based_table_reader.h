@@ -121,6 +121,13 @@ class BlockBasedTable : public TableReader {
                            BlockCacheLookupContext* lookup_context,
                            bool* filter_checked) const;
 
+  // Returns false if the range filter of the table tells that no key falls
+  // in [user key of internal_key, read_options.iterate_upper_bound).
+  bool RangeMayMatch(const Slice& internal_key,
+                     const ReadOptions& read_options,
+                     BlockCacheLookupContext* lookup_context,
+                     bool* filter_checked) const;
+
   // Returns a new iterator over the table contents.
   // The result of NewIterator() is initially invalid (caller must
   // call one of the Seek methods on the iterator before using it).
@@ -159,6 +166,11 @@ class BlockBasedTable : public TableReader {
   Status Prefetch(const ReadOptions& read_options, const Slice* begin,
                   const Slice* end) override;
 
+  Status WarmUpBlockCache(const ReadOptions& read_options,
+                          const std::vector<uint64_t>& offsets,
+                          bool index_and_filter, RateLimiter* rate_limiter,
+                          uint64_t* blocks, uint64_t* bytes) override;
+
   // Given a key, return an approximate byte offset in the file where
   // the data for that key begins (or would begin if the key were
   // present in the file). The returned value is in terms of file
@@ -600,6 +612,8 @@ struct BlockBasedTable::Rep {
   BlockBasedTableOptions::IndexType index_type;
   bool whole_key_filtering;
   bool prefix_filtering;
+  // Whether the filter is a range filter over all the keys, in bytewise order
+  bool range_filtering = false;
   std::shared_ptr<const SliceTransform> table_prefix_extractor;
 
   std::shared_ptr<FragmentedRangeTombstoneList> fragmented_range_dels;
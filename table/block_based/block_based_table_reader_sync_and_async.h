@@ -454,25 +454,25 @@ DEFINE_SYNC_AND_ASYNC(void, BlockBasedTable::MultiGet)
             // initialize block to the contents of the data block.
 
             // An async version of MaybeReadBlockAndLoadToCache /
-            // GetDataBlockFromCache
+            // GetDataBlockFromCache, started in one batch below
             BCI::TypedAsyncLookupHandle& async_handle =
                 async_handles[cache_lookup_count];
             cache_keys[cache_lookup_count] =
                 GetCacheKey(rep_->base_cache_key, v.handle);
             async_handle.key = cache_keys[cache_lookup_count].AsSlice();
-            // NB: StartAsyncLookupFull populates async_handle.helper
+            // NB: MultiLookupFull populates async_handle.helper
             async_handle.create_context = &rep_->create_context;
             async_handle.priority = GetCachePriority<Block_kData>();
             async_handle.stats = rep_->ioptions.statistics.get();
-
-            block_cache.StartAsyncLookupFull(
-                async_handle, rep_->ioptions.lowest_used_cache_tier);
             ++cache_lookup_count;
             // TODO: stats?
           }
         }
 
         if (block_cache) {
+          // One batch so that the cache can group the lookups by shard
+          block_cache.MultiLookupFull(&async_handles[0], cache_lookup_count,
+                                      rep_->ioptions.lowest_used_cache_tier);
           block_cache.get()->WaitAll(&async_handles[0], cache_lookup_count);
         }
         size_t lookup_idx = 0;
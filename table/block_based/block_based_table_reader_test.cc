@@ -713,7 +713,9 @@ INSTANTIATE_TEST_CASE_P(
             BlockBasedTableOptions::IndexType::kBinarySearch,
             BlockBasedTableOptions::IndexType::kHashSearch,
             BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch,
-            BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey),
+            BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey,
+            BlockBasedTableOptions::IndexType::kLearnedIndexSearch,
+            BlockBasedTableOptions::IndexType::kTrieIndexSearch),
         ::testing::Values(false), ::testing::ValuesIn(test::GetUDTTestModes()),
         ::testing::Values(1, 2), ::testing::Values(0, 4096)));
 INSTANTIATE_TEST_CASE_P(
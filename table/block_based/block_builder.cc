@@ -30,6 +30,11 @@
 //     restarts: uint32[num_restarts]
 //     num_restarts: uint32
 // restarts[i] contains the offset within the block of the ith restart point.
+//
+// Data blocks built with restart_key_prefixes also store, right after the
+// restart array, restart_key_prefixes: fixed64[num_restarts], where
+// restart_key_prefixes[i] is RestartKeyPrefix() of the user key at the ith
+// restart point. kRestartKeyPrefixesFlag is then set in num_restarts.
 
 #include "table/block_based/block_builder.h"
 
@@ -49,13 +54,15 @@ BlockBuilder::BlockBuilder(
     bool use_value_delta_encoding,
     BlockBasedTableOptions::DataBlockIndexType index_type,
     double data_block_hash_table_util_ratio, size_t ts_sz,
-    bool persist_user_defined_timestamps, bool is_user_key)
+    bool persist_user_defined_timestamps, bool is_user_key,
+    bool restart_key_prefixes)
     : block_restart_interval_(block_restart_interval),
       use_delta_encoding_(use_delta_encoding),
       use_value_delta_encoding_(use_value_delta_encoding),
       ts_sz_(ts_sz),
       persist_user_defined_timestamps_(persist_user_defined_timestamps),
       is_user_key_(is_user_key),
+      use_restart_key_prefixes_(restart_key_prefixes),
       restarts_(1, 0),  // First restart point is at offset 0
       counter_(0),
       finished_(false) {
@@ -70,6 +77,8 @@ BlockBuilder::BlockBuilder(
       assert(0);
   }
   assert(block_restart_interval_ >= 1);
+  // Restart key prefixes are only for data blocks of bytewise ordered keys
+  assert(!use_restart_key_prefixes_ || (!is_user_key_ && ts_sz_ == 0));
   estimate_ = sizeof(uint32_t) + sizeof(uint32_t);
 }
 
@@ -81,6 +90,7 @@ void BlockBuilder::Reset() {
   counter_ = 0;
   finished_ = false;
   last_key_.clear();
+  restart_key_prefixes_.clear();
   if (data_block_hash_index_builder_.Valid()) {
     data_block_hash_index_builder_.Reset();
   }
@@ -112,6 +122,9 @@ size_t BlockBuilder::EstimateSizeAfterKV(const Slice& key,
 
   if (counter_ >= block_restart_interval_) {
     estimate += sizeof(uint32_t);  // a new restart entry.
+    if (use_restart_key_prefixes_) {
+      estimate += sizeof(uint64_t);
+    }
   }
 
   estimate += sizeof(int32_t);  // varint for shared prefix length.
@@ -130,6 +143,15 @@ Slice BlockBuilder::Finish() {
   for (size_t i = 0; i < restarts_.size(); i++) {
     PutFixed32(&buffer_, restarts_[i]);
   }
+  // None for an empty block
+  const bool has_restart_key_prefixes =
+      use_restart_key_prefixes_ &&
+      restart_key_prefixes_.size() == restarts_.size();
+  if (has_restart_key_prefixes) {
+    for (uint64_t prefix : restart_key_prefixes_) {
+      PutFixed64(&buffer_, prefix);
+    }
+  }
 
   uint32_t num_restarts = static_cast<uint32_t>(restarts_.size());
   BlockBasedTableOptions::DataBlockIndexType index_type =
@@ -141,7 +163,8 @@ Slice BlockBuilder::Finish() {
   }
 
   // footer is a packed format of data_block_index_type and num_restarts
-  uint32_t block_footer = PackIndexTypeAndNumRestarts(index_type, num_restarts);
+  uint32_t block_footer = PackIndexTypeAndNumRestarts(
+      index_type, num_restarts, has_restart_key_prefixes);
 
   PutFixed32(&buffer_, block_footer);
   finished_ = true;
@@ -214,6 +237,11 @@ inline void BlockBuilder::AddWithLastKeyImpl(const Slice& key,
     shared = key_to_persist.difference_offset(last_key_persisted);
   }
 
+  if (counter_ == 0 && use_restart_key_prefixes_) {
+    restart_key_prefixes_.push_back(RestartKeyPrefix(ExtractUserKey(key)));
+    estimate_ += sizeof(uint64_t);
+  }
+
   const size_t non_shared = key_to_persist.size() - shared;
 
   if (use_value_delta_encoding_) {
@@ -73,6 +73,8 @@ const std::array<const Cache::CacheItemHelper*,
         nullptr,  // kHashIndexMetadata
         nullptr,  // kMetaIndex (not yet stored in block cache)
         BlockCacheInterface<Block_kIndex>::GetFullHelper(),
+        nullptr,  // kLearnedIndex
+        nullptr,  // kTrieIndex
         nullptr,  // kInvalid
     }};
 
@@ -90,6 +92,8 @@ const std::array<const Cache::CacheItemHelper*,
         nullptr,  // kHashIndexMetadata
         nullptr,  // kMetaIndex (not yet stored in block cache)
         BlockCacheInterface<Block_kIndex>::GetBasicHelper(),
+        nullptr,  // kLearnedIndex
+        nullptr,  // kTrieIndex
         nullptr,  // kInvalid
     }};
 }  // namespace
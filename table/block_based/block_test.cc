@@ -287,6 +287,79 @@ TEST_P(BlockTest, IndexHashWithSharedPrefix) {
                      shouldPersistUDT());
 }
 
+TEST_P(BlockTest, RestartKeyPrefixes) {
+  if (isUDTEnabled()) {
+    // Restart key prefixes are only written without timestamps
+    return;
+  }
+  Random rnd(301);
+  // User keys shorter and longer than the 8 byte prefixes, many of them
+  // sharing a prefix
+  std::set<std::string> user_keys;
+  while (user_keys.size() < 3000) {
+    std::string key = "u" + rnd.RandomBinaryString(
+                                static_cast<int>(rnd.Uniform(3)));
+    if (!rnd.OneIn(4)) {
+      key += std::string(static_cast<size_t>(rnd.Uniform(8)), 'x');
+      key += rnd.RandomBinaryString(static_cast<int>(rnd.Uniform(4)));
+    }
+    user_keys.insert(key);
+  }
+  std::vector<std::string> keys;
+  for (const auto &user_key : user_keys) {
+    keys.push_back(InternalKey(user_key, 100, kTypeValue).Encode().ToString());
+  }
+
+  for (int restart_interval : {1, 16}) {
+    std::vector<std::unique_ptr<Block>> blocks;
+    for (bool restart_key_prefixes : {false, true}) {
+      BlockBuilder builder(restart_interval, keyUseDeltaEncoding(),
+                           false /* use_value_delta_encoding */,
+                           dataBlockIndexType(),
+                           0.75 /* data_block_hash_table_util_ratio */,
+                           0 /* ts_sz */, true /* persist_udt */,
+                           false /* is_user_key */, restart_key_prefixes);
+      for (size_t i = 0; i < keys.size(); ++i) {
+        builder.Add(keys[i], std::to_string(i));
+      }
+      BlockContents contents;
+      contents.data = builder.Finish();
+      contents.allocation.reset(new char[contents.data.size()]);
+      memcpy(contents.allocation.get(), contents.data.data(),
+             contents.data.size());
+      contents.data = Slice(contents.allocation.get(), contents.data.size());
+      blocks.emplace_back(new Block(std::move(contents)));
+      ASSERT_EQ(restart_key_prefixes, blocks.back()->HasRestartKeyPrefixes());
+      ASSERT_EQ(blocks[0]->NumRestarts(), blocks.back()->NumRestarts());
+    }
+    std::unique_ptr<DataBlockIter> plain_iter(blocks[0]->NewDataIterator(
+        BytewiseComparator(), kDisableGlobalSequenceNumber));
+    std::unique_ptr<DataBlockIter> iter(blocks[1]->NewDataIterator(
+        BytewiseComparator(), kDisableGlobalSequenceNumber));
+
+    std::vector<std::string> targets = {"", "u", "v", "\xff\xff"};
+    for (const auto &user_key : user_keys) {
+      targets.push_back(user_key);
+      targets.push_back(user_key + '\0');
+      targets.push_back(user_key.substr(0, user_key.size() - 1));
+    }
+    for (const auto &target : targets) {
+      for (SequenceNumber seq : {SequenceNumber{200}, SequenceNumber{50}}) {
+        std::string seek_key =
+            InternalKey(target, seq, kValueTypeForSeek).Encode().ToString();
+        plain_iter->Seek(seek_key);
+        iter->Seek(seek_key);
+        ASSERT_OK(iter->status());
+        ASSERT_EQ(plain_iter->Valid(), iter->Valid());
+        if (iter->Valid()) {
+          ASSERT_EQ(plain_iter->key(), iter->key());
+          ASSERT_EQ(plain_iter->value(), iter->value());
+        }
+      }
+    }
+  }
+}
+
 // Param 0: key use delta encoding
 // Param 1: user-defined timestamp test mode
 // Param 2: data block index type. User-defined timestamp feature is not
@@ -9,17 +9,38 @@
 
 #pragma once
 
+#include <string.h>
+
+#include <algorithm>
+
+#include "rocksdb/slice.h"
 #include "rocksdb/table.h"
+#include "util/coding.h"
+#include "util/math.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+// Bit 30 of the block footer flags an array of restart key prefixes following
+// the restart array. It was always clear before, in blocks of any size, as no
+// block has room for 2^30 restart points.
+constexpr uint32_t kRestartKeyPrefixesFlag = uint32_t{1} << 30;
+
 uint32_t PackIndexTypeAndNumRestarts(
     BlockBasedTableOptions::DataBlockIndexType index_type,
-    uint32_t num_restarts);
+    uint32_t num_restarts, bool has_restart_key_prefixes = false);
 
 void UnPackIndexTypeAndNumRestarts(
     uint32_t block_footer,
     BlockBasedTableOptions::DataBlockIndexType* index_type,
     uint32_t* num_restarts);
 
+// The restart key prefix of a user key: its first 8 bytes, zero padded, read
+// as a big-endian integer. Prefixes of bytewise ordered keys are in the same
+// order, and a key whose prefix is smaller than another's is smaller.
+inline uint64_t RestartKeyPrefix(const Slice& user_key) {
+  char buf[sizeof(uint64_t)] = {};
+  memcpy(buf, user_key.data(), std::min(user_key.size(), sizeof(buf)));
+  return EndianSwapValue(DecodeFixed64(buf));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
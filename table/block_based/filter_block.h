@@ -155,6 +155,20 @@ class FilterBlockReader {
     }
   }
 
+  /**
+   * Returns false if no key of the table can fall in [lower_user_key,
+   * upper_user_key), which only range filters can tell. const_ikey_ptr is
+   * the internal key of lower_user_key, used to find filter partitions.
+   */
+  virtual bool RangeMayMatch(const Slice& /*lower_user_key*/,
+                             const Slice& /*upper_user_key*/,
+                             const bool /*no_io*/,
+                             const Slice* const /*const_ikey_ptr*/,
+                             BlockCacheLookupContext* /*lookup_context*/,
+                             const ReadOptions& /*read_options*/) {
+    return true;
+  }
+
   virtual size_t ApproximateMemoryUsage() const = 0;
 
   // convert this object to a human readable form
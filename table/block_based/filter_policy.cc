@@ -27,6 +27,7 @@
 #include "table/block_based/block_based_table_reader.h"
 #include "table/block_based/filter_policy_internal.h"
 #include "table/block_based/full_filter_block.h"
+#include "table/block_based/succinct_trie.h"
 #include "util/bloom_impl.h"
 #include "util/coding.h"
 #include "util/hash.h"
@@ -1259,6 +1260,129 @@ class LegacyBloomBitsReader : public BuiltinFilterBitsReader {
   const uint32_t log2_cache_line_size_;
 };
 
+// ##################### Succinct range filter ################### //
+
+// Succinct range filter data:
+//             0 +-----------------------------------+
+//               | SuccinctTrie of the keys,         |
+//               |   truncated to their              |
+//               |   distinguishing prefixes         |
+//           len +-----------------------------------+
+//               | byte value -3                     |
+//               |   (marker for range filter)       |
+//         len+1 +-----------------------------------+
+//               | four bytes reserved, zero         |
+// len_with_meta +-----------------------------------+
+class SuccinctRangeBitsBuilder : public BuiltinFilterBitsBuilder {
+ public:
+  SuccinctRangeBitsBuilder() : trie_builder_(true /* truncate */) {}
+
+  // No Copy allowed
+  SuccinctRangeBitsBuilder(const SuccinctRangeBitsBuilder&) = delete;
+  void operator=(const SuccinctRangeBitsBuilder&) = delete;
+
+  void AddKey(const Slice& key) override {
+    if (unordered_) {
+      return;
+    }
+    if (trie_builder_.NumKeys() > 0) {
+      int cmp = key.compare(last_key_);
+      if (cmp == 0 || (cmp < 0 && Slice(last_key_).starts_with(key))) {
+        // Duplicate, or a prefix added after its key, which prefix queries
+        // of the last key already match
+        return;
+      }
+      if (cmp < 0) {
+        // Not from a bytewise ordered table. Keep the filter correct for
+        // point queries at least.
+        unordered_ = true;
+        return;
+      }
+    }
+    trie_builder_.Add(key);
+    last_key_.assign(key.data(), key.size());
+  }
+
+  size_t EstimateEntriesAdded() override { return trie_builder_.NumKeys(); }
+
+  using FilterBitsBuilder::Finish;
+
+  Slice Finish(std::unique_ptr<const char[]>* buf) override {
+    if (unordered_) {
+      Reset();
+      return FinishAlwaysTrue(buf);
+    }
+    if (trie_builder_.NumKeys() == 0) {
+      return FinishAlwaysFalse(buf);
+    }
+    std::string data;
+    trie_builder_.Finish(&data);
+    data.push_back(static_cast<char>(-3));  // Marker for range filter
+    data.append(4, '\0');                   // Reserved
+    char* mutable_buf = new char[data.size()];
+    memcpy(mutable_buf, data.data(), data.size());
+    buf->reset(mutable_buf);
+    Reset();
+    return Slice(mutable_buf, data.size());
+  }
+
+  // The trie size depends on the keys. These assume keys telling themselves
+  // apart from their neighbors within a few bytes.
+  size_t CalculateSpace(size_t num_entries) override {
+    return num_entries * kEstimatedBytesPerKey + kMetadataLen;
+  }
+
+  size_t ApproximateNumEntries(size_t bytes) override {
+    return bytes > kMetadataLen
+               ? (bytes - kMetadataLen) / kEstimatedBytesPerKey
+               : 0;
+  }
+
+  // Not a function of the size, as the false positive rate depends on how
+  // close the keys queried are to the keys added.
+  double EstimatedFpRate(size_t /*num_entries*/, size_t /*bytes*/) override {
+    return 1.0;
+  }
+
+ private:
+  static constexpr size_t kEstimatedBytesPerKey = 3;
+
+  // Ready for the next filter partition
+  void Reset() {
+    trie_builder_ = SuccinctTrie::Builder(true /* truncate */);
+    last_key_.clear();
+    unordered_ = false;
+  }
+
+  SuccinctTrie::Builder trie_builder_;
+  std::string last_key_;
+  bool unordered_ = false;
+};
+
+class SuccinctRangeBitsReader : public BuiltinFilterBitsReader {
+ public:
+  explicit SuccinctRangeBitsReader(std::unique_ptr<SuccinctTrie>&& trie)
+      : trie_(std::move(trie)) {}
+
+  // No Copy allowed
+  SuccinctRangeBitsReader(const SuccinctRangeBitsReader&) = delete;
+  void operator=(const SuccinctRangeBitsReader&) = delete;
+
+  // Matches keys with any added key as prefix too, as the added keys are
+  // only kept up to their distinguishing prefixes.
+  bool MayMatch(const Slice& key) override {
+    return trie_->MayContainKeyWithPrefix(key);
+  }
+  using FilterBitsReader::MayMatch;  // inherit overload
+
+  bool RangeMayMatch(const Slice& lower, const Slice& upper) override {
+    return trie_->MayContainKeyInRange(lower, upper);
+  }
+
+ private:
+  std::unique_ptr<SuccinctTrie> trie_;
+};
+
 class AlwaysTrueFilter : public BuiltinFilterBitsReader {
  public:
   bool MayMatch(const Slice&) override { return true; }
@@ -1589,6 +1713,9 @@ BuiltinFilterBitsReader* BuiltinFilterPolicy::GetBuiltinFilterBitsReader(
       case -2:
         // Marker for Ribbon implementations
         return GetRibbonBitsReader(contents);
+      case -3:
+        // Marker for succinct range filter
+        return GetSuccinctRangeBitsReader(contents);
       default:
         // Reserved (treat as zero probes, always FP, for now)
         return new AlwaysTrueFilter();
@@ -1660,6 +1787,22 @@ BuiltinFilterBitsReader* BuiltinFilterPolicy::GetRibbonBitsReader(
                                          seed);
 }
 
+BuiltinFilterBitsReader* BuiltinFilterPolicy::GetSuccinctRangeBitsReader(
+    const Slice& contents) {
+  uint32_t len_with_meta = static_cast<uint32_t>(contents.size());
+  uint32_t len = len_with_meta - kMetadataLen;
+
+  assert(len > 0);  // precondition
+
+  std::unique_ptr<SuccinctTrie> trie;
+  if (DecodeFixed32(contents.data() + len + 1) != 0 ||
+      !SuccinctTrie::Create(Slice(contents.data(), len), &trie).ok()) {
+    // Reserved, or corrupt. Return something safe:
+    return new AlwaysTrueFilter();
+  }
+  return new SuccinctRangeBitsReader(std::move(trie));
+}
+
 // For newer Bloom filter implementations
 BuiltinFilterBitsReader* BuiltinFilterPolicy::GetBloomBitsReader(
     const Slice& contents) {
@@ -1783,6 +1926,22 @@ const FilterPolicy* NewRibbonFilterPolicy(double bloom_equivalent_bits_per_key,
                                 bloom_before_level);
 }
 
+FilterBitsBuilder* SuccinctRangeFilterPolicy::GetBuilderWithContext(
+    const FilterBuildingContext& /*context*/) const {
+  return new SuccinctRangeBitsBuilder();
+}
+
+const char* SuccinctRangeFilterPolicy::kClassName() {
+  return "succinctrangefilter";
+}
+const char* SuccinctRangeFilterPolicy::kNickName() {
+  return "rocksdb.SuccinctRangeFilter";
+}
+
+const FilterPolicy* NewSuccinctRangeFilterPolicy() {
+  return new SuccinctRangeFilterPolicy();
+}
+
 FilterBuildingContext::FilterBuildingContext(
     const BlockBasedTableOptions& _table_options)
     : table_options(_table_options) {}
@@ -1885,6 +2044,14 @@ static int RegisterBuiltinFilterPolicies(ObjectLibrary& library,
         guard->reset(NewRibbonFilterPolicy(bits_per_key, bloom_before_level));
         return guard->get();
       });
+  library.AddFactory<const FilterPolicy>(
+      ObjectLibrary::PatternEntry(SuccinctRangeFilterPolicy::kClassName())
+          .AnotherName(SuccinctRangeFilterPolicy::kNickName()),
+      [](const std::string& /*uri*/, std::unique_ptr<const FilterPolicy>* guard,
+         std::string* /* errmsg */) {
+        guard->reset(NewSuccinctRangeFilterPolicy());
+        return guard->get();
+      });
   library.AddFactory<const FilterPolicy>(
       FilterPatternEntryWithBits(test::LegacyBloomFilterPolicy::kClassName()),
       [](const std::string& uri, std::unique_ptr<const FilterPolicy>* guard,
@@ -95,6 +95,13 @@ class FilterBitsReader {
       may_match[i] = MayMatch(*keys[i]);
     }
   }
+
+  // Check if any entry in [lower, upper) may have been added to the filter.
+  // Only range filters can tell; others always return true.
+  virtual bool RangeMayMatch(const Slice& /* lower */,
+                             const Slice& /* upper */) {
+    return true;
+  }
 };
 
 // Exposes any extra information needed for testing built-in
@@ -157,6 +164,10 @@ class BuiltinFilterPolicy : public FilterPolicy {
 
   // For Ribbon filter implementation(s)
   static BuiltinFilterBitsReader* GetRibbonBitsReader(const Slice& contents);
+
+  // For SuccinctRangeFilterPolicy
+  static BuiltinFilterBitsReader* GetSuccinctRangeBitsReader(
+      const Slice& contents);
 };
 
 // A "read only" filter policy used for backward compatibility with old
@@ -296,6 +307,21 @@ class RibbonFilterPolicy : public BloomLikeFilterPolicy {
   const int bloom_before_level_;
 };
 
+// For NewSuccinctRangeFilterPolicy
+//
+// Stores the keys, truncated to their distinguishing prefixes, in a
+// SuccinctTrie, which also answers range queries.
+class SuccinctRangeFilterPolicy : public BuiltinFilterPolicy {
+ public:
+  FilterBitsBuilder* GetBuilderWithContext(
+      const FilterBuildingContext&) const override;
+
+  static const char* kClassName();
+  const char* Name() const override { return kClassName(); }
+  static const char* kNickName();
+  const char* NickName() const override { return kNickName(); }
+};
+
 // For testing only, but always constructable with internal names
 namespace test {
 
@@ -198,6 +198,36 @@ bool FullFilterBlockReader::MayMatch(const Slice& entry, bool no_io,
   return true;
 }
 
+bool FullFilterBlockReader::RangeMayMatch(
+    const Slice& lower_user_key, const Slice& upper_user_key, const bool no_io,
+    const Slice* const /*const_ikey_ptr*/,
+    BlockCacheLookupContext* lookup_context, const ReadOptions& read_options) {
+  if (!whole_key_filtering()) {
+    // Only prefixes were added
+    return true;
+  }
+
+  CachableEntry<ParsedFullFilterBlock> filter_block;
+
+  const Status s = GetOrReadFilterBlock(no_io, nullptr /* get_context */,
+                                        lookup_context, &filter_block,
+                                        read_options);
+  if (!s.ok()) {
+    IGNORE_STATUS_IF_ERROR(s);
+    return true;
+  }
+
+  assert(filter_block.GetValue());
+
+  FilterBitsReader* const filter_bits_reader =
+      filter_block.GetValue()->filter_bits_reader();
+
+  if (filter_bits_reader) {
+    return filter_bits_reader->RangeMayMatch(lower_user_key, upper_user_key);
+  }
+  return true;
+}
+
 void FullFilterBlockReader::KeysMayMatch(
     MultiGetRange* range, const bool no_io,
     BlockCacheLookupContext* lookup_context, const ReadOptions& read_options) {
@@ -132,6 +132,12 @@ class FullFilterBlockReader
                         const bool no_io,
                         BlockCacheLookupContext* lookup_context,
                         const ReadOptions& read_options) override;
+
+  bool RangeMayMatch(const Slice& lower_user_key, const Slice& upper_user_key,
+                     const bool no_io, const Slice* const const_ikey_ptr,
+                     BlockCacheLookupContext* lookup_context,
+                     const ReadOptions& read_options) override;
+
   size_t ApproximateMemoryUsage() const override;
 
  private:
@@ -314,6 +314,55 @@ TEST_F(FullFilterBlockTest, SingleChunk) {
                                   /*lookup_context=*/nullptr, ReadOptions()));
 }
 
+class SuccinctRangeFilterBlockTest : public mock::MockBlockBasedTableTester,
+                                     public testing::Test {
+ public:
+  SuccinctRangeFilterBlockTest()
+      : mock::MockBlockBasedTableTester(NewSuccinctRangeFilterPolicy()) {}
+};
+
+TEST_F(SuccinctRangeFilterBlockTest, PointAndRangeQueries) {
+  FullFilterBlockBuilder builder(nullptr, true, GetBuilder());
+  builder.Add("apple");
+  builder.Add("banana");
+  builder.Add("cherry");
+  builder.Add("cherry");
+  builder.Add("date");
+  ASSERT_EQ(4, builder.EstimateEntriesAdded());
+  Status s;
+  Slice slice = builder.Finish(BlockHandle(), &s);
+  ASSERT_OK(s);
+
+  CachableEntry<ParsedFullFilterBlock> block(
+      new ParsedFullFilterBlock(table_options_.filter_policy.get(),
+                                BlockContents(slice)),
+      nullptr /* cache */, nullptr /* cache_handle */, true /* own_value */);
+
+  FullFilterBlockReader reader(table_.get(), std::move(block));
+  for (const char* key : {"apple", "banana", "cherry", "date"}) {
+    ASSERT_TRUE(reader.KeyMayMatch(key,
+                                   /*no_io=*/false, /*const_ikey_ptr=*/nullptr,
+                                   /*get_context=*/nullptr,
+                                   /*lookup_context=*/nullptr, ReadOptions()));
+  }
+  ASSERT_TRUE(!reader.KeyMayMatch("zebra",
+                                  /*no_io=*/false, /*const_ikey_ptr=*/nullptr,
+                                  /*get_context=*/nullptr,
+                                  /*lookup_context=*/nullptr, ReadOptions()));
+
+  auto range_may_match = [&](const Slice& lower, const Slice& upper) {
+    return reader.RangeMayMatch(lower, upper, /*no_io=*/false,
+                                /*const_ikey_ptr=*/nullptr,
+                                /*lookup_context=*/nullptr, ReadOptions());
+  };
+  ASSERT_TRUE(range_may_match("apple", "apples"));
+  ASSERT_TRUE(range_may_match("bb", "cc"));
+  ASSERT_TRUE(range_may_match("0", "b"));
+  ASSERT_TRUE(!range_may_match("0", "9"));
+  ASSERT_TRUE(!range_may_match("e", "x"));
+
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
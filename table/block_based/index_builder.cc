@@ -52,6 +52,21 @@ IndexBuilder* IndexBuilder::CreateIndexBuilder(
           persist_user_defined_timestamps);
       break;
     }
+    case BlockBasedTableOptions::kLearnedIndexSearch: {
+      // The model predicts restart points, so index_block_restart_interval is
+      // always 1.
+      result = new LearnedIndexBuilder(
+          comparator, table_opt.format_version, use_value_delta_encoding,
+          table_opt.index_shortening, ts_sz, persist_user_defined_timestamps);
+      break;
+    }
+    case BlockBasedTableOptions::kTrieIndexSearch: {
+      result = new TrieIndexBuilder(
+          comparator, table_opt.index_block_restart_interval,
+          table_opt.format_version, use_value_delta_encoding,
+          table_opt.index_shortening, ts_sz, persist_user_defined_timestamps);
+      break;
+    }
     case BlockBasedTableOptions::kTwoLevelIndexSearch: {
       result = PartitionedIndexBuilder::CreateIndexBuilder(
           comparator, use_value_delta_encoding, table_opt, ts_sz,
@@ -20,6 +20,8 @@
 #include "rocksdb/comparator.h"
 #include "table/block_based/block_based_table_factory.h"
 #include "table/block_based/block_builder.h"
+#include "table/block_based/learned_index.h"
+#include "table/block_based/succinct_trie.h"
 #include "table/format.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -407,6 +409,164 @@ class HashIndexBuilder : public IndexBuilder {
   uint64_t current_restart_index_ = 0;
 };
 
+// LearnedIndexBuilder builds a binary-searchable primary index, with a restart
+// point per entry, and a metablock holding the LearnedIndexModel of its
+// separators. The model is only built for tables ordered bytewise, without
+// user-defined timestamps; readers of other tables just binary search the
+// primary index.
+class LearnedIndexBuilder : public IndexBuilder {
+ public:
+  explicit LearnedIndexBuilder(
+      const InternalKeyComparator* comparator, int format_version,
+      bool use_value_delta_encoding,
+      BlockBasedTableOptions::IndexShorteningMode shortening_mode, size_t ts_sz,
+      const bool persist_user_defined_timestamps)
+      : IndexBuilder(comparator, ts_sz, persist_user_defined_timestamps),
+        primary_index_builder_(comparator, /* index_block_restart_interval */ 1,
+                               format_version, use_value_delta_encoding,
+                               shortening_mode, /* include_first_key */ false,
+                               ts_sz, persist_user_defined_timestamps),
+        build_model_(ts_sz == 0 &&
+                     comparator->user_comparator()->GetRootComparator() ==
+                         BytewiseComparator()) {}
+
+  virtual void AddIndexEntry(std::string* last_key_in_current_block,
+                             const Slice* first_key_in_next_block,
+                             const BlockHandle& block_handle) override {
+    primary_index_builder_.AddIndexEntry(last_key_in_current_block,
+                                         first_key_in_next_block, block_handle);
+    if (build_model_) {
+      // *last_key_in_current_block is now the separator
+      model_builder_.Add(ExtractUserKey(*last_key_in_current_block));
+    }
+  }
+
+  virtual Status Finish(
+      IndexBlocks* index_blocks,
+      const BlockHandle& last_partition_block_handle) override {
+    Status s = primary_index_builder_.Finish(index_blocks,
+                                             last_partition_block_handle);
+    if (build_model_ && model_builder_.Finish(&model_block_)) {
+      index_blocks->meta_blocks.insert(
+          {kLearnedIndexBlock.c_str(), model_block_});
+    }
+    return s;
+  }
+
+  virtual size_t IndexSize() const override {
+    return primary_index_builder_.IndexSize() + model_block_.size();
+  }
+
+  virtual bool seperator_is_key_plus_seq() override {
+    return primary_index_builder_.seperator_is_key_plus_seq();
+  }
+
+ private:
+  ShortenedIndexBuilder primary_index_builder_;
+  const bool build_model_;
+  LearnedIndexModel::Builder model_builder_;
+  std::string model_block_;
+};
+
+// TrieIndexBuilder stores the separators in a SuccinctTrie, in a metablock
+// followed by the handles of their data blocks, ordered by trie key id:
+//
+// +--------------------------------------+
+// | trie size (varint32)                 |
+// | trie (SuccinctTrie::Builder)         |
+// | block offsets (PackedIntArray)       |
+// | block sizes (PackedIntArray)         |
+// +--------------------------------------+
+//
+// The index block itself is then left empty. The trie is only built for
+// tables ordered bytewise, without user-defined timestamps, and whose
+// separators are user keys; for other tables the metablock is omitted and
+// the index block is a regular binary search index.
+class TrieIndexBuilder : public IndexBuilder {
+ public:
+  explicit TrieIndexBuilder(
+      const InternalKeyComparator* comparator,
+      int index_block_restart_interval, int format_version,
+      bool use_value_delta_encoding,
+      BlockBasedTableOptions::IndexShorteningMode shortening_mode, size_t ts_sz,
+      const bool persist_user_defined_timestamps)
+      : IndexBuilder(comparator, ts_sz, persist_user_defined_timestamps),
+        primary_index_builder_(comparator, index_block_restart_interval,
+                               format_version, use_value_delta_encoding,
+                               shortening_mode, /* include_first_key */ false,
+                               ts_sz, persist_user_defined_timestamps),
+        empty_index_block_builder_(1 /* restart interval */),
+        build_trie_(ts_sz == 0 &&
+                    comparator->user_comparator()->GetRootComparator() ==
+                        BytewiseComparator()) {}
+
+  virtual void AddIndexEntry(std::string* last_key_in_current_block,
+                             const Slice* first_key_in_next_block,
+                             const BlockHandle& block_handle) override {
+    primary_index_builder_.AddIndexEntry(last_key_in_current_block,
+                                         first_key_in_next_block, block_handle);
+    if (!build_trie_) {
+      return;
+    }
+    if (primary_index_builder_.seperator_is_key_plus_seq()) {
+      // Separators may now repeat a user key, which the trie can't hold
+      build_trie_ = false;
+      trie_builder_ = SuccinctTrie::Builder();
+      std::vector<BlockHandle>().swap(handles_);
+      return;
+    }
+    // *last_key_in_current_block is now the separator
+    trie_builder_.Add(ExtractUserKey(*last_key_in_current_block));
+    handles_.push_back(block_handle);
+  }
+
+  virtual Status Finish(
+      IndexBlocks* index_blocks,
+      const BlockHandle& last_partition_block_handle) override {
+    Status s = primary_index_builder_.Finish(index_blocks,
+                                             last_partition_block_handle);
+    if (!s.ok() || !build_trie_) {
+      return s;
+    }
+    std::string trie;
+    std::vector<uint32_t> ids;
+    trie_builder_.Finish(&trie, &ids);
+    PutLengthPrefixedSlice(&trie_block_, trie);
+    std::vector<uint64_t> offsets(handles_.size());
+    std::vector<uint64_t> sizes(handles_.size());
+    for (size_t i = 0; i < handles_.size(); ++i) {
+      offsets[ids[i]] = handles_[i].offset();
+      sizes[ids[i]] = handles_[i].size();
+    }
+    PackedIntArray::EncodeTo(offsets, &trie_block_);
+    PackedIntArray::EncodeTo(sizes, &trie_block_);
+    index_blocks->index_block_contents = empty_index_block_builder_.Finish();
+    index_blocks->meta_blocks.insert({kTrieIndexBlock.c_str(), trie_block_});
+    return s;
+  }
+
+  virtual size_t IndexSize() const override {
+    return build_trie_ ? trie_block_.size() + kEmptyIndexBlockSize
+                       : primary_index_builder_.IndexSize();
+  }
+
+  virtual bool seperator_is_key_plus_seq() override {
+    return primary_index_builder_.seperator_is_key_plus_seq();
+  }
+
+ private:
+  // A single restart point and the restart count
+  static constexpr size_t kEmptyIndexBlockSize = 2 * sizeof(uint32_t);
+
+  // Also kept for tables the trie can't index
+  ShortenedIndexBuilder primary_index_builder_;
+  BlockBuilder empty_index_block_builder_;
+  bool build_trie_;
+  SuccinctTrie::Builder trie_builder_;
+  std::vector<BlockHandle> handles_;
+  std::string trie_block_;
+};
+
 /**
  * IndexBuilder for two-level indexing. Internally it creates a new index for
  * each partition and Finish then in order when Finish is called on it
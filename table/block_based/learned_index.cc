@@ -0,0 +1,219 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/learned_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "util/coding.h"
+#include "util/math.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Upper bound on the size of the radix table, in bits.
+constexpr int kMaxRadixBits = 18;
+
+uint64_t DoubleToBits(double d) {
+  uint64_t bits;
+  memcpy(&bits, &d, sizeof(bits));
+  return bits;
+}
+
+double BitsToDouble(uint64_t bits) {
+  double d;
+  memcpy(&d, &bits, sizeof(d));
+  return d;
+}
+}  // namespace
+
+uint64_t LearnedIndexModel::SuffixToInt(const Slice& suffix) {
+  uint64_t result = 0;
+  size_t n = std::min(suffix.size(), sizeof(uint64_t));
+  for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+    result <<= 8;
+    if (i < n) {
+      result |= static_cast<unsigned char>(suffix[i]);
+    }
+  }
+  return result;
+}
+
+void LearnedIndexModel::Builder::Add(const Slice& user_key) {
+  size_t keep = user_key.size();
+  if (!key_ends_.empty()) {
+    Slice first(keys_.data(), key_ends_[0]);
+    size_t shared = 0;
+    size_t limit = std::min(first.size(), user_key.size());
+    while (shared < limit && first[shared] == user_key[shared]) {
+      ++shared;
+    }
+    // Keys are added in order, so the prefix shared by all of them is the
+    // one shared by the first and the last.
+    prefix_len_ = shared;
+    keep = std::min(keep, shared + sizeof(uint64_t));
+  }
+  keys_.append(user_key.data(), keep);
+  key_ends_.push_back(static_cast<uint32_t>(keys_.size()));
+}
+
+bool LearnedIndexModel::Builder::Finish(std::string* contents) {
+  contents->clear();
+  if (key_ends_.empty()) {
+    return false;
+  }
+  if (key_ends_.size() == 1) {
+    prefix_len_ = key_ends_[0];
+  }
+
+  struct Point {
+    uint64_t key;
+    uint32_t entry;
+  };
+  std::vector<Point> points;
+  uint32_t start = 0;
+  for (uint32_t i = 0; i < key_ends_.size(); ++i) {
+    Slice key(keys_.data() + start, key_ends_[i] - start);
+    start = key_ends_[i];
+    key.remove_prefix(prefix_len_);
+    uint64_t x = SuffixToInt(key);
+    if (points.empty() || points.back().key != x) {
+      points.push_back({x, i});
+    }
+  }
+
+  std::string segments;
+  uint32_t num_segments = 0;
+  size_t first = 0;
+  double min_slope = 0;
+  double max_slope = std::numeric_limits<double>::infinity();
+  auto emit = [&]() {
+    double slope = std::isinf(max_slope) ? 0 : (min_slope + max_slope) / 2;
+    PutFixed64(&segments, points[first].key);
+    PutFixed32(&segments, points[first].entry);
+    PutFixed64(&segments, DoubleToBits(slope));
+    ++num_segments;
+  };
+  for (size_t i = 1; i < points.size(); ++i) {
+    double dx = static_cast<double>(points[i].key - points[first].key);
+    double dy = static_cast<double>(points[i].entry - points[first].entry);
+    double lo = (dy - kMaxError) / dx;
+    double hi = (dy + kMaxError) / dx;
+    if (lo > max_slope || hi < min_slope) {
+      emit();
+      first = i;
+      min_slope = 0;
+      max_slope = std::numeric_limits<double>::infinity();
+    } else {
+      min_slope = std::max(min_slope, lo);
+      max_slope = std::min(max_slope, hi);
+    }
+  }
+  emit();
+
+  PutVarint32(contents, static_cast<uint32_t>(key_ends_.size()));
+  PutLengthPrefixedSlice(contents, Slice(keys_.data(), prefix_len_));
+  PutVarint32(contents, num_segments);
+  contents->append(segments);
+  return true;
+}
+
+Status LearnedIndexModel::Create(const Slice& contents,
+                                 std::unique_ptr<LearnedIndexModel>* model) {
+  Slice input = contents;
+  std::unique_ptr<LearnedIndexModel> result(new LearnedIndexModel());
+  Slice prefix;
+  uint32_t num_segments = 0;
+  if (!GetVarint32(&input, &result->num_entries_) ||
+      !GetLengthPrefixedSlice(&input, &prefix) ||
+      !GetVarint32(&input, &num_segments) ||
+      result->num_entries_ == 0 || num_segments == 0 ||
+      num_segments > result->num_entries_ ||
+      input.size() != num_segments * uint64_t{20}) {
+    return Status::Corruption("bad learned index model");
+  }
+  result->prefix_ = prefix.ToString();
+  result->seg_key_.resize(num_segments);
+  result->seg_entry_.resize(num_segments);
+  result->seg_slope_.resize(num_segments);
+  const char* p = input.data();
+  for (uint32_t i = 0; i < num_segments; ++i, p += 20) {
+    uint64_t key = DecodeFixed64(p);
+    uint32_t entry = DecodeFixed32(p + 8);
+    double slope = BitsToDouble(DecodeFixed64(p + 12));
+    if ((i > 0 && (key <= result->seg_key_[i - 1] ||
+                   entry <= result->seg_entry_[i - 1])) ||
+        entry >= result->num_entries_ || !(slope >= 0) || std::isinf(slope)) {
+      return Status::Corruption("bad learned index model");
+    }
+    result->seg_key_[i] = key;
+    result->seg_entry_[i] = entry;
+    result->seg_slope_[i] = slope;
+  }
+
+  if (num_segments > 1) {
+    int bits = std::min(FloorLog2(num_segments) + 1, kMaxRadixBits);
+    result->radix_shift_ = 64 - bits;
+    size_t num_buckets = size_t{1} << bits;
+    result->radix_.resize(num_buckets + 1);
+    uint32_t seg = 0;
+    for (size_t bucket = 0; bucket <= num_buckets; ++bucket) {
+      while (seg < num_segments &&
+             (result->seg_key_[seg] >> result->radix_shift_) < bucket) {
+        ++seg;
+      }
+      result->radix_[bucket] = seg;
+    }
+  }
+  *model = std::move(result);
+  return Status::OK();
+}
+
+uint64_t LearnedIndexModel::KeyToInt(const Slice& user_key) const {
+  size_t n = std::min(user_key.size(), prefix_.size());
+  int cmp = memcmp(user_key.data(), prefix_.data(), n);
+  if (cmp < 0 || (cmp == 0 && user_key.size() < prefix_.size())) {
+    return 0;
+  } else if (cmp > 0) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  return SuffixToInt(Slice(user_key.data() + n, user_key.size() - n));
+}
+
+void LearnedIndexModel::Predict(const Slice& user_key, uint32_t* lo,
+                                uint32_t* hi) const {
+  uint64_t x = KeyToInt(user_key);
+  size_t begin = 0;
+  size_t end = seg_key_.size();
+  if (!radix_.empty()) {
+    uint64_t bucket = x >> radix_shift_;
+    begin = radix_[bucket];
+    end = radix_[bucket + 1];
+  }
+  // The last segment starting at or before x
+  size_t seg = std::upper_bound(seg_key_.begin() + begin,
+                                seg_key_.begin() + end, x) -
+               seg_key_.begin();
+  uint32_t pos = 0;
+  if (seg > 0) {
+    --seg;
+    double limit = seg + 1 < seg_key_.size() ? seg_entry_[seg + 1]
+                                             : num_entries_ - 1;
+    double predicted =
+        seg_entry_[seg] +
+        seg_slope_[seg] * static_cast<double>(x - seg_key_[seg]);
+    pos = static_cast<uint32_t>(std::min(predicted, limit) + 0.5);
+  }
+  // One more entry on each side covers the rounding of the prediction.
+  constexpr uint32_t kWindow = kMaxError + 1;
+  *lo = pos > kWindow ? pos - kWindow : 0;
+  *hi = std::min(pos + kWindow, num_entries_ - 1);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
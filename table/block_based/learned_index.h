@@ -0,0 +1,107 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A piecewise linear model over the user keys of the separators of an index
+// block, in the style of PGM-index and RadixSpline, built for
+// BlockBasedTableOptions::kLearnedIndexSearch. Given a key, it predicts the
+// index of the first separator not less than that key, so that a seek in the
+// index block only has to search a few entries around the prediction.
+//
+// Keys are mapped to integers by skipping the prefix shared by all the
+// separators and reading the next 8 bytes big-endian, which preserves their
+// bytewise order. Separators mapping to the same integer are one point of the
+// model, so the error is only bounded by kMaxError for tables whose separators
+// differ within those 8 bytes, e.g. fixed width big-endian ids. Readers must
+// therefore verify the predicted window against the index block.
+//
+// Serialized format, stored in the kLearnedIndexBlock meta block:
+//   num_entries: varint32
+//   prefix: varint32 length + bytes
+//   num_segments: varint32
+//   num_segments x (first key: fixed64, first entry: fixed32,
+//                   slope: fixed64 bits of a double)
+class LearnedIndexModel {
+ public:
+  // Bound on the distance between the predicted and the actual index of the
+  // first entry of each distinct key integer.
+  static constexpr uint32_t kMaxError = 8;
+
+  class Builder;
+
+  // Parses the model from the contents of a kLearnedIndexBlock meta block.
+  static Status Create(const Slice& contents,
+                       std::unique_ptr<LearnedIndexModel>* model);
+
+  // Sets [*lo, *hi] to the window of index entries predicted to contain the
+  // first separator whose user key is not less than user_key.
+  void Predict(const Slice& user_key, uint32_t* lo, uint32_t* hi) const;
+
+  uint32_t NumEntries() const { return num_entries_; }
+
+  size_t ApproximateMemoryUsage() const {
+    return sizeof(LearnedIndexModel) + prefix_.capacity() +
+           seg_key_.capacity() * sizeof(uint64_t) +
+           seg_entry_.capacity() * sizeof(uint32_t) +
+           seg_slope_.capacity() * sizeof(double) +
+           radix_.capacity() * sizeof(uint32_t);
+  }
+
+  // Reads the up to 8 bytes of suffix as a big-endian integer, padding with
+  // zeros.
+  static uint64_t SuffixToInt(const Slice& suffix);
+
+ private:
+  LearnedIndexModel() = default;
+
+  uint64_t KeyToInt(const Slice& user_key) const;
+
+  uint32_t num_entries_ = 0;
+  std::string prefix_;
+  // The segments, by first key integer.
+  std::vector<uint64_t> seg_key_;
+  std::vector<uint32_t> seg_entry_;
+  std::vector<double> seg_slope_;
+  // radix_[p] is the first segment whose first key has top bits >= p, so
+  // that a lookup only searches the segments of its own radix bucket. Empty
+  // with a single segment.
+  std::vector<uint32_t> radix_;
+  int radix_shift_ = 64;
+};
+
+// Collects the separators of an index block, in order, and fits the model
+// with a shrinking cone: a segment is extended for as long as some slope
+// through its first point keeps every point within kMaxError.
+class LearnedIndexModel::Builder {
+ public:
+  // Adds the user key of the separator of the next index entry.
+  void Add(const Slice& user_key);
+
+  // Serializes the model into *contents. Returns false, leaving *contents
+  // empty, if no separator was added.
+  bool Finish(std::string* contents);
+
+ private:
+  // The separators, each truncated to the bytes the model can read: the
+  // prefix shared with the first separator, followed by 8 bytes.
+  std::string keys_;
+  std::vector<uint32_t> key_ends_;
+  // Length of the prefix shared by all the separators so far.
+  size_t prefix_len_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
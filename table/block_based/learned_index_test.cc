@@ -0,0 +1,212 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/learned_index.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "rocksdb/comparator.h"
+#include "table/block_based/block.h"
+#include "table/block_based/block_builder.h"
+#include "table/format.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+#include "util/coding.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Sorted, unique 16 byte big-endian ids after a common prefix
+std::vector<std::string> GenerateIds(Random* rnd, size_t num,
+                                     const std::string& prefix) {
+  std::vector<std::string> keys;
+  uint64_t hi = rnd->Next();
+  for (size_t i = 0; i < num; ++i) {
+    // Mix dense runs and larger gaps
+    hi += rnd->OneIn(10) ? rnd->Uniform(1 << 20) + 1 : rnd->Uniform(100) + 1;
+    std::string key = prefix;
+    for (int shift = 56; shift >= 0; shift -= 8) {
+      key.push_back(static_cast<char>(hi >> shift));
+    }
+    PutFixed64(&key, rnd->Next64());
+    keys.push_back(std::move(key));
+  }
+  return keys;
+}
+
+// Sorted, unique keys of which many share their first 8 bytes after the
+// common prefix, which the model cannot tell apart.
+std::vector<std::string> GenerateClusteredKeys(Random* rnd, size_t num) {
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < num; ++i) {
+    keys.push_back("user" + std::string(i < num / 2 ? "aaaaaaaa" : "bbbbbbbb") +
+                   rnd->RandomString(static_cast<int>(rnd->Uniform(12)) + 1));
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  return keys;
+}
+
+std::unique_ptr<LearnedIndexModel> BuildModel(
+    const std::vector<std::string>& keys) {
+  LearnedIndexModel::Builder builder;
+  for (const auto& key : keys) {
+    builder.Add(key);
+  }
+  std::string contents;
+  EXPECT_TRUE(builder.Finish(&contents));
+  std::unique_ptr<LearnedIndexModel> model;
+  EXPECT_OK(LearnedIndexModel::Create(contents, &model));
+  return model;
+}
+
+std::string SeekKey(const std::string& user_key) {
+  return InternalKey(user_key, kMaxSequenceNumber, kValueTypeForSeek)
+      .Encode()
+      .ToString();
+}
+
+// Checks that seeking an index block of keys with the given model returns
+// the same entries as a plain binary search.
+void VerifySeeks(Random* rnd, const std::vector<std::string>& keys,
+                 const LearnedIndexModel* model) {
+  BlockBuilder builder(1 /* restart interval */);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    std::string value;
+    IndexValue(BlockHandle(i * 4096, 4096), Slice())
+        .EncodeTo(&value, false /* have_first_key */, nullptr);
+    builder.Add(keys[i], value);
+  }
+  BlockContents contents;
+  contents.data = builder.Finish();
+  Block block(std::move(contents));
+
+  auto new_iter = [&](const LearnedIndexModel* learned_index) {
+    return std::unique_ptr<IndexBlockIter>(block.NewIndexIterator(
+        BytewiseComparator(), kDisableGlobalSequenceNumber, nullptr, nullptr,
+        true /* total_order_seek */, false /* have_first_key */,
+        false /* key_includes_seq */, true /* value_is_full */,
+        false /* block_contents_pinned */,
+        true /* user_defined_timestamps_persisted */, nullptr, learned_index));
+  };
+  std::unique_ptr<IndexBlockIter> learned_iter = new_iter(model);
+  std::unique_ptr<IndexBlockIter> binary_iter = new_iter(nullptr);
+
+  std::vector<std::string> targets = {"", "\xff\xff\xff\xff\xff\xff"};
+  for (const auto& key : keys) {
+    targets.push_back(key);
+    std::string before = key;
+    before.back()--;
+    targets.push_back(before);
+    targets.push_back(key + "0");
+    targets.push_back(
+        key.substr(0, rnd->Uniform(static_cast<int>(key.size()))));
+  }
+  for (const auto& target : targets) {
+    std::string seek_key = SeekKey(target);
+    learned_iter->Seek(seek_key);
+    binary_iter->Seek(seek_key);
+    ASSERT_OK(learned_iter->status());
+    ASSERT_EQ(binary_iter->Valid(), learned_iter->Valid());
+    if (binary_iter->Valid()) {
+      ASSERT_EQ(binary_iter->key(), learned_iter->key());
+      ASSERT_EQ(binary_iter->value().handle.offset(),
+                learned_iter->value().handle.offset());
+    }
+  }
+}
+}  // namespace
+
+class LearnedIndexTest : public testing::Test {};
+
+TEST_F(LearnedIndexTest, PredictionWithinBound) {
+  Random rnd(301);
+  const size_t kNumKeys = 50000;
+  std::vector<std::string> keys = GenerateIds(&rnd, kNumKeys, "tenant01");
+
+  LearnedIndexModel::Builder builder;
+  for (const auto& key : keys) {
+    builder.Add(key);
+  }
+  std::string contents;
+  ASSERT_TRUE(builder.Finish(&contents));
+  // Far smaller than the index keys
+  ASSERT_LT(contents.size(), kNumKeys);
+  std::unique_ptr<LearnedIndexModel> model;
+  ASSERT_OK(LearnedIndexModel::Create(contents, &model));
+  ASSERT_EQ(kNumKeys, model->NumEntries());
+
+  for (uint32_t i = 0; i < kNumKeys; ++i) {
+    uint32_t lo, hi;
+    model->Predict(keys[i], &lo, &hi);
+    ASSERT_LE(lo, i);
+    ASSERT_GE(hi, i);
+    ASSERT_LE(hi - lo, 2 * (LearnedIndexModel::kMaxError + 1));
+  }
+  // Keys outside of the common prefix
+  uint32_t lo, hi;
+  model->Predict("tenant00", &lo, &hi);
+  ASSERT_EQ(0U, lo);
+  model->Predict("tenant02", &lo, &hi);
+  ASSERT_EQ(kNumKeys - 1, hi);
+}
+
+TEST_F(LearnedIndexTest, Corruption) {
+  std::unique_ptr<LearnedIndexModel> model;
+  ASSERT_TRUE(LearnedIndexModel::Create("", &model).IsCorruption());
+
+  Random rnd(301);
+  std::vector<std::string> keys = GenerateIds(&rnd, 1000, "p");
+  LearnedIndexModel::Builder builder;
+  for (const auto& key : keys) {
+    builder.Add(key);
+  }
+  std::string contents;
+  ASSERT_TRUE(builder.Finish(&contents));
+  ASSERT_TRUE(LearnedIndexModel::Create(
+                  Slice(contents.data(), contents.size() - 1), &model)
+                  .IsCorruption());
+  ASSERT_OK(LearnedIndexModel::Create(contents, &model));
+
+  LearnedIndexModel::Builder empty_builder;
+  ASSERT_FALSE(empty_builder.Finish(&contents));
+  ASSERT_TRUE(contents.empty());
+}
+
+TEST_F(LearnedIndexTest, SeekMatchesBinarySearch) {
+  Random rnd(301);
+  {
+    std::vector<std::string> keys = GenerateIds(&rnd, 5000, "tenant01");
+    VerifySeeks(&rnd, keys, BuildModel(keys).get());
+  }
+  {
+    std::vector<std::string> keys = GenerateIds(&rnd, 1, "");
+    VerifySeeks(&rnd, keys, BuildModel(keys).get());
+  }
+  {
+    // Large errors for the keys sharing their first 8 bytes
+    std::vector<std::string> keys = GenerateClusteredKeys(&rnd, 2000);
+    VerifySeeks(&rnd, keys, BuildModel(keys).get());
+  }
+  {
+    // A model of other keys only gives wrong predictions
+    std::vector<std::string> keys = GenerateIds(&rnd, 3000, "a");
+    std::vector<std::string> other_keys = GenerateIds(&rnd, 3000, "a");
+    VerifySeeks(&rnd, keys, BuildModel(other_keys).get());
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
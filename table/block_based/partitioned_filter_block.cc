@@ -266,6 +266,78 @@ void PartitionedFilterBlockReader::PrefixesMayMatch(
            &FullFilterBlockReader::PrefixesMayMatch);
 }
 
+bool PartitionedFilterBlockReader::RangeMayMatch(
+    const Slice& lower_user_key, const Slice& upper_user_key, const bool no_io,
+    const Slice* const const_ikey_ptr, BlockCacheLookupContext* lookup_context,
+    const ReadOptions& read_options) {
+  assert(const_ikey_ptr != nullptr);
+  if (!whole_key_filtering()) {
+    return true;
+  }
+
+  CachableEntry<Block_kFilterPartitionIndex> filter_block;
+  Status s = GetOrReadFilterBlock(no_io, nullptr /* get_context */,
+                                  lookup_context, &filter_block, read_options);
+  if (UNLIKELY(!s.ok())) {
+    IGNORE_STATUS_IF_ERROR(s);
+    return true;
+  }
+
+  if (UNLIKELY(filter_block.GetValue()->size() == 0)) {
+    return true;
+  }
+
+  IndexBlockIter iter;
+  const InternalKeyComparator* const comparator = internal_comparator();
+  const Comparator* const user_comparator = comparator->user_comparator();
+  Statistics* kNullStats = nullptr;
+  filter_block.GetValue()->NewIndexIterator(
+      user_comparator,
+      table()->get_rep()->get_global_seqno(BlockType::kFilterPartitionIndex),
+      &iter, kNullStats, true /* total_order_seek */,
+      false /* have_first_key */, index_key_includes_seq(),
+      index_value_is_full(), false /* block_contents_pinned */,
+      user_defined_timestamps_persisted());
+  iter.Seek(*const_ikey_ptr);
+  if (!iter.Valid()) {
+    // Past the last key of the table
+    return !iter.status().ok();
+  }
+
+  // Each partition separator is >= the keys of its partition and < those of
+  // the next one, so the partitions to check end at the first separator
+  // >= upper_user_key.
+  for (int i = 0; i < kMaxRangePartitions; ++i) {
+    BlockHandle filter_handle = iter.value().handle;
+    if (filter_handle.size() > 0) {
+      CachableEntry<ParsedFullFilterBlock> filter_partition_block;
+      s = GetFilterPartitionBlock(nullptr /* prefetch_buffer */, filter_handle,
+                                  no_io, nullptr /* get_context */,
+                                  lookup_context, read_options,
+                                  &filter_partition_block);
+      if (UNLIKELY(!s.ok())) {
+        IGNORE_STATUS_IF_ERROR(s);
+        return true;
+      }
+      FullFilterBlockReader filter_partition(table(),
+                                             std::move(filter_partition_block));
+      if (filter_partition.RangeMayMatch(lower_user_key, upper_user_key,
+                                         no_io, const_ikey_ptr, lookup_context,
+                                         read_options)) {
+        return true;
+      }
+    }
+    if (user_comparator->Compare(iter.user_key(), upper_user_key) >= 0) {
+      return false;
+    }
+    iter.Next();
+    if (!iter.Valid()) {
+      return !iter.status().ok();
+    }
+  }
+  return true;
+}
+
 BlockHandle PartitionedFilterBlockReader::GetFilterPartitionHandle(
     const CachableEntry<Block_kFilterPartitionIndex>& filter_block,
     const Slice& entry) const {
@@ -132,9 +132,18 @@ class PartitionedFilterBlockReader
                         BlockCacheLookupContext* lookup_context,
                         const ReadOptions& read_options) override;
 
+  bool RangeMayMatch(const Slice& lower_user_key, const Slice& upper_user_key,
+                     const bool no_io, const Slice* const const_ikey_ptr,
+                     BlockCacheLookupContext* lookup_context,
+                     const ReadOptions& read_options) override;
+
   size_t ApproximateMemoryUsage() const override;
 
  private:
+  // RangeMayMatch gives up on ranges spanning more partitions than this, as
+  // they likely hold keys and each partition checked can cost a read.
+  static constexpr int kMaxRangePartitions = 4;
+
   BlockHandle GetFilterPartitionHandle(
       const CachableEntry<Block_kFilterPartitionIndex>& filter_block,
       const Slice& entry) const;
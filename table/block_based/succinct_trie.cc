@@ -0,0 +1,505 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/succinct_trie.h"
+
+#include <algorithm>
+#include <deque>
+
+#include "util/coding.h"
+#include "util/math.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+size_t NumWords(size_t num_bits) { return (num_bits + 63) / 64; }
+
+void PutBits(const std::vector<bool>& bits, std::string* out) {
+  for (size_t w = 0; w < NumWords(bits.size()); ++w) {
+    uint64_t word = 0;
+    for (size_t b = 0; b < 64 && w * 64 + b < bits.size(); ++b) {
+      if (bits[w * 64 + b]) {
+        word |= uint64_t{1} << b;
+      }
+    }
+    PutFixed64(out, word);
+  }
+}
+
+bool GetBits(Slice* input, size_t num_bits, const char** words) {
+  size_t size = NumWords(num_bits) * sizeof(uint64_t);
+  if (input->size() < size) {
+    return false;
+  }
+  *words = input->data();
+  input->remove_prefix(size);
+  return true;
+}
+
+// Number of ones before each word of the bitmap, and in total at the end
+std::vector<uint32_t> BuildRank(const char* words, size_t num_bits) {
+  std::vector<uint32_t> rank(NumWords(num_bits) + 1);
+  uint32_t count = 0;
+  for (size_t w = 0; w < NumWords(num_bits); ++w) {
+    rank[w] = count;
+    count += BitsSetToOne(DecodeFixed64(words + w * sizeof(uint64_t)));
+  }
+  rank.back() = count;
+  return rank;
+}
+}  // namespace
+
+void PackedIntArray::EncodeTo(const std::vector<uint64_t>& values,
+                              std::string* out) {
+  uint64_t max_value = 0;
+  for (uint64_t v : values) {
+    max_value = std::max(max_value, v);
+  }
+  int width = max_value == 0 ? 0 : FloorLog2(max_value) + 1;
+  out->push_back(static_cast<char>(width));
+  std::vector<uint64_t> words(NumWords(values.size() * width));
+  for (size_t i = 0; width > 0 && i < values.size(); ++i) {
+    size_t bit = i * width;
+    words[bit / 64] |= values[i] << (bit % 64);
+    if (bit % 64 + width > 64) {
+      words[bit / 64 + 1] |= values[i] >> (64 - bit % 64);
+    }
+  }
+  for (uint64_t word : words) {
+    PutFixed64(out, word);
+  }
+}
+
+bool PackedIntArray::DecodeFrom(Slice* input, size_t num_values) {
+  if (input->empty() || static_cast<unsigned char>((*input)[0]) > 64) {
+    return false;
+  }
+  width_ = static_cast<unsigned char>((*input)[0]);
+  input->remove_prefix(1);
+  return GetBits(input, num_values * width_, &words_);
+}
+
+uint64_t PackedIntArray::Get(size_t i) const {
+  if (width_ == 0) {
+    return 0;
+  }
+  size_t bit = i * width_;
+  const char* p = words_ + bit / 64 * sizeof(uint64_t);
+  int shift = static_cast<int>(bit % 64);
+  uint64_t value = DecodeFixed64(p) >> shift;
+  if (shift + width_ > 64) {
+    value |= DecodeFixed64(p + sizeof(uint64_t)) << (64 - shift);
+  }
+  return width_ == 64 ? value : value & ((uint64_t{1} << width_) - 1);
+}
+
+void SuccinctTrie::Builder::Add(const Slice& key) {
+#ifndef NDEBUG
+  if (!key_ends_.empty()) {
+    size_t start = key_ends_.size() > 1 ? key_ends_[key_ends_.size() - 2] : 0;
+    assert(Slice(keys_.data() + start, keys_.size() - start).compare(key) < 0);
+  }
+#endif
+  keys_.append(key.data(), key.size());
+  key_ends_.push_back(static_cast<uint32_t>(keys_.size()));
+}
+
+void SuccinctTrie::Builder::Finish(std::string* out,
+                                   std::vector<uint32_t>* ids) {
+  const uint32_t num_keys = static_cast<uint32_t>(key_ends_.size());
+  std::vector<Slice> keys;
+  keys.reserve(num_keys);
+  for (uint32_t i = 0; i < num_keys; ++i) {
+    uint32_t start = i == 0 ? 0 : key_ends_[i - 1];
+    keys.emplace_back(keys_.data() + start, key_ends_[i] - start);
+  }
+  if (truncate_) {
+    // Keep up to the first byte differing from both neighbors, as SuRF-Base
+    auto common = [&](uint32_t a, uint32_t b) {
+      size_t n = std::min(keys[a].size(), keys[b].size());
+      size_t i = 0;
+      while (i < n && keys[a][i] == keys[b][i]) {
+        ++i;
+      }
+      return i;
+    };
+    std::vector<size_t> keep(num_keys);
+    for (uint32_t i = 0; i < num_keys; ++i) {
+      size_t shared = 0;
+      if (i > 0) {
+        shared = common(i - 1, i);
+      }
+      if (i + 1 < num_keys) {
+        shared = std::max(shared, common(i, i + 1));
+      }
+      keep[i] = std::min(keys[i].size(), shared + 1);
+    }
+    for (uint32_t i = 0; i < num_keys; ++i) {
+      keys[i] = Slice(keys[i].data(), keep[i]);
+    }
+  }
+
+  std::string labels;
+  std::vector<bool> has_child;
+  std::vector<bool> louds;
+  std::vector<bool> is_prefix_key;
+  std::vector<Slice> suffixes(num_keys);
+  if (ids != nullptr) {
+    ids->assign(num_keys, 0);
+  }
+  uint32_t next_id = 0;
+  auto assign_id = [&](uint32_t key, Slice suffix) {
+    suffixes[next_id] = suffix;
+    if (ids != nullptr) {
+      (*ids)[key] = next_id;
+    }
+    ++next_id;
+  };
+
+  // Breadth-first over the nodes, each being a range of keys sharing their
+  // first depth bytes
+  struct Node {
+    uint32_t begin;
+    uint32_t end;
+    uint32_t depth;
+  };
+  std::deque<Node> queue;
+  if (num_keys > 0) {
+    queue.push_back({0, num_keys, 0});
+  }
+  uint32_t num_nodes = 0;
+  while (!queue.empty()) {
+    Node node = queue.front();
+    queue.pop_front();
+    ++num_nodes;
+    uint32_t i = node.begin;
+    is_prefix_key.push_back(keys[i].size() == node.depth);
+    if (is_prefix_key.back()) {
+      assign_id(i, Slice());
+      ++i;
+    }
+    bool first = true;
+    while (i < node.end) {
+      char label = keys[i][node.depth];
+      uint32_t j = i + 1;
+      while (j < node.end && keys[j][node.depth] == label) {
+        ++j;
+      }
+      labels.push_back(label);
+      louds.push_back(first);
+      first = false;
+      has_child.push_back(j - i > 1);
+      if (j - i > 1) {
+        queue.push_back({i, j, node.depth + 1});
+      } else {
+        Slice suffix = keys[i];
+        suffix.remove_prefix(node.depth + 1);
+        assign_id(i, suffix);
+      }
+      i = j;
+    }
+  }
+  assert(next_id == num_keys);
+
+  PutVarint32Varint32Varint32(out, num_keys, num_nodes,
+                              static_cast<uint32_t>(labels.size()));
+  out->append(labels);
+  PutBits(has_child, out);
+  PutBits(louds, out);
+  PutBits(is_prefix_key, out);
+  std::vector<uint64_t> suffix_offsets(1, 0);
+  for (const Slice& suffix : suffixes) {
+    suffix_offsets.push_back(suffix_offsets.back() + suffix.size());
+  }
+  PackedIntArray::EncodeTo(suffix_offsets, out);
+  for (const Slice& suffix : suffixes) {
+    out->append(suffix.data(), suffix.size());
+  }
+}
+
+Status SuccinctTrie::Create(const Slice& data,
+                            std::unique_ptr<SuccinctTrie>* trie) {
+  const Status corruption = Status::Corruption("bad succinct trie");
+  std::unique_ptr<SuccinctTrie> result(new SuccinctTrie());
+  Slice input = data;
+  const char* louds = nullptr;
+  if (!GetVarint32(&input, &result->num_keys_) ||
+      !GetVarint32(&input, &result->num_nodes_) ||
+      !GetVarint32(&input, &result->num_labels_) ||
+      input.size() < result->num_labels_) {
+    return corruption;
+  }
+  result->labels_ = input.data();
+  input.remove_prefix(result->num_labels_);
+  if (!GetBits(&input, result->num_labels_, &result->has_child_) ||
+      !GetBits(&input, result->num_labels_, &louds) ||
+      !GetBits(&input, result->num_nodes_, &result->is_prefix_key_) ||
+      !result->suffix_offsets_.DecodeFrom(&input, result->num_keys_ + 1) ||
+      result->suffix_offsets_.Get(result->num_keys_) != input.size()) {
+    return corruption;
+  }
+  result->suffixes_ = input.data();
+
+  result->has_child_rank_ =
+      BuildRank(result->has_child_, result->num_labels_);
+  result->is_prefix_key_rank_ =
+      BuildRank(result->is_prefix_key_, result->num_nodes_);
+  for (uint32_t pos = 0; pos < result->num_labels_; ++pos) {
+    if (GetBit(louds, pos)) {
+      result->node_start_.push_back(pos);
+    }
+  }
+  // Only a root holding just the empty key has no label
+  if (result->num_labels_ == 0 && result->num_nodes_ == 1) {
+    result->node_start_.push_back(0);
+  }
+  result->node_start_.push_back(result->num_labels_);
+  uint32_t num_leaves =
+      result->num_labels_ - result->has_child_rank_.back();
+  if (result->node_start_.size() != result->num_nodes_ + size_t{1} ||
+      (result->num_nodes_ > 0 && result->node_start_[0] != 0) ||
+      result->has_child_rank_.back() + 1 !=
+          std::max(result->num_nodes_, uint32_t{1}) ||
+      num_leaves + result->is_prefix_key_rank_.back() != result->num_keys_) {
+    return corruption;
+  }
+  for (uint32_t id = 0; id < result->num_keys_; ++id) {
+    if (result->suffix_offsets_.Get(id) >
+        result->suffix_offsets_.Get(id + 1)) {
+      return corruption;
+    }
+  }
+  *trie = std::move(result);
+  return Status::OK();
+}
+
+bool SuccinctTrie::GetBit(const char* words, uint32_t i) {
+  return (DecodeFixed64(words + i / 64 * sizeof(uint64_t)) >> (i % 64)) & 1;
+}
+
+uint32_t SuccinctTrie::Rank(const char* words,
+                            const std::vector<uint32_t>& rank, uint32_t i) {
+  uint32_t bits = i % 64;
+  uint32_t result = rank[i / 64];
+  if (bits > 0) {
+    uint64_t word = DecodeFixed64(words + i / 64 * sizeof(uint64_t));
+    result += BitsSetToOne(word & ((uint64_t{1} << bits) - 1));
+  }
+  return result;
+}
+
+uint32_t SuccinctTrie::KeyId(uint32_t node, uint32_t pos) const {
+  if (pos == kPrefixKey) {
+    uint32_t start = NodeStart(node);
+    return start - Rank(has_child_, has_child_rank_, start) +
+           Rank(is_prefix_key_, is_prefix_key_rank_, node);
+  }
+  return pos - Rank(has_child_, has_child_rank_, pos) +
+         Rank(is_prefix_key_, is_prefix_key_rank_, node + 1);
+}
+
+Slice SuccinctTrie::Suffix(uint32_t id) const {
+  uint64_t begin = suffix_offsets_.Get(id);
+  uint64_t end = suffix_offsets_.Get(id + 1);
+  return Slice(suffixes_ + begin, static_cast<size_t>(end - begin));
+}
+
+bool SuccinctTrie::MayContainKeyInRange(const Slice& lower,
+                                        const Slice& upper) const {
+  Iterator iter(this);
+  if (iter.SeekImpl(lower, true /* stop_at_prefix */)) {
+    return true;
+  }
+  return iter.Valid() && iter.key().compare(upper) < 0;
+}
+
+bool SuccinctTrie::MayContainKeyWithPrefix(const Slice& prefix) const {
+  Iterator iter(this);
+  if (iter.SeekImpl(prefix, true /* stop_at_prefix */)) {
+    return true;
+  }
+  return iter.Valid() && iter.key().starts_with(prefix);
+}
+
+void SuccinctTrie::Iterator::SeekToFirst() {
+  path_.clear();
+  if (trie_->num_keys_ == 0) {
+    valid_ = false;
+    return;
+  }
+  MoveToLeftmost(0);
+}
+
+void SuccinctTrie::Iterator::SeekToLast() {
+  path_.clear();
+  if (trie_->num_keys_ == 0) {
+    valid_ = false;
+    return;
+  }
+  MoveToRightmost(0);
+}
+
+bool SuccinctTrie::Iterator::SeekImpl(const Slice& target,
+                                      bool stop_at_prefix) {
+  path_.clear();
+  if (trie_->num_keys_ == 0) {
+    valid_ = false;
+    return false;
+  }
+  uint32_t node = 0;
+  size_t depth = 0;
+  while (true) {
+    if (depth == target.size()) {
+      // All keys under node start with target
+      MoveToLeftmost(node);
+      return false;
+    }
+    // The prefix key of node, if any, is less than target
+    uint32_t start = trie_->NodeStart(node);
+    uint32_t end = trie_->NodeEnd(node);
+    const unsigned char label = static_cast<unsigned char>(target[depth]);
+    const unsigned char* labels =
+        reinterpret_cast<const unsigned char*>(trie_->labels_);
+    uint32_t pos = static_cast<uint32_t>(
+        std::lower_bound(labels + start, labels + end, label) - labels);
+    if (pos == end) {
+      path_.push_back({node, start == end ? kPrefixKey : end - 1});
+      Advance();
+      return false;
+    }
+    path_.push_back({node, pos});
+    if (trie_->Label(pos) != label) {
+      if (trie_->HasChild(pos)) {
+        MoveToLeftmost(trie_->ChildNode(pos));
+      } else {
+        SetKey();
+      }
+      return false;
+    }
+    if (trie_->HasChild(pos)) {
+      node = trie_->ChildNode(pos);
+      ++depth;
+      continue;
+    }
+    Slice suffix = trie_->Suffix(trie_->KeyId(node, pos));
+    Slice rest(target.data() + depth + 1, target.size() - depth - 1);
+    if (stop_at_prefix && rest.starts_with(suffix)) {
+      SetKey();
+      return true;
+    }
+    if (suffix.compare(rest) >= 0) {
+      SetKey();
+    } else {
+      Advance();
+    }
+    return false;
+  }
+}
+
+void SuccinctTrie::Iterator::Next() {
+  assert(valid_);
+  Advance();
+}
+
+void SuccinctTrie::Iterator::Prev() {
+  assert(valid_);
+  Retreat();
+}
+
+void SuccinctTrie::Iterator::MoveToLeftmost(uint32_t node) {
+  while (true) {
+    if (trie_->IsPrefixKey(node)) {
+      path_.push_back({node, kPrefixKey});
+      break;
+    }
+    uint32_t pos = trie_->NodeStart(node);
+    path_.push_back({node, pos});
+    if (!trie_->HasChild(pos)) {
+      break;
+    }
+    node = trie_->ChildNode(pos);
+  }
+  SetKey();
+}
+
+void SuccinctTrie::Iterator::MoveToRightmost(uint32_t node) {
+  while (true) {
+    uint32_t start = trie_->NodeStart(node);
+    uint32_t end = trie_->NodeEnd(node);
+    if (start == end) {
+      path_.push_back({node, kPrefixKey});
+      break;
+    }
+    path_.push_back({node, end - 1});
+    if (!trie_->HasChild(end - 1)) {
+      break;
+    }
+    node = trie_->ChildNode(end - 1);
+  }
+  SetKey();
+}
+
+void SuccinctTrie::Iterator::Advance() {
+  while (!path_.empty()) {
+    Level& level = path_.back();
+    uint32_t next = level.pos == kPrefixKey ? trie_->NodeStart(level.node)
+                                            : level.pos + 1;
+    if (next < trie_->NodeEnd(level.node)) {
+      level.pos = next;
+      if (trie_->HasChild(next)) {
+        MoveToLeftmost(trie_->ChildNode(next));
+      } else {
+        SetKey();
+      }
+      return;
+    }
+    path_.pop_back();
+  }
+  valid_ = false;
+}
+
+void SuccinctTrie::Iterator::Retreat() {
+  while (!path_.empty()) {
+    Level& level = path_.back();
+    if (level.pos != kPrefixKey) {
+      if (level.pos > trie_->NodeStart(level.node)) {
+        --level.pos;
+        if (trie_->HasChild(level.pos)) {
+          MoveToRightmost(trie_->ChildNode(level.pos));
+        } else {
+          SetKey();
+        }
+        return;
+      }
+      if (trie_->IsPrefixKey(level.node)) {
+        level.pos = kPrefixKey;
+        SetKey();
+        return;
+      }
+    }
+    path_.pop_back();
+  }
+  valid_ = false;
+}
+
+void SuccinctTrie::Iterator::SetKey() {
+  assert(!path_.empty());
+  key_.clear();
+  for (const Level& level : path_) {
+    if (level.pos != kPrefixKey) {
+      key_.push_back(static_cast<char>(trie_->Label(level.pos)));
+    }
+  }
+  const Level& last = path_.back();
+  id_ = trie_->KeyId(last.node, last.pos);
+  if (last.pos != kPrefixKey) {
+    Slice suffix = trie_->Suffix(id_);
+    key_.append(suffix.data(), suffix.size());
+  }
+  valid_ = true;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,188 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Unsigned integers of a fixed bit width, packed into little-endian 64-bit
+// words, for random access without decoding.
+class PackedIntArray {
+ public:
+  // Appends the values to *out: the bit width in one byte, then the words.
+  static void EncodeTo(const std::vector<uint64_t>& values, std::string* out);
+
+  // Parses num_values values from the front of *input, which must outlive
+  // this array.
+  bool DecodeFrom(Slice* input, size_t num_values);
+
+  uint64_t Get(size_t i) const;
+
+ private:
+  const char* words_ = nullptr;
+  int width_ = 0;
+};
+
+// A static trie over a sorted set of distinct byte strings, in the
+// LOUDS-Sparse encoding of SuRF (Zhang et al., SIGMOD 2018). Nodes are laid
+// out in breadth-first order, each one as the sorted labels of its outgoing
+// edges, with a bit per label telling whether it leads to a child node and a
+// bit per label marking the first label of each node. A key that is a
+// proper prefix of other keys is flagged on the node it ends at.
+//
+// Unlike in SuRF, the bytes of a key past the node where it becomes unique
+// are kept as a suffix of its leaf, so that the trie holds its keys exactly
+// and Iterator can serve ordered seeks and scans directly over the encoded
+// data. Each key also gets an id in [0, NumKeys()), to look up values
+// stored next to the trie.
+//
+// Built from keys truncated to their distinguishing prefixes instead (see
+// Builder), the trie is a compact range filter answering
+// MayContainKeyInRange().
+class SuccinctTrie {
+ public:
+  class Builder;
+  class Iterator;
+
+  // Parses a trie serialized by Builder::Finish(). data must outlive the
+  // trie.
+  static Status Create(const Slice& data, std::unique_ptr<SuccinctTrie>* trie);
+
+  uint32_t NumKeys() const { return num_keys_; }
+
+  // Returns false if no key of the trie, or of the set it was built from with
+  // truncation, can fall in [lower, upper).
+  bool MayContainKeyInRange(const Slice& lower, const Slice& upper) const;
+
+  // Returns false if no key of the trie, or of the set it was built from with
+  // truncation, can start with prefix.
+  bool MayContainKeyWithPrefix(const Slice& prefix) const;
+
+  size_t ApproximateMemoryUsage() const {
+    return sizeof(SuccinctTrie) +
+           (has_child_rank_.capacity() + is_prefix_key_rank_.capacity() +
+            node_start_.capacity()) *
+               sizeof(uint32_t);
+  }
+
+ private:
+  static constexpr uint32_t kPrefixKey = UINT32_MAX;
+
+  SuccinctTrie() = default;
+
+  uint32_t NodeStart(uint32_t node) const { return node_start_[node]; }
+  uint32_t NodeEnd(uint32_t node) const { return node_start_[node + 1]; }
+  unsigned char Label(uint32_t pos) const {
+    return static_cast<unsigned char>(labels_[pos]);
+  }
+  bool HasChild(uint32_t pos) const { return GetBit(has_child_, pos); }
+  // The k-th label with a child, counting from 1, leads to node k.
+  uint32_t ChildNode(uint32_t pos) const {
+    return Rank(has_child_, has_child_rank_, pos + 1);
+  }
+  bool IsPrefixKey(uint32_t node) const {
+    return GetBit(is_prefix_key_, node);
+  }
+  // Key ids follow the node order, the prefix key of a node, if any, coming
+  // before the keys of its leaf labels.
+  uint32_t KeyId(uint32_t node, uint32_t pos) const;
+  Slice Suffix(uint32_t id) const;
+
+  static bool GetBit(const char* words, uint32_t i);
+  static uint32_t Rank(const char* words, const std::vector<uint32_t>& rank,
+                       uint32_t i);
+
+  uint32_t num_keys_ = 0;
+  uint32_t num_nodes_ = 0;
+  uint32_t num_labels_ = 0;
+  const char* labels_ = nullptr;
+  const char* has_child_ = nullptr;
+  const char* is_prefix_key_ = nullptr;
+  const char* suffixes_ = nullptr;
+  PackedIntArray suffix_offsets_;
+  // Number of ones before each 64-bit word of the bitmaps
+  std::vector<uint32_t> has_child_rank_;
+  std::vector<uint32_t> is_prefix_key_rank_;
+  // Position of the first label of each node, plus num_labels_
+  std::vector<uint32_t> node_start_;
+};
+
+class SuccinctTrie::Builder {
+ public:
+  // With truncate, each key is only stored up to the byte telling it apart
+  // from its neighbors, which makes the trie a range filter.
+  explicit Builder(bool truncate = false) : truncate_(truncate) {}
+
+  // REQUIRES: key is greater than the previously added key.
+  void Add(const Slice& key);
+
+  size_t NumKeys() const { return key_ends_.size(); }
+
+  // Serializes the trie into *out. If ids is not null, (*ids)[i] is set to
+  // the id of the i-th key added.
+  void Finish(std::string* out, std::vector<uint32_t>* ids = nullptr);
+
+ private:
+  bool truncate_;
+  std::string keys_;
+  std::vector<uint32_t> key_ends_;
+};
+
+// Iterates over the keys of a trie in order. Also positions at the prefix
+// of a key when seeking for a range filter.
+class SuccinctTrie::Iterator {
+ public:
+  explicit Iterator(const SuccinctTrie* trie) : trie_(trie) {}
+
+  bool Valid() const { return valid_; }
+  void SeekToFirst();
+  void SeekToLast();
+  // Positions at the first key >= target.
+  void Seek(const Slice& target) { SeekImpl(target, false); }
+  void Next();
+  void Prev();
+
+  // REQUIRES: Valid()
+  Slice key() const { return key_; }
+  uint32_t id() const { return id_; }
+
+ private:
+  friend class SuccinctTrie;
+
+  struct Level {
+    uint32_t node;
+    // Position of the label taken, or kPrefixKey at the prefix key of node
+    uint32_t pos;
+  };
+
+  // Like Seek(), but with stop_at_prefix, also stops at a key that is a
+  // proper prefix of target if its last byte is on a leaf label, and returns
+  // true in that case.
+  bool SeekImpl(const Slice& target, bool stop_at_prefix);
+  void MoveToLeftmost(uint32_t node);
+  void MoveToRightmost(uint32_t node);
+  // Moves to the first key after the subtree of the last level
+  void Advance();
+  // Moves to the last key before the subtree of the last level
+  void Retreat();
+  void SetKey();
+
+  const SuccinctTrie* trie_;
+  std::vector<Level> path_;
+  std::string key_;
+  uint32_t id_ = 0;
+  bool valid_ = false;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
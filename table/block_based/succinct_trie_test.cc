@@ -0,0 +1,195 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/succinct_trie.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+std::unique_ptr<SuccinctTrie> BuildTrie(const std::set<std::string>& keys,
+                                        bool truncate, std::string* data,
+                                        std::vector<uint32_t>* ids) {
+  SuccinctTrie::Builder builder(truncate);
+  for (const auto& key : keys) {
+    builder.Add(key);
+  }
+  builder.Finish(data, ids);
+  std::unique_ptr<SuccinctTrie> trie;
+  EXPECT_OK(SuccinctTrie::Create(*data, &trie));
+  return trie;
+}
+
+// Composite keys sharing long prefixes, a few of them prefixes of others
+std::set<std::string> GenerateKeys(Random* rnd, size_t num) {
+  std::set<std::string> keys;
+  while (keys.size() < num) {
+    std::string key = "tenant" + std::to_string(rnd->Uniform(4)) + "/table" +
+                      std::to_string(rnd->Uniform(10)) + "/";
+    if (!rnd->OneIn(20)) {
+      key += rnd->RandomBinaryString(static_cast<int>(rnd->Uniform(6)) + 1);
+    }
+    keys.insert(key);
+  }
+  return keys;
+}
+}  // namespace
+
+class SuccinctTrieTest : public testing::Test {};
+
+TEST_F(SuccinctTrieTest, PackedIntArray) {
+  Random rnd(301);
+  for (int width : {0, 1, 7, 33, 64}) {
+    std::vector<uint64_t> values;
+    for (int i = 0; i < 1000; ++i) {
+      uint64_t v = rnd.Next64();
+      values.push_back(width == 64 ? v : v & ((uint64_t{1} << width) - 1));
+    }
+    std::string data;
+    PackedIntArray::EncodeTo(values, &data);
+    Slice input = data;
+    PackedIntArray array;
+    ASSERT_TRUE(array.DecodeFrom(&input, values.size()));
+    ASSERT_TRUE(input.empty());
+    for (size_t i = 0; i < values.size(); ++i) {
+      ASSERT_EQ(values[i], array.Get(i));
+    }
+  }
+}
+
+TEST_F(SuccinctTrieTest, IterateAndSeek) {
+  Random rnd(301);
+  for (size_t num_keys : {0, 1, 2, 100, 5000}) {
+    std::set<std::string> keys = GenerateKeys(&rnd, num_keys);
+    if (num_keys == 1) {
+      keys = {""};
+    }
+    std::string data;
+    std::vector<uint32_t> ids;
+    std::unique_ptr<SuccinctTrie> trie = BuildTrie(keys, false, &data, &ids);
+    ASSERT_EQ(keys.size(), trie->NumKeys());
+    std::vector<std::string> sorted(keys.begin(), keys.end());
+
+    // Forward and backward scans return all keys, with their ids
+    SuccinctTrie::Iterator iter(trie.get());
+    iter.SeekToFirst();
+    for (size_t i = 0; i < sorted.size(); ++i) {
+      ASSERT_TRUE(iter.Valid());
+      ASSERT_EQ(sorted[i], iter.key().ToString());
+      ASSERT_EQ(ids[i], iter.id());
+      iter.Next();
+    }
+    ASSERT_FALSE(iter.Valid());
+    iter.SeekToLast();
+    for (size_t i = sorted.size(); i > 0; --i) {
+      ASSERT_TRUE(iter.Valid());
+      ASSERT_EQ(sorted[i - 1], iter.key().ToString());
+      iter.Prev();
+    }
+    ASSERT_FALSE(iter.Valid());
+
+    std::vector<std::string> targets = {"", "\xff", "tenant", "tenant9"};
+    for (const auto& key : sorted) {
+      targets.push_back(key);
+      targets.push_back(key + '\0');
+      targets.push_back(key.substr(0, key.size() / 2));
+      if (!key.empty()) {
+        std::string before = key;
+        before.back()--;
+        targets.push_back(before);
+      }
+    }
+    for (const auto& target : targets) {
+      auto expected = keys.lower_bound(target);
+      iter.Seek(target);
+      if (expected == keys.end()) {
+        ASSERT_FALSE(iter.Valid());
+        continue;
+      }
+      ASSERT_TRUE(iter.Valid());
+      ASSERT_EQ(*expected, iter.key().ToString());
+      // And moving both ways from there
+      if (expected != keys.begin()) {
+        iter.Prev();
+        ASSERT_TRUE(iter.Valid());
+        ASSERT_EQ(*std::prev(expected), iter.key().ToString());
+        iter.Next();
+      }
+      iter.Next();
+      if (std::next(expected) == keys.end()) {
+        ASSERT_FALSE(iter.Valid());
+      } else {
+        ASSERT_TRUE(iter.Valid());
+        ASSERT_EQ(*std::next(expected), iter.key().ToString());
+      }
+    }
+  }
+}
+
+TEST_F(SuccinctTrieTest, RangeFilter) {
+  Random rnd(301);
+  std::set<std::string> keys = GenerateKeys(&rnd, 3000);
+  std::string full_data;
+  std::string truncated_data;
+  std::unique_ptr<SuccinctTrie> full =
+      BuildTrie(keys, false, &full_data, nullptr);
+  std::unique_ptr<SuccinctTrie> truncated =
+      BuildTrie(keys, true, &truncated_data, nullptr);
+  ASSERT_LT(truncated_data.size(), full_data.size());
+
+  int false_positives = 0;
+  int empty_ranges = 0;
+  for (int i = 0; i < 20000; ++i) {
+    std::string lower = *GenerateKeys(&rnd, 1).begin();
+    std::string upper = lower;
+    upper.push_back(static_cast<char>(rnd.Uniform(256)));
+    auto it = keys.lower_bound(lower);
+    bool expected = it != keys.end() && *it < upper;
+    // No false negatives
+    if (expected) {
+      ASSERT_TRUE(full->MayContainKeyInRange(lower, upper));
+      ASSERT_TRUE(truncated->MayContainKeyInRange(lower, upper));
+    }
+    if (it != keys.end() && it->compare(0, lower.size(), lower) == 0) {
+      ASSERT_TRUE(full->MayContainKeyWithPrefix(lower));
+      ASSERT_TRUE(truncated->MayContainKeyWithPrefix(lower));
+    }
+    if (!expected) {
+      ++empty_ranges;
+      if (truncated->MayContainKeyInRange(lower, upper)) {
+        ++false_positives;
+      }
+    }
+  }
+  ASSERT_GT(empty_ranges, 0);
+  ASSERT_LT(false_positives, empty_ranges);
+}
+
+TEST_F(SuccinctTrieTest, Corruption) {
+  Random rnd(301);
+  std::set<std::string> keys = GenerateKeys(&rnd, 100);
+  std::string data;
+  BuildTrie(keys, false, &data, nullptr);
+  std::unique_ptr<SuccinctTrie> trie;
+  ASSERT_TRUE(SuccinctTrie::Create(Slice(data.data(), data.size() / 2), &trie)
+                  .IsCorruption());
+  ASSERT_TRUE(SuccinctTrie::Create("", &trie).IsCorruption());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,114 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#include "table/block_based/trie_index_reader.h"
+
+#include "table/block_based/binary_search_index_reader.h"
+#include "table/block_fetcher.h"
+#include "table/meta_blocks.h"
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+// Index keys are user keys, so seek targets are compared by their user key
+// only, like IndexBlockIter does for such keys.
+class TrieIndexReader::Iterator : public InternalIteratorBase<IndexValue> {
+ public:
+  explicit Iterator(const TrieIndexReader* reader)
+      : reader_(reader), iter_(reader->trie_.get()) {}
+
+  bool Valid() const override { return iter_.Valid(); }
+  void SeekToFirst() override { iter_.SeekToFirst(); }
+  void SeekToLast() override { iter_.SeekToLast(); }
+  void Seek(const Slice& target) override {
+    iter_.Seek(ExtractUserKey(target));
+  }
+  void SeekForPrev(const Slice&) override {
+    assert(false);
+    status_ = Status::InvalidArgument(
+        "RocksDB internal error: should never call SeekForPrev() on index "
+        "blocks");
+  }
+  void Next() override { iter_.Next(); }
+  void Prev() override { iter_.Prev(); }
+
+  Slice key() const override { return iter_.key(); }
+  Slice user_key() const override { return iter_.key(); }
+  IndexValue value() const override {
+    uint32_t id = iter_.id();
+    return IndexValue(BlockHandle(reader_->offsets_.Get(id),
+                                  reader_->sizes_.Get(id)),
+                      Slice());
+  }
+  Status status() const override { return status_; }
+
+ private:
+  const TrieIndexReader* reader_;
+  SuccinctTrie::Iterator iter_;
+  Status status_;
+};
+
+Status TrieIndexReader::Create(const BlockBasedTable* table,
+                               const ReadOptions& ro,
+                               FilePrefetchBuffer* prefetch_buffer,
+                               InternalIterator* meta_index_iter,
+                               bool use_cache, bool prefetch, bool pin,
+                               BlockCacheLookupContext* lookup_context,
+                               std::unique_ptr<IndexReader>* index_reader) {
+  assert(table != nullptr);
+  assert(index_reader != nullptr);
+
+  const BlockBasedTable::Rep* rep = table->get_rep();
+  assert(rep != nullptr);
+
+  BlockHandle trie_handle;
+  Status s = FindMetaBlock(meta_index_iter, kTrieIndexBlock, &trie_handle);
+  if (!s.ok()) {
+    // Not built for this table, which has a binary search index instead
+    return BinarySearchIndexReader::Create(table, ro, prefetch_buffer,
+                                           use_cache, prefetch, pin,
+                                           lookup_context, index_reader);
+  }
+
+  // Unlike the metablocks of the hash index, the trie is the only copy of
+  // the index, so failing to read it fails the open.
+  std::unique_ptr<TrieIndexReader> reader(new TrieIndexReader());
+  BlockFetcher trie_block_fetcher(
+      rep->file.get(), prefetch_buffer, rep->footer, ro, trie_handle,
+      &reader->contents_, rep->ioptions, true /*decompress*/,
+      true /*maybe_compressed*/, BlockType::kTrieIndex,
+      UncompressionDict::GetEmptyDict(), rep->persistent_cache_options,
+      GetMemoryAllocator(rep->table_options));
+  s = trie_block_fetcher.ReadBlockContents();
+  if (!s.ok()) {
+    return s;
+  }
+
+  Slice input = reader->contents_.data;
+  Slice trie_data;
+  if (!GetLengthPrefixedSlice(&input, &trie_data)) {
+    return Status::Corruption("bad trie index block");
+  }
+  s = SuccinctTrie::Create(trie_data, &reader->trie_);
+  if (!s.ok()) {
+    return s;
+  }
+  const size_t num_keys = reader->trie_->NumKeys();
+  if (!reader->offsets_.DecodeFrom(&input, num_keys) ||
+      !reader->sizes_.DecodeFrom(&input, num_keys) || !input.empty()) {
+    return Status::Corruption("bad trie index block");
+  }
+  *index_reader = std::move(reader);
+  return Status::OK();
+}
+
+InternalIteratorBase<IndexValue>* TrieIndexReader::NewIterator(
+    const ReadOptions& /* read_options */, bool /* disable_prefix_seek */,
+    IndexBlockIter* /* iter */, GetContext* /* get_context */,
+    BlockCacheLookupContext* /* lookup_context */) {
+  // The trie is always in memory, so this never does IO and ignores
+  // read_tier. The caller owns the new iterator.
+  return new Iterator(this);
+}
+}  // namespace ROCKSDB_NAMESPACE
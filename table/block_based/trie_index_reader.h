@@ -0,0 +1,53 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#include "table/block_based/block_based_table_reader.h"
+#include "table/block_based/succinct_trie.h"
+
+namespace ROCKSDB_NAMESPACE {
+// Index that looks up the separators in a SuccinctTrie, read from the
+// kTrieIndexBlock metablock and held in memory for the lifetime of the
+// reader. Tables written without the metablock get a BinarySearchIndexReader.
+class TrieIndexReader : public BlockBasedTable::IndexReader {
+ public:
+  static Status Create(const BlockBasedTable* table, const ReadOptions& ro,
+                       FilePrefetchBuffer* prefetch_buffer,
+                       InternalIterator* meta_index_iter, bool use_cache,
+                       bool prefetch, bool pin,
+                       BlockCacheLookupContext* lookup_context,
+                       std::unique_ptr<IndexReader>* index_reader);
+
+  InternalIteratorBase<IndexValue>* NewIterator(
+      const ReadOptions& read_options, bool disable_prefix_seek,
+      IndexBlockIter* iter, GetContext* get_context,
+      BlockCacheLookupContext* lookup_context) override;
+
+  size_t ApproximateMemoryUsage() const override {
+    size_t usage = contents_.ApproximateMemoryUsage();
+#ifdef ROCKSDB_MALLOC_USABLE_SIZE
+    usage += malloc_usable_size(const_cast<TrieIndexReader*>(this));
+#else
+    usage += sizeof(*this);
+#endif  // ROCKSDB_MALLOC_USABLE_SIZE
+    if (trie_) {
+      usage += trie_->ApproximateMemoryUsage();
+    }
+    return usage;
+  }
+
+ private:
+  class Iterator;
+
+  TrieIndexReader() = default;
+
+  BlockContents contents_;
+  std::unique_ptr<SuccinctTrie> trie_;
+  // Offsets and sizes of the data blocks, by trie key id
+  PackedIntArray offsets_;
+  PackedIntArray sizes_;
+};
+}  // namespace ROCKSDB_NAMESPACE
@@ -207,6 +207,30 @@ static int RegisterBuiltinMemTableRepFactory(ObjectLibrary& library,
         }
         return guard->get();
       });
+  library.AddFactory<MemTableRepFactory>(
+      ObjectLibrary::PatternEntry(AdaptiveRadixTreeRepFactory::kClassName())
+          .AnotherName(AdaptiveRadixTreeRepFactory::kNickName()),
+      [](const std::string& /*uri*/,
+         std::unique_ptr<MemTableRepFactory>* guard, std::string* /*errmsg*/) {
+        guard->reset(new AdaptiveRadixTreeRepFactory());
+        return guard->get();
+      });
+  library.AddFactory<MemTableRepFactory>(
+      AsPattern(PartitionedRepFactory::kClassName(),
+                PartitionedRepFactory::kNickName()),
+      [](const std::string& uri, std::unique_ptr<MemTableRepFactory>* guard,
+         std::string* /*errmsg*/) {
+        // Expecting format: partitioned:<num_partitions>, the sub-rep is set
+        // by the "rep" option
+        auto colon = uri.find(":");
+        if (colon != std::string::npos) {
+          size_t num_partitions = ParseSizeT(uri.substr(colon + 1));
+          guard->reset(new PartitionedRepFactory(nullptr, num_partitions));
+        } else {
+          guard->reset(new PartitionedRepFactory());
+        }
+        return guard->get();
+      });
   library.AddFactory<MemTableRepFactory>(
       "cuckoo",
       [](const std::string& /*uri*/,
@@ -31,6 +31,7 @@ struct ReadOptions;
 struct TableProperties;
 class GetContext;
 class MultiGetContext;
+class RateLimiter;
 
 // A Table (also referred to as SST) is a sorted map from strings to strings.
 // Tables are immutable and persistent.  A Table may be safely accessed from
@@ -174,6 +175,19 @@ class TableReader {
     return Status::OK();
   }
 
+  // Loads the data blocks starting at the given file offsets (ascending;
+  // offsets not starting a data block are ignored) into the block cache,
+  // along with the index and filter blocks if `index_and_filter`. Reads are
+  // charged to `rate_limiter` if not nullptr. The numbers of blocks and
+  // bytes read are added to *blocks and *bytes.
+  virtual Status WarmUpBlockCache(const ReadOptions& /*read_options*/,
+                                  const std::vector<uint64_t>& /*offsets*/,
+                                  bool /*index_and_filter*/,
+                                  RateLimiter* /*rate_limiter*/,
+                                  uint64_t* /*blocks*/, uint64_t* /*bytes*/) {
+    return Status::NotSupported("WarmUpBlockCache() not supported");
+  }
+
   // convert db file to a human readable form
   virtual Status DumpTable(WritableFile* /*out_file*/);
 
@@ -706,6 +706,11 @@ DEFINE_double(data_block_hash_table_util_ratio, 0.75,
               "This is only valid if use_data_block_hash_index is "
               "set to true");
 
+DEFINE_bool(data_block_restart_key_prefixes, false,
+            "Store the first 8 bytes of restart keys next to the restart "
+            "array of data blocks, for faster seeks within data blocks. "
+            "This is valid if only we use BlockTable");
+
 DEFINE_int64(compressed_cache_size, -1,
              "Number of bytes to use as a cache of compressed data.");
 
@@ -722,6 +727,10 @@ DEFINE_int32(file_opening_threads,
              "If open_files is set to -1, this option set the number of "
              "threads that will be used to open files during DB::Open()");
 
+DEFINE_int32(wal_recovery_threads,
+             ROCKSDB_NAMESPACE::Options().wal_recovery_threads,
+             "Number of threads used to replay the WALs during DB::Open()");
+
 DEFINE_int32(compaction_readahead_size, 0, "Compaction readahead size");
 
 DEFINE_int32(log_readahead_size, 0, "WAL and manifest readahead size");
@@ -1413,6 +1422,10 @@ DEFINE_bool(
     "Enable the unordered write feature, which provides higher throughput but "
     "relaxes the guarantees around atomic reads and immutable snapshots");
 
+DEFINE_bool(enable_wal_gather_write, false,
+            "Let writers checksum their own WAL payloads and the write group "
+            "leader append them to the WAL without merging");
+
 DEFINE_bool(allow_concurrent_memtable_write, true,
             "Allow multi-writers to update mem tables in parallel.");
 
@@ -3054,11 +3067,16 @@ class Benchmark {
     if (FLAGS_cache_type == "clock_cache") {
       fprintf(stderr, "Old clock cache implementation has been removed.\n");
       ::exit(1);
-    } else if (FLAGS_cache_type == "hyper_clock_cache") {
-      HyperClockCacheOptions hcco{
-          static_cast<size_t>(capacity),
-          static_cast<size_t>(FLAGS_block_size) /*estimated_entry_charge*/,
-          FLAGS_cache_numshardbits};
+    } else if (FLAGS_cache_type == "hyper_clock_cache" ||
+               FLAGS_cache_type == "auto_hyper_clock_cache") {
+      // auto_hyper_clock_cache needs no estimated_entry_charge
+      size_t estimated_entry_charge =
+          FLAGS_cache_type == "hyper_clock_cache"
+              ? static_cast<size_t>(FLAGS_block_size)
+              : 0;
+      HyperClockCacheOptions hcco{static_cast<size_t>(capacity),
+                                  estimated_entry_charge,
+                                  FLAGS_cache_numshardbits};
       hcco.hash_seed = GetCacheHashSeed();
       if (use_tiered_cache) {
         TieredVolatileCacheOptions opts;
@@ -4193,6 +4211,7 @@ class Benchmark {
     }
     options.bloom_locality = FLAGS_bloom_locality;
     options.max_file_opening_threads = FLAGS_file_opening_threads;
+    options.wal_recovery_threads = FLAGS_wal_recovery_threads;
     options.compaction_readahead_size = FLAGS_compaction_readahead_size;
     options.log_readahead_size = FLAGS_log_readahead_size;
     options.random_access_max_buffer_size = FLAGS_random_access_max_buffer_size;
@@ -4396,6 +4415,8 @@ class Benchmark {
       }
       block_based_options.data_block_hash_table_util_ratio =
           FLAGS_data_block_hash_table_util_ratio;
+      block_based_options.data_block_restart_key_prefixes =
+          FLAGS_data_block_restart_key_prefixes;
       if (FLAGS_read_cache_path != "") {
         Status rc_status;
 
@@ -4534,6 +4555,7 @@ class Benchmark {
         FLAGS_enable_write_thread_adaptive_yield;
     options.enable_pipelined_write = FLAGS_enable_pipelined_write;
     options.unordered_write = FLAGS_unordered_write;
+    options.enable_wal_gather_write = FLAGS_enable_wal_gather_write;
     options.write_thread_max_yield_usec = FLAGS_write_thread_max_yield_usec;
     options.write_thread_slow_yield_usec = FLAGS_write_thread_slow_yield_usec;
     options.table_cache_numshardbits = FLAGS_table_cache_numshardbits;